@@ -54,7 +54,35 @@ WHERE relation = ANY(ARRAY['bttest_a', 'bttest_a_idx', 'bttest_b', 'bttest_b_idx
     AND pid = pg_backend_pid();
 COMMIT;
 
+--
+-- Deduplicated index, checked as its posting lists are formed, emptied by
+-- deletes and index scans, shrunk by VACUUM and refilled
+--
+CREATE TABLE bttest_dedup (a int, b int);
+CREATE INDEX bttest_dedup_idx ON bttest_dedup (a);
+INSERT INTO bttest_dedup SELECT i % 10, i FROM generate_series(1, 100000) i;
+SELECT bt_index_check('bttest_dedup_idx');
+SELECT bt_index_parent_check('bttest_dedup_idx');
+
+DELETE FROM bttest_dedup WHERE b % 3 = 0 OR a = 5;
+SET enable_seqscan = off;
+SET enable_bitmapscan = off;
+SELECT count(*) FROM bttest_dedup WHERE a = 5;
+RESET enable_seqscan;
+RESET enable_bitmapscan;
+SELECT bt_index_check('bttest_dedup_idx');
+
+VACUUM bttest_dedup;
+SELECT bt_index_parent_check('bttest_dedup_idx');
+
+INSERT INTO bttest_dedup
+  SELECT i % 10, i FROM generate_series(1, 100000) i WHERE i % 3 = 0 OR i % 10 = 5;
+INSERT INTO bttest_dedup SELECT 7, -i FROM generate_series(1, 50000) i;
+SELECT bt_index_check('bttest_dedup_idx');
+SELECT bt_index_parent_check('bttest_dedup_idx');
+
 -- cleanup
+DROP TABLE bttest_dedup;
 DROP TABLE bttest_a;
 DROP TABLE bttest_b;
 DROP OWNED BY bttest_role; -- permissions
@@ -98,20 +98,24 @@ static void bt_check_every_level(Relation rel, bool readonly);
 static BtreeLevel bt_check_level_from_leftmost(BtreeCheckState *state,
 							 BtreeLevel level);
 static void bt_target_page_check(BtreeCheckState *state);
-static ScanKey bt_right_page_check_scankey(BtreeCheckState *state);
+static ScanKey bt_right_page_check_scankey(BtreeCheckState *state,
+							int *keysz);
 static void bt_downlink_check(BtreeCheckState *state, BlockNumber childblock,
-				  ScanKey targetkey);
+				  ScanKey targetkey, int keysz);
+static inline int bt_scankey_natts(BtreeCheckState *state, IndexTuple itup);
+static void bt_posting_list_check(BtreeCheckState *state, BTPageOpaque opaque,
+					  OffsetNumber offset, IndexTuple itup);
 static inline bool offset_is_negative_infinity(BTPageOpaque opaque,
 							OffsetNumber offset);
 static inline bool invariant_leq_offset(BtreeCheckState *state,
-					 ScanKey key,
+					 ScanKey key, int keysz,
 					 OffsetNumber upperbound);
 static inline bool invariant_geq_offset(BtreeCheckState *state,
-					 ScanKey key,
+					 ScanKey key, int keysz,
 					 OffsetNumber lowerbound);
 static inline bool invariant_leq_nontarget_offset(BtreeCheckState *state,
 							   Page other,
-							   ScanKey key,
+							   ScanKey key, int keysz,
 							   OffsetNumber upperbound);
 static Page palloc_btree_page(BtreeCheckState *state, BlockNumber blocknum);
 
@@ -574,6 +578,7 @@ bt_target_page_check(BtreeCheckState *state)
 		ItemId		itemid;
 		IndexTuple	itup;
 		ScanKey		skey;
+		int			keysz;
 
 		CHECK_FOR_INTERRUPTS();
 
@@ -588,6 +593,16 @@ bt_target_page_check(BtreeCheckState *state)
 		itemid = PageGetItemId(state->target, offset);
 		itup = (IndexTuple) PageGetItem(state->target, itemid);
 		skey = _bt_mkscankey(state->rel, itup);
+		keysz = bt_scankey_natts(state, itup);
+
+		/*
+		 * * Posting list check *
+		 *
+		 * Deduplicated leaf tuples carry their own array of heap TIDs, which
+		 * must be well formed.
+		 */
+		if (BTreeTupleIsPosting(itup))
+			bt_posting_list_check(state, topaque, offset, itup);
 
 		/*
 		 * * High key check *
@@ -610,7 +625,7 @@ bt_target_page_check(BtreeCheckState *state)
 		 * and probably not markedly more effective in practice.
 		 */
 		if (!P_RIGHTMOST(topaque) &&
-			!invariant_leq_offset(state, skey, P_HIKEY))
+			!invariant_leq_offset(state, skey, keysz, P_HIKEY))
 		{
 			char	   *itid,
 					   *htid;
@@ -639,7 +654,7 @@ bt_target_page_check(BtreeCheckState *state)
 		 * current item is less than or equal to next item (if any).
 		 */
 		if (OffsetNumberNext(offset) <= max &&
-			!invariant_leq_offset(state, skey,
+			!invariant_leq_offset(state, skey, keysz,
 								  OffsetNumberNext(offset)))
 		{
 			char	   *itid,
@@ -696,12 +711,13 @@ bt_target_page_check(BtreeCheckState *state)
 		else if (offset == max)
 		{
 			ScanKey		rightkey;
+			int			rightkeysz;
 
 			/* Get item in next/right page */
-			rightkey = bt_right_page_check_scankey(state);
+			rightkey = bt_right_page_check_scankey(state, &rightkeysz);
 
 			if (rightkey &&
-				!invariant_geq_offset(state, rightkey, max))
+				!invariant_geq_offset(state, rightkey, rightkeysz, max))
 			{
 				/*
 				 * As explained at length in bt_right_page_check_scankey(),
@@ -747,7 +763,7 @@ bt_target_page_check(BtreeCheckState *state)
 		{
 			BlockNumber childblock = ItemPointerGetBlockNumber(&(itup->t_tid));
 
-			bt_downlink_check(state, childblock, skey);
+			bt_downlink_check(state, childblock, skey, keysz);
 		}
 	}
 }
@@ -769,12 +785,13 @@ bt_target_page_check(BtreeCheckState *state)
  * been concurrently deleted.
  */
 static ScanKey
-bt_right_page_check_scankey(BtreeCheckState *state)
+bt_right_page_check_scankey(BtreeCheckState *state, int *keysz)
 {
 	BTPageOpaque opaque;
 	ItemId		rightitem;
 	BlockNumber targetnext;
 	Page		rightpage;
+	IndexTuple	firstitup;
 	OffsetNumber nline;
 
 	/* Determine target's next block number */
@@ -960,8 +977,10 @@ bt_right_page_check_scankey(BtreeCheckState *state)
 	 * Return first real item scankey.  Note that this relies on right page
 	 * memory remaining allocated.
 	 */
-	return _bt_mkscankey(state->rel,
-						 (IndexTuple) PageGetItem(rightpage, rightitem));
+	firstitup = (IndexTuple) PageGetItem(rightpage, rightitem);
+	*keysz = bt_scankey_natts(state, firstitup);
+
+	return _bt_mkscankey(state->rel, firstitup);
 }
 
 /*
@@ -975,7 +994,7 @@ bt_right_page_check_scankey(BtreeCheckState *state)
  */
 static void
 bt_downlink_check(BtreeCheckState *state, BlockNumber childblock,
-				  ScanKey targetkey)
+				  ScanKey targetkey, int keysz)
 {
 	OffsetNumber offset;
 	OffsetNumber maxoffset;
@@ -1047,7 +1066,7 @@ bt_downlink_check(BtreeCheckState *state, BlockNumber childblock,
 			continue;
 
 		if (!invariant_leq_nontarget_offset(state, child,
-											targetkey, offset))
+											targetkey, keysz, offset))
 			ereport(ERROR,
 					(errcode(ERRCODE_INDEX_CORRUPTED),
 					 errmsg("down-link lower bound invariant violated for index \"%s\"",
@@ -1093,6 +1112,68 @@ offset_is_negative_infinity(BTPageOpaque opaque, OffsetNumber offset)
 	return !P_ISLEAF(opaque) && offset == P_FIRSTDATAKEY(opaque);
 }
 
+/*
+ * Number of scankey entries that _bt_mkscankey() fills in for itup.
+ *
+ * Pivot tuples may have had trailing key attributes truncated away, which
+ * _bt_compare() treats as minus infinity, so a scankey built from one can
+ * only be used to compare that many attributes.
+ */
+static inline int
+bt_scankey_natts(BtreeCheckState *state, IndexTuple itup)
+{
+	return Min(BTreeTupleGetNAtts(itup, state->rel),
+			   IndexRelationGetNumberOfKeyAttributes(state->rel));
+}
+
+/*
+ * Check the heap TIDs of a posting list tuple at offset on the target page.
+ *
+ * Only leaf pages hold posting lists.  Each holds at least two heap TIDs,
+ * all of them valid, in strictly ascending order.
+ */
+static void
+bt_posting_list_check(BtreeCheckState *state, BTPageOpaque opaque,
+					  OffsetNumber offset, IndexTuple itup)
+{
+	ItemPointer htids;
+	int			nhtids;
+	int			i;
+
+	nhtids = BTreeTupleGetNPosting(itup);
+	htids = BTreeTupleGetPosting(itup);
+
+	if (!P_ISLEAF(opaque) || nhtids < 2 ||
+		BTreeTupleGetPostingOffset(itup) +
+		nhtids * sizeof(ItemPointerData) > IndexTupleSize(itup))
+		ereport(ERROR,
+				(errcode(ERRCODE_INDEX_CORRUPTED),
+				 errmsg("invalid posting list tuple in index \"%s\"",
+						RelationGetRelationName(state->rel)),
+				 errdetail_internal("Index tid=(%u,%u) has %d heap TIDs on %s page, page lsn=%X/%X.",
+									state->targetblock, offset, nhtids,
+									P_ISLEAF(opaque) ? "leaf" : "internal",
+									(uint32) (state->targetlsn >> 32),
+									(uint32) state->targetlsn)));
+
+	for (i = 0; i < nhtids; i++)
+	{
+		if (!ItemPointerIsValid(&htids[i]) ||
+			(i > 0 && ItemPointerCompare(&htids[i - 1], &htids[i]) >= 0))
+			ereport(ERROR,
+					(errcode(ERRCODE_INDEX_CORRUPTED),
+					 errmsg("invalid or out-of-order heap TID in posting list tuple in index \"%s\"",
+							RelationGetRelationName(state->rel)),
+					 errdetail_internal("Index tid=(%u,%u) heap TID %d of %d is (%u,%u), page lsn=%X/%X.",
+										state->targetblock, offset, i + 1,
+										nhtids,
+										ItemPointerGetBlockNumberNoCheck(&htids[i]),
+										ItemPointerGetOffsetNumberNoCheck(&htids[i]),
+										(uint32) (state->targetlsn >> 32),
+										(uint32) state->targetlsn)));
+	}
+}
+
 /*
  * Does the invariant hold that the key is less than or equal to a given upper
  * bound offset item?
@@ -1101,13 +1182,12 @@ offset_is_negative_infinity(BTPageOpaque opaque, OffsetNumber offset)
  * to corruption.
  */
 static inline bool
-invariant_leq_offset(BtreeCheckState *state, ScanKey key,
+invariant_leq_offset(BtreeCheckState *state, ScanKey key, int keysz,
 					 OffsetNumber upperbound)
 {
-	int16		natts = state->rel->rd_rel->relnatts;
 	int32		cmp;
 
-	cmp = _bt_compare(state->rel, natts, key, state->target, upperbound);
+	cmp = _bt_compare(state->rel, keysz, key, state->target, upperbound);
 
 	return cmp <= 0;
 }
@@ -1120,13 +1200,12 @@ invariant_leq_offset(BtreeCheckState *state, ScanKey key,
  * to corruption.
  */
 static inline bool
-invariant_geq_offset(BtreeCheckState *state, ScanKey key,
+invariant_geq_offset(BtreeCheckState *state, ScanKey key, int keysz,
 					 OffsetNumber lowerbound)
 {
-	int16		natts = state->rel->rd_rel->relnatts;
 	int32		cmp;
 
-	cmp = _bt_compare(state->rel, natts, key, state->target, lowerbound);
+	cmp = _bt_compare(state->rel, keysz, key, state->target, lowerbound);
 
 	return cmp >= 0;
 }
@@ -1143,13 +1222,12 @@ invariant_geq_offset(BtreeCheckState *state, ScanKey key,
  */
 static inline bool
 invariant_leq_nontarget_offset(BtreeCheckState *state,
-							   Page nontarget, ScanKey key,
+							   Page nontarget, ScanKey key, int keysz,
 							   OffsetNumber upperbound)
 {
-	int16		natts = state->rel->rd_rel->relnatts;
 	int32		cmp;
 
-	cmp = _bt_compare(state->rel, natts, key, nontarget, upperbound);
+	cmp = _bt_compare(state->rel, keysz, key, nontarget, upperbound);
 
 	return cmp <= 0;
 }
@@ -120,6 +120,8 @@ blhandler(PG_FUNCTION_ARGS)
 	amroutine->amclusterable = false;
 	amroutine->ampredlocks = false;
 	amroutine->amcanparallel = false;
+	amroutine->amcaninclude = false;
+	amroutine->amcanskip = false;
 	amroutine->amkeytype = InvalidOid;
 
 	amroutine->ambuild = blbuild;
@@ -78,3 +78,18 @@ SELECT * FROM hash_page_items(get_raw_page('test_hash_a_idx', 5));
 
 
 DROP TABLE test_hash;
+
+-- An insertion that finds a split due splits some buckets ahead of need.
+-- Splitting one bucket at a time would stop at the fewest buckets that hold
+-- ntuples at ffactor tuples each; this index must end up with more.
+\x off
+CREATE TABLE test_hash_grow (a int);
+CREATE INDEX test_hash_grow_idx ON test_hash_grow USING hash (a)
+  WITH (fillfactor = 10);
+INSERT INTO test_hash_grow SELECT generate_series(1, 49000);
+
+SELECT ntuples, ffactor, maxbucket + 1 AS nbuckets,
+  ceil(ntuples / ffactor) AS nbuckets_one_per_split
+FROM hash_metapage_info(get_raw_page('test_hash_grow_idx', 0));
+
+DROP TABLE test_hash_grow;
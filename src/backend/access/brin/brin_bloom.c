@@ -0,0 +1,357 @@
+/*
+ * brin_bloom.c
+ *		Implementation of Bloom opclass for BRIN
+ *
+ * A minmax summary is useless for a column whose values are not correlated
+ * with the physical order of the table: every range ends up covering nearly
+ * the whole domain.  The "bloom" opclasses instead summarize each page range
+ * with a Bloom filter of the hashes of its values, which can answer equality
+ * searches no matter how the values are scattered.  The filter may report
+ * false positives, so a range is sometimes scanned in vain, but it never
+ * reports a false negative.
+ *
+ * The filter is sized when the first value is added to a range, for an
+ * estimate of the number of distinct values in a range of pages_per_range
+ * pages (BLOOM_NDISTINCT_FRACTION of the maximum number of tuples) and a
+ * false positive rate of BLOOM_FALSE_POSITIVE_RATE, but is never made larger
+ * than BLOOM_MAX_FILTER_BYTES, nor than its share of a BRIN tuple when the
+ * index has several columns.  All the filters of an index thus have the
+ * same size and number of hash functions, which lets us union them by
+ * OR'ing the bitmaps.  For large ranges with many distinct values, the
+ * false positive rate will be higher; use a smaller pages_per_range then.
+ *
+ * Each opclass provides the datatype's hash function as support procedure
+ * BLOOM_HASH_PROCNUM.  The k bit positions for a value are derived from that
+ * one 32-bit hash by double hashing.
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *	  src/backend/access/brin/brin_bloom.c
+ */
+#include "postgres.h"
+
+#include <math.h>
+
+#include "access/brin.h"
+#include "access/brin_internal.h"
+#include "access/brin_page.h"
+#include "access/brin_pageops.h"
+#include "access/brin_tuple.h"
+#include "access/genam.h"
+#include "access/hash.h"
+#include "access/htup_details.h"
+#include "access/stratnum.h"
+#include "catalog/pg_type.h"
+#include "storage/bufpage.h"
+#include "utils/builtins.h"
+#include "utils/rel.h"
+
+
+/* support procedure number of the datatype's hash function */
+#define BLOOM_HASH_PROCNUM			11
+
+#define BLOOM_FALSE_POSITIVE_RATE	0.01
+#define BLOOM_NDISTINCT_FRACTION	0.1
+#define BLOOM_MIN_NDISTINCT			16
+#define BLOOM_MAX_FILTER_BYTES		(BLCKSZ / 8)
+
+/*
+ * On-disk (and in-memory) representation of a range's Bloom filter, stored
+ * as a bytea.
+ */
+typedef struct BloomFilter
+{
+	int32		vl_len_;		/* varlena header (do not touch directly!) */
+	uint16		nhashes;		/* number of hash functions */
+	uint16		padding;
+	uint32		nbits;			/* number of bits in the bitmap */
+	bits8		bitmap[FLEXIBLE_ARRAY_MEMBER];
+} BloomFilter;
+
+static BloomFilter *bloom_init(BrinDesc *bdesc);
+static bool bloom_add_hash(BloomFilter *filter, uint32 hash);
+static bool bloom_contains_hash(BloomFilter *filter, uint32 hash);
+static uint32 bloom_get_hash(BrinDesc *bdesc, AttrNumber attno, Oid colloid,
+			   Datum value);
+
+
+Datum
+brin_bloom_opcinfo(PG_FUNCTION_ARGS)
+{
+	BrinOpcInfo *result;
+
+	/* the summary is a single bytea, whatever the indexed type */
+	result = palloc0(SizeofBrinOpcInfo(1));
+	result->oi_nstored = 1;
+	result->oi_opaque = NULL;
+	result->oi_typcache[0] = lookup_type_cache(BYTEAOID, 0);
+
+	PG_RETURN_POINTER(result);
+}
+
+/*
+ * Add the hash of the given value to the range's Bloom filter, creating the
+ * filter if this is the first non-null value.  Return true if the filter was
+ * modified.
+ */
+Datum
+brin_bloom_add_value(PG_FUNCTION_ARGS)
+{
+	BrinDesc   *bdesc = (BrinDesc *) PG_GETARG_POINTER(0);
+	BrinValues *column = (BrinValues *) PG_GETARG_POINTER(1);
+	Datum		newval = PG_GETARG_DATUM(2);
+	bool		isnull = PG_GETARG_DATUM(3);
+	Oid			colloid = PG_GET_COLLATION();
+	BloomFilter *filter;
+	uint32		hash;
+	bool		updated = false;
+
+	/*
+	 * If the new value is null, we record that we saw it if it's the first
+	 * one; otherwise, there's nothing to do.
+	 */
+	if (isnull)
+	{
+		if (column->bv_hasnulls)
+			PG_RETURN_BOOL(false);
+
+		column->bv_hasnulls = true;
+		PG_RETURN_BOOL(true);
+	}
+
+	hash = bloom_get_hash(bdesc, column->bv_attno, colloid, newval);
+
+	if (column->bv_allnulls)
+	{
+		filter = bloom_init(bdesc);
+		column->bv_values[0] = PointerGetDatum(filter);
+		column->bv_allnulls = false;
+		updated = true;
+	}
+	else
+	{
+		/* the stored value is ours to scribble on, once detoasted */
+		filter = (BloomFilter *) PG_DETOAST_DATUM(column->bv_values[0]);
+		column->bv_values[0] = PointerGetDatum(filter);
+	}
+
+	if (bloom_add_hash(filter, hash))
+		updated = true;
+
+	PG_RETURN_BOOL(updated);
+}
+
+/*
+ * Given an index tuple corresponding to a certain page range and a scan key,
+ * return whether the scan key is consistent with the range's Bloom filter.
+ * Only equality can be tested this way.
+ */
+Datum
+brin_bloom_consistent(PG_FUNCTION_ARGS)
+{
+	BrinDesc   *bdesc = (BrinDesc *) PG_GETARG_POINTER(0);
+	BrinValues *column = (BrinValues *) PG_GETARG_POINTER(1);
+	ScanKey		key = (ScanKey) PG_GETARG_POINTER(2);
+	Oid			colloid = PG_GET_COLLATION();
+	BloomFilter *filter;
+	uint32		hash;
+
+	Assert(key->sk_attno == column->bv_attno);
+
+	/* handle IS NULL/IS NOT NULL tests */
+	if (key->sk_flags & SK_ISNULL)
+	{
+		if (key->sk_flags & SK_SEARCHNULL)
+		{
+			if (column->bv_allnulls || column->bv_hasnulls)
+				PG_RETURN_BOOL(true);
+			PG_RETURN_BOOL(false);
+		}
+
+		/*
+		 * For IS NOT NULL, we can only skip ranges that are known to have
+		 * only nulls.
+		 */
+		if (key->sk_flags & SK_SEARCHNOTNULL)
+			PG_RETURN_BOOL(!column->bv_allnulls);
+
+		/*
+		 * Neither IS NULL nor IS NOT NULL was used; assume all indexable
+		 * operators are strict and return false.
+		 */
+		PG_RETURN_BOOL(false);
+	}
+
+	/* if the range is all empty, it cannot possibly be consistent */
+	if (column->bv_allnulls)
+		PG_RETURN_BOOL(false);
+
+	if (key->sk_strategy != BTEqualStrategyNumber)
+		elog(ERROR, "invalid strategy number %d", key->sk_strategy);
+
+	filter = (BloomFilter *) PG_DETOAST_DATUM(column->bv_values[0]);
+	hash = bloom_get_hash(bdesc, key->sk_attno, colloid, key->sk_argument);
+
+	PG_RETURN_BOOL(bloom_contains_hash(filter, hash));
+}
+
+/*
+ * Given two BrinValues, update the first of them as a union of the summary
+ * values contained in both.  The second one is untouched.
+ */
+Datum
+brin_bloom_union(PG_FUNCTION_ARGS)
+{
+	BrinValues *col_a = (BrinValues *) PG_GETARG_POINTER(1);
+	BrinValues *col_b = (BrinValues *) PG_GETARG_POINTER(2);
+	BloomFilter *filter_a;
+	BloomFilter *filter_b;
+	uint32		nbytes;
+	uint32		i;
+
+	Assert(col_a->bv_attno == col_b->bv_attno);
+
+	/* Adjust "hasnulls" */
+	if (!col_a->bv_hasnulls && col_b->bv_hasnulls)
+		col_a->bv_hasnulls = true;
+
+	/* If there are no values in B, there's nothing left to do */
+	if (col_b->bv_allnulls)
+		PG_RETURN_VOID();
+
+	filter_b = (BloomFilter *) PG_DETOAST_DATUM(col_b->bv_values[0]);
+
+	/*
+	 * Adjust "allnulls".  If A doesn't have values, just copy the filter
+	 * from B into A, and we're done.
+	 */
+	if (col_a->bv_allnulls)
+	{
+		filter_a = (BloomFilter *) palloc(VARSIZE(filter_b));
+		memcpy(filter_a, filter_b, VARSIZE(filter_b));
+		col_a->bv_values[0] = PointerGetDatum(filter_a);
+		col_a->bv_allnulls = false;
+		PG_RETURN_VOID();
+	}
+
+	filter_a = (BloomFilter *) PG_DETOAST_DATUM(col_a->bv_values[0]);
+	col_a->bv_values[0] = PointerGetDatum(filter_a);
+
+	if (filter_a->nbits != filter_b->nbits ||
+		filter_a->nhashes != filter_b->nhashes)
+		elog(ERROR, "cannot union BRIN bloom filters of different sizes");
+
+	nbytes = (filter_a->nbits + 7) / 8;
+	for (i = 0; i < nbytes; i++)
+		filter_a->bitmap[i] |= filter_b->bitmap[i];
+
+	PG_RETURN_VOID();
+}
+
+/*
+ * Create an empty Bloom filter, sized for the index's pages_per_range.
+ */
+static BloomFilter *
+bloom_init(BrinDesc *bdesc)
+{
+	BloomFilter *filter;
+	double		ndistinct;
+	double		nbits;
+	int			nhashes;
+	int			natts = bdesc->bd_tupdesc->natts;
+	Size		maxbytes;
+	Size		len;
+
+	ndistinct = BLOOM_NDISTINCT_FRACTION * MaxHeapTuplesPerPage *
+		BrinGetPagesPerRange(bdesc->bd_index);
+	ndistinct = Max(ndistinct, BLOOM_MIN_NDISTINCT);
+
+	/* the optimal size and number of hash functions for that many values */
+	nbits = ceil(-ndistinct * log(BLOOM_FALSE_POSITIVE_RATE) /
+				 (log(2.0) * log(2.0)));
+
+	/*
+	 * The summaries of all the index's columns go into one BRIN tuple, which
+	 * is not toasted, so each filter only gets its share of the maximum item
+	 * size, less the tuple header and the filter's own header and alignment.
+	 */
+	maxbytes = (BrinMaxItemSize -
+				MAXALIGN(SizeOfBrinTuple + BITMAPLEN(natts * 2))) / natts -
+		MAXALIGN(offsetof(BloomFilter, bitmap));
+	maxbytes = Min(maxbytes, BLOOM_MAX_FILTER_BYTES);
+	nbits = Min(nbits, maxbytes * 8);
+	nbits = ceil(nbits / 8) * 8;
+
+	nhashes = (int) rint(nbits / ndistinct * log(2.0));
+	nhashes = Max(nhashes, 1);
+
+	len = offsetof(BloomFilter, bitmap) + (Size) nbits / 8;
+	filter = (BloomFilter *) palloc0(len);
+	SET_VARSIZE(filter, len);
+	filter->nhashes = (uint16) nhashes;
+	filter->nbits = (uint32) nbits;
+
+	return filter;
+}
+
+/*
+ * Set the bits for the given hash.  Return true if any of them was not set
+ * already.
+ */
+static bool
+bloom_add_hash(BloomFilter *filter, uint32 hash)
+{
+	uint32		h2 = DatumGetUInt32(hash_uint32(hash));
+	bool		updated = false;
+	int			i;
+
+	for (i = 0; i < filter->nhashes; i++)
+	{
+		uint32		bit = (uint32) (((uint64) hash + (uint64) i * h2) %
+									filter->nbits);
+
+		if (!(filter->bitmap[bit / 8] & (1 << (bit % 8))))
+		{
+			filter->bitmap[bit / 8] |= (1 << (bit % 8));
+			updated = true;
+		}
+	}
+
+	return updated;
+}
+
+/*
+ * Are all the bits for the given hash set?
+ */
+static bool
+bloom_contains_hash(BloomFilter *filter, uint32 hash)
+{
+	uint32		h2 = DatumGetUInt32(hash_uint32(hash));
+	int			i;
+
+	for (i = 0; i < filter->nhashes; i++)
+	{
+		uint32		bit = (uint32) (((uint64) hash + (uint64) i * h2) %
+									filter->nbits);
+
+		if (!(filter->bitmap[bit / 8] & (1 << (bit % 8))))
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * Hash a value of the given index column with the opclass' hash function.
+ */
+static uint32
+bloom_get_hash(BrinDesc *bdesc, AttrNumber attno, Oid colloid, Datum value)
+{
+	FmgrInfo   *hashFn;
+
+	hashFn = index_getprocinfo(bdesc->bd_index, attno, BLOOM_HASH_PROCNUM);
+
+	return DatumGetUInt32(FunctionCall1Coll(hashFn, colloid, value));
+}
@@ -0,0 +1,654 @@
+/*
+ * brin_minmax_multi.c
+ *		Implementation of Multi Min/Max opclass for BRIN
+ *
+ * A single min/max interval per page range covers almost the whole domain
+ * when the range holds a few outliers, or values from several clusters that
+ * are not correlated with the physical order of the table.  The "minmax
+ * multi" opclasses instead keep up to MINMAX_MULTI_MAX_RANGES disjoint
+ * intervals per page range, so that the gaps between clusters of values are
+ * not summarized as present.
+ *
+ * The intervals are stored as a single array of the indexed type, holding
+ * the lower and upper bound of each interval in turn, in ascending order.
+ * A new value that doesn't fall into any interval is added as an interval of
+ * its own; when that makes too many, the two adjacent intervals with the
+ * smallest gap between them are merged.  Measuring the gaps takes a
+ * "distance" function for the datatype, support procedure
+ * MINMAX_MULTI_DISTANCE_PROCNUM, which returns the distance between two
+ * values as a float8.
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *	  src/backend/access/brin/brin_minmax_multi.c
+ */
+#include "postgres.h"
+
+#include <float.h>
+#include <math.h>
+
+#include "access/brin_internal.h"
+#include "access/brin_tuple.h"
+#include "access/genam.h"
+#include "access/stratnum.h"
+#include "catalog/pg_amop.h"
+#include "catalog/pg_type.h"
+#include "utils/array.h"
+#include "utils/builtins.h"
+#include "utils/date.h"
+#include "utils/datum.h"
+#include "utils/lsyscache.h"
+#include "utils/rel.h"
+#include "utils/syscache.h"
+#include "utils/timestamp.h"
+
+
+/* support procedure number of the datatype's distance function */
+#define MINMAX_MULTI_DISTANCE_PROCNUM	11
+
+/* maximum number of intervals kept per page range */
+#define MINMAX_MULTI_MAX_RANGES			16
+
+typedef struct MinmaxMultiOpaque
+{
+	TypeCacheEntry *elemtyp;	/* the indexed type */
+	Oid			cached_subtype;
+	FmgrInfo	strategy_procinfos[BTMaxStrategyNumber];
+} MinmaxMultiOpaque;
+
+static FmgrInfo *minmax_multi_get_strategy_procinfo(BrinDesc *bdesc,
+								   uint16 attno, Oid subtype,
+								   uint16 strategynum);
+static Datum *minmax_multi_deconstruct(MinmaxMultiOpaque *opaque, Datum value,
+						 int *nvalues);
+static Datum minmax_multi_construct(MinmaxMultiOpaque *opaque, Datum *values,
+					   int nvalues);
+static void minmax_multi_reduce(BrinDesc *bdesc, AttrNumber attno,
+					Oid colloid, Datum *values, int *nvalues);
+
+
+Datum
+brin_minmax_multi_opcinfo(PG_FUNCTION_ARGS)
+{
+	Oid			typoid = PG_GETARG_OID(0);
+	Oid			arraytypoid = get_array_type(typoid);
+	BrinOpcInfo *result;
+	MinmaxMultiOpaque *opaque;
+
+	if (!OidIsValid(arraytypoid))
+		elog(ERROR, "could not find array type for data type %s",
+			 format_type_be(typoid));
+
+	/*
+	 * opaque->strategy_procinfos is initialized lazily; here it is set to
+	 * all-uninitialized by palloc0 which sets fn_oid to InvalidOid.
+	 */
+	result = palloc0(MAXALIGN(SizeofBrinOpcInfo(1)) +
+					 sizeof(MinmaxMultiOpaque));
+	result->oi_nstored = 1;
+	result->oi_opaque = opaque = (MinmaxMultiOpaque *)
+		MAXALIGN((char *) result + SizeofBrinOpcInfo(1));
+	result->oi_typcache[0] = lookup_type_cache(arraytypoid, 0);
+	opaque->elemtyp = lookup_type_cache(typoid, 0);
+
+	PG_RETURN_POINTER(result);
+}
+
+/*
+ * Examine the given index tuple (which contains partial status of a certain
+ * page range) by comparing it to the given value that comes from another heap
+ * tuple.  If the new value is outside all the intervals of the existing
+ * tuple, add it as an interval of its own, merging intervals if there are
+ * too many, and return true.  Otherwise, return false and do not modify in
+ * this case.
+ */
+Datum
+brin_minmax_multi_add_value(PG_FUNCTION_ARGS)
+{
+	BrinDesc   *bdesc = (BrinDesc *) PG_GETARG_POINTER(0);
+	BrinValues *column = (BrinValues *) PG_GETARG_POINTER(1);
+	Datum		newval = PG_GETARG_DATUM(2);
+	bool		isnull = PG_GETARG_DATUM(3);
+	Oid			colloid = PG_GET_COLLATION();
+	AttrNumber	attno = column->bv_attno;
+	MinmaxMultiOpaque *opaque;
+	Datum	   *values;
+	Datum	   *newvalues;
+	int			nvalues;
+	int			lo,
+				hi;
+	FmgrInfo   *ltFn;
+	FmgrInfo   *gtFn;
+
+	/*
+	 * If the new value is null, we record that we saw it if it's the first
+	 * one; otherwise, there's nothing to do.
+	 */
+	if (isnull)
+	{
+		if (column->bv_hasnulls)
+			PG_RETURN_BOOL(false);
+
+		column->bv_hasnulls = true;
+		PG_RETURN_BOOL(true);
+	}
+
+	opaque = (MinmaxMultiOpaque *) bdesc->bd_info[attno - 1]->oi_opaque;
+
+	/*
+	 * If the recorded value is null, store the new value (which we know to be
+	 * not null) as a single interval, and we're done.
+	 */
+	if (column->bv_allnulls)
+	{
+		Datum		single[2];
+
+		single[0] = single[1] = newval;
+		column->bv_values[0] = minmax_multi_construct(opaque, single, 2);
+		column->bv_allnulls = false;
+		PG_RETURN_BOOL(true);
+	}
+
+	values = minmax_multi_deconstruct(opaque, column->bv_values[0], &nvalues);
+
+	/*
+	 * Binary search for the first interval whose upper bound is not less
+	 * than the new value; the value is covered if that interval's lower
+	 * bound is not greater than it.
+	 */
+	ltFn = minmax_multi_get_strategy_procinfo(bdesc, attno,
+											  opaque->elemtyp->type_id,
+											  BTLessStrategyNumber);
+	gtFn = minmax_multi_get_strategy_procinfo(bdesc, attno,
+											  opaque->elemtyp->type_id,
+											  BTGreaterStrategyNumber);
+	lo = 0;
+	hi = nvalues / 2;
+	while (lo < hi)
+	{
+		int			mid = (lo + hi) / 2;
+
+		if (DatumGetBool(FunctionCall2Coll(ltFn, colloid,
+										   values[2 * mid + 1], newval)))
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	if (lo < nvalues / 2 &&
+		!DatumGetBool(FunctionCall2Coll(gtFn, colloid, values[2 * lo], newval)))
+	{
+		pfree(values);
+		PG_RETURN_BOOL(false);
+	}
+
+	/* Insert [newval, newval] as interval number lo */
+	newvalues = (Datum *) palloc((nvalues + 2) * sizeof(Datum));
+	memcpy(newvalues, values, 2 * lo * sizeof(Datum));
+	newvalues[2 * lo] = newvalues[2 * lo + 1] = newval;
+	memcpy(newvalues + 2 * lo + 2, values + 2 * lo,
+		   (nvalues - 2 * lo) * sizeof(Datum));
+	nvalues += 2;
+
+	minmax_multi_reduce(bdesc, attno, colloid, newvalues, &nvalues);
+
+	/* the values point into the old array, so build the new one first */
+	column->bv_values[0] = minmax_multi_construct(opaque, newvalues, nvalues);
+
+	pfree(newvalues);
+	pfree(values);
+
+	PG_RETURN_BOOL(true);
+}
+
+/*
+ * Given an index tuple corresponding to a certain page range and a scan key,
+ * return whether the scan key is consistent with the index tuple's intervals.
+ * Return true if so, false otherwise.
+ */
+Datum
+brin_minmax_multi_consistent(PG_FUNCTION_ARGS)
+{
+	BrinDesc   *bdesc = (BrinDesc *) PG_GETARG_POINTER(0);
+	BrinValues *column = (BrinValues *) PG_GETARG_POINTER(1);
+	ScanKey		key = (ScanKey) PG_GETARG_POINTER(2);
+	Oid			colloid = PG_GET_COLLATION(),
+				subtype;
+	AttrNumber	attno;
+	MinmaxMultiOpaque *opaque;
+	Datum	   *values;
+	int			nvalues;
+	int			i;
+	Datum		value;
+	Datum		matches;
+	FmgrInfo   *finfo;
+
+	Assert(key->sk_attno == column->bv_attno);
+
+	/* handle IS NULL/IS NOT NULL tests */
+	if (key->sk_flags & SK_ISNULL)
+	{
+		if (key->sk_flags & SK_SEARCHNULL)
+		{
+			if (column->bv_allnulls || column->bv_hasnulls)
+				PG_RETURN_BOOL(true);
+			PG_RETURN_BOOL(false);
+		}
+
+		/*
+		 * For IS NOT NULL, we can only skip ranges that are known to have
+		 * only nulls.
+		 */
+		if (key->sk_flags & SK_SEARCHNOTNULL)
+			PG_RETURN_BOOL(!column->bv_allnulls);
+
+		/*
+		 * Neither IS NULL nor IS NOT NULL was used; assume all indexable
+		 * operators are strict and return false.
+		 */
+		PG_RETURN_BOOL(false);
+	}
+
+	/* if the range is all empty, it cannot possibly be consistent */
+	if (column->bv_allnulls)
+		PG_RETURN_BOOL(false);
+
+	attno = key->sk_attno;
+	subtype = key->sk_subtype;
+	value = key->sk_argument;
+	opaque = (MinmaxMultiOpaque *) bdesc->bd_info[attno - 1]->oi_opaque;
+	values = minmax_multi_deconstruct(opaque, column->bv_values[0], &nvalues);
+
+	switch (key->sk_strategy)
+	{
+		case BTLessStrategyNumber:
+		case BTLessEqualStrategyNumber:
+			/* only the overall minimum matters */
+			finfo = minmax_multi_get_strategy_procinfo(bdesc, attno, subtype,
+													   key->sk_strategy);
+			matches = FunctionCall2Coll(finfo, colloid, values[0], value);
+			break;
+		case BTEqualStrategyNumber:
+
+			/*
+			 * In the equality case (WHERE col = someval), we want to return
+			 * the current page range if any of its intervals has minimum <=
+			 * scan key and maximum >= scan key.
+			 */
+			matches = BoolGetDatum(false);
+			for (i = 0; i < nvalues; i += 2)
+			{
+				finfo = minmax_multi_get_strategy_procinfo(bdesc, attno, subtype,
+														   BTLessEqualStrategyNumber);
+				if (!DatumGetBool(FunctionCall2Coll(finfo, colloid,
+													values[i], value)))
+					break;		/* this and later intervals are above it */
+				finfo = minmax_multi_get_strategy_procinfo(bdesc, attno, subtype,
+														   BTGreaterEqualStrategyNumber);
+				matches = FunctionCall2Coll(finfo, colloid, values[i + 1],
+											value);
+				if (DatumGetBool(matches))
+					break;
+			}
+			break;
+		case BTGreaterEqualStrategyNumber:
+		case BTGreaterStrategyNumber:
+			/* only the overall maximum matters */
+			finfo = minmax_multi_get_strategy_procinfo(bdesc, attno, subtype,
+													   key->sk_strategy);
+			matches = FunctionCall2Coll(finfo, colloid, values[nvalues - 1],
+										value);
+			break;
+		default:
+			/* shouldn't happen */
+			elog(ERROR, "invalid strategy number %d", key->sk_strategy);
+			matches = 0;
+			break;
+	}
+
+	pfree(values);
+
+	PG_RETURN_DATUM(matches);
+}
+
+/*
+ * Given two BrinValues, update the first of them as a union of the summary
+ * values contained in both.  The second one is untouched.
+ */
+Datum
+brin_minmax_multi_union(PG_FUNCTION_ARGS)
+{
+	BrinDesc   *bdesc = (BrinDesc *) PG_GETARG_POINTER(0);
+	BrinValues *col_a = (BrinValues *) PG_GETARG_POINTER(1);
+	BrinValues *col_b = (BrinValues *) PG_GETARG_POINTER(2);
+	Oid			colloid = PG_GET_COLLATION();
+	AttrNumber	attno;
+	MinmaxMultiOpaque *opaque;
+	Datum	   *values_a;
+	Datum	   *values_b;
+	Datum	   *merged;
+	int			nvalues_a,
+				nvalues_b,
+				nmerged,
+				ia,
+				ib;
+	FmgrInfo   *ltFn;
+	FmgrInfo   *gtFn;
+
+	Assert(col_a->bv_attno == col_b->bv_attno);
+
+	/* Adjust "hasnulls" */
+	if (!col_a->bv_hasnulls && col_b->bv_hasnulls)
+		col_a->bv_hasnulls = true;
+
+	/* If there are no values in B, there's nothing left to do */
+	if (col_b->bv_allnulls)
+		PG_RETURN_VOID();
+
+	attno = col_a->bv_attno;
+	opaque = (MinmaxMultiOpaque *) bdesc->bd_info[attno - 1]->oi_opaque;
+
+	/*
+	 * Adjust "allnulls".  If A doesn't have values, just copy the values from
+	 * B into A, and we're done.  We cannot run the operators in this case,
+	 * because values in A might contain garbage.  Note we already established
+	 * that B contains values.
+	 */
+	if (col_a->bv_allnulls)
+	{
+		TypeCacheEntry *arraytyp = bdesc->bd_info[attno - 1]->oi_typcache[0];
+
+		col_a->bv_allnulls = false;
+		col_a->bv_values[0] = datumCopy(col_b->bv_values[0],
+										arraytyp->typbyval, arraytyp->typlen);
+		PG_RETURN_VOID();
+	}
+
+	values_a = minmax_multi_deconstruct(opaque, col_a->bv_values[0],
+										&nvalues_a);
+	values_b = minmax_multi_deconstruct(opaque, col_b->bv_values[0],
+										&nvalues_b);
+
+	ltFn = minmax_multi_get_strategy_procinfo(bdesc, attno,
+											  opaque->elemtyp->type_id,
+											  BTLessStrategyNumber);
+	gtFn = minmax_multi_get_strategy_procinfo(bdesc, attno,
+											  opaque->elemtyp->type_id,
+											  BTGreaterStrategyNumber);
+
+	/*
+	 * Merge the two sorted lists of intervals by lower bound, coalescing any
+	 * that overlap.
+	 */
+	merged = (Datum *) palloc((nvalues_a + nvalues_b) * sizeof(Datum));
+	nmerged = 0;
+	ia = ib = 0;
+	while (ia < nvalues_a || ib < nvalues_b)
+	{
+		Datum	   *next;
+
+		if (ib >= nvalues_b ||
+			(ia < nvalues_a &&
+			 !DatumGetBool(FunctionCall2Coll(ltFn, colloid,
+											 values_b[ib], values_a[ia]))))
+		{
+			next = &values_a[ia];
+			ia += 2;
+		}
+		else
+		{
+			next = &values_b[ib];
+			ib += 2;
+		}
+
+		if (nmerged > 0 &&
+			!DatumGetBool(FunctionCall2Coll(gtFn, colloid,
+											next[0], merged[nmerged - 1])))
+		{
+			/* overlaps the last interval, so extend that one */
+			if (DatumGetBool(FunctionCall2Coll(gtFn, colloid,
+											   next[1], merged[nmerged - 1])))
+				merged[nmerged - 1] = next[1];
+		}
+		else
+		{
+			merged[nmerged++] = next[0];
+			merged[nmerged++] = next[1];
+		}
+	}
+
+	minmax_multi_reduce(bdesc, attno, colloid, merged, &nmerged);
+
+	/* the values point into the old arrays, so build the new one first */
+	col_a->bv_values[0] = minmax_multi_construct(opaque, merged, nmerged);
+
+	pfree(merged);
+	pfree(values_a);
+	pfree(values_b);
+
+	PG_RETURN_VOID();
+}
+
+/*
+ * Merge the closest adjacent intervals in values[] until there are no more
+ * than MINMAX_MULTI_MAX_RANGES of them.
+ */
+static void
+minmax_multi_reduce(BrinDesc *bdesc, AttrNumber attno, Oid colloid,
+					Datum *values, int *nvalues)
+{
+	FmgrInfo   *distFn = NULL;
+
+	while (*nvalues > 2 * MINMAX_MULTI_MAX_RANGES)
+	{
+		int			best = 0;
+		double		bestdist = DBL_MAX;
+		int			i;
+
+		if (distFn == NULL)
+			distFn = index_getprocinfo(bdesc->bd_index, attno,
+									   MINMAX_MULTI_DISTANCE_PROCNUM);
+
+		/* find the smallest gap, between intervals i and i + 1 */
+		for (i = 0; i < *nvalues / 2 - 1; i++)
+		{
+			double		dist;
+
+			dist = DatumGetFloat8(FunctionCall2Coll(distFn, colloid,
+													values[2 * i + 1],
+													values[2 * i + 2]));
+			if (dist < bestdist)
+			{
+				best = i;
+				bestdist = dist;
+			}
+		}
+
+		/* merge them: drop the upper bound of one, lower bound of the other */
+		memmove(&values[2 * best + 1], &values[2 * best + 3],
+				(*nvalues - 2 * best - 3) * sizeof(Datum));
+		*nvalues -= 2;
+	}
+}
+
+/*
+ * Extract the bounds stored in a summary array.  The result is palloc'd,
+ * but pass-by-reference values point into the array.
+ */
+static Datum *
+minmax_multi_deconstruct(MinmaxMultiOpaque *opaque, Datum value, int *nvalues)
+{
+	TypeCacheEntry *elemtyp = opaque->elemtyp;
+	Datum	   *values;
+
+	deconstruct_array(DatumGetArrayTypeP(value),
+					  elemtyp->type_id, elemtyp->typlen, elemtyp->typbyval,
+					  elemtyp->typalign, &values, NULL, nvalues);
+
+	Assert(*nvalues > 0 && *nvalues % 2 == 0);
+
+	return values;
+}
+
+/*
+ * Build a summary array out of the given bounds.
+ */
+static Datum
+minmax_multi_construct(MinmaxMultiOpaque *opaque, Datum *values, int nvalues)
+{
+	TypeCacheEntry *elemtyp = opaque->elemtyp;
+
+	return PointerGetDatum(construct_array(values, nvalues, elemtyp->type_id,
+										   elemtyp->typlen, elemtyp->typbyval,
+										   elemtyp->typalign));
+}
+
+/*
+ * Cache and return the procedure for the given strategy.
+ *
+ * Note: this function mirrors minmax_get_strategy_procinfo; see notes there.
+ * If changes are made here, see that function too.
+ */
+static FmgrInfo *
+minmax_multi_get_strategy_procinfo(BrinDesc *bdesc, uint16 attno, Oid subtype,
+								   uint16 strategynum)
+{
+	MinmaxMultiOpaque *opaque;
+
+	Assert(strategynum >= 1 &&
+		   strategynum <= BTMaxStrategyNumber);
+
+	opaque = (MinmaxMultiOpaque *) bdesc->bd_info[attno - 1]->oi_opaque;
+
+	/*
+	 * We cache the procedures for the previous subtype in the opaque struct,
+	 * to avoid repetitive syscache lookups.  If the subtype changed,
+	 * invalidate all the cached entries.
+	 */
+	if (opaque->cached_subtype != subtype)
+	{
+		uint16		i;
+
+		for (i = 1; i <= BTMaxStrategyNumber; i++)
+			opaque->strategy_procinfos[i - 1].fn_oid = InvalidOid;
+		opaque->cached_subtype = subtype;
+	}
+
+	if (opaque->strategy_procinfos[strategynum - 1].fn_oid == InvalidOid)
+	{
+		Form_pg_attribute attr;
+		HeapTuple	tuple;
+		Oid			opfamily,
+					oprid;
+		bool		isNull;
+
+		opfamily = bdesc->bd_index->rd_opfamily[attno - 1];
+		attr = bdesc->bd_tupdesc->attrs[attno - 1];
+		tuple = SearchSysCache4(AMOPSTRATEGY, ObjectIdGetDatum(opfamily),
+								ObjectIdGetDatum(attr->atttypid),
+								ObjectIdGetDatum(subtype),
+								Int16GetDatum(strategynum));
+
+		if (!HeapTupleIsValid(tuple))
+			elog(ERROR, "missing operator %d(%u,%u) in opfamily %u",
+				 strategynum, attr->atttypid, subtype, opfamily);
+
+		oprid = DatumGetObjectId(SysCacheGetAttr(AMOPSTRATEGY, tuple,
+												 Anum_pg_amop_amopopr, &isNull));
+		ReleaseSysCache(tuple);
+		Assert(!isNull && RegProcedureIsValid(oprid));
+
+		fmgr_info_cxt(get_opcode(oprid),
+					  &opaque->strategy_procinfos[strategynum - 1],
+					  bdesc->bd_context);
+	}
+
+	return &opaque->strategy_procinfos[strategynum - 1];
+}
+
+/*
+ * Distance functions, support procedure MINMAX_MULTI_DISTANCE_PROCNUM of the
+ * minmax multi opclasses.  Each returns the distance between its two
+ * arguments, the second of which is not less than the first.
+ */
+Datum
+brin_minmax_multi_distance_int2(PG_FUNCTION_ARGS)
+{
+	int16		a = PG_GETARG_INT16(0);
+	int16		b = PG_GETARG_INT16(1);
+
+	PG_RETURN_FLOAT8((double) b - (double) a);
+}
+
+Datum
+brin_minmax_multi_distance_int4(PG_FUNCTION_ARGS)
+{
+	int32		a = PG_GETARG_INT32(0);
+	int32		b = PG_GETARG_INT32(1);
+
+	PG_RETURN_FLOAT8((double) b - (double) a);
+}
+
+Datum
+brin_minmax_multi_distance_int8(PG_FUNCTION_ARGS)
+{
+	int64		a = PG_GETARG_INT64(0);
+	int64		b = PG_GETARG_INT64(1);
+
+	PG_RETURN_FLOAT8((double) b - (double) a);
+}
+
+Datum
+brin_minmax_multi_distance_float4(PG_FUNCTION_ARGS)
+{
+	float4		a = PG_GETARG_FLOAT4(0);
+	float4		b = PG_GETARG_FLOAT4(1);
+
+	/* NaN sorts above everything, infinitely far from any number */
+	if (isnan(a) || isnan(b))
+		PG_RETURN_FLOAT8(get_float8_infinity());
+
+	PG_RETURN_FLOAT8((double) b - (double) a);
+}
+
+Datum
+brin_minmax_multi_distance_float8(PG_FUNCTION_ARGS)
+{
+	float8		a = PG_GETARG_FLOAT8(0);
+	float8		b = PG_GETARG_FLOAT8(1);
+
+	/* NaN sorts above everything, infinitely far from any number */
+	if (isnan(a) || isnan(b))
+		PG_RETURN_FLOAT8(get_float8_infinity());
+
+	PG_RETURN_FLOAT8(b - a);
+}
+
+Datum
+brin_minmax_multi_distance_date(PG_FUNCTION_ARGS)
+{
+	DateADT		a = PG_GETARG_DATEADT(0);
+	DateADT		b = PG_GETARG_DATEADT(1);
+
+	PG_RETURN_FLOAT8((double) b - (double) a);
+}
+
+Datum
+brin_minmax_multi_distance_timestamp(PG_FUNCTION_ARGS)
+{
+	Timestamp	a = PG_GETARG_TIMESTAMP(0);
+	Timestamp	b = PG_GETARG_TIMESTAMP(1);
+
+	PG_RETURN_FLOAT8((double) b - (double) a);
+}
+
+Datum
+brin_minmax_multi_distance_timestamptz(PG_FUNCTION_ARGS)
+{
+	TimestampTz a = PG_GETARG_TIMESTAMPTZ(0);
+	TimestampTz b = PG_GETARG_TIMESTAMPTZ(1);
+
+	PG_RETURN_FLOAT8((double) b - (double) a);
+}
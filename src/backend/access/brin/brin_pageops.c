@@ -23,16 +23,6 @@
 #include "utils/rel.h"
 
 
-/*
- * Maximum size of an entry in a BRIN_PAGETYPE_REGULAR page.  We can tolerate
- * a single item per page, unlike other index AMs.
- */
-#define BrinMaxItemSize \
-	MAXALIGN_DOWN(BLCKSZ - \
-				  (MAXALIGN(SizeOfPageHeaderData + \
-							sizeof(ItemIdData)) + \
-				   MAXALIGN(sizeof(BrinSpecialSpace))))
-
 static Buffer brin_getinsertbuffer(Relation irel, Buffer oldbuf, Size itemsz,
 					 bool *extended);
 static Size br_page_get_freespace(Page page);
@@ -1019,6 +1019,42 @@ heap_deform_tuple(HeapTuple tuple, TupleDesc tupleDesc,
 	}
 }
 
+/*
+ * tupdesc_fixed_prefix
+ *		Return the number of leading attributes of tupleDesc that are fixed
+ *		width, setting their attcacheoff on the first call.
+ *
+ * Until the first NULL, those attributes sit at the same offset in every
+ * tuple of the descriptor, so the deform loop can fetch them without
+ * looking at attlen, alignment or attcacheoff validity each time.  The
+ * count is cached in the descriptor; anything that changes an attribute
+ * resets it to -1 (see tupdesc.c).
+ */
+static inline int
+tupdesc_fixed_prefix(TupleDesc tupleDesc)
+{
+	if (tupleDesc->tdnfixed < 0)
+	{
+		Form_pg_attribute *att = tupleDesc->attrs;
+		long		off = 0;
+		int			attnum;
+
+		for (attnum = 0; attnum < tupleDesc->natts; attnum++)
+		{
+			Form_pg_attribute thisatt = att[attnum];
+
+			if (thisatt->attlen <= 0)
+				break;
+			off = att_align_nominal(off, thisatt->attalign);
+			thisatt->attcacheoff = off;
+			off += thisatt->attlen;
+		}
+		tupleDesc->tdnfixed = attnum;
+	}
+
+	return tupleDesc->tdnfixed;
+}
+
 /*
  * slot_deform_tuple
  *		Given a TupleTableSlot, extract data from the slot's physical tuple
@@ -1051,11 +1087,41 @@ slot_deform_tuple(TupleTableSlot *slot, int natts)
 	 * loop state.
 	 */
 	attnum = slot->tts_nvalid;
+	tp = (char *) tup + tup->t_hoff;
+
 	if (attnum == 0)
 	{
+		int			nfixed = Min(natts, tupdesc_fixed_prefix(tupleDesc));
+
 		/* Start from the first attribute */
 		off = 0;
 		slow = false;
+
+		/* The fixed-width prefix ends early at the first NULL */
+		if (hasnulls)
+		{
+			int			i;
+
+			for (i = 0; i < nfixed; i++)
+			{
+				if (att_isnull(i, bp))
+				{
+					nfixed = i;
+					break;
+				}
+			}
+		}
+
+		/* Fetch the prefix straight from the cached offsets */
+		for (; attnum < nfixed; attnum++)
+		{
+			Form_pg_attribute thisatt = att[attnum];
+
+			values[attnum] = fetchatt(thisatt, tp + thisatt->attcacheoff);
+			isnull[attnum] = false;
+		}
+		if (attnum > 0)
+			off = att[attnum - 1]->attcacheoff + att[attnum - 1]->attlen;
 	}
 	else
 	{
@@ -1064,8 +1130,6 @@ slot_deform_tuple(TupleTableSlot *slot, int natts)
 		slow = slot->tts_slow;
 	}
 
-	tp = (char *) tup + tup->t_hoff;
-
 	for (; attnum < natts; attnum++)
 	{
 		Form_pg_attribute thisatt = att[attnum];
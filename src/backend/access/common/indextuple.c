@@ -441,3 +441,39 @@ CopyIndexTuple(IndexTuple source)
 	memcpy(result, source, size);
 	return result;
 }
+
+/*
+ * Create a palloc'd copy of an index tuple, keeping only its first
+ * leavenatts attributes.
+ *
+ * The result's t_tid is copied from the source, but any AM-specific bits in
+ * t_info are not; the caller must set those up as needed.
+ */
+IndexTuple
+index_truncate_tuple(TupleDesc tupleDescriptor, IndexTuple source,
+					 int leavenatts)
+{
+	TupleDesc	truncdesc;
+	Datum		values[INDEX_MAX_KEYS];
+	bool		isnull[INDEX_MAX_KEYS];
+	IndexTuple	truncated;
+
+	Assert(leavenatts > 0 && leavenatts <= tupleDescriptor->natts);
+
+	/* Easy case: no truncation actually required */
+	if (leavenatts == tupleDescriptor->natts)
+		return CopyIndexTuple(source);
+
+	/* Deform and re-form the prefix using a shortened descriptor */
+	truncdesc = CreateTupleDescCopy(tupleDescriptor);
+	truncdesc->natts = leavenatts;
+
+	index_deform_tuple(source, truncdesc, values, isnull);
+	truncated = index_form_tuple(truncdesc, values, isnull);
+	truncated->t_tid = source->t_tid;
+	Assert(IndexTupleSize(truncated) <= IndexTupleSize(source));
+
+	FreeTupleDesc(truncdesc);
+
+	return truncated;
+}
@@ -93,6 +93,7 @@ CreateTemplateTupleDesc(int natts, bool hasoid)
 	desc->tdtypmod = -1;
 	desc->tdhasoid = hasoid;
 	desc->tdrefcount = -1;		/* assume not reference-counted */
+	desc->tdnfixed = -1;
 
 	return desc;
 }
@@ -126,6 +127,7 @@ CreateTupleDesc(int natts, bool hasoid, Form_pg_attribute *attrs)
 	desc->tdtypmod = -1;
 	desc->tdhasoid = hasoid;
 	desc->tdrefcount = -1;		/* assume not reference-counted */
+	desc->tdnfixed = -1;
 
 	return desc;
 }
@@ -254,6 +256,7 @@ TupleDescCopyEntry(TupleDesc dst, AttrNumber dstAttno,
 	 */
 	dst->attrs[dstAttno - 1]->attnum = dstAttno;
 	dst->attrs[dstAttno - 1]->attcacheoff = -1;
+	dst->tdnfixed = -1;
 
 	/* since we're not copying constraints or defaults, clear these */
 	dst->attrs[dstAttno - 1]->attnotnull = false;
@@ -531,6 +534,7 @@ TupleDescInitEntry(TupleDesc desc,
 
 	att->attstattarget = -1;
 	att->attcacheoff = -1;
+	desc->tdnfixed = -1;
 	att->atttypmod = typmod;
 
 	att->attnum = attributeNumber;
@@ -589,6 +593,7 @@ TupleDescInitBuiltinEntry(TupleDesc desc,
 
 	att->attstattarget = -1;
 	att->attcacheoff = -1;
+	desc->tdnfixed = -1;
 	att->atttypmod = typmod;
 
 	att->attnum = attributeNumber;
@@ -70,6 +70,8 @@ hashhandler(PG_FUNCTION_ARGS)
 	amroutine->amclusterable = false;
 	amroutine->ampredlocks = false;
 	amroutine->amcanparallel = false;
+	amroutine->amcaninclude = false;
+	amroutine->amcanskip = false;
 	amroutine->amkeytype = INT4OID;
 
 	amroutine->ambuild = hashbuild;
@@ -35,6 +35,8 @@
 #include "storage/smgr.h"
 
 
+static bool _hash_expandtable_one(Relation rel, Buffer metabuf,
+					  uint32 nahead);
 static bool _hash_alloc_buckets(Relation rel, BlockNumber firstblock,
 					uint32 nblocks);
 static void _hash_splitbucket(Relation rel, Buffer metabuf,
@@ -608,9 +610,42 @@ _hash_pageinit(Page page, Size size)
 	PageInit(page, size, sizeof(HashPageOpaqueData));
 }
 
+/*
+ * Attempt to expand the hash table.
+ *
+ * The caller has found that a split is due.  Rather than creating just the
+ * one bucket needed right now, we go on splitting a few more buckets ahead
+ * of need, up to HASH_SPLIT_BATCH in all but never more than
+ * 1/HASH_SPLIT_AHEAD_FRACTION of the existing buckets ahead.  The next
+ * several insertions into the index then needn't split anything, so with
+ * many concurrent inserters far fewer of them end up in here, contending
+ * for the metapage lock and for cleanup locks on bucket pages.
+ *
+ * We stop early if a split can't be done because we don't get the locks
+ * needed; the next insertion that finds a split due will try again.
+ *
+ * The caller must hold a pin, but no lock, on the metapage buffer.
+ * The buffer is returned in the same state.
+ */
+void
+_hash_expandtable(Relation rel, Buffer metabuf)
+{
+	uint32		nahead;
+
+	for (nahead = 0; nahead < HASH_SPLIT_BATCH; nahead++)
+	{
+		if (!_hash_expandtable_one(rel, metabuf, nahead))
+			break;
+	}
+}
+
 /*
  * Attempt to expand the hash table by creating one new bucket.
  *
+ * nahead is the number of buckets to create ahead of need: the split is
+ * done if the table would still be over its fill factor with that many
+ * fewer buckets.  Returns true if a bucket was split.
+ *
  * This will silently do nothing if we don't get cleanup lock on old or
  * new bucket.
  *
@@ -620,8 +655,8 @@ _hash_pageinit(Page page, Size size)
  * The caller must hold a pin, but no lock, on the metapage buffer.
  * The buffer is returned in the same state.
  */
-void
-_hash_expandtable(Relation rel, Buffer metabuf)
+static bool
+_hash_expandtable_one(Relation rel, Buffer metabuf, uint32 nahead)
 {
 	HashMetaPage metap;
 	Bucket		old_bucket;
@@ -654,12 +689,16 @@ restart_expand:
 
 	/*
 	 * Check to see if split is still needed; someone else might have already
-	 * done one while we waited for the lock.
+	 * done one while we waited for the lock.  When splitting ahead of need,
+	 * don't get too far ahead.
 	 *
 	 * Make sure this stays in sync with _hash_doinsert()
 	 */
+	if (nahead > (metap->hashm_maxbucket + 1) / HASH_SPLIT_AHEAD_FRACTION)
+		goto fail;
 	if (metap->hashm_ntuples <=
-		(double) metap->hashm_ffactor * (metap->hashm_maxbucket + 1))
+		(double) metap->hashm_ffactor *
+		((double) metap->hashm_maxbucket + 1 - nahead))
 		goto fail;
 
 	/*
@@ -960,13 +999,15 @@ restart_expand:
 	_hash_dropbuf(rel, buf_oblkno);
 	_hash_dropbuf(rel, buf_nblkno);
 
-	return;
+	return true;
 
 	/* Here if decide not to split or fail to acquire old bucket lock */
 fail:
 
 	/* We didn't write the metapage, so just drop lock */
 	LockBuffer(metabuf, BUFFER_LOCK_UNLOCK);
+
+	return false;
 }
 
 
@@ -78,6 +78,20 @@
 /* GUC variable */
 bool		synchronize_seqscans = true;
 
+/*
+ * Parallel heap scans hand out blocks in chunks, so that each worker reads
+ * runs of consecutive blocks and the shared allocation counter is touched
+ * only once per chunk.  We aim for about PARALLEL_SEQSCAN_NCHUNKS chunks per
+ * scan, capped at PARALLEL_SEQSCAN_MAX_CHUNK_SIZE blocks.  Each backend
+ * ramps its chunk size up from a single block, so that short scans and scans
+ * stopped early by a LIMIT don't overshoot, and ramps it back down over the
+ * last PARALLEL_SEQSCAN_RAMPDOWN_CHUNKS chunks, so that workers finish at
+ * about the same time.
+ */
+#define PARALLEL_SEQSCAN_NCHUNKS			2048
+#define PARALLEL_SEQSCAN_RAMPDOWN_CHUNKS	64
+#define PARALLEL_SEQSCAN_MAX_CHUNK_SIZE		8192
+
 
 static HeapScanDesc heap_beginscan_internal(Relation relation,
 						Snapshot snapshot,
@@ -270,6 +284,12 @@ initscan(HeapScanDesc scan, ScanKey key, bool keep_startblock)
 	{
 		/* For parallel scan, believe whatever ParallelHeapScanDesc says. */
 		scan->rs_syncscan = scan->rs_parallel->phs_syncscan;
+
+		/* This backend hasn't been allocated any blocks yet. */
+		scan->rs_chunk_size = 0;
+		scan->rs_chunk_maxsize = 0;
+		scan->rs_chunk_remaining = 0;
+		scan->rs_nallocated = 0;
 	}
 	else if (keep_startblock)
 	{
@@ -1593,8 +1613,14 @@ heap_endscan(HeapScanDesc scan)
 Size
 heap_parallelscan_estimate(Snapshot snapshot)
 {
-	return add_size(offsetof(ParallelHeapScanDescData, phs_snapshot_data),
-					EstimateSnapshotSpace(snapshot));
+	Size		sz = offsetof(ParallelHeapScanDescData, phs_snapshot_data);
+
+	if (IsMVCCSnapshot(snapshot))
+		sz = add_size(sz, EstimateSnapshotSpace(snapshot));
+	else
+		Assert(snapshot == SnapshotAny);
+
+	return sz;
 }
 
 /* ----------------
@@ -1616,9 +1642,19 @@ heap_parallelscan_initialize(ParallelHeapScanDesc target, Relation relation,
 		!RelationUsesLocalBuffers(relation) &&
 		target->phs_nblocks > NBuffers / 4;
 	SpinLockInit(&target->phs_mutex);
-	target->phs_cblock = InvalidBlockNumber;
 	target->phs_startblock = InvalidBlockNumber;
-	SerializeSnapshot(snapshot, target->phs_snapshot_data);
+	pg_atomic_init_u64(&target->phs_nallocated, 0);
+	if (IsMVCCSnapshot(snapshot))
+	{
+		SerializeSnapshot(snapshot, target->phs_snapshot_data);
+		target->phs_snapshot_any = false;
+	}
+	else
+	{
+		/* SnapshotAny needs no serialization; used by index builds */
+		Assert(snapshot == SnapshotAny);
+		target->phs_snapshot_any = true;
+	}
 }
 
 /* ----------------
@@ -1631,13 +1667,7 @@ heap_parallelscan_initialize(ParallelHeapScanDesc target, Relation relation,
 void
 heap_parallelscan_reinitialize(ParallelHeapScanDesc parallel_scan)
 {
-	/*
-	 * It shouldn't be necessary to acquire the mutex here, but we do it
-	 * anyway, just to be tidy.
-	 */
-	SpinLockAcquire(&parallel_scan->phs_mutex);
-	parallel_scan->phs_cblock = parallel_scan->phs_startblock;
-	SpinLockRelease(&parallel_scan->phs_mutex);
+	pg_atomic_write_u64(&parallel_scan->phs_nallocated, 0);
 }
 
 /* ----------------
@@ -1652,29 +1682,33 @@ heap_beginscan_parallel(Relation relation, ParallelHeapScanDesc parallel_scan)
 	Snapshot	snapshot;
 
 	Assert(RelationGetRelid(relation) == parallel_scan->phs_relid);
-	snapshot = RestoreSnapshot(parallel_scan->phs_snapshot_data);
-	RegisterSnapshot(snapshot);
+	if (!parallel_scan->phs_snapshot_any)
+	{
+		snapshot = RestoreSnapshot(parallel_scan->phs_snapshot_data);
+		RegisterSnapshot(snapshot);
+	}
+	else
+		snapshot = SnapshotAny;
 
 	return heap_beginscan_internal(relation, snapshot, 0, NULL, parallel_scan,
-								   true, true, true, false, false, true);
+								   true, true, true, false, false,
+								   !parallel_scan->phs_snapshot_any);
 }
 
 /* ----------------
- *		heap_parallelscan_nextpage - get the next page to scan
+ *		heap_parallelscan_startblock_init - join the block allocation
  *
- *		Get the next page to scan.  Even if there are no pages left to scan,
- *		another backend could have grabbed a page to scan and not yet finished
- *		looking at it, so it doesn't follow that the scan is done when the
- *		first backend gets an InvalidBlockNumber return.
+ *		Determine where the parallel seq scan should start, if nobody has
+ *		done so yet, and size this backend's chunks for it.  This is done
+ *		once per backend per scan, by its first heap_parallelscan_nextpage.
  * ----------------
  */
-static BlockNumber
-heap_parallelscan_nextpage(HeapScanDesc scan)
+static void
+heap_parallelscan_startblock_init(HeapScanDesc scan)
 {
-	BlockNumber page = InvalidBlockNumber;
 	BlockNumber sync_startpage = InvalidBlockNumber;
-	BlockNumber report_page = InvalidBlockNumber;
 	ParallelHeapScanDesc parallel_scan;
+	uint32		maxsize;
 
 	Assert(scan->rs_parallel);
 	parallel_scan = scan->rs_parallel;
@@ -1705,46 +1739,109 @@ retry:
 			sync_startpage = ss_get_location(scan->rs_rd, scan->rs_nblocks);
 			goto retry;
 		}
-		parallel_scan->phs_cblock = parallel_scan->phs_startblock;
 	}
 
+	/* Release the lock. */
+	SpinLockRelease(&parallel_scan->phs_mutex);
+
 	/*
-	 * The current block number is the next one that needs to be scanned,
-	 * unless it's InvalidBlockNumber already, in which case there are no more
-	 * blocks to scan.  After remembering the current value, we must advance
-	 * it so that the next call to this function returns the next block to be
-	 * scanned.
+	 * The largest chunk is the smallest power of two that splits the
+	 * relation into no more than PARALLEL_SEQSCAN_NCHUNKS chunks, but we
+	 * don't let it grow past PARALLEL_SEQSCAN_MAX_CHUNK_SIZE.  Start at a
+	 * single block and ramp up from there.
 	 */
-	page = parallel_scan->phs_cblock;
-	if (page != InvalidBlockNumber)
+	maxsize = 1;
+	while (maxsize < PARALLEL_SEQSCAN_MAX_CHUNK_SIZE &&
+		   maxsize < parallel_scan->phs_nblocks / PARALLEL_SEQSCAN_NCHUNKS)
+		maxsize <<= 1;
+
+	scan->rs_chunk_maxsize = maxsize;
+	scan->rs_chunk_size = 1;
+	scan->rs_chunk_remaining = 0;
+}
+
+/* ----------------
+ *		heap_parallelscan_nextpage - get the next page to scan
+ *
+ *		Get the next page to scan.  Even if there are no pages left to scan,
+ *		another backend could have grabbed a page to scan and not yet finished
+ *		looking at it, so it doesn't follow that the scan is done when the
+ *		first backend gets an InvalidBlockNumber return.
+ *
+ *		Blocks are taken from the shared counter a chunk at a time and then
+ *		handed out from the chunk without touching shared state.
+ * ----------------
+ */
+static BlockNumber
+heap_parallelscan_nextpage(HeapScanDesc scan)
+{
+	BlockNumber page;
+	ParallelHeapScanDesc parallel_scan;
+	uint64		nallocated;
+
+	Assert(scan->rs_parallel);
+	parallel_scan = scan->rs_parallel;
+
+	if (scan->rs_chunk_size == 0)
+		heap_parallelscan_startblock_init(scan);
+
+	if (scan->rs_chunk_remaining > 0)
+	{
+		/* Take the next block of the chunk we already own. */
+		scan->rs_chunk_remaining--;
+		nallocated = ++scan->rs_nallocated;
+	}
+	else
 	{
-		parallel_scan->phs_cblock++;
-		if (parallel_scan->phs_cblock >= scan->rs_nblocks)
-			parallel_scan->phs_cblock = 0;
-		if (parallel_scan->phs_cblock == parallel_scan->phs_startblock)
+		/*
+		 * Size the next chunk.  Once fewer than PARALLEL_SEQSCAN_RAMPDOWN_CHUNKS
+		 * chunks of the current size remain, halve it (possibly repeatedly)
+		 * so that the tail of the scan is spread evenly across workers;
+		 * otherwise keep doubling it until it reaches rs_chunk_maxsize.  Our
+		 * idea of how far the scan has got is only as fresh as our last
+		 * allocation, which is good enough for this purpose.
+		 */
+		if (scan->rs_nallocated + (uint64) scan->rs_chunk_size *
+			PARALLEL_SEQSCAN_RAMPDOWN_CHUNKS > parallel_scan->phs_nblocks)
 		{
-			parallel_scan->phs_cblock = InvalidBlockNumber;
-			report_page = parallel_scan->phs_startblock;
+			while (scan->rs_chunk_size > 1 &&
+				   scan->rs_nallocated + (uint64) scan->rs_chunk_size *
+				   PARALLEL_SEQSCAN_RAMPDOWN_CHUNKS > parallel_scan->phs_nblocks)
+				scan->rs_chunk_size >>= 1;
 		}
+		else if (scan->rs_chunk_size < scan->rs_chunk_maxsize)
+			scan->rs_chunk_size <<= 1;
+
+		nallocated = pg_atomic_fetch_add_u64(&parallel_scan->phs_nallocated,
+											 scan->rs_chunk_size);
+		scan->rs_nallocated = nallocated;
+		scan->rs_chunk_remaining = scan->rs_chunk_size - 1;
 	}
 
-	/* Release the lock. */
-	SpinLockRelease(&parallel_scan->phs_mutex);
+	if (nallocated >= parallel_scan->phs_nblocks)
+	{
+		/* All blocks have been allocated; forget the rest of the chunk. */
+		page = InvalidBlockNumber;
+		scan->rs_chunk_remaining = 0;
+	}
+	else
+		page = (nallocated + parallel_scan->phs_startblock) %
+			parallel_scan->phs_nblocks;
 
 	/*
 	 * Report scan location.  Normally, we report the current page number.
 	 * When we reach the end of the scan, though, we report the starting page,
 	 * not the ending page, just so the starting positions for later scans
 	 * doesn't slew backwards.  We only report the position at the end of the
-	 * scan once, though: subsequent callers will have report nothing, since
-	 * they will have page == InvalidBlockNumber.
+	 * scan once, though: only the backend that is handed the block just past
+	 * the end does so.
 	 */
 	if (scan->rs_syncscan)
 	{
-		if (report_page == InvalidBlockNumber)
-			report_page = page;
-		if (report_page != InvalidBlockNumber)
-			ss_report_location(scan->rs_rd, report_page);
+		if (page != InvalidBlockNumber)
+			ss_report_location(scan->rs_rd, page);
+		else if (nallocated == parallel_scan->phs_nblocks)
+			ss_report_location(scan->rs_rd, parallel_scan->phs_startblock);
 	}
 
 	return page;
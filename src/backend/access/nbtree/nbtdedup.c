@@ -0,0 +1,362 @@
+/*-------------------------------------------------------------------------
+ *
+ * nbtdedup.c
+ *	  Merge duplicate leaf tuples into posting list tuples.
+ *
+ * NOTES
+ *
+ * When an insertion finds no room on a leaf page, we try merging each run
+ * of tuples with bitwise identical keys into a single posting list tuple
+ * before resorting to a page split.  That way an index with many duplicates
+ * stores each key only once per run, which keeps low-cardinality indexes
+ * small and makes scans of them read fewer pages.
+ *
+ * Keys are compared by their binary image rather than with the opclass's
+ * comparison function.  Tuples that compare equal but are not bitwise
+ * identical (say, numeric values with different display scales) are simply
+ * not merged, which is always safe.  Since duplicates are not kept in any
+ * particular order here, a posting list can hold any subset of the heap TIDs
+ * for its key, and we never need to split one on insertion.
+ *
+ * Unique indexes are not deduplicated: their duplicates are short-lived
+ * row versions that vacuuming the page gets rid of anyway, and the
+ * uniqueness check looks at one heap TID per index tuple.
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *	  src/backend/access/nbtree/nbtdedup.c
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include "access/nbtree.h"
+#include "access/nbtxlog.h"
+#include "access/xloginsert.h"
+#include "miscadmin.h"
+#include "utils/rel.h"
+
+
+static Size _bt_dedup_keysize(IndexTuple itup);
+static bool _bt_dedup_keys_equal(IndexTuple itup1, IndexTuple itup2);
+static int	_bt_itemptr_cmp(const void *a, const void *b);
+
+
+/*
+ *	_bt_dedup_one_page() -- merge runs of duplicates on a leaf page
+ *
+ * Caller holds a write lock on buf, which must be a leaf page.  Returns
+ * true if anything was merged, in which case the items on the page have
+ * moved and any offsets the caller remembered are no longer valid.
+ */
+bool
+_bt_dedup_one_page(Relation rel, Buffer buf)
+{
+	Page		page = BufferGetPage(buf);
+	BTPageOpaque opaque = (BTPageOpaque) PageGetSpecialPointer(page);
+	OffsetNumber minoff,
+				maxoff,
+				offnum;
+	BTDedupInterval *intervals;
+	int			nintervals = 0;
+	IndexTuple	base = NULL;
+	OffsetNumber baseoff = InvalidOffsetNumber;
+	int			nitems = 0;
+	int			nhtids = 0;
+	Size		maxpostingsize = BTMaxItemSize(page);
+	Page		newpage;
+
+	Assert(P_ISLEAF(opaque));
+
+	if (rel->rd_index->indisunique)
+		return false;
+
+	minoff = P_FIRSTDATAKEY(opaque);
+	maxoff = PageGetMaxOffsetNumber(page);
+	if (maxoff <= minoff)
+		return false;
+
+	/* each interval covers at least two items */
+	intervals = (BTDedupInterval *)
+		palloc((maxoff / 2 + 1) * sizeof(BTDedupInterval));
+
+	for (offnum = minoff; offnum <= maxoff + 1; offnum = OffsetNumberNext(offnum))
+	{
+		ItemId		itemid = NULL;
+		IndexTuple	itup = NULL;
+		int			ntids = 0;
+
+		if (offnum <= maxoff)
+		{
+			itemid = PageGetItemId(page, offnum);
+			itup = (IndexTuple) PageGetItem(page, itemid);
+			ntids = BTreeTupleIsPosting(itup) ? BTreeTupleGetNPosting(itup) : 1;
+
+			/*
+			 * Extend the current run if this item has the same key and the
+			 * merged tuple would still be small enough.  LP_DEAD items are
+			 * left alone, since they'll go away soon anyway.
+			 */
+			if (base != NULL && !ItemIdIsDead(itemid) &&
+				_bt_dedup_keys_equal(base, itup) &&
+				MAXALIGN(_bt_dedup_keysize(base) +
+						 (nhtids + ntids) * sizeof(ItemPointerData)) <= maxpostingsize)
+			{
+				nitems++;
+				nhtids += ntids;
+				continue;
+			}
+		}
+
+		/* close the current run, remembering it if it merges anything */
+		if (nitems > 1)
+		{
+			intervals[nintervals].baseoff = baseoff;
+			intervals[nintervals].nitems = nitems;
+			nintervals++;
+		}
+
+		/* and start a new one at this item, unless it's LP_DEAD */
+		if (itup != NULL && !ItemIdIsDead(itemid))
+		{
+			base = itup;
+			baseoff = offnum;
+			nitems = 1;
+			nhtids = ntids;
+		}
+		else
+		{
+			base = NULL;
+			nitems = 0;
+			nhtids = 0;
+		}
+	}
+
+	if (nintervals == 0)
+	{
+		pfree(intervals);
+		return false;
+	}
+
+	newpage = _bt_dedup_build_page(page, intervals, nintervals);
+
+	/* No ereport(ERROR) until changes are logged */
+	START_CRIT_SECTION();
+
+	PageRestoreTempPage(newpage, page);
+	MarkBufferDirty(buf);
+
+	/* XLOG stuff */
+	if (RelationNeedsWAL(rel))
+	{
+		XLogRecPtr	recptr;
+		xl_btree_dedup xlrec;
+
+		xlrec.nintervals = nintervals;
+
+		XLogBeginInsert();
+		XLogRegisterBuffer(0, buf, REGBUF_STANDARD);
+		XLogRegisterData((char *) &xlrec, SizeOfBtreeDedup);
+		XLogRegisterBufData(0, (char *) intervals,
+							nintervals * sizeof(BTDedupInterval));
+
+		recptr = XLogInsert(RM_BTREE_ID, XLOG_BTREE_DEDUP);
+
+		PageSetLSN(page, recptr);
+	}
+
+	END_CRIT_SECTION();
+
+	pfree(intervals);
+
+	return true;
+}
+
+/*
+ *	_bt_dedup_build_page() -- build a copy of a leaf page with the given
+ *		runs of items merged into posting list tuples
+ *
+ * The intervals must be in offset order.  The result is a temp page for the
+ * caller to install with PageRestoreTempPage.  This is shared with WAL
+ * replay, so the outcome must depend on nothing but the page and the
+ * intervals.
+ */
+Page
+_bt_dedup_build_page(Page page, BTDedupInterval *intervals, int nintervals)
+{
+	BTPageOpaque opaque = (BTPageOpaque) PageGetSpecialPointer(page);
+	Page		newpage = PageGetTempPageCopySpecial(page);
+	ItemPointer htids;
+	OffsetNumber minoff,
+				maxoff,
+				offnum,
+				newoff;
+	int			k = 0;
+
+	htids = (ItemPointer) palloc(MaxTIDsPerBTreePage * sizeof(ItemPointerData));
+
+	minoff = P_FIRSTDATAKEY(opaque);
+	maxoff = PageGetMaxOffsetNumber(page);
+
+	/* the high key, if any, is copied over unchanged */
+	if (!P_RIGHTMOST(opaque))
+	{
+		ItemId		itemid = PageGetItemId(page, P_HIKEY);
+
+		if (PageAddItem(newpage, PageGetItem(page, itemid),
+						ItemIdGetLength(itemid), P_HIKEY,
+						false, false) == InvalidOffsetNumber)
+			elog(ERROR, "failed to add high key to deduplicated index page");
+	}
+
+	newoff = minoff;
+	offnum = minoff;
+	while (offnum <= maxoff)
+	{
+		ItemId		itemid = PageGetItemId(page, offnum);
+		IndexTuple	itup = (IndexTuple) PageGetItem(page, itemid);
+
+		if (k < nintervals && intervals[k].baseoff == offnum)
+		{
+			IndexTuple	posting;
+			int			nhtids = 0;
+			int			i;
+
+			if (offnum + intervals[k].nitems - 1 > maxoff)
+				elog(ERROR, "deduplication interval exceeds index page");
+
+			for (i = 0; i < intervals[k].nitems; i++)
+			{
+				IndexTuple	cur;
+
+				cur = (IndexTuple) PageGetItem(page,
+											   PageGetItemId(page, offnum + i));
+				if (BTreeTupleIsPosting(cur))
+				{
+					int			n = BTreeTupleGetNPosting(cur);
+
+					memcpy(htids + nhtids, BTreeTupleGetPosting(cur),
+						   n * sizeof(ItemPointerData));
+					nhtids += n;
+				}
+				else
+					htids[nhtids++] = cur->t_tid;
+			}
+
+			qsort(htids, nhtids, sizeof(ItemPointerData), _bt_itemptr_cmp);
+			posting = _bt_form_posting(itup, htids, nhtids);
+
+			if (PageAddItem(newpage, (Item) posting, IndexTupleSize(posting),
+							newoff, false, false) == InvalidOffsetNumber)
+				elog(ERROR, "failed to add posting list tuple to index page");
+			pfree(posting);
+
+			offnum += intervals[k].nitems;
+			k++;
+		}
+		else
+		{
+			if (PageAddItem(newpage, (Item) itup, ItemIdGetLength(itemid),
+							newoff, false, false) == InvalidOffsetNumber)
+				elog(ERROR, "failed to add item to deduplicated index page");
+			if (ItemIdIsDead(itemid))
+				ItemIdMarkDead(PageGetItemId(newpage, newoff));
+
+			offnum = OffsetNumberNext(offnum);
+		}
+		newoff = OffsetNumberNext(newoff);
+	}
+
+	if (k != nintervals)
+		elog(ERROR, "deduplication intervals do not match index page");
+
+	pfree(htids);
+
+	return newpage;
+}
+
+/*
+ *	_bt_form_posting() -- form a leaf tuple with base's key and the given
+ *		heap TIDs
+ *
+ * base may be a plain tuple or a posting list tuple; only its key is used.
+ * htids must be sorted.  With a single heap TID, the result is a plain
+ * tuple, which is also how we make a pivot tuple out of a posting list
+ * tuple.  The result is palloc'd.
+ */
+IndexTuple
+_bt_form_posting(IndexTuple base, ItemPointer htids, int nhtids)
+{
+	Size		keysize = _bt_dedup_keysize(base);
+	Size		newsize;
+	IndexTuple	itup;
+
+	Assert(nhtids > 0);
+	Assert(keysize == MAXALIGN(keysize));
+
+	if (nhtids > 1)
+		newsize = MAXALIGN(keysize + nhtids * sizeof(ItemPointerData));
+	else
+		newsize = keysize;
+
+	if (newsize > INDEX_SIZE_MASK)
+		elog(ERROR, "posting list tuple size %zu is too large", newsize);
+
+	itup = (IndexTuple) palloc0(newsize);
+	memcpy(itup, base, keysize);
+	itup->t_info &= ~(INDEX_SIZE_MASK | INDEX_ALT_TID_MASK);
+	itup->t_info |= newsize;
+
+	if (nhtids > 1)
+	{
+		BTreeTupleSetPosting(itup, nhtids, keysize);
+		memcpy(BTreeTupleGetPosting(itup), htids,
+			   nhtids * sizeof(ItemPointerData));
+	}
+	else
+		itup->t_tid = htids[0];
+
+	return itup;
+}
+
+/*
+ * Size of the part of a leaf tuple that holds its key, header included.
+ */
+static Size
+_bt_dedup_keysize(IndexTuple itup)
+{
+	if (BTreeTupleIsPosting(itup))
+		return BTreeTupleGetPostingOffset(itup);
+	return IndexTupleSize(itup);
+}
+
+/*
+ * Do two leaf tuples have bitwise identical keys?
+ */
+static bool
+_bt_dedup_keys_equal(IndexTuple itup1, IndexTuple itup2)
+{
+	Size		keysize = _bt_dedup_keysize(itup1);
+
+	if (keysize != _bt_dedup_keysize(itup2))
+		return false;
+	if ((itup1->t_info & (INDEX_NULL_MASK | INDEX_VAR_MASK)) !=
+		(itup2->t_info & (INDEX_NULL_MASK | INDEX_VAR_MASK)))
+		return false;
+
+	return memcmp((char *) itup1 + sizeof(IndexTupleData),
+				  (char *) itup2 + sizeof(IndexTupleData),
+				  keysize - sizeof(IndexTupleData)) == 0;
+}
+
+/*
+ * qsort comparator for heap TIDs
+ */
+static int
+_bt_itemptr_cmp(const void *a, const void *b)
+{
+	return ItemPointerCompare((ItemPointer) a, (ItemPointer) b);
+}
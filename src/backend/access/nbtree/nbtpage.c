@@ -774,6 +774,9 @@ _bt_page_recyclable(Page page)
  *
  * This routine assumes that the caller has pinned and locked the buffer.
  * Also, the given itemnos *must* appear in increasing order in the array.
+ * updatenos/updated give posting list tuples to replace with the versions
+ * that have the dead heap TIDs taken out; those offsets must not also be
+ * in itemnos.
  *
  * We record VACUUMs and b-tree deletes differently in WAL. InHotStandby
  * we need to be able to pin all of the blocks in the btree in physical
@@ -788,15 +791,48 @@ _bt_page_recyclable(Page page)
 void
 _bt_delitems_vacuum(Relation rel, Buffer buf,
 					OffsetNumber *itemnos, int nitems,
+					OffsetNumber *updatenos, IndexTuple *updated, int nupdated,
 					BlockNumber lastBlockVacuumed)
 {
 	Page		page = BufferGetPage(buf);
 	BTPageOpaque opaque;
+	char	   *updatedbuf = NULL;
+	Size		updatedbuflen = 0;
+	int			i;
+
+	/*
+	 * Gather the replacement tuples into one chunk for WAL, while we can
+	 * still palloc.
+	 */
+	if (nupdated > 0 && RelationNeedsWAL(rel))
+	{
+		for (i = 0; i < nupdated; i++)
+			updatedbuflen += MAXALIGN(IndexTupleSize(updated[i]));
+		updatedbuf = palloc(updatedbuflen);
+		updatedbuflen = 0;
+		for (i = 0; i < nupdated; i++)
+		{
+			Size		itemsz = MAXALIGN(IndexTupleSize(updated[i]));
+
+			memcpy(updatedbuf + updatedbuflen, updated[i], itemsz);
+			updatedbuflen += itemsz;
+		}
+	}
 
 	/* No ereport(ERROR) until changes are logged */
 	START_CRIT_SECTION();
 
-	/* Fix the page */
+	/*
+	 * Fix the page.  Posting list tuples that lost some of their heap TIDs
+	 * are replaced first, since deleting items renumbers the ones after them.
+	 */
+	for (i = 0; i < nupdated; i++)
+	{
+		if (!PageIndexTupleOverwrite(page, updatenos[i], (Item) updated[i],
+									 MAXALIGN(IndexTupleSize(updated[i]))))
+			elog(PANIC, "failed to update partially dead item in block %u of index \"%s\"",
+				 BufferGetBlockNumber(buf), RelationGetRelationName(rel));
+	}
 	if (nitems > 0)
 		PageIndexMultiDelete(page, itemnos, nitems);
 
@@ -825,16 +861,24 @@ _bt_delitems_vacuum(Relation rel, Buffer buf,
 		xl_btree_vacuum xlrec_vacuum;
 
 		xlrec_vacuum.lastBlockVacuumed = lastBlockVacuumed;
+		xlrec_vacuum.ndeleted = nitems;
+		xlrec_vacuum.nupdated = nupdated;
 
 		XLogBeginInsert();
 		XLogRegisterBuffer(0, buf, REGBUF_STANDARD);
 		XLogRegisterData((char *) &xlrec_vacuum, SizeOfBtreeVacuum);
 
 		/*
-		 * The target-offsets array is not in the buffer, but pretend that it
-		 * is.  When XLogInsert stores the whole buffer, the offsets array
-		 * need not be stored too.
+		 * The replacement tuples and the target-offsets arrays are not in the
+		 * buffer, but pretend that they are.  When XLogInsert stores the
+		 * whole buffer, they need not be stored too.
 		 */
+		if (nupdated > 0)
+		{
+			XLogRegisterBufData(0, updatedbuf, updatedbuflen);
+			XLogRegisterBufData(0, (char *) updatenos,
+								nupdated * sizeof(OffsetNumber));
+		}
 		if (nitems > 0)
 			XLogRegisterBufData(0, (char *) itemnos, nitems * sizeof(OffsetNumber));
 
@@ -844,6 +888,9 @@ _bt_delitems_vacuum(Relation rel, Buffer buf,
 	}
 
 	END_CRIT_SECTION();
+
+	if (updatedbuf)
+		pfree(updatedbuf);
 }
 
 /*
@@ -1252,11 +1299,17 @@ _bt_pagedel(Relation rel, Buffer buf)
 					_bt_relbuf(rel, lbuf);
 				}
 
-				/* we need an insertion scan key for the search, so build one */
+				/*
+				 * We need an insertion scan key for the search, so build one.
+				 * The high key may be truncated, in which case we search on
+				 * the attributes it has.
+				 */
 				itup_scankey = _bt_mkscankey(rel, targetkey);
 				/* find the leftmost leaf page containing this key */
-				stack = _bt_search(rel, rel->rd_rel->relnatts, itup_scankey,
-								   false, &lbuf, BT_READ, NULL);
+				stack = _bt_search(rel,
+								   Min(BTreeTupleGetNAtts(targetkey, rel),
+									   IndexRelationGetNumberOfKeyAttributes(rel)),
+								   itup_scankey, false, &lbuf, BT_READ, NULL);
 				/* don't need a pin on the page */
 				_bt_relbuf(rel, lbuf);
 
@@ -1423,7 +1476,7 @@ _bt_mark_page_halfdead(Relation rel, Buffer leafbuf, BTStack stack)
 
 	itemid = PageGetItemId(page, topoff);
 	itup = (IndexTuple) PageGetItem(page, itemid);
-	ItemPointerSet(&(itup->t_tid), rightsib, P_HIKEY);
+	BTreeInnerTupleSetDownLink(itup, rightsib);
 
 	nextoffset = OffsetNumberNext(topoff);
 	PageIndexTupleDelete(page, nextoffset);
@@ -35,22 +35,6 @@
 #include "utils/memutils.h"
 
 
-/* Working state for btbuild and its callback */
-typedef struct
-{
-	bool		isUnique;
-	bool		haveDead;
-	Relation	heapRel;
-	BTSpool    *spool;
-
-	/*
-	 * spool2 is needed only when the index is a unique index. Dead tuples are
-	 * put into spool2 instead of spool in order to avoid uniqueness check.
-	 */
-	BTSpool    *spool2;
-	double		indtuples;
-} BTBuildState;
-
 /* Working state needed by btvacuumpage */
 typedef struct
 {
@@ -104,17 +88,14 @@ typedef struct BTParallelScanDescData
 typedef struct BTParallelScanDescData *BTParallelScanDesc;
 
 
-static void btbuildCallback(Relation index,
-				HeapTuple htup,
-				Datum *values,
-				bool *isnull,
-				bool tupleIsAlive,
-				void *state);
 static void btvacuumscan(IndexVacuumInfo *info, IndexBulkDeleteResult *stats,
 			 IndexBulkDeleteCallback callback, void *callback_state,
 			 BTCycleId cycleid);
 static void btvacuumpage(BTVacState *vstate, BlockNumber blkno,
 			 BlockNumber orig_blkno);
+static IndexTuple btvacuumposting(IndexTuple itup,
+				IndexBulkDeleteCallback callback, void *callback_state,
+				int *nremaining);
 
 
 /*
@@ -140,6 +121,8 @@ bthandler(PG_FUNCTION_ARGS)
 	amroutine->amclusterable = true;
 	amroutine->ampredlocks = true;
 	amroutine->amcanparallel = true;
+	amroutine->amcaninclude = true;
+	amroutine->amcanskip = true;
 	amroutine->amkeytype = InvalidOid;
 
 	amroutine->ambuild = btbuild;
@@ -166,115 +149,6 @@ bthandler(PG_FUNCTION_ARGS)
 	PG_RETURN_POINTER(amroutine);
 }
 
-/*
- *	btbuild() -- build a new btree index.
- */
-IndexBuildResult *
-btbuild(Relation heap, Relation index, IndexInfo *indexInfo)
-{
-	IndexBuildResult *result;
-	double		reltuples;
-	BTBuildState buildstate;
-
-	buildstate.isUnique = indexInfo->ii_Unique;
-	buildstate.haveDead = false;
-	buildstate.heapRel = heap;
-	buildstate.spool = NULL;
-	buildstate.spool2 = NULL;
-	buildstate.indtuples = 0;
-
-#ifdef BTREE_BUILD_STATS
-	if (log_btree_build_stats)
-		ResetUsage();
-#endif							/* BTREE_BUILD_STATS */
-
-	/*
-	 * We expect to be called exactly once for any index relation. If that's
-	 * not the case, big trouble's what we have.
-	 */
-	if (RelationGetNumberOfBlocks(index) != 0)
-		elog(ERROR, "index \"%s\" already contains data",
-			 RelationGetRelationName(index));
-
-	buildstate.spool = _bt_spoolinit(heap, index, indexInfo->ii_Unique, false);
-
-	/*
-	 * If building a unique index, put dead tuples in a second spool to keep
-	 * them out of the uniqueness check.
-	 */
-	if (indexInfo->ii_Unique)
-		buildstate.spool2 = _bt_spoolinit(heap, index, false, true);
-
-	/* do the heap scan */
-	reltuples = IndexBuildHeapScan(heap, index, indexInfo, true,
-								   btbuildCallback, (void *) &buildstate);
-
-	/* okay, all heap tuples are indexed */
-	if (buildstate.spool2 && !buildstate.haveDead)
-	{
-		/* spool2 turns out to be unnecessary */
-		_bt_spooldestroy(buildstate.spool2);
-		buildstate.spool2 = NULL;
-	}
-
-	/*
-	 * Finish the build by (1) completing the sort of the spool file, (2)
-	 * inserting the sorted tuples into btree pages and (3) building the upper
-	 * levels.
-	 */
-	_bt_leafbuild(buildstate.spool, buildstate.spool2);
-	_bt_spooldestroy(buildstate.spool);
-	if (buildstate.spool2)
-		_bt_spooldestroy(buildstate.spool2);
-
-#ifdef BTREE_BUILD_STATS
-	if (log_btree_build_stats)
-	{
-		ShowUsage("BTREE BUILD STATS");
-		ResetUsage();
-	}
-#endif							/* BTREE_BUILD_STATS */
-
-	/*
-	 * Return statistics
-	 */
-	result = (IndexBuildResult *) palloc(sizeof(IndexBuildResult));
-
-	result->heap_tuples = reltuples;
-	result->index_tuples = buildstate.indtuples;
-
-	return result;
-}
-
-/*
- * Per-tuple callback from IndexBuildHeapScan
- */
-static void
-btbuildCallback(Relation index,
-				HeapTuple htup,
-				Datum *values,
-				bool *isnull,
-				bool tupleIsAlive,
-				void *state)
-{
-	BTBuildState *buildstate = (BTBuildState *) state;
-
-	/*
-	 * insert the index tuple into the appropriate spool file for subsequent
-	 * processing
-	 */
-	if (tupleIsAlive || buildstate->spool2 == NULL)
-		_bt_spool(buildstate->spool, &htup->t_self, values, isnull);
-	else
-	{
-		/* dead tuples are put into spool2 */
-		buildstate->haveDead = true;
-		_bt_spool(buildstate->spool2, &htup->t_self, values, isnull);
-	}
-
-	buildstate->indtuples += 1;
-}
-
 /*
  *	btbuildempty() -- build an empty btree index in the initialization fork
  */
@@ -360,7 +234,18 @@ btgettuple(IndexScanDesc scan, ScanDirection dir)
 		_bt_start_array_keys(scan, dir);
 	}
 
-	/* This loop handles advancing to the next array elements, if any */
+	/* Likewise, find the first leading column value for a skip scan */
+	if (so->skipScan && !BTScanPosIsValid(so->currPos))
+	{
+		/* punt if the index is empty */
+		if (!_bt_start_skip_key(scan, dir))
+			return false;
+	}
+
+	/*
+	 * This loop handles advancing to the next array elements, or to the next
+	 * leading column value in a skip scan, if any
+	 */
 	do
 	{
 		/*
@@ -388,8 +273,8 @@ btgettuple(IndexScanDesc scan, ScanDirection dir)
 				 */
 				if (so->killedItems == NULL)
 					so->killedItems = (int *)
-						palloc(MaxIndexTuplesPerPage * sizeof(int));
-				if (so->numKilled < MaxIndexTuplesPerPage)
+						palloc(MaxTIDsPerBTreePage * sizeof(int));
+				if (so->numKilled < MaxTIDsPerBTreePage)
 					so->killedItems[so->numKilled++] = so->currPos.itemIndex;
 			}
 
@@ -402,8 +287,9 @@ btgettuple(IndexScanDesc scan, ScanDirection dir)
 		/* If we have a tuple, return it ... */
 		if (res)
 			break;
-		/* ... otherwise see if we have more array keys to deal with */
-	} while (so->numArrayKeys && _bt_advance_array_keys(scan, dir));
+		/* ... otherwise see if we have more array or skip keys to deal with */
+	} while ((so->numArrayKeys && _bt_advance_array_keys(scan, dir)) ||
+			 (so->skipScan && _bt_advance_skip_key(scan, dir)));
 
 	return res;
 }
@@ -430,7 +316,14 @@ btgetbitmap(IndexScanDesc scan, TIDBitmap *tbm)
 		_bt_start_array_keys(scan, ForwardScanDirection);
 	}
 
-	/* This loop handles advancing to the next array elements, if any */
+	/* Likewise for the first leading column value of a skip scan */
+	if (so->skipScan && !_bt_start_skip_key(scan, ForwardScanDirection))
+		return ntids;
+
+	/*
+	 * This loop handles advancing to the next array elements, or to the next
+	 * leading column value in a skip scan, if any
+	 */
 	do
 	{
 		/* Fetch the first page & tuple */
@@ -460,8 +353,11 @@ btgetbitmap(IndexScanDesc scan, TIDBitmap *tbm)
 				ntids++;
 			}
 		}
-		/* Now see if we have more array keys to deal with */
-	} while (so->numArrayKeys && _bt_advance_array_keys(scan, ForwardScanDirection));
+		/* Now see if we have more array or skip keys to deal with */
+	} while ((so->numArrayKeys &&
+			  _bt_advance_array_keys(scan, ForwardScanDirection)) ||
+			 (so->skipScan &&
+			  _bt_advance_skip_key(scan, ForwardScanDirection)));
 
 	return ntids;
 }
@@ -485,8 +381,9 @@ btbeginscan(Relation rel, int nkeys, int norderbys)
 	so = (BTScanOpaque) palloc(sizeof(BTScanOpaqueData));
 	BTScanPosInvalidate(so->currPos);
 	BTScanPosInvalidate(so->markPos);
+	/* leave room for a skip scan key, too */
 	if (scan->numberOfKeys > 0)
-		so->keyData = (ScanKey) palloc(scan->numberOfKeys * sizeof(ScanKeyData));
+		so->keyData = (ScanKey) palloc((scan->numberOfKeys + 1) * sizeof(ScanKeyData));
 	else
 		so->keyData = NULL;
 
@@ -495,6 +392,10 @@ btbeginscan(Relation rel, int nkeys, int norderbys)
 	so->arrayKeys = NULL;
 	so->arrayContext = NULL;
 
+	so->skipScan = false;		/* decided in btrescan */
+	so->skipKeyData = NULL;
+	so->skipContext = NULL;
+
 	so->killedItems = NULL;		/* until needed */
 	so->numKilled = 0;
 
@@ -570,6 +471,9 @@ btrescan(IndexScanDesc scan, ScanKey scankey, int nscankeys,
 
 	/* If any keys are SK_SEARCHARRAY type, set up array-key info */
 	_bt_preprocess_array_keys(scan);
+
+	/* Set up a skip scan, if the caller asked for one and we can do it */
+	_bt_preprocess_skip_key(scan);
 }
 
 /*
@@ -600,6 +504,9 @@ btendscan(IndexScanDesc scan)
 	/* so->arrayKeyData and so->arrayKeys are in arrayContext */
 	if (so->arrayContext != NULL)
 		MemoryContextDelete(so->arrayContext);
+	/* likewise so->skipKeyData and the skip value */
+	if (so->skipContext != NULL)
+		MemoryContextDelete(so->skipContext);
 	if (so->killedItems != NULL)
 		pfree(so->killedItems);
 	if (so->currTuples != NULL)
@@ -1102,7 +1009,8 @@ btvacuumscan(IndexVacuumInfo *info, IndexBulkDeleteResult *stats,
 								 RBM_NORMAL, info->strategy);
 		LockBufferForCleanup(buf);
 		_bt_checkpage(rel, buf);
-		_bt_delitems_vacuum(rel, buf, NULL, 0, vstate.lastBlockVacuumed);
+		_bt_delitems_vacuum(rel, buf, NULL, 0, NULL, NULL, 0,
+							vstate.lastBlockVacuumed);
 		_bt_relbuf(rel, buf);
 	}
 
@@ -1200,6 +1108,10 @@ restart:
 	{
 		OffsetNumber deletable[MaxOffsetNumber];
 		int			ndeletable;
+		OffsetNumber updatable[MaxIndexTuplesPerPage];
+		IndexTuple	updated[MaxIndexTuplesPerPage];
+		int			nupdatable;
+		int			nhtidsdead;
 		OffsetNumber offnum,
 					minoff,
 					maxoff;
@@ -1239,6 +1151,8 @@ restart:
 		 * callback function.
 		 */
 		ndeletable = 0;
+		nupdatable = 0;
+		nhtidsdead = 0;
 		minoff = P_FIRSTDATAKEY(opaque);
 		maxoff = PageGetMaxOffsetNumber(page);
 		if (callback)
@@ -1275,8 +1189,29 @@ restart:
 				 * applies to *any* type of index that marks index tuples as
 				 * killed.
 				 */
-				if (callback(htup, callback_state))
+				if (BTreeTupleIsPosting(itup))
+				{
+					/* check each of its heap TIDs */
+					int			nposting = BTreeTupleGetNPosting(itup);
+					int			nremaining;
+					IndexTuple	newitup;
+
+					newitup = btvacuumposting(itup, callback, callback_state,
+											  &nremaining);
+					if (newitup != NULL)
+					{
+						updatable[nupdatable] = offnum;
+						updated[nupdatable++] = newitup;
+					}
+					else if (nremaining == 0)
+						deletable[ndeletable++] = offnum;
+					nhtidsdead += nposting - nremaining;
+				}
+				else if (callback(htup, callback_state))
+				{
 					deletable[ndeletable++] = offnum;
+					nhtidsdead++;
+				}
 			}
 		}
 
@@ -1284,8 +1219,10 @@ restart:
 		 * Apply any needed deletes.  We issue just one _bt_delitems_vacuum()
 		 * call per page, so as to minimize WAL traffic.
 		 */
-		if (ndeletable > 0)
+		if (ndeletable > 0 || nupdatable > 0)
 		{
+			int			i;
+
 			/*
 			 * Notice that the issued XLOG_BTREE_VACUUM WAL record includes
 			 * all information to the replay code to allow it to get a cleanup
@@ -1301,7 +1238,10 @@ restart:
 			 * that.
 			 */
 			_bt_delitems_vacuum(rel, buf, deletable, ndeletable,
+								updatable, updated, nupdatable,
 								vstate->lastBlockVacuumed);
+			for (i = 0; i < nupdatable; i++)
+				pfree(updated[i]);
 
 			/*
 			 * Remember highest leaf page number we've issued a
@@ -1310,7 +1250,7 @@ restart:
 			if (blkno > vstate->lastBlockVacuumed)
 				vstate->lastBlockVacuumed = blkno;
 
-			stats->tuples_removed += ndeletable;
+			stats->tuples_removed += nhtidsdead;
 			/* must recompute maxoff */
 			maxoff = PageGetMaxOffsetNumber(page);
 		}
@@ -1342,7 +1282,22 @@ restart:
 		if (minoff > maxoff)
 			delete_now = (blkno == orig_blkno);
 		else
-			stats->num_index_tuples += maxoff - minoff + 1;
+		{
+			/* posting list tuples count once per heap TID */
+			for (offnum = minoff;
+				 offnum <= maxoff;
+				 offnum = OffsetNumberNext(offnum))
+			{
+				IndexTuple	itup;
+
+				itup = (IndexTuple) PageGetItem(page,
+												PageGetItemId(page, offnum));
+				if (BTreeTupleIsPosting(itup))
+					stats->num_index_tuples += BTreeTupleGetNPosting(itup);
+				else
+					stats->num_index_tuples += 1;
+			}
+		}
 	}
 
 	if (delete_now)
@@ -1380,6 +1335,58 @@ restart:
 	}
 }
 
+/*
+ * btvacuumposting --- check the heap TIDs of a posting list tuple for VACUUM
+ *
+ * Sets *nremaining to the number of heap TIDs the callback lets live.  If
+ * some but not all of them are dead, returns a palloc'd replacement tuple
+ * holding just the live ones; otherwise returns NULL.
+ */
+static IndexTuple
+btvacuumposting(IndexTuple itup, IndexBulkDeleteCallback callback,
+				void *callback_state, int *nremaining)
+{
+	ItemPointer htids = BTreeTupleGetPosting(itup);
+	int			nhtids = BTreeTupleGetNPosting(itup);
+	ItemPointer live = NULL;
+	int			nlive = 0;
+	int			i;
+
+	for (i = 0; i < nhtids; i++)
+	{
+		if (callback(&htids[i], callback_state))
+		{
+			/* first dead one; start collecting the live ones */
+			if (live == NULL)
+			{
+				live = (ItemPointer) palloc(nhtids * sizeof(ItemPointerData));
+				memcpy(live, htids, i * sizeof(ItemPointerData));
+				nlive = i;
+			}
+		}
+		else if (live != NULL)
+			live[nlive++] = htids[i];
+	}
+
+	if (live == NULL)
+	{
+		/* nothing to remove */
+		*nremaining = nhtids;
+		return NULL;
+	}
+
+	*nremaining = nlive;
+	if (nlive == 0)
+	{
+		pfree(live);
+		return NULL;
+	}
+
+	itup = _bt_form_posting(itup, live, nlive);
+	pfree(live);
+	return itup;
+}
+
 /*
  *	btcanreturn() -- Check whether btree indexes support index-only scans.
  *
@@ -29,6 +29,8 @@ static bool _bt_readpage(IndexScanDesc scan, ScanDirection dir,
 			 OffsetNumber offnum);
 static void _bt_saveitem(BTScanOpaque so, int itemIndex,
 			 OffsetNumber offnum, IndexTuple itup);
+static void _bt_savepostingitems(BTScanOpaque so, int itemIndex,
+					 OffsetNumber offnum, IndexTuple itup);
 static bool _bt_steppage(IndexScanDesc scan, ScanDirection dir);
 static bool _bt_readnextpage(IndexScanDesc scan, BlockNumber blkno, ScanDirection dir);
 static bool _bt_parallel_readpage(IndexScanDesc scan, BlockNumber blkno,
@@ -37,6 +39,8 @@ static Buffer _bt_walk_left(Relation rel, Buffer buf, Snapshot snapshot);
 static bool _bt_endpoint(IndexScanDesc scan, ScanDirection dir);
 static void _bt_drop_lock_and_maybe_pin(IndexScanDesc scan, BTScanPos sp);
 static inline void _bt_initialize_more_data(BTScanOpaque so, ScanDirection dir);
+static bool _bt_skip_read_value(IndexScanDesc scan, ScanDirection dir,
+					Buffer buf, OffsetNumber offnum);
 
 
 /*
@@ -422,6 +426,10 @@ _bt_binsrch(Relation rel,
  * does not matter.  This convention allows us to implement the Lehman and
  * Yao convention that the first down-link pointer is before the first key.
  * See backend/access/nbtree/README for details.
+ *
+ * A pivot tuple may have been suffix-truncated.  Its missing attributes are
+ * "minus infinity" too, so a scankey that matches all the attributes the
+ * tuple has but has more of its own is greater than the tuple.
  *----------
  */
 int32
@@ -434,6 +442,8 @@ _bt_compare(Relation rel,
 	TupleDesc	itupdesc = RelationGetDescr(rel);
 	BTPageOpaque opaque = (BTPageOpaque) PageGetSpecialPointer(page);
 	IndexTuple	itup;
+	int			ntupatts;
+	int			ncmpkey;
 	int			i;
 
 	/*
@@ -457,7 +467,10 @@ _bt_compare(Relation rel,
 	 * _bt_first).
 	 */
 
-	for (i = 1; i <= keysz; i++)
+	ntupatts = BTreeTupleGetNAtts(itup, rel);
+	ncmpkey = Min(ntupatts, keysz);
+
+	for (i = 1; i <= ncmpkey; i++)
 	{
 		Datum		datum;
 		bool		isNull;
@@ -508,6 +521,14 @@ _bt_compare(Relation rel,
 		scankey++;
 	}
 
+	/*
+	 * All the attributes we could compare are equal.  If the tuple was
+	 * truncated before the end of the scankey, the rest of it is minus
+	 * infinity.
+	 */
+	if (keysz > ntupatts)
+		return 1;
+
 	/* if we get here, the keys are equal */
 	return 0;
 }
@@ -1255,8 +1276,16 @@ _bt_readpage(IndexScanDesc scan, ScanDirection dir, OffsetNumber offnum)
 			if (itup != NULL)
 			{
 				/* tuple passes all scan key conditions, so remember it */
-				_bt_saveitem(so, itemIndex, offnum, itup);
-				itemIndex++;
+				if (BTreeTupleIsPosting(itup))
+				{
+					_bt_savepostingitems(so, itemIndex, offnum, itup);
+					itemIndex += BTreeTupleGetNPosting(itup);
+				}
+				else
+				{
+					_bt_saveitem(so, itemIndex, offnum, itup);
+					itemIndex++;
+				}
 			}
 			if (!continuescan)
 			{
@@ -1268,7 +1297,7 @@ _bt_readpage(IndexScanDesc scan, ScanDirection dir, OffsetNumber offnum)
 			offnum = OffsetNumberNext(offnum);
 		}
 
-		Assert(itemIndex <= MaxIndexTuplesPerPage);
+		Assert(itemIndex <= MaxTIDsPerBTreePage);
 		so->currPos.firstItem = 0;
 		so->currPos.lastItem = itemIndex - 1;
 		so->currPos.itemIndex = 0;
@@ -1276,7 +1305,7 @@ _bt_readpage(IndexScanDesc scan, ScanDirection dir, OffsetNumber offnum)
 	else
 	{
 		/* load items[] in descending order */
-		itemIndex = MaxIndexTuplesPerPage;
+		itemIndex = MaxTIDsPerBTreePage;
 
 		offnum = Min(offnum, maxoff);
 
@@ -1286,8 +1315,17 @@ _bt_readpage(IndexScanDesc scan, ScanDirection dir, OffsetNumber offnum)
 			if (itup != NULL)
 			{
 				/* tuple passes all scan key conditions, so remember it */
-				itemIndex--;
-				_bt_saveitem(so, itemIndex, offnum, itup);
+				if (BTreeTupleIsPosting(itup))
+				{
+					/* its heap TIDs still go in ascending order */
+					itemIndex -= BTreeTupleGetNPosting(itup);
+					_bt_savepostingitems(so, itemIndex, offnum, itup);
+				}
+				else
+				{
+					itemIndex--;
+					_bt_saveitem(so, itemIndex, offnum, itup);
+				}
 			}
 			if (!continuescan)
 			{
@@ -1301,8 +1339,8 @@ _bt_readpage(IndexScanDesc scan, ScanDirection dir, OffsetNumber offnum)
 
 		Assert(itemIndex >= 0);
 		so->currPos.firstItem = itemIndex;
-		so->currPos.lastItem = MaxIndexTuplesPerPage - 1;
-		so->currPos.itemIndex = MaxIndexTuplesPerPage - 1;
+		so->currPos.lastItem = MaxTIDsPerBTreePage - 1;
+		so->currPos.itemIndex = MaxTIDsPerBTreePage - 1;
 	}
 
 	return (so->currPos.firstItem <= so->currPos.lastItem);
@@ -1327,6 +1365,44 @@ _bt_saveitem(BTScanOpaque so, int itemIndex,
 	}
 }
 
+/*
+ * Save each heap TID of a posting list tuple into so->currPos.items[],
+ * starting at itemIndex.  They all share one copy of the tuple's key, in
+ * the form of a plain tuple, for index-only scans.
+ */
+static void
+_bt_savepostingitems(BTScanOpaque so, int itemIndex,
+					 OffsetNumber offnum, IndexTuple itup)
+{
+	ItemPointer htids = BTreeTupleGetPosting(itup);
+	int			nhtids = BTreeTupleGetNPosting(itup);
+	int			tupleOffset = 0;
+	int			i;
+
+	if (so->currTuples)
+	{
+		Size		keysize = BTreeTupleGetPostingOffset(itup);
+		IndexTuple	base;
+
+		tupleOffset = so->currPos.nextTupleOffset;
+		base = (IndexTuple) (so->currTuples + tupleOffset);
+		memcpy(base, itup, keysize);
+		base->t_info &= ~(INDEX_SIZE_MASK | INDEX_ALT_TID_MASK);
+		base->t_info |= keysize;
+		base->t_tid = htids[0];
+		so->currPos.nextTupleOffset += MAXALIGN(keysize);
+	}
+
+	for (i = 0; i < nhtids; i++)
+	{
+		BTScanPosItem *currItem = &so->currPos.items[itemIndex + i];
+
+		currItem->heapTid = htids[i];
+		currItem->indexOffset = offnum;
+		currItem->tupleOffset = tupleOffset;
+	}
+}
+
 /*
  *	_bt_steppage() -- Step to next page containing valid data for scan
  *
@@ -1928,6 +2004,176 @@ _bt_endpoint(IndexScanDesc scan, ScanDirection dir)
 	return true;
 }
 
+/*
+ *	_bt_start_skip_key() -- Initialize the skip key at start of a skip scan
+ *
+ * Sets the skip key to the first value of the leading index column in the
+ * scan direction.  Returns FALSE if the index is empty.  Like array keys,
+ * this has to wait until we know the scan direction.
+ */
+bool
+_bt_start_skip_key(IndexScanDesc scan, ScanDirection dir)
+{
+	Relation	rel = scan->indexRelation;
+	Buffer		buf;
+	Page		page;
+	BTPageOpaque opaque;
+	OffsetNumber offnum;
+
+	buf = _bt_get_endpoint(rel, 0, ScanDirectionIsBackward(dir),
+						   scan->xs_snapshot);
+	if (!BufferIsValid(buf))
+	{
+		/* Empty index; see _bt_endpoint */
+		PredicateLockRelation(rel, scan->xs_snapshot);
+		return false;
+	}
+
+	page = BufferGetPage(buf);
+	opaque = (BTPageOpaque) PageGetSpecialPointer(page);
+	if (ScanDirectionIsForward(dir))
+		offnum = P_FIRSTDATAKEY(opaque);
+	else
+		offnum = PageGetMaxOffsetNumber(page);
+
+	return _bt_skip_read_value(scan, dir, buf, offnum);
+}
+
+/*
+ *	_bt_advance_skip_key() -- Advance the skip key to the next value of the
+ *		leading index column
+ *
+ * Called when a primitive scan of a skip scan has run out of matches.
+ * Returns TRUE if there is another value to scan for, FALSE if not.
+ *
+ * Usually we have to descend the tree to find the first item beyond the
+ * current value, but if _bt_checkkeys already ran into the next value and
+ * stopped there, we just go with that.
+ */
+bool
+_bt_advance_skip_key(IndexScanDesc scan, ScanDirection dir)
+{
+	Relation	rel = scan->indexRelation;
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+	ScanKeyData skey;
+	BTStack		stack;
+	Buffer		buf;
+	OffsetNumber offnum;
+	bool		nextkey;
+	int			flags;
+
+	/* No point going on if the other keys can never be satisfied */
+	if (!so->qual_ok)
+		return false;
+
+	if (so->skipPending)
+	{
+		so->skipPending = false;
+		return true;
+	}
+
+	/*
+	 * Build a one-column insertion scankey for the current value.  For a
+	 * forward scan we want the first item greater than it, and for a
+	 * backward scan the last item less than it, found the same way as
+	 * _bt_first does for ">" and "<" keys.
+	 */
+	flags = rel->rd_indoption[0] << SK_BT_INDOPTION_SHIFT;
+	if (so->skipNull)
+		flags |= SK_ISNULL;
+	ScanKeyEntryInitializeWithInfo(&skey,
+								   flags,
+								   1,
+								   InvalidStrategy,
+								   InvalidOid,
+								   rel->rd_indcollation[0],
+								   index_getprocinfo(rel, 1, BTORDER_PROC),
+								   so->skipValue);
+
+	nextkey = ScanDirectionIsForward(dir);
+	stack = _bt_search(rel, 1, &skey, nextkey, &buf, BT_READ,
+					   scan->xs_snapshot);
+	_bt_freestack(stack);
+
+	if (!BufferIsValid(buf))
+	{
+		/* the index has been emptied since we last looked */
+		PredicateLockRelation(rel, scan->xs_snapshot);
+		return false;
+	}
+
+	offnum = _bt_binsrch(rel, buf, 1, &skey, nextkey);
+	if (ScanDirectionIsBackward(dir))
+		offnum = OffsetNumberPrev(offnum);
+
+	return _bt_skip_read_value(scan, dir, buf, offnum);
+}
+
+/*
+ * Make the leading column value of the item at offnum on the given leaf
+ * page the new skip key, first stepping over to the next page in the scan
+ * direction if offnum is past the end of the page.  Returns FALSE if we
+ * fall off the end of the index.
+ *
+ * The buffer must be pinned and read-locked; it is released on return.
+ */
+static bool
+_bt_skip_read_value(IndexScanDesc scan, ScanDirection dir,
+					Buffer buf, OffsetNumber offnum)
+{
+	Relation	rel = scan->indexRelation;
+	Page		page;
+	BTPageOpaque opaque;
+	IndexTuple	itup;
+	Datum		datum;
+	bool		isnull;
+
+	for (;;)
+	{
+		page = BufferGetPage(buf);
+		opaque = (BTPageOpaque) PageGetSpecialPointer(page);
+		Assert(P_ISLEAF(opaque));
+
+		/* a concurrent insertion here must conflict with us */
+		PredicateLockPage(rel, BufferGetBlockNumber(buf), scan->xs_snapshot);
+
+		if (!P_IGNORE(opaque) &&
+			offnum >= P_FIRSTDATAKEY(opaque) &&
+			offnum <= PageGetMaxOffsetNumber(page))
+			break;
+
+		if (ScanDirectionIsForward(dir))
+		{
+			if (P_RIGHTMOST(opaque))
+			{
+				_bt_relbuf(rel, buf);
+				return false;
+			}
+			CHECK_FOR_INTERRUPTS();
+			buf = _bt_relandgetbuf(rel, buf, opaque->btpo_next, BT_READ);
+			page = BufferGetPage(buf);
+			TestForOldSnapshot(scan->xs_snapshot, rel, page);
+			opaque = (BTPageOpaque) PageGetSpecialPointer(page);
+			offnum = P_FIRSTDATAKEY(opaque);
+		}
+		else
+		{
+			buf = _bt_walk_left(rel, buf, scan->xs_snapshot);
+			if (!BufferIsValid(buf))
+				return false;
+			offnum = PageGetMaxOffsetNumber(BufferGetPage(buf));
+		}
+	}
+
+	itup = (IndexTuple) PageGetItem(page, PageGetItemId(page, offnum));
+	datum = index_getattr(itup, 1, RelationGetDescr(rel), &isnull);
+	_bt_set_skip_value(scan, datum, isnull);
+
+	_bt_relbuf(rel, buf);
+
+	return true;
+}
+
 /*
  * _bt_initialize_more_data() -- initialize moreLeft/moreRight appropriately
  * for scan direction
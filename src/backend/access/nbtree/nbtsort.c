@@ -52,6 +52,15 @@
  * we log the completed index pages to WAL if and only if WAL archiving is
  * active.
  *
+ * A build may be done in parallel.  Worker processes each scan the heap
+ * blocks handed out by a shared parallel heap scan and sort what they find
+ * in their own tuplesorts, exactly as a serial build would.  Each worker
+ * then streams its sorted tuples to the leader through a shm_mq.  The
+ * leader scans and sorts a share of the heap too, and then merges its own
+ * sorted output with the workers' streams while loading the leaf pages.
+ * Each sort only checks uniqueness within its own input, so the leader
+ * compares neighbouring live tuples from different participants as well.
+ *
  * This code isn't concerned about the FSM at all. The caller is responsible
  * for initializing that.
  *
@@ -66,17 +75,41 @@
 
 #include "postgres.h"
 
+#include "access/genam.h"
 #include "access/nbtree.h"
+#include "access/parallel.h"
+#include "access/relscan.h"
+#include "access/xact.h"
 #include "access/xlog.h"
 #include "access/xloginsert.h"
+#include "catalog/catalog.h"
+#include "catalog/index.h"
+#include "lib/binaryheap.h"
 #include "miscadmin.h"
+#include "optimizer/paths.h"
+#include "storage/proc.h"
+#include "storage/shm_mq.h"
 #include "storage/smgr.h"
+#include "storage/spin.h"
 #include "tcop/tcopprot.h"
 #include "utils/rel.h"
+#include "utils/snapmgr.h"
 #include "utils/sortsupport.h"
+#include "utils/tqual.h"
 #include "utils/tuplesort.h"
 
 
+/* Magic numbers for parallel index build shared memory */
+#define PARALLEL_KEY_BTREE_SHARED		UINT64CONST(0xA000000000000001)
+#define PARALLEL_KEY_HEAP_SCAN			UINT64CONST(0xA000000000000002)
+#define PARALLEL_KEY_TUPLE_QUEUE		UINT64CONST(0xA000000000000003)
+
+/* Size of the queue each worker streams its sorted index tuples through */
+#define BT_PARALLEL_QUEUE_SIZE			(1024 * 1024)
+
+/* Minimum sort memory, in kB, that each participant should get */
+#define BT_PARALLEL_MIN_SORTMEM			(32 * 1024)
+
 /*
  * Status record for spooling/sorting phase.  (Note we may have two of
  * these due to the special requirements for uniqueness-checking with
@@ -90,6 +123,87 @@ struct BTSpool
 	bool		isunique;
 };
 
+/*
+ * Status record for a parallel index build, in dynamic shared memory.  The
+ * leader fills in the first group of fields before launching the workers;
+ * each worker adds its results to the second group once it has streamed
+ * all of its tuples.
+ */
+typedef struct BTShared
+{
+	Oid			heaprelid;
+	Oid			indexrelid;
+	bool		isunique;
+	int			sortmem;		/* sort memory per participant, in kB */
+
+	slock_t		mutex;			/* protects the fields below */
+	int			nparticipantsdone;	/* # workers that finished */
+	double		reltuples;		/* sum of workers' heap tuple counts */
+	double		indtuples;		/* sum of workers' index tuple counts */
+	bool		brokenhotchain; /* did any worker see a broken HOT chain? */
+} BTShared;
+
+/*
+ * Leader's private state for a parallel index build.
+ */
+typedef struct BTLeader
+{
+	ParallelContext *pcxt;
+	int			nworkers;		/* # workers actually launched */
+	BTShared   *btshared;
+	ParallelHeapScanDesc pscan;
+	shm_mq_handle **mqh;		/* tuple queue of each launched worker */
+} BTLeader;
+
+/*
+ * Working state for btbuild and its callback, used by the leader as well as
+ * by each parallel worker.
+ */
+typedef struct BTBuildState
+{
+	bool		isunique;
+	bool		havedead;
+	Relation	heap;
+	BTSpool    *spool;
+
+	/*
+	 * spool2 is needed only when the index is a unique index. Dead tuples are
+	 * put into spool2 instead of spool in order to avoid uniqueness check.
+	 */
+	BTSpool    *spool2;
+	double		indtuples;
+
+	/* leader's parallel build state, or NULL for a serial build */
+	BTLeader   *btleader;
+} BTBuildState;
+
+/*
+ * One input of a k-way merge of sorted index tuples: either a local sort,
+ * or the tuple queue of a parallel worker.  Each message on a worker's
+ * queue is a one-byte "dead" flag followed by the index tuple.
+ */
+typedef struct BTMergeSource
+{
+	Tuplesortstate *sortstate;	/* local sort, or NULL */
+	bool		sortisdead;		/* does the local sort hold dead tuples? */
+	shm_mq_handle *mqh;			/* worker's queue, or NULL */
+	IndexTuple	itup;			/* current tuple, or NULL when exhausted */
+	bool		isdead;			/* is itup a dead tuple? */
+	char	   *buf;			/* aligned copy of a tuple read from mqh */
+	Size		bufsize;
+} BTMergeSource;
+
+typedef struct BTMergeState
+{
+	TupleDesc	tupdesc;
+	int			keysz;
+	SortSupport sortKeys;
+	int			nsources;
+	BTMergeSource *sources;
+	binaryheap *heap;			/* sources with a current tuple */
+	int			lastsource;		/* source of last tuple returned, or -1 */
+} BTMergeState;
+
 /*
  * Status record for a btree page being built.  We have one of these
  * for each active tree level.
@@ -128,6 +242,21 @@ typedef struct BTWriteState
 } BTWriteState;
 
 
+static double _bt_spools_heapscan(Relation heap, Relation index,
+					BTBuildState *buildstate, IndexInfo *indexInfo);
+static BTSpool *_bt_spoolinit(Relation heap, Relation index,
+			  bool isunique, bool isdead, int sortmem);
+static void _bt_spooldestroy(BTSpool *btspool);
+static void _bt_spool(BTSpool *btspool, ItemPointer self,
+		  Datum *values, bool *isnull);
+static void _bt_leafbuild(BTSpool *btspool, BTSpool *btspool2,
+			  BTLeader *btleader);
+static void _bt_build_callback(Relation index,
+				   HeapTuple htup,
+				   Datum *values,
+				   bool *isnull,
+				   bool tupleIsAlive,
+				   void *state);
 static Page _bt_blnewpage(uint32 level);
 static BTPageState *_bt_pagestate(BTWriteState *wstate, uint32 level);
 static void _bt_slideleft(Page page);
@@ -137,7 +266,20 @@ static void _bt_buildadd(BTWriteState *wstate, BTPageState *state,
 			 IndexTuple itup);
 static void _bt_uppershutdown(BTWriteState *wstate, BTPageState *state);
 static void _bt_load(BTWriteState *wstate,
-		 BTSpool *btspool, BTSpool *btspool2);
+		 BTSpool *btspool, BTSpool *btspool2, BTLeader *btleader);
+static SortSupport _bt_mksortkeys(Relation index);
+static int _bt_keycompare(SortSupport sortKeys, int keysz, TupleDesc tupdesc,
+			   IndexTuple itup1, IndexTuple itup2, bool *hasnull);
+static BTMergeState *_bt_merge_begin(Relation index, BTSpool *btspool,
+				BTSpool *btspool2, shm_mq_handle **mqh, int nqueues);
+static IndexTuple _bt_merge_next(BTMergeState *mstate, bool *isdead,
+			   int *source);
+static void _bt_merge_end(BTMergeState *mstate);
+static int	_bt_parallel_request(Relation heap, IndexInfo *indexInfo);
+static BTLeader *_bt_begin_parallel(Relation heap, Relation index,
+				   bool isunique, int request);
+static void _bt_end_parallel(BTLeader *btleader, BTBuildState *buildstate,
+				 double *reltuples, IndexInfo *indexInfo);
 
 
 /*
@@ -145,11 +287,139 @@ static void _bt_load(BTWriteState *wstate,
  */
 
 
+/*
+ *	btbuild() -- build a new btree index.
+ */
+IndexBuildResult *
+btbuild(Relation heap, Relation index, IndexInfo *indexInfo)
+{
+	IndexBuildResult *result;
+	BTBuildState buildstate;
+	double		reltuples;
+
+	buildstate.isunique = indexInfo->ii_Unique;
+	buildstate.havedead = false;
+	buildstate.heap = heap;
+	buildstate.spool = NULL;
+	buildstate.spool2 = NULL;
+	buildstate.indtuples = 0;
+	buildstate.btleader = NULL;
+
+#ifdef BTREE_BUILD_STATS
+	if (log_btree_build_stats)
+		ResetUsage();
+#endif							/* BTREE_BUILD_STATS */
+
+	/*
+	 * We expect to be called exactly once for any index relation. If that's
+	 * not the case, big trouble's what we have.
+	 */
+	if (RelationGetNumberOfBlocks(index) != 0)
+		elog(ERROR, "index \"%s\" already contains data",
+			 RelationGetRelationName(index));
+
+	reltuples = _bt_spools_heapscan(heap, index, &buildstate, indexInfo);
+
+	/*
+	 * Finish the build by (1) completing the sort of the spool file, (2)
+	 * inserting the sorted tuples into btree pages and (3) building the upper
+	 * levels.  In a parallel build, step (2) merges in the sorted output of
+	 * the workers.
+	 */
+	_bt_leafbuild(buildstate.spool, buildstate.spool2, buildstate.btleader);
+	_bt_spooldestroy(buildstate.spool);
+	if (buildstate.spool2)
+		_bt_spooldestroy(buildstate.spool2);
+	if (buildstate.btleader)
+		_bt_end_parallel(buildstate.btleader, &buildstate, &reltuples,
+						 indexInfo);
+
+#ifdef BTREE_BUILD_STATS
+	if (log_btree_build_stats)
+	{
+		ShowUsage("BTREE BUILD STATS");
+		ResetUsage();
+	}
+#endif							/* BTREE_BUILD_STATS */
+
+	/*
+	 * Return statistics
+	 */
+	result = (IndexBuildResult *) palloc(sizeof(IndexBuildResult));
+
+	result->heap_tuples = reltuples;
+	result->index_tuples = buildstate.indtuples;
+
+	return result;
+}
+
+/*
+ * Scan the heap into the spools, launching parallel workers to scan and
+ * sort their own share of it first if that seems worthwhile.  The leader
+ * always takes part in the scan.  Returns the number of heap tuples the
+ * leader saw.
+ */
+static double
+_bt_spools_heapscan(Relation heap, Relation index, BTBuildState *buildstate,
+					IndexInfo *indexInfo)
+{
+	int			request;
+	int			sortmem = maintenance_work_mem;
+	double		reltuples;
+
+	request = _bt_parallel_request(heap, indexInfo);
+	if (request > 0)
+	{
+		ereport(DEBUG1,
+				(errmsg_plural("building index \"%s\" with request for %d parallel worker",
+							   "building index \"%s\" with request for %d parallel workers",
+							   request,
+							   RelationGetRelationName(index), request)));
+		buildstate->btleader = _bt_begin_parallel(heap, index,
+												  indexInfo->ii_Unique,
+												  request);
+	}
+	if (buildstate->btleader)
+		sortmem = buildstate->btleader->btshared->sortmem;
+
+	buildstate->spool = _bt_spoolinit(heap, index, indexInfo->ii_Unique,
+									  false, sortmem);
+
+	/*
+	 * If building a unique index, put dead tuples in a second spool to keep
+	 * them out of the uniqueness check.
+	 */
+	if (indexInfo->ii_Unique)
+		buildstate->spool2 = _bt_spoolinit(heap, index, false, true, sortmem);
+
+	/* do the heap scan */
+	if (buildstate->btleader)
+		reltuples = IndexBuildHeapParallelScan(heap, index, indexInfo,
+											   buildstate->btleader->pscan,
+											   _bt_build_callback,
+											   (void *) buildstate);
+	else
+		reltuples = IndexBuildHeapScan(heap, index, indexInfo, true,
+									   _bt_build_callback,
+									   (void *) buildstate);
+
+	/* okay, all heap tuples are indexed */
+	if (buildstate->spool2 && !buildstate->havedead)
+	{
+		/* spool2 turns out to be unnecessary */
+		_bt_spooldestroy(buildstate->spool2);
+		buildstate->spool2 = NULL;
+	}
+
+	return reltuples;
+}
+
 /*
  * create and initialize a spool structure
  */
-BTSpool *
-_bt_spoolinit(Relation heap, Relation index, bool isunique, bool isdead)
+static BTSpool *
+_bt_spoolinit(Relation heap, Relation index, bool isunique, bool isdead,
+			  int sortmem)
 {
 	BTSpool    *btspool = (BTSpool *) palloc0(sizeof(BTSpool));
 	int			btKbytes;
@@ -160,13 +430,14 @@ _bt_spoolinit(Relation heap, Relation index, bool isunique, bool isdead)
 
 	/*
 	 * We size the sort area as maintenance_work_mem rather than work_mem to
-	 * speed index creation.  This should be OK since a single backend can't
-	 * run multiple index creations in parallel.  Note that creation of a
-	 * unique index actually requires two BTSpool objects.  We expect that the
-	 * second one (for dead tuples) won't get very full, so we give it only
-	 * work_mem.
+	 * speed index creation; the caller passes that in as sortmem, divided
+	 * among the participants of a parallel build.  This should be OK since a
+	 * single backend can't run multiple index creations in parallel.  Note
+	 * that creation of a unique index actually requires two BTSpool objects.
+	 * We expect that the second one (for dead tuples) won't get very full, so
+	 * we give it only work_mem.
 	 */
-	btKbytes = isdead ? work_mem : maintenance_work_mem;
+	btKbytes = isdead ? work_mem : sortmem;
 	btspool->sortstate = tuplesort_begin_index_btree(heap, index, isunique,
 													 btKbytes, false);
 
@@ -176,7 +447,7 @@ _bt_spoolinit(Relation heap, Relation index, bool isunique, bool isdead)
 /*
  * clean up a spool structure and its substructures.
  */
-void
+static void
 _bt_spooldestroy(BTSpool *btspool)
 {
 	tuplesort_end(btspool->sortstate);
@@ -186,19 +457,48 @@ _bt_spooldestroy(BTSpool *btspool)
 /*
  * spool an index entry into the sort file.
  */
-void
+static void
 _bt_spool(BTSpool *btspool, ItemPointer self, Datum *values, bool *isnull)
 {
 	tuplesort_putindextuplevalues(btspool->sortstate, btspool->index,
 								  self, values, isnull);
 }
 
+/*
+ * Per-tuple callback from IndexBuildHeapScan
+ */
+static void
+_bt_build_callback(Relation index,
+				   HeapTuple htup,
+				   Datum *values,
+				   bool *isnull,
+				   bool tupleIsAlive,
+				   void *state)
+{
+	BTBuildState *buildstate = (BTBuildState *) state;
+
+	/*
+	 * insert the index tuple into the appropriate spool file for subsequent
+	 * processing
+	 */
+	if (tupleIsAlive || buildstate->spool2 == NULL)
+		_bt_spool(buildstate->spool, &htup->t_self, values, isnull);
+	else
+	{
+		/* dead tuples are put into spool2 */
+		buildstate->havedead = true;
+		_bt_spool(buildstate->spool2, &htup->t_self, values, isnull);
+	}
+
+	buildstate->indtuples += 1;
+}
+
 /*
  * given a spool loaded by successive calls to _bt_spool,
  * create an entire btree.
  */
-void
-_bt_leafbuild(BTSpool *btspool, BTSpool *btspool2)
+static void
+_bt_leafbuild(BTSpool *btspool, BTSpool *btspool2, BTLeader *btleader)
 {
 	BTWriteState wstate;
 
@@ -228,7 +528,7 @@ _bt_leafbuild(BTSpool *btspool, BTSpool *btspool2)
 	wstate.btws_pages_written = 0;
 	wstate.btws_zeropage = NULL;	/* until needed */
 
-	_bt_load(&wstate, btspool, btspool2);
+	_bt_load(&wstate, btspool, btspool2, btleader);
 }
 
 
@@ -537,6 +837,29 @@ _bt_buildadd(BTWriteState *wstate, BTPageState *state, IndexTuple itup)
 		ItemIdSetUnused(ii);	/* redundant */
 		((PageHeader) opage)->pd_lower -= sizeof(ItemIdData);
 
+		/*
+		 * On the leaf level, truncate the high key just as _bt_split would,
+		 * against the item that is now last on opage.  Upper levels hold
+		 * pivot tuples already.
+		 */
+		if (state->btps_level == 0)
+		{
+			IndexTuple	lastleft;
+			IndexTuple	truncated;
+
+			ii = PageGetItemId(opage, OffsetNumberPrev(last_off));
+			lastleft = (IndexTuple) PageGetItem(opage, ii);
+
+			truncated = _bt_truncate(wstate->index, lastleft, oitup);
+			if (!PageIndexTupleOverwrite(opage, P_HIKEY, (Item) truncated,
+										 IndexTupleSize(truncated)))
+				elog(ERROR, "failed to add high key to the index page");
+			pfree(truncated);
+
+			/* oitup pointed into opage, which has been rearranged */
+			oitup = (IndexTuple) PageGetItem(opage, hii);
+		}
+
 		/*
 		 * Link the old page into its parent, using its minimum key. If we
 		 * don't have a parent, we have to create one; this adds a new btree
@@ -546,14 +869,14 @@ _bt_buildadd(BTWriteState *wstate, BTPageState *state, IndexTuple itup)
 			state->btps_next = _bt_pagestate(wstate, state->btps_level + 1);
 
 		Assert(state->btps_minkey != NULL);
-		ItemPointerSet(&(state->btps_minkey->t_tid), oblkno, P_HIKEY);
+		BTreeInnerTupleSetDownLink(state->btps_minkey, oblkno);
 		_bt_buildadd(wstate, state->btps_next, state->btps_minkey);
 		pfree(state->btps_minkey);
 
 		/*
 		 * Save a copy of the minimum key for the new page.  We have to copy
 		 * it off the old page, not the new one, in case we are not at leaf
-		 * level.
+		 * level; on the leaf level that's also the truncated copy.
 		 */
 		state->btps_minkey = CopyIndexTuple(oitup);
 
@@ -590,7 +913,15 @@ _bt_buildadd(BTWriteState *wstate, BTPageState *state, IndexTuple itup)
 	if (last_off == P_HIKEY)
 	{
 		Assert(state->btps_minkey == NULL);
-		state->btps_minkey = CopyIndexTuple(itup);
+
+		/*
+		 * Pivot tuples carry no included columns, so drop those from the
+		 * first key of the leaf level.
+		 */
+		if (state->btps_level == 0)
+			state->btps_minkey = _bt_truncate(wstate->index, NULL, itup);
+		else
+			state->btps_minkey = CopyIndexTuple(itup);
 	}
 
 	/*
@@ -643,7 +974,7 @@ _bt_uppershutdown(BTWriteState *wstate, BTPageState *state)
 		else
 		{
 			Assert(s->btps_minkey != NULL);
-			ItemPointerSet(&(s->btps_minkey->t_tid), blkno, P_HIKEY);
+			BTreeInnerTupleSetDownLink(s->btps_minkey, blkno);
 			_bt_buildadd(wstate, s->btps_next, s->btps_minkey);
 			pfree(s->btps_minkey);
 			s->btps_minkey = NULL;
@@ -671,10 +1002,12 @@ _bt_uppershutdown(BTWriteState *wstate, BTPageState *state)
 
 /*
  * Read tuples in correct sort order from tuplesort, and load them into
- * btree leaves.
+ * btree leaves.  In a parallel build, the leader's own sorted spools are
+ * merged with the sorted streams of the workers on the way.
  */
 static void
-_bt_load(BTWriteState *wstate, BTSpool *btspool, BTSpool *btspool2)
+_bt_load(BTWriteState *wstate, BTSpool *btspool, BTSpool *btspool2,
+		 BTLeader *btleader)
 {
 	BTPageState *state = NULL;
 	bool		merge = (btspool2 != NULL);
@@ -682,12 +1015,80 @@ _bt_load(BTWriteState *wstate, BTSpool *btspool, BTSpool *btspool2)
 				itup2 = NULL;
 	bool		load1;
 	TupleDesc	tupdes = RelationGetDescr(wstate->index);
-	int			i,
-				keysz = RelationGetNumberOfAttributes(wstate->index);
-	ScanKey		indexScanKey = NULL;
+	int			keysz = IndexRelationGetNumberOfKeyAttributes(wstate->index);
 	SortSupport sortKeys;
 
-	if (merge)
+	if (btleader)
+	{
+		BTMergeState *mstate;
+		IndexTuple	lastlive = NULL;
+		Size		lastlivesize = 0;
+		int			lastsource = -1;
+		bool		isdead;
+		int			source;
+
+		mstate = _bt_merge_begin(wstate->index, btspool, btspool2,
+								 btleader->mqh, btleader->nworkers);
+
+		while ((itup = _bt_merge_next(mstate, &isdead, &source)) != NULL)
+		{
+			/*
+			 * Each participant's sort has already checked its own live tuples
+			 * for uniqueness, so we only need to compare neighbouring live
+			 * tuples that came from different participants.  That takes a
+			 * copy of the last live tuple, since its source has moved on.
+			 */
+			if (btspool->isunique && !isdead)
+			{
+				Size		itupsz = IndexTupleSize(itup);
+				bool		hasnull = false;
+
+				if (lastlive != NULL && source != lastsource &&
+					_bt_keycompare(mstate->sortKeys, keysz, tupdes,
+								   lastlive, itup, &hasnull) == 0 &&
+					!hasnull)
+				{
+					Datum		values[INDEX_MAX_KEYS];
+					bool		isnull[INDEX_MAX_KEYS];
+					char	   *key_desc;
+
+					index_deform_tuple(itup, tupdes, values, isnull);
+					key_desc = BuildIndexValueDescription(wstate->index,
+														  values, isnull);
+
+					ereport(ERROR,
+							(errcode(ERRCODE_UNIQUE_VIOLATION),
+							 errmsg("could not create unique index \"%s\"",
+									RelationGetRelationName(wstate->index)),
+							 key_desc ? errdetail("Key %s is duplicated.", key_desc) :
+							 errdetail("Duplicate keys exist."),
+							 errtableconstraint(wstate->heap,
+												RelationGetRelationName(wstate->index))));
+				}
+
+				if (itupsz > lastlivesize)
+				{
+					if (lastlive)
+						pfree(lastlive);
+					lastlivesize = Max(itupsz, BLCKSZ);
+					lastlive = (IndexTuple) palloc(lastlivesize);
+				}
+				memcpy(lastlive, itup, itupsz);
+				lastsource = source;
+			}
+
+			/* When we see first tuple, create first index page */
+			if (state == NULL)
+				state = _bt_pagestate(wstate, 0);
+
+			_bt_buildadd(wstate, state, itup);
+		}
+
+		if (lastlive)
+			pfree(lastlive);
+		_bt_merge_end(mstate);
+	}
+	else if (merge)
 	{
 		/*
 		 * Another BTSpool for dead tuples exists. Now we have to merge
@@ -697,34 +1098,9 @@ _bt_load(BTWriteState *wstate, BTSpool *btspool, BTSpool *btspool2)
 		/* the preparation of merge */
 		itup = tuplesort_getindextuple(btspool->sortstate, true);
 		itup2 = tuplesort_getindextuple(btspool2->sortstate, true);
-		indexScanKey = _bt_mkscankey_nodata(wstate->index);
 
 		/* Prepare SortSupport data for each column */
-		sortKeys = (SortSupport) palloc0(keysz * sizeof(SortSupportData));
-
-		for (i = 0; i < keysz; i++)
-		{
-			SortSupport sortKey = sortKeys + i;
-			ScanKey		scanKey = indexScanKey + i;
-			int16		strategy;
-
-			sortKey->ssup_cxt = CurrentMemoryContext;
-			sortKey->ssup_collation = scanKey->sk_collation;
-			sortKey->ssup_nulls_first =
-				(scanKey->sk_flags & SK_BT_NULLS_FIRST) != 0;
-			sortKey->ssup_attno = scanKey->sk_attno;
-			/* Abbreviation is not supported here */
-			sortKey->abbreviate = false;
-
-			AssertState(sortKey->ssup_attno != 0);
-
-			strategy = (scanKey->sk_flags & SK_BT_DESC) != 0 ?
-				BTGreaterStrategyNumber : BTLessStrategyNumber;
-
-			PrepareSortSupportFromIndexRel(wstate->index, strategy, sortKey);
-		}
-
-		_bt_freeskey(indexScanKey);
+		sortKeys = _bt_mksortkeys(wstate->index);
 
 		for (;;)
 		{
@@ -736,30 +1112,9 @@ _bt_load(BTWriteState *wstate, BTSpool *btspool, BTSpool *btspool2)
 			}
 			else if (itup != NULL)
 			{
-				for (i = 1; i <= keysz; i++)
-				{
-					SortSupport entry;
-					Datum		attrDatum1,
-								attrDatum2;
-					bool		isNull1,
-								isNull2;
-					int32		compare;
-
-					entry = sortKeys + i - 1;
-					attrDatum1 = index_getattr(itup, i, tupdes, &isNull1);
-					attrDatum2 = index_getattr(itup2, i, tupdes, &isNull2);
-
-					compare = ApplySortComparator(attrDatum1, isNull1,
-												  attrDatum2, isNull2,
-												  entry);
-					if (compare > 0)
-					{
-						load1 = false;
-						break;
-					}
-					else if (compare < 0)
-						break;
-				}
+				if (_bt_keycompare(sortKeys, keysz, tupdes,
+								   itup, itup2, NULL) > 0)
+					load1 = false;
 			}
 			else
 				load1 = false;
@@ -819,3 +1174,543 @@ _bt_load(BTWriteState *wstate, BTSpool *btspool, BTSpool *btspool2)
 		smgrimmedsync(wstate->index->rd_smgr, MAIN_FORKNUM);
 	}
 }
+
+/*
+ * Prepare SortSupport data for each key column of a btree index, for
+ * comparing index tuples the way the index orders them.
+ */
+static SortSupport
+_bt_mksortkeys(Relation index)
+{
+	int			i,
+				keysz = IndexRelationGetNumberOfKeyAttributes(index);
+	ScanKey		indexScanKey;
+	SortSupport sortKeys;
+
+	indexScanKey = _bt_mkscankey_nodata(index);
+	sortKeys = (SortSupport) palloc0(keysz * sizeof(SortSupportData));
+
+	for (i = 0; i < keysz; i++)
+	{
+		SortSupport sortKey = sortKeys + i;
+		ScanKey		scanKey = indexScanKey + i;
+		int16		strategy;
+
+		sortKey->ssup_cxt = CurrentMemoryContext;
+		sortKey->ssup_collation = scanKey->sk_collation;
+		sortKey->ssup_nulls_first =
+			(scanKey->sk_flags & SK_BT_NULLS_FIRST) != 0;
+		sortKey->ssup_attno = scanKey->sk_attno;
+		/* Abbreviation is not supported here */
+		sortKey->abbreviate = false;
+
+		AssertState(sortKey->ssup_attno != 0);
+
+		strategy = (scanKey->sk_flags & SK_BT_DESC) != 0 ?
+			BTGreaterStrategyNumber : BTLessStrategyNumber;
+
+		PrepareSortSupportFromIndexRel(index, strategy, sortKey);
+	}
+
+	_bt_freeskey(indexScanKey);
+
+	return sortKeys;
+}
+
+/*
+ * Compare the keys of two index tuples.  If hasnull isn't NULL, *hasnull is
+ * set when a NULL was among the keys compared (which matters for uniqueness
+ * checks, since NULLs never conflict).
+ */
+static int
+_bt_keycompare(SortSupport sortKeys, int keysz, TupleDesc tupdesc,
+			   IndexTuple itup1, IndexTuple itup2, bool *hasnull)
+{
+	int			i;
+
+	for (i = 1; i <= keysz; i++)
+	{
+		SortSupport entry;
+		Datum		attrDatum1,
+					attrDatum2;
+		bool		isNull1,
+					isNull2;
+		int32		compare;
+
+		entry = sortKeys + i - 1;
+		attrDatum1 = index_getattr(itup1, i, tupdesc, &isNull1);
+		attrDatum2 = index_getattr(itup2, i, tupdesc, &isNull2);
+
+		if (hasnull && (isNull1 || isNull2))
+			*hasnull = true;
+
+		compare = ApplySortComparator(attrDatum1, isNull1,
+									  attrDatum2, isNull2,
+									  entry);
+		if (compare != 0)
+			return compare;
+	}
+
+	return 0;
+}
+
+/*
+ * binaryheap comparator for merge sources.  Ties on the keys are broken by
+ * heap TID, as tuplesort does.
+ */
+static int
+_bt_merge_compare(Datum a, Datum b, void *arg)
+{
+	BTMergeState *mstate = (BTMergeState *) arg;
+	IndexTuple	itup1 = mstate->sources[DatumGetInt32(a)].itup;
+	IndexTuple	itup2 = mstate->sources[DatumGetInt32(b)].itup;
+	int			compare;
+
+	compare = _bt_keycompare(mstate->sortKeys, mstate->keysz,
+							 mstate->tupdesc, itup1, itup2, NULL);
+	if (compare == 0)
+		compare = ItemPointerCompare(&itup1->t_tid, &itup2->t_tid);
+
+	/* binaryheap keeps the largest element on top, so invert */
+	return -compare;
+}
+
+/*
+ * Fetch the next tuple of a merge source into src->itup, or set it to NULL
+ * if the source is exhausted.  A worker's queue is exhausted once the worker
+ * detaches from it; _bt_end_parallel checks that it got that far cleanly.
+ */
+static void
+_bt_merge_advance(BTMergeSource *src)
+{
+	shm_mq_result res;
+	Size		nbytes;
+	void	   *data;
+
+	if (src->sortstate)
+	{
+		src->itup = tuplesort_getindextuple(src->sortstate, true);
+		src->isdead = src->sortisdead;
+		return;
+	}
+
+	res = shm_mq_receive(src->mqh, &nbytes, &data, false);
+	if (res == SHM_MQ_DETACHED)
+	{
+		src->itup = NULL;
+		return;
+	}
+	Assert(res == SHM_MQ_SUCCESS);
+	if (nbytes < 1 + sizeof(IndexTupleData))
+		elog(ERROR, "invalid message in parallel index build tuple queue");
+
+	/* copy out the tuple, which needn't be aligned in the queue */
+	if (nbytes - 1 > src->bufsize)
+	{
+		if (src->buf)
+			pfree(src->buf);
+		src->bufsize = Max(nbytes - 1, BLCKSZ);
+		src->buf = palloc(src->bufsize);
+	}
+	memcpy(src->buf, (char *) data + 1, nbytes - 1);
+	src->isdead = ((char *) data)[0] != 0;
+	src->itup = (IndexTuple) src->buf;
+}
+
+/*
+ * Set up a k-way merge of already-sorted local spools (btspool2 may be NULL)
+ * and worker tuple queues.
+ */
+static BTMergeState *
+_bt_merge_begin(Relation index, BTSpool *btspool, BTSpool *btspool2,
+				shm_mq_handle **mqh, int nqueues)
+{
+	BTMergeState *mstate = (BTMergeState *) palloc0(sizeof(BTMergeState));
+	int			i;
+
+	mstate->tupdesc = RelationGetDescr(index);
+	mstate->keysz = IndexRelationGetNumberOfKeyAttributes(index);
+	mstate->sortKeys = _bt_mksortkeys(index);
+	mstate->sources = (BTMergeSource *)
+		palloc0((nqueues + 2) * sizeof(BTMergeSource));
+
+	mstate->sources[mstate->nsources++].sortstate = btspool->sortstate;
+	if (btspool2)
+	{
+		mstate->sources[mstate->nsources].sortstate = btspool2->sortstate;
+		mstate->sources[mstate->nsources++].sortisdead = true;
+	}
+	for (i = 0; i < nqueues; i++)
+		mstate->sources[mstate->nsources++].mqh = mqh[i];
+
+	mstate->heap = binaryheap_allocate(mstate->nsources, _bt_merge_compare,
+									   mstate);
+	for (i = 0; i < mstate->nsources; i++)
+	{
+		_bt_merge_advance(&mstate->sources[i]);
+		if (mstate->sources[i].itup != NULL)
+			binaryheap_add_unordered(mstate->heap, Int32GetDatum(i));
+	}
+	binaryheap_build(mstate->heap);
+	mstate->lastsource = -1;
+
+	return mstate;
+}
+
+/*
+ * Return the next tuple in merged order, or NULL when all sources are
+ * exhausted.  The tuple is only valid until the next call.
+ */
+static IndexTuple
+_bt_merge_next(BTMergeState *mstate, bool *isdead, int *source)
+{
+	BTMergeSource *src;
+	int			i;
+
+	/* refill the slot of the source we returned from last time */
+	if (mstate->lastsource >= 0)
+	{
+		src = &mstate->sources[mstate->lastsource];
+		_bt_merge_advance(src);
+		if (src->itup != NULL)
+			binaryheap_replace_first(mstate->heap,
+									 Int32GetDatum(mstate->lastsource));
+		else
+			(void) binaryheap_remove_first(mstate->heap);
+	}
+
+	if (binaryheap_empty(mstate->heap))
+	{
+		mstate->lastsource = -1;
+		return NULL;
+	}
+
+	i = DatumGetInt32(binaryheap_first(mstate->heap));
+	src = &mstate->sources[i];
+	mstate->lastsource = i;
+	*isdead = src->isdead;
+	*source = i;
+
+	return src->itup;
+}
+
+static void
+_bt_merge_end(BTMergeState *mstate)
+{
+	int			i;
+
+	for (i = 0; i < mstate->nsources; i++)
+	{
+		if (mstate->sources[i].buf)
+			pfree(mstate->sources[i].buf);
+	}
+	binaryheap_free(mstate->heap);
+	pfree(mstate->sources);
+	pfree(mstate->sortKeys);
+	pfree(mstate);
+}
+
+/*
+ * Decide how many parallel workers to request for building a btree index
+ * on heap.  Zero means a serial build.
+ *
+ * The heap's parallel_workers storage parameter, if set, overrides the
+ * size-based estimate; either way the result is capped by
+ * max_parallel_maintenance_workers, and reduced further if that would leave
+ * any participant with less than BT_PARALLEL_MIN_SORTMEM of sort memory.
+ */
+static int
+_bt_parallel_request(Relation heap, IndexInfo *indexInfo)
+{
+	int			nworkers;
+
+	if (max_parallel_maintenance_workers == 0)
+		return 0;
+
+	/*
+	 * Workers don't evaluate expressions or predicates, can't see the
+	 * leader's temporary buffers, and don't know about the leader's reindex
+	 * state for system catalogs.  Concurrent builds and bootstrap processing
+	 * are left alone too, as is anything already running in parallel mode
+	 * or without a snapshot to hand to the workers.
+	 */
+	if (IsBootstrapProcessingMode() || !IsUnderPostmaster ||
+		IsInParallelMode() || !ActiveSnapshotSet() ||
+		indexInfo->ii_Concurrent ||
+		indexInfo->ii_Expressions != NIL ||
+		indexInfo->ii_Predicate != NIL ||
+		indexInfo->ii_ExclusionOps != NULL ||
+		RelationUsesLocalBuffers(heap) ||
+		IsCatalogRelation(heap))
+		return 0;
+
+	nworkers = RelationGetParallelWorkers(heap, -1);
+	if (nworkers < 0)
+	{
+		BlockNumber heap_pages = RelationGetNumberOfBlocks(heap);
+		int			threshold = Max(min_parallel_table_scan_size, 1);
+
+		/*
+		 * Same scaling as for a parallel sequential scan: one worker once
+		 * the heap reaches min_parallel_table_scan_size, and another one
+		 * each time it triples in size.
+		 */
+		if (heap_pages < (BlockNumber) threshold)
+			return 0;
+
+		nworkers = 1;
+		while (heap_pages >= (BlockNumber) (threshold * 3))
+		{
+			nworkers++;
+			threshold *= 3;
+			if (threshold > INT_MAX / 3)
+				break;
+		}
+	}
+
+	nworkers = Min(nworkers, max_parallel_maintenance_workers);
+
+	while (nworkers > 0 &&
+		   maintenance_work_mem / (nworkers + 1) < BT_PARALLEL_MIN_SORTMEM)
+		nworkers--;
+
+	return nworkers;
+}
+
+/*
+ * Enter parallel mode and launch workers for a parallel btree build.
+ *
+ * Returns NULL, having left parallel mode again, if no worker could be
+ * launched; the caller then builds the index serially.
+ */
+static BTLeader *
+_bt_begin_parallel(Relation heap, Relation index, bool isunique, int request)
+{
+	ParallelContext *pcxt;
+	BTLeader   *btleader;
+	BTShared   *btshared;
+	ParallelHeapScanDesc pscan;
+	char	   *mqspace;
+	Size		estpscan;
+	int			i;
+
+	EnterParallelMode();
+	pcxt = CreateParallelContext("postgres", "_bt_parallel_build_main",
+								 request);
+
+	/*
+	 * Estimate space for the shared state, the parallel heap scan and one
+	 * tuple queue per worker.  The scan uses SnapshotAny, as a serial build
+	 * does, and each participant does its own visibility checks.
+	 */
+	estpscan = heap_parallelscan_estimate(SnapshotAny);
+	shm_toc_estimate_chunk(&pcxt->estimator, sizeof(BTShared));
+	shm_toc_estimate_chunk(&pcxt->estimator, estpscan);
+	shm_toc_estimate_chunk(&pcxt->estimator,
+						   mul_size(BT_PARALLEL_QUEUE_SIZE, pcxt->nworkers));
+	shm_toc_estimate_keys(&pcxt->estimator, 3);
+
+	InitializeParallelDSM(pcxt);
+
+	/* InitializeParallelDSM may have had to give up on workers */
+	if (pcxt->nworkers == 0)
+	{
+		DestroyParallelContext(pcxt);
+		ExitParallelMode();
+		return NULL;
+	}
+
+	btshared = (BTShared *) shm_toc_allocate(pcxt->toc, sizeof(BTShared));
+	btshared->heaprelid = RelationGetRelid(heap);
+	btshared->indexrelid = RelationGetRelid(index);
+	btshared->isunique = isunique;
+	btshared->sortmem = maintenance_work_mem / (pcxt->nworkers + 1);
+	SpinLockInit(&btshared->mutex);
+	btshared->nparticipantsdone = 0;
+	btshared->reltuples = 0.0;
+	btshared->indtuples = 0.0;
+	btshared->brokenhotchain = false;
+	shm_toc_insert(pcxt->toc, PARALLEL_KEY_BTREE_SHARED, btshared);
+
+	pscan = (ParallelHeapScanDesc) shm_toc_allocate(pcxt->toc, estpscan);
+	heap_parallelscan_initialize(pscan, heap, SnapshotAny);
+	shm_toc_insert(pcxt->toc, PARALLEL_KEY_HEAP_SCAN, pscan);
+
+	mqspace = shm_toc_allocate(pcxt->toc,
+							   mul_size(BT_PARALLEL_QUEUE_SIZE, pcxt->nworkers));
+	for (i = 0; i < pcxt->nworkers; i++)
+	{
+		shm_mq	   *mq;
+
+		mq = shm_mq_create(mqspace + ((Size) i) * BT_PARALLEL_QUEUE_SIZE,
+						   (Size) BT_PARALLEL_QUEUE_SIZE);
+		shm_mq_set_receiver(mq, MyProc);
+	}
+	shm_toc_insert(pcxt->toc, PARALLEL_KEY_TUPLE_QUEUE, mqspace);
+
+	LaunchParallelWorkers(pcxt);
+
+	if (pcxt->nworkers_launched == 0)
+	{
+		WaitForParallelWorkersToFinish(pcxt);
+		DestroyParallelContext(pcxt);
+		ExitParallelMode();
+		return NULL;
+	}
+
+	btleader = (BTLeader *) palloc0(sizeof(BTLeader));
+	btleader->pcxt = pcxt;
+	btleader->nworkers = pcxt->nworkers_launched;
+	btleader->btshared = btshared;
+	btleader->pscan = pscan;
+	btleader->mqh = (shm_mq_handle **)
+		palloc(btleader->nworkers * sizeof(shm_mq_handle *));
+	for (i = 0; i < btleader->nworkers; i++)
+	{
+		shm_mq	   *mq;
+
+		mq = (shm_mq *) (mqspace + ((Size) i) * BT_PARALLEL_QUEUE_SIZE);
+		btleader->mqh[i] = shm_mq_attach(mq, pcxt->seg,
+										 pcxt->worker[i].bgwhandle);
+	}
+
+	return btleader;
+}
+
+/*
+ * Wait for the workers of a parallel btree build to exit, fold their
+ * results into the leader's, and leave parallel mode.
+ */
+static void
+_bt_end_parallel(BTLeader *btleader, BTBuildState *buildstate,
+				 double *reltuples, IndexInfo *indexInfo)
+{
+	BTShared   *btshared = btleader->btshared;
+	int			i;
+
+	for (i = 0; i < btleader->nworkers; i++)
+		shm_mq_detach(btleader->mqh[i]);
+
+	/* this rethrows any error a worker hit */
+	WaitForParallelWorkersToFinish(btleader->pcxt);
+
+	/*
+	 * A worker's queue also looks exhausted if the worker went away without
+	 * reporting an error, so make sure all of them really finished.
+	 */
+	if (btshared->nparticipantsdone != btleader->nworkers)
+		elog(ERROR, "parallel index build worker exited prematurely");
+
+	*reltuples += btshared->reltuples;
+	buildstate->indtuples += btshared->indtuples;
+	if (btshared->brokenhotchain)
+		indexInfo->ii_BrokenHotChain = true;
+
+	DestroyParallelContext(btleader->pcxt);
+	ExitParallelMode();
+	pfree(btleader->mqh);
+	pfree(btleader);
+}
+
+/*
+ * Main entry point for a parallel btree build worker.
+ *
+ * The worker scans the blocks of the heap that the shared parallel scan
+ * hands it, sorts them like a serial build would, and streams the sorted
+ * tuples (merging in its dead-tuple spool, if any) to the leader through
+ * its tuple queue.
+ */
+void
+_bt_parallel_build_main(dsm_segment *seg, shm_toc *toc)
+{
+	BTShared   *btshared;
+	ParallelHeapScanDesc pscan;
+	char	   *mqspace;
+	shm_mq	   *mq;
+	shm_mq_handle *mqh;
+	Relation	heapRel;
+	Relation	indexRel;
+	IndexInfo  *indexInfo;
+	BTBuildState buildstate;
+	BTMergeState *mstate;
+	IndexTuple	itup;
+	bool		isdead;
+	int			source;
+	double		reltuples;
+
+	btshared = shm_toc_lookup(toc, PARALLEL_KEY_BTREE_SHARED, false);
+	pscan = shm_toc_lookup(toc, PARALLEL_KEY_HEAP_SCAN, false);
+	mqspace = shm_toc_lookup(toc, PARALLEL_KEY_TUPLE_QUEUE, false);
+
+	mq = (shm_mq *) (mqspace +
+					 ((Size) ParallelWorkerNumber) * BT_PARALLEL_QUEUE_SIZE);
+	shm_mq_set_sender(mq, MyProc);
+	mqh = shm_mq_attach(mq, seg, NULL);
+
+	/* the leader holds stronger locks; group locking lets us in */
+	heapRel = heap_open(btshared->heaprelid, ShareLock);
+	indexRel = index_open(btshared->indexrelid, RowExclusiveLock);
+	indexInfo = BuildIndexInfo(indexRel);
+
+	buildstate.isunique = btshared->isunique;
+	buildstate.havedead = false;
+	buildstate.heap = heapRel;
+	buildstate.spool = _bt_spoolinit(heapRel, indexRel, btshared->isunique,
+									 false, btshared->sortmem);
+	buildstate.spool2 = NULL;
+	if (btshared->isunique)
+		buildstate.spool2 = _bt_spoolinit(heapRel, indexRel, false, true,
+										  btshared->sortmem);
+	buildstate.indtuples = 0;
+	buildstate.btleader = NULL;
+
+	reltuples = IndexBuildHeapParallelScan(heapRel, indexRel, indexInfo,
+										   pscan, _bt_build_callback,
+										   (void *) &buildstate);
+
+	tuplesort_performsort(buildstate.spool->sortstate);
+	if (buildstate.spool2 && !buildstate.havedead)
+	{
+		_bt_spooldestroy(buildstate.spool2);
+		buildstate.spool2 = NULL;
+	}
+	if (buildstate.spool2)
+		tuplesort_performsort(buildstate.spool2->sortstate);
+
+	/* stream our sorted tuples to the leader */
+	mstate = _bt_merge_begin(indexRel, buildstate.spool, buildstate.spool2,
+							 NULL, 0);
+	while ((itup = _bt_merge_next(mstate, &isdead, &source)) != NULL)
+	{
+		shm_mq_iovec iov[2];
+		char		flag = isdead ? 1 : 0;
+
+		iov[0].data = &flag;
+		iov[0].len = 1;
+		iov[1].data = (char *) itup;
+		iov[1].len = IndexTupleSize(itup);
+
+		/* if the leader went away, it will take us down shortly anyway */
+		if (shm_mq_sendv(mqh, iov, 2, false) != SHM_MQ_SUCCESS)
+			break;
+	}
+	_bt_merge_end(mstate);
+
+	/* report our share of the results before signalling end of stream */
+	SpinLockAcquire(&btshared->mutex);
+	btshared->nparticipantsdone++;
+	btshared->reltuples += reltuples;
+	btshared->indtuples += buildstate.indtuples;
+	if (indexInfo->ii_BrokenHotChain)
+		btshared->brokenhotchain = true;
+	SpinLockRelease(&btshared->mutex);
+
+	shm_mq_detach(mqh);
+
+	_bt_spooldestroy(buildstate.spool);
+	if (buildstate.spool2)
+		_bt_spooldestroy(buildstate.spool2);
+
+	index_close(indexRel, RowExclusiveLock);
+	heap_close(heapRel, ShareLock);
+}
@@ -22,6 +22,7 @@
 #include "access/relscan.h"
 #include "miscadmin.h"
 #include "utils/array.h"
+#include "utils/datum.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
 #include "utils/rel.h"
@@ -46,9 +47,16 @@ static bool _bt_compare_scankey_args(IndexScanDesc scan, ScanKey op,
 						 bool *result);
 static bool _bt_fix_scankey_strategy(ScanKey skey, int16 *indoption);
 static void _bt_mark_scankey_required(ScanKey skey);
+static void _bt_init_skip_key(IndexScanDesc scan, ScanKey skey, int flags);
+static bool _bt_skip_new_value(IndexScanDesc scan, IndexTuple tuple,
+				   TupleDesc tupdesc);
 static bool _bt_check_rowcompare(ScanKey skey,
 					 IndexTuple tuple, TupleDesc tupdesc,
 					 ScanDirection dir, bool *continuescan);
+static int _bt_killposting(BTScanOpaque so, bool *killed, int itemIndex,
+				IndexTuple ituple);
+static int	_bt_keep_natts(Relation rel, IndexTuple lastleft,
+			   IndexTuple firstright);
 
 
 /*
@@ -56,24 +64,29 @@ static bool _bt_check_rowcompare(ScanKey skey,
  *		Build an insertion scan key that contains comparison data from itup
  *		as well as comparator routines appropriate to the key datatypes.
  *
- *		The result is intended for use with _bt_compare().
+ *		The result is intended for use with _bt_compare().  Only key columns
+ *		are included.  If itup is a truncated pivot tuple, only as many
+ *		entries as it has attributes are filled in, and the caller must pass
+ *		no larger a keysz to _bt_compare().
  */
 ScanKey
 _bt_mkscankey(Relation rel, IndexTuple itup)
 {
 	ScanKey		skey;
 	TupleDesc	itupdesc;
-	int			natts;
+	int			indnkeyatts;
+	int			tupnatts;
 	int16	   *indoption;
 	int			i;
 
 	itupdesc = RelationGetDescr(rel);
-	natts = RelationGetNumberOfAttributes(rel);
+	indnkeyatts = IndexRelationGetNumberOfKeyAttributes(rel);
+	tupnatts = Min(BTreeTupleGetNAtts(itup, rel), indnkeyatts);
 	indoption = rel->rd_indoption;
 
-	skey = (ScanKey) palloc(natts * sizeof(ScanKeyData));
+	skey = (ScanKey) palloc(indnkeyatts * sizeof(ScanKeyData));
 
-	for (i = 0; i < natts; i++)
+	for (i = 0; i < tupnatts; i++)
 	{
 		FmgrInfo   *procinfo;
 		Datum		arg;
@@ -115,16 +128,16 @@ ScanKey
 _bt_mkscankey_nodata(Relation rel)
 {
 	ScanKey		skey;
-	int			natts;
+	int			indnkeyatts;
 	int16	   *indoption;
 	int			i;
 
-	natts = RelationGetNumberOfAttributes(rel);
+	indnkeyatts = IndexRelationGetNumberOfKeyAttributes(rel);
 	indoption = rel->rd_indoption;
 
-	skey = (ScanKey) palloc(natts * sizeof(ScanKeyData));
+	skey = (ScanKey) palloc(indnkeyatts * sizeof(ScanKeyData));
 
-	for (i = 0; i < natts; i++)
+	for (i = 0; i < indnkeyatts; i++)
 	{
 		FmgrInfo   *procinfo;
 		int			flags;
@@ -656,14 +669,206 @@ _bt_restore_array_keys(IndexScanDesc scan)
 	}
 }
 
+/*
+ * _bt_preprocess_skip_key() -- Set up a skip scan, if wanted and possible
+ *
+ * A skip scan serves quals on the second index column when there are none
+ * on the first: we add an "=" key on the first column and run one ordinary
+ * scan for each distinct value of that column, stepping from one value to
+ * the next with a fresh descent of the tree.  The added key lets the keys
+ * on the second column be marked required, so each of those scans starts
+ * and stops at the right place instead of reading the whole index.
+ *
+ * This is done only if the caller asked for it (the planner decides whether
+ * there are few enough distinct leading values to make it pay), and not
+ * together with array keys or row comparisons, nor in a parallel scan.
+ *
+ * Like array keys, the skip key lives in a modifiable copy of the scan keys,
+ * so->skipKeyData, which _bt_preprocess_keys reads instead of scan->keyData.
+ * Its value is filled in by _bt_start_skip_key.
+ */
+void
+_bt_preprocess_skip_key(IndexScanDesc scan)
+{
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+	Relation	rel = scan->indexRelation;
+	int			numberOfKeys = scan->numberOfKeys;
+	ScanKey		inkeys;
+	bool		haveSecond = false;
+	Oid			eqop;
+	int			i;
+	MemoryContext oldContext;
+
+	so->skipScan = false;
+
+	if (!scan->xs_want_skip || numberOfKeys < 1 || so->numArrayKeys != 0 ||
+		scan->parallel_scan != NULL ||
+		IndexRelationGetNumberOfKeyAttributes(rel) < 2)
+		return;
+
+	inkeys = so->arrayKeyData != NULL ? so->arrayKeyData : scan->keyData;
+
+	for (i = 0; i < numberOfKeys; i++)
+	{
+		ScanKey		cur = &inkeys[i];
+
+		if (cur->sk_attno == 1 || (cur->sk_flags & SK_ROW_HEADER))
+			return;
+		if (cur->sk_attno == 2)
+			haveSecond = true;
+	}
+	if (!haveSecond)
+		return;
+
+	eqop = get_opfamily_member(rel->rd_opfamily[0],
+							   rel->rd_opcintype[0],
+							   rel->rd_opcintype[0],
+							   BTEqualStrategyNumber);
+	if (!OidIsValid(eqop))
+		return;
+
+	/*
+	 * Make a scan-lifespan context to hold skip-associated data, or reset it
+	 * if we already have one from a previous rescan cycle.
+	 */
+	if (so->skipContext == NULL)
+		so->skipContext = AllocSetContextCreate(CurrentMemoryContext,
+												"BTree skip context",
+												ALLOCSET_SMALL_SIZES);
+	else
+		MemoryContextReset(so->skipContext);
+
+	oldContext = MemoryContextSwitchTo(so->skipContext);
+
+	fmgr_info(get_opcode(eqop), &so->skipEqProc);
+
+	/* The skip key goes first, since input keys are ordered by attribute */
+	so->skipKeyData = (ScanKey) palloc((numberOfKeys + 1) * sizeof(ScanKeyData));
+	memcpy(&so->skipKeyData[1], inkeys, numberOfKeys * sizeof(ScanKeyData));
+
+	MemoryContextSwitchTo(oldContext);
+
+	so->skipValue = (Datum) 0;
+	so->skipNull = true;
+	so->skipPending = false;
+	so->skipScan = true;
+	_bt_init_skip_key(scan, &so->skipKeyData[0], 0);
+}
+
+/*
+ * _bt_set_skip_value() -- Make value the current skip key value
+ *
+ * The value is copied, so it may point into an index page.  Both the input
+ * skip key and, if _bt_preprocess_keys has run, its preprocessed copy are
+ * updated.
+ */
+void
+_bt_set_skip_value(IndexScanDesc scan, Datum value, bool isnull)
+{
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+	Form_pg_attribute attr = TupleDescAttr(RelationGetDescr(scan->indexRelation), 0);
+
+	Assert(so->skipScan);
+
+	if (!so->skipNull && !attr->attbyval)
+		pfree(DatumGetPointer(so->skipValue));
+
+	if (isnull)
+		so->skipValue = (Datum) 0;
+	else
+	{
+		MemoryContext oldContext = MemoryContextSwitchTo(so->skipContext);
+
+		so->skipValue = datumCopy(value, attr->attbyval, attr->attlen);
+		MemoryContextSwitchTo(oldContext);
+	}
+	so->skipNull = isnull;
+
+	_bt_init_skip_key(scan, &so->skipKeyData[0], 0);
+
+	/* The skip key always comes out first, being the only first-column key */
+	if (so->numberOfKeys > 0)
+	{
+		ScanKey		skey = &so->keyData[0];
+
+		Assert(skey->sk_flags & SK_BT_SKIP);
+		_bt_init_skip_key(scan, skey,
+						  skey->sk_flags & (SK_BT_REQFWD | SK_BT_REQBKWD));
+	}
+}
+
+/*
+ * Fill in skey as the skip key for the current skip value, the same way
+ * _bt_fix_scankey_strategy would, plus the given flags.
+ */
+static void
+_bt_init_skip_key(IndexScanDesc scan, ScanKey skey, int flags)
+{
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+	Relation	rel = scan->indexRelation;
+
+	flags |= SK_BT_SKIP | (rel->rd_indoption[0] << SK_BT_INDOPTION_SHIFT);
+
+	if (so->skipNull)
+		ScanKeyEntryInitialize(skey,
+							   flags | SK_ISNULL | SK_SEARCHNULL,
+							   1,
+							   BTEqualStrategyNumber,
+							   InvalidOid,
+							   InvalidOid,
+							   InvalidOid,
+							   (Datum) 0);
+	else
+		ScanKeyEntryInitializeWithInfo(skey,
+									   flags,
+									   1,
+									   BTEqualStrategyNumber,
+									   rel->rd_opcintype[0],
+									   rel->rd_indcollation[0],
+									   &so->skipEqProc,
+									   so->skipValue);
+}
+
+/*
+ * Check the first column of a tuple against the skip key.  If it's a new
+ * value, the scan has moved on to the next distinct leading value: make
+ * that the skip key and return TRUE.
+ */
+static bool
+_bt_skip_new_value(IndexScanDesc scan, IndexTuple tuple, TupleDesc tupdesc)
+{
+	BTScanOpaque so = (BTScanOpaque) scan->opaque;
+	ScanKey		key = &so->keyData[0];
+	Datum		datum;
+	bool		isNull;
+
+	Assert(key->sk_flags & SK_BT_SKIP);
+
+	datum = index_getattr(tuple, 1, tupdesc, &isNull);
+
+	if (key->sk_flags & SK_ISNULL)
+	{
+		if (isNull)
+			return false;
+	}
+	else if (!isNull &&
+			 DatumGetBool(FunctionCall2Coll(&key->sk_func, key->sk_collation,
+											datum, key->sk_argument)))
+		return false;
+
+	_bt_set_skip_value(scan, datum, isNull);
+	return true;
+}
+
 
 /*
  *	_bt_preprocess_keys() -- Preprocess scan keys
  *
- * The given search-type keys (in scan->keyData[] or so->arrayKeyData[])
- * are copied to so->keyData[] with possible transformation.
- * scan->numberOfKeys is the number of input keys, so->numberOfKeys gets
- * the number of output keys (possibly less, never greater).
+ * The given search-type keys (in scan->keyData[], so->arrayKeyData[] or
+ * so->skipKeyData[]) are copied to so->keyData[] with possible
+ * transformation.  scan->numberOfKeys is the number of input keys (plus one
+ * for the skip key of a skip scan), so->numberOfKeys gets the number of
+ * output keys (possibly less, never greater).
  *
  * The output keys are marked with additional sk_flag bits beyond the
  * system-standard bits supplied by the caller.  The DESC and NULLS_FIRST
@@ -766,9 +971,15 @@ _bt_preprocess_keys(IndexScanDesc scan)
 		return;					/* done if qual-less scan */
 
 	/*
-	 * Read so->arrayKeyData if array keys are present, else scan->keyData
+	 * Read so->skipKeyData in a skip scan, so->arrayKeyData if array keys are
+	 * present, else scan->keyData
 	 */
-	if (so->arrayKeyData != NULL)
+	if (so->skipScan)
+	{
+		inkeys = so->skipKeyData;
+		numberOfKeys++;
+	}
+	else if (so->arrayKeyData != NULL)
 		inkeys = so->arrayKeyData;
 	else
 		inkeys = scan->keyData;
@@ -1410,12 +1621,35 @@ _bt_checkkeys(IndexScanDesc scan,
 	so = (BTScanOpaque) scan->opaque;
 	keysz = so->numberOfKeys;
 
+	/*
+	 * In a skip scan, reaching a new value in the first column means we're
+	 * done with the previous one.  We carry on from here with the new value
+	 * if this tuple matches it; otherwise we end the current primitive scan,
+	 * so that _bt_first can jump straight to where the matches for the new
+	 * value start.
+	 */
+	if (so->skipScan && _bt_skip_new_value(scan, tuple, tupdesc))
+	{
+		/* this time around, the skip key matches */
+		tuple = _bt_checkkeys(scan, page, offnum, dir, continuescan);
+		if (tuple == NULL)
+		{
+			so->skipPending = true;
+			*continuescan = false;
+		}
+		return tuple;
+	}
+
 	for (key = so->keyData, ikey = 0; ikey < keysz; key++, ikey++)
 	{
 		Datum		datum;
 		bool		isNull;
 		Datum		test;
 
+		/* the skip key was checked above */
+		if (key->sk_flags & SK_BT_SKIP)
+			continue;
+
 		/* row-comparison keys need special processing */
 		if (key->sk_flags & SK_ROW_HEADER)
 		{
@@ -1697,6 +1931,53 @@ _bt_check_rowcompare(ScanKey skey, IndexTuple tuple, TupleDesc tupdesc,
 	return result;
 }
 
+/*
+ * Check a posting list tuple against the scan's killed items, for
+ * _bt_killitems.  Returns -1 if the tuple doesn't hold the heap TID of
+ * so->currPos.items[itemIndex], 0 if it does but some of its other heap TIDs
+ * are still live, and 1 if all of them are dead.
+ *
+ * A posting list tuple's heap TIDs were saved as a run of consecutive items
+ * in TID order, so it's dead if that run still matches it exactly and every
+ * item in the run was killed.
+ */
+static int
+_bt_killposting(BTScanOpaque so, bool *killed, int itemIndex,
+				IndexTuple ituple)
+{
+	BTScanPosItem *kitem = &so->currPos.items[itemIndex];
+	ItemPointer htids = BTreeTupleGetPosting(ituple);
+	int			nhtids = BTreeTupleGetNPosting(ituple);
+	int			first;
+	int			j;
+
+	for (j = 0; j < nhtids; j++)
+	{
+		if (ItemPointerEquals(&htids[j], &kitem->heapTid))
+			break;
+	}
+	if (j >= nhtids)
+		return -1;
+
+	/* the killed item must be the j'th of its run */
+	first = itemIndex - j;
+	if (first < so->currPos.firstItem ||
+		first + nhtids - 1 > so->currPos.lastItem)
+		return 0;
+
+	for (j = 0; j < nhtids; j++)
+	{
+		BTScanPosItem *item = &so->currPos.items[first + j];
+
+		if (!killed[first + j] ||
+			item->indexOffset != kitem->indexOffset ||
+			!ItemPointerEquals(&item->heapTid, &htids[j]))
+			return 0;
+	}
+
+	return 1;
+}
+
 /*
  * _bt_killitems - set LP_DEAD state for items an indexscan caller has
  * told us were killed
@@ -1739,6 +2020,7 @@ _bt_killitems(IndexScanDesc scan)
 	int			i;
 	int			numKilled = so->numKilled;
 	bool		killedsomething = false;
+	bool		killed[MaxTIDsPerBTreePage];
 
 	Assert(BTScanPosIsValid(so->currPos));
 
@@ -1786,6 +2068,11 @@ _bt_killitems(IndexScanDesc scan)
 	minoff = P_FIRSTDATAKEY(opaque);
 	maxoff = PageGetMaxOffsetNumber(page);
 
+	/* which scan items are dead, for checking whole posting lists */
+	memset(killed, 0, sizeof(killed));
+	for (i = 0; i < numKilled; i++)
+		killed[so->killedItems[i]] = true;
+
 	for (i = 0; i < numKilled; i++)
 	{
 		int			itemIndex = so->killedItems[i];
@@ -1801,7 +2088,21 @@ _bt_killitems(IndexScanDesc scan)
 			ItemId		iid = PageGetItemId(page, offnum);
 			IndexTuple	ituple = (IndexTuple) PageGetItem(page, iid);
 
-			if (ItemPointerEquals(&ituple->t_tid, &kitem->heapTid))
+			if (BTreeTupleIsPosting(ituple))
+			{
+				int			result = _bt_killposting(so, killed, itemIndex,
+													 ituple);
+
+				if (result > 0)
+				{
+					/* found it, and every heap TID in it is dead */
+					ItemIdMarkDead(iid);
+					killedsomething = true;
+				}
+				if (result >= 0)
+					break;		/* out of inner search loop */
+			}
+			else if (ItemPointerEquals(&ituple->t_tid, &kitem->heapTid))
 			{
 				/* found the item */
 				ItemIdMarkDead(iid);
@@ -2069,3 +2370,84 @@ btproperty(Oid index_oid, int attno,
 			return false;		/* punt to generic code */
 	}
 }
+
+/*
+ *	_bt_truncate() -- create a pivot tuple to separate lastleft from
+ *		firstright, the last item on a new left page and the first on its
+ *		right sibling
+ *
+ * The result keeps as few of firstright's key attributes as are needed to
+ * tell it apart from lastleft; the attributes cut off count as minus
+ * infinity in _bt_compare, so the pivot is still greater than lastleft and
+ * no greater than firstright.  Included columns are always cut off.  If
+ * lastleft is NULL, only the included columns are removed.  The result is
+ * palloc'd and never a posting list tuple.
+ */
+IndexTuple
+_bt_truncate(Relation rel, IndexTuple lastleft, IndexTuple firstright)
+{
+	int			natts = IndexRelationGetNumberOfAttributes(rel);
+	int			nkeyatts = IndexRelationGetNumberOfKeyAttributes(rel);
+	int			keepnatts;
+	IndexTuple	pivot;
+
+	if (lastleft != NULL)
+		keepnatts = Min(_bt_keep_natts(rel, lastleft, firstright), nkeyatts);
+	else
+		keepnatts = nkeyatts;
+
+	if (keepnatts < natts)
+	{
+		pivot = index_truncate_tuple(RelationGetDescr(rel), firstright,
+									 keepnatts);
+		/* a posting list tuple's t_tid doesn't point to the heap */
+		if (BTreeTupleIsPosting(firstright))
+			pivot->t_tid = *BTreeTupleGetPosting(firstright);
+		BTreeTupleSetNAtts(pivot, keepnatts);
+	}
+	else if (BTreeTupleIsPosting(firstright))
+		pivot = _bt_form_posting(firstright, BTreeTupleGetPosting(firstright), 1);
+	else
+		pivot = CopyIndexTuple(firstright);
+
+	return pivot;
+}
+
+/*
+ * Number of leading key attributes a pivot made from firstright must keep to
+ * compare greater than lastleft: one more than the length of their common
+ * prefix.  Returns nkeyatts + 1 if all the key attributes are equal.
+ */
+static int
+_bt_keep_natts(Relation rel, IndexTuple lastleft, IndexTuple firstright)
+{
+	TupleDesc	itupdesc = RelationGetDescr(rel);
+	int			nkeyatts = IndexRelationGetNumberOfKeyAttributes(rel);
+	int			keepnatts = 1;
+	int			attnum;
+
+	for (attnum = 1; attnum <= nkeyatts; attnum++)
+	{
+		Datum		datum1,
+					datum2;
+		bool		isNull1,
+					isNull2;
+
+		datum1 = index_getattr(lastleft, attnum, itupdesc, &isNull1);
+		datum2 = index_getattr(firstright, attnum, itupdesc, &isNull2);
+
+		if (isNull1 != isNull2)
+			break;
+
+		if (!isNull1 &&
+			DatumGetInt32(FunctionCall2Coll(index_getprocinfo(rel, attnum,
+															  BTORDER_PROC),
+											rel->rd_indcollation[attnum - 1],
+											datum1, datum2)) != 0)
+			break;
+
+		keepnatts++;
+	}
+
+	return keepnatts;
+}
@@ -239,18 +239,6 @@ btree_xlog_split(bool onleft, bool isroot, XLogReaderState *record)
 
 	_bt_restore_page(rpage, datapos, datalen);
 
-	/*
-	 * On leaf level, the high key of the left page is equal to the first key
-	 * on the right page.
-	 */
-	if (isleaf)
-	{
-		ItemId		hiItemId = PageGetItemId(rpage, P_FIRSTDATAKEY(ropaque));
-
-		left_hikey = PageGetItem(rpage, hiItemId);
-		left_hikeysz = ItemIdGetLength(hiItemId);
-	}
-
 	PageSetLSN(rpage, lsn);
 	MarkBufferDirty(rbuf);
 
@@ -286,14 +274,15 @@ btree_xlog_split(bool onleft, bool isroot, XLogReaderState *record)
 			datalen -= newitemsz;
 		}
 
-		/* Extract left hikey and its size (assuming 16-bit alignment) */
-		if (!isleaf)
-		{
-			left_hikey = (Item) datapos;
-			left_hikeysz = MAXALIGN(IndexTupleSize(left_hikey));
-			datapos += left_hikeysz;
-			datalen -= left_hikeysz;
-		}
+		/*
+		 * Extract left hikey and its size (assuming 16-bit alignment).  It's
+		 * always logged, since on the leaf level it's a truncated copy of
+		 * the right page's first key rather than the key itself.
+		 */
+		left_hikey = (Item) datapos;
+		left_hikeysz = MAXALIGN(IndexTupleSize(left_hikey));
+		datapos += left_hikeysz;
+		datalen -= left_hikeysz;
 		Assert(datalen == 0);
 
 		newlpage = PageGetTempPageCopySpecial(lpage);
@@ -390,8 +379,8 @@ btree_xlog_vacuum(XLogReaderState *record)
 	Buffer		buffer;
 	Page		page;
 	BTPageOpaque opaque;
-#ifdef UNUSED
 	xl_btree_vacuum *xlrec = (xl_btree_vacuum *) XLogRecGetData(record);
+#ifdef UNUSED
 
 	/*
 	 * This section of code is thought to be no longer needed, after analysis
@@ -482,14 +471,38 @@ btree_xlog_vacuum(XLogReaderState *record)
 
 		if (len > 0)
 		{
+			OffsetNumber *updatenos;
 			OffsetNumber *unused;
-			OffsetNumber *unend;
+			char	   *end = ptr + len;
+			int			i;
 
-			unused = (OffsetNumber *) ptr;
-			unend = (OffsetNumber *) ((char *) ptr + len);
+			/*
+			 * Replace posting list tuples that lost some of their heap TIDs
+			 * first, since deleting items renumbers the ones after them.
+			 */
+			if (xlrec->nupdated > 0)
+			{
+				char	   *tuples = ptr;
+
+				updatenos = (OffsetNumber *)
+					(end - (xlrec->ndeleted + xlrec->nupdated) * sizeof(OffsetNumber));
+
+				for (i = 0; i < xlrec->nupdated; i++)
+				{
+					IndexTuple	itup = (IndexTuple) tuples;
+					Size		itemsz = MAXALIGN(IndexTupleSize(itup));
+
+					if (!PageIndexTupleOverwrite(page, updatenos[i],
+												 (Item) itup, itemsz))
+						elog(PANIC, "failed to update partially dead item");
+					tuples += itemsz;
+				}
+			}
 
-			if ((unend - unused) > 0)
-				PageIndexMultiDelete(page, unused, unend - unused);
+			unused = (OffsetNumber *)
+				(end - xlrec->ndeleted * sizeof(OffsetNumber));
+			if (xlrec->ndeleted > 0)
+				PageIndexMultiDelete(page, unused, xlrec->ndeleted);
 		}
 
 		/*
@@ -506,6 +519,33 @@ btree_xlog_vacuum(XLogReaderState *record)
 		UnlockReleaseBuffer(buffer);
 }
 
+static void
+btree_xlog_dedup(XLogReaderState *record)
+{
+	XLogRecPtr	lsn = record->EndRecPtr;
+	xl_btree_dedup *xlrec = (xl_btree_dedup *) XLogRecGetData(record);
+	Buffer		buffer;
+
+	if (XLogReadBufferForRedo(record, 0, &buffer) == BLK_NEEDS_REDO)
+	{
+		Page		page = (Page) BufferGetPage(buffer);
+		BTDedupInterval *intervals;
+		Size		len;
+		Page		newpage;
+
+		intervals = (BTDedupInterval *) XLogRecGetBlockData(record, 0, &len);
+		Assert(len == xlrec->nintervals * sizeof(BTDedupInterval));
+
+		newpage = _bt_dedup_build_page(page, intervals, xlrec->nintervals);
+		PageRestoreTempPage(newpage, page);
+
+		PageSetLSN(page, lsn);
+		MarkBufferDirty(buffer);
+	}
+	if (BufferIsValid(buffer))
+		UnlockReleaseBuffer(buffer);
+}
+
 /*
  * Get the latestRemovedXid from the heap pages pointed at by the index
  * tuples being deleted. This puts the work for calculating latestRemovedXid
@@ -534,8 +574,11 @@ btree_xlog_delete_get_latestRemovedXid(XLogReaderState *record)
 	HeapTupleHeader htuphdr;
 	BlockNumber hblkno;
 	OffsetNumber hoffnum;
+	ItemPointer htids;
+	int			nhtids;
 	TransactionId latestRemovedXid = InvalidTransactionId;
-	int			i;
+	int			i,
+				j;
 
 	/*
 	 * If there's nothing running on the standby we don't need to derive a
@@ -588,63 +631,83 @@ btree_xlog_delete_get_latestRemovedXid(XLogReaderState *record)
 		iitemid = PageGetItemId(ipage, unused[i]);
 		itup = (IndexTuple) PageGetItem(ipage, iitemid);
 
-		/*
-		 * Locate the heap page that the index tuple points at
-		 */
-		hblkno = ItemPointerGetBlockNumber(&(itup->t_tid));
-		hbuffer = XLogReadBufferExtended(xlrec->hnode, MAIN_FORKNUM, hblkno, RBM_NORMAL);
-		if (!BufferIsValid(hbuffer))
+		if (BTreeTupleIsPosting(itup))
 		{
-			UnlockReleaseBuffer(ibuffer);
-			return InvalidTransactionId;
+			htids = BTreeTupleGetPosting(itup);
+			nhtids = BTreeTupleGetNPosting(itup);
 		}
-		LockBuffer(hbuffer, BUFFER_LOCK_SHARE);
-		hpage = (Page) BufferGetPage(hbuffer);
-
-		/*
-		 * Look up the heap tuple header that the index tuple points at by
-		 * using the heap node supplied with the xlrec. We can't use
-		 * heap_fetch, since it uses ReadBuffer rather than XLogReadBuffer.
-		 * Note that we are not looking at tuple data here, just headers.
-		 */
-		hoffnum = ItemPointerGetOffsetNumber(&(itup->t_tid));
-		hitemid = PageGetItemId(hpage, hoffnum);
-
-		/*
-		 * Follow any redirections until we find something useful.
-		 */
-		while (ItemIdIsRedirected(hitemid))
+		else
 		{
-			hoffnum = ItemIdGetRedirect(hitemid);
-			hitemid = PageGetItemId(hpage, hoffnum);
-			CHECK_FOR_INTERRUPTS();
+			htids = &itup->t_tid;
+			nhtids = 1;
 		}
 
 		/*
-		 * If the heap item has storage, then read the header and use that to
-		 * set latestRemovedXid.
-		 *
-		 * Some LP_DEAD items may not be accessible, so we ignore them.
+		 * A posting list tuple points at several heap tuples; look at each.
 		 */
-		if (ItemIdHasStorage(hitemid))
+		for (j = 0; j < nhtids; j++)
 		{
-			htuphdr = (HeapTupleHeader) PageGetItem(hpage, hitemid);
+			ItemPointer htid = &htids[j];
 
-			HeapTupleHeaderAdvanceLatestRemovedXid(htuphdr, &latestRemovedXid);
-		}
-		else if (ItemIdIsDead(hitemid))
-		{
 			/*
-			 * Conjecture: if hitemid is dead then it had xids before the xids
-			 * marked on LP_NORMAL items. So we just ignore this item and move
-			 * onto the next, for the purposes of calculating
-			 * latestRemovedxids.
+			 * Locate the heap page that the heap TID points at
 			 */
-		}
-		else
-			Assert(!ItemIdIsUsed(hitemid));
+			hblkno = ItemPointerGetBlockNumber(htid);
+			hbuffer = XLogReadBufferExtended(xlrec->hnode, MAIN_FORKNUM, hblkno, RBM_NORMAL);
+			if (!BufferIsValid(hbuffer))
+			{
+				UnlockReleaseBuffer(ibuffer);
+				return InvalidTransactionId;
+			}
+			LockBuffer(hbuffer, BUFFER_LOCK_SHARE);
+			hpage = (Page) BufferGetPage(hbuffer);
 
-		UnlockReleaseBuffer(hbuffer);
+			/*
+			 * Look up the heap tuple header that the index tuple points at
+			 * by using the heap node supplied with the xlrec. We can't use
+			 * heap_fetch, since it uses ReadBuffer rather than
+			 * XLogReadBuffer. Note that we are not looking at tuple data
+			 * here, just headers.
+			 */
+			hoffnum = ItemPointerGetOffsetNumber(htid);
+			hitemid = PageGetItemId(hpage, hoffnum);
+
+			/*
+			 * Follow any redirections until we find something useful.
+			 */
+			while (ItemIdIsRedirected(hitemid))
+			{
+				hoffnum = ItemIdGetRedirect(hitemid);
+				hitemid = PageGetItemId(hpage, hoffnum);
+				CHECK_FOR_INTERRUPTS();
+			}
+
+			/*
+			 * If the heap item has storage, then read the header and use that
+			 * to set latestRemovedXid.
+			 *
+			 * Some LP_DEAD items may not be accessible, so we ignore them.
+			 */
+			if (ItemIdHasStorage(hitemid))
+			{
+				htuphdr = (HeapTupleHeader) PageGetItem(hpage, hitemid);
+
+				HeapTupleHeaderAdvanceLatestRemovedXid(htuphdr, &latestRemovedXid);
+			}
+			else if (ItemIdIsDead(hitemid))
+			{
+				/*
+				 * Conjecture: if hitemid is dead then it had xids before the
+				 * xids marked on LP_NORMAL items. So we just ignore this item
+				 * and move onto the next, for the purposes of calculating
+				 * latestRemovedxids.
+				 */
+			}
+			else
+				Assert(!ItemIdIsUsed(hitemid));
+
+			UnlockReleaseBuffer(hbuffer);
+		}
 	}
 
 	UnlockReleaseBuffer(ibuffer);
@@ -759,7 +822,7 @@ btree_xlog_mark_page_halfdead(uint8 info, XLogReaderState *record)
 
 		itemid = PageGetItemId(page, poffset);
 		itup = (IndexTuple) PageGetItem(page, itemid);
-		ItemPointerSet(&(itup->t_tid), rightsib, P_HIKEY);
+		BTreeInnerTupleSetDownLink(itup, rightsib);
 		nextoffset = OffsetNumberNext(poffset);
 		PageIndexTupleDelete(page, nextoffset);
 
@@ -1013,6 +1076,9 @@ btree_redo(XLogReaderState *record)
 		case XLOG_BTREE_DELETE:
 			btree_xlog_delete(record);
 			break;
+		case XLOG_BTREE_DEDUP:
+			btree_xlog_dedup(record);
+			break;
 		case XLOG_BTREE_MARK_PAGE_HALFDEAD:
 			btree_xlog_mark_page_halfdead(info, record);
 			break;
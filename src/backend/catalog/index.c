@@ -109,6 +109,16 @@ static void UpdateIndexRelation(Oid indexoid, Oid heapoid,
 static void index_update_stats(Relation rel,
 				   bool hasindex, bool isprimary,
 				   double reltuples);
+static double IndexBuildHeapScanInternal(Relation heapRelation,
+						   Relation indexRelation,
+						   IndexInfo *indexInfo,
+						   bool allow_sync,
+						   bool anyvisible,
+						   BlockNumber start_blockno,
+						   BlockNumber numblocks,
+						   ParallelHeapScanDesc pscan,
+						   IndexBuildCallback callback,
+						   void *callback_state);
 static void IndexCheckExclusion(Relation heapRelation,
 					Relation indexRelation,
 					IndexInfo *indexInfo);
@@ -424,6 +434,13 @@ ConstructTupleDescriptor(Relation heapRelation,
 		namestrcpy(&to->attname, (const char *) lfirst(colnames_item));
 		colnames_item = lnext(colnames_item);
 
+		/*
+		 * Included (non-key) columns have no opclass, and are stored just as
+		 * they are in the heap.
+		 */
+		if (i >= indexInfo->ii_NumIndexKeyAttrs)
+			continue;
+
 		/*
 		 * Check the opclass and index AM to see if either provides a keytype
 		 * (overriding the attribute type).  Opclass takes precedence.
@@ -622,6 +639,7 @@ UpdateIndexRelation(Oid indexoid,
 	values[Anum_pg_index_indexrelid - 1] = ObjectIdGetDatum(indexoid);
 	values[Anum_pg_index_indrelid - 1] = ObjectIdGetDatum(heapoid);
 	values[Anum_pg_index_indnatts - 1] = Int16GetDatum(indexInfo->ii_NumIndexAttrs);
+	values[Anum_pg_index_indnkeyatts - 1] = Int16GetDatum(indexInfo->ii_NumIndexKeyAttrs);
 	values[Anum_pg_index_indisunique - 1] = BoolGetDatum(indexInfo->ii_Unique);
 	values[Anum_pg_index_indisprimary - 1] = BoolGetDatum(primary);
 	values[Anum_pg_index_indisexclusion - 1] = BoolGetDatum(isexclusion);
@@ -1024,7 +1042,7 @@ index_create(Relation heapRelation,
 		}
 
 		/* Store dependency on operator classes */
-		for (i = 0; i < indexInfo->ii_NumIndexAttrs; i++)
+		for (i = 0; i < indexInfo->ii_NumIndexKeyAttrs; i++)
 		{
 			referenced.classId = OperatorClassRelationId;
 			referenced.objectId = classObjectId[i];
@@ -1202,7 +1220,7 @@ index_constraint_create(Relation heapRelation,
 								   true,
 								   RelationGetRelid(heapRelation),
 								   indexInfo->ii_KeyAttrNumbers,
-								   indexInfo->ii_NumIndexAttrs,
+								   indexInfo->ii_NumIndexKeyAttrs,
 								   InvalidOid,	/* no domain */
 								   indexRelationId, /* index OID */
 								   InvalidOid,	/* no foreign key */
@@ -1649,6 +1667,9 @@ BuildIndexInfo(Relation index)
 		elog(ERROR, "invalid indnatts %d for index %u",
 			 numKeys, RelationGetRelid(index));
 	ii->ii_NumIndexAttrs = numKeys;
+	ii->ii_NumIndexKeyAttrs = indexStruct->indnkeyatts;
+	Assert(ii->ii_NumIndexKeyAttrs != 0 &&
+		   ii->ii_NumIndexKeyAttrs <= ii->ii_NumIndexAttrs);
 	for (i = 0; i < numKeys; i++)
 		ii->ii_KeyAttrNumbers[i] = indexStruct->indkey.values[i];
 
@@ -1709,7 +1730,7 @@ BuildIndexInfo(Relation index)
 void
 BuildSpeculativeIndexInfo(Relation index, IndexInfo *ii)
 {
-	int			ncols = index->rd_rel->relnatts;
+	int			ncols = IndexRelationGetNumberOfKeyAttributes(index);
 	int			i;
 
 	/*
@@ -2203,6 +2224,51 @@ IndexBuildHeapRangeScan(Relation heapRelation,
 						BlockNumber numblocks,
 						IndexBuildCallback callback,
 						void *callback_state)
+{
+	return IndexBuildHeapScanInternal(heapRelation, indexRelation,
+									  indexInfo, allow_sync, anyvisible,
+									  start_blockno, numblocks, NULL,
+									  callback, callback_state);
+}
+
+/*
+ * As IndexBuildHeapScan, except that the heap is read through a parallel heap
+ * scan shared with other processes, so that each caller sees only the blocks
+ * handed out to it.  The parallel scan must have been initialized with
+ * SnapshotAny, or with an MVCC snapshot for a concurrent build.  Syncscan
+ * reporting is governed by the shared scan descriptor.
+ */
+double
+IndexBuildHeapParallelScan(Relation heapRelation,
+						   Relation indexRelation,
+						   IndexInfo *indexInfo,
+						   ParallelHeapScanDesc pscan,
+						   IndexBuildCallback callback,
+						   void *callback_state)
+{
+	Assert(pscan != NULL);
+
+	return IndexBuildHeapScanInternal(heapRelation, indexRelation,
+									  indexInfo, false, false,
+									  0, InvalidBlockNumber, pscan,
+									  callback, callback_state);
+}
+
+/*
+ * Workhorse for the above.  If pscan isn't NULL, allow_sync and the block
+ * range are ignored, and the scan joins the given parallel heap scan.
+ */
+static double
+IndexBuildHeapScanInternal(Relation heapRelation,
+						   Relation indexRelation,
+						   IndexInfo *indexInfo,
+						   bool allow_sync,
+						   bool anyvisible,
+						   BlockNumber start_blockno,
+						   BlockNumber numblocks,
+						   ParallelHeapScanDesc pscan,
+						   IndexBuildCallback callback,
+						   void *callback_state)
 {
 	bool		is_system_catalog;
 	bool		checking_uniqueness;
@@ -2259,30 +2325,52 @@ IndexBuildHeapRangeScan(Relation heapRelation,
 	 * concurrent build, or during bootstrap, we take a regular MVCC snapshot
 	 * and index whatever's live according to that.
 	 */
-	if (IsBootstrapProcessingMode() || indexInfo->ii_Concurrent)
+	if (pscan != NULL)
 	{
-		snapshot = RegisterSnapshot(GetTransactionSnapshot());
-		OldestXmin = InvalidTransactionId;	/* not used */
-
-		/* "any visible" mode is not compatible with this */
-		Assert(!anyvisible);
+		/*
+		 * The snapshot travels with the parallel scan descriptor; it is
+		 * registered and released by the scan itself.
+		 */
+		scan = heap_beginscan_parallel(heapRelation, pscan);
+		snapshot = scan->rs_snapshot;
+		if (IsMVCCSnapshot(snapshot))
+			OldestXmin = InvalidTransactionId;	/* not used */
+		else
+		{
+			Assert(snapshot == SnapshotAny);
+			/* okay to ignore lazy VACUUMs here */
+			OldestXmin = GetOldestXmin(heapRelation, PROCARRAY_FLAGS_VACUUM);
+		}
 	}
 	else
 	{
-		snapshot = SnapshotAny;
-		/* okay to ignore lazy VACUUMs here */
-		OldestXmin = GetOldestXmin(heapRelation, PROCARRAY_FLAGS_VACUUM);
-	}
+		if (IsBootstrapProcessingMode() || indexInfo->ii_Concurrent)
+		{
+			snapshot = RegisterSnapshot(GetTransactionSnapshot());
+			OldestXmin = InvalidTransactionId;	/* not used */
 
-	scan = heap_beginscan_strat(heapRelation,	/* relation */
-								snapshot,	/* snapshot */
-								0,	/* number of keys */
-								NULL,	/* scan key */
-								true,	/* buffer access strategy OK */
-								allow_sync);	/* syncscan OK? */
+			/* "any visible" mode is not compatible with this */
+			Assert(!anyvisible);
+		}
+		else
+		{
+			snapshot = SnapshotAny;
+			/* okay to ignore lazy VACUUMs here */
+			OldestXmin = GetOldestXmin(heapRelation, PROCARRAY_FLAGS_VACUUM);
+		}
+
+		scan = heap_beginscan_strat(heapRelation,	/* relation */
+									snapshot,	/* snapshot */
+									0,	/* number of keys */
+									NULL,	/* scan key */
+									true,	/* buffer access strategy OK */
+									allow_sync);	/* syncscan OK? */
+	}
 
-	/* set our scan endpoints */
-	if (!allow_sync)
+	/* set our scan endpoints; a parallel scan always covers the whole rel */
+	if (pscan != NULL)
+		Assert(start_blockno == 0 && numblocks == InvalidBlockNumber);
+	else if (!allow_sync)
 		heap_setscanlimits(scan, start_blockno, numblocks);
 	else
 	{
@@ -2611,7 +2699,8 @@ IndexBuildHeapRangeScan(Relation heapRelation,
 	heap_endscan(scan);
 
 	/* we can now forget our snapshot, if set */
-	if (IsBootstrapProcessingMode() || indexInfo->ii_Concurrent)
+	if (pscan == NULL &&
+		(IsBootstrapProcessingMode() || indexInfo->ii_Concurrent))
 		UnregisterSnapshot(snapshot);
 
 	ExecDropSingleTupleTableSlot(slot);
@@ -139,6 +139,12 @@ static int32 partition_bound_cmp(PartitionKey key,
 static int partition_bound_bsearch(PartitionKey key,
 						PartitionBoundInfo boundinfo,
 						void *probe, bool probe_is_bound, bool *is_equal);
+static int32 partition_bound_first_cmp(PartitionKey key,
+						  PartitionBoundInfo boundinfo,
+						  int offset, Datum value);
+static int partition_bound_first_bsearch(PartitionKey key,
+							  PartitionBoundInfo boundinfo,
+							  Datum value, bool or_equal);
 
 /*
  * RelationBuildPartitionDesc
@@ -583,7 +589,7 @@ RelationBuildPartitionDesc(Relation rel)
  * representation of partition bounds.
  */
 bool
-partition_bounds_equal(PartitionKey key,
+partition_bounds_equal(int partnatts, int16 *parttyplen, bool *parttypbyval,
 					   PartitionBoundInfo b1, PartitionBoundInfo b2)
 {
 	int			i;
@@ -601,7 +607,7 @@ partition_bounds_equal(PartitionKey key,
 	{
 		int			j;
 
-		for (j = 0; j < key->partnatts; j++)
+		for (j = 0; j < partnatts; j++)
 		{
 			/* For range partitions, the bounds might not be finite. */
 			if (b1->kind != NULL)
@@ -627,8 +633,7 @@ partition_bounds_equal(PartitionKey key,
 			 * context.  datumIsEqual() should be simple enough to be safe.
 			 */
 			if (!datumIsEqual(b1->datums[i][j], b2->datums[i][j],
-							  key->parttypbyval[j],
-							  key->parttyplen[j]))
+							  parttypbyval[j], parttyplen[j]))
 				return false;
 		}
 
@@ -637,13 +642,85 @@ partition_bounds_equal(PartitionKey key,
 	}
 
 	/* There are ndatums+1 indexes in case of range partitions */
-	if (key->strategy == PARTITION_STRATEGY_RANGE &&
+	if (b1->strategy == PARTITION_STRATEGY_RANGE &&
 		b1->indexes[i] != b2->indexes[i])
 		return false;
 
 	return true;
 }
 
+/*
+ * Return a copy of given PartitionBoundInfo structure. The data types of bounds
+ * are described by given partition key specification.
+ *
+ * The planner keeps such a copy for each partitioned relation it may join
+ * partition-wise, since the relcache entry's bounds can go away once the
+ * relation is closed.
+ */
+PartitionBoundInfo
+partition_bounds_copy(PartitionBoundInfo src, PartitionKey key)
+{
+	PartitionBoundInfo dest;
+	int			i;
+	int			ndatums;
+	int			partnatts;
+	int			num_indexes;
+
+	dest = (PartitionBoundInfo) palloc(sizeof(PartitionBoundInfoData));
+
+	dest->strategy = src->strategy;
+	ndatums = dest->ndatums = src->ndatums;
+	partnatts = key->partnatts;
+
+	/* Range partitioned tables have an extra index. */
+	num_indexes = (key->strategy == PARTITION_STRATEGY_RANGE) ?
+		ndatums + 1 : ndatums;
+
+	/* List partitioned tables have only a single partition key. */
+	Assert(key->strategy != PARTITION_STRATEGY_LIST || partnatts == 1);
+
+	dest->datums = (Datum **) palloc(sizeof(Datum *) * ndatums);
+
+	if (src->kind != NULL)
+	{
+		dest->kind = (PartitionRangeDatumKind **) palloc(ndatums *
+														 sizeof(PartitionRangeDatumKind *));
+		for (i = 0; i < ndatums; i++)
+		{
+			dest->kind[i] = (PartitionRangeDatumKind *) palloc(partnatts *
+															   sizeof(PartitionRangeDatumKind));
+
+			memcpy(dest->kind[i], src->kind[i],
+				   sizeof(PartitionRangeDatumKind) * partnatts);
+		}
+	}
+	else
+		dest->kind = NULL;
+
+	for (i = 0; i < ndatums; i++)
+	{
+		int			j;
+
+		dest->datums[i] = (Datum *) palloc(sizeof(Datum) * partnatts);
+
+		for (j = 0; j < partnatts; j++)
+		{
+			if (dest->kind == NULL ||
+				dest->kind[i][j] == PARTITION_RANGE_DATUM_VALUE)
+				dest->datums[i][j] = datumCopy(src->datums[i][j],
+											   key->parttypbyval[j],
+											   key->parttyplen[j]);
+		}
+	}
+
+	dest->indexes = (int *) palloc(sizeof(int) * num_indexes);
+	memcpy(dest->indexes, src->indexes, sizeof(int) * num_indexes);
+
+	dest->null_index = src->null_index;
+
+	return dest;
+}
+
 /*
  * check_new_partition_bound
  *
@@ -2339,3 +2416,272 @@ partition_bound_bsearch(PartitionKey key, PartitionBoundInfo boundinfo,
 
 	return lo;
 }
+
+/*
+ * partition_bound_first_cmp
+ *
+ * Return whether the first column of the bound at offset in boundinfo is
+ * <, =, or > value.
+ */
+static int32
+partition_bound_first_cmp(PartitionKey key, PartitionBoundInfo boundinfo,
+						  int offset, Datum value)
+{
+	if (key->strategy == PARTITION_STRATEGY_RANGE)
+	{
+		PartitionRangeDatumKind kind = boundinfo->kind[offset][0];
+
+		if (kind == PARTITION_RANGE_DATUM_MINVALUE)
+			return -1;
+		else if (kind == PARTITION_RANGE_DATUM_MAXVALUE)
+			return 1;
+	}
+
+	return DatumGetInt32(FunctionCall2Coll(&key->partsupfunc[0],
+										   key->partcollation[0],
+										   boundinfo->datums[offset][0],
+										   value));
+}
+
+/*
+ * Binary search on the first column of a collection of partition bounds.
+ * Returns the number of bounds whose first column is less than value, or
+ * less than or equal to it if or_equal; that is, the offset of the first
+ * bound that is not.
+ */
+static int
+partition_bound_first_bsearch(PartitionKey key, PartitionBoundInfo boundinfo,
+							  Datum value, bool or_equal)
+{
+	int			lo,
+				hi,
+				mid;
+
+	lo = 0;
+	hi = boundinfo->ndatums;
+	while (lo < hi)
+	{
+		int32		cmpval;
+
+		mid = (lo + hi) / 2;
+		cmpval = partition_bound_first_cmp(key, boundinfo, mid, value);
+		if (cmpval < 0 || (or_equal && cmpval == 0))
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+/*
+ * partition_prune_range_add
+ *
+ * Narrow *range by the condition "key <strategy> value", where strategy is
+ * a btree strategy number of an operator in the partition key's operator
+ * family, or one of PARTITION_PRUNE_IS_NULL and PARTITION_PRUNE_IS_NOT_NULL
+ * (value is ignored then).
+ *
+ * Returns false if the condition can't be true for any row, which happens
+ * if value is NULL, since btree operators are strict.
+ */
+bool
+partition_prune_range_add(PartitionKey key, PartitionPruneRange *range,
+						  int strategy, Datum value, bool isnull)
+{
+	bool		set_lower = false;
+	bool		set_upper = false;
+	bool		inclusive = true;
+	int32		cmpval;
+
+	if (strategy == PARTITION_PRUNE_IS_NULL)
+	{
+		range->isnull = true;
+		return true;
+	}
+	if (strategy == PARTITION_PRUNE_IS_NOT_NULL)
+	{
+		range->notnull = true;
+		return true;
+	}
+
+	if (isnull)
+		return false;
+	range->notnull = true;
+
+	switch (strategy)
+	{
+		case BTLessStrategyNumber:
+			inclusive = false;
+			/* fall through */
+		case BTLessEqualStrategyNumber:
+			set_upper = true;
+			break;
+		case BTEqualStrategyNumber:
+			set_lower = set_upper = true;
+			break;
+		case BTGreaterStrategyNumber:
+			inclusive = false;
+			/* fall through */
+		case BTGreaterEqualStrategyNumber:
+			set_lower = true;
+			break;
+		default:
+			elog(ERROR, "unexpected btree strategy number: %d", strategy);
+	}
+
+	/* Keep whichever of the old and the new bound is tighter */
+	if (set_lower)
+	{
+		if (range->has_lower)
+		{
+			cmpval = DatumGetInt32(FunctionCall2Coll(&key->partsupfunc[0],
+													 key->partcollation[0],
+													 value, range->lower));
+			if (cmpval < 0 ||
+				(cmpval == 0 && (inclusive || !range->lower_inclusive)))
+				set_lower = false;
+		}
+		if (set_lower)
+		{
+			range->has_lower = true;
+			range->lower = value;
+			range->lower_inclusive = inclusive;
+		}
+	}
+	if (set_upper)
+	{
+		if (range->has_upper)
+		{
+			cmpval = DatumGetInt32(FunctionCall2Coll(&key->partsupfunc[0],
+													 key->partcollation[0],
+													 value, range->upper));
+			if (cmpval > 0 ||
+				(cmpval == 0 && (inclusive || !range->upper_inclusive)))
+				set_upper = false;
+		}
+		if (set_upper)
+		{
+			range->has_upper = true;
+			range->upper = value;
+			range->upper_inclusive = inclusive;
+		}
+	}
+
+	return true;
+}
+
+/*
+ * get_partitions_for_prune_range
+ *
+ * Return the indexes, in partdesc, of the partitions that may contain rows
+ * whose first partition key column satisfies all of the conditions in
+ * *range.  The answer is exact for single-column keys and conservative
+ * otherwise: a range partition is kept if its bounds' first columns allow
+ * any matching value.
+ */
+Bitmapset *
+get_partitions_for_prune_range(PartitionKey key, PartitionDesc partdesc,
+							   PartitionPruneRange *range)
+{
+	PartitionBoundInfo boundinfo = partdesc->boundinfo;
+	Bitmapset  *result = NULL;
+	int			i;
+
+	if (partdesc->nparts == 0)
+		return NULL;
+
+	/* Nothing to prune with? */
+	if (!range->isnull && !range->notnull)
+	{
+		for (i = 0; i < partdesc->nparts; i++)
+			result = bms_add_member(result, i);
+		return result;
+	}
+
+	/* NULLs match no operator, and range partitions never contain them */
+	if (range->isnull)
+	{
+		if (!range->notnull && key->strategy == PARTITION_STRATEGY_LIST &&
+			partition_bound_accepts_nulls(boundinfo))
+			result = bms_make_singleton(boundinfo->null_index);
+		return result;
+	}
+
+	/* Is the range empty? */
+	if (range->has_lower && range->has_upper)
+	{
+		int32		cmpval;
+
+		cmpval = DatumGetInt32(FunctionCall2Coll(&key->partsupfunc[0],
+												 key->partcollation[0],
+												 range->lower, range->upper));
+		if (cmpval > 0 ||
+			(cmpval == 0 && !(range->lower_inclusive && range->upper_inclusive)))
+			return NULL;
+	}
+
+	switch (key->strategy)
+	{
+		case PARTITION_STRATEGY_LIST:
+			{
+				int			start = 0;
+				int			end = boundinfo->ndatums;
+
+				/* The bound datums are sorted; find the ones in the range */
+				if (range->has_lower)
+					start = partition_bound_first_bsearch(key, boundinfo,
+														  range->lower,
+														  !range->lower_inclusive);
+				if (range->has_upper)
+					end = partition_bound_first_bsearch(key, boundinfo,
+														range->upper,
+														range->upper_inclusive);
+				for (i = start; i < end; i++)
+					result = bms_add_member(result, boundinfo->indexes[i]);
+				break;
+			}
+
+		case PARTITION_STRATEGY_RANGE:
+			{
+				int			minregion = 0;
+				int			maxregion = boundinfo->ndatums;
+
+				/*
+				 * The bounds divide the key space into ndatums + 1 regions;
+				 * region i lies between bounds i - 1 and i, and belongs to
+				 * partition indexes[i] (see get_partition_for_tuple).  The
+				 * first region we need is the first one whose upper bound is
+				 * above the range's lower bound.  With more key columns, rows
+				 * whose first column equals the upper bound's first column
+				 * may still be in the region, so include that case too.
+				 */
+				if (range->has_lower)
+					minregion = partition_bound_first_bsearch(key, boundinfo,
+															  range->lower,
+															  key->partnatts == 1);
+
+				/*
+				 * The last region we need is the last one whose lower bound
+				 * is not above the range's upper bound.
+				 */
+				if (range->has_upper)
+					maxregion = partition_bound_first_bsearch(key, boundinfo,
+															  range->upper,
+															  range->upper_inclusive);
+
+				for (i = minregion; i <= maxregion; i++)
+				{
+					if (boundinfo->indexes[i] >= 0)
+						result = bms_add_member(result, boundinfo->indexes[i]);
+				}
+				break;
+			}
+
+		default:
+			elog(ERROR, "unexpected partition strategy: %d",
+				 (int) key->strategy);
+	}
+
+	return result;
+}
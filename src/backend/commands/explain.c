@@ -80,6 +80,8 @@ static void show_upper_qual(List *qual, const char *qlabel,
 				ExplainState *es);
 static void show_sort_keys(SortState *sortstate, List *ancestors,
 			   ExplainState *es);
+static void show_incremental_sort_keys(IncrementalSortState *incrsortstate,
+						   List *ancestors, ExplainState *es);
 static void show_merge_append_keys(MergeAppendState *mstate, List *ancestors,
 					   ExplainState *es);
 static void show_agg_keys(AggState *astate, List *ancestors,
@@ -101,7 +103,13 @@ static void show_sortorder_options(StringInfo buf, Node *sortexpr,
 static void show_tablesample(TableSampleClause *tsc, PlanState *planstate,
 				 List *ancestors, ExplainState *es);
 static void show_sort_info(SortState *sortstate, ExplainState *es);
+static void show_incremental_sort_info(IncrementalSortState *incrsortstate,
+						   ExplainState *es);
 static void show_hash_info(HashState *hashstate, ExplainState *es);
+static void show_memoize_info(MemoizeState *mstate, List *ancestors,
+				  ExplainState *es);
+static void show_hashagg_info(AggState *aggstate, ExplainState *es);
+static void show_pruned_subplans(int nplans, int nsubnodes, ExplainState *es);
 static void show_tidbitmap_info(BitmapHeapScanState *planstate,
 					ExplainState *es);
 static void show_instrumentation_count(const char *qlabel, int which,
@@ -116,7 +124,7 @@ static void ExplainModifyTarget(ModifyTable *plan, ExplainState *es);
 static void ExplainTargetRel(Plan *plan, Index rti, ExplainState *es);
 static void show_modifytable_info(ModifyTableState *mtstate, List *ancestors,
 					  ExplainState *es);
-static void ExplainMemberNodes(List *plans, PlanState **planstates,
+static void ExplainMemberNodes(PlanState **planstates, int nplans,
 				   List *ancestors, ExplainState *es);
 static void ExplainSubPlans(List *plans, List *ancestors,
 				const char *relationship, ExplainState *es);
@@ -1013,9 +1021,15 @@ ExplainNode(PlanState *planstate, List *ancestors,
 		case T_Material:
 			pname = sname = "Materialize";
 			break;
+		case T_Memoize:
+			pname = sname = "Memoize";
+			break;
 		case T_Sort:
 			pname = sname = "Sort";
 			break;
+		case T_IncrementalSort:
+			pname = sname = "Incremental Sort";
+			break;
 		case T_Group:
 			pname = sname = "Group";
 			break;
@@ -1120,6 +1134,8 @@ ExplainNode(PlanState *planstate, List *ancestors,
 		}
 		if (plan->parallel_aware)
 			appendStringInfoString(es->str, "Parallel ");
+		if (plan->async_capable)
+			appendStringInfoString(es->str, "Async ");
 		appendStringInfoString(es->str, pname);
 		es->indent++;
 	}
@@ -1139,6 +1155,8 @@ ExplainNode(PlanState *planstate, List *ancestors,
 		if (custom_name)
 			ExplainPropertyText("Custom Plan Provider", custom_name, es);
 		ExplainPropertyBool("Parallel Aware", plan->parallel_aware, es);
+		if (plan->async_capable)
+			ExplainPropertyBool("Async Capable", plan->async_capable, es);
 	}
 
 	switch (nodeTag(plan))
@@ -1377,6 +1395,8 @@ ExplainNode(PlanState *planstate, List *ancestors,
 	switch (nodeTag(plan))
 	{
 		case T_IndexScan:
+			if (((IndexScan *) plan)->indexskip)
+				ExplainPropertyBool("Skip Scan", true, es);
 			show_scan_qual(((IndexScan *) plan)->indexqualorig,
 						   "Index Cond", planstate, ancestors, es);
 			if (((IndexScan *) plan)->indexqualorig)
@@ -1388,8 +1408,13 @@ ExplainNode(PlanState *planstate, List *ancestors,
 			if (plan->qual)
 				show_instrumentation_count("Rows Removed by Filter", 1,
 										   planstate, es);
+			if (((Scan *) plan)->rtfilter_id != 0)
+				show_instrumentation_count("Rows Removed by Bloom Filter", 3,
+										   planstate, es);
 			break;
 		case T_IndexOnlyScan:
+			if (((IndexOnlyScan *) plan)->indexskip)
+				ExplainPropertyBool("Skip Scan", true, es);
 			show_scan_qual(((IndexOnlyScan *) plan)->indexqual,
 						   "Index Cond", planstate, ancestors, es);
 			if (((IndexOnlyScan *) plan)->indexqual)
@@ -1419,6 +1444,9 @@ ExplainNode(PlanState *planstate, List *ancestors,
 			if (plan->qual)
 				show_instrumentation_count("Rows Removed by Filter", 1,
 										   planstate, es);
+			if (((Scan *) plan)->rtfilter_id != 0)
+				show_instrumentation_count("Rows Removed by Bloom Filter", 3,
+										   planstate, es);
 			if (es->analyze)
 				show_tidbitmap_info((BitmapHeapScanState *) planstate, es);
 			break;
@@ -1436,6 +1464,13 @@ ExplainNode(PlanState *planstate, List *ancestors,
 			if (plan->qual)
 				show_instrumentation_count("Rows Removed by Filter", 1,
 										   planstate, es);
+			if (((Scan *) plan)->rtfilter_id != 0)
+				show_instrumentation_count("Rows Removed by Bloom Filter", 3,
+										   planstate, es);
+			break;
+		case T_Append:
+			show_pruned_subplans(list_length(((Append *) plan)->appendplans),
+								 ((AppendState *) planstate)->as_nplans, es);
 			break;
 		case T_Gather:
 			{
@@ -1594,6 +1629,8 @@ ExplainNode(PlanState *planstate, List *ancestors,
 			if (plan->qual)
 				show_instrumentation_count("Rows Removed by Filter", 1,
 										   planstate, es);
+			if (es->analyze)
+				show_hashagg_info(castNode(AggState, planstate), es);
 			break;
 		case T_Group:
 			show_group_keys(castNode(GroupState, planstate), ancestors, es);
@@ -1606,9 +1643,18 @@ ExplainNode(PlanState *planstate, List *ancestors,
 			show_sort_keys(castNode(SortState, planstate), ancestors, es);
 			show_sort_info(castNode(SortState, planstate), es);
 			break;
+		case T_IncrementalSort:
+			show_incremental_sort_keys(castNode(IncrementalSortState, planstate),
+									   ancestors, es);
+			show_incremental_sort_info(castNode(IncrementalSortState, planstate),
+									   es);
+			break;
 		case T_MergeAppend:
 			show_merge_append_keys(castNode(MergeAppendState, planstate),
 								   ancestors, es);
+			show_pruned_subplans(list_length(((MergeAppend *) plan)->mergeplans),
+								 ((MergeAppendState *) planstate)->ms_nplans,
+								 es);
 			break;
 		case T_Result:
 			show_upper_qual((List *) ((Result *) plan)->resconstantqual,
@@ -1625,6 +1671,10 @@ ExplainNode(PlanState *planstate, List *ancestors,
 		case T_Hash:
 			show_hash_info(castNode(HashState, planstate), es);
 			break;
+		case T_Memoize:
+			show_memoize_info(castNode(MemoizeState, planstate), ancestors,
+							  es);
+			break;
 		default:
 			break;
 	}
@@ -1738,28 +1788,28 @@ ExplainNode(PlanState *planstate, List *ancestors,
 	switch (nodeTag(plan))
 	{
 		case T_ModifyTable:
-			ExplainMemberNodes(((ModifyTable *) plan)->plans,
-							   ((ModifyTableState *) planstate)->mt_plans,
+			ExplainMemberNodes(((ModifyTableState *) planstate)->mt_plans,
+							   ((ModifyTableState *) planstate)->mt_nplans,
 							   ancestors, es);
 			break;
 		case T_Append:
-			ExplainMemberNodes(((Append *) plan)->appendplans,
-							   ((AppendState *) planstate)->appendplans,
+			ExplainMemberNodes(((AppendState *) planstate)->appendplans,
+							   ((AppendState *) planstate)->as_nplans,
 							   ancestors, es);
 			break;
 		case T_MergeAppend:
-			ExplainMemberNodes(((MergeAppend *) plan)->mergeplans,
-							   ((MergeAppendState *) planstate)->mergeplans,
+			ExplainMemberNodes(((MergeAppendState *) planstate)->mergeplans,
+							   ((MergeAppendState *) planstate)->ms_nplans,
 							   ancestors, es);
 			break;
 		case T_BitmapAnd:
-			ExplainMemberNodes(((BitmapAnd *) plan)->bitmapplans,
-							   ((BitmapAndState *) planstate)->bitmapplans,
+			ExplainMemberNodes(((BitmapAndState *) planstate)->bitmapplans,
+							   ((BitmapAndState *) planstate)->nplans,
 							   ancestors, es);
 			break;
 		case T_BitmapOr:
-			ExplainMemberNodes(((BitmapOr *) plan)->bitmapplans,
-							   ((BitmapOrState *) planstate)->bitmapplans,
+			ExplainMemberNodes(((BitmapOrState *) planstate)->bitmapplans,
+							   ((BitmapOrState *) planstate)->nplans,
 							   ancestors, es);
 			break;
 		case T_SubqueryScan:
@@ -1939,6 +1989,27 @@ show_sort_keys(SortState *sortstate, List *ancestors, ExplainState *es)
 						 ancestors, es);
 }
 
+/*
+ * Show the sort keys for an IncrementalSort node, and which of them the
+ * input is already sorted by.
+ */
+static void
+show_incremental_sort_keys(IncrementalSortState *incrsortstate,
+						   List *ancestors, ExplainState *es)
+{
+	IncrementalSort *plan = (IncrementalSort *) incrsortstate->ss.ps.plan;
+
+	show_sort_group_keys((PlanState *) incrsortstate, "Sort Key",
+						 plan->sort.numCols, plan->sort.sortColIdx,
+						 plan->sort.sortOperators, plan->sort.collations,
+						 plan->sort.nullsFirst,
+						 ancestors, es);
+	show_sort_group_keys((PlanState *) incrsortstate, "Presorted Key",
+						 plan->nPresortedCols, plan->sort.sortColIdx,
+						 NULL, NULL, NULL,
+						 ancestors, es);
+}
+
 /*
  * Likewise, for a MergeAppend node.
  */
@@ -2317,6 +2388,122 @@ show_sort_info(SortState *sortstate, ExplainState *es)
 	}
 }
 
+/*
+ * If it's EXPLAIN ANALYZE, show how many batches an IncrementalSort node
+ * sorted, and the most space any of them took.
+ */
+static void
+show_incremental_sort_info(IncrementalSortState *incrsortstate,
+						   ExplainState *es)
+{
+	if (!es->analyze || incrsortstate->nbatches == 0)
+		return;
+
+	if (es->format == EXPLAIN_FORMAT_TEXT)
+	{
+		appendStringInfoSpaces(es->str, es->indent * 2);
+		appendStringInfo(es->str, "Sort Batches: %ld  Peak %s: %ldkB\n",
+						 incrsortstate->nbatches,
+						 incrsortstate->maxSpaceType,
+						 incrsortstate->maxSpaceUsed);
+	}
+	else
+	{
+		ExplainPropertyLong("Sort Batches", incrsortstate->nbatches, es);
+		ExplainPropertyLong("Peak Sort Space Used",
+							incrsortstate->maxSpaceUsed, es);
+		ExplainPropertyText("Peak Sort Space Type",
+							incrsortstate->maxSpaceType, es);
+	}
+}
+
+/*
+ * Show how many subplans of an Append or MergeAppend the executor removed
+ * by partition pruning while initializing the node.
+ */
+static void
+show_pruned_subplans(int nplans, int nsubnodes, ExplainState *es)
+{
+	if (nsubnodes < nplans)
+		ExplainPropertyInteger("Subplans Removed", nplans - nsubnodes, es);
+}
+
+/*
+ * Show the cache key of a Memoize node and, for EXPLAIN ANALYZE, how well
+ * the cache worked.
+ */
+static void
+show_memoize_info(MemoizeState *mstate, List *ancestors, ExplainState *es)
+{
+	Plan	   *plan = ((PlanState *) mstate)->plan;
+	ListCell   *lc;
+	List	   *context;
+	StringInfoData keystr;
+	char	   *separator = "";
+	bool		useprefix;
+	int64		memPeakKb;
+
+	initStringInfo(&keystr);
+
+	/*
+	 * It's hard to imagine having a memoize node with fewer than 2 RTEs, but
+	 * let's just keep the same useprefix logic as elsewhere in this file.
+	 */
+	useprefix = list_length(es->rtable) > 1 || es->verbose;
+
+	/* Set up deparsing context */
+	context = set_deparse_context_planstate(es->deparse_cxt,
+											(Node *) mstate,
+											ancestors);
+
+	foreach(lc, ((Memoize *) plan)->param_exprs)
+	{
+		Node	   *expr = (Node *) lfirst(lc);
+
+		appendStringInfoString(&keystr, separator);
+
+		appendStringInfoString(&keystr, deparse_expression(expr, context,
+														   useprefix, false));
+		separator = ", ";
+	}
+
+	ExplainPropertyText("Cache Key", keystr.data, es);
+
+	pfree(keystr.data);
+
+	if (!es->analyze)
+		return;
+
+	/*
+	 * mem_peak is only set when we freed memory, so we must use mem_used when
+	 * mem_peak is 0.
+	 */
+	if (mstate->stats.mem_peak > 0)
+		memPeakKb = (mstate->stats.mem_peak + 1023) / 1024;
+	else
+		memPeakKb = (mstate->mem_used + 1023) / 1024;
+
+	if (es->format != EXPLAIN_FORMAT_TEXT)
+	{
+		ExplainPropertyLong("Cache Hits", (long) mstate->stats.cache_hits, es);
+		ExplainPropertyLong("Cache Misses", (long) mstate->stats.cache_misses, es);
+		ExplainPropertyLong("Cache Evictions", (long) mstate->stats.cache_evictions, es);
+		ExplainPropertyLong("Cache Overflows", (long) mstate->stats.cache_overflows, es);
+		ExplainPropertyLong("Peak Memory Usage", (long) memPeakKb, es);
+	}
+	else
+	{
+		appendStringInfoSpaces(es->str, es->indent * 2);
+		appendStringInfo(es->str,
+						 "Hits: " UINT64_FORMAT "  Misses: " UINT64_FORMAT "  Evictions: " UINT64_FORMAT "  Overflows: " UINT64_FORMAT "  Memory Usage: " INT64_FORMAT "kB\n",
+						 mstate->stats.cache_hits,
+						 mstate->stats.cache_misses,
+						 mstate->stats.cache_evictions,
+						 mstate->stats.cache_overflows,
+						 memPeakKb);
+	}
+}
+
 /*
  * Show information on hash buckets/batches.
  */
@@ -2364,6 +2551,33 @@ show_hash_info(HashState *hashstate, ExplainState *es)
 	}
 }
 
+/*
+ * Show how many batches a hashed aggregate spilled to disk, if any.
+ */
+static void
+show_hashagg_info(AggState *aggstate, ExplainState *es)
+{
+	long		memPeakKb = (aggstate->hash_mem_peak + 1023) / 1024;
+	long		diskPeakKb = aggstate->hash_disk_peak * (BLCKSZ / 1024);
+
+	if (aggstate->hash_batches_used == 0)
+		return;
+
+	if (es->format != EXPLAIN_FORMAT_TEXT)
+	{
+		ExplainPropertyLong("HashAgg Batches", aggstate->hash_batches_used, es);
+		ExplainPropertyLong("Peak Memory Usage", memPeakKb, es);
+		ExplainPropertyLong("Disk Usage", diskPeakKb, es);
+	}
+	else
+	{
+		appendStringInfoSpaces(es->str, es->indent * 2);
+		appendStringInfo(es->str,
+						 "Batches: %d  Memory Usage: %ldkB  Disk Usage: %ldkB\n",
+						 aggstate->hash_batches_used, memPeakKb, diskPeakKb);
+	}
+}
+
 /*
  * If it's EXPLAIN ANALYZE, show exact/lossy pages for a BitmapHeapScan node
  */
@@ -2405,7 +2619,9 @@ show_instrumentation_count(const char *qlabel, int which,
 	if (!es->analyze || !planstate->instrument)
 		return;
 
-	if (which == 2)
+	if (which == 3)
+		nfiltered = planstate->instrument->nfiltered3;
+	else if (which == 2)
 		nfiltered = planstate->instrument->nfiltered2;
 	else
 		nfiltered = planstate->instrument->nfiltered1;
@@ -2923,14 +3139,13 @@ show_modifytable_info(ModifyTableState *mtstate, List *ancestors,
  * The ancestors list should already contain the immediate parent of these
  * plans.
  *
- * Note: we don't actually need to examine the Plan list members, but
- * we need the list in order to determine the length of the PlanState array.
+ * nplans is the length of the PlanState array, which can be less than that
+ * of the plan's list if the executor pruned some subplans.
  */
 static void
-ExplainMemberNodes(List *plans, PlanState **planstates,
+ExplainMemberNodes(PlanState **planstates, int nplans,
 				   List *ancestors, ExplainState *es)
 {
-	int			nplans = list_length(plans);
 	int			j;
 
 	for (j = 0; j < nplans; j++)
@@ -239,7 +239,7 @@ ExecRefreshMatView(RefreshMatViewStmt *stmt, const char *queryString,
 				IndexIsValid(indexStruct) &&
 				RelationGetIndexExpressions(indexRel) == NIL &&
 				RelationGetIndexPredicate(indexRel) == NIL &&
-				indexStruct->indnatts > 0)
+				indexStruct->indnkeyatts > 0)
 			{
 				hasUniqueIndex = true;
 				index_close(indexRel, AccessShareLock);
@@ -720,7 +720,7 @@ refresh_by_match_merge(Oid matviewOid, Oid tempOid, Oid relowner,
 			RelationGetIndexExpressions(indexRel) == NIL &&
 			RelationGetIndexPredicate(indexRel) == NIL)
 		{
-			int			numatts = indexStruct->indnatts;
+			int			numatts = indexStruct->indnkeyatts;
 			int			i;
 
 			/* Add quals for all columns from this index. */
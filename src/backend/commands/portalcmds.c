@@ -394,7 +394,10 @@ PersistHoldablePortal(Portal portal)
 										portal->holdContext,
 										true);
 
-		/* Fetch the result set into the tuplestore */
+		/*
+		 * Fetch the result set into the tuplestore.  (An IQP cursor under
+		 * iqp_cursor_refresh only delivers one round here; see ExecutePlan.)
+		 */
 		ExecutorRun(queryDesc, ForwardScanDirection, 0L, false);
 
 		(*queryDesc->dest->rDestroy) (queryDesc->dest);
@@ -295,6 +295,13 @@ ExecDBTWaitUpdate(EState *estate)
 
     IncTQPool *tq_pool = estate->tq_pool; 
 
+    /* In-process deltas are complete once GenTPCHUpdate returns */
+    if (!external_delta && tpch_inproc_delta)
+    {
+        elog(NOTICE, "delta %d", GetTQUpdate(tq_pool)); 
+        return; 
+    }
+
     for (;;) 
     {
 		CHECK_FOR_INTERRUPTS();
@@ -0,0 +1,634 @@
+/*-------------------------------------------------------------------------
+ *
+ * execBatch.c
+ *	  Batch-at-a-time evaluation of scan quals and simple expressions.
+ *
+ * The row-at-a-time executor pays for every tuple with a trip through the
+ * slot machinery (slot_getattr / slot_deform_tuple) and a dispatch loop in
+ * ExecInterpExpr per expression.  For scans that feed plain aggregation
+ * this overhead dominates.  The routines here let a scan node instead
+ * collect a batch of tuples, deform them column by column into a
+ * TupleBatch, and then run each expression step over the whole batch.
+ *
+ * Only a small, strict subset of expressions is supported: Vars of user
+ * attributes, Consts, RelabelTypes, strict non-set-returning operators and
+ * functions, NullTests on scalars, and AND-ed qual lists thereof.  The
+ * builders return NULL for anything else, and the caller falls back to the
+ * regular row-at-a-time path.
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/executor/execBatch.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/htup_details.h"
+#include "access/tupmacs.h"
+#include "catalog/objectaccess.h"
+#include "executor/execBatch.h"
+#include "miscadmin.h"
+#include "nodes/nodeFuncs.h"
+#include "optimizer/clauses.h"
+#include "storage/bufmgr.h"
+#include "utils/acl.h"
+#include "utils/lsyscache.h"
+
+
+/* GUC parameter */
+int			executor_batch_size = 0;
+
+/* Working state while compiling an expression into batch steps */
+typedef struct BatchExprBuilder
+{
+	TupleBatch *batch;
+	Index		varno;			/* varno of Vars that reference the batch */
+	AttrNumber *attmap;			/* varattno -> batch attnum, or NULL */
+	int			nmap;			/* length of attmap */
+	List	   *steps;			/* list of palloc'd BatchExprEvalSteps */
+} BatchExprBuilder;
+
+static bool ExecBuildBatchExprRec(BatchExprBuilder *builder, Expr *node,
+					  Datum **resvalues, bool **resnulls);
+static BatchExprState *ExecFinishBatchExpr(BatchExprBuilder *builder);
+
+
+/*
+ * TupleBatchCreate
+ *
+ * Create an empty batch for tuples of the given descriptor.  No column
+ * vectors are allocated until TupleBatchUseColumn asks for them.
+ */
+TupleBatch *
+TupleBatchCreate(TupleDesc tupdesc, int maxrows)
+{
+	TupleBatch *batch = (TupleBatch *) palloc0(sizeof(TupleBatch));
+
+	Assert(maxrows > 0);
+
+	batch->tupdesc = tupdesc;
+	batch->maxrows = maxrows;
+	batch->nrows = 0;
+	batch->maxatt = 0;
+	batch->values = (Datum **) palloc0(tupdesc->natts * sizeof(Datum *));
+	batch->isnull = (bool **) palloc0(tupdesc->natts * sizeof(bool *));
+	batch->nsel = 0;
+	batch->sel = (int *) palloc(maxrows * sizeof(int));
+	batch->nbuffers = 0;
+	/* a batch can never span more pages than it has rows */
+	batch->buffers = (Buffer *) palloc(maxrows * sizeof(Buffer));
+
+	return batch;
+}
+
+/*
+ * TupleBatchUseColumn
+ *
+ * Note that attribute attnum (1-based) is referenced, so it must be
+ * deformed into the batch.
+ */
+void
+TupleBatchUseColumn(TupleBatch *batch, AttrNumber attnum)
+{
+	Assert(attnum > 0 && attnum <= batch->tupdesc->natts);
+	Assert(batch->nrows == 0);
+
+	if (batch->values[attnum - 1] == NULL)
+	{
+		batch->values[attnum - 1] =
+			(Datum *) palloc(batch->maxrows * sizeof(Datum));
+		batch->isnull[attnum - 1] =
+			(bool *) palloc(batch->maxrows * sizeof(bool));
+	}
+	batch->maxatt = Max(batch->maxatt, attnum);
+}
+
+/*
+ * TupleBatchStoreTuple
+ *
+ * Append a tuple to the batch, deforming the referenced columns into the
+ * column vectors.  If the tuple lives in a shared buffer, the batch takes
+ * its own pin on that buffer, since pass-by-reference values point into
+ * the page.  This is the column-wise counterpart of slot_deform_tuple.
+ */
+void
+TupleBatchStoreTuple(TupleBatch *batch, HeapTuple tuple, Buffer buffer)
+{
+	TupleDesc	tupleDesc = batch->tupdesc;
+	Form_pg_attribute *att = tupleDesc->attrs;
+	HeapTupleHeader tup = tuple->t_data;
+	bool		hasnulls = HeapTupleHasNulls(tuple);
+	bits8	   *bp = tup->t_bits;
+	int			row = batch->nrows;
+	int			natts;
+	int			attnum;
+	char	   *tp;
+	long		off = 0;
+	bool		slow = false;
+
+	Assert(row < batch->maxrows);
+
+	if (BufferIsValid(buffer) &&
+		(batch->nbuffers == 0 ||
+		 batch->buffers[batch->nbuffers - 1] != buffer))
+	{
+		IncrBufferRefCount(buffer);
+		batch->buffers[batch->nbuffers++] = buffer;
+	}
+
+	/* attributes beyond the end of an old tuple read as NULL */
+	natts = Min(HeapTupleHeaderGetNatts(tup), batch->maxatt);
+	tp = (char *) tup + tup->t_hoff;
+
+	for (attnum = 0; attnum < natts; attnum++)
+	{
+		Form_pg_attribute thisatt = att[attnum];
+		bool		wanted = (batch->values[attnum] != NULL);
+
+		if (hasnulls && att_isnull(attnum, bp))
+		{
+			if (wanted)
+			{
+				batch->values[attnum][row] = (Datum) 0;
+				batch->isnull[attnum][row] = true;
+			}
+			slow = true;		/* can't use attcacheoff anymore */
+			continue;
+		}
+
+		if (!slow && thisatt->attcacheoff >= 0)
+			off = thisatt->attcacheoff;
+		else if (thisatt->attlen == -1)
+		{
+			if (!slow &&
+				off == att_align_nominal(off, thisatt->attalign))
+				thisatt->attcacheoff = off;
+			else
+			{
+				off = att_align_pointer(off, thisatt->attalign, -1,
+										tp + off);
+				slow = true;
+			}
+		}
+		else
+		{
+			/* not varlena, so safe to use att_align_nominal */
+			off = att_align_nominal(off, thisatt->attalign);
+
+			if (!slow)
+				thisatt->attcacheoff = off;
+		}
+
+		if (wanted)
+		{
+			batch->values[attnum][row] = fetchatt(thisatt, tp + off);
+			batch->isnull[attnum][row] = false;
+		}
+
+		off = att_addlength_pointer(off, thisatt->attlen, tp + off);
+
+		if (thisatt->attlen <= 0)
+			slow = true;		/* can't use attcacheoff anymore */
+	}
+
+	for (; attnum < batch->maxatt; attnum++)
+	{
+		if (batch->values[attnum] != NULL)
+		{
+			batch->values[attnum][row] = (Datum) 0;
+			batch->isnull[attnum][row] = true;
+		}
+	}
+
+	batch->sel[batch->nsel++] = row;
+	batch->nrows++;
+}
+
+/*
+ * TupleBatchReset
+ *
+ * Empty the batch and drop the buffer pins it holds.
+ */
+void
+TupleBatchReset(TupleBatch *batch)
+{
+	int			i;
+
+	for (i = 0; i < batch->nbuffers; i++)
+		ReleaseBuffer(batch->buffers[i]);
+	batch->nbuffers = 0;
+	batch->nrows = 0;
+	batch->nsel = 0;
+}
+
+/*
+ * ExecBuildBatchExpr
+ *
+ * Compile a scalar expression for batch evaluation.  Vars with varno equal
+ * to the given varno reference the batch; if attmap is given, their
+ * varattno is first translated through it (entries of 0 are unusable).
+ * Returns NULL if the expression cannot be evaluated in batch mode.
+ */
+BatchExprState *
+ExecBuildBatchExpr(Expr *node, TupleBatch *batch,
+				   Index varno, AttrNumber *attmap, int nmap)
+{
+	BatchExprBuilder builder;
+	BatchExprState *state;
+	Datum	   *resvalues;
+	bool	   *resnulls;
+
+	builder.batch = batch;
+	builder.varno = varno;
+	builder.attmap = attmap;
+	builder.nmap = nmap;
+	builder.steps = NIL;
+
+	if (!ExecBuildBatchExprRec(&builder, node, &resvalues, &resnulls))
+		return NULL;
+
+	state = ExecFinishBatchExpr(&builder);
+	state->resvalues = resvalues;
+	state->resnulls = resnulls;
+
+	return state;
+}
+
+/*
+ * ExecBuildBatchQual
+ *
+ * Compile an implicitly-ANDed qual list.  Evaluating the result with
+ * ExecEvalBatchExpr removes failing rows from the batch's selection vector.
+ * Each clause only sees the rows that passed the clauses before it, which
+ * keeps the short-circuit behaviour of ExecQual.  Returns NULL if any
+ * clause cannot be evaluated in batch mode.
+ */
+BatchExprState *
+ExecBuildBatchQual(List *qual, TupleBatch *batch, Index varno)
+{
+	BatchExprBuilder builder;
+	List	   *clauses = NIL;
+	ListCell   *lc;
+
+	builder.batch = batch;
+	builder.varno = varno;
+	builder.attmap = NULL;
+	builder.nmap = 0;
+	builder.steps = NIL;
+
+	/* flatten nested ANDs so each conjunct narrows the selection */
+	foreach(lc, qual)
+	{
+		Expr	   *clause = (Expr *) lfirst(lc);
+
+		if (and_clause((Node *) clause))
+			clauses = list_concat(clauses,
+								  list_copy(((BoolExpr *) clause)->args));
+		else
+			clauses = lappend(clauses, clause);
+	}
+
+	foreach(lc, clauses)
+	{
+		Expr	   *clause = (Expr *) lfirst(lc);
+		BatchExprEvalStep *step;
+		Datum	   *values;
+		bool	   *nulls;
+
+		if (!ExecBuildBatchExprRec(&builder, clause, &values, &nulls))
+			return NULL;
+
+		step = (BatchExprEvalStep *) palloc0(sizeof(BatchExprEvalStep));
+		step->opcode = EEOP_BATCH_QUAL;
+		step->d.arg.values = values;
+		step->d.arg.nulls = nulls;
+		builder.steps = lappend(builder.steps, step);
+	}
+
+	return ExecFinishBatchExpr(&builder);
+}
+
+/*
+ * Flatten the builder's step list into a BatchExprState.
+ */
+static BatchExprState *
+ExecFinishBatchExpr(BatchExprBuilder *builder)
+{
+	BatchExprState *state = (BatchExprState *) palloc0(sizeof(BatchExprState));
+	ListCell   *lc;
+	int			i = 0;
+
+	state->nsteps = list_length(builder->steps);
+	state->steps = (BatchExprEvalStep *)
+		palloc0(Max(state->nsteps, 1) * sizeof(BatchExprEvalStep));
+	foreach(lc, builder->steps)
+		state->steps[i++] = *(BatchExprEvalStep *) lfirst(lc);
+
+	return state;
+}
+
+/*
+ * Compile one expression node.  On success, *resvalues / *resnulls are set
+ * to the vectors holding the node's per-row result.
+ */
+static bool
+ExecBuildBatchExprRec(BatchExprBuilder *builder, Expr *node,
+					  Datum **resvalues, bool **resnulls)
+{
+	TupleBatch *batch = builder->batch;
+
+	check_stack_depth();
+
+	switch (nodeTag(node))
+	{
+		case T_Var:
+			{
+				Var		   *var = (Var *) node;
+				AttrNumber	attnum = var->varattno;
+
+				if (var->varno != builder->varno || attnum <= 0)
+					return false;
+				if (builder->attmap != NULL)
+				{
+					if (attnum > builder->nmap)
+						return false;
+					attnum = builder->attmap[attnum - 1];
+					if (attnum <= 0)
+						return false;
+				}
+				if (attnum > batch->tupdesc->natts)
+					return false;
+
+				TupleBatchUseColumn(batch, attnum);
+				*resvalues = batch->values[attnum - 1];
+				*resnulls = batch->isnull[attnum - 1];
+				return true;
+			}
+
+		case T_Const:
+			{
+				Const	   *con = (Const *) node;
+				int			i;
+
+				*resvalues = (Datum *) palloc(batch->maxrows * sizeof(Datum));
+				*resnulls = (bool *) palloc(batch->maxrows * sizeof(bool));
+				for (i = 0; i < batch->maxrows; i++)
+				{
+					/* kernels rely on NULL entries being zero */
+					(*resvalues)[i] = con->constisnull ? (Datum) 0 : con->constvalue;
+					(*resnulls)[i] = con->constisnull;
+				}
+				return true;
+			}
+
+		case T_RelabelType:
+			return ExecBuildBatchExprRec(builder,
+										 ((RelabelType *) node)->arg,
+										 resvalues, resnulls);
+
+		case T_OpExpr:
+		case T_FuncExpr:
+			{
+				Oid			funcid;
+				Oid			inputcollid;
+				List	   *args;
+				bool		retset;
+				BatchExprEvalStep *step;
+				FmgrInfo   *flinfo;
+				AclResult	aclresult;
+				int			nargs;
+				int			argno;
+				ListCell   *lc;
+
+				if (IsA(node, OpExpr))
+				{
+					OpExpr	   *op = (OpExpr *) node;
+
+					set_opfuncid(op);
+					funcid = op->opfuncid;
+					inputcollid = op->inputcollid;
+					args = op->args;
+					retset = op->opretset;
+				}
+				else
+				{
+					FuncExpr   *func = (FuncExpr *) node;
+
+					funcid = func->funcid;
+					inputcollid = func->inputcollid;
+					args = func->args;
+					retset = func->funcretset;
+				}
+
+				nargs = list_length(args);
+				if (retset || nargs > FUNC_MAX_ARGS || !func_strict(funcid))
+					return false;
+
+				step = (BatchExprEvalStep *) palloc0(sizeof(BatchExprEvalStep));
+				step->opcode = EEOP_BATCH_FUNCEXPR_STRICT;
+				step->d.func.nargs = nargs;
+				step->d.func.argvalues = (Datum **) palloc(Max(nargs, 1) * sizeof(Datum *));
+				step->d.func.argnulls = (bool **) palloc(Max(nargs, 1) * sizeof(bool *));
+
+				argno = 0;
+				foreach(lc, args)
+				{
+					if (!ExecBuildBatchExprRec(builder, (Expr *) lfirst(lc),
+											   &step->d.func.argvalues[argno],
+											   &step->d.func.argnulls[argno]))
+						return false;
+					argno++;
+				}
+
+				/* Check permission to call function */
+				aclresult = pg_proc_aclcheck(funcid, GetUserId(), ACL_EXECUTE);
+				if (aclresult != ACLCHECK_OK)
+					aclcheck_error(aclresult, ACL_KIND_PROC, get_func_name(funcid));
+				InvokeFunctionExecuteHook(funcid);
+
+				flinfo = (FmgrInfo *) palloc0(sizeof(FmgrInfo));
+				step->d.func.fcinfo_data = palloc0(sizeof(FunctionCallInfoData));
+				fmgr_info(funcid, flinfo);
+				fmgr_info_set_expr((Node *) node, flinfo);
+				InitFunctionCallInfoData(*step->d.func.fcinfo_data, flinfo,
+										 nargs, inputcollid, NULL, NULL);
+
+				/* use a specialized loop if there is one for this function */
+				if (nargs == 2)
+				{
+					step->d.func.kernel = ExecBatchLookupKernel(flinfo->fn_addr);
+					if (step->d.func.kernel != NULL)
+						step->opcode = EEOP_BATCH_KERNEL;
+				}
+
+				step->resvalues = (Datum *) palloc(batch->maxrows * sizeof(Datum));
+				step->resnulls = (bool *) palloc(batch->maxrows * sizeof(bool));
+				*resvalues = step->resvalues;
+				*resnulls = step->resnulls;
+
+				builder->steps = lappend(builder->steps, step);
+				return true;
+			}
+
+		case T_NullTest:
+			{
+				NullTest   *ntest = (NullTest *) node;
+				BatchExprEvalStep *step;
+
+				/* row-valued IS [NOT] NULL looks inside the row; not here */
+				if (ntest->argisrow)
+					return false;
+
+				step = (BatchExprEvalStep *) palloc0(sizeof(BatchExprEvalStep));
+				step->opcode = (ntest->nulltesttype == IS_NULL) ?
+					EEOP_BATCH_NULLTEST_ISNULL : EEOP_BATCH_NULLTEST_ISNOTNULL;
+				if (!ExecBuildBatchExprRec(builder, ntest->arg,
+										   &step->d.arg.values,
+										   &step->d.arg.nulls))
+					return false;
+
+				step->resvalues = (Datum *) palloc(batch->maxrows * sizeof(Datum));
+				step->resnulls = (bool *) palloc(batch->maxrows * sizeof(bool));
+				*resvalues = step->resvalues;
+				*resnulls = step->resnulls;
+
+				builder->steps = lappend(builder->steps, step);
+				return true;
+			}
+
+		default:
+			return false;
+	}
+}
+
+/*
+ * ExecEvalBatchExpr
+ *
+ * Run a compiled batch expression over the live rows of the batch.
+ * Pass-by-reference results are allocated in CurrentMemoryContext, so the
+ * caller should be in a short-lived context that it resets per batch.
+ */
+void
+ExecEvalBatchExpr(BatchExprState *state, TupleBatch *batch)
+{
+	int			stepno;
+
+	for (stepno = 0; stepno < state->nsteps; stepno++)
+	{
+		BatchExprEvalStep *op = &state->steps[stepno];
+		int		   *sel = batch->sel;
+		int			nsel = batch->nsel;
+		int			i;
+
+		switch (op->opcode)
+		{
+			case EEOP_BATCH_FUNCEXPR_STRICT:
+				{
+					FunctionCallInfo fcinfo = op->d.func.fcinfo_data;
+					int			nargs = op->d.func.nargs;
+
+					for (i = 0; i < nsel; i++)
+					{
+						int			row = sel[i];
+						int			argno;
+
+						for (argno = 0; argno < nargs; argno++)
+						{
+							if (op->d.func.argnulls[argno][row])
+								break;
+							fcinfo->arg[argno] = op->d.func.argvalues[argno][row];
+							fcinfo->argnull[argno] = false;
+						}
+						if (argno < nargs)
+						{
+							/* strict function with a NULL input */
+							op->resvalues[row] = (Datum) 0;
+							op->resnulls[row] = true;
+							continue;
+						}
+
+						fcinfo->isnull = false;
+						op->resvalues[row] = FunctionCallInvoke(fcinfo);
+						op->resnulls[row] = fcinfo->isnull;
+						if (fcinfo->isnull)
+							op->resvalues[row] = (Datum) 0;
+					}
+					break;
+				}
+
+			case EEOP_BATCH_KERNEL:
+				{
+					bool	   *nulla = op->d.func.argnulls[0];
+					bool	   *nullb = op->d.func.argnulls[1];
+
+					/*
+					 * If no row has been filtered out yet, the selection is
+					 * the identity and the kernel can run over dense vectors.
+					 */
+					if (nsel == batch->nrows)
+					{
+						for (i = 0; i < nsel; i++)
+							op->resnulls[i] = nulla[i] | nullb[i];
+						op->d.func.kernel(nsel, NULL,
+										  op->d.func.argvalues[0],
+										  op->d.func.argvalues[1],
+										  op->resnulls, op->resvalues);
+					}
+					else
+					{
+						for (i = 0; i < nsel; i++)
+						{
+							int			row = sel[i];
+
+							op->resnulls[row] = nulla[row] | nullb[row];
+						}
+						op->d.func.kernel(nsel, sel,
+										  op->d.func.argvalues[0],
+										  op->d.func.argvalues[1],
+										  op->resnulls, op->resvalues);
+					}
+					break;
+				}
+
+			case EEOP_BATCH_NULLTEST_ISNULL:
+				for (i = 0; i < nsel; i++)
+				{
+					int			row = sel[i];
+
+					op->resvalues[row] = BoolGetDatum(op->d.arg.nulls[row]);
+					op->resnulls[row] = false;
+				}
+				break;
+
+			case EEOP_BATCH_NULLTEST_ISNOTNULL:
+				for (i = 0; i < nsel; i++)
+				{
+					int			row = sel[i];
+
+					op->resvalues[row] = BoolGetDatum(!op->d.arg.nulls[row]);
+					op->resnulls[row] = false;
+				}
+				break;
+
+			case EEOP_BATCH_QUAL:
+				{
+					int			nkeep = 0;
+
+					for (i = 0; i < nsel; i++)
+					{
+						int			row = sel[i];
+
+						if (!op->d.arg.nulls[row] &&
+							DatumGetBool(op->d.arg.values[row]))
+							sel[nkeep++] = row;
+					}
+					batch->nsel = nkeep;
+					break;
+				}
+		}
+	}
+}
@@ -0,0 +1,284 @@
+/*-------------------------------------------------------------------------
+ *
+ * execBatchKernels.c
+ *	  Type-specialized loops for common operators in batch evaluation.
+ *
+ * Calling a comparison or arithmetic operator through fmgr costs far more
+ * than the operation itself.  For the built-in fixed-width comparison and
+ * arithmetic functions listed in batch_kernels[], ExecBuildBatchExpr
+ * substitutes a kernel that applies the operation to a whole column vector
+ * in one tight loop.  The loops have no calls and no data-dependent
+ * branches, so when the batch's selection is dense the compiler can turn
+ * them into SSE2/AVX2 code for whatever target the server is built for.
+ *
+ * Every kernel must give exactly the result of the function it replaces,
+ * including NaN ordering for floats and overflow errors for arithmetic.
+ * Rows whose inputs are NULL get a zero result and never raise errors;
+ * the caller marks them NULL.
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/executor/execBatchKernels.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include <math.h>
+
+#include "executor/execBatch.h"
+#include "utils/builtins.h"
+#include "utils/date.h"
+#include "utils/timestamp.h"
+
+
+#define SAMESIGN(a,b)	(((a) < 0) == ((b) < 0))
+
+/* float comparisons, with NaN equal to itself and above all other values */
+#define FLOAT_EQ(x,y)	((x) == (y) || (isnan(x) && isnan(y)))
+#define FLOAT_LT(x,y)	(!isnan(x) && (isnan(y) || (x) < (y)))
+#define FLOAT_LE(x,y)	(isnan(y) || (!isnan(x) && (x) <= (y)))
+
+/*
+ * Comparison kernel: res = cmp(x, y).  sel == NULL means rows 0 .. n-1.
+ */
+#define BATCH_CMP_KERNEL(fname, type, get, cmp) \
+static void \
+fname(int n, const int *sel, const Datum *a, const Datum *b, \
+	  const bool *nulls, Datum *res) \
+{ \
+	int			i; \
+\
+	if (sel == NULL) \
+	{ \
+		for (i = 0; i < n; i++) \
+		{ \
+			type		x = get(a[i]); \
+			type		y = get(b[i]); \
+\
+			res[i] = BoolGetDatum(!nulls[i] && (cmp)); \
+		} \
+	} \
+	else \
+	{ \
+		for (i = 0; i < n; i++) \
+		{ \
+			int			row = sel[i]; \
+			type		x = get(a[row]); \
+			type		y = get(b[row]); \
+\
+			res[row] = BoolGetDatum(!nulls[row] && (cmp)); \
+		} \
+	} \
+}
+
+/*
+ * Arithmetic kernel: res = op(x, y), remembering whether any non-null row
+ * failed the range check, and raising the operator's error afterwards.
+ */
+#define BATCH_ARITH_KERNEL(fname, type, get, put, op, bad, errcheck) \
+static void \
+fname(int n, const int *sel, const Datum *a, const Datum *b, \
+	  const bool *nulls, Datum *res) \
+{ \
+	int			i; \
+	bool		failed = false; \
+\
+	if (sel == NULL) \
+	{ \
+		for (i = 0; i < n; i++) \
+		{ \
+			type		x = get(a[i]); \
+			type		y = get(b[i]); \
+			type		r = (op); \
+\
+			failed |= !nulls[i] && (bad); \
+			res[i] = nulls[i] ? (Datum) 0 : put(r); \
+		} \
+	} \
+	else \
+	{ \
+		for (i = 0; i < n; i++) \
+		{ \
+			int			row = sel[i]; \
+			type		x = get(a[row]); \
+			type		y = get(b[row]); \
+			type		r = (op); \
+\
+			failed |= !nulls[row] && (bad); \
+			res[row] = nulls[row] ? (Datum) 0 : put(r); \
+		} \
+	} \
+	if (failed) \
+		errcheck(n, sel, a, b, nulls); \
+}
+
+/*
+ * Once a kernel has seen an out-of-range row, rerun the rows through the
+ * real function so the error raised is exactly the one row mode raises.
+ */
+#define BATCH_ARITH_ERROR(fname, func) \
+static void \
+fname(int n, const int *sel, const Datum *a, const Datum *b, \
+	  const bool *nulls) \
+{ \
+	int			i; \
+\
+	for (i = 0; i < n; i++) \
+	{ \
+		int			row = sel ? sel[i] : i; \
+\
+		if (!nulls[row]) \
+			(void) DirectFunctionCall2(func, a[row], b[row]); \
+	} \
+	elog(ERROR, "batch kernel for %s reported a range error", #func); \
+}
+
+#define BATCH_CMP_KERNELS(prefix, type, get, EQ, LT, LE) \
+	BATCH_CMP_KERNEL(prefix##_eq_kernel, type, get, EQ(x, y)) \
+	BATCH_CMP_KERNEL(prefix##_ne_kernel, type, get, !EQ(x, y)) \
+	BATCH_CMP_KERNEL(prefix##_lt_kernel, type, get, LT(x, y)) \
+	BATCH_CMP_KERNEL(prefix##_le_kernel, type, get, LE(x, y)) \
+	BATCH_CMP_KERNEL(prefix##_gt_kernel, type, get, LT(y, x)) \
+	BATCH_CMP_KERNEL(prefix##_ge_kernel, type, get, LE(y, x))
+
+#define INT_EQ(x,y)		((x) == (y))
+#define INT_LT(x,y)		((x) < (y))
+#define INT_LE(x,y)		((x) <= (y))
+
+BATCH_CMP_KERNELS(int2, int16, DatumGetInt16, INT_EQ, INT_LT, INT_LE)
+BATCH_CMP_KERNELS(int4, int32, DatumGetInt32, INT_EQ, INT_LT, INT_LE)
+BATCH_CMP_KERNELS(date, DateADT, DatumGetDateADT, INT_EQ, INT_LT, INT_LE)
+BATCH_CMP_KERNELS(float4, float4, DatumGetFloat4, FLOAT_EQ, FLOAT_LT, FLOAT_LE)
+
+BATCH_ARITH_ERROR(int4pl_error, int4pl)
+BATCH_ARITH_ERROR(int4mi_error, int4mi)
+BATCH_ARITH_ERROR(int4mul_error, int4mul)
+BATCH_ARITH_ERROR(float4pl_error, float4pl)
+BATCH_ARITH_ERROR(float4mi_error, float4mi)
+BATCH_ARITH_ERROR(float4mul_error, float4mul)
+
+BATCH_ARITH_KERNEL(int4pl_kernel, int32, DatumGetInt32, Int32GetDatum,
+				   x + y,
+				   SAMESIGN(x, y) && !SAMESIGN(r, x),
+				   int4pl_error)
+BATCH_ARITH_KERNEL(int4mi_kernel, int32, DatumGetInt32, Int32GetDatum,
+				   x - y,
+				   !SAMESIGN(x, y) && !SAMESIGN(r, x),
+				   int4mi_error)
+BATCH_ARITH_KERNEL(int4mul_kernel, int32, DatumGetInt32, Int32GetDatum,
+				   (int32) ((int64) x * (int64) y),
+				   (int64) x * (int64) y != (int64) r,
+				   int4mul_error)
+BATCH_ARITH_KERNEL(float4pl_kernel, float4, DatumGetFloat4, Float4GetDatum,
+				   x + y,
+				   isinf(r) && !isinf(x) && !isinf(y),
+				   float4pl_error)
+BATCH_ARITH_KERNEL(float4mi_kernel, float4, DatumGetFloat4, Float4GetDatum,
+				   x - y,
+				   isinf(r) && !isinf(x) && !isinf(y),
+				   float4mi_error)
+BATCH_ARITH_KERNEL(float4mul_kernel, float4, DatumGetFloat4, Float4GetDatum,
+				   x * y,
+				   (isinf(r) && !isinf(x) && !isinf(y)) ||
+				   (r == 0.0f && x != 0 && y != 0),
+				   float4mul_error)
+
+/* 64-bit types are only worth it when they are passed by value */
+#ifdef USE_FLOAT8_BYVAL
+BATCH_CMP_KERNELS(int8, int64, DatumGetInt64, INT_EQ, INT_LT, INT_LE)
+BATCH_CMP_KERNELS(timestamp, Timestamp, DatumGetTimestamp, INT_EQ, INT_LT, INT_LE)
+BATCH_CMP_KERNELS(float8, float8, DatumGetFloat8, FLOAT_EQ, FLOAT_LT, FLOAT_LE)
+
+BATCH_ARITH_ERROR(int8pl_error, int8pl)
+BATCH_ARITH_ERROR(int8mi_error, int8mi)
+BATCH_ARITH_ERROR(float8pl_error, float8pl)
+BATCH_ARITH_ERROR(float8mi_error, float8mi)
+BATCH_ARITH_ERROR(float8mul_error, float8mul)
+
+BATCH_ARITH_KERNEL(int8pl_kernel, int64, DatumGetInt64, Int64GetDatum,
+				   x + y,
+				   SAMESIGN(x, y) && !SAMESIGN(r, x),
+				   int8pl_error)
+BATCH_ARITH_KERNEL(int8mi_kernel, int64, DatumGetInt64, Int64GetDatum,
+				   x - y,
+				   !SAMESIGN(x, y) && !SAMESIGN(r, x),
+				   int8mi_error)
+BATCH_ARITH_KERNEL(float8pl_kernel, float8, DatumGetFloat8, Float8GetDatum,
+				   x + y,
+				   isinf(r) && !isinf(x) && !isinf(y),
+				   float8pl_error)
+BATCH_ARITH_KERNEL(float8mi_kernel, float8, DatumGetFloat8, Float8GetDatum,
+				   x - y,
+				   isinf(r) && !isinf(x) && !isinf(y),
+				   float8mi_error)
+BATCH_ARITH_KERNEL(float8mul_kernel, float8, DatumGetFloat8, Float8GetDatum,
+				   x * y,
+				   (isinf(r) && !isinf(x) && !isinf(y)) ||
+				   (r == 0.0 && x != 0 && y != 0),
+				   float8mul_error)
+#endif							/* USE_FLOAT8_BYVAL */
+
+/*
+ * The functions with a kernel.  We match on the C function rather than the
+ * pg_proc OID, so that every pg_proc entry sharing an implementation (for
+ * instance timestamptz_lt and timestamp_lt) gets the kernel.
+ */
+typedef struct BatchKernelEntry
+{
+	PGFunction	func;
+	BatchKernel kernel;
+} BatchKernelEntry;
+
+#define BATCH_CMP_ENTRIES(prefix, fprefix) \
+	{fprefix##eq, prefix##_eq_kernel}, \
+	{fprefix##ne, prefix##_ne_kernel}, \
+	{fprefix##lt, prefix##_lt_kernel}, \
+	{fprefix##le, prefix##_le_kernel}, \
+	{fprefix##gt, prefix##_gt_kernel}, \
+	{fprefix##ge, prefix##_ge_kernel}
+
+static const BatchKernelEntry batch_kernels[] = {
+	BATCH_CMP_ENTRIES(int2, int2),
+	BATCH_CMP_ENTRIES(int4, int4),
+	BATCH_CMP_ENTRIES(date, date_),
+	BATCH_CMP_ENTRIES(float4, float4),
+	{int4pl, int4pl_kernel},
+	{int4mi, int4mi_kernel},
+	{int4mul, int4mul_kernel},
+	{float4pl, float4pl_kernel},
+	{float4mi, float4mi_kernel},
+	{float4mul, float4mul_kernel},
+#ifdef USE_FLOAT8_BYVAL
+	BATCH_CMP_ENTRIES(int8, int8),
+	BATCH_CMP_ENTRIES(timestamp, timestamp_),
+	BATCH_CMP_ENTRIES(float8, float8),
+	{int8pl, int8pl_kernel},
+	{int8mi, int8mi_kernel},
+	{float8pl, float8pl_kernel},
+	{float8mi, float8mi_kernel},
+	{float8mul, float8mul_kernel},
+#endif
+};
+
+/*
+ * ExecBatchLookupKernel
+ *
+ * Return the kernel implementing the given two-argument built-in function,
+ * or NULL if there is none and the function must be called through fmgr.
+ */
+BatchKernel
+ExecBatchLookupKernel(PGFunction func)
+{
+	int			i;
+
+	for (i = 0; i < lengthof(batch_kernels); i++)
+	{
+		if (batch_kernels[i].func == func)
+			return batch_kernels[i].kernel;
+	}
+	return NULL;
+}
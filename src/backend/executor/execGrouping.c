@@ -446,6 +446,31 @@ FindTupleHashEntry(TupleHashTable hashtable, TupleTableSlot *slot,
 	return entry;
 }
 
+/*
+ * Compute the hash value the table would use for the given input tuple,
+ * without searching the table.  The tuple must be the same type as the
+ * hashtable entries.  This lets callers partition tuples consistently with
+ * the table, e.g. when hashed aggregation spills groups to disk.
+ */
+uint32
+TupleHashTableHashSlot(TupleHashTable hashtable, TupleTableSlot *slot)
+{
+	MemoryContext oldContext;
+	uint32		hash;
+
+	/* Need to run the hash functions in short-lived context */
+	oldContext = MemoryContextSwitchTo(hashtable->tempcxt);
+
+	hashtable->inputslot = slot;
+	hashtable->in_hash_funcs = hashtable->tab_hash_funcs;
+
+	hash = TupleHashTableHash(hashtable->hashtab, NULL);
+
+	MemoryContextSwitchTo(oldContext);
+
+	return hash;
+}
+
 /*
  * Compute the hash value for a tuple
  *
@@ -68,6 +68,7 @@
 /* totem: include executor/incmeta.h*/
 #include "executor/incmeta.h"
 #include "executor/dbt.h"
+#include "executor/incDeltaReceiver.h"
 
 /* Hooks for plugins to get control in ExecutorStart/Run/Finish/End */
 ExecutorStart_hook_type ExecutorStart_hook = NULL;
@@ -283,10 +284,28 @@ standard_ExecutorStart(QueryDesc *queryDesc, int eflags)
      */
     estate->deltaIndex = 0; 
     estate->numDelta = 0; 
+    estate->incRefreshPending = false; 
+    estate->incDeltaDest = NULL; 
     if (estate->es_incremental && queryDesc->isFirst) 
     {
         estate->es_qd = queryDesc; 
         ExecIncStart(estate, queryDesc->planstate); 
+
+        /*
+         * In delta-output mode the client gets the difference between 
+         * consecutive rounds instead of every round's full result. The 
+         * extra columns have to be part of the result descriptor before 
+         * anyone describes the query or sets up its result formats. 
+         */
+        if (estate->es_isSelect && iqp_delta_output &&
+                !(eflags & EXEC_FLAG_EXPLAIN_ONLY))
+        {
+            MemoryContextSwitchTo(estate->es_query_cxt);
+            estate->incDeltaDest = CreateDestReceiver(DestIncDelta);
+            SetIncDeltaDestReceiverParams(estate->incDeltaDest,
+                    queryDesc->tupDesc, estate->es_query_cxt);
+            queryDesc->tupDesc = IncDeltaDestResultDesc(estate->incDeltaDest);
+        }
     }
     else if (estate->es_dbt && queryDesc->isFirst)
     {
@@ -383,6 +402,16 @@ standard_ExecutorRun(QueryDesc *queryDesc,
 	sendTuples = (operation == CMD_SELECT ||
 				  queryDesc->plannedstmt->hasReturning);
 
+    /*
+     * totem: in delta-output mode the rows go through the receiver set up 
+     * by ExecutorStart
+     */
+    if (sendTuples && estate->incDeltaDest != NULL)
+    {
+        dest = estate->incDeltaDest;
+        SetIncDeltaDestReceiverInner(dest, queryDesc->dest);
+    }
+
 	if (sendTuples)
 		(*dest->rStartup) (dest, operation, queryDesc->tupDesc);
 
@@ -475,6 +504,9 @@ standard_ExecutorFinish(QueryDesc *queryDesc)
 	if (queryDesc->totaltime)
 		InstrStopNode(queryDesc->totaltime, 0);
 
+    if (estate->incDeltaDest != NULL)
+        (*estate->incDeltaDest->rDestroy) (estate->incDeltaDest);
+
     if (estate->es_incremental && queryDesc->isFirst)
         ExecIncFinish(estate, queryDesc->planstate);
     else if (estate->es_dbt && queryDesc->isFirst)
@@ -1760,6 +1792,17 @@ ExecutePlan(EState *estate,
 	if (use_parallel_mode)
 		EnterParallelMode();
 
+    /*
+     * totem: the previous call stopped at the end of a round; take in the 
+     * deltas that have arrived since then before producing the next result 
+     */
+    if (estate->incRefreshPending && !ScanDirectionIsNoMovement(direction))
+    {
+        estate->incRefreshPending = false;
+        ExecIncRun(estate, planstate);
+        gettimeofday(&start , NULL);
+    }
+
 	/*
 	 * Loop until we've processed the proper number of tuples from the plan.
 	 */
@@ -1798,6 +1841,8 @@ ExecutePlan(EState *estate,
                     gettimeofday(&end , NULL);
                     estate->execTime[estate->numDelta] = GetTimeDiff(start, end);  
                 }
+                if (dest->mydest == DestIncDelta)
+                    (void) IncDeltaDestEndRound(dest, estate->deltaIndex);
                 /* Allow nodes to release or shut down resources. */
 			    (void) ExecShutdownNode(planstate);
 			    break;
@@ -1805,11 +1850,31 @@ ExecutePlan(EState *estate,
             else 
             {
                 /* es_incremental and es_isSelect must be true */
+                if (dest->mydest == DestIncDelta &&
+                        !IncDeltaDestEndRound(dest, estate->deltaIndex))
+                {
+                    (void) ExecShutdownNode(planstate);
+                    break;
+                }
                 estate->deltaIndex++; 
 
                 gettimeofday(&end , NULL);
                 estate->execTime[estate->deltaIndex - 1] = GetTimeDiff(start, end); 
 
+                /*
+                 * A cursor hands each round to the client separately: stop 
+                 * here and let the next FETCH process the new deltas. This 
+                 * is per-query state, so it only lasts as long as the 
+                 * portal's executor, i.e. until the end of the transaction. 
+                 * PersistHoldablePortal runs the executor once more, which 
+                 * stops here too, so a held cursor keeps just that round. 
+                 */
+                if (iqp_cursor_refresh && !execute_once)
+                {
+                    estate->incRefreshPending = true;
+                    break;
+                }
+
                 ExecIncRun(estate, planstate);      
                 gettimeofday(&start , NULL);
                    
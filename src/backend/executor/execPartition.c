@@ -0,0 +1,142 @@
+/*-------------------------------------------------------------------------
+ *
+ * execPartition.c
+ *	  Run-time partition pruning for Append and MergeAppend
+ *
+ * The planner attaches a PartitionPruneInfo to an Append or MergeAppend
+ * over a partitioned table when some of the quals compare the first
+ * partition key column with values that are only known at execution time.
+ * We evaluate those values, look up the partitions that can contain
+ * matching rows in the table's partition bounds, and report the subplans
+ * that scan them.  Values that depend only on external Params can be
+ * evaluated when the node is initialized, so that the pruned subplans are
+ * never initialized at all; values that depend on PARAM_EXEC Params (from
+ * initplans or nestloops) are evaluated at the first execution and again
+ * on each rescan that changes them.
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/executor/execPartition.c
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include "access/heapam.h"
+#include "catalog/partition.h"
+#include "executor/execPartition.h"
+#include "executor/executor.h"
+#include "utils/memutils.h"
+#include "utils/rel.h"
+
+
+/*
+ * ExecSetupPartitionPruneState
+ *		Prepare to prune the subplans of 'planstate' as described by 'pinfo'.
+ */
+PartitionPruneState *
+ExecSetupPartitionPruneState(PlanState *planstate, PartitionPruneInfo *pinfo)
+{
+	PartitionPruneState *prunestate;
+	ListCell   *lc;
+	int			i;
+
+	prunestate = (PartitionPruneState *) palloc0(sizeof(PartitionPruneState));
+	prunestate->pinfo = pinfo;
+
+	/* the table is in the range table, so we already hold a lock on it */
+	prunestate->partrel = heap_open(pinfo->reloid, NoLock);
+
+	if (planstate->ps_ExprContext == NULL)
+		ExecAssignExprContext(planstate->state, planstate);
+	prunestate->econtext = planstate->ps_ExprContext;
+
+	foreach(lc, pinfo->exprs)
+		prunestate->exprstates = lappend(prunestate->exprstates,
+										 ExecInitExpr((Expr *) lfirst(lc),
+													  planstate));
+
+	prunestate->nsubplans = list_length(pinfo->subplan_partidx);
+	prunestate->subplan_partidx = (int *)
+		palloc(prunestate->nsubplans * sizeof(int));
+	i = 0;
+	foreach(lc, pinfo->subplan_partidx)
+		prunestate->subplan_partidx[i++] = lfirst_int(lc);
+
+	return prunestate;
+}
+
+/*
+ * ExecFindMatchingSubPlans
+ *		Return the indexes of the subplans that may produce rows for the
+ *		current values of the prune expressions.
+ *
+ * The result is allocated in the caller's memory context.
+ */
+Bitmapset *
+ExecFindMatchingSubPlans(PartitionPruneState *prunestate)
+{
+	Relation	partrel = prunestate->partrel;
+	PartitionKey partkey = RelationGetPartitionKey(partrel);
+	ExprContext *econtext = prunestate->econtext;
+	PartitionPruneRange range;
+	Bitmapset  *partitions = NULL;
+	Bitmapset  *result = NULL;
+	bool		satisfiable = true;
+	MemoryContext oldcontext;
+	ListCell   *lc1,
+			   *lc2;
+	int			i;
+
+	ResetExprContext(econtext);
+	oldcontext = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
+
+	MemSet(&range, 0, sizeof(range));
+	forboth(lc1, prunestate->exprstates, lc2, prunestate->pinfo->strategies)
+	{
+		ExprState  *exprstate = (ExprState *) lfirst(lc1);
+		Datum		value = (Datum) 0;
+		bool		isnull = false;
+
+		if (exprstate != NULL)
+			value = ExecEvalExpr(exprstate, econtext, &isnull);
+
+		if (!partition_prune_range_add(partkey, &range, lfirst_int(lc2),
+									   value, isnull))
+		{
+			satisfiable = false;
+			break;
+		}
+	}
+
+	if (satisfiable)
+		partitions = get_partitions_for_prune_range(partkey,
+													RelationGetPartitionDesc(partrel),
+													&range);
+
+	MemoryContextSwitchTo(oldcontext);
+
+	for (i = 0; i < prunestate->nsubplans; i++)
+	{
+		int			partidx = prunestate->subplan_partidx[i];
+
+		if (partidx < 0 || bms_is_member(partidx, partitions))
+			result = bms_add_member(result, i);
+	}
+
+	return result;
+}
+
+/*
+ * ExecEndPartitionPruneState
+ *		Release the resources of a PartitionPruneState.
+ */
+void
+ExecEndPartitionPruneState(PartitionPruneState *prunestate)
+{
+	heap_close(prunestate->partrel, NoLock);
+}
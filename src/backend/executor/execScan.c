@@ -19,7 +19,9 @@
 #include "postgres.h"
 
 #include "executor/executor.h"
+#include "lib/bloomfilter.h"
 #include "miscadmin.h"
+#include "utils/lsyscache.h"
 #include "utils/memutils.h"
 
 /*
@@ -28,7 +30,16 @@
 #include "executor/incmeta.h"
 #include "executor/incTupleQueue.h"
 
+/*
+ * A runtime filter is given up on if, after this many probes, it has
+ * rejected less than RTFILTER_MIN_REMOVED_FRAC of them: the hashing costs
+ * more than the rows it saves from being passed up the plan.
+ */
+#define RTFILTER_CHECK_PROBES		4096
+#define RTFILTER_MIN_REMOVED_FRAC	0.05
+
 static bool tlist_matches_tupdesc(PlanState *ps, List *tlist, Index varno, TupleDesc tupdesc);
+static bool ExecScanRuntimeFilterLacks(ScanState *node, ExprContext *econtext);
 
 /*
  * ExecScanFetch -- check interrupts & fetch next potential tuple
@@ -145,7 +156,7 @@ ExecScan(ScanState *node,
 	 * If we have neither a qual to check nor a projection to do, just skip
 	 * all the overhead and return the raw scan tuple.
 	 */
-	if (!qual && !projInfo)
+	if (!qual && !projInfo && !node->ss_rtfilter)
 	{
 		ResetExprContext(econtext);
 		return ExecScanFetch(node, accessMtd, recheckMtd);
@@ -195,6 +206,19 @@ ExecScan(ScanState *node,
 		 */
 		if (qual == NULL || ExecQual(qual, econtext))
 		{
+			/*
+			 * If a hash join above us has published a Bloom filter, skip
+			 * tuples that certainly won't find a join partner before we
+			 * spend a projection on them.
+			 */
+			if (node->ss_rtfilter != NULL &&
+				ExecScanRuntimeFilterLacks(node, econtext))
+			{
+				InstrCountFiltered3(node, 1);
+				ResetExprContext(econtext);
+				continue;
+			}
+
 			/*
 			 * Found a satisfactory scan tuple.
 			 */
@@ -224,6 +248,113 @@ ExecScan(ScanState *node,
 	}
 }
 
+/*
+ * ExecScanRuntimeFilterLacks
+ *		Check the current scan tuple against the runtime filter
+ *
+ * Returns true if the tuple's hash value, computed exactly as
+ * ExecHashGetHashValue computes it for the join's outer tuples, is
+ * definitely not among the inner side's; or if a key is NULL under a strict
+ * operator, so that the tuple could not match anyway.
+ */
+static bool
+ExecScanRuntimeFilterLacks(ScanState *node, ExprContext *econtext)
+{
+	RuntimeFilterState *rf = node->ss_rtfilter;
+	uint32		hashkey = 0;
+	ListCell   *lc;
+	int			i = 0;
+	bool		lacks;
+
+	if (rf->filter == NULL || rf->disabled)
+		return false;
+
+	foreach(lc, rf->keys)
+	{
+		ExprState  *keyexpr = (ExprState *) lfirst(lc);
+		Datum		keyval;
+		bool		isNull;
+
+		/* rotate hashkey left 1 bit at each step */
+		hashkey = (hashkey << 1) | ((hashkey & 0x80000000) ? 1 : 0);
+
+		keyval = ExecEvalExpr(keyexpr, econtext, &isNull);
+
+		if (isNull)
+		{
+			if (rf->hashstrict[i])
+			{
+				lacks = true;
+				goto done;
+			}
+			/* else, leave hashkey unmodified, equivalent to hashcode 0 */
+		}
+		else
+			hashkey ^= DatumGetUInt32(FunctionCall1(&rf->hashfunctions[i],
+													keyval));
+		i++;
+	}
+
+	lacks = bloom_lacks_element(rf->filter, (unsigned char *) &hashkey,
+								sizeof(hashkey));
+
+done:
+	rf->nprobed += 1;
+	if (lacks)
+		rf->nremoved += 1;
+
+	/* Stop paying for the filter if it isn't pulling its weight */
+	if (rf->nprobed == RTFILTER_CHECK_PROBES &&
+		rf->nremoved < rf->nprobed * RTFILTER_MIN_REMOVED_FRAC)
+		rf->disabled = true;
+
+	return lacks;
+}
+
+/*
+ * ExecInitScanRuntimeFilter
+ *		Set up a scan node to test its rows against a hash join's filter
+ *
+ * Returns NULL unless the planner asked for a filter on this scan.  The
+ * filter itself is attached later by the HashJoin (see ExecInitHashJoin).
+ */
+RuntimeFilterState *
+ExecInitScanRuntimeFilter(ScanState *node)
+{
+	Scan	   *scan = (Scan *) node->ps.plan;
+	RuntimeFilterState *rf;
+	int			nkeys;
+	ListCell   *lc;
+	int			i;
+
+	if (scan->rtfilter_id == 0)
+		return NULL;
+
+	nkeys = list_length(scan->rtfilter_ops);
+	rf = (RuntimeFilterState *) palloc0(sizeof(RuntimeFilterState));
+	rf->keys = ExecInitExprList(scan->rtfilter_keys, (PlanState *) node);
+	rf->hashfunctions = (FmgrInfo *) palloc(nkeys * sizeof(FmgrInfo));
+	rf->hashstrict = (bool *) palloc(nkeys * sizeof(bool));
+
+	/* Look up the same hash functions ExecHashTableCreate uses */
+	i = 0;
+	foreach(lc, scan->rtfilter_ops)
+	{
+		Oid			hashop = lfirst_oid(lc);
+		Oid			left_hashfn;
+		Oid			right_hashfn;
+
+		if (!get_op_hash_functions(hashop, &left_hashfn, &right_hashfn))
+			elog(ERROR, "could not find hash function for hash operator %u",
+				 hashop);
+		fmgr_info(left_hashfn, &rf->hashfunctions[i]);
+		rf->hashstrict[i] = op_strict(hashop);
+		i++;
+	}
+
+	return rf;
+}
+
 /*
  * ExecAssignScanProjectionInfo
  *		Set up projection info for a scan node, if necessary.
@@ -12,9 +12,23 @@
 #include "postgres.h"
 #include "executor/execTPCH.h"
 
+#include "access/heapam.h"
+#include "access/relscan.h"
+#include "access/stratnum.h"
+#include "catalog/namespace.h"
+#include "catalog/pg_type.h"
+#include "executor/incTupleQueue.h"
+#include "miscadmin.h"
+#include "nodes/makefuncs.h"
+#include "utils/fmgroids.h"
+#include "utils/rel.h"
+#include "utils/snapmgr.h"
+
 #include <string.h>
 
 char *tables_with_update;
+bool tpch_inproc_delta;
+double tpch_scale_factor;
 double  wrong_exp_delta;
 double  exp_delta;
 double bd_prob;
@@ -35,7 +49,7 @@ double bd_prob;
 #define REGION_OID   35160
 #define NATION_OID   35155
 
-#define SCALE_FACTOR 1
+#define SCALE_FACTOR tpch_scale_factor
 
 #define LINEITEM_MAX_ROW (6000000 * SCALE_FACTOR)
 #define ORDERS_MAX_ROW   (6000000 * SCALE_FACTOR)
@@ -51,6 +65,7 @@ double bd_prob;
 
 #define DELETE_DELTA    "/home/totemtang/IQP/postgresql/pg_scripts/tpch_delta/delete_delta.sh "
 #define GEN_DELTA       "/home/totemtang/IQP/postgresql/pg_scripts/tpch_delta/gen_delta.sh "
+#define DELTA_SUFFIX    "_delta"
 #define CMD_SIZE        200
 #define STR_BUFSIZE     500
 
@@ -64,6 +79,10 @@ int exist_mask[DEFAULT_MASK_SIZE] = {0x1, 0x2, 0x3};
 int delta_count = 1;
 tpch_delta_mode delta_mode = TPCH_UNIFORM; 
 
+static int LookupTPCHTable(char *name, int default_oid);
+static int StreamTPCHDelta(TPCH_Update *update, int i, int begin, int end);
+static void CheckTPCHDeltaSource(Relation target, Relation source);
+
 static char *newstr()
 {
     char *str = palloc(sizeof(char) * STR_BUFSIZE);
@@ -135,17 +154,17 @@ BuildTPCHUpdate(char *tablenames)
     while(name != NULL)
     {
         if (strcmp(name, "lineitem") == 0)
-            update->table_oid[i] = LINEITEM_OID;
+            update->table_oid[i] = LookupTPCHTable(name, LINEITEM_OID);
         else if (strcmp(name, "orders") == 0)
-            update->table_oid[i] = ORDERS_OID;
+            update->table_oid[i] = LookupTPCHTable(name, ORDERS_OID);
         else if (strcmp(name, "customer") == 0)
-            update->table_oid[i] = CUSTOMER_OID;
+            update->table_oid[i] = LookupTPCHTable(name, CUSTOMER_OID);
         else if (strcmp(name, "partsupp") == 0)
-            update->table_oid[i] = PARTSUPP_OID;
+            update->table_oid[i] = LookupTPCHTable(name, PARTSUPP_OID);
         else if (strcmp(name, "part") == 0)
-            update->table_oid[i] = PART_OID;
+            update->table_oid[i] = LookupTPCHTable(name, PART_OID);
         else if (strcmp(name, "supplier") == 0)
-            update->table_oid[i] = SUPPLIER_OID;
+            update->table_oid[i] = LookupTPCHTable(name, SUPPLIER_OID);
         else
             elog(ERROR, "Unrecognized table name %s", name); 
 
@@ -168,6 +187,21 @@ BuildTPCHUpdate(char *tablenames)
     return update; 
 }
 
+/*
+ * Resolve the table through the search path so that freshly loaded databases
+ * (e.g., src/test/iqp) work; fall back to the OIDs of the original setup.
+ */
+static int
+LookupTPCHTable(char *name, int default_oid)
+{
+    Oid relid = RelnameGetRelid(name); 
+
+    if (OidIsValid(relid))
+        return (int) relid; 
+
+    return default_oid; 
+}
+
 static 
 int Uniform(int expected, int width)
 {
@@ -325,7 +359,8 @@ PopulateUpdate(TPCH_Update *update, int numdelta, bool wrong_prediction)
         sprintf(buffer, " %d", update->tpch_delta[i].delta_array[0]); 
         strcat(update->delete_commands[i], buffer); 
       
-        if (!wrong_prediction) 
+        /* In-process deltas never touch the base table, so nothing to delete */
+        if (!wrong_prediction && !tpch_inproc_delta) 
         {
             elog(NOTICE, "delete command %s", update->delete_commands[i]); 
             system(update->delete_commands[i]);
@@ -365,8 +400,9 @@ void
 GenTPCHUpdate(TPCH_Update *update, int delta_index)
 {
     char buffer[STR_BUFSIZE]; 
-    char *cur_update_command = malloc(sizeof(char) * STR_BUFSIZE);
+    char *cur_update_command;
     int *delta_array;
+    int ntuples;
 
     for(int i = 0; i < update->numUpdates; i++) 
     {
@@ -374,6 +410,15 @@ GenTPCHUpdate(TPCH_Update *update, int delta_index)
         if (delta_array[delta_index] == delta_array[delta_index + 1])
             continue; 
 
+        if (tpch_inproc_delta)
+        {
+            ntuples = StreamTPCHDelta(update, i, delta_array[delta_index], delta_array[delta_index + 1]);
+            elog(NOTICE, "update %s [%d, %d): %d rows", update->update_tables[i], 
+                    delta_array[delta_index], delta_array[delta_index + 1], ntuples); 
+            continue; 
+        }
+
+        cur_update_command = malloc(sizeof(char) * STR_BUFSIZE);
         memset(buffer, 0, STR_BUFSIZE); 
         memset(cur_update_command, 0, STR_BUFSIZE); 
 
@@ -384,9 +429,103 @@ GenTPCHUpdate(TPCH_Update *update, int delta_index)
 
         elog(NOTICE, "update command %s", cur_update_command); 
         system(cur_update_command);
+
+        free(cur_update_command); 
+    }
+}
+
+/*
+ * StreamTPCHDelta
+ *      Generate one delta of the i-th updated table inside the backend
+ *
+ * Rather than shelling out to gen_delta.sh, the rows whose key falls in 
+ * [begin, end) are read from the staging table <table>_delta and written 
+ * straight into the tuple queue of the updated table. The key is the first 
+ * column (e.g., l_orderkey, ps_partkey), i.e., the unit of delta_array. 
+ * The base table is left untouched, so runs are repeatable without 
+ * delete_delta.sh. Returns the number of streamed rows. 
+ */
+static int
+StreamTPCHDelta(TPCH_Update *update, int i, int begin, int end)
+{
+    Relation    target;
+    Relation    source;
+    char        source_name[NAMEDATALEN];
+    ScanKeyData key[2];
+    HeapScanDesc scan;
+    HeapTuple   tuple;
+    IncTupQueueWriter *tq_writer;
+    int         ntuples = 0;
+
+    target = heap_open(update->table_oid[i], AccessShareLock);
+
+    tq_writer = CreateIncTupQueueWriter(target, RelationGetDescr(target));
+    if (!OpenIncTupQueueWriter(tq_writer))
+    {
+        /* The running query does not read this table */
+        DestroyIncTupQueueWriter(tq_writer);
+        heap_close(target, AccessShareLock);
+        return 0; 
+    }
+
+    snprintf(source_name, NAMEDATALEN, "%s%s", update->update_tables[i], DELTA_SUFFIX);
+    source = heap_openrv(makeRangeVar(NULL, source_name, -1), AccessShareLock);
+    CheckTPCHDeltaSource(target, source);
+
+    if (RelationGetDescr(source)->attrs[0]->atttypid == INT8OID)
+    {
+        ScanKeyInit(&key[0], 1, BTGreaterEqualStrategyNumber, F_INT8GE, Int64GetDatum((int64) begin));
+        ScanKeyInit(&key[1], 1, BTLessStrategyNumber, F_INT8LT, Int64GetDatum((int64) end));
+    }
+    else
+    {
+        ScanKeyInit(&key[0], 1, BTGreaterEqualStrategyNumber, F_INT4GE, Int32GetDatum(begin));
+        ScanKeyInit(&key[1], 1, BTLessStrategyNumber, F_INT4LT, Int32GetDatum(end));
+    }
+
+    scan = heap_beginscan(source, GetActiveSnapshot(), 2, key);
+    while ((tuple = heap_getnext(scan, ForwardScanDirection)) != NULL)
+    {
+        CHECK_FOR_INTERRUPTS();
+        WriteIncTupQueue(tq_writer, tuple); 
+        ntuples++;
+    }
+    heap_endscan(scan);
+
+    CloseIncTupQueueWriter(tq_writer);
+    DestroyIncTupQueueWriter(tq_writer);
+
+    heap_close(source, AccessShareLock);
+    heap_close(target, AccessShareLock);
+
+    return ntuples; 
+}
+
+/*
+ * Tuples are copied into the tuple queue verbatim, so the staging table 
+ * must have the same row type as the updated table and an integer key.
+ */
+static void
+CheckTPCHDeltaSource(Relation target, Relation source)
+{
+    TupleDesc tdesc = RelationGetDescr(target); 
+    TupleDesc sdesc = RelationGetDescr(source); 
+
+    if (tdesc->natts != sdesc->natts)
+        elog(ERROR, "delta table %s has %d columns, but %s has %d", 
+                RelationGetRelationName(source), sdesc->natts,
+                RelationGetRelationName(target), tdesc->natts); 
+
+    for (int i = 0; i < tdesc->natts; i++)
+    {
+        if (tdesc->attrs[i]->atttypid != sdesc->attrs[i]->atttypid)
+            elog(ERROR, "column %d of delta table %s does not match %s", 
+                    i + 1, RelationGetRelationName(source), RelationGetRelationName(target)); 
     }
 
-    free(cur_update_command); 
+    if (sdesc->attrs[0]->atttypid != INT4OID && sdesc->attrs[0]->atttypid != INT8OID)
+        elog(ERROR, "delta table %s must have an integer key as its first column", 
+                RelationGetRelationName(source)); 
 }
 
 char *GetTableName(TPCH_Update *update, int oid)
@@ -0,0 +1,394 @@
+/*-------------------------------------------------------------------------
+ *
+ * incDeltaReceiver.c
+ *	  An implementation of DestReceiver that turns the per-round results of
+ *	  incremental query processing into a stream of result deltas
+ *
+ * In IQP mode every round emits the complete result over the data seen so
+ * far. This receiver sits in front of the real destination, remembers the
+ * result of the previous round and, at the end of each round, forwards only
+ * the rows that disappeared (sign -1) and the rows that appeared (sign +1),
+ * followed by a marker row (sign 0, all other columns NULL). Two columns are
+ * appended to the query's own:
+ *
+ *		iqp_round	int4	the round (delta index) that produced the row
+ *		iqp_sign	int4	+1 insert, -1 delete, 0 end of round
+ *
+ * The widened descriptor is fixed when the executor starts, and becomes the
+ * query's result descriptor (queryDesc->tupDesc), so the RowDescription, the
+ * portal's result formats and any tuplestore behind a cursor all see the
+ * same columns as the rows sent.  Since the extra columns come last, the
+ * query's target list still describes the leading ones.
+ *
+ * Rows are compared by their text output, as a client would see them, and
+ * duplicates are tracked as counts, so the stream applies to a multiset.
+ *
+ * The receiver lives as long as the query: a cursor that is fetched one
+ * round at a time reuses it, with a new inner receiver, for every FETCH.
+ *
+ * IDENTIFICATION
+ *	  src/backend/executor/incDeltaReceiver.c
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include "access/hash.h"
+#include "access/htup_details.h"
+#include "catalog/pg_type.h"
+#include "executor/incDeltaReceiver.h"
+#include "executor/tuptable.h"
+#include "lib/stringinfo.h"
+#include "nodes/pg_list.h"
+#include "utils/hsearch.h"
+#include "utils/lsyscache.h"
+#include "utils/memutils.h"
+
+bool iqp_delta_output;
+
+/* One distinct result row */
+typedef struct IncDeltaEntry
+{
+    char           *key;            /* text form of the row; hash key */
+    MinimalTuple    tuple;          /* the row itself */
+    int             prev_count;     /* copies in the previous round's result */
+    int             cur_count;      /* copies in this round's result */
+} IncDeltaEntry;
+
+typedef struct
+{
+    DestReceiver    pub;
+    /* parameters: */
+    DestReceiver   *inner;          /* where the deltas go */
+    MemoryContext   cxt;            /* holds the results of both rounds */
+    TupleDesc       typeinfo;       /* the plan's result descriptor */
+    /* workspace: */
+    MemoryContext   rowcxt;         /* reset for every received row */
+    TupleDesc       deltadesc;      /* typeinfo plus iqp_round and iqp_sign */
+    TupleTableSlot *rowslot;        /* for deforming stored rows */
+    TupleTableSlot *outslot;        /* for sending rows to inner */
+    FmgrInfo       *outfuncs;       /* output functions of typeinfo */
+    HTAB           *results;        /* IncDeltaEntry by key */
+    List           *arrivals;       /* entries seen this round, in order */
+    StringInfoData  buf;
+    bool            open;           /* does inner still accept rows? */
+} DR_incdelta;
+
+static void incDeltaStartupReceiver(DestReceiver *self, int operation, TupleDesc typeinfo);
+static bool incDeltaReceiveSlot(TupleTableSlot *slot, DestReceiver *self);
+static void incDeltaShutdownReceiver(DestReceiver *self);
+static void incDeltaDestroyReceiver(DestReceiver *self);
+
+static bool incDeltaSend(DR_incdelta *myState, MinimalTuple tuple, int round, int sign);
+static uint32 incDeltaHash(const void *key, Size keysize);
+static int incDeltaMatch(const void *key1, const void *key2, Size keysize);
+
+/*
+ * Prepare to receive tuples from executor.  typeinfo is the widened
+ * descriptor; the rows arrive in the plan's own, given at setup.
+ */
+static void
+incDeltaStartupReceiver(DestReceiver *self, int operation, TupleDesc typeinfo)
+{
+    DR_incdelta *myState = (DR_incdelta *) self;
+
+    /* every FETCH of a cursor starts us again; the last result is kept */
+    myState->open = true;
+    (*myState->inner->rStartup) (myState->inner, operation, myState->deltadesc);
+}
+
+/*
+ * Receive a row of the current round's result; nothing is sent until the
+ * round ends.
+ */
+static bool
+incDeltaReceiveSlot(TupleTableSlot *slot, DestReceiver *self)
+{
+    DR_incdelta *myState = (DR_incdelta *) self;
+    StringInfo  buf = &myState->buf;
+    MemoryContext old;
+    IncDeltaEntry *entry;
+    char       *key;
+    bool        found;
+
+    if (!myState->open)
+        return false;
+
+    slot_getallattrs(slot);
+
+    /* Build the key: the length-prefixed text of each column */
+    old = MemoryContextSwitchTo(myState->rowcxt);
+    resetStringInfo(buf);
+    for (int i = 0; i < myState->typeinfo->natts; i++)
+    {
+        char *str;
+
+        if (slot->tts_isnull[i])
+        {
+            appendStringInfoString(buf, "-1:");
+            continue;
+        }
+
+        str = OutputFunctionCall(&myState->outfuncs[i], slot->tts_values[i]);
+        appendStringInfo(buf, "%d:%s", (int) strlen(str), str);
+    }
+    (void) MemoryContextSwitchTo(old);
+
+    key = buf->data;
+    entry = (IncDeltaEntry *) hash_search(myState->results, &key, HASH_ENTER, &found);
+    if (!found)
+    {
+        old = MemoryContextSwitchTo(myState->cxt);
+        entry->key = pstrdup(buf->data);
+        entry->tuple = ExecCopySlotMinimalTuple(slot);
+        entry->prev_count = 0;
+        entry->cur_count = 0;
+        (void) MemoryContextSwitchTo(old);
+    }
+
+    if (entry->cur_count++ == 0)
+    {
+        old = MemoryContextSwitchTo(myState->cxt);
+        myState->arrivals = lappend(myState->arrivals, entry);
+        (void) MemoryContextSwitchTo(old);
+    }
+
+    MemoryContextReset(myState->rowcxt);
+
+    return true;
+}
+
+/*
+ * IncDeltaDestEndRound
+ *      Send the difference between this round's result and the previous
+ *      one, then the end-of-round marker
+ *
+ * Deletions go first, then insertions in the order the rows arrived.
+ * Returns false if the inner receiver asked to stop.
+ */
+bool
+IncDeltaDestEndRound(DestReceiver *self, int round)
+{
+    DR_incdelta *myState = (DR_incdelta *) self;
+    HASH_SEQ_STATUS status;
+    IncDeltaEntry *entry;
+    ListCell   *lc;
+
+    Assert(self->mydest == DestIncDelta);
+
+    if (!myState->open)
+        return false;
+
+    hash_seq_init(&status, myState->results);
+    while ((entry = (IncDeltaEntry *) hash_seq_search(&status)) != NULL)
+    {
+        for (int i = entry->cur_count; i < entry->prev_count && myState->open; i++)
+            myState->open = incDeltaSend(myState, entry->tuple, round, -1);
+    }
+
+    foreach(lc, myState->arrivals)
+    {
+        entry = (IncDeltaEntry *) lfirst(lc);
+        for (int i = entry->prev_count; i < entry->cur_count && myState->open; i++)
+            myState->open = incDeltaSend(myState, entry->tuple, round, 1);
+    }
+    list_free(myState->arrivals);
+    myState->arrivals = NIL;
+
+    /* This round's result becomes the previous one */
+    hash_seq_init(&status, myState->results);
+    while ((entry = (IncDeltaEntry *) hash_seq_search(&status)) != NULL)
+    {
+        if (entry->cur_count == 0)
+        {
+            char *key = entry->key;
+
+            pfree(entry->tuple);
+            (void) hash_search(myState->results, &key, HASH_REMOVE, NULL);
+            pfree(key);
+            continue;
+        }
+
+        entry->prev_count = entry->cur_count;
+        entry->cur_count = 0;
+    }
+
+    if (myState->open)
+        myState->open = incDeltaSend(myState, NULL, round, 0);
+
+    return myState->open;
+}
+
+/*
+ * Send one row, or the end-of-round marker if tuple is NULL
+ */
+static bool
+incDeltaSend(DR_incdelta *myState, MinimalTuple tuple, int round, int sign)
+{
+    TupleTableSlot *outslot = myState->outslot;
+    int         natts = myState->typeinfo->natts;
+
+    ExecClearTuple(outslot);
+    outslot->tts_values[natts] = Int32GetDatum(round);
+    outslot->tts_isnull[natts] = false;
+    outslot->tts_values[natts + 1] = Int32GetDatum(sign);
+    outslot->tts_isnull[natts + 1] = false;
+
+    if (tuple != NULL)
+    {
+        TupleTableSlot *rowslot = myState->rowslot;
+
+        ExecStoreMinimalTuple(tuple, rowslot, false);
+        slot_getallattrs(rowslot);
+        memcpy(outslot->tts_values, rowslot->tts_values, sizeof(Datum) * natts);
+        memcpy(outslot->tts_isnull, rowslot->tts_isnull, sizeof(bool) * natts);
+    }
+    else
+    {
+        for (int i = 0; i < natts; i++)
+            outslot->tts_isnull[i] = true;
+    }
+
+    ExecStoreVirtualTuple(outslot);
+
+    return (*myState->inner->receiveSlot) (outslot, myState->inner);
+}
+
+/*
+ * Clean up at end of an executor run; the result of the last round stays 
+ * around for the next run
+ */
+static void
+incDeltaShutdownReceiver(DestReceiver *self)
+{
+    DR_incdelta *myState = (DR_incdelta *) self;
+
+    (*myState->inner->rShutdown) (myState->inner);
+}
+
+/*
+ * Destroy receiver when done with it; the inner receiver belongs to the caller
+ */
+static void
+incDeltaDestroyReceiver(DestReceiver *self)
+{
+    DR_incdelta *myState = (DR_incdelta *) self;
+
+    ExecDropSingleTupleTableSlot(myState->rowslot);
+    ExecDropSingleTupleTableSlot(myState->outslot);
+    hash_destroy(myState->results);
+    MemoryContextDelete(myState->rowcxt);
+    list_free(myState->arrivals);
+    pfree(self);
+}
+
+static uint32
+incDeltaHash(const void *key, Size keysize)
+{
+    const char *str = *(char *const *) key;
+
+    return DatumGetUInt32(hash_any((const unsigned char *) str, strlen(str)));
+}
+
+static int
+incDeltaMatch(const void *key1, const void *key2, Size keysize)
+{
+    return strcmp(*(char *const *) key1, *(char *const *) key2);
+}
+
+/*
+ * Initially create a DestReceiver object.
+ */
+DestReceiver *
+CreateIncDeltaDestReceiver(void)
+{
+    DR_incdelta *self = (DR_incdelta *) palloc0(sizeof(DR_incdelta));
+
+    self->pub.receiveSlot = incDeltaReceiveSlot;
+    self->pub.rStartup = incDeltaStartupReceiver;
+    self->pub.rShutdown = incDeltaShutdownReceiver;
+    self->pub.rDestroy = incDeltaDestroyReceiver;
+    self->pub.mydest = DestIncDelta;
+
+    /* private fields will be set by SetIncDeltaDestReceiverParams */
+
+    return (DestReceiver *) self;
+}
+
+/*
+ * Set parameters for a IncDelta DestReceiver
+ *
+ * typeinfo is the plan's result descriptor.  This builds the widened one,
+ * which the caller must use as the query's result descriptor, and all the
+ * state kept across rounds, in mc.
+ */
+void
+SetIncDeltaDestReceiverParams(DestReceiver *self, TupleDesc typeinfo, MemoryContext mc)
+{
+    DR_incdelta *myState = (DR_incdelta *) self;
+    MemoryContext old;
+    int         natts = typeinfo->natts;
+    HASHCTL     ctl;
+
+    Assert(myState->pub.mydest == DestIncDelta);
+    myState->cxt = mc;
+
+    old = MemoryContextSwitchTo(mc);
+
+    myState->typeinfo = typeinfo;
+
+    myState->deltadesc = CreateTemplateTupleDesc(natts + 2, false);
+    for (int i = 0; i < natts; i++)
+        TupleDescCopyEntry(myState->deltadesc, (AttrNumber) (i + 1), typeinfo, (AttrNumber) (i + 1));
+    TupleDescInitEntry(myState->deltadesc, (AttrNumber) (natts + 1), "iqp_round", INT4OID, -1, 0);
+    TupleDescInitEntry(myState->deltadesc, (AttrNumber) (natts + 2), "iqp_sign", INT4OID, -1, 0);
+
+    myState->outfuncs = (FmgrInfo *) palloc(sizeof(FmgrInfo) * Max(natts, 1));
+    for (int i = 0; i < natts; i++)
+    {
+        Oid     typoutput;
+        bool    typisvarlena;
+
+        getTypeOutputInfo(typeinfo->attrs[i]->atttypid, &typoutput, &typisvarlena);
+        fmgr_info_cxt(typoutput, &myState->outfuncs[i], mc);
+    }
+
+    memset(&ctl, 0, sizeof(ctl));
+    ctl.keysize = sizeof(char *);
+    ctl.entrysize = sizeof(IncDeltaEntry);
+    ctl.hash = incDeltaHash;
+    ctl.match = incDeltaMatch;
+    ctl.hcxt = mc;
+    myState->results = hash_create("IQP delta result", 1024, &ctl,
+            HASH_ELEM | HASH_FUNCTION | HASH_COMPARE | HASH_CONTEXT);
+
+    myState->rowcxt = AllocSetContextCreate(mc, "IQP delta row", ALLOCSET_SMALL_SIZES);
+    myState->rowslot = MakeSingleTupleTableSlot(typeinfo);
+    myState->outslot = MakeSingleTupleTableSlot(myState->deltadesc);
+    myState->arrivals = NIL;
+    initStringInfo(&myState->buf);
+    myState->open = false;
+
+    (void) MemoryContextSwitchTo(old);
+}
+
+/*
+ * The query's result descriptor when its rows go through this receiver
+ */
+TupleDesc
+IncDeltaDestResultDesc(DestReceiver *self)
+{
+    Assert(self->mydest == DestIncDelta);
+    return ((DR_incdelta *) self)->deltadesc;
+}
+
+/*
+ * Set the destination of the deltas, for one executor run
+ */
+void
+SetIncDeltaDestReceiverInner(DestReceiver *self, DestReceiver *inner)
+{
+    Assert(self->mydest == DestIncDelta);
+    ((DR_incdelta *) self)->inner = inner;
+}
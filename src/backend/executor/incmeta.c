@@ -64,6 +64,7 @@ bool enable_incremental;
 int  memory_budget;     /* kB units*/
 DecisionMethod decision_method;
 bool external_delta;
+bool iqp_cursor_refresh;
 
 bool use_material = true; 
 bool use_sym_hashjoin = true;
@@ -77,6 +78,8 @@ bool  useWrongPrediction;
 
 bool is_complete;
 
+double iqp_replan_threshold;
+
 char *incTagName[INC_TAG_NUM] = {"HASHJOIN", "MERGEJOIN", "NESTLOOP", "AGGHASH", "AGGSORT", 
     "SORT", "MATERIAL", "SEQSCAN", "INDEXSCAN","INVALID"}; 
 
@@ -111,6 +114,7 @@ static void ExecGenUpdate(EState *estate, int deltaIndex);
 static void ExecWaitUpdate(EState *estate); 
 static void ExecCollectUpdate(EState *estate);
 static bool ExecPropRealUpdate(IncInfo *incInfo); 
+static void ExecAdaptUpdate(EState *estate);
 
 /* Functions for deciding intermediate state to be discarded or not */
 static void ExecGetMemInfo(IncInfo **incInfoArray, int numIncInfo); 
@@ -209,6 +213,10 @@ ExecIncStart(EState *estate, PlanState *ps)
             estate->numDelta = 2;
         estate->deltaIndex = 0; 
 
+        estate->deltaCorrection = (double *)palloc(sizeof(double) * estate->es_numLeaf);
+        for (int i = 0; i < estate->es_numLeaf; i++)
+            estate->deltaCorrection[i] = 1.0; 
+
         if (delta_mode == TPCH_DEFAULT)
             use_default_tpch = true;  
 
@@ -352,6 +360,9 @@ ExecIncRun(EState *estate, PlanState *planstate)
         /* step 5. let's consider the delta after the next delta */
         if (estate->deltaIndex < estate->numDelta)
         {
+            /* Replace estimates that are far off by the delta we actually got */
+            ExecAdaptUpdate(estate); 
+
             if (external_delta)
                 ReAllocDeltaArray(estate);
 
@@ -838,6 +849,10 @@ ExecEstimateUpdate(EState *estate, bool slave)
             }
         }
 
+        /* Scale by how far off the previous estimate was (see ExecAdaptUpdate) */
+        if (estate->deltaCorrection != NULL)
+            update_rows = (int)ceil(update_rows * estate->deltaCorrection[i]); 
+
         if (slave)
         {
             ss->ps.ps_IncInfo_slave->leftUpdate = (update_rows != 0);
@@ -1017,6 +1032,13 @@ ExecWaitUpdate(EState *estate)
 
     IncTQPool *tq_pool = estate->tq_pool; 
 
+    /* In-process deltas are complete once GenTPCHUpdate returns */
+    if (!external_delta && tpch_inproc_delta)
+    {
+        elog(NOTICE, "delta %d", GetTQUpdate(tq_pool)); 
+        return; 
+    }
+
     for (;;) 
     {
 		CHECK_FOR_INTERRUPTS();
@@ -1069,6 +1091,66 @@ static void ExecCollectUpdate(EState *estate)
 }
 
 
+/*
+ * ExecAdaptUpdate
+ *      Check the delta we just collected against the estimate the states 
+ *      were decided with 
+ *
+ * The slave IncInfo tree still holds the estimated size of the current 
+ * delta (base_delta_rows) when we get here. If the observed size differs 
+ * by more than iqp_replan_threshold times for any table, the estimates are 
+ * replaced by the observed sizes and propagated again, so the decision made 
+ * in step 5 of ExecIncRun -- which precedes the pull actions of this round -- 
+ * is based on what actually arrived instead of a bad keep/drop choice 
+ * being paid for the whole delta. The ratio is also folded into the 
+ * correction applied to the estimates of the following deltas; since those 
+ * estimates were already corrected, it compounds the existing factor. 
+ */
+static void 
+ExecAdaptUpdate(EState *estate)
+{
+    ScanState **reader_ss_array = estate->reader_ss; 
+    IncInfo    *incInfo; 
+    double      estimated, observed, ratio; 
+    bool        diverged = false; 
+
+    if (iqp_replan_threshold <= 0)
+        return; 
+
+    for (int i = 0; i < estate->es_numLeaf; i++)
+    {
+        incInfo = reader_ss_array[i]->ps.ps_IncInfo_slave; 
+        estimated = incInfo->base_delta_rows; 
+        observed = (reader_ss_array[i]->tq_reader != NULL) ? 
+                (double)reader_ss_array[i]->tq_reader->ss_total_num : 0; 
+
+        if (estimated == observed)
+            continue; 
+
+        ratio = Max(estimated, observed) / Max(Min(estimated, observed), 1); 
+        if ((estimated == 0) == (observed == 0) && ratio < iqp_replan_threshold)
+            continue; 
+
+        elog(NOTICE, "delta of %s: estimated %.0f, observed %.0f", 
+                RelationGetRelationName(reader_ss_array[i]->ss_currentRelation), estimated, observed); 
+
+        if (estimated > 0)
+            estate->deltaCorrection[i] *= observed / estimated; 
+        incInfo->base_delta_rows = observed; 
+        incInfo->leftUpdate = (observed != 0); 
+        diverged = true; 
+    }
+
+    if (!diverged)
+        return; 
+
+    (void) ExecIncPropUpdate(estate->es_incInfo_slave[estate->es_numIncInfo - 1], ROW_CPU); 
+
+    /* For the first delta, ROW_MEM is propagated for the first time right after this */
+    if (estate->deltaIndex > 1)
+        (void) ExecIncPropUpdate(estate->es_incInfo_slave[estate->es_numIncInfo - 1], ROW_MEM); 
+}
+
 static bool ExecPropRealUpdate(IncInfo *incInfo)
 {
     if (incInfo->lefttree == NULL && incInfo->righttree == NULL) 
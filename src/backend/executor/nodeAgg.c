@@ -194,6 +194,27 @@
  *	  transition values.  hashcontext is the single context created to support
  *	  all hash tables.
  *
+ *	  Spilling to disk:
+ *
+ *	  In AGG_HASHED mode the planner's estimate of the number of groups can be
+ *	  badly off, so we track the memory used by the hash tables and stop
+ *	  creating new groups once it exceeds work_mem.  From then on, input
+ *	  tuples whose group is already in memory are aggregated as usual, while
+ *	  all other tuples are partitioned by hash value and written to logical
+ *	  tapes (one per partition, per grouping set).  After the in-memory groups
+ *	  have been emitted, each partition is read back as a "batch" and
+ *	  aggregated into a fresh hash table for its grouping set; a batch that
+ *	  still doesn't fit spills again, using further bits of the hash value.
+ *	  Every pass completes at least one group, so this always terminates.
+ *	  AGG_MIXED mode never spills, since its hash tables are filled while the
+ *	  sorted phases consume the input.
+ *
+ *	  When executor_batch_size is set, a plain aggregate (no grouping, no
+ *	  DISTINCT/ORDER BY/FILTER) directly over a SeqScan reads its input
+ *	  batch-at-a-time: the scan evaluates its qual over a whole TupleBatch,
+ *	  the aggregate arguments are computed as column vectors, and only the
+ *	  transition function calls remain per row.  See execBatch.c.
+ *
  *
  * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
  * Portions Copyright (c) 1994, Regents of the University of California
@@ -211,8 +232,10 @@
 #include "catalog/pg_aggregate.h"
 #include "catalog/pg_proc.h"
 #include "catalog/pg_type.h"
+#include "executor/execBatch.h"
 #include "executor/executor.h"
 #include "executor/nodeAgg.h"
+#include "executor/nodeSeqscan.h"
 #include "miscadmin.h"
 #include "nodes/makefuncs.h"
 #include "nodes/nodeFuncs.h"
@@ -227,6 +250,8 @@
 #include "utils/syscache.h"
 #include "utils/tuplesort.h"
 #include "utils/datum.h"
+#include "utils/dynahash.h"
+#include "utils/logtape.h"
 
  /*
   * totem: Add the header for incremental query processing 
@@ -528,6 +553,74 @@ typedef struct AggStatePerHashData
 	Agg		   *aggnode;		/* original Agg node, for numGroups etc. */
 }			AggStatePerHashData;
 
+/*
+ * Control how many partitions are created when spilling a hash table.  We
+ * aim for each partition's groups to fit in work_mem, with some slack for
+ * estimation errors, but don't let the tapes' write buffers take more than
+ * a quarter of the memory budget.
+ */
+#define HASHAGG_PARTITION_FACTOR 1.50
+#define HASHAGG_MIN_PARTITIONS 4
+#define HASHAGG_MAX_PARTITIONS 1024
+#define HASHAGG_WRITE_BUFFER_SIZE BLCKSZ
+#define HASHAGG_READ_BUFFER_SIZE BLCKSZ
+
+/*
+ * HashAggTapeSet - a set of spill tapes shared by the batches made from it
+ *
+ * Each spill writes its partitions to the tapes of one LogicalTapeSet; the
+ * batches created from those partitions keep it open until the last one has
+ * been read.
+ */
+typedef struct HashAggTapeSet
+{
+	LogicalTapeSet *tapeset;
+	int			refcount;		/* batches still to read from it */
+	long		nblocks;		/* size of the underlying file, in blocks */
+} HashAggTapeSet;
+
+/*
+ * HashAggSpillData - per-grouping-set state for spilling input tuples
+ *
+ * The partition of a tuple is taken from the hash value bits just below
+ * those already used by earlier spills of the same data.
+ */
+typedef struct HashAggSpillData
+{
+	HashAggTapeSet *tapes;		/* created at the first spilled tuple */
+	int			npartitions;	/* number of partitions (tapes) */
+	int64	   *ntuples;		/* number of tuples in each partition */
+	uint32		mask;			/* mask to find partition from hash value */
+	int			shift;			/* after masking, shift by this amount */
+	int			used_bits;		/* hash bits used, including this spill's */
+}			HashAggSpillData;
+
+/*
+ * HashAggBatch - a spilled partition, waiting to be aggregated
+ */
+typedef struct HashAggBatch
+{
+	int			setno;			/* grouping set */
+	int			used_bits;		/* number of hash bits already used */
+	HashAggTapeSet *tapes;		/* tape set holding the input */
+	int			input_tapenum;	/* input partition tape */
+	int64		input_tuples;	/* number of tuples in this batch */
+} HashAggBatch;
+
+/*
+ * AggBatchStateData - state for reading the input batch-at-a-time
+ *
+ * args[] holds the compiled argument expressions of all transition states,
+ * laid out like the combined projection slot: those of pertrans start at
+ * args[pertrans->inputoff].
+ */
+typedef struct AggBatchStateData
+{
+	SeqScanState *scan;			/* input node */
+	int			nargs;			/* length of args[] */
+	BatchExprState **args;		/* per-input compiled expressions */
+} AggBatchStateData;
+
 
 static void select_current_set(AggState *aggstate, int setno, bool is_hash);
 static void initialize_phase(AggState *aggstate, int newphase);
@@ -568,11 +661,28 @@ static TupleTableSlot *project_aggregates(AggState *aggstate);
 static Bitmapset *find_unaggregated_cols(AggState *aggstate);
 static bool find_unaggregated_cols_walker(Node *node, Bitmapset **colnos);
 static void build_hash_table(AggState *aggstate);
+static void build_hash_table_for_set(AggState *aggstate, int setno,
+						 double ngroups);
 static TupleHashEntryData *lookup_hash_entry(AggState *aggstate);
 static AggStatePerGroup *lookup_hash_entries(AggState *aggstate);
 static TupleTableSlot *agg_retrieve_direct(AggState *aggstate);
 static void agg_fill_hash_table(AggState *aggstate);
+static bool agg_refill_hash_table(AggState *aggstate);
 static TupleTableSlot *agg_retrieve_hash_table(AggState *aggstate);
+static TupleTableSlot *agg_retrieve_hash_table_in_memory(AggState *aggstate);
+static void agg_init_batch(AggState *aggstate);
+static TupleTableSlot *agg_retrieve_plain_batch(AggState *aggstate);
+static void hash_agg_check_limits(AggState *aggstate);
+static void hash_agg_enter_spill_mode(AggState *aggstate);
+static void hash_agg_reset_spill(AggState *aggstate);
+static void hash_spill_init(AggState *aggstate, HashAggSpill spill,
+				int used_bits, double input_groups);
+static void hash_spill_tuple(AggState *aggstate, HashAggSpill spill,
+				 TupleTableSlot *inputslot, uint32 hash);
+static void hash_spill_finish(AggState *aggstate, HashAggSpill spill,
+				  int setno);
+static void hash_tapes_release(AggState *aggstate, HashAggTapeSet *tapes);
+static MinimalTuple hash_batch_read_tuple(HashAggBatch *batch);
 static Datum GetAggInitVal(Datum textInitVal, Oid transtype);
 static void build_pertrans_for_aggref(AggStatePerTrans pertrans,
 						  AggState *aggstate, EState *estate,
@@ -1110,6 +1220,10 @@ advance_aggregates(AggState *aggstate, AggStatePerGroup pergroup, AggStatePerGro
 				{
 					AggStatePerGroup pergroupstate;
 
+					/* skip sets whose group was spilled to disk */
+					if (pergroups[setno] == NULL)
+						continue;
+
 					select_current_set(aggstate, setno, true);
 
 					pergroupstate = &pergroups[setno][transno];
@@ -1878,37 +1992,65 @@ find_unaggregated_cols_walker(Node *node, Bitmapset **colnos)
  *
  * The hash tables always live in the hashcontext's per-tuple memory context
  * (there is only one of these for all tables together, since they are all
- * reset at the same time).
+ * reset at the same time).  That context is also what we measure against
+ * hash_mem_limit to decide when to spill.
  */
 static void
 build_hash_table(AggState *aggstate)
 {
-	MemoryContext tmpmem = aggstate->tmpcontext->ecxt_per_tuple_memory;
-	Size		additionalsize;
+	double		ngroups = 0;
+	int			npartitions;
 	int			i;
 
 	Assert(aggstate->aggstrategy == AGG_HASHED || aggstate->aggstrategy == AGG_MIXED);
 
-	additionalsize = aggstate->numtrans * sizeof(AggStatePerGroupData);
+	for (i = 0; i < aggstate->num_hashes; ++i)
+		ngroups += aggstate->perhash[i].aggnode->numGroups;
+
+	hash_agg_set_limits(aggstate->hashentrysize, ngroups, 0,
+						&aggstate->hash_mem_limit, &npartitions);
+	aggstate->hash_ngroups_current = 0;
 
 	for (i = 0; i < aggstate->num_hashes; ++i)
 	{
-		AggStatePerHash perhash = &aggstate->perhash[i];
-
-		Assert(perhash->aggnode->numGroups > 0);
-
-		perhash->hashtable = BuildTupleHashTable(perhash->numCols,
-												 perhash->hashGrpColIdxHash,
-												 perhash->eqfunctions,
-												 perhash->hashfunctions,
-												 perhash->aggnode->numGroups,
-												 additionalsize,
-												 aggstate->hashcontext->ecxt_per_tuple_memory,
-												 tmpmem,
-												 DO_AGGSPLIT_SKIPFINAL(aggstate->aggsplit));
+		Assert(aggstate->perhash[i].aggnode->numGroups > 0);
+
+		build_hash_table_for_set(aggstate, i,
+								 aggstate->perhash[i].aggnode->numGroups);
 	}
 }
 
+/*
+ * Build an empty hash table for one grouping set, sized for the given
+ * number of groups.  The bucket array is never made larger than the memory
+ * limit could fill, so that a gross overestimate can't blow the budget
+ * before we've seen a single row; the table grows if it needs to.
+ */
+static void
+build_hash_table_for_set(AggState *aggstate, int setno, double ngroups)
+{
+	AggStatePerHash perhash = &aggstate->perhash[setno];
+	MemoryContext tmpmem = aggstate->tmpcontext->ecxt_per_tuple_memory;
+	Size		additionalsize;
+	double		max_nbuckets;
+	long		nbuckets;
+
+	additionalsize = aggstate->numtrans * sizeof(AggStatePerGroupData);
+
+	max_nbuckets = aggstate->hash_mem_limit / aggstate->hashentrysize;
+	nbuckets = (long) Max(Min(ngroups, max_nbuckets), 1);
+
+	perhash->hashtable = BuildTupleHashTable(perhash->numCols,
+											 perhash->hashGrpColIdxHash,
+											 perhash->eqfunctions,
+											 perhash->hashfunctions,
+											 nbuckets,
+											 additionalsize,
+											 aggstate->hashcontext->ecxt_per_tuple_memory,
+											 tmpmem,
+											 DO_AGGSPLIT_SKIPFINAL(aggstate->aggsplit));
+}
+
 /*
  * Compute columns that actually need to be stored in hashtable entries.  The
  * incoming tuples from the child plan node will contain grouping columns,
@@ -2044,6 +2186,49 @@ hash_agg_entry_size(int numAggs)
 	return entrysize;
 }
 
+/*
+ * Compute the memory limit at which hashed aggregation starts spilling, and
+ * the number of partitions to spill into, for a hash table expected to hold
+ * input_groups groups of hashentrysize bytes each.  used_bits is the number
+ * of hash value bits already consumed by earlier spills of the same input.
+ *
+ * This is also used by the planner to estimate the cost of spilling.
+ */
+void
+hash_agg_set_limits(double hashentrysize, double input_groups, int used_bits,
+					Size *mem_limit, int *num_partitions)
+{
+	Size		limit = work_mem * 1024L;
+	double		mem_wanted;
+	int			npartitions;
+	int			max_partitions;
+	int			partition_bits;
+
+	/* enough partitions that each is expected to fit in memory */
+	mem_wanted = HASHAGG_PARTITION_FACTOR * input_groups * hashentrysize;
+	if (mem_wanted / limit + 1 > HASHAGG_MAX_PARTITIONS)
+		npartitions = HASHAGG_MAX_PARTITIONS;
+	else
+		npartitions = 1 + (int) (mem_wanted / limit);
+
+	/* but keep the tapes' write buffers to a fraction of the budget */
+	max_partitions = limit / 4 / HASHAGG_WRITE_BUFFER_SIZE;
+	npartitions = Min(npartitions, max_partitions);
+	npartitions = Max(npartitions, HASHAGG_MIN_PARTITIONS);
+
+	/* round to a power of two, without running out of hash bits */
+	partition_bits = my_log2(npartitions);
+	if (partition_bits + used_bits >= 32)
+		partition_bits = 32 - used_bits;
+	*num_partitions = 1 << partition_bits;
+
+	/* leave room for the write buffers if that still leaves a usable table */
+	if (limit > 4 * (Size) *num_partitions * HASHAGG_WRITE_BUFFER_SIZE)
+		limit -= (Size) *num_partitions * HASHAGG_WRITE_BUFFER_SIZE;
+
+	*mem_limit = limit;
+}
+
 /*
  * Find or create a hashtable entry for the tuple group containing the current
  * tuple (already set in tmpcontext's outertuple slot), in the current grouping
@@ -2075,6 +2260,25 @@ lookup_hash_entry(AggState *aggstate)
 	}
 	ExecStoreVirtualTuple(hashslot);
 
+	/*
+	 * Once over the memory limit, only groups already in the table are
+	 * advanced; the input tuple of any other group is saved for later.
+	 */
+	if (aggstate->hash_spill_mode)
+	{
+		entry = LookupTupleHashEntry(perhash->hashtable, hashslot, NULL);
+		if (entry == NULL)
+		{
+			uint32		hash;
+
+			hash = TupleHashTableHashSlot(perhash->hashtable, hashslot);
+			hash_spill_tuple(aggstate,
+							 &aggstate->hash_spills[aggstate->current_set],
+							 inputslot, hash);
+		}
+		return entry;
+	}
+
 	/* find or create the hashtable entry using the filtered tuple */
 	entry = LookupTupleHashEntry(perhash->hashtable, hashslot, &isnew);
 
@@ -2086,6 +2290,9 @@ lookup_hash_entry(AggState *aggstate)
 		/* initialize aggregates for new tuple group */
 		initialize_aggregates(aggstate, (AggStatePerGroup) entry->additional,
 							  -1);
+
+		aggstate->hash_ngroups_current++;
+		hash_agg_check_limits(aggstate);
 	}
 
 	return entry;
@@ -2094,6 +2301,7 @@ lookup_hash_entry(AggState *aggstate)
 /*
  * Look up hash entries for the current tuple in all hashed grouping sets,
  * returning an array of pergroup pointers suitable for advance_aggregates.
+ * A set's pointer is NULL if the tuple was spilled to disk for that set.
  *
  * Be aware that lookup_hash_entry can reset the tmpcontext.
  */
@@ -2106,13 +2314,295 @@ lookup_hash_entries(AggState *aggstate)
 
 	for (setno = 0; setno < numHashes; setno++)
 	{
+		TupleHashEntryData *entry;
+
 		select_current_set(aggstate, setno, true);
-		pergroup[setno] = lookup_hash_entry(aggstate)->additional;
+		entry = lookup_hash_entry(aggstate);
+		pergroup[setno] = entry ? (AggStatePerGroup) entry->additional : NULL;
 	}
 
 	return pergroup;
 }
 
+/*
+ * Check whether the hash tables have outgrown the memory limit, and if so
+ * switch to spilling new groups to disk.
+ *
+ * Only AGG_HASHED can spill: in AGG_MIXED mode the input is consumed by the
+ * sorted phases and can't be deferred.  We always keep at least one group in
+ * memory so that every pass over the data makes progress.
+ */
+static void
+hash_agg_check_limits(AggState *aggstate)
+{
+	Size		hash_mem;
+
+	hash_mem = MemoryContextMemAllocated(aggstate->hashcontext->ecxt_per_tuple_memory,
+										 true);
+	if (hash_mem > aggstate->hash_mem_peak)
+		aggstate->hash_mem_peak = hash_mem;
+
+	if (aggstate->aggstrategy != AGG_HASHED || aggstate->hash_spill_mode)
+		return;
+
+	if (hash_mem > aggstate->hash_mem_limit &&
+		aggstate->hash_ngroups_current > 0)
+		hash_agg_enter_spill_mode(aggstate);
+}
+
+/*
+ * Stop creating new groups; from now on, tuples that don't belong to a group
+ * already in memory are written to disk.
+ */
+static void
+hash_agg_enter_spill_mode(AggState *aggstate)
+{
+	aggstate->hash_spill_mode = true;
+	aggstate->hash_ever_spilled = true;
+
+	if (aggstate->hash_spills == NULL)
+		aggstate->hash_spills = (HashAggSpill)
+			MemoryContextAllocZero(aggstate->ss.ps.state->es_query_cxt,
+								   sizeof(HashAggSpillData) * aggstate->num_hashes);
+
+	/*
+	 * While refilling from a batch, agg_refill_hash_table has already set up
+	 * the spill for the batch's set.  Otherwise we're still reading the
+	 * original input, and every set needs one.
+	 */
+	if (aggstate->hash_batch_setno < 0)
+	{
+		int			setno;
+
+		for (setno = 0; setno < aggstate->num_hashes; setno++)
+			hash_spill_init(aggstate, &aggstate->hash_spills[setno], 0,
+							aggstate->perhash[setno].aggnode->numGroups);
+	}
+}
+
+/*
+ * Throw away all spill state: close any spill files and forget the batches
+ * still waiting to be processed.  Used when rescanning or shutting down.
+ */
+static void
+hash_agg_reset_spill(AggState *aggstate)
+{
+	ListCell   *lc;
+	int			setno;
+
+	foreach(lc, aggstate->hash_batches)
+	{
+		HashAggBatch *batch = (HashAggBatch *) lfirst(lc);
+
+		hash_tapes_release(aggstate, batch->tapes);
+		pfree(batch);
+	}
+	list_free(aggstate->hash_batches);
+	aggstate->hash_batches = NIL;
+
+	if (aggstate->hash_spills != NULL)
+	{
+		for (setno = 0; setno < aggstate->num_hashes; setno++)
+		{
+			HashAggSpill spill = &aggstate->hash_spills[setno];
+
+			if (spill->tapes != NULL)
+			{
+				LogicalTapeSetClose(spill->tapes->tapeset);
+				pfree(spill->tapes);
+				spill->tapes = NULL;
+			}
+			if (spill->ntuples != NULL)
+			{
+				pfree(spill->ntuples);
+				spill->ntuples = NULL;
+			}
+		}
+	}
+
+	aggstate->hash_spill_mode = false;
+	aggstate->hash_ever_spilled = false;
+	aggstate->hash_batch_setno = -1;
+	aggstate->hash_disk_open = 0;
+}
+
+/*
+ * Prepare to spill the input of one grouping set, choosing the number of
+ * partitions from the number of groups expected.  The tapes themselves are
+ * only created once the first tuple is spilled.
+ */
+static void
+hash_spill_init(AggState *aggstate, HashAggSpill spill, int used_bits,
+				double input_groups)
+{
+	Size		mem_limit;
+	int			npartitions;
+	int			partition_bits;
+
+	hash_agg_set_limits(aggstate->hashentrysize, input_groups, used_bits,
+						&mem_limit, &npartitions);
+	partition_bits = my_log2(npartitions);
+
+	spill->tapes = NULL;
+	spill->npartitions = npartitions;
+	spill->ntuples = (int64 *)
+		MemoryContextAllocZero(aggstate->ss.ps.state->es_query_cxt,
+							   sizeof(int64) * npartitions);
+	spill->used_bits = used_bits + partition_bits;
+
+	if (partition_bits == 0)
+	{
+		/* out of hash bits; everything goes to the single partition */
+		spill->shift = 0;
+		spill->mask = 0;
+	}
+	else
+	{
+		spill->shift = 32 - used_bits - partition_bits;
+		spill->mask = (npartitions - 1) << spill->shift;
+	}
+}
+
+/*
+ * Write an input tuple to the partition selected by its hash value.
+ */
+static void
+hash_spill_tuple(AggState *aggstate, HashAggSpill spill,
+				 TupleTableSlot *inputslot, uint32 hash)
+{
+	MemoryContext oldcxt;
+	MinimalTuple tuple;
+	int			partition;
+
+	/* the tapes' buffers must outlive the per-tuple context */
+	oldcxt = MemoryContextSwitchTo(aggstate->ss.ps.state->es_query_cxt);
+
+	if (spill->tapes == NULL)
+	{
+		spill->tapes = (HashAggTapeSet *) palloc(sizeof(HashAggTapeSet));
+		spill->tapes->tapeset = LogicalTapeSetCreate(spill->npartitions);
+		spill->tapes->refcount = 0;
+		spill->tapes->nblocks = 0;
+	}
+
+	partition = (hash & spill->mask) >> spill->shift;
+
+	tuple = ExecCopySlotMinimalTuple(inputslot);
+	LogicalTapeWrite(spill->tapes->tapeset, partition,
+					 (void *) tuple, tuple->t_len);
+	spill->ntuples[partition]++;
+	pfree(tuple);
+
+	MemoryContextSwitchTo(oldcxt);
+}
+
+/*
+ * Done spilling one grouping set's input: turn each non-empty partition
+ * into a batch to be processed later.
+ */
+static void
+hash_spill_finish(AggState *aggstate, HashAggSpill spill, int setno)
+{
+	HashAggTapeSet *tapes = spill->tapes;
+	MemoryContext oldcxt;
+	int			i;
+
+	if (spill->ntuples == NULL)
+		return;
+
+	if (tapes != NULL)
+	{
+		oldcxt = MemoryContextSwitchTo(aggstate->ss.ps.state->es_query_cxt);
+
+		for (i = 0; i < spill->npartitions; i++)
+		{
+			HashAggBatch *batch;
+
+			if (spill->ntuples[i] == 0)
+				continue;
+
+			LogicalTapeRewindForRead(tapes->tapeset, i,
+									 HASHAGG_READ_BUFFER_SIZE);
+
+			batch = (HashAggBatch *) palloc(sizeof(HashAggBatch));
+			batch->setno = setno;
+			batch->used_bits = spill->used_bits;
+			batch->tapes = tapes;
+			batch->input_tapenum = i;
+			batch->input_tuples = spill->ntuples[i];
+
+			/* process the newest batches first, to keep disk usage down */
+			aggstate->hash_batches = lcons(batch, aggstate->hash_batches);
+			tapes->refcount++;
+		}
+
+		MemoryContextSwitchTo(oldcxt);
+
+		tapes->nblocks = LogicalTapeSetBlocks(tapes->tapeset);
+		aggstate->hash_disk_open += tapes->nblocks;
+		if (aggstate->hash_disk_open > aggstate->hash_disk_peak)
+			aggstate->hash_disk_peak = aggstate->hash_disk_open;
+
+		spill->tapes = NULL;
+	}
+
+	pfree(spill->ntuples);
+	spill->ntuples = NULL;
+}
+
+/*
+ * A batch is done with its tape set; close it if no other batch needs it.
+ */
+static void
+hash_tapes_release(AggState *aggstate, HashAggTapeSet *tapes)
+{
+	Assert(tapes->refcount > 0);
+
+	if (--tapes->refcount == 0)
+	{
+		LogicalTapeSetClose(tapes->tapeset);
+		aggstate->hash_disk_open -= tapes->nblocks;
+		pfree(tapes);
+	}
+}
+
+/*
+ * Read the next spilled tuple of a batch, or NULL at the end.  The tuple is
+ * palloc'd in the caller's memory context.
+ */
+static MinimalTuple
+hash_batch_read_tuple(HashAggBatch *batch)
+{
+	LogicalTapeSet *tapeset = batch->tapes->tapeset;
+	MinimalTuple tuple;
+	uint32		t_len;
+	size_t		nread;
+
+	nread = LogicalTapeRead(tapeset, batch->input_tapenum,
+							&t_len, sizeof(t_len));
+	if (nread == 0)
+		return NULL;
+	if (nread != sizeof(t_len))
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("unexpected EOF for tape %d: requested %zu bytes, read %zu bytes",
+						batch->input_tapenum, sizeof(t_len), nread)));
+
+	tuple = (MinimalTuple) palloc(t_len);
+	tuple->t_len = t_len;
+
+	nread = LogicalTapeRead(tapeset, batch->input_tapenum,
+							(char *) tuple + sizeof(uint32),
+							t_len - sizeof(uint32));
+	if (nread != t_len - sizeof(uint32))
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("unexpected EOF for tape %d: requested %zu bytes, read %zu bytes",
+						batch->input_tapenum, t_len - sizeof(uint32), nread)));
+
+	return tuple;
+}
+
 /*
  * ExecAgg -
  *
@@ -2147,6 +2637,12 @@ ExecAgg(PlanState *pstate)
 				result = agg_retrieve_hash_table(node);
 				break;
 			case AGG_PLAIN:
+				if (node->batch)
+				{
+					result = agg_retrieve_plain_batch(node);
+					break;
+				}
+				/* FALLTHROUGH */
 			case AGG_SORTED:
 				result = agg_retrieve_direct(node);
 				break;
@@ -2512,6 +3008,79 @@ agg_retrieve_direct(AggState *aggstate)
 	return NULL;
 }
 
+/*
+ * ExecAgg for plain aggregation over batch-at-a-time input
+ *
+ * Equivalent to agg_retrieve_direct for a single AGG_PLAIN group, but pulls
+ * whole batches from the SeqScan below and evaluates the aggregate
+ * arguments column-wise before running the transition functions.
+ */
+static TupleTableSlot *
+agg_retrieve_plain_batch(AggState *aggstate)
+{
+	AggBatchState bstate = aggstate->batch;
+	ExprContext *econtext = aggstate->ss.ps.ps_ExprContext;
+	ExprContext *tmpcontext = aggstate->tmpcontext;
+	AggStatePerGroup pergroup = aggstate->pergroup;
+	TupleBatch *batch;
+
+	ReScanExprContext(econtext);
+	ReScanExprContext(aggstate->aggcontexts[0]);
+
+	initialize_aggregates(aggstate, pergroup, 1);
+
+	while ((batch = ExecSeqScanNextBatch(bstate->scan)) != NULL)
+	{
+		MemoryContext oldcontext;
+		int			transno;
+		int			i;
+
+		/* compute all argument vectors in per-input memory */
+		oldcontext = MemoryContextSwitchTo(tmpcontext->ecxt_per_tuple_memory);
+		for (i = 0; i < bstate->nargs; i++)
+			ExecEvalBatchExpr(bstate->args[i], batch);
+		MemoryContextSwitchTo(oldcontext);
+
+		for (transno = 0; transno < aggstate->numtrans; transno++)
+		{
+			AggStatePerTrans pertrans = &aggstate->pertrans[transno];
+			FunctionCallInfo fcinfo = &pertrans->transfn_fcinfo;
+			BatchExprState **args = &bstate->args[pertrans->inputoff];
+			int			numTransInputs = pertrans->numTransInputs;
+			int			j;
+
+			for (j = 0; j < batch->nsel; j++)
+			{
+				int			row = batch->sel[j];
+
+				for (i = 0; i < numTransInputs; i++)
+				{
+					fcinfo->arg[i + 1] = args[i]->resvalues[row];
+					fcinfo->argnull[i + 1] = args[i]->resnulls[row];
+				}
+				advance_transition_function(aggstate, pertrans,
+											&pergroup[transno]);
+			}
+		}
+
+		/*
+		 * The argument vectors must survive the whole batch, so the
+		 * per-input context is reset once per batch rather than per row.
+		 */
+		ResetExprContext(tmpcontext);
+	}
+
+	aggstate->agg_done = true;
+
+	/* no representative input row; plain aggs can't reference one anyway */
+	econtext->ecxt_outertuple = aggstate->ss.ss_ScanTupleSlot;
+	prepare_projection_slot(aggstate, econtext->ecxt_outertuple, 0);
+	select_current_set(aggstate, 0, false);
+	finalize_aggregates(aggstate, aggstate->peragg, pergroup);
+
+	return project_aggregates(aggstate);
+}
+
 /*
  * ExecAgg for hashed case: read input and build hash table
  */
@@ -2541,7 +3110,10 @@ agg_fill_hash_table(AggState *aggstate)
 
 		/* Advance the aggregates */
 		if (DO_AGGSPLIT_COMBINE(aggstate->aggsplit))
-			combine_aggregates(aggstate, pergroups[0]);
+		{
+			if (pergroups[0] != NULL)
+				combine_aggregates(aggstate, pergroups[0]);
+		}
 		else
 			advance_aggregates(aggstate, NULL, pergroups);
 
@@ -2552,6 +3124,16 @@ agg_fill_hash_table(AggState *aggstate)
 		ResetExprContext(aggstate->tmpcontext);
 	}
 
+	/* Turn whatever was spilled into batches to process later */
+	if (aggstate->hash_spill_mode)
+	{
+		int			setno;
+
+		for (setno = 0; setno < aggstate->num_hashes; setno++)
+			hash_spill_finish(aggstate, &aggstate->hash_spills[setno], setno);
+		aggstate->hash_spill_mode = false;
+	}
+
 	aggstate->table_filled = true;
 	/* Initialize to walk the first hash table */
 	select_current_set(aggstate, 0, true);
@@ -2559,11 +3141,132 @@ agg_fill_hash_table(AggState *aggstate)
 						   &aggstate->perhash[0].hashiter);
 }
 
+/*
+ * Aggregate the next spilled batch into a fresh hash table.
+ *
+ * Returns false if there are no more batches.  Otherwise the table for the
+ * batch's grouping set has been filled and its iterator reset, and any of
+ * the batch's tuples that didn't fit have been spilled again into new
+ * batches.
+ */
+static bool
+agg_refill_hash_table(AggState *aggstate)
+{
+	HashAggBatch *batch;
+	HashAggSpill spill;
+	AggStatePerGroup *pergroups = aggstate->hash_pergroup;
+	TupleTableSlot *slot = aggstate->hash_spill_slot;
+	MemoryContext oldcxt;
+	Size		mem_limit;
+	int			npartitions;
+	int			setno;
+
+	if (aggstate->hash_batches == NIL)
+		return false;
+
+	oldcxt = MemoryContextSwitchTo(aggstate->ss.ps.state->es_query_cxt);
+	batch = (HashAggBatch *) linitial(aggstate->hash_batches);
+	aggstate->hash_batches = list_delete_first(aggstate->hash_batches);
+	MemoryContextSwitchTo(oldcxt);
+
+	/*
+	 * Free the groups we just emitted, and start over with a table sized for
+	 * this batch.  (The other sets' tables go away too, but they have already
+	 * been emitted and won't be looked at again.)  We rescan rather than
+	 * reset so that aggregate shutdown callbacks get run.
+	 */
+	ReScanExprContext(aggstate->hashcontext);
+
+	hash_agg_set_limits(aggstate->hashentrysize, batch->input_tuples,
+						batch->used_bits, &mem_limit, &npartitions);
+	aggstate->hash_mem_limit = mem_limit;
+	aggstate->hash_ngroups_current = 0;
+	aggstate->hash_spill_mode = false;
+	aggstate->hash_batch_setno = batch->setno;
+	build_hash_table_for_set(aggstate, batch->setno, batch->input_tuples);
+
+	/* tuples that don't fit this time round are split further */
+	spill = &aggstate->hash_spills[batch->setno];
+	hash_spill_init(aggstate, spill, batch->used_bits, batch->input_tuples);
+
+	/* only the batch's own set gets advanced */
+	for (setno = 0; setno < aggstate->num_hashes; setno++)
+		pergroups[setno] = NULL;
+
+	for (;;)
+	{
+		MinimalTuple tuple;
+		TupleHashEntryData *entry;
+
+		CHECK_FOR_INTERRUPTS();
+
+		tuple = hash_batch_read_tuple(batch);
+		if (tuple == NULL)
+			break;
+
+		ExecStoreMinimalTuple(tuple, slot, true);
+		aggstate->tmpcontext->ecxt_outertuple = slot;
+
+		select_current_set(aggstate, batch->setno, true);
+		entry = lookup_hash_entry(aggstate);
+
+		if (entry != NULL)
+		{
+			pergroups[batch->setno] = (AggStatePerGroup) entry->additional;
+
+			if (DO_AGGSPLIT_COMBINE(aggstate->aggsplit))
+				combine_aggregates(aggstate, pergroups[batch->setno]);
+			else
+				advance_aggregates(aggstate, NULL, pergroups);
+		}
+
+		ResetExprContext(aggstate->tmpcontext);
+	}
+
+	ExecClearTuple(slot);
+
+	hash_spill_finish(aggstate, spill, batch->setno);
+	aggstate->hash_spill_mode = false;
+
+	hash_tapes_release(aggstate, batch->tapes);
+	pfree(batch);
+	aggstate->hash_batches_used++;
+
+	/* Initialize to walk the new hash table */
+	select_current_set(aggstate, aggstate->hash_batch_setno, true);
+	ResetTupleHashIterator(aggstate->perhash[aggstate->hash_batch_setno].hashtable,
+						   &aggstate->perhash[aggstate->hash_batch_setno].hashiter);
+
+	return true;
+}
+
 /*
  * ExecAgg for hashed case: retrieving groups from hash table
+ *
+ * After the in-memory groups are exhausted, refill the hash table from the
+ * next spilled batch, until there are none left.
  */
 static TupleTableSlot *
 agg_retrieve_hash_table(AggState *aggstate)
+{
+	TupleTableSlot *result = NULL;
+
+	while (result == NULL && !aggstate->agg_done)
+	{
+		result = agg_retrieve_hash_table_in_memory(aggstate);
+		if (result == NULL && !agg_refill_hash_table(aggstate))
+			aggstate->agg_done = true;
+	}
+
+	return result;
+}
+
+/*
+ * Retrieve the groups from the in-memory hash tables, returning NULL once
+ * they are exhausted.
+ */
+static TupleTableSlot *
+agg_retrieve_hash_table_in_memory(AggState *aggstate)
 {
 	ExprContext *econtext;
 	AggStatePerAgg peragg;
@@ -2607,7 +3310,9 @@ agg_retrieve_hash_table(AggState *aggstate)
 		{
 			int			nextset = aggstate->current_set + 1;
 
-			if (nextset < aggstate->num_hashes)
+			/* a refilled batch has only its own set's table to walk */
+			if (nextset < aggstate->num_hashes &&
+				aggstate->hash_batch_setno < 0)
 			{
 				/*
 				 * Switch to next grouping set, reinitialize, and restart the
@@ -2623,8 +3328,7 @@ agg_retrieve_hash_table(AggState *aggstate)
 			}
 			else
 			{
-				/* No more hashtables, so done */
-				aggstate->agg_done = TRUE;
+				/* No more hashtables in memory */
 				return NULL;
 			}
 		}
@@ -3041,6 +3745,20 @@ ExecInitAgg(Agg *node, EState *estate, int eflags)
 		/* this is an array of pointers, not structures */
 		aggstate->hash_pergroup = palloc0(sizeof(AggStatePerGroup) * numHashes);
 
+		/*
+		 * Estimate the space per group the same way the planner does, to
+		 * choose table sizes and the number of partitions when spilling.
+		 */
+		aggstate->hashentrysize = MAXALIGN(outerPlan->plan_width) +
+			MAXALIGN(SizeofMinimalTupleHeader) +
+			hash_agg_entry_size(aggstate->numtrans);
+		aggstate->hash_batch_setno = -1;
+
+		/* spilled input tuples are read back into this slot */
+		aggstate->hash_spill_slot = ExecInitExtraTupleSlot(estate);
+		ExecSetSlotDescriptor(aggstate->hash_spill_slot,
+							  ExecGetResultType(outerPlanState(aggstate)));
+
 		find_hash_columns(aggstate);
 		build_hash_table(aggstate);
 		aggstate->table_filled = false;
@@ -3473,9 +4191,111 @@ ExecInitAgg(Agg *node, EState *estate, int eflags)
 				(errcode(ERRCODE_GROUPING_ERROR),
 				 errmsg("aggregate function calls cannot be nested")));
 
+	if (executor_batch_size > 0 &&
+		!estate->es_incremental && !estate->es_dbt)
+		agg_init_batch(aggstate);
+
 	return aggstate;
 }
 
+/*
+ * Set up batch-at-a-time input for the agg node, if its shape allows it;
+ * otherwise leave aggstate->batch NULL so that ExecAgg uses the row path.
+ */
+static void
+agg_init_batch(AggState *aggstate)
+{
+	Agg		   *node = (Agg *) aggstate->ss.ps.plan;
+	PlanState  *outerstate = outerPlanState(aggstate);
+	SeqScanState *scan;
+	TupleBatch *batch;
+	AggBatchState bstate;
+	AttrNumber *attmap = NULL;
+	int			nmap = 0;
+	int			nargs = 0;
+	int			transno;
+
+	if (aggstate->aggstrategy != AGG_PLAIN ||
+		node->groupingSets != NIL ||
+		DO_AGGSPLIT_COMBINE(aggstate->aggsplit) ||
+		!IsA(outerstate, SeqScanState))
+		return;
+
+	for (transno = 0; transno < aggstate->numtrans; transno++)
+	{
+		AggStatePerTrans pertrans = &aggstate->pertrans[transno];
+		Aggref	   *aggref = pertrans->aggref;
+
+		if (pertrans->numSortCols > 0 ||
+			aggref->aggfilter != NULL ||
+			aggref->aggkind != AGGKIND_NORMAL ||
+			aggref->aggdirectargs != NIL ||
+			pertrans->numInputs != pertrans->numTransInputs)
+			return;
+		nargs += pertrans->numInputs;
+	}
+
+	scan = (SeqScanState *) outerstate;
+	batch = ExecSeqScanInitBatch(scan, executor_batch_size);
+	if (batch == NULL)
+		return;
+
+	/*
+	 * The arguments reference the scan's output through OUTER_VAR.  If the
+	 * scan projects, map its output columns back to the scan tuple; only
+	 * plain Vars can be mapped.
+	 */
+	if (scan->ss.ps.ps_ProjInfo != NULL)
+	{
+		Scan	   *scanplan = (Scan *) scan->ss.ps.plan;
+		ListCell   *lc;
+
+		nmap = list_length(scanplan->plan.targetlist);
+		attmap = (AttrNumber *) palloc0(Max(nmap, 1) * sizeof(AttrNumber));
+		foreach(lc, scanplan->plan.targetlist)
+		{
+			TargetEntry *tle = lfirst_node(TargetEntry, lc);
+			Var		   *var = (Var *) tle->expr;
+
+			if (IsA(var, Var) &&
+				var->varno == scanplan->scanrelid &&
+				var->varattno > 0)
+				attmap[tle->resno - 1] = var->varattno;
+		}
+	}
+
+	bstate = (AggBatchState) palloc0(sizeof(AggBatchStateData));
+	bstate->scan = scan;
+	bstate->nargs = nargs;
+	bstate->args = (BatchExprState **)
+		palloc0(Max(nargs, 1) * sizeof(BatchExprState *));
+
+	for (transno = 0; transno < aggstate->numtrans; transno++)
+	{
+		AggStatePerTrans pertrans = &aggstate->pertrans[transno];
+		int			argno = pertrans->inputoff;
+		ListCell   *lc;
+
+		foreach(lc, pertrans->aggref->args)
+		{
+			TargetEntry *tle = lfirst_node(TargetEntry, lc);
+
+			bstate->args[argno] = ExecBuildBatchExpr(tle->expr, batch,
+													 OUTER_VAR, attmap, nmap);
+			if (bstate->args[argno] == NULL)
+			{
+				/* unsupported argument: put the scan back in row mode */
+				scan->batch = NULL;
+				scan->batchqual = NULL;
+				return;
+			}
+			argno++;
+		}
+	}
+
+	aggstate->batch = bstate;
+}
+
 /*
  * Build the state needed to calculate a state value for an aggregate.
  *
@@ -3953,6 +4773,9 @@ ExecEndAgg(AggState *node)
 		}
 	}
 
+	/* Close any spill files */
+	hash_agg_reset_spill(node);
+
 	/* And ensure any agg shutdown callbacks have been called */
 	for (setno = 0; setno < numGroupingSets; setno++)
 		ReScanExprContext(node->aggcontexts[setno]);
@@ -4000,9 +4823,11 @@ ExecReScanAgg(AggState *node)
 		 * If we do have the hash table, and the subplan does not have any
 		 * parameter changes, and none of our own parameter changes affect
 		 * input expressions of the aggregated functions, then we can just
-		 * rescan the existing hash table; no need to build it again.
+		 * rescan the existing hash table; no need to build it again.  That
+		 * doesn't work if we spilled, since the table then holds only the
+		 * last batch's groups.
 		 */
-		if (outerPlan->chgParam == NULL &&
+		if (outerPlan->chgParam == NULL && !node->hash_ever_spilled &&
 			!bms_overlap(node->ss.ps.chgParam, aggnode->aggParams))
 		{
 			ResetTupleHashIterator(node->perhash[0].hashtable,
@@ -4059,6 +4884,7 @@ ExecReScanAgg(AggState *node)
 	 */
 	if (node->aggstrategy == AGG_HASHED || node->aggstrategy == AGG_MIXED)
 	{
+		hash_agg_reset_spill(node);
 		ReScanExprContext(node->hashcontext);
 		/* Rebuild an empty hash table */
 		build_hash_table(node);
@@ -25,6 +25,14 @@
  *		until the subplan stops returning tuples, at which point that
  *		plan is shut down and the next started up.
  *
+ *		Subplans that the planner marked async-capable (currently only
+ *		foreign scans whose FDW supports it) are not run in this order.
+ *		Instead, each is sent an AsyncRequest when the Append starts, and
+ *		their tuples are returned as they arrive, interleaved with those
+ *		of the synchronous subplans; once the synchronous subplans are
+ *		exhausted, we sleep until some async subplan has something for us.
+ *		This lets, e.g., queries on several remote servers run at once.
+ *
  *		Append nodes don't make use of their left and right
  *		subtrees, rather they maintain a list of subplans so
  *		a typical append node looks like this in the plan tree:
@@ -57,12 +65,23 @@
 
 #include "postgres.h"
 
+#include "executor/execAsync.h"
 #include "executor/execdebug.h"
+#include "executor/execPartition.h"
 #include "executor/nodeAppend.h"
 #include "miscadmin.h"
+#include "pgstat.h"
+#include "storage/latch.h"
+
+/* Maximum number of wait events returned by one ExecAppendAsyncEventWait */
+#define EVENT_BUFFER_SIZE			16
 
 static TupleTableSlot *ExecAppend(PlanState *pstate);
 static bool exec_append_initialize_next(AppendState *appendstate);
+static void ExecAppendAsyncBegin(AppendState *node);
+static bool ExecAppendAsyncGetNext(AppendState *node, TupleTableSlot **result);
+static bool ExecAppendAsyncRequest(AppendState *node, TupleTableSlot **result);
+static void ExecAppendAsyncEventWait(AppendState *node);
 
 
 /* ----------------------------------------------------------------
@@ -116,6 +135,9 @@ exec_append_initialize_next(AppendState *appendstate)
  *		append node may not be scanned, but this way all of the
  *		structures get allocated in the executor's top level memory
  *		block instead of that of the call to ExecAppend.)
+ *
+ *		If partition pruning can be done with the values of external
+ *		Params, only the subscans of matching partitions are begun.
  * ----------------------------------------------------------------
  */
 AppendState *
@@ -123,8 +145,11 @@ ExecInitAppend(Append *node, EState *estate, int eflags)
 {
 	AppendState *appendstate = makeNode(AppendState);
 	PlanState **appendplanstates;
+	Bitmapset  *validsubplans = NULL;
+	bool		init_pruned = false;
 	int			nplans;
-	int			i;
+	int			i,
+				j;
 	ListCell   *lc;
 
 	/* check for unsupported flags */
@@ -137,18 +162,69 @@ ExecInitAppend(Append *node, EState *estate, int eflags)
 	ExecLockNonLeafAppendTables(node->partitioned_rels, estate);
 
 	/*
-	 * Set up empty vector of subplan states
+	 * create new AppendState for our append node
 	 */
+	appendstate->ps.plan = (Plan *) node;
+	appendstate->ps.state = estate;
+	appendstate->ps.ExecProcNode = ExecAppend;
+	appendstate->as_prune_state = NULL;
+	appendstate->as_valid_subplans = NULL;
+	appendstate->as_valid_stale = false;
+	appendstate->as_begun = false;
+	appendstate->as_asyncplans = NULL;
+	appendstate->as_nasyncplans = 0;
+	appendstate->as_asyncrequests = NULL;
+	appendstate->as_asyncresults = NULL;
+	appendstate->as_nasyncresults = 0;
+	appendstate->as_nasyncremain = 0;
+	appendstate->as_needrequest = NULL;
+	appendstate->as_eventset = NULL;
+
 	nplans = list_length(node->appendplans);
 
-	appendplanstates = (PlanState **) palloc0(nplans * sizeof(PlanState *));
+	/*
+	 * Set up run-time partition pruning, if the planner found it possible.
+	 * If the prune expressions use only external Params we can tell which
+	 * subplans are needed right now, and initialize only those.  Otherwise
+	 * all subplans must be initialized, and we find out which ones to scan
+	 * at the first execution.
+	 */
+	if (node->part_prune_info != NULL)
+	{
+		PartitionPruneState *prunestate;
+
+		prunestate = ExecSetupPartitionPruneState(&appendstate->ps,
+												  node->part_prune_info);
+		if (node->part_prune_info->exec_params)
+		{
+			appendstate->as_prune_state = prunestate;
+			appendstate->as_valid_stale = true;
+		}
+		else
+		{
+			validsubplans = ExecFindMatchingSubPlans(prunestate);
+			init_pruned = true;
+			nplans = bms_num_members(validsubplans);
+			if (nplans == 0)
+			{
+				/*
+				 * Nothing can match.  EXPLAIN needs at least one subplan to
+				 * deparse our targetlist, so initialize the first one anyway,
+				 * but keep the pruning state around to never scan it.
+				 */
+				validsubplans = bms_make_singleton(0);
+				nplans = 1;
+				appendstate->as_prune_state = prunestate;
+			}
+			else
+				ExecEndPartitionPruneState(prunestate);
+		}
+	}
 
 	/*
-	 * create new AppendState for our append node
+	 * Set up empty vector of subplan states
 	 */
-	appendstate->ps.plan = (Plan *) node;
-	appendstate->ps.state = estate;
-	appendstate->ps.ExecProcNode = ExecAppend;
+	appendplanstates = (PlanState **) palloc0(nplans * sizeof(PlanState *));
 	appendstate->appendplans = appendplanstates;
 	appendstate->as_nplans = nplans;
 
@@ -170,13 +246,53 @@ ExecInitAppend(Append *node, EState *estate, int eflags)
 	 * results into the array "appendplans".
 	 */
 	i = 0;
+	j = 0;
 	foreach(lc, node->appendplans)
 	{
 		Plan	   *initNode = (Plan *) lfirst(lc);
 
-		appendplanstates[i] = ExecInitNode(initNode, estate, eflags);
+		if (!init_pruned || bms_is_member(i, validsubplans))
+			appendplanstates[j++] = ExecInitNode(initNode, estate, eflags);
 		i++;
 	}
+	Assert(j == nplans);
+
+	/*
+	 * Set up an AsyncRequest for each async-capable subplan.  These live as
+	 * long as the node does, and are reused for every request.
+	 */
+	for (i = 0; i < nplans; i++)
+	{
+		if (appendplanstates[i]->async_capable)
+			appendstate->as_asyncplans =
+				bms_add_member(appendstate->as_asyncplans, i);
+	}
+	appendstate->as_nasyncplans = bms_num_members(appendstate->as_asyncplans);
+	if (appendstate->as_nasyncplans > 0)
+	{
+		appendstate->as_asyncrequests = (AsyncRequest **)
+			palloc0(nplans * sizeof(AsyncRequest *));
+
+		i = -1;
+		while ((i = bms_next_member(appendstate->as_asyncplans, i)) >= 0)
+		{
+			AsyncRequest *areq;
+
+			areq = palloc(sizeof(AsyncRequest));
+			areq->requestor = (PlanState *) appendstate;
+			areq->requestee = appendplanstates[i];
+			areq->request_index = i;
+			areq->callback_pending = false;
+			areq->request_complete = false;
+			areq->result = NULL;
+
+			appendstate->as_asyncrequests[i] = areq;
+		}
+
+		appendstate->as_asyncresults = (TupleTableSlot **)
+			palloc0(appendstate->as_nasyncplans * sizeof(TupleTableSlot *));
+	}
+	appendstate->as_syncdone = (appendstate->as_nasyncplans == nplans);
 
 	/*
 	 * initialize output tuple type
@@ -203,45 +319,85 @@ static TupleTableSlot *
 ExecAppend(PlanState *pstate)
 {
 	AppendState *node = castNode(AppendState, pstate);
+	TupleTableSlot *result;
+
+	/* With run-time pruning, find out which subplans to scan */
+	if (node->as_prune_state != NULL && node->as_valid_stale)
+	{
+		bms_free(node->as_valid_subplans);
+		node->as_valid_subplans =
+			ExecFindMatchingSubPlans(node->as_prune_state);
+		node->as_valid_stale = false;
+	}
+
+	/* On the first call, set all the async subplans going */
+	if (!node->as_begun)
+	{
+		node->as_begun = true;
+		if (node->as_nasyncplans > 0)
+			ExecAppendAsyncBegin(node);
+	}
 
 	for (;;)
 	{
 		PlanState  *subnode;
-		TupleTableSlot *result;
 
 		CHECK_FOR_INTERRUPTS();
 
 		/*
-		 * figure out which subplan we are currently processing
+		 * Return an async result if one has come in, or wait for one if the
+		 * sync subplans are all done.
 		 */
-		subnode = node->appendplans[node->as_whichplan];
+		if (node->as_nasyncplans > 0 &&
+			(node->as_syncdone || !bms_is_empty(node->as_needrequest)))
+		{
+			if (ExecAppendAsyncGetNext(node, &result))
+				return result;
+			Assert(!node->as_syncdone);
+			Assert(bms_is_empty(node->as_needrequest));
+		}
 
 		/*
-		 * get a tuple from the subplan
+		 * figure out which subplan we are currently processing, and skip it
+		 * if it is async or was pruned
 		 */
-		result = ExecProcNode(subnode);
+		subnode = node->appendplans[node->as_whichplan];
 
-		if (!TupIsNull(result))
+		if (!bms_is_member(node->as_whichplan, node->as_asyncplans) &&
+			(node->as_prune_state == NULL ||
+			 bms_is_member(node->as_whichplan, node->as_valid_subplans)))
 		{
 			/*
-			 * If the subplan gave us something then return it as-is. We do
-			 * NOT make use of the result slot that was set up in
-			 * ExecInitAppend; there's no need for it.
+			 * get a tuple from the subplan
 			 */
-			return result;
+			result = ExecProcNode(subnode);
+
+			if (!TupIsNull(result))
+			{
+				/*
+				 * If the subplan gave us something then return it as-is. We
+				 * do NOT make use of the result slot that was set up in
+				 * ExecInitAppend; there's no need for it.
+				 */
+				return result;
+			}
 		}
 
 		/*
 		 * Go on to the "next" subplan in the appropriate direction. If no
 		 * more subplans, return the empty slot set up for us by
-		 * ExecInitAppend.
+		 * ExecInitAppend, unless there are async subplans still to drain.
 		 */
 		if (ScanDirectionIsForward(node->ps.state->es_direction))
 			node->as_whichplan++;
 		else
 			node->as_whichplan--;
 		if (!exec_append_initialize_next(node))
-			return ExecClearTuple(node->ps.ps_ResultTupleSlot);
+		{
+			node->as_syncdone = true;
+			if (node->as_nasyncplans == 0)
+				return ExecClearTuple(node->ps.ps_ResultTupleSlot);
+		}
 
 		/* Else loop back and try to get a tuple from the new subplan */
 	}
@@ -273,6 +429,9 @@ ExecEndAppend(AppendState *node)
 	 */
 	for (i = 0; i < nplans; i++)
 		ExecEndNode(appendplans[i]);
+
+	if (node->as_prune_state != NULL)
+		ExecEndPartitionPruneState(node->as_prune_state);
 }
 
 void
@@ -298,6 +457,309 @@ ExecReScanAppend(AppendState *node)
 		if (subnode->chgParam == NULL)
 			ExecReScan(subnode);
 	}
+
+	/* New Param values may change which partitions match */
+	if (node->as_prune_state != NULL &&
+		node->as_prune_state->pinfo->exec_params &&
+		node->ps.chgParam != NULL)
+		node->as_valid_stale = true;
+
+	/* Forget about any requests made to the async subplans */
+	if (node->as_nasyncplans > 0)
+	{
+		i = -1;
+		while ((i = bms_next_member(node->as_asyncplans, i)) >= 0)
+		{
+			AsyncRequest *areq = node->as_asyncrequests[i];
+
+			areq->callback_pending = false;
+			areq->request_complete = false;
+			areq->result = NULL;
+		}
+
+		node->as_nasyncresults = 0;
+		node->as_nasyncremain = 0;
+		bms_free(node->as_needrequest);
+		node->as_needrequest = NULL;
+	}
+
+	node->as_begun = false;
+	node->as_syncdone = (node->as_nasyncplans == node->as_nplans);
 	node->as_whichplan = 0;
 	exec_append_initialize_next(node);
 }
+
+/* ----------------------------------------------------------------
+ *		ExecAppendAsyncBegin
+ *
+ *		Begin executing the async-capable subplans that are to be scanned,
+ *		by sending each of them a request for its first tuple.
+ * ----------------------------------------------------------------
+ */
+static void
+ExecAppendAsyncBegin(AppendState *node)
+{
+	Bitmapset  *validplans;
+	int			i;
+
+	/* Backward scan is not supported by async-aware Appends. */
+	Assert(ScanDirectionIsForward(node->ps.state->es_direction));
+
+	if (node->as_prune_state != NULL)
+		validplans = bms_intersect(node->as_asyncplans,
+								   node->as_valid_subplans);
+	else
+		validplans = bms_copy(node->as_asyncplans);
+
+	/* Must be set first, since a request may complete immediately. */
+	node->as_nasyncremain = bms_num_members(validplans);
+
+	i = -1;
+	while ((i = bms_next_member(validplans, i)) >= 0)
+	{
+		AsyncRequest *areq = node->as_asyncrequests[i];
+
+		Assert(areq->request_index == i);
+		Assert(!areq->callback_pending);
+
+		ExecAsyncRequest(areq);
+	}
+
+	bms_free(validplans);
+}
+
+/* ----------------------------------------------------------------
+ *		ExecAppendAsyncGetNext
+ *
+ *		Get the next tuple from any of the async subplans.  Returns true
+ *		with *result set if we got one, or if there's nothing left to scan
+ *		at all (*result is then an empty slot).  Returns false if no async
+ *		result is available yet but the sync subplans aren't finished, so
+ *		the caller should go run those.
+ * ----------------------------------------------------------------
+ */
+static bool
+ExecAppendAsyncGetNext(AppendState *node, TupleTableSlot **result)
+{
+	*result = NULL;
+
+	/* Request a tuple from the subplans that are ready for one. */
+	if (ExecAppendAsyncRequest(node, result))
+		return true;
+
+	while (node->as_nasyncremain > 0)
+	{
+		CHECK_FOR_INTERRUPTS();
+
+		/* Wait, or just poll if there's sync work we could be doing. */
+		ExecAppendAsyncEventWait(node);
+
+		if (ExecAppendAsyncRequest(node, result))
+			return true;
+
+		if (!node->as_syncdone)
+			break;
+	}
+
+	/*
+	 * If the sync subplans are done too, the whole Append is finished;
+	 * otherwise go back to scanning them.
+	 */
+	if (node->as_syncdone)
+	{
+		Assert(node->as_nasyncremain == 0);
+		*result = ExecClearTuple(node->ps.ps_ResultTupleSlot);
+		return true;
+	}
+
+	return false;
+}
+
+/* ----------------------------------------------------------------
+ *		ExecAppendAsyncRequest
+ *
+ *		Hand back a result that an async subplan has already produced, if
+ *		any; otherwise issue new requests to the subplans whose previous
+ *		result we have returned, and return one of their results if they
+ *		come back at once.
+ * ----------------------------------------------------------------
+ */
+static bool
+ExecAppendAsyncRequest(AppendState *node, TupleTableSlot **result)
+{
+	Bitmapset  *needrequest;
+	int			i;
+
+	/* Nothing to do if no subplan is waiting for a new request. */
+	if (bms_is_empty(node->as_needrequest))
+	{
+		Assert(node->as_nasyncresults == 0);
+		return false;
+	}
+
+	/*
+	 * Return a result we already have, if any.  The subplan that produced
+	 * it gets its next request only once the caller is done with it.
+	 */
+	if (node->as_nasyncresults > 0)
+	{
+		--node->as_nasyncresults;
+		*result = node->as_asyncresults[node->as_nasyncresults];
+		return true;
+	}
+
+	needrequest = node->as_needrequest;
+	node->as_needrequest = NULL;
+	i = -1;
+	while ((i = bms_next_member(needrequest, i)) >= 0)
+		ExecAsyncRequest(node->as_asyncrequests[i]);
+	bms_free(needrequest);
+
+	if (node->as_nasyncresults > 0)
+	{
+		--node->as_nasyncresults;
+		*result = node->as_asyncresults[node->as_nasyncresults];
+		return true;
+	}
+
+	return false;
+}
+
+/* ----------------------------------------------------------------
+ *		ExecAppendAsyncEventWait
+ *
+ *		Wait for an async subplan to become ready, and notify it.  If the
+ *		sync subplans aren't done, just poll without waiting.
+ * ----------------------------------------------------------------
+ */
+static void
+ExecAppendAsyncEventWait(AppendState *node)
+{
+	int			nevents = node->as_nasyncplans + 2;
+	long		timeout = node->as_syncdone ? -1 : 0;
+	WaitEvent	occurred_event[EVENT_BUFFER_SIZE];
+	int			noccurred;
+	int			i;
+
+	/* We should never be called when there are no valid async subplans. */
+	Assert(node->as_nasyncremain > 0);
+
+	node->as_eventset = CreateWaitEventSet(CurrentMemoryContext, nevents);
+
+	/*
+	 * Give each subplan with a pending request a chance to add an event.
+	 * This happens before we add our own latch and postmaster-death events,
+	 * so that a subplan can tell from the number of registered events
+	 * whether one of its siblings is already waiting.
+	 */
+	i = -1;
+	while ((i = bms_next_member(node->as_asyncplans, i)) >= 0)
+	{
+		AsyncRequest *areq = node->as_asyncrequests[i];
+
+		if (areq->callback_pending)
+			ExecAsyncConfigureWait(areq);
+	}
+
+	/*
+	 * If no subplan asked to wait for anything (say, because configuring
+	 * the wait completed its request), there's nothing to wait for.
+	 */
+	if (GetNumRegisteredWaitEvents(node->as_eventset) == 0)
+	{
+		FreeWaitEventSet(node->as_eventset);
+		node->as_eventset = NULL;
+		return;
+	}
+
+	AddWaitEventToSet(node->as_eventset, WL_LATCH_SET, PGINVALID_SOCKET,
+					  MyLatch, NULL);
+	if (IsUnderPostmaster)
+		AddWaitEventToSet(node->as_eventset, WL_POSTMASTER_DEATH,
+						  PGINVALID_SOCKET, NULL, NULL);
+
+	if (nevents > EVENT_BUFFER_SIZE)
+		nevents = EVENT_BUFFER_SIZE;
+
+	noccurred = WaitEventSetWait(node->as_eventset, timeout, occurred_event,
+								 nevents, WAIT_EVENT_APPEND_READY);
+	FreeWaitEventSet(node->as_eventset);
+	node->as_eventset = NULL;
+
+	for (i = 0; i < noccurred; i++)
+	{
+		WaitEvent  *w = &occurred_event[i];
+
+		if (w->events & WL_POSTMASTER_DEATH)
+			ereport(FATAL,
+					(errcode(ERRCODE_ADMIN_SHUTDOWN),
+					 errmsg("terminating connection due to unexpected postmaster exit")));
+
+		if (w->events & WL_LATCH_SET)
+		{
+			ResetLatch(MyLatch);
+			CHECK_FOR_INTERRUPTS();
+		}
+
+		if (w->events & WL_SOCKET_READABLE)
+		{
+			AsyncRequest *areq = (AsyncRequest *) w->user_data;
+
+			/*
+			 * The callback might already have been made while configuring
+			 * another subplan's wait, if the two share a connection.
+			 */
+			if (areq->callback_pending)
+			{
+				areq->callback_pending = false;
+				ExecAsyncNotify(areq);
+			}
+		}
+	}
+}
+
+/* ----------------------------------------------------------------
+ *		ExecAsyncAppendResponse
+ *
+ *		Receive a response from an asynchronous request we made.
+ * ----------------------------------------------------------------
+ */
+void
+ExecAsyncAppendResponse(AsyncRequest *areq)
+{
+	AppendState *node = (AppendState *) areq->requestor;
+	TupleTableSlot *slot = areq->result;
+
+	/* Ignore stragglers from before a rescan. */
+	if (!node->as_begun)
+		return;
+
+	/* Nothing to do if the request is pending. */
+	if (!areq->request_complete)
+	{
+		/* The request would have been pending for a callback. */
+		Assert(areq->callback_pending);
+		return;
+	}
+
+	/* If the result is NULL or an empty slot, the subplan is finished. */
+	if (TupIsNull(slot))
+	{
+		/* The ending subplan wouldn't have been pending for a callback. */
+		Assert(!areq->callback_pending);
+		--node->as_nasyncremain;
+		return;
+	}
+
+	/* Save result so we can return it. */
+	Assert(node->as_nasyncresults < node->as_nasyncplans);
+	node->as_asyncresults[node->as_nasyncresults++] = slot;
+
+	/*
+	 * Mark the subplan that returned a result as ready for a new request.
+	 * We don't launch another one here immediately because it might
+	 * complete, overwriting the slot we're about to return.
+	 */
+	node->as_needrequest = bms_add_member(node->as_needrequest,
+										  areq->request_index);
+}
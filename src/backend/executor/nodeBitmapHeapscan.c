@@ -831,6 +831,7 @@ ExecInitBitmapHeapScan(BitmapHeapScan *node, EState *estate, int eflags)
 		ExecInitQual(node->scan.plan.qual, (PlanState *) scanstate);
 	scanstate->bitmapqualorig =
 		ExecInitQual(node->bitmapqualorig, (PlanState *) scanstate);
+	scanstate->ss.ss_rtfilter = ExecInitScanRuntimeFilter(&scanstate->ss);
 
 	/*
 	 * tuple table initialization
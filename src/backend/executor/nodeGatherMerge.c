@@ -663,6 +663,11 @@ gather_merge_readnext(GatherMergeState *gm_state, int reader, bool nowait)
 								&tuple_buffer->done);
 		if (!HeapTupleIsValid(tup))
 			return false;
+
+		/*
+		 * The reader's tuple is only valid until we read from it again, which
+		 * load_tuple_array is about to do, so keep a copy.
+		 */
 		tup = heap_copytuple(tup);
 
 		/*
@@ -17,6 +17,11 @@
  *		MultiExecHash	- generate an in-memory hash table of the relation
  *		ExecInitHash	- initialize node and subnodes
  *		ExecEndHash		- shutdown node and subnodes
+ *
+ * A hash table may also be shared by all participants of a parallel query;
+ * see ParallelHashJoinState in hashjoin.h.  Those tables always have a
+ * single batch and no skew buckets, so exceeding their memory budget is an
+ * error rather than a reason to add batches.
  */
 
 #include "postgres.h"
@@ -31,7 +36,9 @@
 #include "executor/hashjoin.h"
 #include "executor/nodeHash.h"
 #include "executor/nodeHashjoin.h"
+#include "lib/bloomfilter.h"
 #include "miscadmin.h"
+#include "pgstat.h"
 #include "utils/dynahash.h"
 #include "utils/memutils.h"
 #include "utils/lsyscache.h"
@@ -51,6 +58,25 @@ static void ExecHashRemoveNextSkewBucket(HashJoinTable hashtable);
 
 static void *dense_alloc(HashJoinTable hashtable, Size size);
 
+static HashJoinTable ExecHashTableCreateInternal(Hash *node,
+							List *hashOperators,
+							bool keepNulls,
+							ParallelHashJoinState *pstate,
+							dsa_area *area);
+static void MultiExecParallelHash(HashState *node);
+static void ExecHashTableInsertInternal(HashJoinTable hashtable,
+							TupleTableSlot *slot,
+							uint32 hashvalue,
+							bool defer);
+static void ExecParallelHashTableInsert(HashJoinTable hashtable,
+							TupleTableSlot *slot,
+							uint32 hashvalue);
+static HashJoinTuple ExecParallelHashTupleAlloc(HashJoinTable hashtable,
+						   Size size, dsa_pointer *shared);
+static void ExecParallelHashIncreaseNumBuckets(HashJoinTable hashtable);
+static bool ExecParallelScanHashBucket(HashJoinState *hjstate,
+						   ExprContext *econtext);
+
 /* ----------------------------------------------------------------
  *		ExecHash
  *
@@ -97,6 +123,18 @@ MultiExecHash(HashState *node)
 	hashkeys = node->hashkeys;
 	econtext = node->ps.ps_ExprContext;
 
+	/*
+	 * A shared table is built together with the other participants
+	 */
+	if (hashtable->parallel_state != NULL)
+	{
+		MultiExecParallelHash(node);
+
+		if (node->ps.instrument)
+			InstrStopNode(node->ps.instrument, hashtable->totalTuples);
+		return NULL;
+	}
+
 	/*
 	 * get all inner tuples and insert into the hash table (or temp files)
 	 */
@@ -124,11 +162,12 @@ MultiExecHash(HashState *node)
 			else
 			{
 				/* Not subject to skew optimization, so insert normally */
-				ExecHashTableInsert(hashtable, slot, hashvalue);
+				ExecHashTableInsertDeferred(hashtable, slot, hashvalue);
 			}
 			hashtable->totalTuples += 1;
 		}
 	}
+	ExecHashTableFlushInserts(hashtable);
 
 	/* resize the hash table if needed (NTUP_PER_BUCKET exceeded) */
 	if (hashtable->nbuckets != hashtable->nbuckets_optimal)
@@ -176,6 +215,7 @@ ExecInitHash(Hash *node, EState *estate, int eflags)
 	hashstate->ps.ExecProcNode = ExecHash;
 	hashstate->hashtable = NULL;
 	hashstate->hashkeys = NIL;	/* will be set by parent HashJoin */
+	hashstate->parallel_state = NULL;	/* set by parent's DSM callbacks */
 
 	/*
 	 * Miscellaneous initialization
@@ -242,6 +282,34 @@ ExecEndHash(HashState *node)
  */
 HashJoinTable
 ExecHashTableCreate(Hash *node, List *hashOperators, bool keepNulls)
+{
+	return ExecHashTableCreateInternal(node, hashOperators, keepNulls,
+									   NULL, NULL);
+}
+
+/* ----------------------------------------------------------------
+ *		ExecParallelHashTableCreate
+ *
+ *		create the local control block for a hash table shared through
+ *		the given HashState's parallel_state.  The buckets and tuples
+ *		themselves live in the query's DSA area.
+ * ----------------------------------------------------------------
+ */
+HashJoinTable
+ExecParallelHashTableCreate(HashState *state, List *hashOperators,
+							bool keepNulls)
+{
+	Assert(state->parallel_state != NULL);
+	Assert(state->ps.state->es_query_dsa != NULL);
+
+	return ExecHashTableCreateInternal((Hash *) state->ps.plan, hashOperators,
+									   keepNulls, state->parallel_state,
+									   state->ps.state->es_query_dsa);
+}
+
+static HashJoinTable
+ExecHashTableCreateInternal(Hash *node, List *hashOperators, bool keepNulls,
+							ParallelHashJoinState *pstate, dsa_area *area)
 {
 	HashJoinTable hashtable;
 	Plan	   *outerNode;
@@ -265,6 +333,16 @@ ExecHashTableCreate(Hash *node, List *hashOperators, bool keepNulls)
 							OidIsValid(node->skewTable),
 							&nbuckets, &nbatch, &num_skew_mcvs);
 
+	/*
+	 * A shared table keeps everything in one batch; its real bucket count is
+	 * only known once the build is over, see MultiExecParallelHash.
+	 */
+	if (pstate != NULL)
+	{
+		nbatch = 1;
+		num_skew_mcvs = 0;
+	}
+
 	/* nbuckets must be a power of 2 */
 	log2_nbuckets = my_log2(nbuckets);
 	Assert(nbuckets == (1 << log2_nbuckets));
@@ -304,7 +382,14 @@ ExecHashTableCreate(Hash *node, List *hashOperators, bool keepNulls)
 	hashtable->spaceAllowedSkew =
 		hashtable->spaceAllowed * SKEW_WORK_MEM_PERCENT / 100;
 	hashtable->chunks = NULL;
+	hashtable->npending = 0;
     hashtable->needMaintain = true;
+	hashtable->parallel_state = pstate;
+	hashtable->area = area;
+	hashtable->shared_buckets = NULL;
+	hashtable->current_chunk_dp = InvalidDsaPointer;
+	if (pstate != NULL)
+		hashtable->growEnabled = false;
 
 #ifdef HJDEBUG
 	printf("Hashjoin %p: initial nbatch = %d, nbuckets = %d\n",
@@ -373,8 +458,9 @@ ExecHashTableCreate(Hash *node, List *hashOperators, bool keepNulls)
 	 */
 	MemoryContextSwitchTo(hashtable->batchCxt);
 
-	hashtable->buckets = (HashJoinTuple *)
-		palloc0(nbuckets * sizeof(HashJoinTuple));
+	if (pstate == NULL)
+		hashtable->buckets = (HashJoinTuple *)
+			palloc0(nbuckets * sizeof(HashJoinTuple));
 
 	/*
 	 * Set up for skew optimization, if possible and there's a need for more
@@ -672,10 +758,13 @@ ExecHashIncreaseNumBatches(HashJoinTable hashtable)
 	oldchunks = hashtable->chunks;
 	hashtable->chunks = NULL;
 
+	/* deferred inserts are in the old chunks, so they're handled below */
+	hashtable->npending = 0;
+
 	/* so, let's scan through the old chunks, and all tuples in each chunk */
 	while (oldchunks != NULL)
 	{
-		HashMemoryChunk nextchunk = oldchunks->next;
+		HashMemoryChunk nextchunk = oldchunks->next.unshared;
 
 		/* position within the buffer (up to oldchunks->used) */
 		size_t		idx = 0;
@@ -702,7 +791,7 @@ ExecHashIncreaseNumBatches(HashJoinTable hashtable)
 				memcpy(copyTuple, hashTuple, hashTupleSize);
 
 				/* and add it back to the appropriate bucket */
-				copyTuple->next = hashtable->buckets[bucketno];
+				copyTuple->next.unshared = hashtable->buckets[bucketno];
 				hashtable->buckets[bucketno] = copyTuple;
 			}
 			else
@@ -790,8 +879,11 @@ ExecHashIncreaseNumBuckets(HashJoinTable hashtable)
 
 	memset(hashtable->buckets, 0, hashtable->nbuckets * sizeof(HashJoinTuple));
 
+	/* deferred inserts are in the chunks, so they're linked below too */
+	hashtable->npending = 0;
+
 	/* scan through all tuples in all chunks to rebuild the hash table */
-	for (chunk = hashtable->chunks; chunk != NULL; chunk = chunk->next)
+	for (chunk = hashtable->chunks; chunk != NULL; chunk = chunk->next.unshared)
 	{
 		/* process all tuples stored in this chunk */
 		size_t		idx = 0;
@@ -806,7 +898,7 @@ ExecHashIncreaseNumBuckets(HashJoinTable hashtable)
 									  &bucketno, &batchno);
 
 			/* add the tuple to the proper bucket */
-			hashTuple->next = hashtable->buckets[bucketno];
+			hashTuple->next.unshared = hashtable->buckets[bucketno];
 			hashtable->buckets[bucketno] = hashTuple;
 
 			/* advance index past the tuple */
@@ -835,6 +927,53 @@ void
 ExecHashTableInsert(HashJoinTable hashtable,
 					TupleTableSlot *slot,
 					uint32 hashvalue)
+{
+	ExecHashTableInsertInternal(hashtable, slot, hashvalue, false);
+}
+
+/*
+ * ExecHashTableInsertDeferred
+ *		like ExecHashTableInsert, but the tuple may not be linked into its
+ *		bucket until the next ExecHashTableFlushInserts
+ *
+ * Linking is done HJ_INSERT_BATCH_SIZE tuples at a time, with the bucket
+ * heads prefetched in between.  The table must not be probed until the
+ * caller has flushed.
+ */
+void
+ExecHashTableInsertDeferred(HashJoinTable hashtable,
+							TupleTableSlot *slot,
+							uint32 hashvalue)
+{
+	ExecHashTableInsertInternal(hashtable, slot, hashvalue, true);
+}
+
+/*
+ * ExecHashTableFlushInserts
+ *		link all tuples added by ExecHashTableInsertDeferred into their
+ *		buckets
+ */
+void
+ExecHashTableFlushInserts(HashJoinTable hashtable)
+{
+	int			i;
+
+	for (i = 0; i < hashtable->npending; i++)
+	{
+		HashJoinTuple hashTuple = hashtable->pendingTuples[i];
+		int			bucketno = hashtable->pendingBuckets[i];
+
+		hashTuple->next.unshared = hashtable->buckets[bucketno];
+		hashtable->buckets[bucketno] = hashTuple;
+	}
+	hashtable->npending = 0;
+}
+
+static void
+ExecHashTableInsertInternal(HashJoinTable hashtable,
+							TupleTableSlot *slot,
+							uint32 hashvalue,
+							bool defer)
 {
 	MinimalTuple tuple = ExecFetchSlotMinimalTuple(slot);
 	int			bucketno;
@@ -873,9 +1012,25 @@ ExecHashTableInsert(HashJoinTable hashtable,
 		 */
 		HeapTupleHeaderClearMatch(HJTUPLE_MINTUPLE(hashTuple));
 
-		/* Push it onto the front of the bucket's list */
-		hashTuple->next = hashtable->buckets[bucketno];
-		hashtable->buckets[bucketno] = hashTuple;
+		/*
+		 * Push it onto the front of the bucket's list, or remember to do so
+		 * once the bucket head is in cache.  Any rebuild of the buckets
+		 * below will take care of the pending tuples as well, since it works
+		 * from the chunks.
+		 */
+		if (defer)
+		{
+			hashtable->pendingTuples[hashtable->npending] = hashTuple;
+			hashtable->pendingBuckets[hashtable->npending] = bucketno;
+			pg_prefetch_mem(&hashtable->buckets[bucketno]);
+			if (++hashtable->npending == HJ_INSERT_BATCH_SIZE)
+				ExecHashTableFlushInserts(hashtable);
+		}
+		else
+		{
+			hashTuple->next.unshared = hashtable->buckets[bucketno];
+			hashtable->buckets[bucketno] = hashTuple;
+		}
 
 		/*
 		 * Increase the (optimal) number of buckets if we just exceeded the
@@ -1076,6 +1231,9 @@ ExecScanHashBucket(HashJoinState *hjstate,
 	HashJoinTuple hashTuple = hjstate->hj_CurTuple;
 	uint32		hashvalue = hjstate->hj_CurHashValue;
 
+	if (hashtable->parallel_state != NULL)
+		return ExecParallelScanHashBucket(hjstate, econtext);
+
 	/*
 	 * hj_CurTuple is the address of the tuple last returned from the current
 	 * bucket, or NULL if it's time to start scanning a new bucket.
@@ -1084,7 +1242,7 @@ ExecScanHashBucket(HashJoinState *hjstate,
 	 * otherwise scan the standard hashtable bucket.
 	 */
 	if (hashTuple != NULL)
-		hashTuple = hashTuple->next;
+		hashTuple = hashTuple->next.unshared;
 	else if (hjstate->hj_CurSkewBucketNo != INVALID_SKEW_BUCKET_NO)
 		hashTuple = hashtable->skewBucket[hjstate->hj_CurSkewBucketNo]->tuples;
 	else
@@ -1112,7 +1270,7 @@ ExecScanHashBucket(HashJoinState *hjstate,
 			}
 		}
 
-		hashTuple = hashTuple->next;
+		hashTuple = hashTuple->next.unshared;
 	}
 
 	/*
@@ -1136,6 +1294,9 @@ ExecPrepHashTableForUnmatched(HashJoinState *hjstate)
 	 * hj_CurTuple: last tuple returned, or NULL to start next bucket
 	 *----------
 	 */
+	/* right and full joins never use a shared table, see joinpath.c */
+	Assert(hjstate->hj_HashTable->parallel_state == NULL);
+
 	hjstate->hj_CurBucketNo = 0;
 	hjstate->hj_CurSkewBucketNo = 0;
 	hjstate->hj_CurTuple = NULL;
@@ -1163,7 +1324,7 @@ ExecScanHashTableForUnmatched(HashJoinState *hjstate, ExprContext *econtext)
 		 * bucket.
 		 */
 		if (hashTuple != NULL)
-			hashTuple = hashTuple->next;
+			hashTuple = hashTuple->next.unshared;
 		else if (hjstate->hj_CurBucketNo < hashtable->nbuckets)
 		{
 			hashTuple = hashtable->buckets[hjstate->hj_CurBucketNo];
@@ -1202,7 +1363,7 @@ ExecScanHashTableForUnmatched(HashJoinState *hjstate, ExprContext *econtext)
 				return true;
 			}
 
-			hashTuple = hashTuple->next;
+			hashTuple = hashTuple->next.unshared;
 		}
 
 		/* allow this loop to be cancellable */
@@ -1243,6 +1404,7 @@ ExecHashTableReset(HashJoinTable hashtable)
 
 	/* Forget the chunks (the memory was freed by the context reset above). */
 	hashtable->chunks = NULL;
+	hashtable->npending = 0;
 }
 
 /*
@@ -1258,7 +1420,7 @@ ExecHashTableResetMatchFlags(HashJoinTable hashtable)
 	/* Reset all flags in the main table ... */
 	for (i = 0; i < hashtable->nbuckets; i++)
 	{
-		for (tuple = hashtable->buckets[i]; tuple != NULL; tuple = tuple->next)
+		for (tuple = hashtable->buckets[i]; tuple != NULL; tuple = tuple->next.unshared)
 			HeapTupleHeaderClearMatch(HJTUPLE_MINTUPLE(tuple));
 	}
 
@@ -1268,11 +1430,85 @@ ExecHashTableResetMatchFlags(HashJoinTable hashtable)
 		int			j = hashtable->skewBucketNums[i];
 		HashSkewBucket *skewBucket = hashtable->skewBucket[j];
 
-		for (tuple = skewBucket->tuples; tuple != NULL; tuple = tuple->next)
+		for (tuple = skewBucket->tuples; tuple != NULL; tuple = tuple->next.unshared)
 			HeapTupleHeaderClearMatch(HJTUPLE_MINTUPLE(tuple));
 	}
 }
 
+/*
+ * ExecHashBuildBloomFilter
+ *		Summarize the hash values of all tuples in the table in a Bloom filter
+ *
+ * The table must be completely built and have a single batch, else the
+ * filter would miss tuples.  The filter is allocated in the table's hashCxt
+ * and so goes away with it.
+ */
+bloom_filter *
+ExecHashBuildBloomFilter(HashJoinTable hashtable)
+{
+	bloom_filter *filter;
+	MemoryContext oldcxt;
+	int			i;
+
+	Assert(hashtable->nbatch == 1);
+
+	oldcxt = MemoryContextSwitchTo(hashtable->hashCxt);
+	filter = bloom_create((int64) hashtable->totalTuples, work_mem, 0);
+	MemoryContextSwitchTo(oldcxt);
+
+	if (hashtable->parallel_state != NULL)
+	{
+		ParallelHashJoinState *pstate = hashtable->parallel_state;
+		dsa_pointer chunk_dp;
+
+		/* everyone's done inserting, so the chunk list is stable */
+		for (chunk_dp = pstate->chunks; DsaPointerIsValid(chunk_dp);)
+		{
+			HashMemoryChunk chunk;
+			size_t		idx = 0;
+
+			chunk = (HashMemoryChunk) dsa_get_address(hashtable->area, chunk_dp);
+			while (idx < chunk->used)
+			{
+				HashJoinTuple hashTuple = (HashJoinTuple) (chunk->data + idx);
+
+				bloom_add_element(filter, (unsigned char *) &hashTuple->hashvalue,
+								  sizeof(uint32));
+				idx += MAXALIGN(HJTUPLE_OVERHEAD +
+								HJTUPLE_MINTUPLE(hashTuple)->t_len);
+			}
+			chunk_dp = chunk->next.shared;
+
+			CHECK_FOR_INTERRUPTS();
+		}
+	}
+	else
+	{
+		HashJoinTuple tuple;
+
+		/* Walk the main table ... */
+		for (i = 0; i < hashtable->nbuckets; i++)
+		{
+			for (tuple = hashtable->buckets[i]; tuple != NULL; tuple = tuple->next.unshared)
+				bloom_add_element(filter, (unsigned char *) &tuple->hashvalue,
+								  sizeof(uint32));
+		}
+
+		/* ... and the skew buckets, if any */
+		for (i = 0; i < hashtable->nSkewBuckets; i++)
+		{
+			int			j = hashtable->skewBucketNums[i];
+			HashSkewBucket *skewBucket = hashtable->skewBucket[j];
+
+			for (tuple = skewBucket->tuples; tuple != NULL; tuple = tuple->next.unshared)
+				bloom_add_element(filter, (unsigned char *) &tuple->hashvalue,
+								  sizeof(uint32));
+		}
+	}
+
+	return filter;
+}
+
 
 void
 ExecReScanHash(HashState *node)
@@ -1513,7 +1749,7 @@ ExecHashSkewTableInsert(HashJoinTable hashtable,
 	HeapTupleHeaderClearMatch(HJTUPLE_MINTUPLE(hashTuple));
 
 	/* Push it onto the front of the skew bucket's list */
-	hashTuple->next = hashtable->skewBucket[bucketNumber]->tuples;
+	hashTuple->next.unshared = hashtable->skewBucket[bucketNumber]->tuples;
 	hashtable->skewBucket[bucketNumber]->tuples = hashTuple;
 
 	/* Account for space used, and back off if we've used too much */
@@ -1562,7 +1798,7 @@ ExecHashRemoveNextSkewBucket(HashJoinTable hashtable)
 	hashTuple = bucket->tuples;
 	while (hashTuple != NULL)
 	{
-		HashJoinTuple nextHashTuple = hashTuple->next;
+		HashJoinTuple nextHashTuple = hashTuple->next.unshared;
 		MinimalTuple tuple;
 		Size		tupleSize;
 
@@ -1588,7 +1824,7 @@ ExecHashRemoveNextSkewBucket(HashJoinTable hashtable)
 			memcpy(copyTuple, hashTuple, tupleSize);
 			pfree(hashTuple);
 
-			copyTuple->next = hashtable->buckets[bucketno];
+			copyTuple->next.unshared = hashtable->buckets[bucketno];
 			hashtable->buckets[bucketno] = copyTuple;
 
 			/* We have reduced skew space, but overall space doesn't change */
@@ -1676,12 +1912,12 @@ dense_alloc(HashJoinTable hashtable, Size size)
 		 */
 		if (hashtable->chunks != NULL)
 		{
-			newChunk->next = hashtable->chunks->next;
-			hashtable->chunks->next = newChunk;
+			newChunk->next.unshared = hashtable->chunks->next.unshared;
+			hashtable->chunks->next.unshared = newChunk;
 		}
 		else
 		{
-			newChunk->next = hashtable->chunks;
+			newChunk->next.unshared = hashtable->chunks;
 			hashtable->chunks = newChunk;
 		}
 
@@ -1706,7 +1942,7 @@ dense_alloc(HashJoinTable hashtable, Size size)
 		newChunk->used = size;
 		newChunk->ntuples = 1;
 
-		newChunk->next = hashtable->chunks;
+		newChunk->next.unshared = hashtable->chunks;
 		hashtable->chunks = newChunk;
 
 		return newChunk->data;
@@ -1783,3 +2019,427 @@ ExecEstimateHashTableSize(double ntuples, int tupwidth)
     return (int)(inner_rel_bytes + bucket_bytes); 
 }
 
+/* ----------------------------------------------------------------
+ *		Shared hash tables
+ * ----------------------------------------------------------------
+ */
+
+/*
+ * MultiExecParallelHash
+ *		help build a shared hash table, then wait until it is complete
+ *
+ * We only join the build if it is still running.  Anyone arriving later
+ * would find the partial inner plan exhausted anyway, since the build only
+ * ends when every participant that took a share of it has finished.
+ */
+static void
+MultiExecParallelHash(HashState *node)
+{
+	ParallelHashJoinState *pstate = node->parallel_state;
+	HashJoinTable hashtable = node->hashtable;
+	PlanState  *outerNode = outerPlanState(node);
+	List	   *hashkeys = node->hashkeys;
+	ExprContext *econtext = node->ps.ps_ExprContext;
+	TupleTableSlot *slot;
+	uint32		hashvalue;
+	double		ntuples = 0;
+	bool		building;
+	bool		last = false;
+
+	SpinLockAcquire(&pstate->mutex);
+	building = (pstate->phase == PHJ_BUILD_HASHING);
+	if (building)
+	{
+		pstate->nbuilding++;
+		hashtable->nbuckets = pstate->nbuckets;
+		hashtable->log2_nbuckets = pstate->log2_nbuckets;
+	}
+	SpinLockRelease(&pstate->mutex);
+
+	if (building)
+	{
+		hashtable->shared_buckets = (dsa_pointer_atomic *)
+			dsa_get_address(hashtable->area, pstate->buckets);
+
+		for (;;)
+		{
+			slot = ExecProcNode(outerNode);
+			if (TupIsNull(slot))
+				break;
+			econtext->ecxt_innertuple = slot;
+			if (ExecHashGetHashValue(hashtable, econtext, hashkeys,
+									 false, hashtable->keepNulls,
+									 &hashvalue))
+			{
+				ExecParallelHashTableInsert(hashtable, slot, hashvalue);
+				ntuples += 1;
+			}
+		}
+
+		SpinLockAcquire(&pstate->mutex);
+		pstate->ntuples += ntuples;
+		pstate->size += hashtable->spaceUsed;
+		if (--pstate->nbuilding == 0)
+		{
+			/* keep latecomers out while we fix up the buckets */
+			pstate->phase = PHJ_BUILD_GROWING;
+			last = true;
+		}
+		SpinLockRelease(&pstate->mutex);
+		hashtable->current_chunk_dp = InvalidDsaPointer;
+		hashtable->chunks = NULL;
+
+		if (last)
+		{
+			/* everyone else is done, so we have the table to ourselves */
+			ExecParallelHashIncreaseNumBuckets(hashtable);
+
+			SpinLockAcquire(&pstate->mutex);
+			pstate->phase = PHJ_BUILD_DONE;
+			SpinLockRelease(&pstate->mutex);
+			ConditionVariableBroadcast(&pstate->build_cv);
+		}
+	}
+
+	/* Wait for the others */
+	ConditionVariablePrepareToSleep(&pstate->build_cv);
+	for (;;)
+	{
+		bool		done;
+
+		SpinLockAcquire(&pstate->mutex);
+		done = (pstate->phase == PHJ_BUILD_DONE);
+		SpinLockRelease(&pstate->mutex);
+		if (done)
+			break;
+		ConditionVariableSleep(&pstate->build_cv, WAIT_EVENT_HASH_BUILD);
+	}
+	ConditionVariableCancelSleep();
+
+	/* The table is read-only from now on; pick up its final shape */
+	SpinLockAcquire(&pstate->mutex);
+	hashtable->nbuckets = pstate->nbuckets;
+	hashtable->log2_nbuckets = pstate->log2_nbuckets;
+	hashtable->nbuckets_optimal = pstate->nbuckets;
+	hashtable->log2_nbuckets_optimal = pstate->log2_nbuckets;
+	hashtable->totalTuples = pstate->ntuples;
+	hashtable->spaceUsed = pstate->size +
+		pstate->nbuckets * sizeof(dsa_pointer_atomic);
+	SpinLockRelease(&pstate->mutex);
+	hashtable->spacePeak = Max(hashtable->spacePeak, hashtable->spaceUsed);
+	hashtable->shared_buckets = (dsa_pointer_atomic *)
+		dsa_get_address(hashtable->area, pstate->buckets);
+}
+
+/*
+ * ExecParallelHashTableInsert
+ *		insert a tuple into a shared hash table
+ *
+ * Several processes may push onto the same bucket at once, so the bucket
+ * head is swapped in atomically.  Nobody reads the buckets until the build
+ * is done.
+ */
+static void
+ExecParallelHashTableInsert(HashJoinTable hashtable,
+							TupleTableSlot *slot,
+							uint32 hashvalue)
+{
+	MinimalTuple tuple = ExecFetchSlotMinimalTuple(slot);
+	dsa_pointer_atomic *bucket;
+	HashJoinTuple hashTuple;
+	dsa_pointer shared;
+	int			bucketno;
+	int			batchno;
+
+	ExecHashGetBucketAndBatch(hashtable, hashvalue, &bucketno, &batchno);
+	Assert(batchno == 0);
+
+	hashTuple = ExecParallelHashTupleAlloc(hashtable,
+										   HJTUPLE_OVERHEAD + tuple->t_len,
+										   &shared);
+	hashTuple->delta = TupIsDelta(slot);
+	hashTuple->hashvalue = hashvalue;
+	memcpy(HJTUPLE_MINTUPLE(hashTuple), tuple, tuple->t_len);
+	HeapTupleHeaderClearMatch(HJTUPLE_MINTUPLE(hashTuple));
+
+	bucket = &hashtable->shared_buckets[bucketno];
+	hashTuple->next.shared = dsa_pointer_atomic_read(bucket);
+	while (!dsa_pointer_atomic_compare_exchange(bucket,
+												&hashTuple->next.shared,
+												shared))
+		;
+
+	hashtable->spaceUsed += MAXALIGN(HJTUPLE_OVERHEAD + tuple->t_len);
+}
+
+/*
+ * ExecParallelHashTupleAlloc
+ *		allocate 'size' bytes for a tuple of a shared hash table
+ *
+ * Like dense_alloc, but the chunks come from the DSA area and each process
+ * fills its own.  Every chunk is put on the shared list so that the whole
+ * table can be walked later.  Returns the local address; *shared receives
+ * the dsa_pointer to the same memory.
+ *
+ * This is also where the table's memory budget is enforced.  We have no way
+ * to spill a shared table to batch files, so if the planner's estimate was
+ * too low by more than the budget allows for, the query fails.
+ */
+static HashJoinTuple
+ExecParallelHashTupleAlloc(HashJoinTable hashtable, Size size,
+						   dsa_pointer *shared)
+{
+	ParallelHashJoinState *pstate = hashtable->parallel_state;
+	HashMemoryChunk chunk = hashtable->chunks;
+	dsa_pointer chunk_dp;
+	Size		chunk_size;
+	HashJoinTuple result;
+	bool		overflow;
+
+	/* just in case the size is not already aligned properly */
+	size = MAXALIGN(size);
+
+	/* Room left in the chunk we are filling? */
+	if (chunk != NULL && chunk->maxlen - chunk->used >= size)
+	{
+		*shared = hashtable->current_chunk_dp +
+			offsetof(HashMemoryChunkData, data) + chunk->used;
+		result = (HashJoinTuple) (chunk->data + chunk->used);
+		chunk->used += size;
+		chunk->ntuples += 1;
+		return result;
+	}
+
+	/* Big tuples get a chunk of their own, like in dense_alloc */
+	chunk_size = (size > HASH_CHUNK_THRESHOLD) ? size : HASH_CHUNK_SIZE;
+	chunk_dp = dsa_allocate(hashtable->area,
+							offsetof(HashMemoryChunkData, data) + chunk_size);
+	chunk = (HashMemoryChunk) dsa_get_address(hashtable->area, chunk_dp);
+	chunk->maxlen = chunk_size;
+	chunk->used = size;
+	chunk->ntuples = 1;
+
+	SpinLockAcquire(&pstate->mutex);
+	chunk->next.shared = pstate->chunks;
+	pstate->chunks = chunk_dp;
+	pstate->space_used += offsetof(HashMemoryChunkData, data) + chunk_size;
+	overflow = (pstate->space_used > pstate->space_allowed);
+	SpinLockRelease(&pstate->mutex);
+
+	if (overflow)
+		ereport(ERROR,
+				(errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+				 errmsg("shared hash table exceeded its memory limit of %ld kB",
+						(long) (pstate->space_allowed / 1024L)),
+				 errdetail("A parallel hash join cannot split its shared hash table into batches."),
+				 errhint("Run ANALYZE on the tables involved, increase work_mem, or turn off enable_parallel_hash.")));
+
+	if (chunk_size == HASH_CHUNK_SIZE)
+	{
+		hashtable->chunks = chunk;
+		hashtable->current_chunk_dp = chunk_dp;
+	}
+
+	*shared = chunk_dp + offsetof(HashMemoryChunkData, data);
+	return (HashJoinTuple) chunk->data;
+}
+
+/*
+ * ExecParallelHashIncreaseNumBuckets
+ *		grow the bucket array of a shared table whose estimate was too low
+ *
+ * Called by the last participant to finish the build, while all others
+ * wait, so nothing here needs to be atomic.
+ */
+static void
+ExecParallelHashIncreaseNumBuckets(HashJoinTable hashtable)
+{
+	ParallelHashJoinState *pstate = hashtable->parallel_state;
+	dsa_pointer_atomic *buckets;
+	dsa_pointer chunk_dp;
+	double		dbuckets;
+	int			nbuckets;
+	int			i;
+
+	dbuckets = ceil(pstate->ntuples / NTUP_PER_BUCKET);
+	if (dbuckets <= pstate->nbuckets)
+		return;
+	dbuckets = Min(dbuckets, INT_MAX / 2);
+	dbuckets = Min(dbuckets, MaxAllocHugeSize / sizeof(dsa_pointer_atomic));
+	nbuckets = 1 << my_log2((long) dbuckets);
+
+#ifdef HJDEBUG
+	printf("Hashjoin %p: increasing shared nbuckets %d => %d\n",
+		   hashtable, pstate->nbuckets, nbuckets);
+#endif
+
+	dsa_free(hashtable->area, pstate->buckets);
+	pstate->buckets = dsa_allocate_extended(hashtable->area,
+											nbuckets * sizeof(dsa_pointer_atomic),
+											DSA_ALLOC_HUGE);
+	buckets = (dsa_pointer_atomic *)
+		dsa_get_address(hashtable->area, pstate->buckets);
+	for (i = 0; i < nbuckets; i++)
+		dsa_pointer_atomic_init(&buckets[i], InvalidDsaPointer);
+
+	/* walk all chunks and put every tuple into its new bucket */
+	for (chunk_dp = pstate->chunks; DsaPointerIsValid(chunk_dp);)
+	{
+		HashMemoryChunk chunk;
+		size_t		idx = 0;
+
+		chunk = (HashMemoryChunk) dsa_get_address(hashtable->area, chunk_dp);
+		while (idx < chunk->used)
+		{
+			HashJoinTuple hashTuple = (HashJoinTuple) (chunk->data + idx);
+			int			bucketno = hashTuple->hashvalue & (nbuckets - 1);
+
+			hashTuple->next.shared = dsa_pointer_atomic_read(&buckets[bucketno]);
+			dsa_pointer_atomic_write(&buckets[bucketno],
+									 chunk_dp + offsetof(HashMemoryChunkData, data) + idx);
+
+			idx += MAXALIGN(HJTUPLE_OVERHEAD +
+							HJTUPLE_MINTUPLE(hashTuple)->t_len);
+		}
+		chunk_dp = chunk->next.shared;
+
+		/* allow this loop to be cancellable */
+		CHECK_FOR_INTERRUPTS();
+	}
+
+	pstate->nbuckets = nbuckets;
+	pstate->log2_nbuckets = my_log2(nbuckets);
+}
+
+/*
+ * ExecParallelScanHashBucket
+ *		ExecScanHashBucket for a shared table
+ */
+static bool
+ExecParallelScanHashBucket(HashJoinState *hjstate,
+						   ExprContext *econtext)
+{
+	ExprState  *hjclauses = hjstate->hashclauses;
+	HashJoinTable hashtable = hjstate->hj_HashTable;
+	HashJoinTuple hashTuple = hjstate->hj_CurTuple;
+	uint32		hashvalue = hjstate->hj_CurHashValue;
+	dsa_pointer shared;
+
+	/* there are no skew buckets in a shared table */
+	Assert(hjstate->hj_CurSkewBucketNo == INVALID_SKEW_BUCKET_NO);
+
+	if (hashTuple != NULL)
+		shared = hashTuple->next.shared;
+	else
+		shared = dsa_pointer_atomic_read(&hashtable->shared_buckets[hjstate->hj_CurBucketNo]);
+
+	while (DsaPointerIsValid(shared))
+	{
+		hashTuple = (HashJoinTuple) dsa_get_address(hashtable->area, shared);
+
+		if (hashTuple->hashvalue == hashvalue)
+		{
+			TupleTableSlot *inntuple;
+
+			/* insert hashtable's tuple into exec slot so ExecQual sees it */
+			inntuple = ExecStoreMinimalTuple(HJTUPLE_MINTUPLE(hashTuple),
+											 hjstate->hj_HashTupleSlot,
+											 false);	/* do not pfree */
+			econtext->ecxt_innertuple = inntuple;
+
+			/* reset temp memory each time to avoid leaks from qual expr */
+			ResetExprContext(econtext);
+
+			if (ExecQual(hjclauses, econtext))
+			{
+				hjstate->hj_CurTuple = hashTuple;
+				return true;
+			}
+		}
+
+		shared = hashTuple->next.shared;
+	}
+
+	/*
+	 * no match
+	 */
+	return false;
+}
+
+/*
+ * ExecParallelHashTableInitialize
+ *		set up the shared state of a hash table for a parallel query
+ *
+ * 'ntuples' and 'tupwidth' estimate the whole inner relation, which is
+ * what the initial bucket count is sized for.  'space_allowed' is the most
+ * memory the table may take, in bytes.
+ */
+void
+ExecParallelHashTableInitialize(ParallelHashJoinState *pstate, dsa_area *area,
+								double ntuples, int tupwidth,
+								Size space_allowed)
+{
+	dsa_pointer_atomic *buckets;
+	int			nbuckets;
+	int			nbatch;
+	int			num_skew_mcvs;
+	int			i;
+
+	ExecChooseHashTableSize(ntuples, tupwidth, false,
+							&nbuckets, &nbatch, &num_skew_mcvs);
+
+	SpinLockInit(&pstate->mutex);
+	pstate->phase = PHJ_BUILD_HASHING;
+	pstate->nbuilding = 0;
+	pstate->nbuckets = nbuckets;
+	pstate->log2_nbuckets = my_log2(nbuckets);
+	pstate->buckets = dsa_allocate_extended(area,
+											nbuckets * sizeof(dsa_pointer_atomic),
+											DSA_ALLOC_HUGE);
+	buckets = (dsa_pointer_atomic *) dsa_get_address(area, pstate->buckets);
+	for (i = 0; i < nbuckets; i++)
+		dsa_pointer_atomic_init(&buckets[i], InvalidDsaPointer);
+	pstate->chunks = InvalidDsaPointer;
+	pstate->ntuples = 0;
+	pstate->size = 0;
+	pstate->space_used = nbuckets * sizeof(dsa_pointer_atomic);
+	pstate->space_allowed = space_allowed;
+	ConditionVariableInit(&pstate->build_cv);
+}
+
+/*
+ * ExecParallelHashTableReset
+ *		forget the contents of a shared hash table so it can be built again
+ *
+ * Only called by the leader, before workers are launched for a rescan.
+ */
+void
+ExecParallelHashTableReset(ParallelHashJoinState *pstate, dsa_area *area)
+{
+	dsa_pointer_atomic *buckets;
+	dsa_pointer chunk_dp;
+	int			i;
+
+	chunk_dp = pstate->chunks;
+	while (DsaPointerIsValid(chunk_dp))
+	{
+		HashMemoryChunk chunk;
+		dsa_pointer next;
+
+		chunk = (HashMemoryChunk) dsa_get_address(area, chunk_dp);
+		next = chunk->next.shared;
+		dsa_free(area, chunk_dp);
+		chunk_dp = next;
+	}
+
+	buckets = (dsa_pointer_atomic *) dsa_get_address(area, pstate->buckets);
+	for (i = 0; i < pstate->nbuckets; i++)
+		dsa_pointer_atomic_write(&buckets[i], InvalidDsaPointer);
+
+	pstate->phase = PHJ_BUILD_HASHING;
+	pstate->nbuilding = 0;
+	pstate->chunks = InvalidDsaPointer;
+	pstate->ntuples = 0;
+	pstate->size = 0;
+	pstate->space_used = pstate->nbuckets * sizeof(dsa_pointer_atomic);
+}
@@ -10,6 +10,16 @@
  * IDENTIFICATION
  *	  src/backend/executor/nodeHashjoin.c
  *
+ * PARALLELISM
+ *
+ * A parallel-aware hash join (planned only for a partial inner path whose
+ * whole output is expected to fit in one batch) shares a single hash table
+ * among all participants; see ParallelHashJoinState.  The DSM callbacks
+ * below hand the shared state down to the Hash child.  Without a DSA area,
+ * e.g. when the Gather ran without parallel mode, each process falls back to
+ * a private table built from whatever its inner plan returns, which is then
+ * the whole relation.
+ *
  *-------------------------------------------------------------------------
  */
 
@@ -21,6 +31,7 @@
 #include "executor/nodeHash.h"
 #include "executor/nodeHashjoin.h"
 #include "miscadmin.h"
+#include "nodes/nodeFuncs.h"
 #include "utils/memutils.h"
 
 /*
@@ -39,6 +50,14 @@
 #define HJ_FILL_INNER_TUPLES	5
 #define HJ_NEED_NEW_BATCH		6
 
+/*
+ * Outer tuples are probed HJ_PROBE_BATCH_SIZE at a time once the hash table
+ * has at least HJ_PROBE_MIN_BUCKETS buckets, which is about when the bucket
+ * array stops fitting in the CPU's caches.
+ */
+#define HJ_PROBE_BATCH_SIZE		16
+#define HJ_PROBE_MIN_BUCKETS	(1 << 16)
+
 /* Returns true if doing null-fill on outer relation */
 #define HJ_FILL_OUTER(hjstate)	((hjstate)->hj_NullInnerTupleSlot != NULL)
 /* Returns true if doing null-fill on inner relation */
@@ -51,7 +70,12 @@ static TupleTableSlot *ExecHashJoinGetSavedTuple(HashJoinState *hjstate,
 						  BufFile *file,
 						  uint32 *hashvalue,
 						  TupleTableSlot *tupleSlot);
+static TupleTableSlot *ExecHashJoinOuterGetBatchedTuple(PlanState *outerNode,
+								 HashJoinState *hjstate,
+								 uint32 *hashvalue);
 static bool ExecHashJoinNewBatch(HashJoinState *hjstate);
+static bool ExecHashJoinFindRuntimeFilter(PlanState *planstate,
+							  HashJoinState *hjstate);
 
 
 /* ----------------------------------------------------------------
@@ -162,9 +186,14 @@ ExecHashJoin(PlanState *pstate)
 				/*
 				 * create the hash table
 				 */
-				hashtable = ExecHashTableCreate((Hash *) hashNode->ps.plan,
-												node->hj_HashOperators,
-												HJ_FILL_INNER(node));
+				if (hashNode->parallel_state != NULL)
+					hashtable = ExecParallelHashTableCreate(hashNode,
+															node->hj_HashOperators,
+															HJ_FILL_INNER(node));
+				else
+					hashtable = ExecHashTableCreate((Hash *) hashNode->ps.plan,
+													node->hj_HashOperators,
+													HJ_FILL_INNER(node));
 				node->hj_HashTable = hashtable;
 
 				/*
@@ -181,6 +210,26 @@ ExecHashJoin(PlanState *pstate)
 				if (hashtable->totalTuples == 0 && !HJ_FILL_OUTER(node))
 					return NULL;
 
+				/*
+				 * Let the outer-side scan drop rows that cannot match before
+				 * they are projected and passed up to us, by publishing a
+				 * Bloom filter over the inner hash values.  That's only
+				 * possible if the whole inner relation is in memory.
+				 */
+				if (node->hj_RuntimeFilter != NULL &&
+					!node->hj_RuntimeFilter->disabled &&
+					hashtable->nbatch == 1)
+					node->hj_RuntimeFilter->filter =
+						ExecHashBuildBloomFilter(hashtable);
+
+				/*
+				 * Probe batch-at-a-time, prefetching buckets, if the table is
+				 * big enough for its bucket heads to miss the cache.
+				 */
+				node->hj_ProbeBatched =
+					(node->hj_ProbeSlot != NULL &&
+					 hashtable->nbuckets >= HJ_PROBE_MIN_BUCKETS);
+
 				/*
 				 * need to remember whether nbatch has increased since we
 				 * began scanning the outer relation
@@ -203,9 +252,14 @@ ExecHashJoin(PlanState *pstate)
 				/*
 				 * We don't have an outer tuple, try to get the next one
 				 */
-				outerTupleSlot = ExecHashJoinOuterGetTuple(outerNode,
-														   node,
-														   &hashvalue);
+				if (node->hj_ProbeBatched)
+					outerTupleSlot = ExecHashJoinOuterGetBatchedTuple(outerNode,
+																	  node,
+																	  &hashvalue);
+				else
+					outerTupleSlot = ExecHashJoinOuterGetTuple(outerNode,
+															   node,
+															   &hashvalue);
 				if (TupIsNull(outerTupleSlot))
 				{
 					/* end of batch, or maybe whole join */
@@ -510,6 +564,28 @@ ExecInitHashJoin(HashJoin *node, EState *estate, int eflags)
 	ExecSetSlotDescriptor(hjstate->hj_OuterTupleSlot,
 						  ExecGetResultType(outerPlanState(hjstate)));
 
+	/*
+	 * Set up for batched probing, should the hash table turn out to be
+	 * large.  The incremental executor probes tuple-at-a-time.
+	 */
+	if (!(estate->es_incremental && estate->es_isSelect))
+	{
+		hjstate->hj_ProbeSlot = ExecInitExtraTupleSlot(estate);
+		ExecSetSlotDescriptor(hjstate->hj_ProbeSlot,
+							  ExecGetResultType(outerPlanState(hjstate)));
+		hjstate->hj_ProbeTuples = (MinimalTuple *)
+			palloc(HJ_PROBE_BATCH_SIZE * sizeof(MinimalTuple));
+		hjstate->hj_ProbeCxt = AllocSetContextCreate(CurrentMemoryContext,
+													 "HashJoin probe batch",
+													 ALLOCSET_SMALL_SIZES);
+		hjstate->hj_ProbeHashValues = (uint32 *)
+			palloc(HJ_PROBE_BATCH_SIZE * sizeof(uint32));
+	}
+	hjstate->hj_ProbeNTuples = 0;
+	hjstate->hj_ProbeNext = 0;
+	hjstate->hj_ProbeBatched = false;
+	hjstate->hj_ProbeExhausted = false;
+
 	/*
 	 * initialize hash-specific info
 	 */
@@ -550,6 +626,16 @@ ExecInitHashJoin(HashJoin *node, EState *estate, int eflags)
 	hjstate->hj_MatchedOuter = false;
 	hjstate->hj_OuterNotEmpty = false;
 
+	/*
+	 * Find the outer-side scan the planner picked to receive our Bloom
+	 * filter, if any.  The incremental executor maintains its hash tables
+	 * across deltas, so it doesn't publish one.
+	 */
+	hjstate->hj_RuntimeFilter = NULL;
+	if (node->rtfilter_id != 0 &&
+		!(estate->es_incremental && estate->es_isSelect))
+		(void) ExecHashJoinFindRuntimeFilter(outerPlanState(hjstate), hjstate);
+
     /*
      * totem: incremental hash join or not  
      */
@@ -583,6 +669,8 @@ ExecEndHashJoin(HashJoinState *node)
 		ExecHashTableDestroy(node->hj_HashTable);
 		node->hj_HashTable = NULL;
 	}
+	if (node->hj_RuntimeFilter)
+		node->hj_RuntimeFilter->filter = NULL;
 
 	/*
 	 * Free the exprcontext
@@ -686,6 +774,107 @@ ExecHashJoinOuterGetTuple(PlanState *outerNode,
 	return NULL;
 }
 
+/*
+ * ExecHashJoinOuterGetBatchedTuple
+ *
+ *		Like ExecHashJoinOuterGetTuple, but fetches HJ_PROBE_BATCH_SIZE
+ *		outer tuples at a time, copying them as minimal tuples into a
+ *		per-batch memory context, and prefetches all of their hash buckets
+ *		before handing out the first.
+ *		By the time the caller walks a tuple's bucket chain its head is
+ *		hopefully in cache, so that the cache misses of a large hash table
+ *		overlap instead of being paid one after another.
+ */
+static TupleTableSlot *
+ExecHashJoinOuterGetBatchedTuple(PlanState *outerNode,
+								 HashJoinState *hjstate,
+								 uint32 *hashvalue)
+{
+	HashJoinTable hashtable = hjstate->hj_HashTable;
+
+	if (hjstate->hj_ProbeNext >= hjstate->hj_ProbeNTuples)
+	{
+		int			ntuples = 0;
+		int			i;
+
+		/*
+		 * If the outer side ran out while we were filling the last batch,
+		 * report that now, without asking it for more.
+		 */
+		if (hjstate->hj_ProbeExhausted)
+		{
+			hjstate->hj_ProbeExhausted = false;
+			hjstate->hj_ProbeNTuples = hjstate->hj_ProbeNext = 0;
+			return NULL;
+		}
+
+		/* The previous batch's tuples are all done with */
+		ExecClearTuple(hjstate->hj_ProbeSlot);
+		MemoryContextReset(hjstate->hj_ProbeCxt);
+
+		while (ntuples < HJ_PROBE_BATCH_SIZE)
+		{
+			TupleTableSlot *slot;
+			MemoryContext oldcxt;
+			uint32		hv;
+			int			bucketno;
+			int			batchno;
+
+			slot = ExecHashJoinOuterGetTuple(outerNode, hjstate, &hv);
+			if (TupIsNull(slot))
+			{
+				hjstate->hj_ProbeExhausted = true;
+				break;
+			}
+			oldcxt = MemoryContextSwitchTo(hjstate->hj_ProbeCxt);
+			hjstate->hj_ProbeTuples[ntuples] = ExecCopySlotMinimalTuple(slot);
+			MemoryContextSwitchTo(oldcxt);
+			hjstate->hj_ProbeHashValues[ntuples] = hv;
+
+			ExecHashGetBucketAndBatch(hashtable, hv, &bucketno, &batchno);
+			if (hashtable->parallel_state != NULL)
+				pg_prefetch_mem(&hashtable->shared_buckets[bucketno]);
+			else
+				pg_prefetch_mem(&hashtable->buckets[bucketno]);
+			ntuples++;
+		}
+
+		/*
+		 * The bucket heads should be arriving by now; start on the first
+		 * tuple of each chain too.  (Shared tuples would need a DSA address
+		 * translation, which isn't worth it here.)
+		 */
+		if (hashtable->parallel_state == NULL)
+		{
+			for (i = 0; i < ntuples; i++)
+			{
+				int			bucketno;
+				int			batchno;
+
+				ExecHashGetBucketAndBatch(hashtable,
+										  hjstate->hj_ProbeHashValues[i],
+										  &bucketno, &batchno);
+				if (batchno == hashtable->curbatch)
+					pg_prefetch_mem(hashtable->buckets[bucketno]);
+			}
+		}
+
+		hjstate->hj_ProbeNTuples = ntuples;
+		hjstate->hj_ProbeNext = 0;
+
+		if (ntuples == 0)
+		{
+			hjstate->hj_ProbeExhausted = false;
+			return NULL;
+		}
+	}
+
+	*hashvalue = hjstate->hj_ProbeHashValues[hjstate->hj_ProbeNext];
+	return ExecStoreMinimalTuple(hjstate->hj_ProbeTuples[hjstate->hj_ProbeNext++],
+								 hjstate->hj_ProbeSlot,
+								 false);
+}
+
 /*
  * ExecHashJoinNewBatch
  *		switch to a new hashjoin batch
@@ -803,8 +992,9 @@ ExecHashJoinNewBatch(HashJoinState *hjstate)
 			 * NOTE: some tuples may be sent to future batches.  Also, it is
 			 * possible for hashtable->nbatch to be increased here!
 			 */
-			ExecHashTableInsert(hashtable, slot, hashvalue);
+			ExecHashTableInsertDeferred(hashtable, slot, hashvalue);
 		}
+		ExecHashTableFlushInserts(hashtable);
 
 		/*
 		 * after we build the hash table, the inner batch file is no longer
@@ -918,6 +1108,41 @@ ExecHashJoinGetSavedTuple(HashJoinState *hjstate,
 	return ExecStoreMinimalTuple(tuple, tupleSlot, true);
 }
 
+/*
+ * ExecHashJoinFindRuntimeFilter
+ *		planstate_tree_walker callback looking for the scan node that the
+ *		planner marked with our rtfilter_id
+ */
+static bool
+ExecHashJoinFindRuntimeFilter(PlanState *planstate, HashJoinState *hjstate)
+{
+	HashJoin   *node = (HashJoin *) hjstate->js.ps.plan;
+
+	if (planstate == NULL)
+		return false;
+
+	switch (nodeTag(planstate))
+	{
+		case T_SeqScanState:
+		case T_IndexScanState:
+		case T_BitmapHeapScanState:
+			{
+				ScanState  *scanstate = (ScanState *) planstate;
+
+				if (((Scan *) planstate->plan)->rtfilter_id == node->rtfilter_id)
+				{
+					hjstate->hj_RuntimeFilter = scanstate->ss_rtfilter;
+					return true;
+				}
+			}
+			break;
+		default:
+			break;
+	}
+
+	return planstate_tree_walker(planstate, ExecHashJoinFindRuntimeFilter,
+								 (void *) hjstate);
+}
 
 void
 ExecReScanHashJoin(HashJoinState *node)
@@ -932,6 +1157,7 @@ ExecReScanHashJoin(HashJoinState *node)
 	if (node->hj_HashTable != NULL)
 	{
 		if (node->hj_HashTable->nbatch == 1 &&
+			node->hj_HashTable->parallel_state == NULL &&
 			node->js.ps.righttree->chgParam == NULL)
 		{
 			/*
@@ -964,6 +1190,19 @@ ExecReScanHashJoin(HashJoinState *node)
 			node->hj_HashTable = NULL;
 			node->hj_JoinState = HJ_BUILD_HASHTABLE;
 
+			/*
+			 * The Bloom filter went with it.  The new hash table may filter
+			 * much better or worse than the old one did, so forget what the
+			 * scan learned about the old filter and judge the next one afresh.
+			 */
+			if (node->hj_RuntimeFilter)
+			{
+				node->hj_RuntimeFilter->filter = NULL;
+				node->hj_RuntimeFilter->disabled = false;
+				node->hj_RuntimeFilter->nprobed = 0;
+				node->hj_RuntimeFilter->nremoved = 0;
+			}
+
 			/*
 			 * if chgParam of subnode is not null then plan will be re-scanned
 			 * by first ExecProcNode.
@@ -981,6 +1220,9 @@ ExecReScanHashJoin(HashJoinState *node)
 
 	node->hj_MatchedOuter = false;
 	node->hj_FirstOuterTupleSlot = NULL;
+	node->hj_ProbeNTuples = 0;
+	node->hj_ProbeNext = 0;
+	node->hj_ProbeExhausted = false;
 
 	/*
 	 * if chgParam of subnode is not null then plan will be re-scanned by
@@ -989,3 +1231,85 @@ ExecReScanHashJoin(HashJoinState *node)
 	if (node->js.ps.lefttree->chgParam == NULL)
 		ExecReScan(node->js.ps.lefttree);
 }
+
+/* ----------------------------------------------------------------
+ *						Parallel Hash Join Support
+ * ----------------------------------------------------------------
+ */
+
+/* ----------------------------------------------------------------
+ *		ExecHashJoinEstimate
+ *
+ *		estimates the space required to serialize the shared hash
+ *		table state.
+ * ----------------------------------------------------------------
+ */
+void
+ExecHashJoinEstimate(HashJoinState *state, ParallelContext *pcxt)
+{
+	shm_toc_estimate_chunk(&pcxt->estimator, sizeof(ParallelHashJoinState));
+	shm_toc_estimate_keys(&pcxt->estimator, 1);
+}
+
+/* ----------------------------------------------------------------
+ *		ExecHashJoinInitializeDSM
+ *
+ *		Set up the shared hash table state
+ * ----------------------------------------------------------------
+ */
+void
+ExecHashJoinInitializeDSM(HashJoinState *state, ParallelContext *pcxt)
+{
+	HashState  *hashNode = (HashState *) innerPlanState(state);
+	Plan	   *innerPlan = outerPlan(hashNode->ps.plan);
+	dsa_area   *area = state->js.ps.state->es_query_dsa;
+	ParallelHashJoinState *pstate;
+
+	/* no DSA area, no shared table; everybody builds their own */
+	if (area == NULL)
+		return;
+
+	/*
+	 * plan_rows of the partial inner plan is per participant.  The memory
+	 * budget is work_mem for each of them, as they would have had with
+	 * private tables.
+	 */
+	pstate = shm_toc_allocate(pcxt->toc, sizeof(ParallelHashJoinState));
+	ExecParallelHashTableInitialize(pstate, area,
+									innerPlan->plan_rows * (pcxt->nworkers + 1),
+									innerPlan->plan_width,
+									(Size) work_mem * 1024L * (pcxt->nworkers + 1));
+	shm_toc_insert(pcxt->toc, state->js.ps.plan->plan_node_id, pstate);
+	hashNode->parallel_state = pstate;
+}
+
+/* ----------------------------------------------------------------
+ *		ExecHashJoinReInitializeDSM
+ *
+ *		Reset shared state before beginning a fresh scan.
+ * ----------------------------------------------------------------
+ */
+void
+ExecHashJoinReInitializeDSM(HashJoinState *state, ParallelContext *pcxt)
+{
+	HashState  *hashNode = (HashState *) innerPlanState(state);
+
+	if (hashNode->parallel_state != NULL)
+		ExecParallelHashTableReset(hashNode->parallel_state,
+								   state->js.ps.state->es_query_dsa);
+}
+
+/* ----------------------------------------------------------------
+ *		ExecHashJoinInitializeWorker
+ *
+ *		Find the shared hash table state in the DSM
+ * ----------------------------------------------------------------
+ */
+void
+ExecHashJoinInitializeWorker(HashJoinState *state, shm_toc *toc)
+{
+	HashState  *hashNode = (HashState *) innerPlanState(state);
+
+	hashNode->parallel_state =
+		shm_toc_lookup(toc, state->js.ps.plan->plan_node_id, true);
+}
@@ -545,7 +545,7 @@ ExecScanHashBucketInc(HashJoinState *hjstate,
 	 * otherwise scan the standard hashtable bucket.
 	 */
 	if (hashTuple != NULL)
-		hashTuple = hashTuple->next;
+		hashTuple = hashTuple->next.unshared;
 	else if (hjstate->hj_CurSkewBucketNo != INVALID_SKEW_BUCKET_NO)
 		hashTuple = hashtable->skewBucket[hjstate->hj_CurSkewBucketNo]->tuples;
 	else
@@ -569,7 +569,7 @@ ExecScanHashBucketInc(HashJoinState *hjstate,
             {
                 if (!CheckMatch(TupIsDelta(econtext->ecxt_outertuple), hashTuple->delta, hjstate->hj_PullEncoding)) 
                 {
-                    hashTuple = hashTuple->next;
+                    hashTuple = hashTuple->next.unshared;
                     continue; 
                 }
  		    	temptuple = ExecStoreMinimalTuple(HJTUPLE_MINTUPLE(hashTuple),
@@ -589,7 +589,7 @@ ExecScanHashBucketInc(HashJoinState *hjstate,
 			}
 		}
 
-		hashTuple = hashTuple->next;
+		hashTuple = hashTuple->next.unshared;
 	}
 
 	/*
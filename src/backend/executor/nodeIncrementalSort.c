@@ -0,0 +1,333 @@
+/*-------------------------------------------------------------------------
+ *
+ * nodeIncrementalSort.c
+ *	  Routines to handle sorting of input that is already sorted on a
+ *	  prefix of the sort keys.
+ *
+ * If the input is known to be ordered by the first nPresortedCols sort
+ * keys, the full ordering can be produced by sorting each group of tuples
+ * with equal prefix keys on its own, and emitting the groups in input
+ * order.  The first output tuple is then available as soon as the first
+ * group has been read, and only one group needs to be held at a time,
+ * which makes this much cheaper than a full sort under a LIMIT.
+ *
+ * Groups are usually small, and starting a tuplesort is not free, so we
+ * gather whole groups into one batch until it holds at least
+ * MIN_BATCH_TUPLES tuples, and then sort the batch on all the keys.  To
+ * find the end of a group, we remember the tuple that brought the batch to
+ * MIN_BATCH_TUPLES (the "pivot") and keep reading until a tuple's prefix
+ * keys differ from it.  That tuple starts the next batch.
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/executor/nodeIncrementalSort.c
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include "executor/execdebug.h"
+#include "executor/nodeIncrementalSort.h"
+#include "miscadmin.h"
+#include "utils/lsyscache.h"
+#include "utils/memutils.h"
+#include "utils/tuplesort.h"
+
+/* Don't start a tuplesort for fewer input tuples than this */
+#define MIN_BATCH_TUPLES 32
+
+static void incsort_fill_batch(IncrementalSortState *node);
+
+
+/* ----------------------------------------------------------------
+ *		incsort_fill_batch
+ *
+ *		Read the next batch of complete prefix groups from the outer node
+ *		into a new tuplesort, and sort it.
+ * ----------------------------------------------------------------
+ */
+static void
+incsort_fill_batch(IncrementalSortState *node)
+{
+	IncrementalSort *plannode = (IncrementalSort *) node->ss.ps.plan;
+	PlanState  *outerNode = outerPlanState(node);
+	Tuplesortstate *tuplesortstate;
+	TupleTableSlot *slot;
+	int64		ntuples = 0;
+	const char *sortMethod;
+	const char *spaceType;
+	long		spaceUsed;
+
+	tuplesortstate = tuplesort_begin_heap(ExecGetResultType(outerNode),
+										  plannode->sort.numCols,
+										  plannode->sort.sortColIdx,
+										  plannode->sort.sortOperators,
+										  plannode->sort.collations,
+										  plannode->sort.nullsFirst,
+										  work_mem,
+										  false);
+
+	/* the batch holds whole groups, so the bound carries over directly */
+	if (node->bounded)
+		tuplesort_set_bound(tuplesortstate, node->bound - node->bound_Done);
+	node->tuplesortstate = (void *) tuplesortstate;
+
+	/* start with the tuple that ended the previous batch, if any */
+	if (!TupIsNull(node->transfer_tuple))
+	{
+		tuplesort_puttupleslot(tuplesortstate, node->transfer_tuple);
+		ExecClearTuple(node->transfer_tuple);
+		ntuples++;
+	}
+	ExecClearTuple(node->group_pivot);
+
+	for (;;)
+	{
+		slot = ExecProcNode(outerNode);
+
+		if (TupIsNull(slot))
+		{
+			node->outerNodeDone = true;
+			break;
+		}
+
+		if (!TupIsNull(node->group_pivot) &&
+			!execTuplesMatch(node->group_pivot, slot,
+							 plannode->nPresortedCols,
+							 plannode->sort.sortColIdx,
+							 node->presortedEqfuncs,
+							 node->ss.ps.ps_ExprContext->ecxt_per_tuple_memory))
+		{
+			/* first tuple of a new group: it starts the next batch */
+			ExecCopySlot(node->transfer_tuple, slot);
+			break;
+		}
+
+		tuplesort_puttupleslot(tuplesortstate, slot);
+		ntuples++;
+
+		/* big enough; finish the current group and stop */
+		if (ntuples == MIN_BATCH_TUPLES)
+			ExecCopySlot(node->group_pivot, slot);
+	}
+
+	ResetExprContext(node->ss.ps.ps_ExprContext);
+
+	tuplesort_performsort(tuplesortstate);
+
+	node->nbatches++;
+	tuplesort_get_stats(tuplesortstate, &sortMethod, &spaceType, &spaceUsed);
+	if (spaceUsed > node->maxSpaceUsed)
+	{
+		node->maxSpaceUsed = spaceUsed;
+		node->maxSpaceType = spaceType;
+	}
+
+	node->sort_Done = true;
+}
+
+/* ----------------------------------------------------------------
+ *		ExecIncrementalSort
+ *
+ *		Returns the next tuple in sort order, sorting a new batch of
+ *		input groups whenever the current one is exhausted.
+ * ----------------------------------------------------------------
+ */
+static TupleTableSlot *
+ExecIncrementalSort(PlanState *pstate)
+{
+	IncrementalSortState *node = castNode(IncrementalSortState, pstate);
+	EState	   *estate = node->ss.ps.state;
+	ScanDirection dir = estate->es_direction;
+	TupleTableSlot *slot = node->ss.ps.ps_ResultTupleSlot;
+
+	CHECK_FOR_INTERRUPTS();
+
+	/* we don't support backward scan; see ExecSupportsBackwardScan */
+	Assert(ScanDirectionIsForward(dir));
+
+	for (;;)
+	{
+		if (node->sort_Done)
+		{
+			if (tuplesort_gettupleslot((Tuplesortstate *) node->tuplesortstate,
+									   true, false, slot, NULL))
+			{
+				node->bound_Done++;
+				return slot;
+			}
+
+			/* batch exhausted */
+			tuplesort_end((Tuplesortstate *) node->tuplesortstate);
+			node->tuplesortstate = NULL;
+			node->sort_Done = false;
+		}
+
+		if ((node->outerNodeDone && TupIsNull(node->transfer_tuple)) ||
+			(node->bounded && node->bound_Done >= node->bound))
+			return ExecClearTuple(slot);
+
+		SO1_printf("ExecIncrementalSort: %s\n", "sorting next batch");
+
+		estate->es_direction = ForwardScanDirection;
+		incsort_fill_batch(node);
+		estate->es_direction = dir;
+	}
+}
+
+/* ----------------------------------------------------------------
+ *		ExecInitIncrementalSort
+ *
+ *		Creates the run-time state information for the incremental sort
+ *		node produced by the planner and initializes its outer subtree.
+ * ----------------------------------------------------------------
+ */
+IncrementalSortState *
+ExecInitIncrementalSort(IncrementalSort *node, EState *estate, int eflags)
+{
+	IncrementalSortState *incrsortstate;
+	Oid		   *eqOperators;
+	int			i;
+
+	SO1_printf("ExecInitIncrementalSort: %s\n",
+			   "initializing sort node");
+
+	/* output is produced on the fly, so no backward scan or mark/restore */
+	Assert((eflags & (EXEC_FLAG_BACKWARD | EXEC_FLAG_MARK)) == 0);
+
+	incrsortstate = makeNode(IncrementalSortState);
+	incrsortstate->ss.ps.plan = (Plan *) node;
+	incrsortstate->ss.ps.state = estate;
+	incrsortstate->ss.ps.ExecProcNode = ExecIncrementalSort;
+
+	incrsortstate->bounded = false;
+	incrsortstate->bound_Done = 0;
+	incrsortstate->outerNodeDone = false;
+	incrsortstate->sort_Done = false;
+	incrsortstate->tuplesortstate = NULL;
+	incrsortstate->nbatches = 0;
+	incrsortstate->maxSpaceUsed = 0;
+	incrsortstate->maxSpaceType = NULL;
+
+	/*
+	 * Miscellaneous initialization
+	 *
+	 * We need an ExprContext only for the memory used by the group
+	 * comparisons.
+	 */
+	ExecAssignExprContext(estate, &incrsortstate->ss.ps);
+
+	/*
+	 * tuple table initialization
+	 */
+	ExecInitResultTupleSlot(estate, &incrsortstate->ss.ps);
+	ExecInitScanTupleSlot(estate, &incrsortstate->ss);
+	incrsortstate->group_pivot = ExecInitExtraTupleSlot(estate);
+	incrsortstate->transfer_tuple = ExecInitExtraTupleSlot(estate);
+
+	/*
+	 * initialize child nodes
+	 */
+	eflags &= ~(EXEC_FLAG_REWIND | EXEC_FLAG_BACKWARD | EXEC_FLAG_MARK);
+
+	outerPlanState(incrsortstate) = ExecInitNode(outerPlan(node), estate, eflags);
+
+	/*
+	 * initialize tuple type.  no need to initialize projection info because
+	 * this node doesn't do projections.
+	 */
+	ExecAssignResultTypeFromTL(&incrsortstate->ss.ps);
+	ExecAssignScanTypeFromOuterPlan(&incrsortstate->ss);
+	incrsortstate->ss.ps.ps_ProjInfo = NULL;
+
+	ExecSetSlotDescriptor(incrsortstate->group_pivot,
+						  ExecGetResultType(outerPlanState(incrsortstate)));
+	ExecSetSlotDescriptor(incrsortstate->transfer_tuple,
+						  ExecGetResultType(outerPlanState(incrsortstate)));
+
+	/* Look up the equality functions for the presorted keys */
+	eqOperators = (Oid *) palloc(node->nPresortedCols * sizeof(Oid));
+	for (i = 0; i < node->nPresortedCols; i++)
+	{
+		eqOperators[i] = get_equality_op_for_ordering_op(node->sort.sortOperators[i],
+														 NULL);
+		if (!OidIsValid(eqOperators[i]))
+			elog(ERROR, "could not find equality operator for ordering operator %u",
+				 node->sort.sortOperators[i]);
+	}
+	incrsortstate->presortedEqfuncs =
+		execTuplesMatchPrepare(node->nPresortedCols, eqOperators);
+
+	SO1_printf("ExecInitIncrementalSort: %s\n",
+			   "sort node initialized");
+
+	return incrsortstate;
+}
+
+/* ----------------------------------------------------------------
+ *		ExecEndIncrementalSort(node)
+ * ----------------------------------------------------------------
+ */
+void
+ExecEndIncrementalSort(IncrementalSortState *node)
+{
+	SO1_printf("ExecEndIncrementalSort: %s\n",
+			   "shutting down sort node");
+
+	/*
+	 * clean out the tuple table
+	 */
+	ExecClearTuple(node->ss.ss_ScanTupleSlot);
+	/* must drop pointer to sort result tuple */
+	ExecClearTuple(node->ss.ps.ps_ResultTupleSlot);
+	ExecClearTuple(node->group_pivot);
+	ExecClearTuple(node->transfer_tuple);
+
+	/*
+	 * Release tuplesort resources
+	 */
+	if (node->tuplesortstate != NULL)
+		tuplesort_end((Tuplesortstate *) node->tuplesortstate);
+	node->tuplesortstate = NULL;
+
+	ExecFreeExprContext(&node->ss.ps);
+
+	/*
+	 * shut down the subplan
+	 */
+	ExecEndNode(outerPlanState(node));
+
+	SO1_printf("ExecEndIncrementalSort: %s\n",
+			   "sort node shutdown");
+}
+
+void
+ExecReScanIncrementalSort(IncrementalSortState *node)
+{
+	PlanState  *outerPlan = outerPlanState(node);
+
+	/*
+	 * The output is never materialized, so we always have to start over.
+	 */
+	ExecClearTuple(node->ss.ps.ps_ResultTupleSlot);
+	ExecClearTuple(node->group_pivot);
+	ExecClearTuple(node->transfer_tuple);
+
+	if (node->tuplesortstate != NULL)
+		tuplesort_end((Tuplesortstate *) node->tuplesortstate);
+	node->tuplesortstate = NULL;
+	node->sort_Done = false;
+	node->outerNodeDone = false;
+	node->bound_Done = 0;
+
+	/*
+	 * if chgParam of subnode is not null then plan will be re-scanned by
+	 * first ExecProcNode.
+	 */
+	if (outerPlan->chgParam == NULL)
+		ExecReScan(outerPlan);
+}
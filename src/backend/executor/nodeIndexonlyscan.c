@@ -98,6 +98,8 @@ IndexOnlyNext(IndexOnlyScanState *node)
 
 		/* Set it up for index-only scan */
 		node->ioss_ScanDesc->xs_want_itup = true;
+		node->ioss_ScanDesc->xs_want_skip =
+			((IndexOnlyScan *) node->ss.ps.plan)->indexskip;
 		node->ioss_VMBuffer = InvalidBuffer;
 
 		/*
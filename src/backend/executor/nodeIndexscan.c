@@ -117,6 +117,7 @@ IndexNext(IndexScanState *node)
 								   node->iss_NumOrderByKeys);
 
 		node->iss_ScanDesc = scandesc;
+		scandesc->xs_want_skip = ((IndexScan *) node->ss.ps.plan)->indexskip;
 
 		/*
 		 * If no run-time keys to calculate or they are ready, go ahead and
@@ -224,6 +225,7 @@ IndexNextWithReorder(IndexScanState *node)
 								   node->iss_NumOrderByKeys);
 
 		node->iss_ScanDesc = scandesc;
+		scandesc->xs_want_skip = ((IndexScan *) node->ss.ps.plan)->indexskip;
 
 		/*
 		 * If no run-time keys to calculate or they are ready, go ahead and
@@ -941,6 +943,7 @@ ExecInitIndexScan(IndexScan *node, EState *estate, int eflags)
 		ExecInitQual(node->indexqualorig, (PlanState *) indexstate);
 	indexstate->indexorderbyorig =
 		ExecInitExprList(node->indexorderbyorig, (PlanState *) indexstate);
+	indexstate->ss.ss_rtfilter = ExecInitScanRuntimeFilter(&indexstate->ss);
 
 	/*
 	 * tuple table initialization
@@ -302,12 +302,13 @@ recompute_limits(LimitState *node)
 }
 
 /*
- * If we have a COUNT, and our input is a Sort node, notify it that it can
- * use bounded sort.  Also, if our input is a MergeAppend, we can apply the
- * same bound to any Sorts that are direct children of the MergeAppend,
- * since the MergeAppend surely need read no more than that many tuples from
- * any one input.  We also have to be prepared to look through a Result,
- * since the planner might stick one atop MergeAppend for projection purposes.
+ * If we have a COUNT, and our input is a Sort or IncrementalSort node,
+ * notify it that it can use bounded sort.  Also, if our input is a
+ * MergeAppend, we can apply the same bound to any Sorts that are direct
+ * children of the MergeAppend, since the MergeAppend surely need read no
+ * more than that many tuples from any one input.  We also have to be
+ * prepared to look through a Result, since the planner might stick one atop
+ * MergeAppend for projection purposes.
  *
  * This is a bit of a kluge, but we don't have any more-abstract way of
  * communicating between the two nodes; and it doesn't seem worth trying
@@ -337,6 +338,20 @@ pass_down_bound(LimitState *node, PlanState *child_node)
 			sortState->bound = tuples_needed;
 		}
 	}
+	else if (IsA(child_node, IncrementalSortState))
+	{
+		IncrementalSortState *sortState = (IncrementalSortState *) child_node;
+		int64		tuples_needed = node->count + node->offset;
+
+		/* negative test checks for overflow in sum */
+		if (node->noCount || tuples_needed < 0)
+			sortState->bounded = false;
+		else
+		{
+			sortState->bounded = true;
+			sortState->bound = tuples_needed;
+		}
+	}
 	else if (IsA(child_node, MergeAppendState))
 	{
 		MergeAppendState *maState = (MergeAppendState *) child_node;
@@ -39,6 +39,7 @@
 #include "postgres.h"
 
 #include "executor/execdebug.h"
+#include "executor/execPartition.h"
 #include "executor/nodeMergeAppend.h"
 #include "lib/binaryheap.h"
 #include "miscadmin.h"
@@ -57,7 +58,9 @@ static int	heap_compare_slots(Datum a, Datum b, void *arg);
 /* ----------------------------------------------------------------
  *		ExecInitMergeAppend
  *
- *		Begin all of the subscans of the MergeAppend node.
+ *		Begin all of the subscans of the MergeAppend node, or only
+ *		those of matching partitions if partition pruning can be done
+ *		with the values of external Params.
  * ----------------------------------------------------------------
  */
 MergeAppendState *
@@ -65,8 +68,11 @@ ExecInitMergeAppend(MergeAppend *node, EState *estate, int eflags)
 {
 	MergeAppendState *mergestate = makeNode(MergeAppendState);
 	PlanState **mergeplanstates;
+	Bitmapset  *validsubplans = NULL;
+	bool		init_pruned = false;
 	int			nplans;
-	int			i;
+	int			i,
+				j;
 	ListCell   *lc;
 
 	/* check for unsupported flags */
@@ -79,18 +85,53 @@ ExecInitMergeAppend(MergeAppend *node, EState *estate, int eflags)
 	ExecLockNonLeafAppendTables(node->partitioned_rels, estate);
 
 	/*
-	 * Set up empty vector of subplan states
+	 * create new MergeAppendState for our node
 	 */
+	mergestate->ps.plan = (Plan *) node;
+	mergestate->ps.state = estate;
+	mergestate->ps.ExecProcNode = ExecMergeAppend;
+	mergestate->ms_prune_state = NULL;
+	mergestate->ms_valid_subplans = NULL;
+	mergestate->ms_valid_stale = false;
+
 	nplans = list_length(node->mergeplans);
 
-	mergeplanstates = (PlanState **) palloc0(nplans * sizeof(PlanState *));
+	/*
+	 * Set up run-time partition pruning, if the planner found it possible.
+	 * This works just like in ExecInitAppend.
+	 */
+	if (node->part_prune_info != NULL)
+	{
+		PartitionPruneState *prunestate;
+
+		prunestate = ExecSetupPartitionPruneState(&mergestate->ps,
+												  node->part_prune_info);
+		if (node->part_prune_info->exec_params)
+		{
+			mergestate->ms_prune_state = prunestate;
+			mergestate->ms_valid_stale = true;
+		}
+		else
+		{
+			validsubplans = ExecFindMatchingSubPlans(prunestate);
+			init_pruned = true;
+			nplans = bms_num_members(validsubplans);
+			if (nplans == 0)
+			{
+				/* keep one subplan for EXPLAIN, but never scan it */
+				validsubplans = bms_make_singleton(0);
+				nplans = 1;
+				mergestate->ms_prune_state = prunestate;
+			}
+			else
+				ExecEndPartitionPruneState(prunestate);
+		}
+	}
 
 	/*
-	 * create new MergeAppendState for our node
+	 * Set up empty vector of subplan states
 	 */
-	mergestate->ps.plan = (Plan *) node;
-	mergestate->ps.state = estate;
-	mergestate->ps.ExecProcNode = ExecMergeAppend;
+	mergeplanstates = (PlanState **) palloc0(nplans * sizeof(PlanState *));
 	mergestate->mergeplans = mergeplanstates;
 	mergestate->ms_nplans = nplans;
 
@@ -116,13 +157,16 @@ ExecInitMergeAppend(MergeAppend *node, EState *estate, int eflags)
 	 * results into the array "mergeplans".
 	 */
 	i = 0;
+	j = 0;
 	foreach(lc, node->mergeplans)
 	{
 		Plan	   *initNode = (Plan *) lfirst(lc);
 
-		mergeplanstates[i] = ExecInitNode(initNode, estate, eflags);
+		if (!init_pruned || bms_is_member(i, validsubplans))
+			mergeplanstates[j++] = ExecInitNode(initNode, estate, eflags);
 		i++;
 	}
+	Assert(j == nplans);
 
 	/*
 	 * initialize output tuple type
@@ -184,10 +228,22 @@ ExecMergeAppend(PlanState *pstate)
 	{
 		/*
 		 * First time through: pull the first tuple from each subplan, and set
-		 * up the heap.
+		 * up the heap.  With run-time pruning, only the subplans of matching
+		 * partitions are scanned.
 		 */
+		if (node->ms_prune_state != NULL && node->ms_valid_stale)
+		{
+			bms_free(node->ms_valid_subplans);
+			node->ms_valid_subplans =
+				ExecFindMatchingSubPlans(node->ms_prune_state);
+			node->ms_valid_stale = false;
+		}
+
 		for (i = 0; i < node->ms_nplans; i++)
 		{
+			if (node->ms_prune_state != NULL &&
+				!bms_is_member(i, node->ms_valid_subplans))
+				continue;
 			node->ms_slots[i] = ExecProcNode(node->mergeplans[i]);
 			if (!TupIsNull(node->ms_slots[i]))
 				binaryheap_add_unordered(node->ms_heap, Int32GetDatum(i));
@@ -292,6 +348,9 @@ ExecEndMergeAppend(MergeAppendState *node)
 	 */
 	for (i = 0; i < nplans; i++)
 		ExecEndNode(mergeplans[i]);
+
+	if (node->ms_prune_state != NULL)
+		ExecEndPartitionPruneState(node->ms_prune_state);
 }
 
 void
@@ -317,6 +376,13 @@ ExecReScanMergeAppend(MergeAppendState *node)
 		if (subnode->chgParam == NULL)
 			ExecReScan(subnode);
 	}
+
+	/* New Param values may change which partitions match */
+	if (node->ms_prune_state != NULL &&
+		node->ms_prune_state->pinfo->exec_params &&
+		node->ps.chgParam != NULL)
+		node->ms_valid_stale = true;
+
 	binaryheap_reset(node->ms_heap);
 	node->ms_initialized = false;
 }
@@ -20,6 +20,9 @@
  *		ExecEndSeqScan			releases any storage allocated.
  *		ExecReScanSeqScan		rescans the relation
  *
+ *		ExecSeqScanInitBatch	prepare to return tuples batch-at-a-time
+ *		ExecSeqScanNextBatch	retrieve next batch of qualifying tuples
+ *
  *		ExecSeqScanEstimate		estimates DSM space needed for parallel scan
  *		ExecSeqScanInitializeDSM initialize DSM for parallel scan
  *		ExecSeqScanReInitializeDSM reinitialize DSM for fresh parallel scan
@@ -28,8 +31,12 @@
 #include "postgres.h"
 
 #include "access/relscan.h"
+#include "executor/execBatch.h"
 #include "executor/execdebug.h"
+#include "executor/instrument.h"
 #include "executor/nodeSeqscan.h"
+#include "miscadmin.h"
+#include "utils/memutils.h"
 #include "utils/rel.h"
 
 /*
@@ -229,6 +236,7 @@ ExecInitSeqScan(SeqScan *node, EState *estate, int eflags)
 	 */
 	scanstate->ss.ps.qual =
 		ExecInitQual(node->plan.qual, (PlanState *) scanstate);
+	scanstate->ss.ss_rtfilter = ExecInitScanRuntimeFilter(&scanstate->ss);
 
 	/*
 	 * tuple table initialization
@@ -300,6 +308,10 @@ ExecEndSeqScan(SeqScanState *node)
 	ExecClearTuple(node->ss.ps.ps_ResultTupleSlot);
 	ExecClearTuple(node->ss.ss_ScanTupleSlot);
 
+	/* drop any buffer pins held by the batch */
+	if (node->batch)
+		TupleBatchReset(node->batch);
+
 	/*
 	 * close heap scan
 	 */
@@ -331,6 +343,10 @@ ExecReScanSeqScan(SeqScanState *node)
 
 	scan = node->ss.ss_currentScanDesc;
 
+	if (node->batch)
+		TupleBatchReset(node->batch);
+	node->batchdone = false;
+
 	if (scan != NULL)
 		heap_rescan(scan,		/* scan desc */
 					NULL);		/* new scan keys */
@@ -338,6 +354,125 @@ ExecReScanSeqScan(SeqScanState *node)
 	ExecScanReScan((ScanState *) node);
 }
 
+/* ----------------------------------------------------------------
+ *						Batch Support
+ * ----------------------------------------------------------------
+ */
+
+/* ----------------------------------------------------------------
+ *		ExecSeqScanInitBatch
+ *
+ *		Set up the node so that its parent can pull tuples from it
+ *		batch-at-a-time with ExecSeqScanNextBatch, bypassing the slot
+ *		and the row-at-a-time qual.  The caller registers the columns it
+ *		needs with TupleBatchUseColumn before the first batch is read.
+ *		Returns NULL if the scan cannot run in batch mode, in which case
+ *		the caller must keep using ExecProcNode.
+ * ----------------------------------------------------------------
+ */
+TupleBatch *
+ExecSeqScanInitBatch(SeqScanState *node, int maxrows)
+{
+	EState	   *estate = node->ss.ps.state;
+	TupleBatch *batch;
+	BatchExprState *batchqual;
+
+	/* EvalPlanQual substitutes single test tuples; keep the slot path */
+	if (estate->es_epqTuple != NULL)
+		return NULL;
+
+	/* The runtime Bloom filter is only applied on the slot path, too */
+	if (node->ss.ss_rtfilter != NULL)
+		return NULL;
+
+	batch = TupleBatchCreate(node->ss.ss_ScanTupleSlot->tts_tupleDescriptor,
+							 maxrows);
+	batchqual = ExecBuildBatchQual(node->ss.ps.plan->qual, batch,
+								   ((Scan *) node->ss.ps.plan)->scanrelid);
+	if (batchqual == NULL)
+		return NULL;
+
+	node->batch = batch;
+	node->batchqual = batchqual;
+
+	return batch;
+}
+
+/* ----------------------------------------------------------------
+ *		ExecSeqScanNextBatch
+ *
+ *		Fill the node's batch with the next tuples that pass the qual,
+ *		returning NULL at the end of the scan.  The live rows are listed
+ *		in the batch's selection vector; values stay valid until the
+ *		next call.
+ * ----------------------------------------------------------------
+ */
+TupleBatch *
+ExecSeqScanNextBatch(SeqScanState *node)
+{
+	TupleBatch *batch = node->batch;
+	EState	   *estate = node->ss.ps.state;
+	ExprContext *econtext = node->ss.ps.ps_ExprContext;
+	HeapScanDesc scandesc = node->ss.ss_currentScanDesc;
+	Instrumentation *instr = node->ss.ps.instrument;
+	MemoryContext oldcontext;
+	bool		done = node->batchdone;
+
+	Assert(batch != NULL);
+
+	CHECK_FOR_INTERRUPTS();
+
+	if (instr)
+		InstrStartNode(instr);
+
+	if (scandesc == NULL)
+	{
+		scandesc = heap_beginscan(node->ss.ss_currentRelation,
+								  estate->es_snapshot,
+								  0, NULL);
+		node->ss.ss_currentScanDesc = scandesc;
+	}
+
+	TupleBatchReset(batch);
+	ResetExprContext(econtext);
+	oldcontext = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
+
+	while (batch->nsel == 0 && !done)
+	{
+		int			nread;
+
+		TupleBatchReset(batch);
+
+		while (batch->nrows < batch->maxrows)
+		{
+			HeapTuple	tuple = heap_getnext(scandesc, estate->es_direction);
+
+			/*
+			 * heap_getnext would restart the scan if called again after
+			 * reporting the end, so remember that we got there.
+			 */
+			if (tuple == NULL)
+			{
+				node->batchdone = done = true;
+				break;
+			}
+			TupleBatchStoreTuple(batch, tuple, scandesc->rs_cbuf);
+		}
+
+		nread = batch->nrows;
+		ExecEvalBatchExpr(node->batchqual, batch);
+		if (nread > batch->nsel)
+			InstrCountFiltered1(node, nread - batch->nsel);
+	}
+
+	MemoryContextSwitchTo(oldcontext);
+
+	if (instr)
+		InstrStopNode(instr, (double) batch->nsel);
+
+	return batch->nsel > 0 ? batch : NULL;
+}
+
 /* ----------------------------------------------------------------
  *						Parallel Scan Support
  * ----------------------------------------------------------------
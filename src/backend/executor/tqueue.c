@@ -13,15 +13,17 @@
  * maps the sender's typmod for that type to its own typmod.
  *
  * A DestReceiver of type DestTupleQueue, which is a TQueueDestReceiver
- * under the hood, writes tuples from the executor to a shm_mq.  If
- * necessary, it also writes control messages describing transient
- * record types used within the tuple.
+ * under the hood, writes tuples from the executor to a shm_mq.  Tuples are
+ * packed into batches so that the queue is touched once per batch rather
+ * than once per tuple.  If necessary, it also writes control messages
+ * describing transient record types used within the tuple.
  *
  * A TupleQueueReader reads tuples, and control messages if any are sent,
- * from a shm_mq and returns the tuples.  If transient record types are
- * in use, it registers those types locally based on the control messages
- * and rewrites the typmods sent by the remote side to the corresponding
- * local record typmods.
+ * from a shm_mq and returns the tuples.  Where possible, the tuples are
+ * returned in place, without copying them out of the queue.  If transient
+ * record types are in use, it registers those types locally based on the
+ * control messages and rewrites the typmods sent by the remote side to the
+ * corresponding local record typmods.
  *
  * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
  * Portions Copyright (c) 1994, Regents of the University of California
@@ -52,14 +54,25 @@
  * The data transferred through the shm_mq is divided into messages.
  * One-byte messages are mode-switch messages, telling the receiver to switch
  * between "control" and "data" modes.  (We always start up in "data" mode.)
- * Otherwise, when in "data" mode, each message is a tuple.  When in "control"
- * mode, each message defines one transient-typmod-to-tupledesc mapping to
- * let us interpret future tuples.  Both of those cases certainly require
- * more than one byte, so no confusion is possible.
+ * Otherwise, when in "data" mode, each message is a batch of one or more
+ * tuples.  When in "control" mode, each message defines one
+ * transient-typmod-to-tupledesc mapping to let us interpret future tuples.
+ * Both of those cases certainly require more than one byte, so no confusion
+ * is possible.
+ *
+ * Within a batch, each tuple is preceded by its length as a uint32 padded
+ * out to MAXALIGN, and is itself padded out to MAXALIGN, so that the receiver
+ * can use every tuple header in place.  The sender ships a batch once it
+ * holds TUPLE_QUEUE_BATCH_SIZE bytes, and whenever it must send a mode-switch
+ * message or is shut down, so the ordering of tuples and control messages is
+ * preserved.
  */
 #define TUPLE_QUEUE_MODE_CONTROL	'c' /* mode-switch message contents */
 #define TUPLE_QUEUE_MODE_DATA		'd'
 
+#define TUPLE_QUEUE_TUPLE_HDRSZ		MAXALIGN(sizeof(uint32))
+#define TUPLE_QUEUE_BATCH_SIZE		8192
+
 /*
  * Both the sender and receiver build trees of TupleRemapInfo nodes to help
  * them identify which (sub) fields of transmitted tuples are composite and
@@ -133,7 +146,8 @@ struct TupleRemapInfo
  * queue and tupledesc are pointers to data supplied by DestReceiver's caller.
  * The recordhtab and remap info are owned by the DestReceiver and are kept
  * in mycontext.  tmpcontext is a tuple-lifespan context to hold cruft
- * created while traversing each tuple to find record subfields.
+ * created while traversing each tuple to find record subfields.  batch
+ * accumulates tuples not yet sent; it is also kept in mycontext.
  */
 typedef struct TQueueDestReceiver
 {
@@ -145,6 +159,9 @@ typedef struct TQueueDestReceiver
 	char		mode;			/* current message mode */
 	TupleDesc	tupledesc;		/* current top-level tuple descriptor */
 	TupleRemapInfo **field_remapinfo;	/* current top-level remap info */
+	char	   *batch;			/* tuples waiting to be sent */
+	Size		batch_used;		/* # bytes of batch in use */
+	Size		batch_size;		/* # bytes allocated for batch */
 } TQueueDestReceiver;
 
 /*
@@ -161,7 +178,9 @@ typedef struct RecordTypmodMap
  *
  * queue and tupledesc are pointers to data supplied by reader's caller.
  * The typmodmap and remap info are owned by the TupleQueueReader and
- * are kept in mycontext.
+ * are kept in mycontext.  batch points to the data message currently being
+ * returned, which belongs to the shm_mq and stays valid only until the next
+ * shm_mq_receive; htup is the header for a tuple returned from it in place.
  *
  * "typedef struct TupleQueueReader TupleQueueReader" is in tqueue.h
  */
@@ -173,9 +192,15 @@ struct TupleQueueReader
 	char		mode;			/* current message mode */
 	TupleDesc	tupledesc;		/* current top-level tuple descriptor */
 	TupleRemapInfo **field_remapinfo;	/* current top-level remap info */
+	char	   *batch;			/* current batch of tuples, if any */
+	Size		batch_len;		/* # bytes in batch */
+	Size		batch_off;		/* offset of next tuple in batch */
+	HeapTupleData htup;			/* tuple returned in place */
 };
 
 /* Local function prototypes */
+static bool TQFlushBatch(TQueueDestReceiver *tqueue);
+static void TQSendModeSwitch(TQueueDestReceiver *tqueue, char mode);
 static void TQExamine(TQueueDestReceiver *tqueue,
 		  TupleRemapInfo *remapinfo,
 		  Datum value);
@@ -192,8 +217,7 @@ static void TQSendRecordInfo(TQueueDestReceiver *tqueue, int32 typmod,
 				 TupleDesc tupledesc);
 static void TupleQueueHandleControlMessage(TupleQueueReader *reader,
 							   Size nbytes, char *data);
-static HeapTuple TupleQueueHandleDataMessage(TupleQueueReader *reader,
-							Size nbytes, HeapTupleHeader data);
+static HeapTuple TupleQueueHandleDataMessage(TupleQueueReader *reader);
 static HeapTuple TQRemapTuple(TupleQueueReader *reader,
 			 TupleDesc tupledesc,
 			 TupleRemapInfo **field_remapinfo,
@@ -226,7 +250,8 @@ tqueueReceiveSlot(TupleTableSlot *slot, DestReceiver *self)
 	TQueueDestReceiver *tqueue = (TQueueDestReceiver *) self;
 	TupleDesc	tupledesc = slot->tts_tupleDescriptor;
 	HeapTuple	tuple;
-	shm_mq_result result;
+	Size		needed;
+	uint32		len;
 
 	/*
 	 * If first time through, compute remapping info for the top-level fields.
@@ -298,15 +323,59 @@ tqueueReceiveSlot(TupleTableSlot *slot, DestReceiver *self)
 
 		/* If we entered control mode, switch back to data mode. */
 		if (tqueue->mode != TUPLE_QUEUE_MODE_DATA)
+			TQSendModeSwitch(tqueue, TUPLE_QUEUE_MODE_DATA);
+	}
+
+	/*
+	 * Add the tuple itself to the current batch.  If it doesn't fit, ship
+	 * what we have first, and make room if the tuple is bigger than any
+	 * batch so far.
+	 */
+	tuple = ExecMaterializeSlot(slot);
+	needed = TUPLE_QUEUE_TUPLE_HDRSZ + MAXALIGN(tuple->t_len);
+	if (tqueue->batch_used + needed > tqueue->batch_size)
+	{
+		if (!TQFlushBatch(tqueue))
+			return false;
+		if (needed > tqueue->batch_size)
 		{
-			tqueue->mode = TUPLE_QUEUE_MODE_DATA;
-			shm_mq_send(tqueue->queue, sizeof(char), &tqueue->mode, false);
+			if (tqueue->batch != NULL)
+				pfree(tqueue->batch);
+			tqueue->batch_size = Max(needed, TUPLE_QUEUE_BATCH_SIZE);
+			tqueue->batch = MemoryContextAlloc(tqueue->mycontext,
+											   tqueue->batch_size);
 		}
 	}
 
-	/* Send the tuple itself. */
-	tuple = ExecMaterializeSlot(slot);
-	result = shm_mq_send(tqueue->queue, tuple->t_len, tuple->t_data, false);
+	len = tuple->t_len;
+	memcpy(tqueue->batch + tqueue->batch_used, &len, sizeof(uint32));
+	memcpy(tqueue->batch + tqueue->batch_used + TUPLE_QUEUE_TUPLE_HDRSZ,
+		   tuple->t_data, tuple->t_len);
+	tqueue->batch_used += needed;
+
+	/* Ship the batch once it's big enough. */
+	if (tqueue->batch_used >= TUPLE_QUEUE_BATCH_SIZE)
+		return TQFlushBatch(tqueue);
+
+	return true;
+}
+
+/*
+ * Send the tuples accumulated in the current batch, if any.
+ *
+ * Returns TRUE if successful, FALSE if shm_mq has been detached.
+ */
+static bool
+TQFlushBatch(TQueueDestReceiver *tqueue)
+{
+	shm_mq_result result;
+
+	if (tqueue->batch_used == 0)
+		return true;
+
+	result = shm_mq_send(tqueue->queue, tqueue->batch_used, tqueue->batch,
+						 false);
+	tqueue->batch_used = 0;
 
 	/* Check for failure. */
 	if (result == SHM_MQ_DETACHED)
@@ -319,6 +388,18 @@ tqueueReceiveSlot(TupleTableSlot *slot, DestReceiver *self)
 	return true;
 }
 
+/*
+ * Switch the message queue to the given mode.  Any tuples still batched
+ * must reach the receiver before the mode-switch message does.
+ */
+static void
+TQSendModeSwitch(TQueueDestReceiver *tqueue, char mode)
+{
+	(void) TQFlushBatch(tqueue);
+	tqueue->mode = mode;
+	shm_mq_send(tqueue->queue, sizeof(char), &tqueue->mode, false);
+}
+
 /*
  * Examine the given datum and send any necessary control messages for
  * transient record types contained in it.
@@ -539,10 +620,7 @@ TQSendRecordInfo(TQueueDestReceiver *tqueue, int32 typmod, TupleDesc tupledesc)
 
 	/* If message queue is in data mode, switch to control mode. */
 	if (tqueue->mode != TUPLE_QUEUE_MODE_CONTROL)
-	{
-		tqueue->mode = TUPLE_QUEUE_MODE_CONTROL;
-		shm_mq_send(tqueue->queue, sizeof(char), &tqueue->mode, false);
-	}
+		TQSendModeSwitch(tqueue, TUPLE_QUEUE_MODE_CONTROL);
 
 	/* Assemble a control message. */
 	initStringInfo(&buf);
@@ -579,7 +657,11 @@ tqueueShutdownReceiver(DestReceiver *self)
 	TQueueDestReceiver *tqueue = (TQueueDestReceiver *) self;
 
 	if (tqueue->queue != NULL)
+	{
+		/* Ship any tuples still batched. */
+		(void) TQFlushBatch(tqueue);
 		shm_mq_detach(tqueue->queue);
+	}
 	tqueue->queue = NULL;
 }
 
@@ -601,6 +683,8 @@ tqueueDestroyReceiver(DestReceiver *self)
 	/* Is it worth trying to free substructure of the remap tree? */
 	if (tqueue->field_remapinfo != NULL)
 		pfree(tqueue->field_remapinfo);
+	if (tqueue->batch != NULL)
+		pfree(tqueue->batch);
 	pfree(self);
 }
 
@@ -627,6 +711,10 @@ CreateTupleQueueDestReceiver(shm_mq_handle *handle)
 	/* Top-level tupledesc is not known yet */
 	self->tupledesc = NULL;
 	self->field_remapinfo = NULL;
+	/* Batch buffer is allocated when the first tuple arrives */
+	self->batch = NULL;
+	self->batch_used = 0;
+	self->batch_size = 0;
 
 	return (DestReceiver *) self;
 }
@@ -645,6 +733,9 @@ CreateTupleQueueReader(shm_mq_handle *handle, TupleDesc tupledesc)
 	reader->mode = TUPLE_QUEUE_MODE_DATA;
 	reader->tupledesc = tupledesc;
 	reader->field_remapinfo = BuildFieldRemapInfo(tupledesc, reader->mycontext);
+	reader->batch = NULL;
+	reader->batch_len = 0;
+	reader->batch_off = 0;
 
 	return reader;
 }
@@ -673,10 +764,12 @@ DestroyTupleQueueReader(TupleQueueReader *reader)
  * nowait = true and no tuple is ready to return.  *done, if not NULL,
  * is set to true when there are no remaining tuples and otherwise to false.
  *
- * The returned tuple, if any, is allocated in CurrentMemoryContext.
- * That should be a short-lived (tuple-lifespan) context, because we are
- * pretty cavalier about leaking memory in that context if we have to do
- * tuple remapping.
+ * The returned tuple, if any, either points directly into the queue or,
+ * if it had to be remapped, is allocated in CurrentMemoryContext.  Either
+ * way it is valid only until the next call for this reader, so a caller
+ * that wants to keep it longer must copy it.  CurrentMemoryContext should
+ * be a short-lived (tuple-lifespan) context, because we are pretty cavalier
+ * about leaking memory in that context if we have to do tuple remapping.
  *
  * Even when shm_mq_receive() returns SHM_MQ_WOULD_BLOCK, this can still
  * accumulate bytes from a partially-read message, so it's useful to call
@@ -695,6 +788,10 @@ TupleQueueReaderNext(TupleQueueReader *reader, bool nowait, bool *done)
 		Size		nbytes;
 		void	   *data;
 
+		/* Return the next tuple of the current batch, if any remain. */
+		if (reader->batch_off < reader->batch_len)
+			return TupleQueueHandleDataMessage(reader);
+
 		/* Attempt to read a message. */
 		result = shm_mq_receive(reader->queue, &nbytes, &data, nowait);
 
@@ -721,8 +818,10 @@ TupleQueueReaderNext(TupleQueueReader *reader, bool nowait, bool *done)
 		}
 		else if (reader->mode == TUPLE_QUEUE_MODE_DATA)
 		{
-			/* Tuple data. */
-			return TupleQueueHandleDataMessage(reader, nbytes, data);
+			/* A batch of tuples; loop around to return the first one. */
+			reader->batch = (char *) data;
+			reader->batch_len = nbytes;
+			reader->batch_off = 0;
 		}
 		else if (reader->mode == TUPLE_QUEUE_MODE_CONTROL)
 		{
@@ -735,32 +834,41 @@ TupleQueueReaderNext(TupleQueueReader *reader, bool nowait, bool *done)
 }
 
 /*
- * Handle a data message - that is, a tuple - from the remote side.
+ * Handle the next tuple of the current data message from the remote side.
  */
 static HeapTuple
-TupleQueueHandleDataMessage(TupleQueueReader *reader,
-							Size nbytes,
-							HeapTupleHeader data)
+TupleQueueHandleDataMessage(TupleQueueReader *reader)
 {
-	HeapTupleData htup;
+	HeapTuple	htup = &reader->htup;
+	uint32		len;
+
+	Assert(reader->batch_off + TUPLE_QUEUE_TUPLE_HDRSZ <= reader->batch_len);
+	memcpy(&len, reader->batch + reader->batch_off, sizeof(uint32));
 
 	/*
-	 * Set up a dummy HeapTupleData pointing to the data from the shm_mq
-	 * (which had better be sufficiently aligned).
+	 * Set up a HeapTupleData pointing to the data from the shm_mq (which had
+	 * better be sufficiently aligned; the batch layout sees to that), and
+	 * step over it.
 	 */
-	ItemPointerSetInvalid(&htup.t_self);
-	htup.t_tableOid = InvalidOid;
-	htup.t_len = nbytes;
-	htup.t_data = data;
+	ItemPointerSetInvalid(&htup->t_self);
+	htup->t_tableOid = InvalidOid;
+	htup->t_len = len;
+	htup->t_data = (HeapTupleHeader)
+		(reader->batch + reader->batch_off + TUPLE_QUEUE_TUPLE_HDRSZ);
+	reader->batch_off += TUPLE_QUEUE_TUPLE_HDRSZ + MAXALIGN(len);
+	Assert(reader->batch_off <= reader->batch_len);
 
 	/*
-	 * Either just copy the data into a regular palloc'd tuple, or remap it,
-	 * as required.
+	 * If no remapping can be necessary, hand back the tuple in place;
+	 * otherwise remap it into a palloc'd copy.
 	 */
+	if (reader->field_remapinfo == NULL)
+		return htup;
+
 	return TQRemapTuple(reader,
 						reader->tupledesc,
 						reader->field_remapinfo,
-						&htup);
+						htup);
 }
 
 /*
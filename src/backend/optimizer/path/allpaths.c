@@ -32,6 +32,7 @@
 #include "optimizer/clauses.h"
 #include "optimizer/cost.h"
 #include "optimizer/geqo.h"
+#include "optimizer/partprune.h"
 #include "optimizer/pathnode.h"
 #include "optimizer/paths.h"
 #include "optimizer/plancat.h"
@@ -865,10 +866,19 @@ set_append_rel_size(PlannerInfo *root, RelOptInfo *rel,
 	double		parent_size;
 	double	   *parent_attrsizes;
 	int			nattrs;
+	Relids		pruned_children = NULL;
 	ListCell   *l;
 
 	Assert(IS_SIMPLE_REL(rel));
 
+	/*
+	 * For a partitioned table, find the partitions that the quals exclude by
+	 * looking them up in the partition bounds.  That's much cheaper than
+	 * running constraint exclusion on each of them.
+	 */
+	if (enable_partition_pruning && rte->relkind == RELKIND_PARTITIONED_TABLE)
+		pruned_children = prune_append_rel_partitions(root, rel, rte);
+
 	/*
 	 * Initialize to compute size estimates for whole append relation.
 	 *
@@ -916,6 +926,13 @@ set_append_rel_size(PlannerInfo *root, RelOptInfo *rel,
 		childrel = find_base_rel(root, childRTindex);
 		Assert(childrel->reloptkind == RELOPT_OTHER_MEMBER_REL);
 
+		if (bms_is_member(childRTindex, pruned_children))
+		{
+			/* This partition was pruned; skip it entirely */
+			set_dummy_rel_pathlist(childrel);
+			continue;
+		}
+
 		/*
 		 * We have to copy the parent's targetlist and quals to the child,
 		 * with appropriate substitution of variables.  However, only the
@@ -1286,7 +1303,6 @@ add_paths_to_append_rel(PlannerInfo *root, RelOptInfo *rel,
 	List	   *all_child_outers = NIL;
 	ListCell   *l;
 	List	   *partitioned_rels = NIL;
-	RangeTblEntry *rte;
 	bool		build_partitioned_rels = false;
 
 	/*
@@ -1297,24 +1313,32 @@ add_paths_to_append_rel(PlannerInfo *root, RelOptInfo *rel,
 	 * we ever do, we could create a PartitionedChildRelInfo with the
 	 * accumulated list of partitioned_rels which would then be found when
 	 * populated our parent rel with paths.  For the present, that appears to
-	 * be unnecessary.)
+	 * be unnecessary.)  A partition-wise join collects those of its member
+	 * base relations.
 	 */
-	rte = planner_rt_fetch(rel->relid, root);
-	switch (rte->rtekind)
+	if (IS_JOIN_REL(rel))
+		partitioned_rels = get_partitioned_child_rels_for_join(root,
+															   rel->relids);
+	else
 	{
-		case RTE_RELATION:
-			if (rte->relkind == RELKIND_PARTITIONED_TABLE)
-			{
-				partitioned_rels =
-					get_partitioned_child_rels(root, rel->relid);
-				Assert(list_length(partitioned_rels) >= 1);
-			}
-			break;
-		case RTE_SUBQUERY:
-			build_partitioned_rels = true;
-			break;
-		default:
-			elog(ERROR, "unexpected rtekind: %d", (int) rte->rtekind);
+		RangeTblEntry *rte = planner_rt_fetch(rel->relid, root);
+
+		switch (rte->rtekind)
+		{
+			case RTE_RELATION:
+				if (rte->relkind == RELKIND_PARTITIONED_TABLE)
+				{
+					partitioned_rels =
+						get_partitioned_child_rels(root, rel->relid);
+					Assert(list_length(partitioned_rels) >= 1);
+				}
+				break;
+			case RTE_SUBQUERY:
+				build_partitioned_rels = true;
+				break;
+			default:
+				elog(ERROR, "unexpected rtekind: %d", (int) rte->rtekind);
+		}
 	}
 
 	/*
@@ -2430,6 +2454,9 @@ standard_join_search(PlannerInfo *root, int levels_needed, List *initial_rels)
 		{
 			rel = (RelOptInfo *) lfirst(lc);
 
+			/* Create paths for partition-wise joins. */
+			generate_partitionwise_join_paths(root, rel);
+
 			/* Create GatherPaths for any useful partial paths for rel */
 			generate_gather_paths(root, rel);
 
@@ -2456,6 +2483,62 @@ standard_join_search(PlannerInfo *root, int levels_needed, List *initial_rels)
 	return rel;
 }
 
+/*
+ * generate_partitionwise_join_paths
+ * 		Create paths representing partition-wise join for given partitioned
+ * 		join relation.
+ *
+ * This must not be called until after we are done adding paths for all
+ * child-joins. Otherwise, add_path might delete a path to which some path
+ * generated here has a reference.
+ */
+void
+generate_partitionwise_join_paths(PlannerInfo *root, RelOptInfo *rel)
+{
+	List	   *live_children = NIL;
+	int			cnt_parts;
+
+	/* Handle only join relations here. */
+	if (!IS_JOIN_REL(rel))
+		return;
+
+	/* We've nothing to do if the relation is not partitioned. */
+	if (!IS_PARTITIONED_REL(rel))
+		return;
+
+	/* Collect non-dummy child-joins. */
+	for (cnt_parts = 0; cnt_parts < rel->nparts; cnt_parts++)
+	{
+		RelOptInfo *child_rel = rel->part_rels[cnt_parts];
+
+		/*
+		 * If no pair of input relations allowed this child join to be built,
+		 * or gave it any paths, the join can't be done partition-wise.
+		 */
+		if (child_rel == NULL || child_rel->pathlist == NIL)
+			return;
+
+		set_cheapest(child_rel);
+
+		/* Dummy children will not be scanned, so ignore those. */
+		if (IS_DUMMY_REL(child_rel))
+			continue;
+
+		live_children = lappend(live_children, child_rel);
+	}
+
+	/* If all child-joins are dummy, parent join is also dummy. */
+	if (!live_children)
+	{
+		mark_dummy_rel(rel);
+		return;
+	}
+
+	/* Build additional paths for this rel from child-join paths. */
+	add_paths_to_append_rel(root, rel, live_children);
+	list_free(live_children);
+}
+
 /*****************************************************************************
  *			PUSHING QUALS DOWN INTO SUBQUERIES
  *****************************************************************************/
@@ -3295,6 +3378,10 @@ print_path(PlannerInfo *root, Path *path, int indent)
 			ptype = "Material";
 			subpath = ((MaterialPath *) path)->subpath;
 			break;
+		case T_MemoizePath:
+			ptype = "Memoize";
+			subpath = ((MemoizePath *) path)->subpath;
+			break;
 		case T_UniquePath:
 			ptype = "Unique";
 			subpath = ((UniquePath *) path)->subpath;
@@ -3315,6 +3402,10 @@ print_path(PlannerInfo *root, Path *path, int indent)
 			ptype = "Sort";
 			subpath = ((SortPath *) path)->subpath;
 			break;
+		case T_IncrementalSortPath:
+			ptype = "IncrementalSort";
+			subpath = ((SortPath *) path)->subpath;
+			break;
 		case T_GroupPath:
 			ptype = "Group";
 			subpath = ((GroupPath *) path)->subpath;
@@ -80,7 +80,9 @@
 #include "access/htup_details.h"
 #include "access/tsmapi.h"
 #include "executor/executor.h"
+#include "executor/nodeAgg.h"
 #include "executor/nodeHash.h"
+#include "executor/nodeMemoize.h"
 #include "miscadmin.h"
 #include "nodes/nodeFuncs.h"
 #include "optimizer/clauses.h"
@@ -118,15 +120,25 @@ int			max_parallel_workers_per_gather = 2;
 bool		enable_seqscan = true;
 bool		enable_indexscan = true;
 bool		enable_indexonlyscan = true;
+bool		enable_indexskipscan = true;
 bool		enable_bitmapscan = true;
 bool		enable_tidscan = true;
 bool		enable_sort = true;
+bool		enable_incremental_sort = true;
 bool		enable_hashagg = true;
+bool		enable_hashagg_disk = true;
 bool		enable_nestloop = true;
 bool		enable_material = true;
+bool		enable_memoize = true;
 bool		enable_mergejoin = true;
 bool		enable_hashjoin = true;
+bool		enable_hashjoin_bloom = true;
 bool		enable_gathermerge = true;
+bool		enable_parallel_hash = false;
+bool		enable_partition_pruning = true;
+bool		enable_partitionwise_join = false;
+bool		enable_partitionwise_aggregate = false;
+bool		enable_async_append = true;
 
 typedef struct
 {
@@ -1740,6 +1752,97 @@ cost_sort(Path *path, PlannerInfo *root,
 	path->total_cost = startup_cost + run_cost;
 }
 
+/*
+ * cost_incremental_sort
+ *	  Determines and returns the cost of an incremental sort, whose input
+ *	  is already sorted by the first 'presorted_keys' of 'pathkeys'.
+ *
+ * The input is sorted one group of equal presorted keys at a time, so we
+ * estimate the number of groups from the presorted keys and charge one
+ * sort of an average-sized group per group (the executor batches groups
+ * to at least 32 tuples, and so do we).  Only the first group must be read
+ * and sorted before the first tuple comes out, which is what makes this
+ * attractive under a LIMIT.  In addition, each input tuple is compared
+ * with the current group's pivot to find the group boundaries.
+ *
+ * Arguments are as for cost_sort, except that the input cost is split into
+ * startup and total.
+ */
+void
+cost_incremental_sort(Path *path, PlannerInfo *root,
+					  List *pathkeys, int presorted_keys,
+					  Cost input_startup_cost, Cost input_total_cost,
+					  double input_tuples, int width,
+					  Cost comparison_cost, int sort_mem,
+					  double limit_tuples)
+{
+	Cost		startup_cost;
+	Cost		run_cost;
+	Cost		input_run_cost = input_total_cost - input_startup_cost;
+	double		group_tuples;
+	double		input_groups;
+	Cost		group_startup_cost;
+	Cost		group_run_cost;
+	Cost		group_input_run_cost;
+	List	   *presortedExprs = NIL;
+	ListCell   *lc;
+	int			i = 0;
+	Path		sort_path;		/* dummy for result of cost_sort */
+
+	Assert(presorted_keys > 0 && presorted_keys < list_length(pathkeys));
+
+	/* Mustn't divide by zero, or take log(0) in cost_sort */
+	if (input_tuples < 2.0)
+		input_tuples = 2.0;
+
+	/* Estimate the number of groups of equal presorted keys */
+	foreach(lc, pathkeys)
+	{
+		PathKey    *key = (PathKey *) lfirst(lc);
+		EquivalenceMember *member = (EquivalenceMember *)
+		linitial(key->pk_eclass->ec_members);
+
+		presortedExprs = lappend(presortedExprs, member->em_expr);
+
+		if (++i >= presorted_keys)
+			break;
+	}
+	input_groups = estimate_num_groups(root, presortedExprs, input_tuples,
+									   NULL);
+	group_tuples = input_tuples / input_groups;
+
+	/* the executor sorts at least this many tuples at a time */
+	if (group_tuples < 32.0)
+	{
+		group_tuples = Min(32.0, input_tuples);
+		input_groups = input_tuples / group_tuples;
+	}
+	group_input_run_cost = input_run_cost / input_groups;
+
+	/* Cost of sorting one group */
+	cost_sort(&sort_path, root, pathkeys, 0.0, group_tuples, width,
+			  comparison_cost, sort_mem, limit_tuples);
+	group_startup_cost = sort_path.startup_cost;
+	group_run_cost = sort_path.total_cost - group_startup_cost;
+
+	/* The first group has to be read and sorted before we can emit */
+	startup_cost = input_startup_cost + group_input_run_cost +
+		group_startup_cost;
+
+	/* ... and then all the others */
+	run_cost = group_run_cost +
+		(group_startup_cost + group_run_cost + group_input_run_cost) *
+		(input_groups - 1);
+
+	/* Group boundary checks, and per-group tuplesort setup */
+	run_cost += (cpu_tuple_cost + 2.0 * cpu_operator_cost) * input_tuples;
+	run_cost += 2.0 * cpu_tuple_cost * input_groups;
+
+	path->rows = input_tuples;
+	path->startup_cost = startup_cost;
+	path->total_cost = startup_cost + run_cost;
+}
+
 /*
  * cost_merge_append
  *	  Determines and returns the cost of a MergeAppend node.
@@ -1868,13 +1971,16 @@ cost_material(Path *path,
  *
  * Note: when aggstrategy == AGG_SORTED, caller must ensure that input costs
  * are for appropriately-sorted input.
+ *
+ * input_width is the width of the input rows, which AGG_HASHED may have to
+ * write to disk if the groups don't fit in work_mem.
  */
 void
 cost_agg(Path *path, PlannerInfo *root,
 		 AggStrategy aggstrategy, const AggClauseCosts *aggcosts,
 		 int numGroupCols, double numGroups,
 		 Cost input_startup_cost, Cost input_total_cost,
-		 double input_tuples)
+		 double input_tuples, int input_width)
 {
 	double		output_tuples;
 	Cost		startup_cost;
@@ -1942,6 +2048,11 @@ cost_agg(Path *path, PlannerInfo *root,
 	else
 	{
 		/* must be AGG_HASHED */
+		double		hashentrysize;
+		double		nbatches;
+		Size		mem_limit;
+		int			num_partitions;
+
 		startup_cost = input_total_cost;
 		if (!enable_hashagg)
 			startup_cost += disable_cost;
@@ -1952,6 +2063,40 @@ cost_agg(Path *path, PlannerInfo *root,
 		total_cost += aggcosts->finalCost * numGroups;
 		total_cost += cpu_tuple_cost * numGroups;
 		output_tuples = numGroups;
+
+		/*
+		 * If the groups are not expected to fit in work_mem, the executor
+		 * spills input tuples to disk and aggregates them in further passes.
+		 * Each level of recursion writes and reads back all of the input (a
+		 * pessimistic assumption: the first pass usually keeps some groups in
+		 * memory).  Charge the writes as random I/O, since many partitions
+		 * are written at once.
+		 */
+		hashentrysize = MAXALIGN(input_width) +
+			MAXALIGN(SizeofMinimalTupleHeader) +
+			aggcosts->transitionSpace +
+			hash_agg_entry_size(aggcosts->numAggs);
+		hash_agg_set_limits(hashentrysize, numGroups, 0,
+							&mem_limit, &num_partitions);
+		nbatches = numGroups * hashentrysize / mem_limit;
+
+		if (nbatches > 1.0)
+		{
+			double		pages;
+			Cost		spill_cost;
+			int			depth;
+
+			depth = (int) ceil(log(nbatches) / log(num_partitions));
+			depth = Max(depth, 1);
+
+			pages = page_size(input_tuples, input_width);
+			spill_cost = pages * depth * random_page_cost;
+			spill_cost += pages * depth * seq_page_cost;
+			spill_cost += depth * input_tuples * 2.0 * cpu_tuple_cost;
+
+			startup_cost += spill_cost;
+			total_cost += spill_cost;
+		}
 	}
 
 	path->rows = output_tuples;
@@ -2915,18 +3060,22 @@ cached_scansel(PlannerInfo *root, RestrictInfo *rinfo, PathKey *pathkey)
  * 'outer_path' is the outer input to the join
  * 'inner_path' is the inner input to the join
  * 'extra' contains miscellaneous information about the join
+ * 'parallel_hash' indicates that inner_path is partial and that the hash
+ *		table is built by, and shared between, all participants
  */
 void
 initial_cost_hashjoin(PlannerInfo *root, JoinCostWorkspace *workspace,
 					  JoinType jointype,
 					  List *hashclauses,
 					  Path *outer_path, Path *inner_path,
-					  JoinPathExtraData *extra)
+					  JoinPathExtraData *extra,
+					  bool parallel_hash)
 {
 	Cost		startup_cost = 0;
 	Cost		run_cost = 0;
 	double		outer_path_rows = outer_path->rows;
 	double		inner_path_rows = inner_path->rows;
+	double		inner_path_rows_total = inner_path_rows;
 	int			num_hashclauses = list_length(hashclauses);
 	int			numbuckets;
 	int			numbatches;
@@ -2951,6 +3100,13 @@ initial_cost_hashjoin(PlannerInfo *root, JoinCostWorkspace *workspace,
 		* inner_path_rows;
 	run_cost += cpu_operator_cost * num_hashclauses * outer_path_rows;
 
+	/*
+	 * A shared hash table holds the rows of all participants, though each
+	 * participant only hashes its own share of them (charged above).
+	 */
+	if (parallel_hash)
+		inner_path_rows_total *= get_parallel_divisor(inner_path);
+
 	/*
 	 * Get hash table size that executor would use for inner relation.
 	 *
@@ -2961,9 +3117,9 @@ initial_cost_hashjoin(PlannerInfo *root, JoinCostWorkspace *workspace,
 	 * XXX at some point it might be interesting to try to account for skew
 	 * optimization in the cost estimate, but for now, we don't.
 	 */
-	ExecChooseHashTableSize(inner_path_rows,
+	ExecChooseHashTableSize(inner_path_rows_total,
 							inner_path->pathtarget->width,
-							true,	/* useskew */
+							!parallel_hash, /* useskew */
 							&numbuckets,
 							&numbatches,
 							&num_skew_mcvs);
@@ -2995,6 +3151,7 @@ initial_cost_hashjoin(PlannerInfo *root, JoinCostWorkspace *workspace,
 	workspace->run_cost = run_cost;
 	workspace->numbuckets = numbuckets;
 	workspace->numbatches = numbatches;
+	workspace->inner_rows_total = inner_path_rows_total;
 }
 
 /*
@@ -3016,7 +3173,8 @@ final_cost_hashjoin(PlannerInfo *root, HashPath *path,
 	Path	   *outer_path = path->jpath.outerjoinpath;
 	Path	   *inner_path = path->jpath.innerjoinpath;
 	double		outer_path_rows = outer_path->rows;
-	double		inner_path_rows = inner_path->rows;
+	/* every probe sees the whole table, even if it is shared */
+	double		inner_path_rows = workspace->inner_rows_total;
 	List	   *hashclauses = path->path_hashclauses;
 	Cost		startup_cost = workspace->startup_cost;
 	Cost		run_cost = workspace->run_cost;
@@ -3313,6 +3471,133 @@ cost_subplan(PlannerInfo *root, SubPlan *subplan, Plan *plan)
 }
 
 
+/*
+ * cost_memoize_rescan
+ *	  Determines the estimated cost of rescanning a Memoize node.
+ *
+ * In order to estimate this, we must gain knowledge of how often we expect to
+ * be called and how many distinct sets of parameters we are likely to be
+ * called with.  If we expect a good cache hit ratio, then we can set our
+ * costs to account for that hit ratio, plus a little bit of cost for the
+ * caching itself.  Caching will not work out well if we expect to be called
+ * with too many distinct parameter values, or if the tuples for each set of
+ * parameters don't fit in work_mem together.
+ *
+ * The estimated number of cache entries the planner expects to fit is
+ * stored in mpath->est_entries, to size the executor's hash table.
+ */
+static void
+cost_memoize_rescan(PlannerInfo *root, MemoizePath *mpath,
+					Cost *rescan_startup_cost, Cost *rescan_total_cost)
+{
+	Cost		input_startup_cost = mpath->subpath->startup_cost;
+	Cost		input_total_cost = mpath->subpath->total_cost;
+	double		tuples = mpath->subpath->rows;
+	double		calls = mpath->calls;
+	int			width = mpath->subpath->pathtarget->width;
+	double		work_mem_bytes;
+	double		est_entry_bytes;
+	double		est_cache_entries;
+	double		ndistinct;
+	double		evict_ratio;
+	double		hit_ratio;
+	Cost		startup_cost;
+	Cost		total_cost;
+
+	/* available cache space */
+	work_mem_bytes = work_mem * 1024L;
+
+	/*
+	 * Set the number of bytes each cache entry should consume in the cache.
+	 * To provide us with better estimations on how many cache entries we can
+	 * store at once, we make a call to the executor here to ask it what
+	 * memory overheads there are for a single cache entry.
+	 */
+	est_entry_bytes = relation_byte_size(tuples, width) +
+		ExecEstimateCacheEntryOverheadBytes(tuples);
+
+	/* estimate on the upper limit of cache entries we can hold at once */
+	est_cache_entries = floor(work_mem_bytes / est_entry_bytes);
+
+	/* estimate on the distinct number of parameter values */
+	ndistinct = estimate_num_groups(root, mpath->param_exprs, calls, NULL);
+
+	/*
+	 * Since we've already estimated the maximum number of entries we can
+	 * store at once and know the estimated number of distinct values we'll
+	 * be called with, we'll take this opportunity to set the path's
+	 * est_entries.  This will ultimately determine the hash table size that
+	 * the executor will use.  If we leave this at zero, the executor will
+	 * just choose the size itself.  Really this is not the right place to do
+	 * this, but it's convenient, so we'll leave it here for now.
+	 */
+	mpath->est_entries = Min(Min(ndistinct, est_cache_entries),
+							 PG_UINT32_MAX);
+
+	/*
+	 * When the number of distinct parameter values is above the amount we can
+	 * store in the cache, then we'll have to evict some entries from the
+	 * cache.  This is not free.  Here we estimate how often we'll incur the
+	 * cost of that eviction.
+	 */
+	evict_ratio = 1.0 - Min(est_cache_entries, ndistinct) / ndistinct;
+
+	/*
+	 * In order to estimate how many cache hits we'll get, we can just look
+	 * at the number of distinct values we expect to be called with and the
+	 * number of calls, and see what fraction of the distinct values fit in
+	 * the cache.  The first call for each distinct value is always a miss.
+	 */
+	hit_ratio = ((calls - ndistinct) / calls) *
+		(est_cache_entries / Max(ndistinct, est_cache_entries));
+
+	/* Ensure we don't go negative */
+	hit_ratio = Max(hit_ratio, 0.0);
+
+	/*
+	 * Set the total_cost accounting for the expected cache hit ratio.  We
+	 * also add on a cpu_operator_cost to account for a cache lookup.  This
+	 * will happen regardless of whether it's a cache hit or not.
+	 */
+	total_cost = input_total_cost * (1.0 - hit_ratio) + cpu_operator_cost;
+
+	/* Now adjust the total cost to account for cache evictions */
+
+	/* Charge a cpu_tuple_cost for evicting the actual cache entry */
+	total_cost += cpu_tuple_cost * evict_ratio;
+
+	/*
+	 * Charge a 10th of cpu_operator_cost to evict every tuple in that entry.
+	 * The per-tuple eviction is really just a pfree, so charging a whole
+	 * cpu_operator_cost seems a little excessive.
+	 */
+	total_cost += cpu_operator_cost / 10.0 * evict_ratio * tuples;
+
+	/*
+	 * Now adjust for storing things in the cache, since that's not free
+	 * either.  Everything must go in the cache.  We don't proportion this
+	 * over any ratio, just apply it once for the scan.  We charge a
+	 * cpu_tuple_cost for the creation of the cache entry and also a
+	 * cpu_operator_cost for each tuple we expect to cache.
+	 */
+	total_cost += cpu_tuple_cost + cpu_operator_cost * tuples;
+
+	/*
+	 * Getting the first row must also be proportioned according to the
+	 * expected cache hit ratio.
+	 */
+	startup_cost = input_startup_cost * (1.0 - hit_ratio);
+
+	/*
+	 * Additionally we charge a cpu_tuple_cost to account for cache lookups,
+	 * which we'll do regardless of whether it was a cache hit or not.
+	 */
+	startup_cost += cpu_tuple_cost;
+
+	*rescan_startup_cost = startup_cost;
+	*rescan_total_cost = total_cost;
+}
+
 /*
  * cost_rescan
  *		Given a finished Path, estimate the costs of rescanning it after
@@ -3390,6 +3675,11 @@ cost_rescan(PlannerInfo *root, Path *path,
 				*rescan_total_cost = run_cost;
 			}
 			break;
+		case T_Memoize:
+			/* Changes the cost of rescans based on the expected cache hits */
+			cost_memoize_rescan(root, (MemoizePath *) path,
+								rescan_startup_cost, rescan_total_cost);
+			break;
 		case T_Material:
 		case T_Sort:
 			{
@@ -131,6 +131,8 @@ static Relids get_bitmap_tree_required_outer(Path *bitmapqual);
 static void find_indexpath_quals(Path *bitmapqual, List **quals, List **preds);
 static int	find_list_position(Node *node, List **nodelist);
 static bool check_index_only(RelOptInfo *rel, IndexOptInfo *index);
+static bool check_index_skip(IndexOptInfo *index, List *index_clauses,
+				 List *clause_columns);
 static double get_loop_count(PlannerInfo *root, Index cur_relid, Relids outer_relids);
 static double adjust_rowcount_for_semijoins(PlannerInfo *root,
 							  Index cur_relid,
@@ -468,7 +470,7 @@ consider_index_join_clauses(PlannerInfo *root, RelOptInfo *rel,
 	 * relation itself is also included in the relids set.  considered_relids
 	 * lists all relids sets we've already tried.
 	 */
-	for (indexcol = 0; indexcol < index->ncolumns; indexcol++)
+	for (indexcol = 0; indexcol < index->nkeycolumns; indexcol++)
 	{
 		/* Consider each applicable simple join clause */
 		considered_clauses += list_length(jclauseset->indexclauses[indexcol]);
@@ -622,7 +624,7 @@ get_join_index_paths(PlannerInfo *root, RelOptInfo *rel,
 	/* Identify indexclauses usable with this relids set */
 	MemSet(&clauseset, 0, sizeof(clauseset));
 
-	for (indexcol = 0; indexcol < index->ncolumns; indexcol++)
+	for (indexcol = 0; indexcol < index->nkeycolumns; indexcol++)
 	{
 		ListCell   *lc;
 
@@ -791,7 +793,7 @@ get_index_paths(PlannerInfo *root, RelOptInfo *rel,
 		if (index->amhasgettuple)
 			add_path(rel, (Path *) ipath);
 
-		if (index->amhasgetbitmap &&
+		if (index->amhasgetbitmap && !ipath->indexskip &&
 			(ipath->path.pathkeys == NIL ||
 			 ipath->indexselectivity < 1.0))
 			*bitindexpaths = lappend(*bitindexpaths, ipath);
@@ -877,6 +879,7 @@ build_index_paths(PlannerInfo *root, RelOptInfo *rel,
 	bool		pathkeys_possibly_useful;
 	bool		index_is_ordered;
 	bool		index_only_scan;
+	bool		index_skip_scan;
 	int			indexcol;
 
 	/*
@@ -922,7 +925,7 @@ build_index_paths(PlannerInfo *root, RelOptInfo *rel,
 	clause_columns = NIL;
 	found_lower_saop_clause = false;
 	outer_relids = bms_copy(rel->lateral_relids);
-	for (indexcol = 0; indexcol < index->ncolumns; indexcol++)
+	for (indexcol = 0; indexcol < index->nkeycolumns; indexcol++)
 	{
 		ListCell   *lc;
 
@@ -1026,6 +1029,15 @@ build_index_paths(PlannerInfo *root, RelOptInfo *rel,
 	index_only_scan = (scantype != ST_BITMAPSCAN &&
 					   check_index_only(rel, index));
 
+	/*
+	 * 3a. Check if a skip scan is possible, that is, whether the index AM
+	 * could probe the index once per distinct value of the first column
+	 * instead of reading all of it.  This only matters if the first column
+	 * has no clauses but a later one does.
+	 */
+	index_skip_scan = (scantype != ST_BITMAPSCAN &&
+					   check_index_skip(index, index_clauses, clause_columns));
+
 	/*
 	 * 4. Generate an indexscan path if there are relevant restriction clauses
 	 * in the current clauses, OR the index ordering is potentially useful for
@@ -1045,11 +1057,36 @@ build_index_paths(PlannerInfo *root, RelOptInfo *rel,
 								  ForwardScanDirection :
 								  NoMovementScanDirection,
 								  index_only_scan,
+								  false,
 								  outer_relids,
 								  loop_count,
 								  false);
 		result = lappend(result, ipath);
 
+		/*
+		 * If appropriate, consider a skip scan too.  It returns the same rows
+		 * in the same order, so it competes with the plain path on cost
+		 * alone.
+		 */
+		if (index_skip_scan)
+		{
+			ipath = create_index_path(root, index,
+									  index_clauses,
+									  clause_columns,
+									  orderbyclauses,
+									  orderbyclausecols,
+									  useful_pathkeys,
+									  index_is_ordered ?
+									  ForwardScanDirection :
+									  NoMovementScanDirection,
+									  index_only_scan,
+									  true,
+									  outer_relids,
+									  loop_count,
+									  false);
+			result = lappend(result, ipath);
+		}
+
 		/*
 		 * If appropriate, consider parallel index scan.  We don't allow
 		 * parallel index scan for bitmap index scans.
@@ -1068,6 +1105,7 @@ build_index_paths(PlannerInfo *root, RelOptInfo *rel,
 									  ForwardScanDirection :
 									  NoMovementScanDirection,
 									  index_only_scan,
+									  false,
 									  outer_relids,
 									  loop_count,
 									  true);
@@ -1102,11 +1140,30 @@ build_index_paths(PlannerInfo *root, RelOptInfo *rel,
 									  useful_pathkeys,
 									  BackwardScanDirection,
 									  index_only_scan,
+									  false,
 									  outer_relids,
 									  loop_count,
 									  false);
 			result = lappend(result, ipath);
 
+			/* If appropriate, consider a backwards skip scan too */
+			if (index_skip_scan)
+			{
+				ipath = create_index_path(root, index,
+										  index_clauses,
+										  clause_columns,
+										  NIL,
+										  NIL,
+										  useful_pathkeys,
+										  BackwardScanDirection,
+										  index_only_scan,
+										  true,
+										  outer_relids,
+										  loop_count,
+										  false);
+				result = lappend(result, ipath);
+			}
+
 			/* If appropriate, consider parallel index scan */
 			if (index->amcanparallel &&
 				rel->consider_parallel && outer_relids == NULL &&
@@ -1120,6 +1177,7 @@ build_index_paths(PlannerInfo *root, RelOptInfo *rel,
 										  useful_pathkeys,
 										  BackwardScanDirection,
 										  index_only_scan,
+										  false,
 										  outer_relids,
 										  loop_count,
 										  true);
@@ -1933,6 +1991,48 @@ check_index_only(RelOptInfo *rel, IndexOptInfo *index)
 	return result;
 }
 
+/*
+ * check_index_skip
+ *		Determine whether a skip scan is possible and worth considering for
+ *		an index scan with the given index clauses.
+ *
+ * We want a clause on the second index column and none on the first, since
+ * the point is to use the second column's clauses to bound each probe.  The
+ * index AM doesn't handle ScalarArrayOpExpr or RowCompareExpr clauses in a
+ * skip scan, so don't ask for one if there are any.
+ */
+static bool
+check_index_skip(IndexOptInfo *index, List *index_clauses,
+				 List *clause_columns)
+{
+	bool		found_second = false;
+	ListCell   *lc;
+	ListCell   *lcc;
+
+	/* Skip scans must be enabled */
+	if (!enable_indexskipscan)
+		return false;
+
+	if (!index->amcanskip || index->nkeycolumns < 2)
+		return false;
+
+	forboth(lc, index_clauses, lcc, clause_columns)
+	{
+		RestrictInfo *rinfo = (RestrictInfo *) lfirst(lc);
+		int			indexcol = lfirst_int(lcc);
+
+		if (indexcol == 0)
+			return false;
+		if (IsA(rinfo->clause, ScalarArrayOpExpr) ||
+			IsA(rinfo->clause, RowCompareExpr))
+			return false;
+		if (indexcol == 1)
+			found_second = true;
+	}
+
+	return found_second;
+}
+
 /*
  * get_loop_count
  *		Choose the loop count estimate to use for costing a parameterized path
@@ -2151,7 +2251,7 @@ match_eclass_clauses_to_index(PlannerInfo *root, IndexOptInfo *index,
 	if (!index->rel->has_eclass_joins)
 		return;
 
-	for (indexcol = 0; indexcol < index->ncolumns; indexcol++)
+	for (indexcol = 0; indexcol < index->nkeycolumns; indexcol++)
 	{
 		ec_member_matches_arg arg;
 		List	   *clauses;
@@ -2234,7 +2334,7 @@ match_clause_to_index(IndexOptInfo *index,
 		return;
 
 	/* OK, check each index column for a match */
-	for (indexcol = 0; indexcol < index->ncolumns; indexcol++)
+	for (indexcol = 0; indexcol < index->nkeycolumns; indexcol++)
 	{
 		if (match_clause_to_indexcol(index,
 									 indexcol,
@@ -2607,7 +2707,7 @@ match_pathkeys_to_index(IndexOptInfo *index, List *pathkeys,
 			 * amcanorderbyop.  We might need different logic in future for
 			 * other implementations.
 			 */
-			for (indexcol = 0; indexcol < index->ncolumns; indexcol++)
+			for (indexcol = 0; indexcol < index->nkeycolumns; indexcol++)
 			{
 				Expr	   *expr;
 
@@ -3028,7 +3128,7 @@ relation_has_unique_index_for(PlannerInfo *root, RelOptInfo *rel,
 		 * Try to find each index column in the lists of conditions.  This is
 		 * O(N^2) or worse, but we expect all the lists to be short.
 		 */
-		for (c = 0; c < ind->ncolumns; c++)
+		for (c = 0; c < ind->nkeycolumns; c++)
 		{
 			bool		matched = false;
 			ListCell   *lc;
@@ -3104,7 +3204,7 @@ relation_has_unique_index_for(PlannerInfo *root, RelOptInfo *rel,
 		}
 
 		/* Matched all columns of this index? */
-		if (c == ind->ncolumns)
+		if (c == ind->nkeycolumns)
 			return true;
 	}
 
@@ -3907,7 +4007,7 @@ adjust_rowcompare_for_index(RowCompareExpr *clause,
 		/*
 		 * The Var side can match any column of the index.
 		 */
-		for (i = 0; i < index->ncolumns; i++)
+		for (i = 0; i < index->nkeycolumns; i++)
 		{
 			if (match_index_to_operand(varop, i, index) &&
 				get_op_opfamily_strategy(expr_op,
@@ -3916,7 +4016,7 @@ adjust_rowcompare_for_index(RowCompareExpr *clause,
 										 lfirst_oid(collids_cell)))
 				break;
 		}
-		if (i >= index->ncolumns)
+		if (i >= index->nkeycolumns)
 			break;				/* no match found */
 
 		/* Add column number to returned list */
@@ -17,11 +17,15 @@
 #include <math.h>
 
 #include "executor/executor.h"
+#include "executor/incmeta.h"
 #include "foreign/fdwapi.h"
+#include "nodes/nodeFuncs.h"
+#include "optimizer/clauses.h"
 #include "optimizer/cost.h"
 #include "optimizer/pathnode.h"
 #include "optimizer/paths.h"
 #include "optimizer/planmain.h"
+#include "utils/lsyscache.h"
 
 /* Hook for plugins to get control in add_paths_to_joinrel() */
 set_join_pathlist_hook_type set_join_pathlist_hook = NULL;
@@ -332,6 +336,140 @@ allow_star_schema_join(PlannerInfo *root,
 			bms_nonempty_difference(innerparams, outerrelids));
 }
 
+/*
+ * paraminfo_get_equal_hashops
+ *		Determine whether the join clauses a parameterized inner path is
+ *		parameterized by can serve as the cache key of a Memoize node.  If so,
+ *		set *param_exprs to their outer-side expressions and *operators to the
+ *		hashable equality operators to compare them with, and return true.
+ */
+static bool
+paraminfo_get_equal_hashops(ParamPathInfo *param_info, RelOptInfo *outerrel,
+							RelOptInfo *innerrel, List **param_exprs,
+							List **operators)
+{
+	ListCell   *lc;
+
+	*param_exprs = NIL;
+	*operators = NIL;
+
+	foreach(lc, param_info->ppi_clauses)
+	{
+		RestrictInfo *rinfo = (RestrictInfo *) lfirst(lc);
+		OpExpr	   *opexpr;
+		Node	   *expr;
+		Oid			lefttype;
+		Oid			righttype;
+
+		/* We can only use binary operator clauses */
+		if (!is_opclause(rinfo->clause) ||
+			list_length(((OpExpr *) rinfo->clause)->args) != 2)
+			return false;
+		opexpr = (OpExpr *) rinfo->clause;
+
+		/* Find the argument that is computed from the outer rel */
+		if (bms_is_subset(rinfo->left_relids, outerrel->relids) &&
+			bms_is_subset(rinfo->right_relids, innerrel->relids))
+			expr = (Node *) linitial(opexpr->args);
+		else if (bms_is_subset(rinfo->left_relids, innerrel->relids) &&
+				 bms_is_subset(rinfo->right_relids, outerrel->relids))
+			expr = (Node *) lsecond(opexpr->args);
+		else
+			return false;
+
+		/*
+		 * Two cache keys are compared with the clause's own operator, so it
+		 * must be a hashable equality between values of the same type.
+		 */
+		op_input_types(opexpr->opno, &lefttype, &righttype);
+		if (lefttype != righttype ||
+			!op_hashjoinable(opexpr->opno, lefttype) ||
+			contain_volatile_functions((Node *) rinfo->clause))
+			return false;
+
+		*operators = lappend_oid(*operators, opexpr->opno);
+		*param_exprs = lappend(*param_exprs, expr);
+	}
+
+	return *param_exprs != NIL;
+}
+
+/*
+ * get_memoize_path
+ *		If possible, make and return a Memoize path atop of 'inner_path'.
+ *		Otherwise return NULL.
+ *
+ * We only cache base relation scans parameterized by the outer rel: their
+ * parameters all come from the join clauses in their ParamPathInfo, so the
+ * values of those clauses' outer sides identify a scan's result.
+ */
+static Path *
+get_memoize_path(PlannerInfo *root, RelOptInfo *innerrel,
+				 RelOptInfo *outerrel, Path *inner_path,
+				 Path *outer_path)
+{
+	List	   *param_exprs;
+	List	   *hash_operators;
+	ListCell   *lc;
+
+	/* Obviously not if it's disabled */
+	if (!enable_memoize)
+		return NULL;
+
+	/* The incremental executor has no delta handling for Memoize nodes */
+	if (enable_incremental)
+		return NULL;
+
+	/*
+	 * We can safely not bother with all this unless we expect to perform
+	 * more than one inner scan.  The first scan is always going to be a cache
+	 * miss.  This would likely fail later anyway based on costs, so this is
+	 * really just to save some wasted effort.
+	 */
+	if (outer_path->parent->rows < 2)
+		return NULL;
+
+	/* We can only have a memoize node when there's some kind of cache key */
+	if (inner_path->param_info == NULL ||
+		inner_path->param_info->ppi_clauses == NIL)
+		return NULL;
+
+	if (!bms_is_subset(PATH_REQ_OUTER(inner_path), outerrel->relids))
+		return NULL;
+
+	/*
+	 * Join rels and lateral references can use outer values that don't
+	 * appear in ppi_clauses, which would make the cache return wrong results.
+	 */
+	if (innerrel->reloptkind != RELOPT_BASEREL ||
+		!bms_is_empty(innerrel->lateral_relids))
+		return NULL;
+
+	/*
+	 * We can't cache the results of scans whose quals might give a different
+	 * answer each time they're evaluated.
+	 */
+	foreach(lc, innerrel->baserestrictinfo)
+	{
+		RestrictInfo *rinfo = (RestrictInfo *) lfirst(lc);
+
+		if (contain_volatile_functions((Node *) rinfo->clause))
+			return NULL;
+	}
+
+	/* Check if we have hash ops for each parameter to the path */
+	if (!paraminfo_get_equal_hashops(inner_path->param_info, outerrel,
+									 innerrel, &param_exprs, &hash_operators))
+		return NULL;
+
+	return (Path *) create_memoize_path(root,
+										innerrel,
+										inner_path,
+										param_exprs,
+										hash_operators,
+										outer_path->rows);
+}
+
 /*
  * try_nestloop_path
  *	  Consider a nestloop join path; if it appears useful, push it into
@@ -660,7 +798,7 @@ try_hashjoin_path(PlannerInfo *root,
 	 * never have any output pathkeys, per comments in create_hashjoin_path.
 	 */
 	initial_cost_hashjoin(root, &workspace, jointype, hashclauses,
-						  outer_path, inner_path, extra);
+						  outer_path, inner_path, extra, false);
 
 	if (add_path_precheck(joinrel,
 						  workspace.startup_cost, workspace.total_cost,
@@ -674,6 +812,7 @@ try_hashjoin_path(PlannerInfo *root,
 									  extra,
 									  outer_path,
 									  inner_path,
+									  false,	/* parallel_hash */
 									  extra->restrictlist,
 									  required_outer,
 									  hashclauses));
@@ -689,6 +828,9 @@ try_hashjoin_path(PlannerInfo *root,
  * try_partial_hashjoin_path
  *	  Consider a partial hashjoin join path; if it appears useful, push it into
  *	  the joinrel's partial_pathlist via add_partial_path().
+ *	  With parallel_hash, inner_path is partial too and all participants
+ *	  build one shared hash table; that is only done when it fits in a
+ *	  single batch.
  */
 static void
 try_partial_hashjoin_path(PlannerInfo *root,
@@ -697,7 +839,8 @@ try_partial_hashjoin_path(PlannerInfo *root,
 						  Path *inner_path,
 						  List *hashclauses,
 						  JoinType jointype,
-						  JoinPathExtraData *extra)
+						  JoinPathExtraData *extra,
+						  bool parallel_hash)
 {
 	JoinCostWorkspace workspace;
 
@@ -721,7 +864,9 @@ try_partial_hashjoin_path(PlannerInfo *root,
 	 * cost.  Bail out right away if it looks terrible.
 	 */
 	initial_cost_hashjoin(root, &workspace, jointype, hashclauses,
-						  outer_path, inner_path, extra);
+						  outer_path, inner_path, extra, parallel_hash);
+	if (parallel_hash && workspace.numbatches > 1)
+		return;
 	if (!add_partial_path_precheck(joinrel, workspace.total_cost, NIL))
 		return;
 
@@ -734,6 +879,7 @@ try_partial_hashjoin_path(PlannerInfo *root,
 										  extra,
 										  outer_path,
 										  inner_path,
+										  parallel_hash,
 										  extra->restrictlist,
 										  NULL,
 										  hashclauses));
@@ -1377,6 +1523,7 @@ match_unsorted_outer(PlannerInfo *root,
 			foreach(lc2, innerrel->cheapest_parameterized_paths)
 			{
 				Path	   *innerpath = (Path *) lfirst(lc2);
+				Path	   *mpath;
 
 				try_nestloop_path(root,
 								  joinrel,
@@ -1385,6 +1532,21 @@ match_unsorted_outer(PlannerInfo *root,
 								  merge_pathkeys,
 								  jointype,
 								  extra);
+
+				/*
+				 * Try generating a memoize path and see if that makes the
+				 * nested loop any cheaper.
+				 */
+				mpath = get_memoize_path(root, innerrel, outerrel,
+										 innerpath, outerpath);
+				if (mpath != NULL)
+					try_nestloop_path(root,
+									  joinrel,
+									  outerpath,
+									  mpath,
+									  merge_pathkeys,
+									  jointype,
+									  extra);
 			}
 
 			/* Also consider materialized form of the cheapest inner path */
@@ -1783,7 +1945,30 @@ hash_inner_and_outer(PlannerInfo *root,
 				try_partial_hashjoin_path(root, joinrel,
 										  cheapest_partial_outer,
 										  cheapest_safe_inner,
-										  hashclauses, jointype, extra);
+										  hashclauses, jointype, extra,
+										  false);
+
+			/*
+			 * If the inner side can be partial too, try building one shared
+			 * hash table from all participants' shares instead of having
+			 * each of them hash the whole inner relation.  That can't work
+			 * for JOIN_UNIQUE_INNER, which needs all inner rows in one place
+			 * to unique-ify them.
+			 */
+			if (enable_parallel_hash &&
+				save_jointype != JOIN_UNIQUE_INNER &&
+				innerrel->partial_pathlist != NIL)
+			{
+				Path	   *cheapest_partial_inner;
+
+				cheapest_partial_inner =
+					(Path *) linitial(innerrel->partial_pathlist);
+				try_partial_hashjoin_path(root, joinrel,
+										  cheapest_partial_outer,
+										  cheapest_partial_inner,
+										  hashclauses, jointype, extra,
+										  true);
+			}
 		}
 	}
 }
@@ -22,6 +22,7 @@
 #include "nodes/nodeFuncs.h"
 #include "nodes/plannodes.h"
 #include "optimizer/clauses.h"
+#include "optimizer/cost.h"
 #include "optimizer/pathnode.h"
 #include "optimizer/paths.h"
 #include "optimizer/tlist.h"
@@ -327,6 +328,33 @@ pathkeys_contained_in(List *keys1, List *keys2)
 	return false;
 }
 
+/*
+ * pathkeys_count_contained_in
+ *	  Same as pathkeys_contained_in, but also sets *n_common to the length
+ *	  of the longest common prefix of keys1 and keys2.
+ */
+bool
+pathkeys_count_contained_in(List *keys1, List *keys2, int *n_common)
+{
+	int			n = 0;
+	ListCell   *key1,
+			   *key2;
+
+	/* Pathkeys are canonical, so pointer comparison is enough */
+	forboth(key1, keys1, key2, keys2)
+	{
+		if (lfirst(key1) != lfirst(key2))
+		{
+			*n_common = n;
+			return false;
+		}
+		n++;
+	}
+
+	*n_common = n;
+	return (key1 == NULL);
+}
+
 /*
  * get_cheapest_path_for_pathkeys
  *	  Find the cheapest path (according to the specified criterion) that
@@ -477,6 +505,10 @@ build_index_pathkeys(PlannerInfo *root,
 		bool		nulls_first;
 		PathKey    *cpathkey;
 
+		/* included columns are not part of the sort order */
+		if (i >= index->nkeycolumns)
+			break;
+
 		/* We assume we don't need to make a copy of the tlist item */
 		indexkey = indextle->expr;
 
@@ -1488,25 +1520,32 @@ right_merge_direction(PlannerInfo *root, PathKey *pathkey)
  *		Count the number of pathkeys that are useful for meeting the
  *		query's requested output ordering.
  *
- * Unlike merge pathkeys, this is an all-or-nothing affair: it does us
- * no good to order by just the first key(s) of the requested ordering.
- * So the result is always either 0 or list_length(root->query_pathkeys).
+ * A path ordered by just the first key(s) of the requested ordering is
+ * useful too, since an incremental sort can finish the job.  Without
+ * incremental sort this is an all-or-nothing affair, and the result is
+ * always either 0 or list_length(root->query_pathkeys).
  */
 static int
 pathkeys_useful_for_ordering(PlannerInfo *root, List *pathkeys)
 {
+	int			n_common_pathkeys;
+
 	if (root->query_pathkeys == NIL)
 		return 0;				/* no special ordering requested */
 
 	if (pathkeys == NIL)
 		return 0;				/* unordered path */
 
-	if (pathkeys_contained_in(root->query_pathkeys, pathkeys))
+	if (pathkeys_count_contained_in(root->query_pathkeys, pathkeys,
+									&n_common_pathkeys))
 	{
 		/* It's useful ... or at least the first N keys are */
 		return list_length(root->query_pathkeys);
 	}
 
+	if (enable_incremental_sort)
+		return n_common_pathkeys;
+
 	return 0;					/* path ordering not useful */
 }
 
@@ -29,6 +29,7 @@
 #include "nodes/nodeFuncs.h"
 #include "optimizer/clauses.h"
 #include "optimizer/cost.h"
+#include "optimizer/partprune.h"
 #include "optimizer/paths.h"
 #include "optimizer/placeholder.h"
 #include "optimizer/plancat.h"
@@ -80,16 +81,23 @@ static Plan *create_gating_plan(PlannerInfo *root, Path *path, Plan *plan,
 static Plan *create_join_plan(PlannerInfo *root, JoinPath *best_path);
 static Plan *create_append_plan(PlannerInfo *root, AppendPath *best_path);
 static Plan *create_merge_append_plan(PlannerInfo *root, MergeAppendPath *best_path);
+static PartitionPruneInfo *make_append_pruneinfo(PlannerInfo *root,
+					  Path *best_path, List *subpaths);
 static Result *create_result_plan(PlannerInfo *root, ResultPath *best_path);
 static ProjectSet *create_project_set_plan(PlannerInfo *root, ProjectSetPath *best_path);
 static Material *create_material_plan(PlannerInfo *root, MaterialPath *best_path,
 					 int flags);
+static Memoize *create_memoize_plan(PlannerInfo *root, MemoizePath *best_path,
+					int flags);
 static Plan *create_unique_plan(PlannerInfo *root, UniquePath *best_path,
 				   int flags);
 static Gather *create_gather_plan(PlannerInfo *root, GatherPath *best_path);
 static Plan *create_projection_plan(PlannerInfo *root, ProjectionPath *best_path);
 static Plan *inject_projection_plan(Plan *subplan, List *tlist, bool parallel_safe);
+static bool mark_async_capable_plan(Plan *plan, Path *path);
 static Sort *create_sort_plan(PlannerInfo *root, SortPath *best_path, int flags);
+static IncrementalSort *create_incrementalsort_plan(PlannerInfo *root,
+							IncrementalSortPath *best_path, int flags);
 static Group *create_group_plan(PlannerInfo *root, GroupPath *best_path);
 static Unique *create_upper_unique_plan(PlannerInfo *root, UpperUniquePath *best_path,
 						 int flags);
@@ -151,8 +159,12 @@ static CustomScan *create_customscan_plan(PlannerInfo *root,
 static NestLoop *create_nestloop_plan(PlannerInfo *root, NestPath *best_path);
 static MergeJoin *create_mergejoin_plan(PlannerInfo *root, MergePath *best_path);
 static HashJoin *create_hashjoin_plan(PlannerInfo *root, HashPath *best_path);
+static void attach_hashjoin_runtime_filter(PlannerInfo *root,
+							   HashJoin *join_plan, HashPath *best_path);
+static Scan *find_runtime_filter_target(Plan *plan, Index relid);
 static Node *replace_nestloop_params(PlannerInfo *root, Node *expr);
 static Node *replace_nestloop_params_mutator(Node *node, PlannerInfo *root);
+static bool pull_paramids_walker(Node *node, Bitmapset **context);
 static void process_subquery_nestloop_params(PlannerInfo *root,
 								 List *subplan_params);
 static List *fix_indexqual_references(PlannerInfo *root, IndexPath *index_path);
@@ -171,12 +183,12 @@ static IndexScan *make_indexscan(List *qptlist, List *qpqual, Index scanrelid,
 			   Oid indexid, List *indexqual, List *indexqualorig,
 			   List *indexorderby, List *indexorderbyorig,
 			   List *indexorderbyops,
-			   ScanDirection indexscandir);
+			   ScanDirection indexscandir, bool indexskip);
 static IndexOnlyScan *make_indexonlyscan(List *qptlist, List *qpqual,
 				   Index scanrelid, Oid indexid,
 				   List *indexqual, List *indexorderby,
 				   List *indextlist,
-				   ScanDirection indexscandir);
+				   ScanDirection indexscandir, bool indexskip);
 static BitmapIndexScan *make_bitmap_indexscan(Index scanrelid, Oid indexid,
 					  List *indexqual,
 					  List *indexqualorig);
@@ -250,11 +262,18 @@ static Plan *prepare_sort_from_pathkeys(Plan *lefttree, List *pathkeys,
 static EquivalenceMember *find_ec_member_for_tle(EquivalenceClass *ec,
 					   TargetEntry *tle,
 					   Relids relids);
-static Sort *make_sort_from_pathkeys(Plan *lefttree, List *pathkeys);
+static Sort *make_sort_from_pathkeys(Plan *lefttree, List *pathkeys,
+						Relids relids);
+static IncrementalSort *make_incrementalsort_from_pathkeys(Plan *lefttree,
+								   List *pathkeys, Relids relids,
+								   int nPresortedCols);
 static Sort *make_sort_from_groupcols(List *groupcls,
 						 AttrNumber *grpColIdx,
 						 Plan *lefttree);
 static Material *make_material(Plan *lefttree);
+static Memoize *make_memoize(Plan *lefttree, Oid *hashoperators,
+			 Oid *collations, List *param_exprs,
+			 uint32 est_entries, Bitmapset *keyparamids);
 static WindowAgg *make_windowagg(List *tlist, Index winref,
 			   int partNumCols, AttrNumber *partColIdx, Oid *partOperators,
 			   int ordNumCols, AttrNumber *ordColIdx, Oid *ordOperators,
@@ -415,6 +434,11 @@ create_plan_recurse(PlannerInfo *root, Path *best_path, int flags)
 												 (MaterialPath *) best_path,
 												 flags);
 			break;
+		case T_Memoize:
+			plan = (Plan *) create_memoize_plan(root,
+												(MemoizePath *) best_path,
+												flags);
+			break;
 		case T_Unique:
 			if (IsA(best_path, UpperUniquePath))
 			{
@@ -439,6 +463,11 @@ create_plan_recurse(PlannerInfo *root, Path *best_path, int flags)
 											 (SortPath *) best_path,
 											 flags);
 			break;
+		case T_IncrementalSort:
+			plan = (Plan *) create_incrementalsort_plan(root,
+														(IncrementalSortPath *) best_path,
+														flags);
+			break;
 		case T_Group:
 			plan = (Plan *) create_group_plan(root,
 											  (GroupPath *) best_path);
@@ -1039,6 +1068,10 @@ create_append_plan(PlannerInfo *root, AppendPath *best_path)
 		/* Must insist that all children return the same tlist */
 		subplan = create_plan_recurse(root, subpath, CP_EXACT_TLIST);
 
+		/* Let the executor run it asynchronously, if it can */
+		if (enable_async_append)
+			(void) mark_async_capable_plan(subplan, subpath);
+
 		subplans = lappend(subplans, subplan);
 	}
 
@@ -1050,12 +1083,51 @@ create_append_plan(PlannerInfo *root, AppendPath *best_path)
 	 */
 
 	plan = make_append(subplans, tlist, best_path->partitioned_rels);
+	plan->part_prune_info = make_append_pruneinfo(root, &best_path->path,
+												  best_path->subpaths);
 
 	copy_generic_path_info(&plan->plan, (Path *) best_path);
 
 	return (Plan *) plan;
 }
 
+/*
+ * mark_async_capable_plan
+ *		Check whether the Plan node created from a Path node is async-capable,
+ *		and if so, mark the Plan node as such and return true, otherwise
+ *		return false.
+ */
+static bool
+mark_async_capable_plan(Plan *plan, Path *path)
+{
+	switch (nodeTag(path))
+	{
+		case T_ForeignPath:
+			{
+				FdwRoutine *fdwroutine = path->parent->fdwroutine;
+
+				/*
+				 * If the generated plan node includes a gating Result node,
+				 * we can't execute it asynchronously.
+				 */
+				if (IsA(plan, Result))
+					return false;
+
+				Assert(fdwroutine != NULL);
+				if (fdwroutine->IsForeignPathAsyncCapable == NULL ||
+					!fdwroutine->IsForeignPathAsyncCapable((ForeignPath *) path))
+					return false;
+			}
+			break;
+		default:
+			return false;
+	}
+
+	plan->async_capable = true;
+
+	return true;
+}
+
 /*
  * create_merge_append_plan
  *	  Create a MergeAppend plan for 'best_path' and (recursively) plans
@@ -1159,10 +1231,46 @@ create_merge_append_plan(PlannerInfo *root, MergeAppendPath *best_path)
 
 	node->partitioned_rels = best_path->partitioned_rels;
 	node->mergeplans = subplans;
+	node->part_prune_info = make_append_pruneinfo(root, &best_path->path,
+												  best_path->subpaths);
 
 	return (Plan *) node;
 }
 
+/*
+ * make_append_pruneinfo
+ *	  Build the run-time partition pruning info for an Append or MergeAppend
+ *	  path scanning a partitioned table, or return NULL if there is none.
+ *
+ * The table's restriction clauses are usable, and so are the join clauses
+ * of a parameterized path, after replacing the outer Vars with the nestloop
+ * Params that will supply them.
+ */
+static PartitionPruneInfo *
+make_append_pruneinfo(PlannerInfo *root, Path *best_path, List *subpaths)
+{
+	RelOptInfo *rel = best_path->parent;
+	List	   *prunequals;
+
+	if (!enable_partition_pruning ||
+		rel->reloptkind != RELOPT_BASEREL ||
+		planner_rt_fetch(rel->relid, root)->relkind != RELKIND_PARTITIONED_TABLE)
+		return NULL;
+
+	prunequals = extract_actual_clauses(rel->baserestrictinfo, false);
+	if (best_path->param_info)
+	{
+		List	   *joinquals;
+
+		joinquals = extract_actual_clauses(best_path->param_info->ppi_clauses,
+										   false);
+		joinquals = (List *) replace_nestloop_params(root, (Node *) joinquals);
+		prunequals = list_concat(prunequals, joinquals);
+	}
+
+	return make_partition_pruneinfo(root, rel, subpaths, prunequals);
+}
+
 /*
  * create_result_plan
  *	  Create a Result plan for 'best_path'.
@@ -1243,6 +1351,65 @@ create_material_plan(PlannerInfo *root, MaterialPath *best_path, int flags)
 	return plan;
 }
 
+/*
+ * create_memoize_plan
+ *	  Create a Memoize plan for 'best_path' and (recursively) plans for its
+ *	  subpaths.
+ *
+ *	  Returns a Plan node.
+ */
+static Memoize *
+create_memoize_plan(PlannerInfo *root, MemoizePath *best_path, int flags)
+{
+	Memoize    *plan;
+	Bitmapset  *keyparamids;
+	Plan	   *subplan;
+	Oid		   *operators;
+	Oid		   *collations;
+	List	   *param_exprs;
+	ListCell   *lc;
+	ListCell   *lc2;
+	int			nkeys;
+	int			i;
+
+	/* As for Material, we don't want excess columns in cached tuples */
+	subplan = create_plan_recurse(root, best_path->subpath,
+								  flags | CP_SMALL_TLIST);
+
+	/*
+	 * The cache keys are outer-relation expressions; turn their Vars into
+	 * the same nestloop Params the subplan is parameterized by.
+	 */
+	param_exprs = (List *) replace_nestloop_params(root,
+												   (Node *) best_path->param_exprs);
+
+	nkeys = list_length(param_exprs);
+	Assert(nkeys > 0);
+	operators = palloc(nkeys * sizeof(Oid));
+	collations = palloc(nkeys * sizeof(Oid));
+
+	i = 0;
+	forboth(lc, param_exprs, lc2, best_path->hash_operators)
+	{
+		Expr	   *param_expr = (Expr *) lfirst(lc);
+		Oid			opno = lfirst_oid(lc2);
+
+		operators[i] = opno;
+		collations[i] = exprCollation((Node *) param_expr);
+		i++;
+	}
+
+	keyparamids = NULL;
+	(void) pull_paramids_walker((Node *) param_exprs, &keyparamids);
+
+	plan = make_memoize(subplan, operators, collations, param_exprs,
+						best_path->est_entries, keyparamids);
+
+	copy_generic_path_info(&plan->plan, (Path *) best_path);
+
+	return plan;
+}
+
 /*
  * create_unique_plan
  *	  Create a Unique plan for 'best_path' and (recursively) plans
@@ -1652,13 +1819,46 @@ create_sort_plan(PlannerInfo *root, SortPath *best_path, int flags)
 	subplan = create_plan_recurse(root, best_path->subpath,
 								  flags | CP_SMALL_TLIST);
 
-	plan = make_sort_from_pathkeys(subplan, best_path->path.pathkeys);
+	/*
+	 * A child relation's pathkeys name the parent's equivalence classes;
+	 * tell prepare_sort_from_pathkeys which child members may match.
+	 */
+	plan = make_sort_from_pathkeys(subplan, best_path->path.pathkeys,
+								   IS_OTHER_REL(best_path->subpath->parent) ?
+								   best_path->path.parent->relids : NULL);
 
 	copy_generic_path_info(&plan->plan, (Path *) best_path);
 
 	return plan;
 }
 
+/*
+ * create_incrementalsort_plan
+ *
+ *	  Do the same as create_sort_plan, but create IncrementalSort plan.
+ */
+static IncrementalSort *
+create_incrementalsort_plan(PlannerInfo *root, IncrementalSortPath *best_path,
+							int flags)
+{
+	IncrementalSort *plan;
+	Plan	   *subplan;
+
+	/* See comments in create_sort_plan() above */
+	subplan = create_plan_recurse(root, best_path->spath.subpath,
+								  flags | CP_SMALL_TLIST);
+
+	plan = make_incrementalsort_from_pathkeys(subplan,
+											  best_path->spath.path.pathkeys,
+											  IS_OTHER_REL(best_path->spath.subpath->parent) ?
+											  best_path->spath.path.parent->relids : NULL,
+											  best_path->nPresortedCols);
+
+	copy_generic_path_info(&plan->sort.plan, (Path *) best_path);
+
+	return plan;
+}
+
 /*
  * create_group_plan
  *
@@ -2653,7 +2853,8 @@ create_indexscan_plan(PlannerInfo *root,
 												fixed_indexquals,
 												fixed_indexorderbys,
 												best_path->indexinfo->indextlist,
-												best_path->indexscandir);
+												best_path->indexscandir,
+												best_path->indexskip);
 	else
 		scan_plan = (Scan *) make_indexscan(tlist,
 											qpqual,
@@ -2664,7 +2865,8 @@ create_indexscan_plan(PlannerInfo *root,
 											fixed_indexorderbys,
 											indexorderbys,
 											indexorderbyops,
-											best_path->indexscandir);
+											best_path->indexscandir,
+											best_path->indexskip);
 
 	copy_generic_path_info(&scan_plan->plan, &best_path->path);
 
@@ -3757,6 +3959,8 @@ create_mergejoin_plan(PlannerInfo *root,
 	Plan	   *outer_plan;
 	Plan	   *inner_plan;
 	List	   *tlist = build_path_tlist(root, &best_path->jpath.path);
+	Path	   *outer_path = best_path->jpath.outerjoinpath;
+	Path	   *inner_path = best_path->jpath.innerjoinpath;
 	List	   *joinclauses;
 	List	   *otherclauses;
 	List	   *mergeclauses;
@@ -3834,8 +4038,10 @@ create_mergejoin_plan(PlannerInfo *root,
 	 */
 	if (best_path->outersortkeys)
 	{
+		Relids		outer_relids = outer_path->parent->relids;
 		Sort	   *sort = make_sort_from_pathkeys(outer_plan,
-												   best_path->outersortkeys);
+												   best_path->outersortkeys,
+												   outer_relids);
 
 		label_sort_with_costsize(root, sort, -1.0);
 		outer_plan = (Plan *) sort;
@@ -3846,8 +4052,10 @@ create_mergejoin_plan(PlannerInfo *root,
 
 	if (best_path->innersortkeys)
 	{
+		Relids		inner_relids = inner_path->parent->relids;
 		Sort	   *sort = make_sort_from_pathkeys(inner_plan,
-												   best_path->innersortkeys);
+												   best_path->innersortkeys,
+												   inner_relids);
 
 		label_sort_with_costsize(root, sort, -1.0);
 		inner_plan = (Plan *) sort;
@@ -4133,9 +4341,9 @@ create_hashjoin_plan(PlannerInfo *root,
 	 * skew optimization.  (Note: in principle we could do skew optimization
 	 * with multiple join clauses, but we'd have to be able to determine the
 	 * most common combinations of outer values, which we don't currently have
-	 * enough stats for.)
+	 * enough stats for.)  Shared hash tables don't use skew buckets.
 	 */
-	if (list_length(hashclauses) == 1)
+	if (list_length(hashclauses) == 1 && !best_path->jpath.path.parallel_aware)
 	{
 		OpExpr	   *clause = (OpExpr *) linitial(hashclauses);
 		Node	   *node;
@@ -4174,6 +4382,9 @@ create_hashjoin_plan(PlannerInfo *root,
 	copy_plan_costsize(&hash_plan->plan, inner_plan);
 	hash_plan->plan.startup_cost = hash_plan->plan.total_cost;
 
+	/* A shared hash table is built by the Hash node of every participant */
+	hash_plan->plan.parallel_aware = best_path->jpath.path.parallel_aware;
+
 	join_plan = make_hashjoin(tlist,
 							  joinclauses,
 							  otherclauses,
@@ -4185,9 +4396,126 @@ create_hashjoin_plan(PlannerInfo *root,
 
 	copy_generic_path_info(&join_plan->join.plan, &best_path->jpath.path);
 
+	attach_hashjoin_runtime_filter(root, join_plan, best_path);
+
 	return join_plan;
 }
 
+/*
+ * attach_hashjoin_runtime_filter
+ *	  Arrange for a hash join to pass a Bloom filter to an outer-side scan
+ *
+ * If every outer hash key is a plain column of one base relation that is
+ * scanned below the join, the scan can test its rows against a Bloom filter
+ * over the inner side's hash values (built by the executor once the hash
+ * table is complete), and skip rows that cannot find a join partner before
+ * projecting them and passing them up.  That's only right for join types
+ * that discard unmatched outer rows, and with strict operators, since rows
+ * removed below an outer join can turn into null-extended ones.
+ */
+static void
+attach_hashjoin_runtime_filter(PlannerInfo *root, HashJoin *join_plan,
+							   HashPath *best_path)
+{
+	List	   *keys = NIL;
+	List	   *ops = NIL;
+	Index		relid = 0;
+	Scan	   *scan;
+	ListCell   *lc;
+
+	if (!enable_hashjoin_bloom)
+		return;
+
+	switch (join_plan->join.jointype)
+	{
+		case JOIN_INNER:
+		case JOIN_SEMI:
+		case JOIN_RIGHT:
+			break;
+		default:
+			return;
+	}
+
+	/*
+	 * The executor can only summarize a hash table that fits in one batch;
+	 * don't bother asking for a filter if we expect it not to.
+	 */
+	if (best_path->num_batches > 1)
+		return;
+
+	foreach(lc, join_plan->hashclauses)
+	{
+		OpExpr	   *clause = lfirst_node(OpExpr, lc);
+		Node	   *key = (Node *) linitial(clause->args);
+		Node	   *node = key;
+		Var		   *var;
+
+		if (IsA(node, RelabelType))
+			node = (Node *) ((RelabelType *) node)->arg;
+		if (!IsA(node, Var))
+			return;
+		var = (Var *) node;
+		if (var->varlevelsup != 0 || (relid != 0 && var->varno != relid))
+			return;
+		if (!op_strict(clause->opno))
+			return;
+		relid = var->varno;
+		keys = lappend(keys, copyObject(key));
+		ops = lappend_oid(ops, clause->opno);
+	}
+
+	scan = find_runtime_filter_target(join_plan->join.plan.lefttree, relid);
+	if (scan == NULL)
+		return;
+
+	join_plan->rtfilter_id = ++root->glob->lastRtFilterId;
+	scan->rtfilter_id = join_plan->rtfilter_id;
+	scan->rtfilter_keys = keys;
+	scan->rtfilter_ops = ops;
+}
+
+/*
+ * find_runtime_filter_target
+ *	  Find the scan of relid, if it's a runtime filter candidate
+ *
+ * We look through joins only.  Anything that could run the scan before the
+ * hash table is built, or in another process, isn't worth the trouble.  That
+ * includes the build side of another hash join: its hash table may be kept
+ * across rescans of that join, so rows our filter rejected while it was
+ * being built would stay missing after our filter is rebuilt.  A scan that
+ * already serves another join's filter is left alone.
+ */
+static Scan *
+find_runtime_filter_target(Plan *plan, Index relid)
+{
+	Scan	   *scan;
+
+	if (plan == NULL)
+		return NULL;
+
+	switch (nodeTag(plan))
+	{
+		case T_SeqScan:
+		case T_IndexScan:
+		case T_BitmapHeapScan:
+			scan = (Scan *) plan;
+			if (scan->scanrelid == relid && scan->rtfilter_id == 0)
+				return scan;
+			break;
+		case T_NestLoop:
+		case T_MergeJoin:
+		case T_HashJoin:
+			scan = find_runtime_filter_target(plan->lefttree, relid);
+			if (scan == NULL)
+				scan = find_runtime_filter_target(plan->righttree, relid);
+			return scan;
+		default:
+			break;
+	}
+
+	return NULL;
+}
+
 
 /*****************************************************************************
  *
@@ -4195,6 +4523,26 @@ create_hashjoin_plan(PlannerInfo *root,
  *
  *****************************************************************************/
 
+/*
+ * pull_paramids_walker
+ *	  Collect the paramids of all Params in an expression.
+ */
+static bool
+pull_paramids_walker(Node *node, Bitmapset **context)
+{
+	if (node == NULL)
+		return false;
+	if (IsA(node, Param))
+	{
+		Param	   *param = (Param *) node;
+
+		*context = bms_add_member(*context, param->paramid);
+		return false;
+	}
+	return expression_tree_walker(node, pull_paramids_walker,
+								  (void *) context);
+}
+
 /*
  * replace_nestloop_params
  *	  Replace outer-relation Vars and PlaceHolderVars in the given expression
@@ -4997,7 +5345,8 @@ make_indexscan(List *qptlist,
 			   List *indexorderby,
 			   List *indexorderbyorig,
 			   List *indexorderbyops,
-			   ScanDirection indexscandir)
+			   ScanDirection indexscandir,
+			   bool indexskip)
 {
 	IndexScan  *node = makeNode(IndexScan);
 	Plan	   *plan = &node->scan.plan;
@@ -5014,6 +5363,7 @@ make_indexscan(List *qptlist,
 	node->indexorderbyorig = indexorderbyorig;
 	node->indexorderbyops = indexorderbyops;
 	node->indexorderdir = indexscandir;
+	node->indexskip = indexskip;
 
 	return node;
 }
@@ -5026,7 +5376,8 @@ make_indexonlyscan(List *qptlist,
 				   List *indexqual,
 				   List *indexorderby,
 				   List *indextlist,
-				   ScanDirection indexscandir)
+				   ScanDirection indexscandir,
+				   bool indexskip)
 {
 	IndexOnlyScan *node = makeNode(IndexOnlyScan);
 	Plan	   *plan = &node->scan.plan;
@@ -5041,6 +5392,7 @@ make_indexonlyscan(List *qptlist,
 	node->indexorderby = indexorderby;
 	node->indextlist = indextlist;
 	node->indexorderdir = indexscandir;
+	node->indexskip = indexskip;
 
 	return node;
 }
@@ -5529,7 +5881,7 @@ make_sort(Plan *lefttree, int numCols,
  * the output parameters *p_numsortkeys etc.
  *
  * When looking for matches to an EquivalenceClass's members, we will only
- * consider child EC members if they match 'relids'.  This protects against
+ * consider child EC members if they belong to given 'relids'.  This protects against
  * possible incorrect matches to child expressions that contain no Vars.
  *
  * If reqColIdx isn't NULL then it contains sort key column numbers that
@@ -5685,11 +6037,11 @@ prepare_sort_from_pathkeys(Plan *lefttree, List *pathkeys,
 					continue;
 
 				/*
-				 * Ignore child members unless they match the rel being
+				 * Ignore child members unless they belong to the rel being
 				 * sorted.
 				 */
 				if (em->em_is_child &&
-					!bms_equal(em->em_relids, relids))
+					!bms_is_subset(em->em_relids, relids))
 					continue;
 
 				sortexpr = em->em_expr;
@@ -5773,7 +6125,7 @@ prepare_sort_from_pathkeys(Plan *lefttree, List *pathkeys,
  * find_ec_member_for_tle
  *		Locate an EquivalenceClass member matching the given TLE, if any
  *
- * Child EC members are ignored unless they match 'relids'.
+ * Child EC members are ignored unless they belong to given 'relids'.
  */
 static EquivalenceMember *
 find_ec_member_for_tle(EquivalenceClass *ec,
@@ -5801,10 +6153,10 @@ find_ec_member_for_tle(EquivalenceClass *ec,
 			continue;
 
 		/*
-		 * Ignore child members unless they match the rel being sorted.
+		 * Ignore child members unless they belong to the rel being sorted.
 		 */
 		if (em->em_is_child &&
-			!bms_equal(em->em_relids, relids))
+			!bms_is_subset(em->em_relids, relids))
 			continue;
 
 		/* Match if same expression (after stripping relabel) */
@@ -5825,9 +6177,10 @@ find_ec_member_for_tle(EquivalenceClass *ec,
  *
  *	  'lefttree' is the node which yields input tuples
  *	  'pathkeys' is the list of pathkeys by which the result is to be sorted
+ *	  'relids' is the set of relations required by prepare_sort_from_pathkeys()
  */
 static Sort *
-make_sort_from_pathkeys(Plan *lefttree, List *pathkeys)
+make_sort_from_pathkeys(Plan *lefttree, List *pathkeys, Relids relids)
 {
 	int			numsortkeys;
 	AttrNumber *sortColIdx;
@@ -5837,7 +6190,7 @@ make_sort_from_pathkeys(Plan *lefttree, List *pathkeys)
 
 	/* Compute sort column info, and adjust lefttree as needed */
 	lefttree = prepare_sort_from_pathkeys(lefttree, pathkeys,
-										  NULL,
+										  relids,
 										  NULL,
 										  false,
 										  &numsortkeys,
@@ -5852,6 +6205,53 @@ make_sort_from_pathkeys(Plan *lefttree, List *pathkeys)
 					 collations, nullsFirst);
 }
 
+/*
+ * make_incrementalsort_from_pathkeys
+ *	  Create incremental sort plan to sort according to given pathkeys
+ *
+ *	  'lefttree' is the node which yields input tuples
+ *	  'pathkeys' is the list of pathkeys by which the result is to be sorted
+ *	  'relids' is the set of relations required by prepare_sort_from_pathkeys()
+ *	  'nPresortedCols' is the number of presorted columns in input tuples
+ */
+static IncrementalSort *
+make_incrementalsort_from_pathkeys(Plan *lefttree, List *pathkeys,
+								   Relids relids, int nPresortedCols)
+{
+	IncrementalSort *node = makeNode(IncrementalSort);
+	Plan	   *plan = &node->sort.plan;
+	int			numsortkeys;
+	AttrNumber *sortColIdx;
+	Oid		   *sortOperators;
+	Oid		   *collations;
+	bool	   *nullsFirst;
+
+	/* Compute sort column info, and adjust lefttree as needed */
+	lefttree = prepare_sort_from_pathkeys(lefttree, pathkeys,
+										  relids,
+										  NULL,
+										  false,
+										  &numsortkeys,
+										  &sortColIdx,
+										  &sortOperators,
+										  &collations,
+										  &nullsFirst);
+	Assert(nPresortedCols > 0 && nPresortedCols < numsortkeys);
+
+	plan->targetlist = lefttree->targetlist;
+	plan->qual = NIL;
+	plan->lefttree = lefttree;
+	plan->righttree = NULL;
+	node->sort.numCols = numsortkeys;
+	node->sort.sortColIdx = sortColIdx;
+	node->sort.sortOperators = sortOperators;
+	node->sort.collations = collations;
+	node->sort.nullsFirst = nullsFirst;
+	node->nPresortedCols = nPresortedCols;
+
+	return node;
+}
+
 /*
  * make_sort_from_sortclauses
  *	  Create sort plan to sort according to given sortclauses
@@ -5963,6 +6363,28 @@ make_material(Plan *lefttree)
 	return node;
 }
 
+static Memoize *
+make_memoize(Plan *lefttree, Oid *hashoperators, Oid *collations,
+			 List *param_exprs, uint32 est_entries, Bitmapset *keyparamids)
+{
+	Memoize    *node = makeNode(Memoize);
+	Plan	   *plan = &node->plan;
+
+	plan->targetlist = lefttree->targetlist;
+	plan->qual = NIL;
+	plan->lefttree = lefttree;
+	plan->righttree = NULL;
+
+	node->numKeys = list_length(param_exprs);
+	node->hashOperators = hashoperators;
+	node->collations = collations;
+	node->param_exprs = param_exprs;
+	node->est_entries = est_entries;
+	node->keyparamids = keyparamids;
+
+	return node;
+}
+
 /*
  * materialize_finished_plan: stick a Material node atop a completed plan
  *
@@ -6554,7 +6976,9 @@ is_projection_capable_path(Path *path)
 	{
 		case T_Hash:
 		case T_Material:
+		case T_Memoize:
 		case T_Sort:
+		case T_IncrementalSort:
 		case T_Unique:
 		case T_SetOp:
 		case T_LockRows:
@@ -6599,7 +7023,9 @@ is_projection_capable_plan(Plan *plan)
 	{
 		case T_Hash:
 		case T_Material:
+		case T_Memoize:
 		case T_Sort:
+		case T_IncrementalSort:
 		case T_Unique:
 		case T_SetOp:
 		case T_LockRows:
@@ -26,6 +26,7 @@
 #include "catalog/pg_proc.h"
 #include "catalog/pg_type.h"
 #include "executor/executor.h"
+#include "executor/incmeta.h"
 #include "executor/nodeAgg.h"
 #include "foreign/fdwapi.h"
 #include "miscadmin.h"
@@ -138,6 +139,22 @@ static RelOptInfo *create_grouping_paths(PlannerInfo *root,
 					  PathTarget *target,
 					  const AggClauseCosts *agg_costs,
 					  grouping_sets_data *gd);
+static void create_partitionwise_grouping_paths(PlannerInfo *root,
+									RelOptInfo *input_rel,
+									RelOptInfo *grouped_rel,
+									PathTarget *target,
+									const AggClauseCosts *agg_costs,
+									bool can_sort, bool can_hash,
+									double dNumGroups);
+static bool group_by_has_partkey(RelOptInfo *input_rel,
+					 List *groupClause, List *tlist);
+static Path *make_child_grouping_path(PlannerInfo *root,
+						 RelOptInfo *child_grouped_rel,
+						 Path *subpath, PathTarget *target,
+						 AggSplit aggsplit, List *havingQual,
+						 const AggClauseCosts *agg_costs,
+						 bool can_sort, bool can_hash,
+						 double dNumGroups);
 static void consider_groupingsets_paths(PlannerInfo *root,
 							RelOptInfo *grouped_rel,
 							Path *path,
@@ -247,6 +264,7 @@ standard_planner(Query *parse, int cursorOptions, ParamListInfo boundParams)
 	glob->lastPHId = 0;
 	glob->lastRowMarkId = 0;
 	glob->lastPlanNodeId = 0;
+	glob->lastRtFilterId = 0;
 	glob->transientPlan = false;
 	glob->dependsOnRole = false;
 
@@ -3834,9 +3852,10 @@ create_grouping_paths(PlannerInfo *root,
 
 			/*
 			 * Tentatively produce a partial HashAgg Path, depending on if it
-			 * looks as if the hash table will fit in work_mem.
+			 * looks as if the hash table will fit in work_mem, or we're
+			 * allowed to spill it to disk.
 			 */
-			if (hashaggtablesize < work_mem * 1024L)
+			if (enable_hashagg_disk || hashaggtablesize < work_mem * 1024L)
 			{
 				add_partial_path(grouped_rel, (Path *)
 								 create_agg_path(root,
@@ -4060,11 +4079,13 @@ create_grouping_paths(PlannerInfo *root,
 
 			/*
 			 * Provided that the estimated size of the hashtable does not
-			 * exceed work_mem, we'll generate a HashAgg Path, although if we
-			 * were unable to sort above, then we'd better generate a Path, so
-			 * that we at least have one.
+			 * exceed work_mem (or that we may spill it to disk), we'll
+			 * generate a HashAgg Path, although if we were unable to sort
+			 * above, then we'd better generate a Path, so that we at least
+			 * have one.
 			 */
-			if (hashaggtablesize < work_mem * 1024L ||
+			if (enable_hashagg_disk ||
+				hashaggtablesize < work_mem * 1024L ||
 				grouped_rel->pathlist == NIL)
 			{
 				/*
@@ -4087,7 +4108,7 @@ create_grouping_paths(PlannerInfo *root,
 		/*
 		 * Generate a HashAgg Path atop of the cheapest partial path. Once
 		 * again, we'll only do this if it looks as though the hash table
-		 * won't exceed work_mem.
+		 * won't exceed work_mem, unless we may spill it to disk.
 		 */
 		if (grouped_rel->partial_pathlist)
 		{
@@ -4097,7 +4118,7 @@ create_grouping_paths(PlannerInfo *root,
 														  &agg_final_costs,
 														  dNumGroups);
 
-			if (hashaggtablesize < work_mem * 1024L)
+			if (enable_hashagg_disk || hashaggtablesize < work_mem * 1024L)
 			{
 				double		total_groups = path->rows * path->parallel_workers;
 
@@ -4123,6 +4144,16 @@ create_grouping_paths(PlannerInfo *root,
 		}
 	}
 
+	/*
+	 * If the input is partitioned, consider grouping each partition on its
+	 * own and appending the results.
+	 */
+	if (enable_partitionwise_aggregate && IS_PARTITIONED_REL(input_rel) &&
+		(can_sort || can_hash))
+		create_partitionwise_grouping_paths(root, input_rel, grouped_rel,
+											target, agg_costs,
+											can_sort, can_hash, dNumGroups);
+
 	/* Give a helpful error if we failed to find any implementation */
 	if (grouped_rel->pathlist == NIL)
 		ereport(ERROR,
@@ -4161,6 +4192,298 @@ create_grouping_paths(PlannerInfo *root,
 }
 
 
+/*
+ * create_partitionwise_grouping_paths
+ *
+ * Build an Append of per-partition grouping paths for a partitioned input
+ * rel and add it to grouped_rel.
+ *
+ * When the GROUP BY clause contains every partition key column, no group
+ * can span two partitions, so each partition is aggregated completely and
+ * HAVING is applied per partition.  Otherwise each partition is aggregated
+ * partially and a FinalizeAggregate combines the appended partial results,
+ * which requires that every aggregate supports partial mode.
+ */
+static void
+create_partitionwise_grouping_paths(PlannerInfo *root,
+									RelOptInfo *input_rel,
+									RelOptInfo *grouped_rel,
+									PathTarget *target,
+									const AggClauseCosts *agg_costs,
+									bool can_sort, bool can_hash,
+									double dNumGroups)
+{
+	Query	   *parse = root->parse;
+	PathTarget *scanjoin_target = input_rel->cheapest_total_path->pathtarget;
+	PathTarget *child_agg_target;
+	AggClauseCosts agg_partial_costs;
+	AggClauseCosts agg_final_costs;
+	List	   *group_exprs;
+	List	   *subpaths = NIL;
+	bool		full_agg;
+	bool		child_can_sort = can_sort;
+	Path	   *path;
+	ListCell   *lc;
+	int			cnt;
+
+	/* Grouping sets and SRFs in the tlist are too hard to push down. */
+	if (parse->groupClause == NIL || parse->groupingSets ||
+		parse->hasTargetSRFs)
+		return;
+
+	full_agg = group_by_has_partkey(input_rel, parse->groupClause,
+									parse->targetList);
+
+	if (!full_agg &&
+		(!parse->hasAggs || agg_costs->hasNonPartial ||
+		 agg_costs->hasNonSerial))
+		return;
+
+	MemSet(&agg_partial_costs, 0, sizeof(AggClauseCosts));
+	MemSet(&agg_final_costs, 0, sizeof(AggClauseCosts));
+	if (full_agg)
+		child_agg_target = target;
+	else
+	{
+		child_agg_target = make_partial_grouping_target(root, target);
+		get_agg_clause_costs(root, (Node *) child_agg_target->exprs,
+							 AGGSPLIT_INITIAL_SERIAL,
+							 &agg_partial_costs);
+		get_agg_clause_costs(root, (Node *) target->exprs,
+							 AGGSPLIT_FINAL_DESERIAL,
+							 &agg_final_costs);
+		get_agg_clause_costs(root, parse->havingQual,
+							 AGGSPLIT_FINAL_DESERIAL,
+							 &agg_final_costs);
+	}
+
+	group_exprs = get_sortgrouplist_exprs(parse->groupClause,
+										  parse->targetList);
+
+	/*
+	 * Child equivalence members exist only for expressions of a single
+	 * baserel, so a partition of a join can't be sorted on a grouping
+	 * expression that mixes columns of both sides.  Hash those instead.
+	 */
+	foreach(lc, group_exprs)
+	{
+		Relids		varnos = pull_varnos((Node *) lfirst(lc));
+
+		if (bms_membership(varnos) == BMS_MULTIPLE)
+			child_can_sort = false;
+	}
+	if (!child_can_sort && !can_hash)
+		return;
+
+	for (cnt = 0; cnt < input_rel->nparts; cnt++)
+	{
+		RelOptInfo *child_rel = input_rel->part_rels[cnt];
+		RelOptInfo *child_grouped_rel;
+		PathTarget *child_scanjoin_target;
+		PathTarget *child_target;
+		List	   *appinfos;
+		List	   *child_having;
+		List	   *child_group_exprs;
+		Path	   *child_path;
+		double		child_groups;
+
+		/* A partition we couldn't plan on its own spoils the whole thing. */
+		if (child_rel == NULL || child_rel->cheapest_total_path == NULL)
+			return;
+
+		/* Pruned or provably empty partitions contribute no groups. */
+		if (IS_DUMMY_REL(child_rel))
+			continue;
+
+		appinfos = find_appinfos_by_relids(root, child_rel->relids);
+
+		child_scanjoin_target = copy_pathtarget(scanjoin_target);
+		child_scanjoin_target->exprs = (List *)
+			adjust_appendrel_attrs_list(root,
+										(Node *) scanjoin_target->exprs,
+										appinfos);
+		child_target = copy_pathtarget(child_agg_target);
+		child_target->exprs = (List *)
+			adjust_appendrel_attrs_list(root,
+										(Node *) child_agg_target->exprs,
+										appinfos);
+		child_having = full_agg ? (List *)
+			adjust_appendrel_attrs_list(root, parse->havingQual, appinfos) :
+			NIL;
+		child_group_exprs = (List *)
+			adjust_appendrel_attrs_list(root, (Node *) group_exprs, appinfos);
+
+		child_grouped_rel = fetch_upper_rel(root, UPPERREL_GROUP_AGG,
+											child_rel->relids);
+
+		child_path = (Path *)
+			create_projection_path(root, child_rel,
+								   child_rel->cheapest_total_path,
+								   child_scanjoin_target);
+		child_groups = estimate_num_groups(root, child_group_exprs,
+										   child_path->rows, NULL);
+
+		child_path = make_child_grouping_path(root, child_grouped_rel,
+											  child_path, child_target,
+											  full_agg ? AGGSPLIT_SIMPLE :
+											  AGGSPLIT_INITIAL_SERIAL,
+											  child_having,
+											  full_agg ? agg_costs :
+											  &agg_partial_costs,
+											  child_can_sort, can_hash,
+											  child_groups);
+		if (child_path == NULL)
+			return;
+
+		subpaths = lappend(subpaths, child_path);
+	}
+
+	/* Every partition was empty; the ordinary paths handle that fine. */
+	if (subpaths == NIL)
+		return;
+
+	path = (Path *)
+		create_append_path(grouped_rel, subpaths, NULL, 0,
+						   get_partitioned_child_rels_for_join(root,
+															   input_rel->relids));
+	path->pathtarget = child_agg_target;
+
+	if (full_agg)
+	{
+		add_path(grouped_rel, path);
+		return;
+	}
+
+	/* Combine the appended partial groups. */
+	if (can_sort)
+	{
+		Path	   *sorted_path;
+
+		sorted_path = (Path *) create_sort_path(root, grouped_rel, path,
+												root->group_pathkeys, -1.0);
+		add_path(grouped_rel, (Path *)
+				 create_agg_path(root, grouped_rel, sorted_path, target,
+								 AGG_SORTED,
+								 AGGSPLIT_FINAL_DESERIAL,
+								 parse->groupClause,
+								 (List *) parse->havingQual,
+								 &agg_final_costs,
+								 dNumGroups));
+	}
+	if (can_hash &&
+		(enable_hashagg_disk ||
+		 estimate_hashagg_tablesize(path, &agg_final_costs,
+									dNumGroups) < work_mem * 1024L ||
+		 grouped_rel->pathlist == NIL))
+		add_path(grouped_rel, (Path *)
+				 create_agg_path(root, grouped_rel, path, target,
+								 AGG_HASHED,
+								 AGGSPLIT_FINAL_DESERIAL,
+								 parse->groupClause,
+								 (List *) parse->havingQual,
+								 &agg_final_costs,
+								 dNumGroups));
+}
+
+/*
+ * group_by_has_partkey
+ *
+ * Returns true if every partition key column of input_rel is equated by the
+ * GROUP BY clause under an operator of the key's opfamily and collation, so
+ * that rows of one group can only ever come from a single partition.
+ */
+static bool
+group_by_has_partkey(RelOptInfo *input_rel, List *groupClause, List *tlist)
+{
+	PartitionScheme part_scheme = input_rel->part_scheme;
+	int			cnt;
+
+	for (cnt = 0; cnt < part_scheme->partnatts; cnt++)
+	{
+		bool		found = false;
+		ListCell   *lc;
+
+		foreach(lc, groupClause)
+		{
+			SortGroupClause *sgc = (SortGroupClause *) lfirst(lc);
+			Expr	   *expr = (Expr *) get_sortgroupclause_expr(sgc, tlist);
+
+			if (!op_in_opfamily(sgc->eqop, part_scheme->partopfamily[cnt]) ||
+				exprCollation((Node *) expr) != part_scheme->partcollation[cnt])
+				continue;
+
+			if (list_member(input_rel->partexprs[cnt], expr))
+			{
+				found = true;
+				break;
+			}
+		}
+
+		if (!found)
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * make_child_grouping_path
+ *
+ * Build the cheaper of a sorted and a hashed grouping path over one
+ * partition's input, or return NULL if neither is possible.
+ */
+static Path *
+make_child_grouping_path(PlannerInfo *root,
+						 RelOptInfo *child_grouped_rel,
+						 Path *subpath, PathTarget *target,
+						 AggSplit aggsplit, List *havingQual,
+						 const AggClauseCosts *agg_costs,
+						 bool can_sort, bool can_hash,
+						 double dNumGroups)
+{
+	Query	   *parse = root->parse;
+	Path	   *sorted_path = NULL;
+	Path	   *hashed_path = NULL;
+
+	if (can_sort)
+	{
+		Path	   *path = subpath;
+
+		if (!pathkeys_contained_in(root->group_pathkeys, path->pathkeys))
+			path = (Path *) create_sort_path(root, child_grouped_rel, path,
+											 root->group_pathkeys, -1.0);
+		if (parse->hasAggs)
+			sorted_path = (Path *)
+				create_agg_path(root, child_grouped_rel, path, target,
+								AGG_SORTED, aggsplit,
+								parse->groupClause, havingQual,
+								agg_costs, dNumGroups);
+		else
+			sorted_path = (Path *)
+				create_group_path(root, child_grouped_rel, path, target,
+								  parse->groupClause, havingQual,
+								  dNumGroups);
+	}
+
+	if (can_hash &&
+		(enable_hashagg_disk || sorted_path == NULL ||
+		 estimate_hashagg_tablesize(subpath, agg_costs,
+									dNumGroups) < work_mem * 1024L))
+		hashed_path = (Path *)
+			create_agg_path(root, child_grouped_rel, subpath, target,
+							AGG_HASHED, aggsplit,
+							parse->groupClause, havingQual,
+							agg_costs, dNumGroups);
+
+	if (sorted_path == NULL)
+		return hashed_path;
+	if (hashed_path == NULL)
+		return sorted_path;
+	return compare_path_costs(sorted_path, hashed_path, TOTAL_COST) <= 0 ?
+		sorted_path : hashed_path;
+}
+
+
 /*
  * For a given input path, consider the possible ways of doing grouping sets on
  * it, by combinations of hashing and sorting.  This can be called multiple
@@ -4938,9 +5261,11 @@ create_ordered_paths(PlannerInfo *root,
 	{
 		Path	   *path = (Path *) lfirst(lc);
 		bool		is_sorted;
+		int			presorted_keys;
 
-		is_sorted = pathkeys_contained_in(root->sort_pathkeys,
-										  path->pathkeys);
+		is_sorted = pathkeys_count_contained_in(root->sort_pathkeys,
+												path->pathkeys,
+												&presorted_keys);
 		if (path == cheapest_input_path || is_sorted)
 		{
 			if (!is_sorted)
@@ -4953,6 +5278,30 @@ create_ordered_paths(PlannerInfo *root,
 												 limit_tuples);
 			}
 
+			/* Add projection step if needed */
+			if (path->pathtarget != target)
+				path = apply_projection_to_path(root, ordered_rel,
+												path, target);
+
+			add_path(ordered_rel, path);
+		}
+		else if (enable_incremental_sort && !enable_incremental &&
+				 presorted_keys > 0)
+		{
+			/*
+			 * The path is sorted on a prefix of the required ordering, so
+			 * sorting only within groups of equal prefix keys may beat a full
+			 * sort of the cheapest path, especially under a LIMIT.  The
+			 * incremental executor (enable_incremental) keeps per-node delta
+			 * state only for plain Sort nodes, so don't offer this there.
+			 */
+			path = (Path *) create_incremental_sort_path(root,
+														 ordered_rel,
+														 path,
+														 root->sort_pathkeys,
+														 presorted_keys,
+														 limit_tuples);
+
 			/* Add projection step if needed */
 			if (path->pathtarget != target)
 				path = apply_projection_to_path(root, ordered_rel,
@@ -6079,7 +6428,7 @@ plan_cluster_use_sort(Oid tableOid, Oid indexOid)
 	/* Estimate the cost of index scan */
 	indexScanPath = create_index_path(root, indexInfo,
 									  NIL, NIL, NIL, NIL, NIL,
-									  ForwardScanDirection, false,
+									  ForwardScanDirection, false, false,
 									  NULL, 1.0, false);
 
 	return (seqScanAndSortPath.total_cost < indexScanPath->path.total_cost);
@@ -6112,3 +6461,25 @@ get_partitioned_child_rels(PlannerInfo *root, Index rti)
 
 	return result;
 }
+
+/*
+ * get_partitioned_child_rels_for_join
+ *		Build and return a list containing the RTI of every partitioned
+ *		relation which is a child of some rel included in the join.
+ */
+List *
+get_partitioned_child_rels_for_join(PlannerInfo *root, Relids join_relids)
+{
+	List	   *result = NIL;
+	ListCell   *l;
+
+	foreach(l, root->pcinfo_list)
+	{
+		PartitionedChildRelInfo *pc = lfirst(l);
+
+		if (bms_is_member(pc->parent_relid, join_relids))
+			result = list_concat(result, list_copy(pc->child_rels));
+	}
+
+	return result;
+}
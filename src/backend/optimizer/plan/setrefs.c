@@ -455,6 +455,8 @@ set_plan_refs(PlannerInfo *root, Plan *plan, int rtoffset)
 					fix_scan_list(root, splan->plan.targetlist, rtoffset);
 				splan->plan.qual =
 					fix_scan_list(root, splan->plan.qual, rtoffset);
+				splan->rtfilter_keys =
+					fix_scan_list(root, splan->rtfilter_keys, rtoffset);
 			}
 			break;
 		case T_SampleScan:
@@ -487,6 +489,8 @@ set_plan_refs(PlannerInfo *root, Plan *plan, int rtoffset)
 					fix_scan_list(root, splan->indexorderby, rtoffset);
 				splan->indexorderbyorig =
 					fix_scan_list(root, splan->indexorderbyorig, rtoffset);
+				splan->scan.rtfilter_keys =
+					fix_scan_list(root, splan->scan.rtfilter_keys, rtoffset);
 			}
 			break;
 		case T_IndexOnlyScan:
@@ -521,6 +525,8 @@ set_plan_refs(PlannerInfo *root, Plan *plan, int rtoffset)
 					fix_scan_list(root, splan->scan.plan.qual, rtoffset);
 				splan->bitmapqualorig =
 					fix_scan_list(root, splan->bitmapqualorig, rtoffset);
+				splan->scan.rtfilter_keys =
+					fix_scan_list(root, splan->scan.rtfilter_keys, rtoffset);
 			}
 			break;
 		case T_TidScan:
@@ -634,6 +640,7 @@ set_plan_refs(PlannerInfo *root, Plan *plan, int rtoffset)
 		case T_Hash:
 		case T_Material:
 		case T_Sort:
+		case T_IncrementalSort:
 		case T_Unique:
 		case T_SetOp:
 
@@ -652,6 +659,20 @@ set_plan_refs(PlannerInfo *root, Plan *plan, int rtoffset)
 			 */
 			Assert(plan->qual == NIL);
 			break;
+		case T_Memoize:
+			{
+				Memoize    *mplan = (Memoize *) plan;
+
+				/*
+				 * Memoize does not evaluate its targetlist.  It just uses
+				 * the same targetlist from its outer subnode.
+				 */
+				set_dummy_tlist_references(plan, rtoffset);
+
+				mplan->param_exprs = fix_scan_list(root, mplan->param_exprs,
+												   rtoffset);
+				break;
+			}
 		case T_LockRows:
 			{
 				LockRows   *splan = (LockRows *) plan;
@@ -921,6 +942,10 @@ set_plan_refs(PlannerInfo *root, Plan *plan, int rtoffset)
 											  (Plan *) lfirst(l),
 											  rtoffset);
 				}
+				if (splan->part_prune_info)
+					splan->part_prune_info->exprs =
+						fix_scan_list(root, splan->part_prune_info->exprs,
+									  rtoffset);
 			}
 			break;
 		case T_MergeAppend:
@@ -943,6 +968,10 @@ set_plan_refs(PlannerInfo *root, Plan *plan, int rtoffset)
 											  (Plan *) lfirst(l),
 											  rtoffset);
 				}
+				if (splan->part_prune_info)
+					splan->part_prune_info->exprs =
+						fix_scan_list(root, splan->part_prune_info->exprs,
+									  rtoffset);
 			}
 			break;
 		case T_RecursiveUnion:
@@ -2572,6 +2572,9 @@ finalize_plan(PlannerInfo *root, Plan *plan,
 			{
 				ListCell   *l;
 
+				if (((Append *) plan)->part_prune_info)
+					finalize_primnode((Node *) ((Append *) plan)->part_prune_info->exprs,
+									  &context);
 				foreach(l, ((Append *) plan)->appendplans)
 				{
 					context.paramids =
@@ -2589,6 +2592,9 @@ finalize_plan(PlannerInfo *root, Plan *plan,
 			{
 				ListCell   *l;
 
+				if (((MergeAppend *) plan)->part_prune_info)
+					finalize_primnode((Node *) ((MergeAppend *) plan)->part_prune_info->exprs,
+									  &context);
 				foreach(l, ((MergeAppend *) plan)->mergeplans)
 				{
 					context.paramids =
@@ -2761,10 +2767,16 @@ finalize_plan(PlannerInfo *root, Plan *plan,
 			/* rescan_param does *not* get added to scan_params */
 			break;
 
+		case T_Memoize:
+			finalize_primnode((Node *) ((Memoize *) plan)->param_exprs,
+							  &context);
+			break;
+
 		case T_ProjectSet:
 		case T_Hash:
 		case T_Material:
 		case T_Sort:
+		case T_IncrementalSort:
 		case T_Unique:
 		case T_SetOp:
 		case T_Group:
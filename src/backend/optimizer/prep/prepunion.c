@@ -964,7 +964,7 @@ choose_hashed_setop(PlannerInfo *root, List *groupClauses,
 	cost_agg(&hashed_p, root, AGG_HASHED, NULL,
 			 numGroupCols, dNumGroups,
 			 input_path->startup_cost, input_path->total_cost,
-			 input_path->rows);
+			 input_path->rows, input_path->pathtarget->width);
 
 	/*
 	 * Now for the sorted case.  Note that the input is *always* unsorted,
@@ -2168,3 +2168,61 @@ adjust_appendrel_attrs_multilevel(PlannerInfo *root, Node *node,
 	/* Now translate for this child */
 	return adjust_appendrel_attrs(root, node, appinfo);
 }
+
+/*
+ * adjust_appendrel_attrs_list
+ *	  Apply the Var translations of several appendrel children at once.
+ *
+ * The AppendRelInfos must all have different parents, as is the case for
+ * the member rels of a child join, so that the translations do not interact.
+ */
+Node *
+adjust_appendrel_attrs_list(PlannerInfo *root, Node *node, List *appinfos)
+{
+	ListCell   *lc;
+
+	foreach(lc, appinfos)
+		node = adjust_appendrel_attrs(root, node,
+									  (AppendRelInfo *) lfirst(lc));
+
+	return node;
+}
+
+/*
+ * adjust_child_relids
+ *	  Substitute the child relids for their parents' in a Relid set, for all
+ *	  the given AppendRelInfos.
+ */
+Relids
+adjust_child_relids(Relids relids, List *appinfos)
+{
+	ListCell   *lc;
+
+	foreach(lc, appinfos)
+	{
+		AppendRelInfo *appinfo = (AppendRelInfo *) lfirst(lc);
+
+		relids = adjust_relid_set(relids, appinfo->parent_relid,
+								  appinfo->child_relid);
+	}
+
+	return relids;
+}
+
+/*
+ * find_appinfos_by_relids
+ *	  Find the AppendRelInfos of all the appendrel children in relids.
+ */
+List *
+find_appinfos_by_relids(PlannerInfo *root, Relids relids)
+{
+	List	   *appinfos = NIL;
+	int			i = -1;
+
+	while ((i = bms_next_member(relids, i)) >= 0)
+		appinfos = lappend(appinfos,
+						   find_childrel_appendrelinfo(root,
+													   find_base_rel(root, i)));
+
+	return appinfos;
+}
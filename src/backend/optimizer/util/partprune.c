@@ -0,0 +1,492 @@
+/*-------------------------------------------------------------------------
+ *
+ * partprune.c
+ *	  Routines to prune the partitions of a partitioned table by matching
+ *	  the query's restriction clauses against the partition bounds
+ *
+ * Constraint exclusion has to prove each partition's constraint refuted by
+ * the quals one partition at a time, and can only use constants.  Here we
+ * instead collect the quals on the first partition key column and look the
+ * matching partitions up in the table's PartitionDesc with a binary search.
+ * Quals comparing with constants are used at plan time, to skip the pruned
+ * children of the appendrel.  Quals comparing with Params (including those
+ * set by initplans and nestloops) are handed to the executor in a
+ * PartitionPruneInfo attached to the Append or MergeAppend, so that it can
+ * skip the non-matching subplans at run time.
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/optimizer/util/partprune.c
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#include "postgres.h"
+
+#include "access/heapam.h"
+#include "access/nbtree.h"
+#include "catalog/partition.h"
+#include "catalog/pg_inherits_fn.h"
+#include "nodes/makefuncs.h"
+#include "nodes/nodeFuncs.h"
+#include "optimizer/clauses.h"
+#include "optimizer/partprune.h"
+#include "optimizer/var.h"
+#include "parser/parsetree.h"
+#include "rewrite/rewriteManip.h"
+#include "utils/lsyscache.h"
+#include "utils/rel.h"
+
+
+/* A leaf table of a partition tree, and its top-level partition */
+typedef struct PartitionMember
+{
+	Oid			relid;
+	int			partidx;
+} PartitionMember;
+
+static Expr *make_partkey_expr(PartitionKey partkey, Index varno);
+static bool match_partkey_expr(Expr *expr, Expr *keyexpr);
+static bool match_clause_to_partkey(PartitionKey partkey, Expr *keyexpr,
+						Expr *clause, int *strategy, Expr **value);
+static PartitionMember *get_partition_members(Relation partrel,
+					  int *nmembers);
+static int	partition_member_cmp(const void *a, const void *b);
+static int	get_partition_member_index(PartitionMember *members,
+						   int nmembers, Oid relid);
+static bool contain_exec_param_walker(Node *node, void *context);
+
+
+/*
+ * prune_append_rel_partitions
+ *	  Return the RT indexes of the children of partitioned table 'rel'
+ *	  whose partitions can't contain rows matching the restriction clauses
+ *	  that compare the partition key with constants.
+ */
+Relids
+prune_append_rel_partitions(PlannerInfo *root, RelOptInfo *rel,
+							RangeTblEntry *rte)
+{
+	Relation	partrel;
+	PartitionKey partkey;
+	PartitionDesc partdesc;
+	PartitionPruneRange range;
+	Expr	   *keyexpr;
+	Bitmapset  *partitions = NULL;
+	bool		have_conditions = false;
+	bool		contradiction = false;
+	PartitionMember *members;
+	int			nmembers;
+	Relids		result = NULL;
+	ListCell   *lc;
+
+	Assert(rte->relkind == RELKIND_PARTITIONED_TABLE);
+
+	/* The rewriter already locked the table, and expansion its partitions */
+	partrel = heap_open(rte->relid, NoLock);
+	partkey = RelationGetPartitionKey(partrel);
+	partdesc = RelationGetPartitionDesc(partrel);
+	keyexpr = make_partkey_expr(partkey, rel->relid);
+
+	MemSet(&range, 0, sizeof(range));
+	foreach(lc, rel->baserestrictinfo)
+	{
+		RestrictInfo *rinfo = (RestrictInfo *) lfirst(lc);
+		int			strategy;
+		Expr	   *value;
+		Const	   *cvalue;
+
+		if (rinfo->pseudoconstant)
+			continue;
+		if (!match_clause_to_partkey(partkey, keyexpr, rinfo->clause,
+									 &strategy, &value))
+			continue;
+		/* Params and stable functions can only be used at run time */
+		if (value != NULL && !IsA(value, Const))
+			continue;
+
+		have_conditions = true;
+		cvalue = (Const *) value;
+		if (!partition_prune_range_add(partkey, &range, strategy,
+									   cvalue ? cvalue->constvalue : (Datum) 0,
+									   cvalue ? cvalue->constisnull : false))
+		{
+			contradiction = true;
+			break;
+		}
+	}
+
+	if (!have_conditions)
+	{
+		heap_close(partrel, NoLock);
+		return NULL;
+	}
+
+	if (!contradiction)
+		partitions = get_partitions_for_prune_range(partkey, partdesc, &range);
+
+	/* The children are the leaf tables; find their top-level partitions */
+	members = get_partition_members(partrel, &nmembers);
+	foreach(lc, root->append_rel_list)
+	{
+		AppendRelInfo *appinfo = (AppendRelInfo *) lfirst(lc);
+		RangeTblEntry *childrte;
+		int			partidx;
+
+		if (appinfo->parent_relid != rel->relid)
+			continue;
+
+		childrte = planner_rt_fetch(appinfo->child_relid, root);
+		partidx = get_partition_member_index(members, nmembers,
+											 childrte->relid);
+		if (partidx >= 0 && !bms_is_member(partidx, partitions))
+			result = bms_add_member(result, appinfo->child_relid);
+	}
+
+	heap_close(partrel, NoLock);
+
+	return result;
+}
+
+/*
+ * make_partition_pruneinfo
+ *	  Build the information needed to prune the children of partitioned
+ *	  table 'rel', scanned by 'subpaths', at execution time, using those of
+ *	  'clauses' (a list of bare clauses) that compare the partition key
+ *	  with an expression that is only known then.
+ *
+ * Returns NULL if no clause allows run-time pruning.
+ */
+PartitionPruneInfo *
+make_partition_pruneinfo(PlannerInfo *root, RelOptInfo *rel,
+						 List *subpaths, List *clauses)
+{
+	RangeTblEntry *rte = planner_rt_fetch(rel->relid, root);
+	Relation	partrel;
+	PartitionKey partkey;
+	Expr	   *keyexpr;
+	PartitionPruneInfo *pinfo;
+	List	   *exprs = NIL;
+	List	   *strategies = NIL;
+	List	   *subplan_partidx = NIL;
+	bool		have_runtime_value = false;
+	PartitionMember *members;
+	int			nmembers;
+	ListCell   *lc;
+
+	Assert(rte->relkind == RELKIND_PARTITIONED_TABLE);
+
+	partrel = heap_open(rte->relid, NoLock);
+	partkey = RelationGetPartitionKey(partrel);
+	keyexpr = make_partkey_expr(partkey, rel->relid);
+
+	foreach(lc, clauses)
+	{
+		Expr	   *clause = (Expr *) lfirst(lc);
+		int			strategy;
+		Expr	   *value;
+
+		if (!match_clause_to_partkey(partkey, keyexpr, clause,
+									 &strategy, &value))
+			continue;
+
+		/*
+		 * Constants were already used at plan time, but they may still
+		 * narrow the range together with the run-time values.  SubPlans
+		 * would need a parent plan to run in, so skip them.
+		 */
+		if (value != NULL && !IsA(value, Const))
+		{
+			if (contain_subplans((Node *) value))
+				continue;
+			have_runtime_value = true;
+		}
+
+		exprs = lappend(exprs, value);
+		strategies = lappend_int(strategies, strategy);
+	}
+
+	if (!have_runtime_value)
+	{
+		heap_close(partrel, NoLock);
+		return NULL;
+	}
+
+	members = get_partition_members(partrel, &nmembers);
+	foreach(lc, subpaths)
+	{
+		Path	   *subpath = (Path *) lfirst(lc);
+		RelOptInfo *childrel = subpath->parent;
+		int			partidx = -1;
+
+		if (childrel->reloptkind == RELOPT_OTHER_MEMBER_REL)
+		{
+			RangeTblEntry *childrte = planner_rt_fetch(childrel->relid, root);
+
+			partidx = get_partition_member_index(members, nmembers,
+												 childrte->relid);
+		}
+		subplan_partidx = lappend_int(subplan_partidx, partidx);
+	}
+
+	heap_close(partrel, NoLock);
+
+	pinfo = makeNode(PartitionPruneInfo);
+	pinfo->reloid = rte->relid;
+	pinfo->exprs = exprs;
+	pinfo->strategies = strategies;
+	pinfo->subplan_partidx = subplan_partidx;
+	pinfo->exec_params = contain_exec_param_walker((Node *) exprs, NULL);
+
+	return pinfo;
+}
+
+/*
+ * make_partkey_expr
+ *	  Build an expression for the first partition key column, as it would
+ *	  appear in quals on the table with RT index varno.
+ */
+static Expr *
+make_partkey_expr(PartitionKey partkey, Index varno)
+{
+	Expr	   *keyexpr;
+
+	if (partkey->partattrs[0] != 0)
+		return (Expr *) makeVar(varno, partkey->partattrs[0],
+								partkey->parttypid[0],
+								partkey->parttypmod[0],
+								partkey->parttypcoll[0],
+								0);
+
+	/* The key's expressions are stored with varno 1 */
+	keyexpr = (Expr *) copyObject(linitial(partkey->partexprs));
+	if (varno != 1)
+		ChangeVarNodes((Node *) keyexpr, 1, varno, 0);
+
+	return keyexpr;
+}
+
+/*
+ * match_partkey_expr
+ *	  Is 'expr' the partition key column 'keyexpr', possibly relabeled?
+ */
+static bool
+match_partkey_expr(Expr *expr, Expr *keyexpr)
+{
+	while (IsA(expr, RelabelType))
+		expr = ((RelabelType *) expr)->arg;
+
+	/* For a plain column, don't insist on matching varnoold etc. */
+	if (IsA(keyexpr, Var))
+		return IsA(expr, Var) &&
+			((Var *) expr)->varno == ((Var *) keyexpr)->varno &&
+			((Var *) expr)->varattno == ((Var *) keyexpr)->varattno &&
+			((Var *) expr)->varlevelsup == 0;
+
+	return equal(expr, keyexpr);
+}
+
+/*
+ * match_clause_to_partkey
+ *	  Is 'clause' usable to prune partitions on the first partition key
+ *	  column, 'keyexpr'?
+ *
+ * We accept "key op value", "value op key" where op is a member of the key's
+ * btree operator family taking the opclass input type on both sides, and
+ * value contains no Vars or volatile functions; and "key IS [NOT] NULL".  On
+ * success, *strategy is set to the btree strategy number the clause applies
+ * to the key with, or the pseudo strategy for a NullTest, and *value to the
+ * value expression, or NULL for a NullTest.
+ */
+static bool
+match_clause_to_partkey(PartitionKey partkey, Expr *keyexpr, Expr *clause,
+						int *strategy, Expr **value)
+{
+	if (IsA(clause, OpExpr) && list_length(((OpExpr *) clause)->args) == 2)
+	{
+		OpExpr	   *opclause = (OpExpr *) clause;
+		Expr	   *leftop = (Expr *) linitial(opclause->args);
+		Expr	   *rightop = (Expr *) lsecond(opclause->args);
+		Expr	   *valueop;
+		bool		commuted;
+		int			op_strategy;
+		Oid			lefttype;
+		Oid			righttype;
+
+		if (match_partkey_expr(leftop, keyexpr))
+		{
+			valueop = rightop;
+			commuted = false;
+		}
+		else if (match_partkey_expr(rightop, keyexpr))
+		{
+			valueop = leftop;
+			commuted = true;
+		}
+		else
+			return false;
+
+		/* The operator has to compare the same way the bounds were sorted */
+		if (!op_in_opfamily(opclause->opno, partkey->partopfamily[0]))
+			return false;
+		get_op_opfamily_properties(opclause->opno, partkey->partopfamily[0],
+								   false, &op_strategy,
+								   &lefttype, &righttype);
+		if (lefttype != partkey->partopcintype[0] ||
+			righttype != partkey->partopcintype[0])
+			return false;
+		if (OidIsValid(partkey->partcollation[0]) &&
+			opclause->inputcollid != partkey->partcollation[0])
+			return false;
+
+		if (contain_var_clause((Node *) valueop) ||
+			contain_volatile_functions((Node *) valueop))
+			return false;
+
+		if (commuted)
+		{
+			switch (op_strategy)
+			{
+				case BTLessStrategyNumber:
+					op_strategy = BTGreaterStrategyNumber;
+					break;
+				case BTLessEqualStrategyNumber:
+					op_strategy = BTGreaterEqualStrategyNumber;
+					break;
+				case BTGreaterEqualStrategyNumber:
+					op_strategy = BTLessEqualStrategyNumber;
+					break;
+				case BTGreaterStrategyNumber:
+					op_strategy = BTLessStrategyNumber;
+					break;
+			}
+		}
+
+		*strategy = op_strategy;
+		*value = valueop;
+		return true;
+	}
+	else if (IsA(clause, NullTest))
+	{
+		NullTest   *ntest = (NullTest *) clause;
+
+		if (ntest->argisrow || !match_partkey_expr(ntest->arg, keyexpr))
+			return false;
+
+		*strategy = (ntest->nulltesttype == IS_NULL) ?
+			PARTITION_PRUNE_IS_NULL : PARTITION_PRUNE_IS_NOT_NULL;
+		*value = NULL;
+		return true;
+	}
+
+	return false;
+}
+
+/*
+ * get_partition_members
+ *	  Return an array of all the leaf tables under partitioned table
+ *	  'partrel', each with the index of the top-level partition containing
+ *	  it, sorted by OID.
+ */
+static PartitionMember *
+get_partition_members(Relation partrel, int *nmembers)
+{
+	PartitionDesc partdesc = RelationGetPartitionDesc(partrel);
+	PartitionMember *members = NULL;
+	int			n = 0;
+	int			maxmembers = partdesc->nparts;
+	int			i;
+
+	if (maxmembers > 0)
+		members = (PartitionMember *)
+			palloc(maxmembers * sizeof(PartitionMember));
+
+	for (i = 0; i < partdesc->nparts; i++)
+	{
+		Oid			partoid = partdesc->oids[i];
+		List	   *inhoids;
+		ListCell   *lc;
+
+		if (get_rel_relkind(partoid) != RELKIND_PARTITIONED_TABLE)
+		{
+			members[n].relid = partoid;
+			members[n].partidx = i;
+			n++;
+			continue;
+		}
+
+		/* expansion already locked all of the sub-partitions */
+		inhoids = find_all_inheritors(partoid, NoLock, NULL);
+		foreach(lc, inhoids)
+		{
+			if (n >= maxmembers)
+			{
+				maxmembers *= 2;
+				members = (PartitionMember *)
+					repalloc(members, maxmembers * sizeof(PartitionMember));
+			}
+			members[n].relid = lfirst_oid(lc);
+			members[n].partidx = i;
+			n++;
+		}
+		list_free(inhoids);
+	}
+
+	if (n > 1)
+		qsort(members, n, sizeof(PartitionMember), partition_member_cmp);
+
+	*nmembers = n;
+	return members;
+}
+
+static int
+partition_member_cmp(const void *a, const void *b)
+{
+	Oid			oida = ((const PartitionMember *) a)->relid;
+	Oid			oidb = ((const PartitionMember *) b)->relid;
+
+	if (oida < oidb)
+		return -1;
+	if (oida > oidb)
+		return 1;
+	return 0;
+}
+
+/*
+ * get_partition_member_index
+ *	  Return the top-level partition index for leaf table 'relid', or -1 if
+ *	  it's not under the partitioned table.
+ */
+static int
+get_partition_member_index(PartitionMember *members, int nmembers, Oid relid)
+{
+	PartitionMember key;
+	PartitionMember *member;
+
+	if (nmembers == 0)
+		return -1;
+
+	key.relid = relid;
+	member = (PartitionMember *) bsearch(&key, members, nmembers,
+										 sizeof(PartitionMember),
+										 partition_member_cmp);
+
+	return member ? member->partidx : -1;
+}
+
+/*
+ * contain_exec_param_walker
+ *	  Does the expression reference any PARAM_EXEC Params?
+ */
+static bool
+contain_exec_param_walker(Node *node, void *context)
+{
+	if (node == NULL)
+		return false;
+	if (IsA(node, Param))
+		return ((Param *) node)->paramkind == PARAM_EXEC;
+	return expression_tree_walker(node, contain_exec_param_walker, context);
+}
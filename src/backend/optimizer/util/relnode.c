@@ -16,6 +16,8 @@
 
 #include <limits.h>
 
+#include "access/heapam.h"
+#include "catalog/partition.h"
 #include "miscadmin.h"
 #include "optimizer/clauses.h"
 #include "optimizer/cost.h"
@@ -23,9 +25,11 @@
 #include "optimizer/paths.h"
 #include "optimizer/placeholder.h"
 #include "optimizer/plancat.h"
+#include "optimizer/prep.h"
 #include "optimizer/restrictinfo.h"
 #include "optimizer/tlist.h"
 #include "utils/hsearch.h"
+#include "utils/rel.h"
 
 
 typedef struct JoinHashEntry
@@ -52,6 +56,11 @@ static List *subbuild_joinrel_joinlist(RelOptInfo *joinrel,
 static void set_foreign_rel_properties(RelOptInfo *joinrel,
 						   RelOptInfo *outer_rel, RelOptInfo *inner_rel);
 static void add_join_rel(PlannerInfo *root, RelOptInfo *joinrel);
+static void set_baserel_partition_rels(PlannerInfo *root, RelOptInfo *rel,
+						   RangeTblEntry *rte);
+static void build_joinrel_partition_info(RelOptInfo *joinrel,
+							 RelOptInfo *outer_rel, RelOptInfo *inner_rel,
+							 List *restrictlist, JoinType jointype);
 
 
 /*
@@ -146,6 +155,12 @@ build_simple_rel(PlannerInfo *root, int relid, RelOptInfo *parent)
 	rel->baserestrict_min_security = UINT_MAX;
 	rel->joininfo = NIL;
 	rel->has_eclass_joins = false;
+	rel->part_scheme = NULL;
+	rel->nparts = 0;
+	rel->boundinfo = NULL;
+	rel->part_rels = NULL;
+	rel->partexprs = NULL;
+	rel->nullable_partexprs = NULL;
 
 	/*
 	 * Pass top parent's relids down the inheritance hierarchy. If the parent
@@ -230,11 +245,80 @@ build_simple_rel(PlannerInfo *root, int relid, RelOptInfo *parent)
 			(void) build_simple_rel(root, appinfo->child_relid,
 									rel);
 		}
+
+		/* Line the partitions up in bound order, for partition-wise joins */
+		if (rel->part_scheme)
+			set_baserel_partition_rels(root, rel, rte);
 	}
 
 	return rel;
 }
 
+/*
+ * set_baserel_partition_rels
+ *	  Fill in rel->part_rels for a partitioned base relation, whose children
+ *	  have just been built.
+ *
+ * The partitions are put in the order of the relation's partition bounds, so
+ * that the i'th partition of two relations with equal bounds hold matching
+ * rows.  If any partition lacks a RelOptInfo, the relation is treated as not
+ * partitioned for planning purposes.
+ */
+static void
+set_baserel_partition_rels(PlannerInfo *root, RelOptInfo *rel,
+						   RangeTblEntry *rte)
+{
+	Relation	relation;
+	PartitionDesc partdesc;
+	RelOptInfo **part_rels;
+	ListCell   *l;
+	int			i;
+
+	/* The relation is already locked, and its partitioning is known valid */
+	relation = heap_open(rte->relid, NoLock);
+	partdesc = RelationGetPartitionDesc(relation);
+	Assert(partdesc->nparts == rel->nparts);
+
+	part_rels = (RelOptInfo **) palloc0(sizeof(RelOptInfo *) * rel->nparts);
+
+	foreach(l, root->append_rel_list)
+	{
+		AppendRelInfo *appinfo = (AppendRelInfo *) lfirst(l);
+		Oid			childoid;
+
+		if (appinfo->parent_relid != rel->relid)
+			continue;
+
+		childoid = root->simple_rte_array[appinfo->child_relid]->relid;
+		for (i = 0; i < partdesc->nparts; i++)
+		{
+			if (partdesc->oids[i] == childoid)
+			{
+				part_rels[i] = root->simple_rel_array[appinfo->child_relid];
+				break;
+			}
+		}
+	}
+
+	heap_close(relation, NoLock);
+
+	for (i = 0; i < rel->nparts; i++)
+	{
+		if (part_rels[i] == NULL)
+		{
+			pfree(part_rels);
+			rel->part_scheme = NULL;
+			rel->nparts = 0;
+			rel->boundinfo = NULL;
+			rel->partexprs = NULL;
+			rel->nullable_partexprs = NULL;
+			return;
+		}
+	}
+
+	rel->part_rels = part_rels;
+}
+
 /*
  * find_base_rel
  *	  Find a base or other relation entry, which must already exist.
@@ -527,6 +611,12 @@ build_join_rel(PlannerInfo *root,
 	joinrel->joininfo = NIL;
 	joinrel->has_eclass_joins = false;
 	joinrel->top_parent_relids = NULL;
+	joinrel->part_scheme = NULL;
+	joinrel->nparts = 0;
+	joinrel->boundinfo = NULL;
+	joinrel->part_rels = NULL;
+	joinrel->partexprs = NULL;
+	joinrel->nullable_partexprs = NULL;
 
 	/* Compute information relevant to the foreign relations. */
 	set_foreign_rel_properties(joinrel, outer_rel, inner_rel);
@@ -578,6 +668,10 @@ build_join_rel(PlannerInfo *root,
 	set_joinrel_size_estimates(root, joinrel, outer_rel, inner_rel,
 							   sjinfo, restrictlist);
 
+	/* Is the join between partitioned relations itself partitioned? */
+	build_joinrel_partition_info(joinrel, outer_rel, inner_rel, restrictlist,
+								 sjinfo->jointype);
+
 	/*
 	 * Set the consider_parallel flag if this joinrel could potentially be
 	 * scanned within a parallel worker.  If this flag is false for either
@@ -617,6 +711,113 @@ build_join_rel(PlannerInfo *root,
 	return joinrel;
 }
 
+/*
+ * build_child_join_rel
+ *	  Builds RelOptInfo representing join between given two child relations.
+ *
+ * 'outer_rel' and 'inner_rel' are the RelOptInfos of child relations being
+ *		joined
+ * 'parent_joinrel' is the RelOptInfo representing the join between parent
+ *		relations.  The child join's targetlist and join clauses are produced
+ *		by translating the parent's.
+ * 'restrictlist': list of RestrictInfo nodes that apply to this particular
+ *		pair of joinable relations, already translated
+ * 'sjinfo': child-join context info
+ *
+ * A child join is not entered in the planner's join lists; it can only be
+ * reached through its parent's part_rels array.
+ */
+RelOptInfo *
+build_child_join_rel(PlannerInfo *root, RelOptInfo *outer_rel,
+					 RelOptInfo *inner_rel, RelOptInfo *parent_joinrel,
+					 List *restrictlist, SpecialJoinInfo *sjinfo)
+{
+	RelOptInfo *joinrel = makeNode(RelOptInfo);
+	List	   *appinfos;
+
+	/* Only joins between "other" relations land here. */
+	Assert(IS_OTHER_REL(outer_rel) && IS_OTHER_REL(inner_rel));
+
+	joinrel->reloptkind = RELOPT_OTHER_JOINREL;
+	joinrel->relids = bms_union(outer_rel->relids, inner_rel->relids);
+	joinrel->rows = 0;
+	/* cheap startup cost is interesting iff not all tuples to be retrieved */
+	joinrel->consider_startup = (root->tuple_fraction > 0);
+	joinrel->consider_param_startup = false;
+	/* child join is parallel safe if parent is */
+	joinrel->consider_parallel = parent_joinrel->consider_parallel;
+	joinrel->pathlist = NIL;
+	joinrel->ppilist = NIL;
+	joinrel->partial_pathlist = NIL;
+	joinrel->cheapest_startup_path = NULL;
+	joinrel->cheapest_total_path = NULL;
+	joinrel->cheapest_unique_path = NULL;
+	joinrel->cheapest_parameterized_paths = NIL;
+	/* partition-wise joins are not attempted below LATERAL references */
+	Assert(parent_joinrel->lateral_relids == NULL);
+	joinrel->direct_lateral_relids = NULL;
+	joinrel->lateral_relids = NULL;
+	joinrel->relid = 0;			/* indicates not a baserel */
+	joinrel->rtekind = RTE_JOIN;
+	joinrel->min_attr = 0;
+	joinrel->max_attr = 0;
+	joinrel->attr_needed = NULL;
+	joinrel->attr_widths = NULL;
+	joinrel->lateral_vars = NIL;
+	joinrel->lateral_referencers = NULL;
+	joinrel->indexlist = NIL;
+	joinrel->statlist = NIL;
+	joinrel->pages = 0;
+	joinrel->tuples = 0;
+	joinrel->allvisfrac = 0;
+	joinrel->subroot = NULL;
+	joinrel->subplan_params = NIL;
+	joinrel->rel_parallel_workers = -1;
+	joinrel->serverid = InvalidOid;
+	joinrel->userid = InvalidOid;
+	joinrel->useridiscurrent = false;
+	joinrel->fdwroutine = NULL;
+	joinrel->fdw_private = NULL;
+	joinrel->unique_for_rels = NIL;
+	joinrel->non_unique_for_rels = NIL;
+	joinrel->baserestrictinfo = NIL;
+	joinrel->baserestrictcost.startup = 0;
+	joinrel->baserestrictcost.per_tuple = 0;
+	joinrel->baserestrict_min_security = UINT_MAX;
+	joinrel->top_parent_relids = bms_union(outer_rel->top_parent_relids,
+										   inner_rel->top_parent_relids);
+	joinrel->part_scheme = NULL;
+	joinrel->nparts = 0;
+	joinrel->boundinfo = NULL;
+	joinrel->part_rels = NULL;
+	joinrel->partexprs = NULL;
+	joinrel->nullable_partexprs = NULL;
+
+	/*
+	 * The child join emits the same columns as its parent, and takes part in
+	 * the same join clauses further up, all translated to refer to the
+	 * children.
+	 */
+	appinfos = find_appinfos_by_relids(root, joinrel->relids);
+	joinrel->reltarget = copy_pathtarget(parent_joinrel->reltarget);
+	joinrel->reltarget->exprs = (List *)
+		adjust_appendrel_attrs_list(root,
+									(Node *) joinrel->reltarget->exprs,
+									appinfos);
+	joinrel->joininfo = (List *)
+		adjust_appendrel_attrs_list(root,
+									(Node *) parent_joinrel->joininfo,
+									appinfos);
+	joinrel->has_eclass_joins = parent_joinrel->has_eclass_joins;
+	list_free(appinfos);
+
+	/* Set estimates of the child-joinrel's size. */
+	set_joinrel_size_estimates(root, joinrel, outer_rel, inner_rel,
+							   sjinfo, restrictlist);
+
+	return joinrel;
+}
+
 /*
  * min_join_parameterization
  *
@@ -1359,3 +1560,161 @@ get_appendrel_parampathinfo(RelOptInfo *appendrel, Relids required_outer)
 
 	return ppi;
 }
+
+/*
+ * build_joinrel_partition_info
+ *		If the two relations have same partitioning scheme, their join may be
+ *		partitioned and will follow the same partitioning scheme as the joining
+ *		relations.  Set the partition scheme and partition key expressions in
+ *		the join relation.
+ */
+static void
+build_joinrel_partition_info(RelOptInfo *joinrel, RelOptInfo *outer_rel,
+							 RelOptInfo *inner_rel, List *restrictlist,
+							 JoinType jointype)
+{
+	int			partnatts;
+	int			cnt;
+	PartitionScheme part_scheme;
+	ListCell   *lc;
+
+	/* Nothing to do if partition-wise join technique is disabled. */
+	if (!enable_partitionwise_join)
+		return;
+
+	/*
+	 * We can only consider this join as an input to further partition-wise
+	 * joins if (a) the input relations are partitioned, (b) the partition
+	 * schemes match, and (c) we can identify an equi-join between the
+	 * partition keys.
+	 */
+	if (!IS_PARTITIONED_REL(outer_rel) || !IS_PARTITIONED_REL(inner_rel) ||
+		outer_rel->part_scheme != inner_rel->part_scheme ||
+		!have_partkey_equi_join(joinrel, outer_rel, inner_rel,
+								jointype, restrictlist))
+		return;
+
+	/*
+	 * Child joins are built by translating the parent join's targetlist and
+	 * clauses, which is only done for plain column references, and never
+	 * below a LATERAL reference.
+	 */
+	if (joinrel->lateral_relids != NULL ||
+		outer_rel->lateral_relids != NULL ||
+		inner_rel->lateral_relids != NULL)
+		return;
+	foreach(lc, joinrel->reltarget->exprs)
+	{
+		Var		   *var = (Var *) lfirst(lc);
+
+		if (!IsA(var, Var) || var->varattno == 0)
+			return;
+	}
+
+	part_scheme = outer_rel->part_scheme;
+
+	/*
+	 * For now, our partition matching algorithm can match partitions only
+	 * when the partition bounds of the joining relations are exactly same.
+	 * So, bail out otherwise.
+	 */
+	if (outer_rel->nparts != inner_rel->nparts ||
+		!partition_bounds_equal(part_scheme->partnatts,
+								part_scheme->parttyplen,
+								part_scheme->parttypbyval,
+								outer_rel->boundinfo, inner_rel->boundinfo))
+		return;
+
+	/*
+	 * Join relation is partitioned using the same partitioning scheme as the
+	 * joining relations and has same bounds.
+	 */
+	joinrel->part_scheme = part_scheme;
+	joinrel->boundinfo = outer_rel->boundinfo;
+	joinrel->nparts = outer_rel->nparts;
+	partnatts = joinrel->part_scheme->partnatts;
+	joinrel->partexprs = (List **) palloc0(sizeof(List *) * partnatts);
+	joinrel->nullable_partexprs =
+		(List **) palloc0(sizeof(List *) * partnatts);
+	joinrel->part_rels =
+		(RelOptInfo **) palloc0(sizeof(RelOptInfo *) * joinrel->nparts);
+
+	/*
+	 * Construct partition keys for the join.
+	 *
+	 * An INNER join between two partitioned relations can be regarded as
+	 * partitioned by either key expression.  For example, A INNER JOIN B ON
+	 * A.a = B.b can be regarded as partitioned on A.a or on B.b; they are
+	 * equivalent.
+	 *
+	 * For a SEMI or ANTI join, the result can only be regarded as being
+	 * partitioned in the same manner as the outer side, since the inner
+	 * columns are not retained.
+	 *
+	 * An OUTER join like (A LEFT JOIN B ON A.a = B.b) may produce rows with
+	 * B.b NULL.  These rows may not fit the partitioning conditions imposed
+	 * on B.b.  Hence, strictly speaking, the join is not partitioned by B.b
+	 * and thus partition keys of an OUTER join should include partition key
+	 * expressions from the OUTER side only.  However, because all
+	 * commonly-used comparison operators are strict, the presence of nulls on
+	 * the outer side doesn't cause any problem; they can't match anything at
+	 * future join levels anyway.  Therefore, we track two sets of
+	 * expressions: those that authentically partition the relation
+	 * (partexprs) and those that partition the relation with the exception
+	 * that extra nulls may be present (nullable_partexprs).  When the
+	 * comparison operator is strict, the latter is just as good as the
+	 * former.
+	 */
+	for (cnt = 0; cnt < partnatts; cnt++)
+	{
+		List	   *outer_expr;
+		List	   *outer_null_expr;
+		List	   *inner_expr;
+		List	   *inner_null_expr;
+		List	   *partexpr = NIL;
+		List	   *nullable_partexpr = NIL;
+
+		outer_expr = list_copy(outer_rel->partexprs[cnt]);
+		outer_null_expr = list_copy(outer_rel->nullable_partexprs[cnt]);
+		inner_expr = list_copy(inner_rel->partexprs[cnt]);
+		inner_null_expr = list_copy(inner_rel->nullable_partexprs[cnt]);
+
+		switch (jointype)
+		{
+			case JOIN_INNER:
+				partexpr = list_concat(outer_expr, inner_expr);
+				nullable_partexpr = list_concat(outer_null_expr,
+												inner_null_expr);
+				break;
+
+			case JOIN_SEMI:
+			case JOIN_ANTI:
+				partexpr = outer_expr;
+				nullable_partexpr = outer_null_expr;
+				break;
+
+			case JOIN_LEFT:
+				partexpr = outer_expr;
+				nullable_partexpr = list_concat(inner_expr,
+												outer_null_expr);
+				nullable_partexpr = list_concat(nullable_partexpr,
+												inner_null_expr);
+				break;
+
+			case JOIN_FULL:
+				nullable_partexpr = list_concat(outer_expr,
+												inner_expr);
+				nullable_partexpr = list_concat(nullable_partexpr,
+												outer_null_expr);
+				nullable_partexpr = list_concat(nullable_partexpr,
+												inner_null_expr);
+				break;
+
+			default:
+				elog(ERROR, "unrecognized join type: %d", (int) jointype);
+		}
+
+		joinrel->partexprs[cnt] = partexpr;
+		joinrel->nullable_partexprs[cnt] = nullable_partexpr;
+	}
+}
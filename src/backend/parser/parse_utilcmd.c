@@ -1431,7 +1431,7 @@ generateClonedIndexStmt(CreateStmtContext *cxt, Relation source_idx,
 	index->indexParams = NIL;
 
 	indexpr_item = list_head(indexprs);
-	for (keyno = 0; keyno < idxrec->indnatts; keyno++)
+	for (keyno = 0; keyno < idxrec->indnkeyatts; keyno++)
 	{
 		IndexElem  *iparam;
 		AttrNumber	attnum = idxrec->indkey.values[keyno];
@@ -1518,6 +1518,28 @@ generateClonedIndexStmt(CreateStmtContext *cxt, Relation source_idx,
 		index->indexParams = lappend(index->indexParams, iparam);
 	}
 
+	/* Handle included columns separately; they are always plain columns */
+	index->indexIncludingParams = NIL;
+	for (keyno = idxrec->indnkeyatts; keyno < idxrec->indnatts; keyno++)
+	{
+		IndexElem  *iparam;
+		AttrNumber	attnum = idxrec->indkey.values[keyno];
+
+		if (!AttributeNumberIsValid(attnum))
+			elog(ERROR, "expressions are not supported in included columns");
+
+		iparam = makeNode(IndexElem);
+		iparam->name = get_relid_attribute_name(indrelid, attnum);
+		iparam->expr = NULL;
+		iparam->indexcolname = pstrdup(NameStr(attrs[keyno]->attname));
+		iparam->collation = NIL;
+		iparam->opclass = NIL;
+		iparam->ordering = SORTBY_DEFAULT;
+		iparam->nulls_ordering = SORTBY_NULLS_DEFAULT;
+		index->indexIncludingParams = lappend(index->indexIncludingParams,
+											  iparam);
+	}
+
 	/* Copy reloptions if any */
 	datum = SysCacheGetAttr(RELOID, ht_idxrel,
 							Anum_pg_class_reloptions, &isnull);
@@ -1709,6 +1731,7 @@ transformIndexConstraints(CreateStmtContext *cxt)
 			IndexStmt  *priorindex = lfirst(k);
 
 			if (equal(index->indexParams, priorindex->indexParams) &&
+				equal(index->indexIncludingParams, priorindex->indexIncludingParams) &&
 				equal(index->whereClause, priorindex->whereClause) &&
 				equal(index->excludeOpNames, priorindex->excludeOpNames) &&
 				strcmp(index->accessMethod, priorindex->accessMethod) == 0 &&
@@ -1901,6 +1924,17 @@ transformIndexConstraint(Constraint *constraint, CreateStmtContext *cxt)
 					 errmsg("index \"%s\" is not a btree", index_name),
 					 parser_errposition(cxt->pstate, constraint->location)));
 
+		/*
+		 * Constraint syntax has no way to spell included columns, so an
+		 * index that has any can't be reproduced from the constraint.
+		 */
+		if (index_form->indnkeyatts != index_form->indnatts)
+			ereport(ERROR,
+					(errcode(ERRCODE_WRONG_OBJECT_TYPE),
+					 errmsg("index \"%s\" has included columns", index_name),
+					 errdetail("Cannot create a primary key or unique constraint using such an index."),
+					 parser_errposition(cxt->pstate, constraint->location)));
+
 		/* Must get indclass the hard way */
 		indclassDatum = SysCacheGetAttr(INDEXRELID, index_rel->rd_indextuple,
 										Anum_pg_index_indclass, &isnull);
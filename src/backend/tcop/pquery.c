@@ -924,6 +924,14 @@ PortalRunSelect(Portal portal,
 	 */
 	if (forward)
 	{
+		/*
+		 * totem: an IQP cursor that stopped at the end of a round is not at
+		 * its end; the next fetch refreshes it with the newer deltas
+		 */
+		if (portal->atEnd && !portal->holdStore &&
+			queryDesc->estate->incRefreshPending)
+			portal->atEnd = false;
+
 		if (portal->atEnd || count <= 0)
 		{
 			direction = NoMovementScanDirection;
@@ -166,6 +166,7 @@ indexam_property(FunctionCallInfo fcinfo,
 	bool		res = false;
 	bool		isnull = false;
 	int			natts = 0;
+	int			nkeyatts = 0;
 	IndexAMProperty prop;
 	IndexAmRoutine *routine;
 
@@ -191,6 +192,12 @@ indexam_property(FunctionCallInfo fcinfo,
 		amoid = rd_rel->relam;
 		natts = rd_rel->relnatts;
 		ReleaseSysCache(tuple);
+
+		tuple = SearchSysCache1(INDEXRELID, ObjectIdGetDatum(index_oid));
+		if (!HeapTupleIsValid(tuple))
+			PG_RETURN_NULL();
+		nkeyatts = ((Form_pg_index) GETSTRUCT(tuple))->indnkeyatts;
+		ReleaseSysCache(tuple);
 	}
 
 	/*
@@ -221,6 +228,31 @@ indexam_property(FunctionCallInfo fcinfo,
 		PG_RETURN_BOOL(res);
 	}
 
+	if (attno > nkeyatts)
+	{
+		/*
+		 * Included columns are only stored, never searched or ordered by, so
+		 * of the column-level properties only returnability can apply.
+		 */
+		switch (prop)
+		{
+			case AMPROP_ASC:
+			case AMPROP_DESC:
+			case AMPROP_NULLS_FIRST:
+			case AMPROP_NULLS_LAST:
+				PG_RETURN_NULL();
+
+			case AMPROP_ORDERABLE:
+			case AMPROP_DISTANCE_ORDERABLE:
+			case AMPROP_SEARCH_ARRAY:
+			case AMPROP_SEARCH_NULLS:
+				PG_RETURN_BOOL(false);
+
+			default:
+				break;
+		}
+	}
+
 	if (attno > 0)
 	{
 		/* Handle column-level properties */
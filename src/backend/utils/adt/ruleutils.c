@@ -1279,6 +1279,21 @@ pg_get_indexdef_worker(Oid indexrelid, int colno,
 		Oid			keycoltype;
 		Oid			keycolcollation;
 
+		/*
+		 * Included columns come after the key columns.  A bare column list is
+		 * only wanted for the key; otherwise they go in an INCLUDE clause.
+		 */
+		if (keyno >= idxrec->indnkeyatts)
+		{
+			if (attrsOnly && !colno)
+				break;
+			if (!colno && keyno == idxrec->indnkeyatts)
+			{
+				appendStringInfoString(&buf, ") INCLUDE (");
+				sep = "";
+			}
+		}
+
 		if (!colno)
 			appendStringInfoString(&buf, sep);
 		sep = ", ";
@@ -1320,7 +1335,8 @@ pg_get_indexdef_worker(Oid indexrelid, int colno,
 			keycolcollation = exprCollation(indexkey);
 		}
 
-		if (!attrsOnly && (!colno || colno == keyno + 1))
+		if (!attrsOnly && keyno < idxrec->indnkeyatts &&
+			(!colno || colno == keyno + 1))
 		{
 			Oid			indcoll;
 
@@ -4682,7 +4682,7 @@ examine_variable(PlannerInfo *root, Node *node, int varRelid,
 						 * should match has_unique_index().
 						 */
 						if (index->unique &&
-							index->ncolumns == 1 &&
+							index->nkeycolumns == 1 &&
 							(index->indpred == NIL || index->predOK))
 							vardata->isunique = true;
 
@@ -6488,6 +6488,10 @@ genericcostestimate(PlannerInfo *root,
 		}
 	}
 
+	/* A skip scan performs one indexscan per value it skips to */
+	if (costs->num_skip_scans > 1)
+		num_sa_scans *= costs->num_skip_scans;
+
 	/* Estimate the fraction of main-table tuples that will be visited */
 	indexSelectivity = clauselist_selectivity(root, selectivityQuals,
 											  index->rel->relid,
@@ -6506,10 +6510,10 @@ genericcostestimate(PlannerInfo *root,
 
 		/*
 		 * The above calculation counts all the tuples visited across all
-		 * scans induced by ScalarArrayOpExpr nodes.  We want to consider the
-		 * average per-indexscan number, so adjust.  This is a handy place to
-		 * round to integer, too.  (If caller supplied tuple estimate, it's
-		 * responsible for handling these considerations.)
+		 * scans induced by ScalarArrayOpExpr nodes or a skip scan.  We want
+		 * to consider the average per-indexscan number, so adjust.  This is
+		 * a handy place to round to integer, too.  (If caller supplied tuple
+		 * estimate, it's responsible for handling these considerations.)
 		 */
 		numIndexTuples = rint(numIndexTuples / num_sa_scans);
 	}
@@ -6698,11 +6702,28 @@ btcostestimate(PlannerInfo *root, IndexPath *path, double loop_count,
 	bool		found_saop;
 	bool		found_is_null_op;
 	double		num_sa_scans;
+	double		num_skip_scans;
 	ListCell   *lc;
 
 	/* Do preliminary analysis of indexquals */
 	qinfos = deconstruct_indexquals(path);
 
+	/*
+	 * A skip scan does a separate index scan for each distinct value of the
+	 * first column, so estimate how many of those there are.  The first
+	 * column has no quals in that case, so boundary quals start at the
+	 * second column.
+	 */
+	num_skip_scans = 1;
+	if (path->indexskip)
+	{
+		TargetEntry *tle = (TargetEntry *) linitial(index->indextlist);
+
+		num_skip_scans = estimate_num_groups(root, list_make1(tle->expr),
+											 Max(index->tuples, 1.0),
+											 NULL);
+	}
+
 	/*
 	 * For a btree scan, only leading '=' quals plus inequality quals for the
 	 * immediately next attribute contribute to index selectivity (these are
@@ -6721,7 +6742,7 @@ btcostestimate(PlannerInfo *root, IndexPath *path, double loop_count,
 	 * considered to act the same as it normally does.
 	 */
 	indexBoundQuals = NIL;
-	indexcol = 0;
+	indexcol = path->indexskip ? 1 : 0;
 	eqQualHere = false;
 	found_saop = false;
 	found_is_null_op = false;
@@ -6793,8 +6814,9 @@ btcostestimate(PlannerInfo *root, IndexPath *path, double loop_count,
 	 * NullTest invalidates that theory, even though it sets eqQualHere.
 	 */
 	if (index->unique &&
-		indexcol == index->ncolumns - 1 &&
+		indexcol == index->nkeycolumns - 1 &&
 		eqQualHere &&
+		!path->indexskip &&
 		!found_saop &&
 		!found_is_null_op)
 		numIndexTuples = 1.0;
@@ -6818,10 +6840,10 @@ btcostestimate(PlannerInfo *root, IndexPath *path, double loop_count,
 
 		/*
 		 * As in genericcostestimate(), we have to adjust for any
-		 * ScalarArrayOpExpr quals included in indexBoundQuals, and then round
-		 * to integer.
+		 * ScalarArrayOpExpr quals included in indexBoundQuals, and for the
+		 * scans of a skip scan, and then round to integer.
 		 */
-		numIndexTuples = rint(numIndexTuples / num_sa_scans);
+		numIndexTuples = rint(numIndexTuples / (num_sa_scans * num_skip_scans));
 	}
 
 	/*
@@ -6829,6 +6851,7 @@ btcostestimate(PlannerInfo *root, IndexPath *path, double loop_count,
 	 */
 	MemSet(&costs, 0, sizeof(costs));
 	costs.numIndexTuples = numIndexTuples;
+	costs.num_skip_scans = num_skip_scans;
 
 	genericcostestimate(root, path, loop_count, qinfos, &costs);
 
@@ -6864,6 +6887,18 @@ btcostestimate(PlannerInfo *root, IndexPath *path, double loop_count,
 	costs.indexStartupCost += descentCost;
 	costs.indexTotalCost += costs.num_sa_scans * descentCost;
 
+	/*
+	 * A skip scan also descends the tree once per skipped-to value to find
+	 * the next value of the first column.  Charge that like the above.
+	 */
+	if (path->indexskip)
+	{
+		descentCost = (index->tree_height + 1) * 50.0 * cpu_operator_cost;
+		if (index->tuples > 1)
+			descentCost += ceil(log(index->tuples) / log(2.0)) * cpu_operator_cost;
+		costs.indexTotalCost += num_skip_scans * descentCost;
+	}
+
 	/*
 	 * If we can get an estimate of the first column's ordering correlation C
 	 * from pg_statistic, estimate the index correlation as C for a
@@ -6953,7 +6988,7 @@ btcostestimate(PlannerInfo *root, IndexPath *path, double loop_count,
 			if (index->reverse_sort[0])
 				varCorrelation = -varCorrelation;
 
-			if (index->ncolumns > 1)
+			if (index->nkeycolumns > 1)
 				costs.indexCorrelation = varCorrelation * 0.75;
 			else
 				costs.indexCorrelation = varCorrelation;
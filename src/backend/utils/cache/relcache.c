@@ -1208,7 +1208,9 @@ equalPartitionDescs(PartitionKey key, PartitionDesc partdesc1,
 			if (partdesc2->boundinfo == NULL)
 				return false;
 
-			if (!partition_bounds_equal(key, partdesc1->boundinfo,
+			if (!partition_bounds_equal(key->partnatts, key->parttyplen,
+										key->parttypbyval,
+										partdesc1->boundinfo,
 										partdesc2->boundinfo))
 				return false;
 		}
@@ -1627,11 +1629,12 @@ RelationInitIndexAccessInfo(Relation relation)
 	/*
 	 * Fill the support procedure OID array, as well as the info about
 	 * opfamilies and opclass input types.  (aminfo and supportinfo are left
-	 * as zeroes, and are filled on-the-fly when used)
+	 * as zeroes, and are filled on-the-fly when used)  Included columns have
+	 * no opclass, so their entries stay zero.
 	 */
 	IndexSupportInitialize(indclass, relation->rd_support,
 						   relation->rd_opfamily, relation->rd_opcintype,
-						   amsupport, natts);
+						   amsupport, relation->rd_index->indnkeyatts);
 
 	/*
 	 * Similarly extract indoption and copy it to the cache entry
@@ -4953,6 +4956,10 @@ restart:
 				indexattrs = bms_add_member(indexattrs,
 											attrnum - FirstLowInvalidHeapAttributeNumber);
 
+				/* included columns don't make anything unique */
+				if (i >= indexInfo->ii_NumIndexKeyAttrs)
+					continue;
+
 				if (isKey)
 					uindexattrs = bms_add_member(uindexattrs,
 												 attrnum - FirstLowInvalidHeapAttributeNumber);
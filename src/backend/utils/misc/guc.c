@@ -97,6 +97,8 @@
 #include "executor/incmeta.h"
 #include "executor/execTPCH.h"
 #include "executor/dbt.h"
+#include "executor/incDeltaReceiver.h"
+#include "executor/execBatch.h"
 
 #ifndef PG_KRB_SRVTAB
 #define PG_KRB_SRVTAB ""
@@ -842,6 +844,39 @@ static struct config_bool ConfigureNamesBool[] =
         false,
         NULL, NULL, NULL
     },
+    /* totem: generate TPC-H deltas inside the backend */
+    {
+        {"tpch_inproc_delta", PGC_USERSET, QUERY_TUNING_METHOD,
+            gettext_noop("Generate TPC-H deltas in-process instead of running the delta scripts"),
+            NULL
+        },
+        &tpch_inproc_delta,
+        false,
+        NULL, NULL, NULL
+    },
+    /* totem: FETCH from an IQP cursor returns one round at a time */
+    {
+        {"iqp_cursor_refresh", PGC_USERSET, QUERY_TUNING_METHOD,
+            gettext_noop("Makes each FETCH from an IQP cursor stop at the end of a round; the next FETCH processes the deltas that arrived since"),
+            gettext_noop("The kept state lives in the cursor's executor state, so refreshing "
+                         "only works within the transaction that opened the cursor. A WITH HOLD "
+                         "cursor is persisted at commit by one more such FETCH, so it holds a "
+                         "single round's result and is not refreshed afterwards.")
+        },
+        &iqp_cursor_refresh,
+        false,
+        NULL, NULL, NULL
+    },
+    /* totem: send per-round result deltas instead of full results */
+    {
+        {"iqp_delta_output", PGC_USERSET, QUERY_TUNING_METHOD,
+            gettext_noop("Sends the changes between consecutive IQP rounds instead of each round's full result"),
+            NULL
+        },
+        &iqp_delta_output,
+        false,
+        NULL, NULL, NULL
+    },
     {
         {"is_complete", PGC_USERSET, QUERY_TUNING_METHOD,
             gettext_noop("Is the current table complete or not"),
@@ -896,6 +931,15 @@ static struct config_bool ConfigureNamesBool[] =
 		true,
 		NULL, NULL, NULL
 	},
+	{
+		{"enable_indexskipscan", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enables the planner's use of index skip scans."),
+			NULL
+		},
+		&enable_indexskipscan,
+		true,
+		NULL, NULL, NULL
+	},
 	{
 		{"enable_bitmapscan", PGC_USERSET, QUERY_TUNING_METHOD,
 			gettext_noop("Enables the planner's use of bitmap-scan plans."),
@@ -923,6 +967,15 @@ static struct config_bool ConfigureNamesBool[] =
 		true,
 		NULL, NULL, NULL
 	},
+	{
+		{"enable_incremental_sort", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enables the planner's use of incremental sort steps."),
+			NULL
+		},
+		&enable_incremental_sort,
+		true,
+		NULL, NULL, NULL
+	},
 	{
 		{"enable_hashagg", PGC_USERSET, QUERY_TUNING_METHOD,
 			gettext_noop("Enables the planner's use of hashed aggregation plans."),
@@ -932,6 +985,15 @@ static struct config_bool ConfigureNamesBool[] =
 		true,
 		NULL, NULL, NULL
 	},
+	{
+		{"enable_hashagg_disk", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enables the planner's use of hashed aggregation plans that are expected to exceed work_mem."),
+			NULL
+		},
+		&enable_hashagg_disk,
+		true,
+		NULL, NULL, NULL
+	},
 	{
 		{"enable_material", PGC_USERSET, QUERY_TUNING_METHOD,
 			gettext_noop("Enables the planner's use of materialization."),
@@ -941,6 +1003,15 @@ static struct config_bool ConfigureNamesBool[] =
 		true,
 		NULL, NULL, NULL
 	},
+	{
+		{"enable_memoize", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enables the planner's use of memoization."),
+			NULL
+		},
+		&enable_memoize,
+		true,
+		NULL, NULL, NULL
+	},
 	{
 		{"enable_nestloop", PGC_USERSET, QUERY_TUNING_METHOD,
 			gettext_noop("Enables the planner's use of nested-loop join plans."),
@@ -968,6 +1039,15 @@ static struct config_bool ConfigureNamesBool[] =
 		true,
 		NULL, NULL, NULL
 	},
+	{
+		{"enable_hashjoin_bloom", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enables hash joins to pass a Bloom filter down to their outer-side scans."),
+			NULL
+		},
+		&enable_hashjoin_bloom,
+		true,
+		NULL, NULL, NULL
+	},
 	{
 		{"enable_gathermerge", PGC_USERSET, QUERY_TUNING_METHOD,
 			gettext_noop("Enables the planner's use of gather merge plans."),
@@ -977,6 +1057,51 @@ static struct config_bool ConfigureNamesBool[] =
 		true,
 		NULL, NULL, NULL
 	},
+	{
+		{"enable_parallel_hash", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enables the planner's use of parallel hash plans."),
+			NULL
+		},
+		&enable_parallel_hash,
+		false,
+		NULL, NULL, NULL
+	},
+	{
+		{"enable_partition_pruning", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enables pruning partitions using their bounds, at plan and execution time."),
+			NULL
+		},
+		&enable_partition_pruning,
+		true,
+		NULL, NULL, NULL
+	},
+	{
+		{"enable_partitionwise_join", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enables partition-wise join."),
+			NULL
+		},
+		&enable_partitionwise_join,
+		false,
+		NULL, NULL, NULL
+	},
+	{
+		{"enable_partitionwise_aggregate", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enables partition-wise aggregation and grouping."),
+			NULL
+		},
+		&enable_partitionwise_aggregate,
+		false,
+		NULL, NULL, NULL
+	},
+	{
+		{"enable_async_append", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enables the planner's use of async append plans."),
+			NULL
+		},
+		&enable_async_append,
+		true,
+		NULL, NULL, NULL
+	},
 
 	{
 		{"geqo", PGC_USERSET, QUERY_TUNING_GEQO,
@@ -1797,6 +1922,15 @@ static struct config_int ConfigureNamesInt[] =
 		8, 1, INT_MAX,
 		NULL, NULL, NULL
 	},
+	{
+		{"executor_batch_size", PGC_USERSET, QUERY_TUNING_OTHER,
+			gettext_noop("Sets the number of rows processed per batch by batch-capable plan nodes."),
+			gettext_noop("Zero disables batch-at-a-time execution.")
+		},
+		&executor_batch_size,
+		0, 0, 16384,
+		NULL, NULL, NULL
+	},
 	{
 		{"geqo_threshold", PGC_USERSET, QUERY_TUNING_GEQO,
 			gettext_noop("Sets the threshold of FROM items beyond which GEQO is used."),
@@ -1979,6 +2113,7 @@ static struct config_int ConfigureNamesInt[] =
 	{
 		{"memory_budget", PGC_USERSET, RESOURCES_MEM,
 			gettext_noop("Sets the memory budget to cache intermediate states"),
+			NULL,
 			GUC_UNIT_KB
 		},
 		&memory_budget,
@@ -2791,6 +2926,16 @@ static struct config_int ConfigureNamesInt[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"max_parallel_maintenance_workers", PGC_USERSET, RESOURCES_ASYNCHRONOUS,
+			gettext_noop("Sets the maximum number of parallel processes per maintenance operation."),
+			NULL
+		},
+		&max_parallel_maintenance_workers,
+		2, 0, MAX_PARALLEL_WORKER_LIMIT,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"max_parallel_workers", PGC_USERSET, RESOURCES_ASYNCHRONOUS,
 			gettext_noop("Sets the maximum number of parallel workers than can be active at one time."),
@@ -2991,6 +3136,24 @@ static struct config_real ConfigureNamesReal[] =
         0.01, 0.001, 0.5,
         NULL, NULL, NULL
     },
+    {
+        {"iqp_replan_threshold", PGC_USERSET, QUERY_TUNING_COST,
+			gettext_noop("setting the ratio between observed and estimated delta size that triggers re-deciding states"),
+			gettext_noop("Zero disables re-deciding.")
+        },
+        &iqp_replan_threshold, 
+        2.0, 0, 1000.0,
+        NULL, NULL, NULL
+    },
+    {
+        {"tpch_scale_factor", PGC_USERSET, QUERY_TUNING_COST,
+			gettext_noop("setting the TPC-H scale factor the delta ranges are computed for"),
+			NULL
+        },
+        &tpch_scale_factor, 
+        1.0, 0.001, 1000.0,
+        NULL, NULL, NULL
+    },
     {
         {"wrong_exp_delta", PGC_USERSET, QUERY_TUNING_COST,
 			gettext_noop("setting the wrong delta size"),
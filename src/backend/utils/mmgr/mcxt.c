@@ -426,6 +426,34 @@ MemoryContextIsEmpty(MemoryContext context)
 	return (*context->methods->is_empty) (context);
 }
 
+/*
+ * MemoryContextMemAllocated
+ *		Find the memory allocated to blocks for this memory context.  If
+ *		recurse is true, also include children.
+ *
+ * Unlike MemoryContextStats, this is cheap enough to call once per tuple:
+ * each context keeps a running total of the blocks it got from malloc().
+ */
+Size
+MemoryContextMemAllocated(MemoryContext context, bool recurse)
+{
+	Size		total = context->mem_allocated;
+
+	AssertArg(MemoryContextIsValid(context));
+
+	if (recurse)
+	{
+		MemoryContext child;
+
+		for (child = context->firstchild;
+			 child != NULL;
+			 child = child->nextchild)
+			total += MemoryContextMemAllocated(child, true);
+	}
+
+	return total;
+}
+
 /*
  * MemoryContextStats
  *		Print statistics about the named context and all its descendants.
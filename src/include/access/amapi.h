@@ -191,6 +191,10 @@ typedef struct IndexAmRoutine
 	bool		ampredlocks;
 	/* does AM support parallel scan? */
 	bool		amcanparallel;
+	/* does AM support columns included with clause INCLUDE? */
+	bool		amcaninclude;
+	/* can AM skip scan over distinct values of the first column? */
+	bool		amcanskip;
 	/* type of data stored in index, or InvalidOid if variable */
 	Oid			amkeytype;
 
@@ -237,6 +237,14 @@ typedef HashMetaPageData *HashMetaPage;
 #define HASH_MIN_FILLFACTOR			10
 #define HASH_DEFAULT_FILLFACTOR		75
 
+/*
+ * An insertion that finds a split due splits up to HASH_SPLIT_BATCH buckets,
+ * but gets no more than 1/HASH_SPLIT_AHEAD_FRACTION of the existing buckets
+ * ahead of need (see _hash_expandtable).
+ */
+#define HASH_SPLIT_BATCH			16
+#define HASH_SPLIT_AHEAD_FRACTION	64
+
 /*
  * Constants
  */
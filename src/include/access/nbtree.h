@@ -21,6 +21,8 @@
 #include "catalog/pg_index.h"
 #include "lib/stringinfo.h"
 #include "storage/bufmgr.h"
+#include "storage/dsm.h"
+#include "storage/shm_toc.h"
 
 /* There's room for a 16-bit vacuum cycle ID in BTPageOpaqueData */
 typedef uint16 BTCycleId;
@@ -149,12 +151,110 @@ typedef struct BTMetaPageData
  *	are unique, not in ALL INDEX. So, we can use the t_tid
  *	as unique identifier for a given index tuple (logical position
  *	within a level). - vadim 04/09/97
+ *
+ *	BTEntrySame is only applied to downlinks, whose offset number may hold
+ *	a truncated pivot tuple's attribute count, so it compares just the
+ *	block numbers.
  */
 #define BTTidSame(i1, i2)	\
 	((ItemPointerGetBlockNumber(&(i1)) == ItemPointerGetBlockNumber(&(i2))) && \
 	 (ItemPointerGetOffsetNumber(&(i1)) == ItemPointerGetOffsetNumber(&(i2))))
 #define BTEntrySame(i1, i2) \
-	BTTidSame((i1)->t_tid, (i2)->t_tid)
+	(ItemPointerGetBlockNumberNoCheck(&(i1)->t_tid) == \
+	 ItemPointerGetBlockNumberNoCheck(&(i2)->t_tid))
+
+/*
+ * Posting list tuples.
+ *
+ * A run of leaf tuples whose keys are bitwise identical can be merged into
+ * a single "posting list" tuple, which stores the key once followed by a
+ * sorted array of the heap TIDs of all the merged tuples.  This is done
+ * lazily, when a leaf page would otherwise have to be split (see
+ * nbtdedup.c).  Pivot tuples (high keys, and all tuples on internal pages)
+ * are never posting list tuples.
+ *
+ * A posting list tuple has INDEX_ALT_TID_MASK set in t_info, and its t_tid
+ * does not point to the heap.  Instead, t_tid's block number is the offset
+ * of the posting list from the start of the tuple, which is where the key
+ * data ends, and t_tid's offset number holds the number of heap TIDs along
+ * with the BT_IS_POSTING flag bit.
+ */
+#define INDEX_ALT_TID_MASK			INDEX_AM_RESERVED_BIT
+
+#define BT_OFFSET_MASK				0x0FFF
+#define BT_IS_POSTING				0x2000
+
+#define BTreeTupleIsPosting(itup) \
+	(((itup)->t_info & INDEX_ALT_TID_MASK) != 0 && \
+	 (ItemPointerGetOffsetNumberNoCheck(&(itup)->t_tid) & BT_IS_POSTING) != 0)
+#define BTreeTupleGetNPosting(itup) \
+	( \
+		AssertMacro(BTreeTupleIsPosting(itup)), \
+		(int) (ItemPointerGetOffsetNumberNoCheck(&(itup)->t_tid) & BT_OFFSET_MASK) \
+	)
+#define BTreeTupleGetPostingOffset(itup) \
+	((Size) ItemPointerGetBlockNumberNoCheck(&(itup)->t_tid))
+#define BTreeTupleGetPosting(itup) \
+	((ItemPointer) ((char *) (itup) + BTreeTupleGetPostingOffset(itup)))
+#define BTreeTupleGetPostingN(itup, n) \
+	(BTreeTupleGetPosting(itup) + (n))
+#define BTreeTupleSetPosting(itup, nhtids, postingoffset) \
+	do { \
+		Assert((nhtids) > 1 && (nhtids) <= BT_OFFSET_MASK); \
+		(itup)->t_info |= INDEX_ALT_TID_MASK; \
+		ItemPointerSetBlockNumber(&(itup)->t_tid, (postingoffset)); \
+		ItemPointerSetOffsetNumber(&(itup)->t_tid, \
+								   (nhtids) | BT_IS_POSTING); \
+	} while (0)
+
+/*
+ * Pivot tuples.
+ *
+ * High keys and the tuples on internal pages only need enough of the key to
+ * separate the pages on either side, so they may be suffix-truncated: a
+ * pivot tuple keeps a prefix of the key columns, and the truncated ones are
+ * taken to be "minus infinity" by _bt_compare.  Included (non-key) columns
+ * are always truncated away.  A truncated tuple has INDEX_ALT_TID_MASK set
+ * and the number of attributes it still has in t_tid's offset number,
+ * without BT_IS_POSTING.  On internal pages t_tid's block number is still
+ * the downlink, so it must be set with BTreeInnerTupleSetDownLink, which
+ * leaves the attribute count alone.
+ */
+#define BTreeTupleGetNAtts(itup, rel) \
+	( \
+		(((itup)->t_info & INDEX_ALT_TID_MASK) != 0 && \
+		 !BTreeTupleIsPosting(itup)) ? \
+		(int) (ItemPointerGetOffsetNumberNoCheck(&(itup)->t_tid) & BT_OFFSET_MASK) : \
+		IndexRelationGetNumberOfAttributes(rel) \
+	)
+#define BTreeTupleSetNAtts(itup, n) \
+	do { \
+		(itup)->t_info |= INDEX_ALT_TID_MASK; \
+		ItemPointerSetOffsetNumber(&(itup)->t_tid, (n) & BT_OFFSET_MASK); \
+	} while (0)
+#define BTreeInnerTupleGetDownLink(itup) \
+	ItemPointerGetBlockNumberNoCheck(&(itup)->t_tid)
+#define BTreeInnerTupleSetDownLink(itup, blkno) \
+	ItemPointerSetBlockNumber(&(itup)->t_tid, (blkno))
+
+/*
+ * The number of heap TIDs a leaf page can reference, counting each TID in a
+ * posting list separately.  This is a generous upper bound, used to size
+ * per-page arrays in index scans.
+ */
+#define MaxTIDsPerBTreePage \
+	(int) ((BLCKSZ - SizeOfPageHeaderData - sizeof(BTPageOpaqueData)) / \
+		   sizeof(ItemPointerData))
+
+/*
+ * A run of consecutive leaf items merged by deduplication, as recorded in
+ * XLOG_BTREE_DEDUP records.
+ */
+typedef struct BTDedupInterval
+{
+	OffsetNumber baseoff;		/* offset of first item of the run */
+	uint16		nitems;			/* number of items merged */
+} BTDedupInterval;
 
 
 /*
@@ -281,7 +381,9 @@ typedef BTStackData *BTStack;
  * If we are doing an index-only scan, we save the entire IndexTuple for each
  * matched item, otherwise only its heap TID and offset.  The IndexTuples go
  * into a separate workspace array; each BTScanPosItem stores its tuple's
- * offset within that array.
+ * offset within that array.  A posting list tuple yields one item per heap
+ * TID; those items share a single copy of the tuple's key, stored as a
+ * plain tuple.
  */
 
 typedef struct BTScanPosItem	/* what we remember about each match */
@@ -325,7 +427,7 @@ typedef struct BTScanPosData
 	int			lastItem;		/* last valid index in items[] */
 	int			itemIndex;		/* current index in items[] */
 
-	BTScanPosItem items[MaxIndexTuplesPerPage]; /* MUST BE LAST */
+	BTScanPosItem items[MaxTIDsPerBTreePage];	/* MUST BE LAST */
 } BTScanPosData;
 
 typedef BTScanPosData *BTScanPos;
@@ -388,6 +490,15 @@ typedef struct BTScanOpaqueData
 	BTArrayKeyInfo *arrayKeys;	/* info about each equality-type array key */
 	MemoryContext arrayContext; /* scan-lifespan context for array data */
 
+	/* workspace for skip scans (see _bt_preprocess_skip_key) */
+	bool		skipScan;		/* is this a skip scan? */
+	ScanKey		skipKeyData;	/* skip key followed by copy of scan->keyData */
+	FmgrInfo	skipEqProc;		/* "=" function for the first column */
+	Datum		skipValue;		/* current value of the first column */
+	bool		skipNull;		/* ... or is it NULL? */
+	bool		skipPending;	/* skip key already advanced past last scan */
+	MemoryContext skipContext;	/* scan-lifespan context for skip data */
+
 	/* info about killed items if any (killedItems is NULL if never used) */
 	int		   *killedItems;	/* currPos.items indexes of killed items */
 	int			numKilled;		/* number of currently stored items */
@@ -423,6 +534,7 @@ typedef BTScanOpaqueData *BTScanOpaque;
  */
 #define SK_BT_REQFWD	0x00010000	/* required to continue forward scan */
 #define SK_BT_REQBKWD	0x00020000	/* required to continue backward scan */
+#define SK_BT_SKIP		0x00040000	/* skip scan key on first index column */
 #define SK_BT_INDOPTION_SHIFT  24	/* must clear the above bits */
 #define SK_BT_DESC			(INDOPTION_DESC << SK_BT_INDOPTION_SHIFT)
 #define SK_BT_NULLS_FIRST	(INDOPTION_NULLS_FIRST << SK_BT_INDOPTION_SHIFT)
@@ -464,6 +576,15 @@ extern void _bt_parallel_release(IndexScanDesc scan, BlockNumber scan_page);
 extern void _bt_parallel_done(IndexScanDesc scan);
 extern void _bt_parallel_advance_array_keys(IndexScanDesc scan);
 
+/*
+ * prototypes for functions in nbtdedup.c
+ */
+extern bool _bt_dedup_one_page(Relation rel, Buffer buf);
+extern Page _bt_dedup_build_page(Page page, BTDedupInterval *intervals,
+					 int nintervals);
+extern IndexTuple _bt_form_posting(IndexTuple base, ItemPointer htids,
+				 int nhtids);
+
 /*
  * prototypes for functions in nbtinsert.c
  */
@@ -490,7 +611,8 @@ extern void _bt_delitems_delete(Relation rel, Buffer buf,
 					OffsetNumber *itemnos, int nitems, Relation heapRel);
 extern void _bt_delitems_vacuum(Relation rel, Buffer buf,
 					OffsetNumber *itemnos, int nitems,
-					BlockNumber lastBlockVacuumed);
+					OffsetNumber *updatenos, IndexTuple *updated,
+					int nupdated, BlockNumber lastBlockVacuumed);
 extern int	_bt_pagedel(Relation rel, Buffer buf);
 
 /*
@@ -510,6 +632,8 @@ extern bool _bt_first(IndexScanDesc scan, ScanDirection dir);
 extern bool _bt_next(IndexScanDesc scan, ScanDirection dir);
 extern Buffer _bt_get_endpoint(Relation rel, uint32 level, bool rightmost,
 				 Snapshot snapshot);
+extern bool _bt_start_skip_key(IndexScanDesc scan, ScanDirection dir);
+extern bool _bt_advance_skip_key(IndexScanDesc scan, ScanDirection dir);
 
 /*
  * prototypes for functions in nbtutils.c
@@ -523,6 +647,8 @@ extern void _bt_start_array_keys(IndexScanDesc scan, ScanDirection dir);
 extern bool _bt_advance_array_keys(IndexScanDesc scan, ScanDirection dir);
 extern void _bt_mark_array_keys(IndexScanDesc scan);
 extern void _bt_restore_array_keys(IndexScanDesc scan);
+extern void _bt_preprocess_skip_key(IndexScanDesc scan);
+extern void _bt_set_skip_value(IndexScanDesc scan, Datum value, bool isnull);
 extern void _bt_preprocess_keys(IndexScanDesc scan);
 extern IndexTuple _bt_checkkeys(IndexScanDesc scan,
 			  Page page, OffsetNumber offnum,
@@ -538,6 +664,8 @@ extern bytea *btoptions(Datum reloptions, bool validate);
 extern bool btproperty(Oid index_oid, int attno,
 		   IndexAMProperty prop, const char *propname,
 		   bool *res, bool *isnull);
+extern IndexTuple _bt_truncate(Relation rel, IndexTuple lastleft,
+			 IndexTuple firstright);
 
 /*
  * prototypes for functions in nbtvalidate.c
@@ -549,11 +677,6 @@ extern bool btvalidate(Oid opclassoid);
  */
 typedef struct BTSpool BTSpool; /* opaque type known only within nbtsort.c */
 
-extern BTSpool *_bt_spoolinit(Relation heap, Relation index,
-			  bool isunique, bool isdead);
-extern void _bt_spooldestroy(BTSpool *btspool);
-extern void _bt_spool(BTSpool *btspool, ItemPointer self,
-		  Datum *values, bool *isnull);
-extern void _bt_leafbuild(BTSpool *btspool, BTSpool *spool2);
+extern void _bt_parallel_build_main(dsm_segment *seg, shm_toc *toc);
 
 #endif							/* NBTREE_H */
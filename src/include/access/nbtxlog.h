@@ -39,6 +39,7 @@
 										 * vacuum */
 #define XLOG_BTREE_REUSE_PAGE	0xD0	/* old page is about to be reused from
 										 * FSM */
+#define XLOG_BTREE_DEDUP		0xE0	/* merge duplicates into posting lists */
 
 /*
  * All that we need to regenerate the meta-data page
@@ -88,9 +89,9 @@ typedef struct xl_btree_insert
  *
  * The left page's data portion contains the new item, if it's the _L variant.
  * (In the _R variants, the new item is one of the right page's tuples.)
- * If level > 0, an IndexTuple representing the HIKEY of the left page
- * follows.  We don't need this on leaf pages, because it's the same as the
- * leftmost key in the new right page.
+ * An IndexTuple representing the HIKEY of the left page follows.  On leaf
+ * pages it is a suffix-truncated copy of the leftmost key in the new right
+ * page, so it can't be reconstructed from that page's tuples.
  *
  * Backup Blk 1: new right page
  *
@@ -160,16 +161,37 @@ typedef struct xl_btree_reuse_page
  * block numbers aren't given.
  *
  * Note that the *last* WAL record in any vacuum of an index is allowed to
- * have a zero length array of offsets. Earlier records must have at least one.
+ * have no deleted or updated items. Earlier records must have at least one.
+ *
+ * Posting list tuples that lose only some of their heap TIDs are replaced by
+ * smaller tuples ("updated") rather than deleted.  The block data holds the
+ * replacement tuples, then their offsets, then the offsets of the deleted
+ * items.  Updates are applied before deletions.
  */
 typedef struct xl_btree_vacuum
 {
 	BlockNumber lastBlockVacuumed;
+	uint16		ndeleted;
+	uint16		nupdated;
 
-	/* TARGET OFFSET NUMBERS FOLLOW */
+	/* UPDATED TUPLES, UPDATED OFFSETS AND DELETED OFFSETS FOLLOW */
 } xl_btree_vacuum;
 
-#define SizeOfBtreeVacuum	(offsetof(xl_btree_vacuum, lastBlockVacuumed) + sizeof(BlockNumber))
+#define SizeOfBtreeVacuum	(offsetof(xl_btree_vacuum, nupdated) + sizeof(uint16))
+
+/*
+ * This is what we need to know about merging runs of duplicates on a leaf
+ * page into posting list tuples.  The block data is an array of
+ * BTDedupInterval, in offset order; redo replays the merge from it.
+ */
+typedef struct xl_btree_dedup
+{
+	uint16		nintervals;
+
+	/* DEDUPLICATION INTERVALS FOLLOW */
+} xl_btree_dedup;
+
+#define SizeOfBtreeDedup	(offsetof(xl_btree_dedup, nintervals) + sizeof(uint16))
 
 /*
  * This is what we need to know about marking an empty branch for deletion.
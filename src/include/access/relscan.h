@@ -19,6 +19,7 @@
 #include "access/htup_details.h"
 #include "access/itup.h"
 #include "access/tupdesc.h"
+#include "port/atomics.h"
 #include "storage/spin.h"
 
 /*
@@ -28,16 +29,20 @@
  * HeapScanDesc in backend-private memory, and those objects all contain
  * a pointer to this structure.  The information here must be sufficient
  * to properly initialize each new HeapScanDesc as workers join the scan,
- * and it must act as a font of block numbers for those workers.
+ * and it must act as a font of block numbers for those workers.  Blocks are
+ * handed out in chunks by advancing phs_nallocated atomically; the block
+ * number is phs_nallocated offset by phs_startblock, modulo phs_nblocks.
  */
 typedef struct ParallelHeapScanDescData
 {
 	Oid			phs_relid;		/* OID of relation to scan */
 	bool		phs_syncscan;	/* report location to syncscan logic? */
 	BlockNumber phs_nblocks;	/* # blocks in relation at start of scan */
-	slock_t		phs_mutex;		/* mutual exclusion for block number fields */
+	slock_t		phs_mutex;		/* mutual exclusion for setting startblock */
 	BlockNumber phs_startblock; /* starting block number */
-	BlockNumber phs_cblock;		/* current block number */
+	pg_atomic_uint64 phs_nallocated;	/* number of blocks allocated to
+										 * workers so far. */
+	bool		phs_snapshot_any;	/* SnapshotAny, not phs_snapshot_data? */
 	char		phs_snapshot_data[FLEXIBLE_ARRAY_MEMBER];
 }			ParallelHeapScanDescData;
 
@@ -71,6 +76,13 @@ typedef struct HeapScanDescData
 	/* NB: if rs_cbuf is not InvalidBuffer, we hold a pin on that buffer */
 	ParallelHeapScanDesc rs_parallel;	/* parallel scan information */
 
+	/* this backend's share of a parallel scan; see heap_parallelscan_nextpage */
+	uint32		rs_chunk_size;	/* # blocks in the chunk last allocated */
+	uint32		rs_chunk_maxsize;	/* largest chunk size to ramp up to */
+	uint32		rs_chunk_remaining; /* # blocks left in current chunk */
+	uint64		rs_nallocated;	/* shared allocation count for the block
+								 * last handed out to this backend */
+
 	/* these fields only used in page-at-a-time mode and for bitmap scans */
 	int			rs_cindex;		/* current tuple's index in vistuples */
 	int			rs_ntuples;		/* number of visible tuples on page */
@@ -93,6 +105,7 @@ typedef struct IndexScanDescData
 	ScanKey		keyData;		/* array of index qualifier descriptors */
 	ScanKey		orderByData;	/* array of ordering op descriptors */
 	bool		xs_want_itup;	/* caller requests index tuples */
+	bool		xs_want_skip;	/* caller requests a skip scan, if possible */
 	bool		xs_temp_snap;	/* unregister snapshot at scan end? */
 
 	/* signaling to index AM about killing index tuples */
@@ -966,6 +966,17 @@ typedef NameData *Name;
 #define unlikely(x) ((x) != 0)
 #endif
 
+/*
+ * Hint to the CPU that the memory at the given address will be accessed
+ * soon, so that a cache miss can overlap with other work.  This is only a
+ * hint; the address need not be valid.
+ */
+#if defined(__GNUC__) || defined(__INTEL_COMPILER)
+#define pg_prefetch_mem(a) __builtin_prefetch(a)
+#else
+#define pg_prefetch_mem(a) ((void) 0)
+#endif
+
 
 /* ----------------------------------------------------------------
  *				Section 8:	random stuff
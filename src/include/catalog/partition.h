@@ -70,9 +70,33 @@ typedef struct PartitionDispatchData
 
 typedef struct PartitionDispatchData *PartitionDispatch;
 
+/*
+ * Conditions on the first partition key column, collected from a query's
+ * quals to prune partitions that can't contain matching rows.  Zero it out
+ * before use and add conditions with partition_prune_range_add().
+ */
+typedef struct PartitionPruneRange
+{
+	bool		isnull;			/* key IS NULL */
+	bool		notnull;		/* key IS NOT NULL, or a strict operator */
+	bool		has_lower;		/* is there a lower bound on the key? */
+	bool		lower_inclusive;
+	Datum		lower;
+	bool		has_upper;		/* is there an upper bound on the key? */
+	bool		upper_inclusive;
+	Datum		upper;
+} PartitionPruneRange;
+
+/* pseudo strategy numbers for IS [NOT] NULL conditions */
+#define PARTITION_PRUNE_IS_NULL			(-1)
+#define PARTITION_PRUNE_IS_NOT_NULL		(-2)
+
 extern void RelationBuildPartitionDesc(Relation relation);
-extern bool partition_bounds_equal(PartitionKey key,
-					   PartitionBoundInfo p1, PartitionBoundInfo p2);
+extern bool partition_bounds_equal(int partnatts, int16 *parttyplen,
+					   bool *parttypbyval, PartitionBoundInfo b1,
+					   PartitionBoundInfo b2);
+extern PartitionBoundInfo partition_bounds_copy(PartitionBoundInfo src,
+					  PartitionKey key);
 
 extern void check_new_partition_bound(char *relname, Relation parent,
 						  PartitionBoundSpec *spec);
@@ -98,4 +122,11 @@ extern int get_partition_for_tuple(PartitionDispatch *pd,
 						EState *estate,
 						PartitionDispatchData **failed_at,
 						TupleTableSlot **failed_slot);
+
+extern bool partition_prune_range_add(PartitionKey key,
+						  PartitionPruneRange *range,
+						  int strategy, Datum value, bool isnull);
+extern Bitmapset *get_partitions_for_prune_range(PartitionKey key,
+							   PartitionDesc partdesc,
+							   PartitionPruneRange *range);
 #endif							/* PARTITION_H */
@@ -1162,4 +1162,61 @@ DATA(insert (	4104	603  603 12 s	  2572	  3580 0 ));
 /* we could, but choose not to, supply entries for strategies 13 and 14 */
 DATA(insert (	4104	603  600  7 s	   433	  3580 0 ));
 
+/* bloom */
+DATA(insert (	4150	  21   21  3 s	    94	  3580 0 ));
+DATA(insert (	4151	  23   23  3 s	    96	  3580 0 ));
+DATA(insert (	4152	  20   20  3 s	   410	  3580 0 ));
+DATA(insert (	4153	 700  700  3 s	   620	  3580 0 ));
+DATA(insert (	4154	 701  701  3 s	   670	  3580 0 ));
+DATA(insert (	4155	1700 1700  3 s	  1752	  3580 0 ));
+DATA(insert (	4156	  25   25  3 s	    98	  3580 0 ));
+DATA(insert (	4157	  17   17  3 s	  1955	  3580 0 ));
+DATA(insert (	4158	  26   26  3 s	   607	  3580 0 ));
+DATA(insert (	4159	1082 1082  3 s	  1093	  3580 0 ));
+DATA(insert (	4160	1114 1114  3 s	  2060	  3580 0 ));
+DATA(insert (	4161	1184 1184  3 s	  1320	  3580 0 ));
+DATA(insert (	4162	2950 2950  3 s	  2972	  3580 0 ));
+
+/* minmax multi */
+DATA(insert (	4170	  21   21  1 s	    95	  3580 0 ));
+DATA(insert (	4170	  21   21  2 s	   522	  3580 0 ));
+DATA(insert (	4170	  21   21  3 s	    94	  3580 0 ));
+DATA(insert (	4170	  21   21  4 s	   524	  3580 0 ));
+DATA(insert (	4170	  21   21  5 s	   520	  3580 0 ));
+DATA(insert (	4171	  23   23  1 s	    97	  3580 0 ));
+DATA(insert (	4171	  23   23  2 s	   523	  3580 0 ));
+DATA(insert (	4171	  23   23  3 s	    96	  3580 0 ));
+DATA(insert (	4171	  23   23  4 s	   525	  3580 0 ));
+DATA(insert (	4171	  23   23  5 s	   521	  3580 0 ));
+DATA(insert (	4172	  20   20  1 s	   412	  3580 0 ));
+DATA(insert (	4172	  20   20  2 s	   414	  3580 0 ));
+DATA(insert (	4172	  20   20  3 s	   410	  3580 0 ));
+DATA(insert (	4172	  20   20  4 s	   415	  3580 0 ));
+DATA(insert (	4172	  20   20  5 s	   413	  3580 0 ));
+DATA(insert (	4173	 700  700  1 s	   622	  3580 0 ));
+DATA(insert (	4173	 700  700  2 s	   624	  3580 0 ));
+DATA(insert (	4173	 700  700  3 s	   620	  3580 0 ));
+DATA(insert (	4173	 700  700  4 s	   625	  3580 0 ));
+DATA(insert (	4173	 700  700  5 s	   623	  3580 0 ));
+DATA(insert (	4174	 701  701  1 s	   672	  3580 0 ));
+DATA(insert (	4174	 701  701  2 s	   673	  3580 0 ));
+DATA(insert (	4174	 701  701  3 s	   670	  3580 0 ));
+DATA(insert (	4174	 701  701  4 s	   675	  3580 0 ));
+DATA(insert (	4174	 701  701  5 s	   674	  3580 0 ));
+DATA(insert (	4175	1082 1082  1 s	  1095	  3580 0 ));
+DATA(insert (	4175	1082 1082  2 s	  1096	  3580 0 ));
+DATA(insert (	4175	1082 1082  3 s	  1093	  3580 0 ));
+DATA(insert (	4175	1082 1082  4 s	  1098	  3580 0 ));
+DATA(insert (	4175	1082 1082  5 s	  1097	  3580 0 ));
+DATA(insert (	4176	1114 1114  1 s	  2062	  3580 0 ));
+DATA(insert (	4176	1114 1114  2 s	  2063	  3580 0 ));
+DATA(insert (	4176	1114 1114  3 s	  2060	  3580 0 ));
+DATA(insert (	4176	1114 1114  4 s	  2065	  3580 0 ));
+DATA(insert (	4176	1114 1114  5 s	  2064	  3580 0 ));
+DATA(insert (	4177	1184 1184  1 s	  1322	  3580 0 ));
+DATA(insert (	4177	1184 1184  2 s	  1323	  3580 0 ));
+DATA(insert (	4177	1184 1184  3 s	  1320	  3580 0 ));
+DATA(insert (	4177	1184 1184  4 s	  1325	  3580 0 ));
+DATA(insert (	4177	1184 1184  5 s	  1324	  3580 0 ));
+
 #endif							/* PG_AMOP_H */
@@ -535,5 +535,112 @@ DATA(insert (	4104   603	 603  3  4107 ));
 DATA(insert (	4104   603	 603  4  4108 ));
 DATA(insert (	4104   603	 603  11 4067 ));
 DATA(insert (	4104   603	 603  13  187 ));
+/* bloom */
+DATA(insert (	4150    21	  21  1  4130 ));
+DATA(insert (	4150    21	  21  2  4131 ));
+DATA(insert (	4150    21	  21  3  4132 ));
+DATA(insert (	4150    21	  21  4  4133 ));
+DATA(insert (	4150    21	  21  11  449 ));
+DATA(insert (	4151    23	  23  1  4130 ));
+DATA(insert (	4151    23	  23  2  4131 ));
+DATA(insert (	4151    23	  23  3  4132 ));
+DATA(insert (	4151    23	  23  4  4133 ));
+DATA(insert (	4151    23	  23  11  450 ));
+DATA(insert (	4152    20	  20  1  4130 ));
+DATA(insert (	4152    20	  20  2  4131 ));
+DATA(insert (	4152    20	  20  3  4132 ));
+DATA(insert (	4152    20	  20  4  4133 ));
+DATA(insert (	4152    20	  20  11  949 ));
+DATA(insert (	4153   700	 700  1  4130 ));
+DATA(insert (	4153   700	 700  2  4131 ));
+DATA(insert (	4153   700	 700  3  4132 ));
+DATA(insert (	4153   700	 700  4  4133 ));
+DATA(insert (	4153   700	 700  11  451 ));
+DATA(insert (	4154   701	 701  1  4130 ));
+DATA(insert (	4154   701	 701  2  4131 ));
+DATA(insert (	4154   701	 701  3  4132 ));
+DATA(insert (	4154   701	 701  4  4133 ));
+DATA(insert (	4154   701	 701  11  452 ));
+DATA(insert (	4155  1700	1700  1  4130 ));
+DATA(insert (	4155  1700	1700  2  4131 ));
+DATA(insert (	4155  1700	1700  3  4132 ));
+DATA(insert (	4155  1700	1700  4  4133 ));
+DATA(insert (	4155  1700	1700  11  432 ));
+DATA(insert (	4156    25	  25  1  4130 ));
+DATA(insert (	4156    25	  25  2  4131 ));
+DATA(insert (	4156    25	  25  3  4132 ));
+DATA(insert (	4156    25	  25  4  4133 ));
+DATA(insert (	4156    25	  25  11  400 ));
+DATA(insert (	4157    17	  17  1  4130 ));
+DATA(insert (	4157    17	  17  2  4131 ));
+DATA(insert (	4157    17	  17  3  4132 ));
+DATA(insert (	4157    17	  17  4  4133 ));
+DATA(insert (	4157    17	  17  11  456 ));
+DATA(insert (	4158    26	  26  1  4130 ));
+DATA(insert (	4158    26	  26  2  4131 ));
+DATA(insert (	4158    26	  26  3  4132 ));
+DATA(insert (	4158    26	  26  4  4133 ));
+DATA(insert (	4158    26	  26  11  453 ));
+DATA(insert (	4159  1082	1082  1  4130 ));
+DATA(insert (	4159  1082	1082  2  4131 ));
+DATA(insert (	4159  1082	1082  3  4132 ));
+DATA(insert (	4159  1082	1082  4  4133 ));
+DATA(insert (	4159  1082	1082  11  450 ));
+DATA(insert (	4160  1114	1114  1  4130 ));
+DATA(insert (	4160  1114	1114  2  4131 ));
+DATA(insert (	4160  1114	1114  3  4132 ));
+DATA(insert (	4160  1114	1114  4  4133 ));
+DATA(insert (	4160  1114	1114  11 2039 ));
+DATA(insert (	4161  1184	1184  1  4130 ));
+DATA(insert (	4161  1184	1184  2  4131 ));
+DATA(insert (	4161  1184	1184  3  4132 ));
+DATA(insert (	4161  1184	1184  4  4133 ));
+DATA(insert (	4161  1184	1184  11 2039 ));
+DATA(insert (	4162  2950	2950  1  4130 ));
+DATA(insert (	4162  2950	2950  2  4131 ));
+DATA(insert (	4162  2950	2950  3  4132 ));
+DATA(insert (	4162  2950	2950  4  4133 ));
+DATA(insert (	4162  2950	2950  11 2963 ));
+/* minmax multi */
+DATA(insert (	4170    21	  21  1  4134 ));
+DATA(insert (	4170    21	  21  2  4135 ));
+DATA(insert (	4170    21	  21  3  4136 ));
+DATA(insert (	4170    21	  21  4  4137 ));
+DATA(insert (	4170    21	  21  11 4138 ));
+DATA(insert (	4171    23	  23  1  4134 ));
+DATA(insert (	4171    23	  23  2  4135 ));
+DATA(insert (	4171    23	  23  3  4136 ));
+DATA(insert (	4171    23	  23  4  4137 ));
+DATA(insert (	4171    23	  23  11 4139 ));
+DATA(insert (	4172    20	  20  1  4134 ));
+DATA(insert (	4172    20	  20  2  4135 ));
+DATA(insert (	4172    20	  20  3  4136 ));
+DATA(insert (	4172    20	  20  4  4137 ));
+DATA(insert (	4172    20	  20  11 4140 ));
+DATA(insert (	4173   700	 700  1  4134 ));
+DATA(insert (	4173   700	 700  2  4135 ));
+DATA(insert (	4173   700	 700  3  4136 ));
+DATA(insert (	4173   700	 700  4  4137 ));
+DATA(insert (	4173   700	 700  11 4141 ));
+DATA(insert (	4174   701	 701  1  4134 ));
+DATA(insert (	4174   701	 701  2  4135 ));
+DATA(insert (	4174   701	 701  3  4136 ));
+DATA(insert (	4174   701	 701  4  4137 ));
+DATA(insert (	4174   701	 701  11 4142 ));
+DATA(insert (	4175  1082	1082  1  4134 ));
+DATA(insert (	4175  1082	1082  2  4135 ));
+DATA(insert (	4175  1082	1082  3  4136 ));
+DATA(insert (	4175  1082	1082  4  4137 ));
+DATA(insert (	4175  1082	1082  11 4143 ));
+DATA(insert (	4176  1114	1114  1  4134 ));
+DATA(insert (	4176  1114	1114  2  4135 ));
+DATA(insert (	4176  1114	1114  3  4136 ));
+DATA(insert (	4176  1114	1114  4  4137 ));
+DATA(insert (	4176  1114	1114  11 4144 ));
+DATA(insert (	4177  1184	1184  1  4134 ));
+DATA(insert (	4177  1184	1184  2  4135 ));
+DATA(insert (	4177  1184	1184  3  4136 ));
+DATA(insert (	4177  1184	1184  4  4137 ));
+DATA(insert (	4177  1184	1184  11 4145 ));
 
 #endif							/* PG_AMPROC_H */
@@ -246,5 +246,27 @@ DATA(insert (	3580	pg_lsn_minmax_ops		PGNSP PGUID 4082  3220 t 3220 ));
 /* no brin opclass for enum, tsvector, tsquery, jsonb */
 DATA(insert (	3580	box_inclusion_ops		PGNSP PGUID 4104   603 t 603 ));
 /* no brin opclass for the geometric types except box */
+/* bloom and minmax multi, for columns not correlated with the table order */
+DATA(insert (	3580	int2_bloom_ops		PGNSP PGUID 4150    21 f 21 ));
+DATA(insert (	3580	int4_bloom_ops		PGNSP PGUID 4151    23 f 23 ));
+DATA(insert (	3580	int8_bloom_ops		PGNSP PGUID 4152    20 f 20 ));
+DATA(insert (	3580	float4_bloom_ops		PGNSP PGUID 4153   700 f 700 ));
+DATA(insert (	3580	float8_bloom_ops		PGNSP PGUID 4154   701 f 701 ));
+DATA(insert (	3580	numeric_bloom_ops		PGNSP PGUID 4155  1700 f 1700 ));
+DATA(insert (	3580	text_bloom_ops		PGNSP PGUID 4156    25 f 25 ));
+DATA(insert (	3580	bytea_bloom_ops		PGNSP PGUID 4157    17 f 17 ));
+DATA(insert (	3580	oid_bloom_ops		PGNSP PGUID 4158    26 f 26 ));
+DATA(insert (	3580	date_bloom_ops		PGNSP PGUID 4159  1082 f 1082 ));
+DATA(insert (	3580	timestamp_bloom_ops		PGNSP PGUID 4160  1114 f 1114 ));
+DATA(insert (	3580	timestamptz_bloom_ops		PGNSP PGUID 4161  1184 f 1184 ));
+DATA(insert (	3580	uuid_bloom_ops		PGNSP PGUID 4162  2950 f 2950 ));
+DATA(insert (	3580	int2_minmax_multi_ops	PGNSP PGUID 4170    21 f 21 ));
+DATA(insert (	3580	int4_minmax_multi_ops	PGNSP PGUID 4171    23 f 23 ));
+DATA(insert (	3580	int8_minmax_multi_ops	PGNSP PGUID 4172    20 f 20 ));
+DATA(insert (	3580	float4_minmax_multi_ops	PGNSP PGUID 4173   700 f 700 ));
+DATA(insert (	3580	float8_minmax_multi_ops	PGNSP PGUID 4174   701 f 701 ));
+DATA(insert (	3580	date_minmax_multi_ops	PGNSP PGUID 4175  1082 f 1082 ));
+DATA(insert (	3580	timestamp_minmax_multi_ops	PGNSP PGUID 4176  1114 f 1114 ));
+DATA(insert (	3580	timestamptz_minmax_multi_ops	PGNSP PGUID 4177  1184 f 1184 ));
 
 #endif							/* PG_OPCLASS_H */
@@ -185,6 +185,27 @@ DATA(insert OID = 4081 (	3580	uuid_minmax_ops			PGNSP PGUID ));
 DATA(insert OID = 4103 (	3580	range_inclusion_ops		PGNSP PGUID ));
 DATA(insert OID = 4082 (	3580	pg_lsn_minmax_ops		PGNSP PGUID ));
 DATA(insert OID = 4104 (	3580	box_inclusion_ops		PGNSP PGUID ));
+DATA(insert OID = 4150 (	3580	int2_bloom_ops		PGNSP PGUID ));
+DATA(insert OID = 4151 (	3580	int4_bloom_ops		PGNSP PGUID ));
+DATA(insert OID = 4152 (	3580	int8_bloom_ops		PGNSP PGUID ));
+DATA(insert OID = 4153 (	3580	float4_bloom_ops		PGNSP PGUID ));
+DATA(insert OID = 4154 (	3580	float8_bloom_ops		PGNSP PGUID ));
+DATA(insert OID = 4155 (	3580	numeric_bloom_ops		PGNSP PGUID ));
+DATA(insert OID = 4156 (	3580	text_bloom_ops		PGNSP PGUID ));
+DATA(insert OID = 4157 (	3580	bytea_bloom_ops		PGNSP PGUID ));
+DATA(insert OID = 4158 (	3580	oid_bloom_ops		PGNSP PGUID ));
+DATA(insert OID = 4159 (	3580	date_bloom_ops		PGNSP PGUID ));
+DATA(insert OID = 4160 (	3580	timestamp_bloom_ops		PGNSP PGUID ));
+DATA(insert OID = 4161 (	3580	timestamptz_bloom_ops		PGNSP PGUID ));
+DATA(insert OID = 4162 (	3580	uuid_bloom_ops		PGNSP PGUID ));
+DATA(insert OID = 4170 (	3580	int2_minmax_multi_ops	PGNSP PGUID ));
+DATA(insert OID = 4171 (	3580	int4_minmax_multi_ops	PGNSP PGUID ));
+DATA(insert OID = 4172 (	3580	int8_minmax_multi_ops	PGNSP PGUID ));
+DATA(insert OID = 4173 (	3580	float4_minmax_multi_ops	PGNSP PGUID ));
+DATA(insert OID = 4174 (	3580	float8_minmax_multi_ops	PGNSP PGUID ));
+DATA(insert OID = 4175 (	3580	date_minmax_multi_ops	PGNSP PGUID ));
+DATA(insert OID = 4176 (	3580	timestamp_minmax_multi_ops	PGNSP PGUID ));
+DATA(insert OID = 4177 (	3580	timestamptz_minmax_multi_ops	PGNSP PGUID ));
 DATA(insert OID = 5000 (	4000	box_ops		PGNSP PGUID ));
 
 #endif							/* PG_OPFAMILY_H */
@@ -4329,6 +4329,42 @@ DESCR("BRIN inclusion support");
 DATA(insert OID = 4108 ( brin_inclusion_union	PGNSP PGUID 12 1 0 0 0 f f f f t f i s 3 0 16 "2281 2281 2281" _null_ _null_ _null_ _null_ _null_ brin_inclusion_union _null_ _null_ _null_ ));
 DESCR("BRIN inclusion support");
 
+/* BRIN bloom */
+DATA(insert OID = 4130 ( brin_bloom_opcinfo		PGNSP PGUID 12 1 0 0 0 f f f f t f i s 1 0 2281 "2281" _null_ _null_ _null_ _null_ _null_ brin_bloom_opcinfo _null_ _null_ _null_ ));
+DESCR("BRIN bloom support");
+DATA(insert OID = 4131 ( brin_bloom_add_value	PGNSP PGUID 12 1 0 0 0 f f f f t f i s 4 0 16 "2281 2281 2281 2281" _null_ _null_ _null_ _null_ _null_ brin_bloom_add_value _null_ _null_ _null_ ));
+DESCR("BRIN bloom support");
+DATA(insert OID = 4132 ( brin_bloom_consistent	PGNSP PGUID 12 1 0 0 0 f f f f t f i s 3 0 16 "2281 2281 2281" _null_ _null_ _null_ _null_ _null_ brin_bloom_consistent _null_ _null_ _null_ ));
+DESCR("BRIN bloom support");
+DATA(insert OID = 4133 ( brin_bloom_union		PGNSP PGUID 12 1 0 0 0 f f f f t f i s 3 0 16 "2281 2281 2281" _null_ _null_ _null_ _null_ _null_ brin_bloom_union _null_ _null_ _null_ ));
+DESCR("BRIN bloom support");
+
+/* BRIN minmax multi */
+DATA(insert OID = 4134 ( brin_minmax_multi_opcinfo		PGNSP PGUID 12 1 0 0 0 f f f f t f i s 1 0 2281 "2281" _null_ _null_ _null_ _null_ _null_ brin_minmax_multi_opcinfo _null_ _null_ _null_ ));
+DESCR("BRIN minmax multi support");
+DATA(insert OID = 4135 ( brin_minmax_multi_add_value	PGNSP PGUID 12 1 0 0 0 f f f f t f i s 4 0 16 "2281 2281 2281 2281" _null_ _null_ _null_ _null_ _null_ brin_minmax_multi_add_value _null_ _null_ _null_ ));
+DESCR("BRIN minmax multi support");
+DATA(insert OID = 4136 ( brin_minmax_multi_consistent	PGNSP PGUID 12 1 0 0 0 f f f f t f i s 3 0 16 "2281 2281 2281" _null_ _null_ _null_ _null_ _null_ brin_minmax_multi_consistent _null_ _null_ _null_ ));
+DESCR("BRIN minmax multi support");
+DATA(insert OID = 4137 ( brin_minmax_multi_union		PGNSP PGUID 12 1 0 0 0 f f f f t f i s 3 0 16 "2281 2281 2281" _null_ _null_ _null_ _null_ _null_ brin_minmax_multi_union _null_ _null_ _null_ ));
+DESCR("BRIN minmax multi support");
+DATA(insert OID = 4138 ( brin_minmax_multi_distance_int2 PGNSP PGUID 12 1 0 0 0 f f f f t f i s 2 0 701 "21 21" _null_ _null_ _null_ _null_ _null_ brin_minmax_multi_distance_int2 _null_ _null_ _null_ ));
+DESCR("BRIN minmax multi distance support");
+DATA(insert OID = 4139 ( brin_minmax_multi_distance_int4 PGNSP PGUID 12 1 0 0 0 f f f f t f i s 2 0 701 "23 23" _null_ _null_ _null_ _null_ _null_ brin_minmax_multi_distance_int4 _null_ _null_ _null_ ));
+DESCR("BRIN minmax multi distance support");
+DATA(insert OID = 4140 ( brin_minmax_multi_distance_int8 PGNSP PGUID 12 1 0 0 0 f f f f t f i s 2 0 701 "20 20" _null_ _null_ _null_ _null_ _null_ brin_minmax_multi_distance_int8 _null_ _null_ _null_ ));
+DESCR("BRIN minmax multi distance support");
+DATA(insert OID = 4141 ( brin_minmax_multi_distance_float4 PGNSP PGUID 12 1 0 0 0 f f f f t f i s 2 0 701 "700 700" _null_ _null_ _null_ _null_ _null_ brin_minmax_multi_distance_float4 _null_ _null_ _null_ ));
+DESCR("BRIN minmax multi distance support");
+DATA(insert OID = 4142 ( brin_minmax_multi_distance_float8 PGNSP PGUID 12 1 0 0 0 f f f f t f i s 2 0 701 "701 701" _null_ _null_ _null_ _null_ _null_ brin_minmax_multi_distance_float8 _null_ _null_ _null_ ));
+DESCR("BRIN minmax multi distance support");
+DATA(insert OID = 4143 ( brin_minmax_multi_distance_date PGNSP PGUID 12 1 0 0 0 f f f f t f i s 2 0 701 "1082 1082" _null_ _null_ _null_ _null_ _null_ brin_minmax_multi_distance_date _null_ _null_ _null_ ));
+DESCR("BRIN minmax multi distance support");
+DATA(insert OID = 4144 ( brin_minmax_multi_distance_timestamp PGNSP PGUID 12 1 0 0 0 f f f f t f i s 2 0 701 "1114 1114" _null_ _null_ _null_ _null_ _null_ brin_minmax_multi_distance_timestamp _null_ _null_ _null_ ));
+DESCR("BRIN minmax multi distance support");
+DATA(insert OID = 4145 ( brin_minmax_multi_distance_timestamptz PGNSP PGUID 12 1 0 0 0 f f f f t f i s 2 0 701 "1184 1184" _null_ _null_ _null_ _null_ _null_ brin_minmax_multi_distance_timestamptz _null_ _null_ _null_ ));
+DESCR("BRIN minmax multi distance support");
+
 /* userlock replacements */
 DATA(insert OID = 2880 (  pg_advisory_lock				PGNSP PGUID 12 1 0 0 0 f f f f t f v u 1 0 2278 "20" _null_ _null_ _null_ _null_ _null_ pg_advisory_lock_int8 _null_ _null_ _null_ ));
 DESCR("obtain exclusive advisory lock");
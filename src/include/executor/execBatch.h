@@ -0,0 +1,131 @@
+/*-------------------------------------------------------------------------
+ *
+ * execBatch.h
+ *	  Batch-at-a-time ("vectorized") execution support
+ *
+ * A TupleBatch holds up to maxrows tuples of one relation, deformed into
+ * one vector of values and one of null flags per referenced column, plus a
+ * selection vector listing the rows that are still live.  Quals and simple
+ * expressions are compiled into BatchExprState programs that run each step
+ * over the whole selection vector, so that the per-row cost is one function
+ * call rather than a pass through the expression interpreter.
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/executor/execBatch.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef EXECBATCH_H
+#define EXECBATCH_H
+
+#include "access/htup.h"
+#include "access/tupdesc.h"
+#include "fmgr.h"
+#include "nodes/pg_list.h"
+#include "nodes/primnodes.h"
+#include "storage/buf.h"
+
+/* GUC: rows per batch, or 0 to disable batch execution */
+extern int	executor_batch_size;
+
+typedef struct TupleBatch
+{
+	TupleDesc	tupdesc;		/* descriptor of the stored tuples */
+	int			maxrows;		/* capacity of every vector */
+	int			nrows;			/* number of rows stored */
+	int			maxatt;			/* deform attributes 1 .. maxatt */
+	Datum	  **values;			/* per-column value vectors, NULL if unused */
+	bool	  **isnull;			/* per-column null vectors, NULL if unused */
+	int			nsel;			/* number of live rows */
+	int		   *sel;			/* selection vector: indexes of live rows */
+	int			nbuffers;		/* number of buffers pinned by the batch */
+	Buffer	   *buffers;		/* pinned buffers the rows point into */
+} TupleBatch;
+
+/*
+ * A kernel applies one built-in two-argument function to the rows listed
+ * in sel (or to rows 0 .. n-1 if sel is NULL), see execBatchKernels.c.
+ * nulls gives the rows whose result is NULL; they must not raise errors.
+ */
+typedef void (*BatchKernel) (int n, const int *sel,
+							 const Datum *a, const Datum *b,
+							 const bool *nulls, Datum *res);
+
+/*
+ * Discriminator for BatchExprEvalSteps.  Vars and Consts need no step: they
+ * are resolved at build time to a column vector, or a vector filled with
+ * the constant.
+ */
+typedef enum BatchExprEvalOp
+{
+	/* call a strict function for every live row with no NULL argument */
+	EEOP_BATCH_FUNCEXPR_STRICT,
+
+	/* same, for a two-argument function with a type-specialized kernel */
+	EEOP_BATCH_KERNEL,
+
+	/* IS [NOT] NULL */
+	EEOP_BATCH_NULLTEST_ISNULL,
+	EEOP_BATCH_NULLTEST_ISNOTNULL,
+
+	/* drop rows whose boolean input is false or NULL from the selection */
+	EEOP_BATCH_QUAL
+} BatchExprEvalOp;
+
+typedef struct BatchExprEvalStep
+{
+	BatchExprEvalOp opcode;
+
+	/* where to store the result, one entry per row */
+	Datum	   *resvalues;
+	bool	   *resnulls;
+
+	union
+	{
+		/* for EEOP_BATCH_FUNCEXPR_STRICT, EEOP_BATCH_KERNEL */
+		struct
+		{
+			FunctionCallInfo fcinfo_data;
+			BatchKernel kernel;
+			int			nargs;
+			Datum	  **argvalues;
+			bool	  **argnulls;
+		}			func;
+
+		/* for EEOP_BATCH_NULLTEST_*, EEOP_BATCH_QUAL */
+		struct
+		{
+			Datum	   *values;
+			bool	   *nulls;
+		}			arg;
+	}			d;
+} BatchExprEvalStep;
+
+typedef struct BatchExprState
+{
+	int			nsteps;
+	BatchExprEvalStep *steps;
+
+	/* result of the whole expression (unused for quals) */
+	Datum	   *resvalues;
+	bool	   *resnulls;
+} BatchExprState;
+
+extern TupleBatch *TupleBatchCreate(TupleDesc tupdesc, int maxrows);
+extern void TupleBatchUseColumn(TupleBatch *batch, AttrNumber attnum);
+extern void TupleBatchStoreTuple(TupleBatch *batch, HeapTuple tuple,
+					 Buffer buffer);
+extern void TupleBatchReset(TupleBatch *batch);
+
+extern BatchExprState *ExecBuildBatchExpr(Expr *node, TupleBatch *batch,
+				   Index varno, AttrNumber *attmap, int nmap);
+extern BatchExprState *ExecBuildBatchQual(List *qual, TupleBatch *batch,
+				   Index varno);
+extern void ExecEvalBatchExpr(BatchExprState *state, TupleBatch *batch);
+
+/* in execBatchKernels.c */
+extern BatchKernel ExecBatchLookupKernel(PGFunction func);
+
+#endif							/* EXECBATCH_H */
@@ -0,0 +1,44 @@
+/*-------------------------------------------------------------------------
+ *
+ * execPartition.h
+ *	  Run-time partition pruning for Append and MergeAppend
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/executor/execPartition.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef EXECPARTITION_H
+#define EXECPARTITION_H
+
+#include "nodes/execnodes.h"
+#include "nodes/plannodes.h"
+
+/*
+ * PartitionPruneState - executor state for a PartitionPruneInfo
+ *
+ *		partrel			the partitioned table, kept open for its key and
+ *						partition bounds
+ *		exprstates		one ExprState per PartitionPruneInfo expr, or NULL
+ *		nsubplans		number of subplans of the Append or MergeAppend
+ *		subplan_partidx	array of the partition index of each subplan
+ *		econtext		context to evaluate the exprs in
+ */
+typedef struct PartitionPruneState
+{
+	PartitionPruneInfo *pinfo;
+	Relation	partrel;
+	List	   *exprstates;
+	int			nsubplans;
+	int		   *subplan_partidx;
+	ExprContext *econtext;
+} PartitionPruneState;
+
+extern PartitionPruneState *ExecSetupPartitionPruneState(PlanState *planstate,
+							 PartitionPruneInfo *pinfo);
+extern Bitmapset *ExecFindMatchingSubPlans(PartitionPruneState *prunestate);
+extern void ExecEndPartitionPruneState(PartitionPruneState *prunestate);
+
+#endif							/* EXECPARTITION_H */
@@ -17,6 +17,8 @@ extern double bd_prob;
 extern enum tpch_delta_mode delta_mode;
 extern double wrong_exp_delta;
 extern double exp_delta; 
+extern bool tpch_inproc_delta;
+extern double tpch_scale_factor;
 
 typedef enum tpch_delta_mode {
     TPCH_DEFAULT,
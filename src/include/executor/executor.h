@@ -143,6 +143,8 @@ extern TupleHashEntry FindTupleHashEntry(TupleHashTable hashtable,
 				   TupleTableSlot *slot,
 				   FmgrInfo *eqfunctions,
 				   FmgrInfo *hashfunctions);
+extern uint32 TupleHashTableHashSlot(TupleHashTable hashtable,
+					   TupleTableSlot *slot);
 
 /*
  * prototypes from functions in execJunk.c
@@ -413,6 +415,7 @@ extern TupleTableSlot *ExecScan(ScanState *node, ExecScanAccessMtd accessMtd,
 extern void ExecAssignScanProjectionInfo(ScanState *node);
 extern void ExecAssignScanProjectionInfoWithVarno(ScanState *node, Index varno);
 extern void ExecScanReScan(ScanState *node);
+extern RuntimeFilterState *ExecInitScanRuntimeFilter(ScanState *node);
 
 /*
  * prototypes from functions in execTuples.c
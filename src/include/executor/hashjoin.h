@@ -16,6 +16,9 @@
 
 #include "nodes/execnodes.h"
 #include "storage/buffile.h"
+#include "storage/condition_variable.h"
+#include "storage/spin.h"
+#include "utils/dsa.h"
 
 /* ----------------------------------------------------------------
  *				hash-join hash table structures
@@ -54,6 +57,14 @@
  * inner batch file.  Subsequently, while reading either inner or outer batch
  * files, we might find tuples that no longer belong to the current batch;
  * if so, we just dump them out to the correct batch file.
+ *
+ * Under a Gather, a hash join whose inner input is itself partial can use a
+ * single hash table shared by all participants instead of each building its
+ * own.  The buckets and tuples of such a table live in the query's DSA area,
+ * so links between them are dsa_pointers rather than plain pointers; see
+ * ParallelHashJoinState.  Shared tables are only planned when the whole inner
+ * relation is expected to fit in one batch, and they never grow more batches
+ * at run time: a table that exceeds its memory budget raises an error.
  * ----------------------------------------------------------------
  */
 
@@ -63,7 +74,12 @@
 
 typedef struct HashJoinTupleData
 {
-	struct HashJoinTupleData *next; /* link to next tuple in same bucket */
+	/* link to next tuple in same bucket */
+	union
+	{
+		struct HashJoinTupleData *unshared;
+		dsa_pointer shared;
+	}			next;
 	uint32		hashvalue;		/* tuple's hash code */
     bool        delta; 
 	/* Tuple data, in MinimalTuple format, follows on a MAXALIGN boundary */
@@ -113,8 +129,12 @@ typedef struct HashMemoryChunkData
 	size_t		maxlen;			/* size of the buffer holding the tuples */
 	size_t		used;			/* number of buffer bytes already used */
 
-	struct HashMemoryChunkData *next;	/* pointer to the next chunk (linked
-										 * list) */
+	/* pointer to the next chunk (linked list) */
+	union
+	{
+		struct HashMemoryChunkData *unshared;
+		dsa_pointer shared;
+	}			next;
 
 	char		data[FLEXIBLE_ARRAY_MEMBER];	/* buffer allocated at the end */
 }			HashMemoryChunkData;
@@ -124,6 +144,49 @@ typedef struct HashMemoryChunkData *HashMemoryChunk;
 #define HASH_CHUNK_SIZE			(32 * 1024L)
 #define HASH_CHUNK_THRESHOLD	(HASH_CHUNK_SIZE / 4)
 
+/*
+ * While building, ExecHashTableInsertDeferred copies tuples into the table
+ * right away but links up to this many of them into their buckets at once,
+ * after prefetching the bucket heads, so that the cache misses on a large
+ * bucket array overlap instead of being taken one at a time.
+ */
+#define HJ_INSERT_BATCH_SIZE	16
+
+/*
+ * State of a hash table shared by the participants of a parallel query.
+ *
+ * Every participant that reaches the Hash node while the build is still
+ * running joins in, pulls tuples from its share of the partial inner plan and
+ * pushes them onto the shared buckets with compare-and-swap.  The last one to
+ * finish moves the build to GROWING, which keeps latecomers out, grows the
+ * bucket array if the estimate was too low, then marks the build DONE and
+ * wakes the others; from then on the table is read-only.
+ *
+ * Since a shared table cannot be split into batches, its memory is capped at
+ * space_allowed: work_mem for each planned participant, which is what they
+ * could have used between them with private tables.  space_used counts the
+ * bucket array and every tuple chunk allocated so far.
+ */
+#define PHJ_BUILD_HASHING		0
+#define PHJ_BUILD_GROWING		1
+#define PHJ_BUILD_DONE			2
+
+typedef struct ParallelHashJoinState
+{
+	slock_t		mutex;			/* protects all fields below */
+	int			phase;			/* PHJ_BUILD_* */
+	int			nbuilding;		/* # participants still inserting */
+	int			nbuckets;		/* # buckets in the shared table */
+	int			log2_nbuckets;	/* its log2 */
+	dsa_pointer buckets;		/* array of nbuckets dsa_pointer_atomic */
+	dsa_pointer chunks;			/* list of all tuple chunks */
+	double		ntuples;		/* # tuples inserted by all participants */
+	Size		size;			/* bytes used by tuples */
+	Size		space_used;		/* bytes allocated for buckets and chunks */
+	Size		space_allowed;	/* limit on space_used */
+	ConditionVariable build_cv; /* broadcast when the build is done */
+} ParallelHashJoinState;
+
 typedef struct HashJoinTableData
 {
 	int			nbuckets;		/* # buckets in the in-memory hash table */
@@ -188,6 +251,17 @@ typedef struct HashJoinTableData
 
 	/* used for dense allocation of tuples (into linked chunks) */
 	HashMemoryChunk chunks;		/* one list for the whole batch */
+
+	/* tuples in chunks not yet linked into their buckets, and the buckets */
+	HashJoinTuple pendingTuples[HJ_INSERT_BATCH_SIZE];
+	int			pendingBuckets[HJ_INSERT_BATCH_SIZE];
+	int			npending;
+
+	/* used only when the table is shared by a parallel query */
+	ParallelHashJoinState *parallel_state;
+	dsa_area   *area;			/* where the shared buckets and tuples live */
+	dsa_pointer_atomic *shared_buckets; /* mapped parallel_state->buckets */
+	dsa_pointer current_chunk_dp;	/* our chunk being filled, if any */
 }			HashJoinTableData;
 
 #endif							/* HASHJOIN_H */
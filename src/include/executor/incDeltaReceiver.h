@@ -0,0 +1,29 @@
+/*-------------------------------------------------------------------------
+ *
+ * incDeltaReceiver.h
+ *	  prototypes for incDeltaReceiver.c
+ *
+ *
+ * src/include/executor/incDeltaReceiver.h
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#ifndef INCDELTARECEIVER_H
+#define INCDELTARECEIVER_H
+
+#include "tcop/dest.h"
+
+extern bool iqp_delta_output;
+
+extern DestReceiver *CreateIncDeltaDestReceiver(void);
+
+extern void SetIncDeltaDestReceiverParams(DestReceiver *self, TupleDesc typeinfo, MemoryContext mc);
+
+extern TupleDesc IncDeltaDestResultDesc(DestReceiver *self);
+
+extern void SetIncDeltaDestReceiverInner(DestReceiver *self, DestReceiver *inner);
+
+extern bool IncDeltaDestEndRound(DestReceiver *self, int round);
+
+#endif
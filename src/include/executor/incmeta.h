@@ -23,6 +23,8 @@ extern bool use_sym_hashjoin;
 extern bool use_material;
 extern bool external_delta;
 extern bool is_complete; 
+extern double iqp_replan_threshold;
+extern bool iqp_cursor_refresh;
 
 extern char *wrong_table_update;
 extern bool  useWrongPrediction;
@@ -21,6 +21,8 @@ extern void ExecEndAgg(AggState *node);
 extern void ExecReScanAgg(AggState *node);
 
 extern Size hash_agg_entry_size(int numAggs);
+extern void hash_agg_set_limits(double hashentrysize, double input_groups,
+					int used_bits, Size *mem_limit, int *num_partitions);
 
 extern Datum aggregate_dummy(PG_FUNCTION_ARGS);
 
@@ -19,5 +19,6 @@
 extern AppendState *ExecInitAppend(Append *node, EState *estate, int eflags);
 extern void ExecEndAppend(AppendState *node);
 extern void ExecReScanAppend(AppendState *node);
+extern void ExecAsyncAppendResponse(AsyncRequest *areq);
 
 #endif							/* NODEAPPEND_H */
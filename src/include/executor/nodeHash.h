@@ -15,6 +15,9 @@
 #define NODEHASH_H
 
 #include "nodes/execnodes.h"
+#include "utils/dsa.h"
+
+struct ParallelHashJoinState;
 
 extern HashState *ExecInitHash(Hash *node, EState *estate, int eflags);
 extern Node *MultiExecHash(HashState *node);
@@ -23,10 +26,23 @@ extern void ExecReScanHash(HashState *node);
 
 extern HashJoinTable ExecHashTableCreate(Hash *node, List *hashOperators,
 					bool keepNulls);
+extern HashJoinTable ExecParallelHashTableCreate(HashState *state,
+							List *hashOperators,
+							bool keepNulls);
+extern void ExecParallelHashTableInitialize(struct ParallelHashJoinState *pstate,
+								dsa_area *area,
+								double ntuples, int tupwidth,
+								Size space_allowed);
+extern void ExecParallelHashTableReset(struct ParallelHashJoinState *pstate,
+						   dsa_area *area);
 extern void ExecHashTableDestroy(HashJoinTable hashtable);
 extern void ExecHashTableInsert(HashJoinTable hashtable,
 					TupleTableSlot *slot,
 					uint32 hashvalue);
+extern void ExecHashTableInsertDeferred(HashJoinTable hashtable,
+							TupleTableSlot *slot,
+							uint32 hashvalue);
+extern void ExecHashTableFlushInserts(HashJoinTable hashtable);
 extern bool ExecHashGetHashValue(HashJoinTable hashtable,
 					 ExprContext *econtext,
 					 List *hashkeys,
@@ -43,6 +59,7 @@ extern bool ExecScanHashTableForUnmatched(HashJoinState *hjstate,
 							  ExprContext *econtext);
 extern void ExecHashTableReset(HashJoinTable hashtable);
 extern void ExecHashTableResetMatchFlags(HashJoinTable hashtable);
+extern struct bloom_filter *ExecHashBuildBloomFilter(HashJoinTable hashtable);
 extern void ExecChooseHashTableSize(double ntuples, int tupwidth, bool useskew,
 						int *numbuckets,
 						int *numbatches,
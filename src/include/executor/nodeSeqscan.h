@@ -21,6 +21,10 @@ extern SeqScanState *ExecInitSeqScan(SeqScan *node, EState *estate, int eflags);
 extern void ExecEndSeqScan(SeqScanState *node);
 extern void ExecReScanSeqScan(SeqScanState *node);
 
+/* batch-at-a-time support */
+extern struct TupleBatch *ExecSeqScanInitBatch(SeqScanState *node, int maxrows);
+extern struct TupleBatch *ExecSeqScanNextBatch(SeqScanState *node);
+
 /* parallel scan support */
 extern void ExecSeqScanEstimate(SeqScanState *node, ParallelContext *pcxt);
 extern void ExecSeqScanInitializeDSM(SeqScanState *node, ParallelContext *pcxt);
@@ -18,6 +18,7 @@
 #include "access/heapam.h"
 #include "access/tupconvert.h"
 #include "executor/instrument.h"
+#include "lib/ilist.h"
 #include "lib/pairingheap.h"
 #include "nodes/params.h"
 #include "nodes/plannodes.h"
@@ -124,7 +125,9 @@ typedef struct ExprState
  *		entries for a particular index.  Used for both index_build and
  *		retail creation of index entries.
  *
- *		NumIndexAttrs		number of columns in this index
+ *		NumIndexAttrs		total number of columns in this index
+ *		NumIndexKeyAttrs	number of key columns in index; the rest are
+ *							included (non-key) columns
  *		KeyAttrNumbers		underlying-rel attribute numbers used as keys
  *							(zeroes indicate expressions)
  *		Expressions			expr trees for expression entries, or NIL if none
@@ -151,7 +154,8 @@ typedef struct ExprState
 typedef struct IndexInfo
 {
 	NodeTag		type;
-	int			ii_NumIndexAttrs;
+	int			ii_NumIndexAttrs;	/* total number of columns in index */
+	int			ii_NumIndexKeyAttrs;	/* number of key columns in index */
 	AttrNumber	ii_KeyAttrNumbers[INDEX_MAX_KEYS];
 	List	   *ii_Expressions; /* list of Expr */
 	List	   *ii_ExpressionsState;	/* list of ExprState */
@@ -558,8 +562,12 @@ typedef struct EState
     struct DPMeta      *dpmeta; 
     struct TPCH_Update *tpch_update;
     struct TPCH_Update *wrong_tpch_update; 
+    double             *deltaCorrection;    /* totem: observed/estimated delta size per leaf */
     int                 numDelta;           /* totem: number of delta we may have */ 
     int                 deltaIndex;         /* totem: the current delta */
+    bool                incRefreshPending;  /* totem: next ExecutorRun starts with ExecIncRun;
+                                             * lost at transaction end with the EState */
+    struct _DestReceiver *incDeltaDest;     /* totem: DestIncDelta wrapper, kept across runs */
     bool                leftChildExist; 
     bool                rightChildExist;
     struct PlanState    *tempLeftPS; 
@@ -895,6 +903,23 @@ struct PlanState;
  */
 typedef TupleTableSlot *(*ExecProcNodeMtd) (struct PlanState *pstate);
 
+/* ----------------
+ *		AsyncRequest
+ *
+ * State for an asynchronous tuple request.
+ * ----------------
+ */
+typedef struct AsyncRequest
+{
+	struct PlanState *requestor; /* Node that wants a tuple */
+	struct PlanState *requestee; /* Node from which a tuple is wanted */
+	int			request_index;	/* Scratch space for requestor */
+	bool		callback_pending;	/* Callback is needed */
+	bool		request_complete;	/* Request complete, result valid */
+	TupleTableSlot *result;		/* Result (NULL or an empty slot if no more
+								 * tuples) */
+} AsyncRequest;
+
 /* ----------------
  *		PlanState node
  *
@@ -919,6 +944,8 @@ typedef struct PlanState
 	Instrumentation *instrument;	/* Optional runtime stats for this node */
 	WorkerInstrumentation *worker_instrument;	/* per-worker instrumentation */
 
+	bool		async_capable;	/* true if node is async-capable */
+
 	/*
 	 * Common structural data for all Plan types.  These links to subsidiary
 	 * state trees parallel links in the associated plan tree (except for the
@@ -972,6 +999,11 @@ typedef struct PlanState
 		if (((PlanState *)(node))->instrument) \
 			((PlanState *)(node))->instrument->nfiltered2 += (delta); \
 	} while(0)
+#define InstrCountFiltered3(node, delta) \
+	do { \
+		if (((PlanState *)(node))->instrument) \
+			((PlanState *)(node))->instrument->nfiltered3 += (delta); \
+	} while(0)
 
 /*
  * EPQState is state for executing an EvalPlanQual recheck on a candidate
@@ -1067,14 +1099,44 @@ typedef struct ModifyTableState
  *
  *		nplans			how many plans are in the array
  *		whichplan		which plan is being executed (0 .. n-1)
+ *		prune_state		run-time partition pruning state, or NULL if
+ *						all the subplans in the array are to be scanned
+ *		valid_subplans	the subplans to scan, if prune_state is set
+ *		valid_stale		must valid_subplans be recomputed?
+ *		begun			have we started scanning yet?
+ *		asyncplans		the subplans to be executed asynchronously
+ *		nasyncplans		how many of them there are
+ *		asyncrequests	array of AsyncRequests, indexed by subplan number
+ *		asyncresults	unreturned results of async subplans
+ *		nasyncresults	how many of those there are
+ *		nasyncremain	number of async subplans not yet exhausted
+ *		needrequest		async subplans ready for a new request
+ *		eventset		WaitEventSet used to wait for async subplans
+ *		syncdone		have we finished all the sync subplans?
  * ----------------
  */
+struct PartitionPruneState;
+struct WaitEventSet;
+
 typedef struct AppendState
 {
 	PlanState	ps;				/* its first field is NodeTag */
 	PlanState **appendplans;	/* array of PlanStates for my inputs */
 	int			as_nplans;
 	int			as_whichplan;
+	struct PartitionPruneState *as_prune_state;
+	Bitmapset  *as_valid_subplans;
+	bool		as_valid_stale;
+	bool		as_begun;
+	Bitmapset  *as_asyncplans;
+	int			as_nasyncplans;
+	AsyncRequest **as_asyncrequests;
+	TupleTableSlot **as_asyncresults;
+	int			as_nasyncresults;
+	int			as_nasyncremain;
+	Bitmapset  *as_needrequest;
+	struct WaitEventSet *as_eventset;
+	bool		as_syncdone;
 } AppendState;
 
 /* ----------------
@@ -1086,6 +1148,10 @@ typedef struct AppendState
  *		slots			current output tuple of each subplan
  *		heap			heap of active tuples
  *		initialized		true if we have fetched first tuple from each subplan
+ *		prune_state		run-time partition pruning state, or NULL if
+ *						all the subplans in the array are to be scanned
+ *		valid_subplans	the subplans to scan, if prune_state is set
+ *		valid_stale		must valid_subplans be recomputed?
  * ----------------
  */
 typedef struct MergeAppendState
@@ -1098,6 +1164,9 @@ typedef struct MergeAppendState
 	TupleTableSlot **ms_slots;	/* array of length ms_nplans */
 	struct binaryheap *ms_heap; /* binary heap of slot indices */
 	bool		ms_initialized; /* are subplans started? */
+	struct PartitionPruneState *ms_prune_state;
+	Bitmapset  *ms_valid_subplans;
+	bool		ms_valid_stale;
 } MergeAppendState;
 
 /* ----------------
@@ -1167,12 +1236,33 @@ typedef struct BitmapOrState
  *		ScanTupleSlot	   pointer to slot in tuple table holding scan tuple
  * ----------------
  */
+/* ----------------
+ *	 RuntimeFilterState information
+ *
+ *		A Bloom filter over the hash values of a hash join's inner side,
+ *		which the HashJoin publishes once its hash table is built, and the
+ *		scan producing the join's outer keys tests each of its rows against.
+ *		filter is NULL until then, and whenever the hash table is rebuilt.
+ * ----------------
+ */
+typedef struct RuntimeFilterState
+{
+	struct bloom_filter *filter;	/* published filter, or NULL */
+	List	   *keys;			/* list of ExprState nodes */
+	FmgrInfo   *hashfunctions;	/* outer-side hash function per key */
+	bool	   *hashstrict;		/* is each hash operator strict? */
+	bool		disabled;		/* gave up on the filter as unselective */
+	double		nprobed;		/* # rows tested against the filter */
+	double		nremoved;		/* # of those it rejected */
+} RuntimeFilterState;
+
 typedef struct ScanState
 {
 	PlanState	        ps;				/* its first field is NodeTag */
 	Relation	        ss_currentRelation;
 	HeapScanDesc        ss_currentScanDesc;
 	TupleTableSlot      *ss_ScanTupleSlot;
+	RuntimeFilterState  *ss_rtfilter;	/* hash join's Bloom filter, or NULL */
     struct IncTupQueueReader   *tq_reader; /* totem: memory buffer to hold delta data */
 } ScanState;
 
@@ -1184,6 +1274,9 @@ typedef struct SeqScanState
 {
 	ScanState	ss;				/* its first field is NodeTag */
 	Size		pscan_len;		/* size of parallel heap scan descriptor */
+	struct TupleBatch *batch;	/* batch buffer, if read batch-at-a-time */
+	struct BatchExprState *batchqual;	/* qual compiled for batches */
+	bool		batchdone;		/* batch scan has reached the end? */
 } SeqScanState;
 
 /* ----------------
@@ -1783,6 +1876,15 @@ typedef struct HashJoinState
 	TupleTableSlot *hj_NullOuterTupleSlot;
 	TupleTableSlot *hj_NullInnerTupleSlot;
 	TupleTableSlot *hj_FirstOuterTupleSlot;
+	RuntimeFilterState *hj_RuntimeFilter;	/* outer scan's filter, or NULL */
+	TupleTableSlot *hj_ProbeSlot;	/* slot for handing out batched tuples */
+	MinimalTuple *hj_ProbeTuples;	/* batch of outer tuples being probed */
+	MemoryContext hj_ProbeCxt;	/* holds the batch's tuples */
+	uint32	   *hj_ProbeHashValues; /* and their hash values */
+	int			hj_ProbeNTuples;	/* # of outer tuples in the batch */
+	int			hj_ProbeNext;	/* next one to hand out */
+	bool		hj_ProbeBatched;	/* probe batch-at-a-time? */
+	bool		hj_ProbeExhausted;	/* outer side ran out filling the batch */
     HashJoinTable     hj_OuterHashTable; /* totem: outer hash table */
     struct HashState *hj_OuterHashNode;   /* totem: outer hashstate node for hash table */
     HashJoinTable  hj_RealHashTable;
@@ -1830,6 +1932,60 @@ typedef struct MaterialState
 	Tuplestorestate *tuplestorestate;
 } MaterialState;
 
+/* ----------------
+ *	 memoize execution statistics, for EXPLAIN ANALYZE
+ * ----------------
+ */
+typedef struct MemoizeInstrumentation
+{
+	uint64		cache_hits;		/* number of rescans where we've found the
+								 * scan parameter values to be cached */
+	uint64		cache_misses;	/* number of rescans where we've not found the
+								 * scan parameter values to be cached. */
+	uint64		cache_evictions;	/* number of cache entries removed due to
+									 * the need to free memory */
+	uint64		cache_overflows;	/* number of times we've had to bypass the
+									 * cache when filling it due to not being
+									 * able to free enough space to store the
+									 * current scan's tuples. */
+	uint64		mem_peak;		/* peak memory usage in bytes */
+} MemoizeInstrumentation;
+
+/* ----------------
+ *	 MemoizeState information
+ *
+ *		memoize nodes are used to cache recent and commonly seen results from
+ *		a parameterized scan.
+ * ----------------
+ */
+typedef struct MemoizeState
+{
+	ScanState	ss;				/* its first field is NodeTag */
+	int			mstatus;		/* value of ExecMemoize state machine */
+	int			nkeys;			/* number of cache keys */
+	struct memoize_hash *hashtable; /* hash table for cache entries */
+	TupleTableSlot *tableslot;	/* min tuple slot for existing cache entries */
+	TupleTableSlot *probeslot;	/* virtual slot used for hash lookups */
+	ExprState **param_exprs;	/* exprs containing the parameters to this
+								 * node */
+	FmgrInfo   *hashfunctions;	/* lookup data for hash funcs nkeys in size */
+	FmgrInfo   *eqfunctions;	/* lookup data for equality funcs */
+	Oid		   *collations;		/* collation for comparisons nkeys in size */
+	uint64		mem_used;		/* bytes of memory used by cache */
+	uint64		mem_limit;		/* memory limit in bytes for the cache */
+	MemoryContext tableContext; /* memory context to store cache data */
+	dlist_head	lru_list;		/* least recently used entry list */
+	struct MemoizeTuple *last_tuple;	/* Used to point to the last tuple
+										 * returned during a cache hit and the
+										 * tuple we last stored when
+										 * populating the cache. */
+	struct MemoizeEntry *entry; /* the entry that 'last_tuple' belongs to or
+								 * NULL if 'last_tuple' is NULL. */
+	Bitmapset  *keyparamids;	/* Param->paramids of expressions belonging to
+								 * param_exprs */
+	MemoizeInstrumentation stats;	/* execution statistics */
+} MemoizeState;
+
 /* ----------------
  *	 MaterialIncState information
  *
@@ -1869,6 +2025,28 @@ typedef struct SortState
     bool        isEOF;          /* totem: whether tuplesortstate reaches to eof */
 } SortState;
 
+/* ----------------
+ *	 IncrementalSortState information
+ * ----------------
+ */
+typedef struct IncrementalSortState
+{
+	ScanState	ss;				/* its first field is NodeTag */
+	bool		bounded;		/* is the result set bounded? */
+	int64		bound;			/* if bounded, how many tuples are needed */
+	int64		bound_Done;		/* number of tuples returned so far */
+	bool		outerNodeDone;	/* outer node has returned all tuples? */
+	bool		sort_Done;		/* current batch sorted and being returned? */
+	FmgrInfo   *presortedEqfuncs;	/* equality fns for presorted keys */
+	TupleTableSlot *group_pivot;	/* tuple whose group ends the batch */
+	TupleTableSlot *transfer_tuple; /* first tuple of the next batch */
+	void	   *tuplesortstate; /* private state of tuplesort.c */
+	/* for EXPLAIN ANALYZE: */
+	long		nbatches;		/* number of batches sorted */
+	long		maxSpaceUsed;	/* largest space used by one batch, in kB */
+	const char *maxSpaceType;	/* "Memory" or "Disk" for that batch */
+} IncrementalSortState;
+
 /* ---------------------
  *	GroupState information
  * ---------------------
@@ -1898,6 +2076,8 @@ typedef struct AggStatePerTransData *AggStatePerTrans;
 typedef struct AggStatePerGroupData *AggStatePerGroup;
 typedef struct AggStatePerPhaseData *AggStatePerPhase;
 typedef struct AggStatePerHashData *AggStatePerHash;
+typedef struct HashAggSpillData *HashAggSpill;
+typedef struct AggBatchStateData *AggBatchState;
 
 typedef struct AggState
 {
@@ -1937,6 +2117,22 @@ typedef struct AggState
 	int			        num_hashes;
 	AggStatePerHash     perhash;
 	AggStatePerGroup    *hash_pergroup;	/* array of per-group pointers */
+	/* these fields are used when AGG_HASHED spills to disk: */
+	bool		        hash_spill_mode;	/* new groups go to disk, not the table */
+	bool		        hash_ever_spilled;	/* spilled since last rescan? */
+	double		        hashentrysize;	/* estimated bytes per group */
+	Size		        hash_mem_limit;	/* spill once the tables use more */
+	Size		        hash_mem_peak;	/* peak memory used by the tables */
+	int64		        hash_ngroups_current;	/* groups in the current tables */
+	HashAggSpill        hash_spills;	/* per-set spill state, or NULL */
+	List	            *hash_batches;	/* spilled partitions left to process */
+	int			        hash_batch_setno;	/* set being refilled, or -1 */
+	int			        hash_batches_used;	/* batches processed so far */
+	long		        hash_disk_open;	/* blocks in open spill files */
+	long		        hash_disk_peak;	/* peak of hash_disk_open */
+	TupleTableSlot      *hash_spill_slot;	/* slot for re-reading spilled input */
+	/* set when AGG_PLAIN reads its input batch-at-a-time: */
+	AggBatchState       batch;
 	/* support for evaluation of agg input expressions: */
 	ProjectionInfo      *combinedproj;	/* projection machinery */
 	AggStatePerAgg      curperagg;	    /* currently active aggregate, if any */
@@ -2089,6 +2285,9 @@ typedef struct HashState
 	HashJoinTable hashtable;	/* hash table for the hashjoin */
 	List	   *hashkeys;		/* list of ExprState nodes */
 	/* hashkeys is same as parent's hj_InnerHashKeys */
+
+	/* shared hash table state, set up by the parent's DSM callbacks */
+	struct ParallelHashJoinState *parallel_state;
 } HashState;
 
 /* ----------------
@@ -138,6 +138,11 @@ typedef struct Plan
 	bool		parallel_aware; /* engage parallel-aware logic? */
 	bool		parallel_safe;	/* OK to use as part of parallel plan? */
 
+	/*
+	 * information needed for asynchronous execution
+	 */
+	bool		async_capable;	/* engage asynchronous-capable logic? */
+
 	/*
 	 * Common structural data for all Plan types.
 	 */
@@ -238,6 +243,29 @@ typedef struct ModifyTable
 	List	   *exclRelTlist;	/* tlist of the EXCLUDED pseudo relation */
 } ModifyTable;
 
+/* ----------------
+ *	 PartitionPruneInfo -
+ *		Details for removing the subplans of an Append or MergeAppend over
+ *		a partitioned table at execution time.
+ *
+ * Each member of 'exprs' is compared with the first partition key column
+ * using the btree strategy number in the same position of 'strategies';
+ * IS [NOT] NULL tests have a NULL expr and a pseudo strategy number (see
+ * catalog/partition.h).  'subplan_partidx' gives, for each subplan, the
+ * index in the table's PartitionDesc of the partition it scans or that
+ * contains it, or -1 if the subplan can't be pruned.
+ * ----------------
+ */
+typedef struct PartitionPruneInfo
+{
+	NodeTag		type;
+	Oid			reloid;			/* OID of the partitioned table */
+	List	   *exprs;			/* values to compare the key with */
+	List	   *strategies;		/* integer list of strategy numbers */
+	List	   *subplan_partidx;	/* integer list, one per subplan */
+	bool		exec_params;	/* do exprs reference PARAM_EXEC Params? */
+} PartitionPruneInfo;
+
 /* ----------------
  *	 Append node -
  *		Generate the concatenation of the results of sub-plans.
@@ -249,6 +277,8 @@ typedef struct Append
 	/* RT indexes of non-leaf tables in a partition tree */
 	List	   *partitioned_rels;
 	List	   *appendplans;
+	/* info for run-time partition pruning, or NULL */
+	PartitionPruneInfo *part_prune_info;
 } Append;
 
 /* ----------------
@@ -268,6 +298,8 @@ typedef struct MergeAppend
 	Oid		   *sortOperators;	/* OIDs of operators to sort them by */
 	Oid		   *collations;		/* OIDs of collations */
 	bool	   *nullsFirst;		/* NULLS FIRST/LAST directions */
+	/* info for run-time partition pruning, or NULL */
+	PartitionPruneInfo *part_prune_info;
 } MergeAppend;
 
 /* ----------------
@@ -328,6 +360,16 @@ typedef struct Scan
 {
 	Plan		plan;
 	Index		scanrelid;		/* relid is index into the range table */
+
+	/*
+	 * If rtfilter_id is not zero, a hash join above this scan (the HashJoin
+	 * with the same rtfilter_id) may publish a Bloom filter over its inner
+	 * side's hash values, and we skip rows whose rtfilter_keys cannot match.
+	 * rtfilter_ops are the hash join operators' OIDs, one per key.
+	 */
+	int			rtfilter_id;
+	List	   *rtfilter_keys;	/* outer hash keys, evaluated on scan tuple */
+	List	   *rtfilter_ops;	/* OIDs of the matching hash operators */
 } Scan;
 
 /* ----------------
@@ -382,6 +424,8 @@ typedef struct SampleScan
  *
  * indexorderdir specifies the scan ordering, for indexscans on amcanorder
  * indexes (for other indexes it should be "don't care").
+ *
+ * indexskip asks the index AM for a skip scan (see amcanskip).
  * ----------------
  */
 typedef struct IndexScan
@@ -394,6 +438,7 @@ typedef struct IndexScan
 	List	   *indexorderbyorig;	/* the same in original form */
 	List	   *indexorderbyops;	/* OIDs of sort ops for ORDER BY exprs */
 	ScanDirection indexorderdir;	/* forward or backward or don't care */
+	bool		indexskip;		/* skip scan over the first column? */
 } IndexScan;
 
 /* ----------------
@@ -421,6 +466,7 @@ typedef struct IndexOnlyScan
 	List	   *indexorderby;	/* list of index ORDER BY exprs */
 	List	   *indextlist;		/* TargetEntry list describing index's cols */
 	ScanDirection indexorderdir;	/* forward or backward or don't care */
+	bool		indexskip;		/* skip scan over the first column? */
 } IndexOnlyScan;
 
 /* ----------------
@@ -725,6 +771,7 @@ typedef struct HashJoin
 {
 	Join		join;
 	List	   *hashclauses;
+	int			rtfilter_id;	/* runtime Bloom filter target, or 0 */
 } HashJoin;
 
 /* ----------------
@@ -736,6 +783,25 @@ typedef struct Material
 	Plan		plan;
 } Material;
 
+/* ----------------
+ *		memoize node
+ *
+ * Caches the results of its parameterized subplan, keyed by the values of
+ * param_exprs, so that rescans with already-seen values need not run it.
+ * ----------------
+ */
+typedef struct Memoize
+{
+	Plan		plan;
+	int			numKeys;		/* size of the two arrays below */
+	Oid		   *hashOperators;	/* hash operators for each key */
+	Oid		   *collations;		/* collations for each key */
+	List	   *param_exprs;	/* exprs containing the cache key parameters */
+	uint32		est_entries;	/* planner's estimate of the number of cache
+								 * entries, or 0 if unknown */
+	Bitmapset  *keyparamids;	/* paramids of the params in param_exprs */
+} Memoize;
+
 /* ----------------
  *		sort node
  * ----------------
@@ -750,6 +816,18 @@ typedef struct Sort
 	bool	   *nullsFirst;		/* NULLS FIRST/LAST directions */
 } Sort;
 
+/* ----------------
+ *		incremental sort node
+ *
+ * The input is already sorted on the first nPresortedCols sort keys.
+ * ----------------
+ */
+typedef struct IncrementalSort
+{
+	Sort		sort;
+	int			nPresortedCols; /* number of presorted columns */
+} IncrementalSort;
+
 /* ---------------
  *	 group node -
  *		Used for queries with GROUP BY (but no aggregates) specified.
@@ -122,6 +122,8 @@ typedef struct PlannerGlobal
 
 	int			lastPlanNodeId; /* highest plan node ID assigned */
 
+	int			lastRtFilterId; /* highest runtime Bloom filter ID assigned */
+
 	bool		transientPlan;	/* redo plan when TransactionXmin changes? */
 
 	bool		dependsOnRole;	/* is plan specific to current role? */
@@ -253,6 +255,9 @@ typedef struct PlannerInfo
 
 	List	   *pcinfo_list;	/* list of PartitionedChildRelInfos */
 
+	List	   *part_schemes;	/* Canonicalised partition schemes used in the
+								 * query. */
+
 	List	   *rowMarks;		/* list of PlanRowMarks */
 
 	List	   *placeholder_list;	/* list of PlaceHolderInfos */
@@ -484,6 +489,21 @@ typedef struct PlannerInfo
  * the RelOptInfo to store the joininfo list, because that is the same
  * for a given rel no matter how we form it.
  *
+ * If the relation is partitioned, and the partitioning is usable for
+ * partition-wise join or aggregation, these fields are set:
+ *
+ *		part_scheme - Partitioning scheme of the relation
+ *		nparts - Number of partitions
+ *		boundinfo - Partition bounds
+ *		part_rels - RelOptInfos for each partition, in bound order
+ *		partexprs, nullable_partexprs - Partition key expressions
+ *
+ * The partexprs arrays have one List per partition key column.  A base rel
+ * has a single expression per column; an inner join is partitioned on the
+ * keys of both of its inputs, so has one for each.  Keys that outer joins
+ * can null out live in nullable_partexprs and are usable only to match
+ * strict join clauses.
+ *
  * We store baserestrictcost in the RelOptInfo (for base relations) because
  * we know we will need it at least once (to price the sequential scan)
  * and may need it multiple times to price index scans.
@@ -494,6 +514,7 @@ typedef enum RelOptKind
 	RELOPT_BASEREL,
 	RELOPT_JOINREL,
 	RELOPT_OTHER_MEMBER_REL,
+	RELOPT_OTHER_JOINREL,
 	RELOPT_UPPER_REL,
 	RELOPT_DEADREL
 } RelOptKind;
@@ -507,13 +528,40 @@ typedef enum RelOptKind
 	 (rel)->reloptkind == RELOPT_OTHER_MEMBER_REL)
 
 /* Is the given relation a join relation? */
-#define IS_JOIN_REL(rel) ((rel)->reloptkind == RELOPT_JOINREL)
+#define IS_JOIN_REL(rel)	\
+	((rel)->reloptkind == RELOPT_JOINREL || \
+	 (rel)->reloptkind == RELOPT_OTHER_JOINREL)
 
 /* Is the given relation an upper relation? */
 #define IS_UPPER_REL(rel) ((rel)->reloptkind == RELOPT_UPPER_REL)
 
 /* Is the given relation an "other" relation? */
-#define IS_OTHER_REL(rel) ((rel)->reloptkind == RELOPT_OTHER_MEMBER_REL)
+#define IS_OTHER_REL(rel) \
+	((rel)->reloptkind == RELOPT_OTHER_MEMBER_REL || \
+	 (rel)->reloptkind == RELOPT_OTHER_JOINREL)
+
+/*
+ * PartitionSchemeData
+ *		The partitioning properties that decide whether two relations'
+ *		partitions can be matched up one-to-one.
+ *
+ * Relations whose partition keys agree in all of these share a single
+ * PartitionScheme, so planner code compares schemes by pointer.
+ */
+typedef struct PartitionSchemeData
+{
+	char		strategy;		/* partition strategy */
+	int16		partnatts;		/* number of partition attributes */
+	Oid		   *partopfamily;	/* OIDs of operator families */
+	Oid		   *partopcintype;	/* OIDs of opclass declared input data types */
+	Oid		   *partcollation;	/* OIDs of partitioning collations */
+
+	/* Cached information about partition key data types. */
+	int16	   *parttyplen;
+	bool	   *parttypbyval;
+} PartitionSchemeData;
+
+typedef struct PartitionSchemeData *PartitionScheme;
 
 typedef struct RelOptInfo
 {
@@ -592,18 +640,38 @@ typedef struct RelOptInfo
 
 	/* used by "other" relations */
 	Relids		top_parent_relids;	/* Relids of topmost parents */
+
+	/* used for partitioned relations */
+	PartitionScheme part_scheme;	/* Partitioning scheme. */
+	int			nparts;			/* number of partitions */
+	struct PartitionBoundInfoData *boundinfo;	/* Partition bounds */
+	struct RelOptInfo **part_rels;	/* Array of RelOptInfos of partitions,
+									 * stored in the same order of bounds */
+	List	  **partexprs;		/* Non-nullable partition key expressions. */
+	List	  **nullable_partexprs; /* Nullable partition key expressions. */
 } RelOptInfo;
 
+/*
+ * Is given relation partitioned in a way partition-wise join or aggregation
+ * can use?  A proven-empty relation is not, since it has no paths to append.
+ */
+#define IS_PARTITIONED_REL(rel) \
+	((rel)->part_scheme && (rel)->boundinfo && (rel)->nparts > 0 && \
+	 (rel)->part_rels && !IS_DUMMY_REL(rel))
+
 /*
  * IndexOptInfo
  *		Per-index information for planning/optimization
  *
  *		indexkeys[], indexcollations[], opfamily[], and opcintype[]
- *		each have ncolumns entries.
+ *		each have ncolumns entries.  The first nkeycolumns of those are key
+ *		columns; the rest are included columns, which can be returned by an
+ *		index-only scan but can't be searched or ordered by, and have zero
+ *		opfamily, opcintype and collation.
  *
- *		sortopfamily[], reverse_sort[], and nulls_first[] likewise have
- *		ncolumns entries, if the index is ordered; but if it is unordered,
- *		those pointers are NULL.
+ *		sortopfamily[], reverse_sort[], and nulls_first[] have nkeycolumns
+ *		entries, if the index is ordered; but if it is unordered, those
+ *		pointers are NULL.
  *
  *		Zeroes in the indexkeys[] array indicate index columns that are
  *		expressions; there is one element in indexprs for each such column.
@@ -639,6 +707,7 @@ typedef struct IndexOptInfo
 
 	/* index descriptor information */
 	int			ncolumns;		/* number of columns in index */
+	int			nkeycolumns;	/* number of key columns in index */
 	int		   *indexkeys;		/* column numbers of index's keys, or 0 */
 	Oid		   *indexcollations;	/* OIDs of collations of index columns */
 	Oid		   *opfamily;		/* OIDs of operator families for columns */
@@ -674,6 +743,7 @@ typedef struct IndexOptInfo
 	bool		amhasgettuple;	/* does AM have amgettuple interface? */
 	bool		amhasgetbitmap; /* does AM have amgetbitmap interface? */
 	bool		amcanparallel;	/* does AM support parallel scan? */
+	bool		amcanskip;		/* does AM support skip scan? */
 	/* Rather than include amapi.h here, we declare amcostestimate like this */
 	void		(*amcostestimate) ();	/* AM's cost estimator */
 } IndexOptInfo;
@@ -1019,6 +1089,10 @@ typedef struct Path
  * NoMovementScanDirection for an indexscan, but the planner wants to
  * distinguish ordered from unordered indexes for building pathkeys.)
  *
+ * 'indexskip' is true for a skip scan: the index AM scans separately for
+ * each distinct value of the first index column, which has no indexquals,
+ * using the quals on the second column to bound each of those scans.
+ *
  * 'indextotalcost' and 'indexselectivity' are saved in the IndexPath so that
  * we need not recompute them when considering using the same index in a
  * bitmap index/heap scan (see BitmapHeapPath).  The costs of the IndexPath
@@ -1035,6 +1109,7 @@ typedef struct IndexPath
 	List	   *indexorderbys;
 	List	   *indexorderbycols;
 	ScanDirection indexscandir;
+	bool		indexskip;
 	Cost		indextotalcost;
 	Selectivity indexselectivity;
 } IndexPath;
@@ -1226,6 +1301,23 @@ typedef struct MaterialPath
 	Path	   *subpath;
 } MaterialPath;
 
+/*
+ * MemoizePath represents a Memoize plan node, i.e., a cache of the results
+ * of a parameterized subpath, keyed by the values of its parameters.  It is
+ * used for the inner side of a nestloop whose outer side repeats values.
+ */
+typedef struct MemoizePath
+{
+	Path		path;
+	Path	   *subpath;		/* outerpath to cache tuples from */
+	List	   *hash_operators; /* hash operators for each key */
+	List	   *param_exprs;	/* cache keys */
+	double		calls;			/* expected number of rescans */
+	uint32		est_entries;	/* The maximum number of entries that the
+								 * planner expects will fit in the cache, or 0
+								 * if unknown */
+} MemoizePath;
+
 /*
  * UniquePath represents elimination of distinct rows from the output of
  * its subpath.
@@ -1418,6 +1510,16 @@ typedef struct SortPath
 	Path	   *subpath;		/* path representing input source */
 } SortPath;
 
+/*
+ * IncrementalSortPath represents an incremental sort step: the input is
+ * already sorted on the first nPresortedCols of the path's pathkeys.
+ */
+typedef struct IncrementalSortPath
+{
+	SortPath	spath;
+	int			nPresortedCols; /* number of presorted columns */
+} IncrementalSortPath;
+
 /*
  * GroupPath represents grouping (of presorted input)
  *
@@ -2219,6 +2321,7 @@ typedef struct JoinCostWorkspace
 	/* private for cost_hashjoin code */
 	int			numbuckets;
 	int			numbatches;
+	double		inner_rows_total;
 } JoinCostWorkspace;
 
 #endif							/* RELATION_H */
@@ -0,0 +1,27 @@
+/*-------------------------------------------------------------------------
+ *
+ * partprune.h
+ *	  prototypes for partprune.c.
+ *
+ *
+ * Portions Copyright (c) 1996-2017, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/optimizer/partprune.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef PARTPRUNE_H
+#define PARTPRUNE_H
+
+#include "nodes/plannodes.h"
+#include "nodes/relation.h"
+
+extern Relids prune_append_rel_partitions(PlannerInfo *root, RelOptInfo *rel,
+							RangeTblEntry *rte);
+extern PartitionPruneInfo *make_partition_pruneinfo(PlannerInfo *root,
+						 RelOptInfo *rel,
+						 List *subpaths,
+						 List *clauses);
+
+#endif							/* PARTPRUNE_H */
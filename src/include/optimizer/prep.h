@@ -58,4 +58,11 @@ extern Node *adjust_appendrel_attrs(PlannerInfo *root, Node *node,
 extern Node *adjust_appendrel_attrs_multilevel(PlannerInfo *root, Node *node,
 								  RelOptInfo *child_rel);
 
+extern Node *adjust_appendrel_attrs_list(PlannerInfo *root, Node *node,
+							List *appinfos);
+
+extern Relids adjust_child_relids(Relids relids, List *appinfos);
+
+extern List *find_appinfos_by_relids(PlannerInfo *root, Relids relids);
+
 #endif							/* PREP_H */
@@ -121,7 +121,9 @@ typedef struct
  *
  * Callers should initialize all fields of GenericCosts to zero.  In addition,
  * they can set numIndexTuples to some positive value if they have a better
- * than default way of estimating the number of leaf index tuples visited.
+ * than default way of estimating the number of leaf index tuples visited,
+ * and num_skip_scans to the number of separate scans a skip scan performs.
+ * num_sa_scans on return counts the latter too.
  */
 typedef struct
 {
@@ -136,6 +138,7 @@ typedef struct
 	double		numIndexTuples; /* number of leaf tuples visited */
 	double		spc_random_page_cost;	/* relevant random_page_cost value */
 	double		num_sa_scans;	/* # indexscans from ScalarArrayOps */
+	double		num_skip_scans; /* # indexscans from skip scan, if any */
 } GenericCosts;
 
 /* Hooks for plugins to get control when we ask for stats */
@@ -0,0 +1,317 @@
+#!/bin/bash
+#
+# iqp_bench.sh
+#	  Benchmark the incremental engines (IQP, DBT) against batch execution
+#
+# Runs every query of tpch_conf/iqp_query under the requested modes and
+# reports, per query and mode, the p50/p99 latency of the delta rounds,
+# the latency of the final round, the peak kept state and the time spent
+# deciding states.  The numbers come from the stat files the executor
+# appends under $PGDATA (iqp_stat/, dbt_stat/, timeFile_batch.txt), so the
+# server must be local.
+#
+# src/test/iqp/iqp_bench.sh
+#
+
+set -e
+
+usage()
+{
+	cat <<EOF
+Usage: $0 [OPTION]...
+
+  -D DATADIR      data directory of the running server (default: \$PGDATA)
+  -d DBNAME       database to use (default: \$PGDATABASE or tpch)
+  -c CONFDIR      tpch_conf directory (default: <source tree>/tpch_conf)
+  -q QUERIES      queries to run (default: all of CONFDIR/iqp_query)
+  -m MODES        any of batch, dbt and the decision_method values
+                  (default: "batch dp recycler topdown bottomup memsmallfirst membigfirst dbt")
+  -r REPEAT       repetitions per query and mode (default: 3)
+  -s SCALE        TPC-H scale factor (default: 0.1)
+  -b BUDGET       memory_budget in kB for IQP (default: 102400)
+  -M DELTAMODE    tpch_delta_mode (default: binomial)
+  -p PROB         bd_prob (default: 0.9)
+  -e EXPDELTA     exp_delta (default: 0.01)
+  -f FRACTION     fraction of each key range staged as deltas (default: 0.2)
+  -o OUTDIR       where to write the results (default: ./results)
+  -B BASELINE     summary.tsv of an earlier run to compare against
+  -t TOLERANCE    allowed slowdown/growth over BASELINE in percent (default: 10)
+  -L              (re)load the TPC-H subset and the per-query tables first
+  -h              show this help
+EOF
+}
+
+srcdir=$(cd "$(dirname "$0")" && pwd)
+
+datadir=$PGDATA
+dbname=${PGDATABASE:-tpch}
+confdir=$srcdir/../../../tpch_conf
+queries=
+modes="batch dp recycler topdown bottomup memsmallfirst membigfirst dbt"
+repeat=3
+scale=0.1
+budget=102400
+delta_mode=binomial
+bd_prob=0.9
+exp_delta=0.01
+delta_fraction=0.2
+outdir=results
+baseline=
+tolerance=10
+load=no
+
+while getopts "D:d:c:q:m:r:s:b:M:p:e:f:o:B:t:Lh" opt
+do
+	case $opt in
+		D) datadir=$OPTARG ;;
+		d) dbname=$OPTARG ;;
+		c) confdir=$OPTARG ;;
+		q) queries=$OPTARG ;;
+		m) modes=$OPTARG ;;
+		r) repeat=$OPTARG ;;
+		s) scale=$OPTARG ;;
+		b) budget=$OPTARG ;;
+		M) delta_mode=$OPTARG ;;
+		p) bd_prob=$OPTARG ;;
+		e) exp_delta=$OPTARG ;;
+		f) delta_fraction=$OPTARG ;;
+		o) outdir=$OPTARG ;;
+		B) baseline=$OPTARG ;;
+		t) tolerance=$OPTARG ;;
+		L) load=yes ;;
+		h) usage; exit 0 ;;
+		*) usage >&2; exit 2 ;;
+	esac
+done
+
+if [ -z "$datadir" ] || [ ! -f "$datadir/PG_VERSION" ]
+then
+	echo "$0: data directory not found, use -D or set PGDATA" >&2
+	exit 2
+fi
+
+if [ -z "$queries" ]
+then
+	queries=$(cd "$confdir/iqp_query" && ls q*.sql | grep -v _para | sed 's/\.sql$//' | sort -V)
+fi
+
+PSQL="${PSQL:-psql} -X -q -v ON_ERROR_STOP=1 -d $dbname"
+
+mkdir -p "$outdir/scripts"
+rounds_file=$outdir/rounds.tsv
+state_file=$outdir/state.tsv
+summary_file=$outdir/summary.tsv
+printf "query\tmode\trep\tround\tms\n" > "$rounds_file"
+printf "query\tmode\trep\tpeak_state_kb\tdecision_ms\n" > "$state_file"
+
+# The executor reads its configuration relative to the data directory
+mkdir -p "$datadir/iqp_conf" "$datadir/iqp_stat" "$datadir/dbt_conf" "$datadir/dbt_stat"
+cp "$confdir"/iqp_conf/*.conf "$confdir"/iqp_conf/*.mem "$datadir/iqp_conf/"
+cp "$confdir"/dbt_conf/*.conf "$confdir"/dbt_conf/*.base "$datadir/dbt_conf/"
+
+if [ "$load" = yes ]
+then
+	echo "loading TPC-H subset at scale $scale"
+	$PSQL -v scale="$scale" -v delta_fraction="$delta_fraction" -f "$srcdir/sql/tpch_load.sql"
+	for q in $queries
+	do
+		for f in iqp_conf/${q}_build.sql iqp_conf/${q}_load.sql dbt_conf/${q}_build.sql
+		do
+			[ -f "$confdir/$f" ] && $PSQL -f "$confdir/$f" > /dev/null
+		done
+	done
+	$PSQL -c "ANALYZE"
+fi
+
+# Number of lines currently in a stat file
+stat_lines()
+{
+	if [ -f "$1" ]; then wc -l < "$1"; else echo 0; fi
+}
+
+# Lines appended to a stat file since it had $2 lines
+stat_new()
+{
+	[ -f "$1" ] && tail -n +$(($2 + 1)) "$1" | grep -v '^$' || true
+}
+
+# Build the script for one run: the query file's own settings, then ours,
+# then the query itself
+make_script()
+{
+	local qfile=$1 mode=$2 script=$3
+
+	grep -i '^ *set ' "$qfile" > "$script" || true
+	cat >> "$script" <<EOF
+set client_min_messages to warning;
+set max_parallel_workers_per_gather to 0;
+set tpch_scale_factor to $scale;
+set tpch_delta_mode to $delta_mode;
+set bd_prob to $bd_prob;
+set exp_delta to $exp_delta;
+set tpch_inproc_delta to on;
+set enable_wrong_prediction to off;
+EOF
+	case $mode in
+		batch)
+			echo "set enable_incremental to off;" >> "$script"
+			echo "set enable_dbtoaster to off;" >> "$script"
+			;;
+		dbt)
+			;;
+		*)
+			echo "set enable_incremental to on;" >> "$script"
+			echo "set gen_mem_info to off;" >> "$script"
+			echo "set decision_method to $mode;" >> "$script"
+			echo "set memory_budget to $budget;" >> "$script"
+			;;
+	esac
+	grep -vi '^ *set ' "$qfile" >> "$script" || true
+}
+
+for q in $queries
+do
+	for mode in $modes
+	do
+		if [ "$mode" = dbt ]
+		then
+			qfile=$confdir/dbt_query/$q.sql
+			time_file=$datadir/dbt_stat/time.out
+			mem_file=$datadir/dbt_stat/mem.out
+		elif [ "$mode" = batch ]
+		then
+			qfile=$confdir/iqp_query/$q.sql
+			time_file=$datadir/timeFile_batch.txt
+			mem_file=
+		else
+			qfile=$confdir/iqp_query/$q.sql
+			time_file=$datadir/iqp_stat/time.out
+			mem_file=$datadir/iqp_stat/mem.out
+		fi
+
+		if [ ! -f "$qfile" ]
+		then
+			echo "skipping $q/$mode: no $qfile"
+			continue
+		fi
+
+		script=$outdir/scripts/${q}_$mode.sql
+		make_script "$qfile" "$mode" "$script"
+
+		for rep in $(seq 1 "$repeat")
+		do
+			echo "running $q $mode ($rep/$repeat)"
+			time_lines=$(stat_lines "$time_file")
+			mem_lines=0
+			[ -n "$mem_file" ] && mem_lines=$(stat_lines "$mem_file")
+
+			$PSQL -o /dev/null -f "$script"
+
+			case $mode in
+				batch)
+					# every plain query appends here; ours is the last one
+					stat_new "$time_file" "$time_lines" | tail -n 1 |
+					awk -v q=$q -v m=$mode -v r=$rep '
+						{ printf "%s\t%s\t%d\t0\t%s\n", q, m, r, $1 }' >> "$rounds_file"
+					printf "%s\t%s\t%d\t0\t0\n" $q $mode $rep >> "$state_file"
+					;;
+				dbt)
+					# time.out: one column per round; mem.out: kB per round
+					stat_new "$time_file" "$time_lines" | tail -n 1 |
+					awk -v q=$q -v m=$mode -v r=$rep '
+						{ for (i = 1; i <= NF; i++)
+							printf "%s\t%s\t%d\t%d\t%s\n", q, m, r, i - 1, $i }' >> "$rounds_file"
+					stat_new "$mem_file" "$mem_lines" | tail -n 1 |
+					awk -v q=$q -v m=$mode -v r=$rep '
+						{ peak = 0
+						  for (i = 1; i <= NF; i++) if ($i > peak) peak = $i
+						  printf "%s\t%s\t%d\t%d\t0\n", q, m, r, peak }' >> "$state_file"
+					;;
+				*)
+					# time.out: one column per round, then the decision time;
+					# mem.out: (active, kept) MB per round, then total and budget
+					decision=$(stat_new "$time_file" "$time_lines" | tail -n 1 |
+					awk -v q=$q -v m=$mode -v r=$rep -v out="$rounds_file" '
+						{ for (i = 1; i < NF; i++)
+							printf "%s\t%s\t%d\t%d\t%s\n", q, m, r, i - 1, $i >> out
+						  print $NF }')
+					stat_new "$mem_file" "$mem_lines" | tail -n 1 |
+					awk -v q=$q -v m=$mode -v r=$rep -v d="${decision:-0}" '
+						{ peak = 0
+						  for (i = 2; i <= NF - 2; i += 2) if ($i > peak) peak = $i
+						  printf "%s\t%s\t%d\t%d\t%s\n", q, m, r, peak * 1024, d }' >> "$state_file"
+					;;
+			esac
+		done
+	done
+done
+
+# Summarize: percentiles over the delta rounds (every run for batch), the
+# mean final round, the largest kept state and the mean decision time
+{
+	printf "query\tmode\tn\tp50_ms\tp99_ms\tfinal_ms\tpeak_state_kb\tdecision_ms\n"
+	awk -F'\t' '
+		NR == FNR {
+			if (FNR == 1) next
+			key = $1 "\t" $2
+			if ($4 > last[key, $3]) last[key, $3] = $4
+			next
+		}
+		FNR == 1 { next }
+		{
+			key = $1 "\t" $2
+			if ($2 == "batch" || $4 > 0)
+				printf "%s\t%s\n", key, $5
+			if ($4 == last[key, $3])
+				printf "F\t%s\t%s\n", key, $5
+		}' "$rounds_file" "$rounds_file" |
+	sort -t'	' -k1,1 -k2,2 -k3,3g |
+	awk -F'\t' -v state="$state_file" '
+		function flush() {
+			if (cur == "") return
+			p50 = v[int(n * 0.50 + 0.999999)]
+			p99 = v[int(n * 0.99 + 0.999999)]
+			out[cur] = sprintf("%d\t%.2f\t%.2f", n, p50, p99)
+		}
+		$1 == "F" { fsum[$2 "\t" $3] += $4; fcnt[$2 "\t" $3]++; next }
+		{
+			key = $1 "\t" $2
+			if (key != cur) { flush(); cur = key; n = 0 }
+			v[++n] = $3
+		}
+		END {
+			flush()
+			while ((getline line < state) > 0) {
+				split(line, f, "\t")
+				if (f[1] == "query") continue
+				key = f[1] "\t" f[2]
+				if (f[4] > peak[key]) peak[key] = f[4]
+				dsum[key] += f[5]; dcnt[key]++
+			}
+			for (key in out)
+				printf "%s\t%s\t%.2f\t%d\t%.2f\n", key, out[key],
+					fcnt[key] ? fsum[key] / fcnt[key] : 0, peak[key],
+					dcnt[key] ? dsum[key] / dcnt[key] : 0
+		}' | sort -t'	' -k1,1V -k2,2
+} > "$summary_file"
+
+column -t -s'	' "$summary_file" 2>/dev/null || cat "$summary_file"
+
+# Flag regressions against an earlier summary
+if [ -n "$baseline" ]
+then
+	awk -F'\t' -v tol="$tolerance" '
+		NR == FNR { if (FNR > 1) base[$1 "\t" $2] = $0; next }
+		FNR == 1 { next }
+		($1 "\t" $2) in base {
+			split(base[$1 "\t" $2], b, "\t")
+			lim = 1 + tol / 100
+			split("p50_ms p99_ms final_ms peak_state_kb", name, " ")
+			for (i = 4; i <= 7; i++)
+				if (b[i] > 0 && $i > b[i] * lim) {
+					printf "REGRESSION %s %s %s: %s -> %s\n", $1, $2, name[i - 3], b[i], $i
+					bad = 1
+				}
+		}
+		END { exit bad }' "$baseline" "$summary_file"
+fi
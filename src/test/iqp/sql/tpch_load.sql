@@ -0,0 +1,273 @@
+--
+-- Load a synthetic TPC-H subset for the IQP/DBT benchmark.
+--
+-- Variables (psql -v):
+--   scale           TPC-H scale factor; must match tpch_scale_factor
+--   delta_fraction  upper fraction of each key range kept out of the base
+--                   tables and staged in <table>_delta for in-process deltas
+--
+-- The data only follows the TPC-H schema and value domains closely enough
+-- for the queries under tpch_conf/; it is not dbgen output.  setseed() makes
+-- every load of the same scale identical.
+--
+
+\set ON_ERROR_STOP on
+SET client_min_messages TO warning;
+
+SELECT setseed(0.42);
+
+SELECT floor(6000000 * :scale * (1 - :delta_fraction))::bigint AS cut_orderkey,
+       floor(200000  * :scale * (1 - :delta_fraction))::bigint AS cut_partkey,
+       floor(150000  * :scale * (1 - :delta_fraction))::bigint AS cut_custkey,
+       floor(10000   * :scale * (1 - :delta_fraction))::bigint AS cut_suppkey,
+       greatest(floor(10000 * :scale), 1)::bigint AS num_supplier,
+       greatest(floor(150000 * :scale), 1)::bigint AS num_customer,
+       greatest(floor(200000 * :scale), 1)::bigint AS num_part,
+       greatest(floor(1500000 * :scale), 1)::bigint AS num_orders
+\gset
+
+DROP TABLE IF EXISTS region, nation CASCADE;
+DROP TABLE IF EXISTS supplier, supplier_full, supplier_delta CASCADE;
+DROP TABLE IF EXISTS customer, customer_full, customer_delta CASCADE;
+DROP TABLE IF EXISTS part, part_full, part_delta CASCADE;
+DROP TABLE IF EXISTS partsupp, partsupp_full, partsupp_delta CASCADE;
+DROP TABLE IF EXISTS orders, orders_full, orders_delta CASCADE;
+DROP TABLE IF EXISTS lineitem, lineitem_full, lineitem_delta CASCADE;
+
+CREATE TABLE region (
+    R_REGIONKEY     INTEGER,
+    R_NAME          CHAR(25),
+    R_COMMENT       VARCHAR(152)
+);
+
+INSERT INTO region
+SELECT i - 1, name, 'region ' || name
+FROM unnest(ARRAY['AFRICA', 'AMERICA', 'ASIA', 'EUROPE', 'MIDDLE EAST'])
+     WITH ORDINALITY AS r(name, i);
+
+CREATE TABLE nation (
+    N_NATIONKEY     INTEGER,
+    N_NAME          CHAR(25),
+    N_REGIONKEY     INTEGER,
+    N_COMMENT       VARCHAR(152)
+);
+
+INSERT INTO nation
+SELECT i - 1, name, region, 'nation ' || name
+FROM unnest(ARRAY['ALGERIA', 'ARGENTINA', 'BRAZIL', 'CANADA', 'EGYPT',
+                  'ETHIOPIA', 'FRANCE', 'GERMANY', 'INDIA', 'INDONESIA',
+                  'IRAN', 'IRAQ', 'JAPAN', 'JORDAN', 'KENYA', 'MOROCCO',
+                  'MOZAMBIQUE', 'PERU', 'CHINA', 'ROMANIA', 'SAUDI ARABIA',
+                  'VIETNAM', 'RUSSIA', 'UNITED KINGDOM', 'UNITED STATES'],
+            ARRAY[0, 1, 1, 1, 4, 0, 3, 3, 2, 2, 4, 4, 2, 4, 0, 0, 0, 1, 2, 3,
+                  4, 2, 3, 3, 1])
+     WITH ORDINALITY AS n(name, region, i);
+
+CREATE TABLE supplier_full (
+    S_SUPPKEY       BIGINT,
+    S_NAME          CHAR(25),
+    S_ADDRESS       VARCHAR(40),
+    S_NATIONKEY     INTEGER,
+    S_PHONE         CHAR(15),
+    S_ACCTBAL       DECIMAL,
+    S_COMMENT       VARCHAR(101)
+);
+
+INSERT INTO supplier_full
+SELECT i,
+       'Supplier#' || lpad(i::text, 9, '0'),
+       md5(i::text),
+       n,
+       (n + 10) || '-' || (100 + i % 900) || '-' || (1000 + i % 9000),
+       round((random() * 10999 - 999)::numeric, 2),
+       'supplier comment'
+FROM generate_series(1, :num_supplier) AS i,
+     LATERAL (SELECT (random() * 24)::int AS n OFFSET 0) AS x;
+
+CREATE TABLE customer_full (
+    C_CUSTKEY       BIGINT,
+    C_NAME          VARCHAR(25),
+    C_ADDRESS       VARCHAR(40),
+    C_NATIONKEY     INTEGER,
+    C_PHONE         CHAR(15),
+    C_ACCTBAL       DECIMAL,
+    C_MKTSEGMENT    CHAR(10),
+    C_COMMENT       VARCHAR(117)
+);
+
+INSERT INTO customer_full
+SELECT i,
+       'Customer#' || lpad(i::text, 9, '0'),
+       md5(i::text),
+       n,
+       (n + 10) || '-' || (100 + i % 900) || '-' || (1000 + i % 9000),
+       round((random() * 10999 - 999)::numeric, 2),
+       (ARRAY['AUTOMOBILE', 'BUILDING', 'FURNITURE', 'MACHINERY',
+              'HOUSEHOLD'])[1 + (random() * 4)::int],
+       'customer comment'
+FROM generate_series(1, :num_customer) AS i,
+     LATERAL (SELECT (random() * 24)::int AS n OFFSET 0) AS x;
+
+CREATE TABLE part_full (
+    P_PARTKEY       BIGINT,
+    P_NAME          VARCHAR(55),
+    P_MFGR          CHAR(25),
+    P_BRAND         CHAR(10),
+    P_TYPE          VARCHAR(25),
+    P_SIZE          INTEGER,
+    P_CONTAINER     CHAR(10),
+    P_RETAILPRICE   DECIMAL,
+    P_COMMENT       VARCHAR(23)
+);
+
+INSERT INTO part_full
+SELECT i,
+       c1 || ' ' || c2,
+       'Manufacturer#' || m,
+       'Brand#' || m || (1 + (random() * 4)::int),
+       (ARRAY['STANDARD', 'SMALL', 'MEDIUM', 'LARGE', 'ECONOMY',
+              'PROMO'])[1 + (random() * 5)::int] || ' ' ||
+       (ARRAY['ANODIZED', 'BURNISHED', 'PLATED', 'POLISHED',
+              'BRUSHED'])[1 + (random() * 4)::int] || ' ' ||
+       (ARRAY['TIN', 'NICKEL', 'BRASS', 'STEEL',
+              'COPPER'])[1 + (random() * 4)::int],
+       1 + (random() * 49)::int,
+       (ARRAY['SM', 'LG', 'MED', 'JUMBO', 'WRAP'])[1 + (random() * 4)::int] ||
+       ' ' ||
+       (ARRAY['CASE', 'BOX', 'BAG', 'JAR', 'PKG', 'PACK', 'CAN',
+              'DRUM'])[1 + (random() * 7)::int],
+       (90000 + ((i / 10) % 20001) + 100 * (i % 1000)) / 100.0,
+       'part comment'
+FROM generate_series(1, :num_part) AS i,
+     LATERAL (SELECT 1 + (random() * 4)::int AS m,
+                     (ARRAY['almond', 'azure', 'blush', 'chocolate', 'forest',
+                            'green', 'ivory', 'khaki', 'navy', 'olive',
+                            'orchid', 'peru', 'rose', 'salmon', 'tan',
+                            'wheat'])[1 + (random() * 15)::int] AS c1,
+                     (ARRAY['antique', 'burlywood', 'cornsilk', 'dim',
+                            'green', 'lace', 'linen', 'metallic', 'plum',
+                            'powder', 'sandy', 'smoke', 'thistle',
+                            'violet'])[1 + (random() * 13)::int] AS c2
+              OFFSET 0) AS x;
+
+CREATE TABLE partsupp_full (
+    PS_PARTKEY      BIGINT,
+    PS_SUPPKEY      BIGINT,
+    PS_AVAILQTY     INTEGER,
+    PS_SUPPLYCOST   DECIMAL,
+    PS_COMMENT      VARCHAR(199)
+);
+
+INSERT INTO partsupp_full
+SELECT p,
+       (p + j * (:num_supplier / 4 + (p - 1) / :num_supplier)) % :num_supplier + 1,
+       1 + (random() * 9998)::int,
+       round((1 + random() * 999)::numeric, 2),
+       'partsupp comment'
+FROM generate_series(1, :num_part) AS p,
+     generate_series(0, 3) AS j;
+
+CREATE TABLE orders_full (
+    O_ORDERKEY      BIGINT,
+    O_CUSTKEY       BIGINT,
+    O_ORDERSTATUS   CHAR(1),
+    O_TOTALPRICE    DECIMAL,
+    O_ORDERDATE     DATE,
+    O_ORDERPRIORITY CHAR(15),
+    O_CLERK         CHAR(15),
+    O_SHIPPRIORITY  INTEGER,
+    O_COMMENT       VARCHAR(79)
+);
+
+-- Only the first 8 of every 32 order keys are used, as in dbgen
+INSERT INTO orders_full
+SELECT ((i - 1) / 8) * 32 + (i - 1) % 8 + 1,
+       1 + (random() * (:num_customer - 1))::bigint,
+       'O',
+       round((1000 + random() * 400000)::numeric, 2),
+       date '1992-01-01' + (random() * 2405)::int,
+       (ARRAY['1-URGENT', '2-HIGH', '3-MEDIUM', '4-NOT SPECIFIED',
+              '5-LOW'])[1 + (random() * 4)::int],
+       'Clerk#' || lpad((1 + (random() * 999)::int)::text, 9, '0'),
+       0,
+       'order comment'
+FROM generate_series(1, :num_orders) AS i;
+
+CREATE TABLE lineitem_full (
+    L_ORDERKEY      BIGINT,
+    L_PARTKEY       BIGINT,
+    L_SUPPKEY       BIGINT,
+    L_LINENUMBER    INTEGER,
+    L_QUANTITY      DECIMAL,
+    L_EXTENDEDPRICE DECIMAL,
+    L_DISCOUNT      DECIMAL,
+    L_TAX           DECIMAL,
+    L_RETURNFLAG    CHAR(1),
+    L_LINESTATUS    CHAR(1),
+    L_SHIPDATE      DATE,
+    L_COMMITDATE    DATE,
+    L_RECEIPTDATE   DATE,
+    L_SHIPINSTRUCT  CHAR(25),
+    L_SHIPMODE      CHAR(10),
+    L_COMMENT       VARCHAR(44)
+);
+
+INSERT INTO lineitem_full
+SELECT o_orderkey,
+       partkey,
+       (partkey + (random() * 3)::int * (:num_supplier / 4 + (partkey - 1) / :num_supplier)) % :num_supplier + 1,
+       linenumber,
+       quantity,
+       quantity * (90000 + ((partkey / 10) % 20001) + 100 * (partkey % 1000)) / 100.0,
+       round((random() * 0.10)::numeric, 2),
+       round((random() * 0.08)::numeric, 2),
+       CASE WHEN receiptdate <= date '1995-06-17'
+            THEN (ARRAY['R', 'A'])[1 + (random())::int] ELSE 'N' END,
+       CASE WHEN shipdate > date '1995-06-17' THEN 'O' ELSE 'F' END,
+       shipdate,
+       o_orderdate + 30 + (random() * 60)::int,
+       receiptdate,
+       (ARRAY['DELIVER IN PERSON', 'COLLECT COD', 'NONE',
+              'TAKE BACK RETURN'])[1 + (random() * 3)::int],
+       (ARRAY['REG AIR', 'AIR', 'RAIL', 'SHIP', 'TRUCK', 'MAIL',
+              'FOB'])[1 + (random() * 6)::int],
+       'lineitem comment'
+FROM orders_full,
+     LATERAL generate_series(1, 1 + (o_orderkey % 7)::int) AS linenumber,
+     LATERAL (SELECT 1 + (random() * (:num_part - 1))::bigint AS partkey,
+                     (1 + (random() * 49)::int)::numeric AS quantity,
+                     o_orderdate + 1 + (random() * 120)::int AS shipdate
+              OFFSET 0) AS x,
+     LATERAL (SELECT shipdate + 1 + (random() * 29)::int AS receiptdate
+              OFFSET 0) AS y;
+
+-- Split every updated table into its base part and its delta staging table
+CREATE TABLE supplier (LIKE supplier_full);
+CREATE TABLE supplier_delta (LIKE supplier_full);
+INSERT INTO supplier SELECT * FROM supplier_full WHERE s_suppkey <= :cut_suppkey;
+INSERT INTO supplier_delta SELECT * FROM supplier_full WHERE s_suppkey > :cut_suppkey;
+
+CREATE TABLE customer (LIKE customer_full);
+CREATE TABLE customer_delta (LIKE customer_full);
+INSERT INTO customer SELECT * FROM customer_full WHERE c_custkey <= :cut_custkey;
+INSERT INTO customer_delta SELECT * FROM customer_full WHERE c_custkey > :cut_custkey;
+
+CREATE TABLE part (LIKE part_full);
+CREATE TABLE part_delta (LIKE part_full);
+INSERT INTO part SELECT * FROM part_full WHERE p_partkey <= :cut_partkey;
+INSERT INTO part_delta SELECT * FROM part_full WHERE p_partkey > :cut_partkey;
+
+CREATE TABLE partsupp (LIKE partsupp_full);
+CREATE TABLE partsupp_delta (LIKE partsupp_full);
+INSERT INTO partsupp SELECT * FROM partsupp_full WHERE ps_partkey <= :cut_partkey;
+INSERT INTO partsupp_delta SELECT * FROM partsupp_full WHERE ps_partkey > :cut_partkey;
+
+CREATE TABLE orders (LIKE orders_full);
+CREATE TABLE orders_delta (LIKE orders_full);
+INSERT INTO orders SELECT * FROM orders_full WHERE o_orderkey <= :cut_orderkey;
+INSERT INTO orders_delta SELECT * FROM orders_full WHERE o_orderkey > :cut_orderkey;
+
+CREATE TABLE lineitem (LIKE lineitem_full);
+CREATE TABLE lineitem_delta (LIKE lineitem_full);
+INSERT INTO lineitem SELECT * FROM lineitem_full WHERE l_orderkey <= :cut_orderkey;
+INSERT INTO lineitem_delta SELECT * FROM lineitem_full WHERE l_orderkey > :cut_orderkey;
@@ -837,3 +837,128 @@ create aggregate my_half_sum(int4)
 select my_sum(one),my_half_sum(one) from (values(1),(2),(3),(4)) t(one);
 
 rollback;
+
+--
+-- Hash Aggregation Spill tests
+--
+
+set enable_sort = false;
+set work_mem = '64kB';
+
+-- far more groups than fit in work_mem, so the hash table must spill
+explain (costs off)
+select g % 10000 as c1, sum(g::numeric) as c2, count(*) as c3
+  from generate_series(0, 19999) g
+  group by g % 10000;
+
+create function hashagg_spilled(query text) returns bool language plpgsql as
+$$
+declare
+    ln text;
+begin
+    for ln in execute
+        'explain (analyze, costs off, timing off, summary off) ' || query
+    loop
+        if ln ~ '^\s*Batches: \d+' then
+            return true;
+        end if;
+    end loop;
+    return false;
+end;
+$$;
+
+select hashagg_spilled('select g % 10000, count(*)
+                          from generate_series(0, 19999) g
+                          group by g % 10000');
+
+create table agg_hash_1 as
+select g % 10000 as c1, sum(g::numeric) as c2, count(*) as c3
+  from generate_series(0, 19999) g
+  group by g % 10000;
+
+select count(*), sum(c3), min(c2), max(c2) from agg_hash_1;
+
+-- compare with the same aggregation done by sorting
+reset enable_sort;
+set enable_hashagg = false;
+
+create table agg_sort_1 as
+select g % 10000 as c1, sum(g::numeric) as c2, count(*) as c3
+  from generate_series(0, 19999) g
+  group by g % 10000;
+
+reset enable_hashagg;
+reset work_mem;
+
+(select * from agg_hash_1 except select * from agg_sort_1)
+  union all
+(select * from agg_sort_1 except select * from agg_hash_1);
+
+drop table agg_hash_1;
+drop table agg_sort_1;
+drop function hashagg_spilled(text);
+
+--
+-- Batch execution of plain aggregates over a sequential scan
+--
+
+create temp table batch_tab as
+select case when g % 7 = 0 then null else g end as a,
+       g::int8 * 10 as b,
+       g % 10 as c
+  from generate_series(1, 3000) g;
+
+-- a batch size that doesn't divide the row count
+set executor_batch_size = 64;
+
+select count(*), count(a), sum(a), sum(b), max(c) from batch_tab;
+select count(*), sum(b) from batch_tab where a is null;
+select count(*), min(a), max(a) from batch_tab
+  where a is not null and c < 3 and b >= 1000;
+select sum(a + c), sum(b - a) from batch_tab where c <> 0;
+
+-- OR is not supported in batch quals, so this runs row at a time
+select count(*) from batch_tab where a > 2990 or c = 1;
+
+reset executor_batch_size;
+drop table batch_tab;
+
+--
+-- Type-specialized batch kernels for comparisons and arithmetic
+--
+
+create temp table batch_kern as
+select g::int2 as i2, g as i4, g::int8 * 100000 as i8,
+       (g / 8.0)::float4 as f4, (g / 4.0)::float8 as f8,
+       date '2000-01-01' + g as d,
+       timestamp '2000-01-01' + g * interval '1 hour' as ts,
+       timestamptz '2000-01-01 00:00+00' + g * interval '1 hour' as tstz
+  from generate_series(1, 1000) g;
+insert into batch_kern values (null, null, null, null, null, null, null, null);
+insert into batch_kern values (0, 0, 0, 'NaN', 'NaN', null, null, null);
+
+set executor_batch_size = 64;
+
+select count(*) from batch_kern where i2 >= 100::int2 and i2 < 200::int2;
+select count(*) from batch_kern where i4 <> 500 and i4 <= 600;
+select count(*) from batch_kern where i8 > 50000000::int8;
+select count(*) from batch_kern where f4 = 'NaN'::float4;
+select count(*) from batch_kern where f4 > 100::float4;
+select count(*) from batch_kern where f8 < 'NaN'::float8;
+select count(*) from batch_kern where f8 >= 250::float8;
+select count(*) from batch_kern
+  where d between date '2000-02-01' and date '2000-02-29';
+select count(*) from batch_kern where ts < timestamp '2000-01-02';
+select count(*) from batch_kern where tstz >= timestamptz '2000-01-03 00:00+00';
+
+select sum(i4 + 1), sum(i4 * 3), sum(i8 + i8), sum(i8 - 100000::int8),
+       sum(f4 + f4), sum(f8 * 2::float8)
+  from batch_kern where i4 > 0;
+
+-- overflow must raise the same error as row-at-a-time execution
+select sum(i4 * 3000000) from batch_kern;
+select sum(i8 + 9223372036854775000) from batch_kern;
+select sum(f8 * 1e308::float8) from batch_kern;
+
+reset executor_batch_size;
+drop table batch_kern;
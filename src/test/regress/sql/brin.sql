@@ -373,6 +373,264 @@ $x$;
 RESET enable_seqscan;
 RESET enable_bitmapscan;
 
+-- The same data, indexed with the bloom and minmax multi operator classes.
+-- Bloom supports only equality.
+CREATE TABLE brintest_bloom WITH (fillfactor=10) AS
+	SELECT byteacol, int8col, int2col, int4col, textcol, oidcol, float4col,
+		float8col, datecol, timestampcol, timestamptzcol, numericcol, uuidcol
+	FROM brintest;
+CREATE INDEX brinidx_bloom ON brintest_bloom USING brin (
+	byteacol bytea_bloom_ops,
+	int8col int8_bloom_ops,
+	int2col int2_bloom_ops,
+	int4col int4_bloom_ops,
+	textcol text_bloom_ops,
+	oidcol oid_bloom_ops,
+	float4col float4_bloom_ops,
+	float8col float8_bloom_ops,
+	datecol date_bloom_ops,
+	timestampcol timestamp_bloom_ops,
+	timestamptzcol timestamptz_bloom_ops,
+	numericcol numeric_bloom_ops,
+	uuidcol uuid_bloom_ops
+) with (pages_per_range = 1);
+
+CREATE TABLE brintest_multi WITH (fillfactor=10) AS
+	SELECT int8col, int2col, int4col, float4col, float8col, datecol,
+		timestampcol, timestamptzcol
+	FROM brintest;
+CREATE INDEX brinidx_multi ON brintest_multi USING brin (
+	int8col int8_minmax_multi_ops,
+	int2col int2_minmax_multi_ops,
+	int4col int4_minmax_multi_ops,
+	float4col float4_minmax_multi_ops,
+	float8col float8_minmax_multi_ops,
+	datecol date_minmax_multi_ops,
+	timestampcol timestamp_minmax_multi_ops,
+	timestamptzcol timestamptz_minmax_multi_ops
+) with (pages_per_range = 1);
+
+-- These opclasses only have operators for their own type, so check the
+-- brinopers entries that compare a column with a value of its own type.
+DO $x$
+DECLARE
+	r record;
+	cond text;
+	idx_ctids tid[];
+	ss_ctids tid[];
+	count int;
+	plan_ok bool;
+	plan_line text;
+BEGIN
+	FOR r IN SELECT tab, colname, oper, typ, value[ordinality], matches[ordinality]
+		FROM (VALUES ('brintest_bloom'), ('brintest_multi')) AS t(tab),
+			brinopers, unnest(op) WITH ORDINALITY AS oper
+		WHERE EXISTS (SELECT 1 FROM pg_attribute
+					  WHERE attrelid = tab::regclass AND attname = colname AND
+							atttypid = typ::regtype)
+		  AND (tab = 'brintest_multi' OR oper = '=') LOOP
+
+		cond := format('%I %s %L::%s', r.colname, r.oper, r.value, r.typ);
+
+		-- run the query using the brin index
+		SET enable_seqscan = 0;
+		SET enable_bitmapscan = 1;
+
+		plan_ok := false;
+		FOR plan_line IN EXECUTE format($y$EXPLAIN SELECT array_agg(ctid) FROM %I WHERE %s $y$, r.tab, cond) LOOP
+			IF plan_line LIKE '%Bitmap Heap Scan on ' || r.tab || '%' THEN
+				plan_ok := true;
+			END IF;
+		END LOOP;
+		IF NOT plan_ok THEN
+			RAISE WARNING 'did not get bitmap indexscan plan for %', r;
+		END IF;
+
+		EXECUTE format($y$SELECT array_agg(ctid) FROM %I WHERE %s $y$, r.tab, cond)
+			INTO idx_ctids;
+
+		-- run the query using a seqscan
+		SET enable_seqscan = 1;
+		SET enable_bitmapscan = 0;
+
+		EXECUTE format($y$SELECT array_agg(ctid) FROM %I WHERE %s $y$, r.tab, cond)
+			INTO ss_ctids;
+
+		-- make sure both return the same results
+		count := array_length(idx_ctids, 1);
+
+		IF NOT (count = array_length(ss_ctids, 1) AND
+				idx_ctids @> ss_ctids AND
+				idx_ctids <@ ss_ctids) THEN
+			RAISE WARNING 'something not right in %: count %', r, count;
+		END IF;
+
+		-- make sure we found expected number of matches
+		IF count != r.matches THEN RAISE WARNING 'unexpected number of results % for %', count, r; END IF;
+	END LOOP;
+END;
+$x$;
+
+RESET enable_seqscan;
+RESET enable_bitmapscan;
+
+-- Values that follow the table order, but with outliers scattered all over,
+-- so that every range's single min/max interval would cover nearly all of
+-- them: minmax multi has to merge intervals, and the bloom filters fill up.
+-- Both must still exclude most of the ranges.
+CREATE TABLE brin_uncorr (i int, f float8, t timestamptz, txt text)
+	WITH (autovacuum_enabled = off);
+INSERT INTO brin_uncorr
+	SELECT v, v / 7.0, timestamptz '2000-01-01 00:00+00' + v * interval '1 hour',
+		md5((v / 4)::text)
+	FROM (SELECT CASE WHEN x % 37 = 0 THEN (x * 7919) % 10007 ELSE x END AS v
+		  FROM generate_series(1, 5000) x) s;
+CREATE INDEX brin_uncorr_multi_idx ON brin_uncorr USING brin (
+	i int4_minmax_multi_ops,
+	f float8_minmax_multi_ops,
+	t timestamptz_minmax_multi_ops
+) WITH (pages_per_range = 4);
+CREATE INDEX brin_uncorr_bloom_idx ON brin_uncorr USING brin (
+	txt text_bloom_ops
+) WITH (pages_per_range = 4);
+
+CREATE TABLE brin_uncorr_conds (cond text);
+INSERT INTO brin_uncorr_conds VALUES
+	('i = 17'), ('i = 5000'), ('i = 2800'), ('i = -1'), ('i < 20'),
+	('i > 9000'), ('i between 4000 and 4010'), ('f = 1'), ('f <= 2'),
+	('f > 1420'), ('t = timestamptz ''2000-01-01 17:00+00'''),
+	('t < timestamptz ''2000-01-02 00:00+00'''), ('txt = md5(''1250'')'),
+	('txt = md5(''-1'')');
+
+CREATE FUNCTION brin_uncorr_check() RETURNS SETOF text LANGUAGE plpgsql AS
+$x$
+DECLARE
+	c text;
+	idx_ctids tid[];
+	ss_ctids tid[];
+	plan_line text;
+	plan_ok bool;
+BEGIN
+	FOR c IN SELECT cond FROM brin_uncorr_conds LOOP
+		SET LOCAL enable_seqscan = 0;
+		SET LOCAL enable_bitmapscan = 1;
+		plan_ok := false;
+		FOR plan_line IN EXECUTE 'EXPLAIN SELECT ctid FROM brin_uncorr WHERE ' || c LOOP
+			IF plan_line LIKE '%Bitmap Index Scan on brin_uncorr_%' THEN
+				plan_ok := true;
+			END IF;
+		END LOOP;
+		IF NOT plan_ok THEN
+			RAISE WARNING 'did not get bitmap indexscan plan for %', c;
+		END IF;
+		EXECUTE 'SELECT array_agg(ctid) FROM brin_uncorr WHERE ' || c
+			INTO idx_ctids;
+
+		SET LOCAL enable_seqscan = 1;
+		SET LOCAL enable_bitmapscan = 0;
+		EXECUTE 'SELECT array_agg(ctid) FROM brin_uncorr WHERE ' || c
+			INTO ss_ctids;
+
+		RETURN NEXT format('%s: %s', c,
+						   CASE WHEN coalesce(idx_ctids @> ss_ctids AND
+											  idx_ctids <@ ss_ctids,
+											  idx_ctids IS NULL AND
+											  ss_ctids IS NULL)
+						   THEN coalesce(cardinality(ss_ctids), 0)::text
+						   ELSE 'mismatch' END);
+	END LOOP;
+END;
+$x$;
+
+SELECT * FROM brin_uncorr_check();
+
+SET enable_seqscan = 0;
+EXPLAIN (ANALYZE, COSTS OFF, TIMING OFF, SUMMARY OFF)
+SELECT * FROM brin_uncorr WHERE i = 2800;
+EXPLAIN (ANALYZE, COSTS OFF, TIMING OFF, SUMMARY OFF)
+SELECT * FROM brin_uncorr WHERE txt = md5('1250');
+RESET enable_seqscan;
+
+-- New pages are only summarized by brin_summarize_new_values (or vacuum);
+-- until then they are returned by every scan
+INSERT INTO brin_uncorr
+	SELECT v, v / 7.0, timestamptz '2000-01-01 00:00+00' + v * interval '1 hour',
+		md5((v / 4)::text)
+	FROM (SELECT CASE WHEN x % 37 = 0 THEN (x * 7919) % 10007 ELSE x END AS v
+		  FROM generate_series(5001, 10000) x) s;
+SELECT * FROM brin_uncorr_check();
+SELECT brin_summarize_new_values('brin_uncorr_multi_idx');
+SELECT brin_summarize_new_values('brin_uncorr_bloom_idx');
+SELECT * FROM brin_uncorr_check();
+
+-- Summarizing a range merges in what concurrent insertions into the range
+-- added to its placeholder tuple, using the opclass' union procedure.  Get
+-- such an insertion by having the indexed expression insert a row into the
+-- range being summarized.
+CREATE TABLE brin_union (a int) WITH (fillfactor = 10, autovacuum_enabled = off);
+CREATE FUNCTION brin_union_hook(a int) RETURNS int LANGUAGE plpgsql IMMUTABLE AS
+$x$
+BEGIN
+	IF a = 5 AND current_setting('brin_union.hook', true) = 'on' THEN
+		PERFORM set_config('brin_union.hook', 'off', true);
+		INSERT INTO brin_union VALUES (1001);
+	END IF;
+	RETURN a;
+END;
+$x$;
+CREATE INDEX brin_union_bloom_idx ON brin_union
+	USING brin (brin_union_hook(a) int4_bloom_ops) WITH (pages_per_range = 4);
+CREATE INDEX brin_union_multi_idx ON brin_union
+	USING brin (brin_union_hook(a) int4_minmax_multi_ops) WITH (pages_per_range = 4);
+-- it isn't really immutable
+ALTER FUNCTION brin_union_hook(int) VOLATILE;
+INSERT INTO brin_union SELECT i FROM generate_series(1, 1000) i;
+-- make room in the first range, and have it summarized again
+DELETE FROM brin_union WHERE a BETWEEN 10 AND 20;
+VACUUM brin_union;
+SELECT brin_desummarize_range('brin_union_bloom_idx', 0);
+SELECT brin_desummarize_range('brin_union_multi_idx', 0);
+BEGIN;
+SET LOCAL brin_union.hook = on;
+SELECT brin_summarize_new_values('brin_union_bloom_idx');
+SET LOCAL brin_union.hook = on;
+SELECT brin_summarize_new_values('brin_union_multi_idx');
+COMMIT;
+-- the rows inserted by the hook must be found through both indexes
+SET enable_seqscan = 0;
+EXPLAIN (COSTS OFF)
+SELECT ctid, a FROM brin_union WHERE brin_union_hook(a) = 1001;
+SELECT ctid, a FROM brin_union WHERE brin_union_hook(a) = 1001;
+DROP INDEX brin_union_multi_idx;
+EXPLAIN (COSTS OFF)
+SELECT ctid, a FROM brin_union WHERE brin_union_hook(a) = 1001;
+SELECT ctid, a FROM brin_union WHERE brin_union_hook(a) = 1001;
+RESET enable_seqscan;
+SELECT ctid, a FROM brin_union WHERE a = 1001;
+
+-- With many bloom columns at the default pages_per_range, the filters must
+-- share the space of one index tuple.
+CREATE TABLE brin_bloom_wide (a int, b int, c int, d int, e int, f int, g int, h int);
+CREATE INDEX brin_bloom_wide_idx ON brin_bloom_wide USING brin (
+	a int4_bloom_ops, b int4_bloom_ops, c int4_bloom_ops, d int4_bloom_ops,
+	e int4_bloom_ops, f int4_bloom_ops, g int4_bloom_ops, h int4_bloom_ops
+);
+INSERT INTO brin_bloom_wide
+	SELECT i, i + 1, i + 2, i + 3, i + 4, i + 5, i + 6, i + 7
+	FROM generate_series(1, 5000) i;
+SELECT brin_desummarize_range('brin_bloom_wide_idx', 0);
+SELECT brin_summarize_new_values('brin_bloom_wide_idx');
+SET enable_seqscan = 0;
+EXPLAIN (COSTS OFF)
+SELECT count(*) FROM brin_bloom_wide WHERE h = 1007;
+SELECT count(*) FROM brin_bloom_wide WHERE h = 1007;
+SELECT count(*) FROM brin_bloom_wide WHERE a = 2500 AND e = 2504;
+RESET enable_seqscan;
+
+DROP TABLE brintest_bloom, brintest_multi, brin_uncorr, brin_uncorr_conds, brin_union;
+DROP TABLE brin_bloom_wide;
+DROP FUNCTION brin_uncorr_check(), brin_union_hook(int);
+
 INSERT INTO brintest SELECT
 	repeat(stringu1, 42)::bytea,
 	substr(stringu1, 1, 1)::"char",
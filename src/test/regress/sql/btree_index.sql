@@ -92,3 +92,222 @@ vacuum btree_tall_tbl;
 -- need to insert some rows to cause the fast root page to split.
 insert into btree_tall_tbl (id, t)
   select g, repeat('x', 100) from generate_series(1, 500) g;
+
+--
+-- Test parallel B-tree index builds
+--
+-- Each participant needs 32MB of maintenance_work_mem
+set max_parallel_maintenance_workers = 3;
+set maintenance_work_mem = '128MB';
+create table btree_par_tbl (a int, b text) with (parallel_workers = 4);
+insert into btree_par_tbl
+  select i, 'v' || (i % 1000) from generate_series(1, 100000) i;
+insert into btree_par_tbl values (null, 'null1'), (null, 'null2');
+
+-- the DEBUG lines show whether a build was parallel; keep the LOG lines
+-- about temporary files, which vary from run to run, out of them
+set log_temp_files = -1;
+set client_min_messages = debug1;
+create unique index btree_par_a_idx on btree_par_tbl (a);
+create index btree_par_b_idx on btree_par_tbl (b, a);
+-- expression and partial indexes are built serially
+create index btree_par_expr_idx on btree_par_tbl ((a + 1));
+create index btree_par_part_idx on btree_par_tbl (a) where a < 10;
+reset client_min_messages;
+reset log_temp_files;
+
+set enable_seqscan to false;
+set enable_bitmapscan to false;
+select count(*), min(a), max(a) from btree_par_tbl where a > 0;
+select count(*), min(a), max(a) from btree_par_tbl where b = 'v7';
+select a from btree_par_tbl where b = 'v7' order by b desc, a desc limit 3;
+select count(*) from btree_par_tbl where a is null;
+reset enable_seqscan;
+reset enable_bitmapscan;
+
+-- A duplicate at the far end of the heap from the original is most likely
+-- scanned by a different participant, in which case it is found only when
+-- the participants' sorted runs are merged.  A worker that finds it itself
+-- reports it with a CONTEXT line, so keep the report terse.
+drop index btree_par_a_idx;
+insert into btree_par_tbl values (1, 'dup');
+\set VERBOSITY terse
+create unique index btree_par_dup_idx on btree_par_tbl (a);
+\set VERBOSITY default
+-- Dead duplicates, here in every participant, don't count against uniqueness
+insert into btree_par_tbl select i, 'dead' from generate_series(1, 100000) i;
+delete from btree_par_tbl where b in ('dup', 'dead');
+create unique index btree_par_dup_idx on btree_par_tbl (a);
+
+-- With no workers allowed the build is serial
+set max_parallel_maintenance_workers = 0;
+set log_temp_files = -1;
+set client_min_messages = debug1;
+reindex index btree_par_dup_idx;
+reset client_min_messages;
+reset log_temp_files;
+
+reset max_parallel_maintenance_workers;
+reset maintenance_work_mem;
+drop table btree_par_tbl;
+
+--
+-- Test deduplication of B-tree leaf tuples into posting lists
+--
+create table btree_dedup_tbl (a int, b int);
+create index btree_dedup_idx on btree_dedup_tbl (a);
+-- Inserting through the index merges duplicates whenever a leaf page fills
+insert into btree_dedup_tbl select i % 10, i from generate_series(1, 100000) i;
+-- ... leaving it much smaller than an index built by sorting
+create index btree_dedup_sorted_idx on btree_dedup_tbl (a);
+select pg_relation_size('btree_dedup_idx') * 2 <
+       pg_relation_size('btree_dedup_sorted_idx') as deduplicated;
+drop index btree_dedup_sorted_idx;
+
+set enable_seqscan to false;
+set enable_bitmapscan to false;
+select a, count(*), sum(b) from btree_dedup_tbl where a between 3 and 5
+  group by a order by a;
+-- Scan posting lists backwards
+explain (costs off)
+select a, b from btree_dedup_tbl where a between 3 and 4 order by a desc;
+select a, count(*), sum(b)
+  from (select a, b from btree_dedup_tbl where a between 3 and 4
+        order by a desc) s
+  group by a order by a;
+
+-- Delete some of the heap TIDs of every posting list, and all of those of
+-- key 5.  Scanning key 5 then marks its posting lists dead.
+delete from btree_dedup_tbl where b % 3 = 0 or a = 5;
+select count(*) from btree_dedup_tbl where a = 5;
+select a, count(*), sum(b) from btree_dedup_tbl where a between 3 and 5
+  group by a order by a;
+
+-- Vacuum shrinks posting lists and removes the dead ones
+vacuum btree_dedup_tbl;
+select a, count(*), sum(b) from btree_dedup_tbl group by a order by a;
+
+-- Refill the space vacuum freed, then split pages full of posting lists
+insert into btree_dedup_tbl
+  select i % 10, i from generate_series(1, 100000) i where i % 3 = 0 or i % 10 = 5;
+insert into btree_dedup_tbl select 7, -i from generate_series(1, 50000) i;
+select a, count(*), sum(b) from btree_dedup_tbl group by a order by a;
+select a, count(*), sum(b)
+  from (select a, b from btree_dedup_tbl where a between 6 and 8
+        order by a desc) s
+  group by a order by a;
+reset enable_seqscan;
+reset enable_bitmapscan;
+
+-- The same, without the index
+set enable_indexscan to false;
+set enable_bitmapscan to false;
+select a, count(*), sum(b) from btree_dedup_tbl group by a order by a;
+reset enable_indexscan;
+reset enable_bitmapscan;
+
+drop table btree_dedup_tbl;
+
+--
+-- Test skip scans of multicolumn B-tree indexes, with conditions on the
+-- second column only
+--
+create table btree_skip_tbl (a int, b int, c text);
+insert into btree_skip_tbl
+  select i % 5, i, 'x' || i from generate_series(1, 100000) i;
+insert into btree_skip_tbl
+  select null, i, 'null' || i from generate_series(1, 1000) i;
+create index btree_skip_tbl_a_b_idx on btree_skip_tbl (a, b);
+vacuum analyze btree_skip_tbl;
+
+-- one probe per value of a, including the nulls, in both directions
+explain (costs off)
+select a, b from btree_skip_tbl where b between 100 and 104 order by a, b;
+select a, b from btree_skip_tbl where b between 100 and 104 order by a, b;
+explain (costs off)
+select a, b from btree_skip_tbl where b between 100 and 104
+  order by a desc, b desc;
+select a, b from btree_skip_tbl where b between 100 and 104
+  order by a desc, b desc;
+explain (costs off)
+select * from btree_skip_tbl where b = 500;
+select * from btree_skip_tbl where b = 500;
+
+-- the last and first values of b, which some values of a don't reach
+select a, b from btree_skip_tbl where b > 99997 order by a, b;
+select a, b from btree_skip_tbl where b < 3 order by a desc, b desc;
+-- and no matches at all
+select a, b from btree_skip_tbl where b > 100000;
+select a, b from btree_skip_tbl where b > 10 and b < 5;
+
+-- changing direction in the middle of a skip scan
+begin;
+declare c scroll cursor for
+  select a, b from btree_skip_tbl where b between 100 and 102 order by a, b;
+fetch 4 from c;
+fetch backward 3 from c;
+fetch all from c;
+fetch backward all from c;
+fetch absolute 5 from c;
+fetch relative -2 from c;
+commit;
+-- a skip scan can't change direction itself, so scroll cursors materialize
+explain (costs off)
+declare c scroll cursor for
+  select a, b from btree_skip_tbl where b > 99990 order by a, b;
+begin;
+declare c scroll cursor for
+  select a, b from btree_skip_tbl where b > 99990 order by a, b;
+fetch 1 from c;
+fetch backward all from c;
+fetch 2 from c;
+fetch backward all from c;
+commit;
+
+-- other index orderings and leading column types
+drop index btree_skip_tbl_a_b_idx;
+create index btree_skip_tbl_a_b_idx on btree_skip_tbl (a desc nulls last, b);
+explain (costs off)
+select a, b from btree_skip_tbl where b between 100 and 104
+  order by a desc nulls last, b;
+select a, b from btree_skip_tbl where b between 100 and 104
+  order by a desc nulls last, b;
+select a, b from btree_skip_tbl where b between 100 and 104
+  order by a nulls first, b desc;
+create table btree_skip_text (a text, b int);
+insert into btree_skip_text
+  select repeat(chr(ascii('a') + i % 3), 100), i from generate_series(1, 30000) i;
+create index btree_skip_text_a_b_idx on btree_skip_text (a, b);
+vacuum analyze btree_skip_text;
+explain (costs off)
+select left(a, 3), b from btree_skip_text where b >= 7 and b <= 8 order by a;
+select left(a, 3), b from btree_skip_text where b >= 7 and b <= 8 order by a;
+
+-- the results must match a scan without skipping
+explain (costs off)
+select a, count(*), sum(b) from btree_skip_tbl where b between 20000 and 21000
+  group by a order by a;
+select a, count(*), sum(b) from btree_skip_tbl where b between 20000 and 21000
+  group by a order by a;
+select count(*), sum(b) from btree_skip_tbl where b < 500 and b % 7 = 0;
+set enable_indexskipscan to false;
+explain (costs off)
+select a, count(*), sum(b) from btree_skip_tbl where b between 20000 and 21000
+  group by a order by a;
+select a, count(*), sum(b) from btree_skip_tbl where b between 20000 and 21000
+  group by a order by a;
+select count(*), sum(b) from btree_skip_tbl where b < 500 and b % 7 = 0;
+reset enable_indexskipscan;
+
+-- an empty index
+truncate btree_skip_text;
+set enable_seqscan to false;
+set enable_bitmapscan to false;
+explain (costs off)
+select * from btree_skip_text where b = 1;
+select * from btree_skip_text where b = 1;
+reset enable_seqscan;
+reset enable_bitmapscan;
+
+drop table btree_skip_tbl;
+drop table btree_skip_text;
@@ -181,6 +181,24 @@ VACUUM hash_split_heap;
 -- Clean up.
 DROP TABLE hash_split_heap;
 
+-- Grow an index well past HASH_SPLIT_AHEAD_FRACTION buckets, so that
+-- inserts go on to split buckets ahead of need.
+CREATE TABLE hash_grow_heap (keycol INT);
+CREATE INDEX hash_grow_index ON hash_grow_heap USING HASH (keycol)
+  WITH (fillfactor = 10);
+INSERT INTO hash_grow_heap SELECT a FROM generate_series(1, 50000) a;
+
+-- Every key must still be found in its bucket.
+SET enable_seqscan = OFF;
+SET enable_bitmapscan = OFF;
+SELECT count(*) FROM hash_grow_heap WHERE keycol = 4242;
+SELECT count(*) FROM generate_series(1, 50000) g
+  WHERE EXISTS (SELECT 1 FROM hash_grow_heap WHERE keycol = g);
+RESET enable_seqscan;
+RESET enable_bitmapscan;
+
+DROP TABLE hash_grow_heap;
+
 -- Index on temp table.
 CREATE TEMP TABLE hash_temp_heap (x int, y int);
 INSERT INTO hash_temp_heap VALUES (1,1);
@@ -0,0 +1,178 @@
+--
+-- INDEX_INCLUDING
+--
+-- Tests for btree indexes with INCLUDE columns, and for suffix truncation
+-- of the pivot tuples in btree internal pages.
+--
+
+-- Regular index with included columns
+CREATE TABLE tbl_include_reg (c1 int, c2 int, c3 int, c4 box);
+INSERT INTO tbl_include_reg SELECT x, 2*x, 3*x, box('4,4,4,4')
+  FROM generate_series(1,10) AS x;
+CREATE INDEX tbl_include_reg_idx ON tbl_include_reg USING btree (c1, c2) INCLUDE (c3, c4);
+-- duplicate columns are pointless but allowed
+CREATE INDEX ON tbl_include_reg (c1, c2) INCLUDE (c1, c3);
+SELECT pg_get_indexdef(i.indexrelid), i.indnatts, i.indnkeyatts
+FROM pg_index i JOIN pg_class c ON i.indexrelid = c.oid
+WHERE i.indrelid = 'tbl_include_reg'::regclass ORDER BY c.relname;
+\d tbl_include_reg
+
+-- Unique index and unique constraint
+CREATE TABLE tbl_include_unique (c1 int, c2 int, c3 int, c4 box);
+INSERT INTO tbl_include_unique SELECT x, 2*x, 3*x, box('4,4,4,4')
+  FROM generate_series(1,10) AS x;
+CREATE UNIQUE INDEX tbl_include_unique_idx ON tbl_include_unique using btree (c1, c2) INCLUDE (c3, c4);
+SELECT pg_get_indexdef(i.indexrelid), i.indnatts, i.indnkeyatts
+FROM pg_index i WHERE i.indrelid = 'tbl_include_unique'::regclass;
+-- only the key columns are checked for uniqueness
+INSERT INTO tbl_include_unique VALUES (1, 2, 99, NULL);
+INSERT INTO tbl_include_unique VALUES (1, 3, 3, box('4,4,4,4'));
+INSERT INTO tbl_include_unique VALUES (100, 200, 300, NULL), (101, 202, 300, NULL);
+-- the index can be an ON CONFLICT arbiter through its key columns
+INSERT INTO tbl_include_unique VALUES (1, 2, 0, NULL)
+  ON CONFLICT (c1, c2) DO UPDATE SET c3 = excluded.c3;
+SELECT c1, c2, c3 FROM tbl_include_unique WHERE c1 = 1 ORDER BY c2;
+-- a unique index with included columns can't back a constraint
+ALTER TABLE tbl_include_unique ADD CONSTRAINT tbl_include_unique_con
+  UNIQUE USING INDEX tbl_include_unique_idx;
+-- building the index must find duplicates of the key columns only
+CREATE TABLE tbl_include_dup (c1 int, c2 int, c3 int);
+INSERT INTO tbl_include_dup SELECT 1, 2, x FROM generate_series(1,3) AS x;
+CREATE UNIQUE INDEX tbl_include_dup_idx ON tbl_include_dup (c1, c2) INCLUDE (c3);
+CREATE UNIQUE INDEX tbl_include_dup_idx ON tbl_include_dup (c1, c3) INCLUDE (c2);
+DROP TABLE tbl_include_dup;
+
+-- Included columns are only stored
+SELECT pg_index_column_has_property('tbl_include_unique_idx'::regclass, col, prop)
+  AS has, col, prop
+FROM generate_series(2, 3) col,
+     unnest(array['orderable', 'asc', 'search_array', 'search_nulls',
+                  'returnable']) prop
+ORDER BY col, prop;
+
+-- Unsupported uses
+CREATE INDEX tbl_include_hash_idx ON tbl_include_reg USING hash (c1) INCLUDE (c2);
+CREATE INDEX tbl_include_gist_idx ON tbl_include_reg USING gist (c4) INCLUDE (c1);
+CREATE INDEX tbl_include_expr_idx ON tbl_include_reg (c1) INCLUDE ((c2 + 1));
+CREATE INDEX tbl_include_desc_idx ON tbl_include_reg (c1) INCLUDE (c2 DESC);
+CREATE INDEX tbl_include_opc_idx ON tbl_include_reg (c1) INCLUDE (c2 int4_ops);
+CREATE INDEX tbl_include_coll_idx ON tbl_include_reg (c1) INCLUDE (c2 COLLATE "C");
+
+-- Index-only scans return included columns, but can't search on them
+CREATE TABLE tbl_include_ios (c1 int, c2 int, c3 int, c4 text);
+INSERT INTO tbl_include_ios SELECT x, x % 100, x * 3, 'x' || x
+  FROM generate_series(1, 10000) AS x;
+CREATE UNIQUE INDEX tbl_include_ios_idx ON tbl_include_ios (c1) INCLUDE (c2, c3);
+VACUUM ANALYZE tbl_include_ios;
+SET enable_seqscan TO off;
+SET enable_bitmapscan TO off;
+EXPLAIN (COSTS OFF)
+SELECT c1, c2, c3 FROM tbl_include_ios WHERE c1 BETWEEN 100 AND 104;
+SELECT c1, c2, c3 FROM tbl_include_ios WHERE c1 BETWEEN 100 AND 104;
+EXPLAIN (COSTS OFF)
+SELECT c1, c3 FROM tbl_include_ios WHERE c1 < 5 ORDER BY c1 DESC;
+SELECT c1, c3 FROM tbl_include_ios WHERE c1 < 5 ORDER BY c1 DESC;
+-- a condition on an included column is a filter, not an index qual
+EXPLAIN (COSTS OFF)
+SELECT c1 FROM tbl_include_ios WHERE c1 < 1000 AND c2 = 7;
+SELECT count(*) FROM tbl_include_ios WHERE c1 < 1000 AND c2 = 7;
+-- and the index can't provide an ordering on one
+EXPLAIN (COSTS OFF)
+SELECT c1, c2 FROM tbl_include_ios WHERE c1 < 5 ORDER BY c2, c1;
+-- columns that aren't in the index need the heap
+EXPLAIN (COSTS OFF)
+SELECT c4 FROM tbl_include_ios WHERE c1 = 42;
+SELECT c4 FROM tbl_include_ios WHERE c1 = 42;
+RESET enable_seqscan;
+RESET enable_bitmapscan;
+
+-- Page splits, VACUUM, REINDEX and CLUSTER keep the index usable
+DELETE FROM tbl_include_ios WHERE c1 % 3 = 0;
+INSERT INTO tbl_include_ios SELECT x, x % 100, x * 3, 'y' || x
+  FROM generate_series(10001, 20000) AS x;
+VACUUM tbl_include_ios;
+INSERT INTO tbl_include_ios VALUES (3, 3, 9, 'x3');
+INSERT INTO tbl_include_ios VALUES (4, 0, 0, 'dup');
+REINDEX INDEX tbl_include_ios_idx;
+CLUSTER tbl_include_ios USING tbl_include_ios_idx;
+SET enable_seqscan TO off;
+SET enable_bitmapscan TO off;
+SELECT count(*), sum(c2), sum(c3) FROM tbl_include_ios WHERE c1 > 0;
+RESET enable_seqscan;
+RESET enable_bitmapscan;
+SELECT count(*), sum(c2), sum(c3) FROM tbl_include_ios;
+
+-- Dropping a column drops the indexes that include it
+ALTER TABLE tbl_include_reg DROP COLUMN c3;
+\d tbl_include_reg
+ALTER TABLE tbl_include_unique DROP COLUMN c4;
+\d tbl_include_unique
+
+DROP TABLE tbl_include_reg;
+DROP TABLE tbl_include_unique;
+DROP TABLE tbl_include_ios;
+
+--
+-- Suffix truncation
+--
+-- Leaf page splits between two values of the first column only need that
+-- column in the new high key; the second is truncated away, and compares as
+-- minus infinity.  Searches must still land on the right leaf page, in both
+-- directions, whatever they give for the second column.
+CREATE TABLE tbl_truncate (a int, b text);
+CREATE INDEX tbl_truncate_idx ON tbl_truncate (a, b);
+INSERT INTO tbl_truncate
+  SELECT x % 40, repeat(md5((x / 40)::text), 4) || lpad((x / 40)::text, 6, '0')
+  FROM generate_series(0, 39999) AS x;
+ANALYZE tbl_truncate;
+
+CREATE FUNCTION truncate_check() RETURNS TABLE (q int, n bigint)
+LANGUAGE plpgsql AS
+$$
+BEGIN
+    RETURN QUERY
+      SELECT 1, count(*) FROM tbl_truncate WHERE a = 17;
+    RETURN QUERY
+      SELECT 2, count(*) FROM tbl_truncate WHERE a = 17 AND b > '';
+    RETURN QUERY
+      SELECT 3, count(*) FROM tbl_truncate WHERE a = 17 AND b < 'z';
+    RETURN QUERY
+      SELECT 4, count(*) FROM tbl_truncate WHERE a BETWEEN 10 AND 12;
+    RETURN QUERY
+      SELECT 5, count(*) FROM tbl_truncate WHERE a > 38;
+    RETURN QUERY
+      SELECT 6, count(*) FROM tbl_truncate WHERE a < 1;
+    RETURN QUERY
+      SELECT 7, count(*) FROM tbl_truncate
+      WHERE a = 5 AND b = repeat(md5('500'), 4) || '000500';
+    RETURN QUERY
+      SELECT 8, sum(x.a)::bigint FROM
+        (SELECT a FROM tbl_truncate WHERE a >= 20 ORDER BY a DESC, b DESC
+         LIMIT 1500) x;
+    RETURN QUERY
+      SELECT 9, sum(x.a)::bigint FROM
+        (SELECT a FROM tbl_truncate WHERE a <= 20 ORDER BY a, b LIMIT 1500) x;
+END;
+$$;
+
+SET enable_seqscan TO off;
+SET enable_bitmapscan TO off;
+EXPLAIN (COSTS OFF)
+SELECT a FROM tbl_truncate WHERE a >= 20 ORDER BY a DESC, b DESC LIMIT 1500;
+SELECT * FROM truncate_check();
+-- the same again, with the index built by sorting
+DROP INDEX tbl_truncate_idx;
+CREATE INDEX tbl_truncate_idx ON tbl_truncate (a, b);
+SELECT * FROM truncate_check();
+RESET enable_seqscan;
+RESET enable_bitmapscan;
+SET enable_indexscan TO off;
+SET enable_indexonlyscan TO off;
+SET enable_bitmapscan TO off;
+SELECT * FROM truncate_check();
+RESET enable_indexscan;
+RESET enable_indexonlyscan;
+RESET enable_bitmapscan;
+
+DROP FUNCTION truncate_check();
+DROP TABLE tbl_truncate;
@@ -671,3 +671,84 @@ insert into parted_minmax values (1,'12345');
 explain (costs off) select min(a), max(a) from parted_minmax where b = '12345';
 select min(a), max(a) from parted_minmax where b = '12345';
 drop table parted_minmax;
+
+--
+-- check partition pruning using the partition bounds
+--
+create table pp_lp (a int, b text) partition by list (a);
+create table pp_lp1 partition of pp_lp for values in (1);
+create table pp_lp2 partition of pp_lp for values in (2);
+create table pp_lp3 partition of pp_lp for values in (3);
+create table pp_lp_null partition of pp_lp for values in (null);
+insert into pp_lp values (1, 'a'), (2, 'b'), (3, 'c'), (null, 'n');
+create table pp_rp (a int) partition by range (a);
+create table pp_rp1 partition of pp_rp for values from (minvalue) to (10);
+create table pp_rp2 partition of pp_rp for values from (10) to (20);
+create table pp_rp3 partition of pp_rp for values from (20) to (maxvalue);
+
+-- constraint exclusion is not needed to prune with constants
+set constraint_exclusion = off;
+explain (costs off) select * from pp_lp where a = 2;	-- scans pp_lp2
+explain (costs off) select * from pp_lp where a is null;	-- scans pp_lp_null
+explain (costs off) select * from pp_lp where a >= 2 and a < 3;	-- scans pp_lp2
+explain (costs off) select * from pp_rp where a >= 15 and a < 20;	-- scans pp_rp2
+explain (costs off) select * from pp_rp where a > 19;	-- scans pp_rp2, pp_rp3
+explain (costs off) select * from pp_rp where a is null;	-- scans nothing
+set enable_partition_pruning = off;
+explain (costs off) select * from pp_lp where a = 2;	-- scans all partitions
+reset enable_partition_pruning;
+reset constraint_exclusion;
+
+-- pruning with a value set by an initplan, at executor startup
+explain (analyze, costs off, summary off, timing off)
+select * from pp_lp where a = (select 2);
+select * from pp_lp where a = (select 2);
+
+-- pruning again on each rescan of a correlated subquery
+create table pp_keys (k int);
+insert into pp_keys values (1), (3);
+explain (analyze, costs off, summary off, timing off)
+select k, (select count(*) from pp_lp where a = pp_keys.k) from pp_keys;
+select k, (select count(*) from pp_lp where a = pp_keys.k) from pp_keys;
+drop table pp_keys;
+drop table pp_lp;
+drop table pp_rp;
+
+--
+-- check partition-wise join and aggregation
+--
+create table pwj_t1 (a int, b int) partition by range (a);
+create table pwj_t1_p1 partition of pwj_t1 for values from (0) to (3000);
+create table pwj_t1_p2 partition of pwj_t1 for values from (3000) to (6000);
+create table pwj_t2 (a int, b int) partition by range (a);
+create table pwj_t2_p1 partition of pwj_t2 for values from (0) to (3000);
+create table pwj_t2_p2 partition of pwj_t2 for values from (3000) to (6000);
+insert into pwj_t1 select i, i % 5 from generate_series(0, 5999) i;
+insert into pwj_t2 select i, i % 5 from generate_series(0, 5999, 3) i;
+analyze pwj_t1;
+analyze pwj_t2;
+set enable_partitionwise_join = on;
+set enable_partitionwise_aggregate = on;
+
+-- each partition's hash table fits in work_mem, but the whole one doesn't
+set work_mem = '64kB';
+explain (costs off)
+select count(*), sum(t2.a) from pwj_t1 t1 join pwj_t2 t2 on t1.a = t2.a;
+select count(*), sum(t2.a) from pwj_t1 t1 join pwj_t2 t2 on t1.a = t2.a;
+reset work_mem;
+
+-- grouping by the partition key aggregates each partition completely
+set enable_hashagg = off;
+explain (costs off)
+select a, count(*) from pwj_t1 group by a;
+select count(*), sum(c) from (select a, count(*) c from pwj_t1 group by a) s;
+reset enable_hashagg;
+
+-- otherwise partial aggregates of the partitions are combined
+select b, count(*), sum(a) from pwj_t1 group by b order by b;
+select t1.b, count(*) from pwj_t1 t1 join pwj_t2 t2 on t1.a = t2.a
+  group by t1.b order by t1.b;
+reset enable_partitionwise_join;
+reset enable_partitionwise_aggregate;
+drop table pwj_t1;
+drop table pwj_t2;
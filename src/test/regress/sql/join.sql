@@ -486,6 +486,7 @@ reset enable_nestloop;
 
 set work_mem to '64kB';
 set enable_mergejoin to off;
+set enable_memoize to off;
 
 explain (costs off)
 select count(*) from tenk1 a, tenk1 b
@@ -495,6 +496,7 @@ select count(*) from tenk1 a, tenk1 b
 
 reset work_mem;
 reset enable_mergejoin;
+reset enable_memoize;
 
 --
 -- regression test for 8.2 bug with improper re-ordering of left joins
@@ -1527,11 +1529,13 @@ select count(*) from tenk1 a,
   tenk1 b join lateral (values(a.unique1)) ss(x) on b.unique2 = ss.x;
 
 -- lateral with VALUES, no flattening possible
+set enable_memoize to off;
 explain (costs off)
   select count(*) from tenk1 a,
     tenk1 b join lateral (values(a.unique1),(-1)) ss(x) on b.unique2 = ss.x;
 select count(*) from tenk1 a,
   tenk1 b join lateral (values(a.unique1),(-1)) ss(x) on b.unique2 = ss.x;
+reset enable_memoize;
 
 -- lateral injecting a strange outer join condition
 explain (costs off)
@@ -1906,3 +1910,116 @@ where exists (select 1 from j3
       and t1.unique1 < 1;
 
 drop table j3;
+
+--
+-- Bloom filters pushed from a hash join down to its outer scan
+--
+create temp table bf_fact (k int, v int);
+insert into bf_fact select i % 1000, i from generate_series(1, 20000) i;
+create temp table bf_dim (k int, grp int);
+insert into bf_dim
+  select i, case when i < 10 then 1 when i < 990 then 2 else 3 end
+  from generate_series(0, 999) i;
+analyze bf_fact;
+analyze bf_dim;
+
+create function explain_bloom(query text) returns setof text
+language plpgsql as
+$$
+declare
+    ln text;
+begin
+    for ln in
+        execute format('explain (analyze, costs off, summary off, timing off) %s',
+            query)
+    loop
+        ln := regexp_replace(ln, 'Memory Usage: \d+', 'Memory Usage: N');
+        return next ln;
+    end loop;
+end;
+$$;
+
+set enable_nestloop = off;
+set enable_mergejoin = off;
+
+-- The hash table is rebuilt for each group.  The middle group lets nearly
+-- everything through, so the scan gives up on its filter; the last group's
+-- filter must be consulted again.
+select explain_bloom('
+select g, (select count(*) from bf_fact f join bf_dim d on f.k = d.k
+           where d.grp = g)
+from generate_series(1, 3) g');
+
+select g, (select count(*) from bf_fact f join bf_dim d on f.k = d.k
+           where d.grp = g)
+from generate_series(1, 3) g;
+
+set enable_hashjoin_bloom = off;
+
+select g, (select count(*) from bf_fact f join bf_dim d on f.k = d.k
+           where d.grp = g)
+from generate_series(1, 3) g;
+
+reset enable_hashjoin_bloom;
+reset enable_nestloop;
+reset enable_mergejoin;
+
+drop function explain_bloom(text);
+
+--
+-- Probing a hash table big enough (65536 buckets or more) that outer tuples
+-- are fetched in batches and their buckets prefetched
+--
+create temp table hj_inner as
+  select i as k, i % 7 as v from generate_series(1, 100000) i;
+create temp table hj_outer as
+  select i % 150000 as k from generate_series(1, 300000) i;
+analyze hj_inner;
+analyze hj_outer;
+
+create function explain_hashjoin(query text) returns setof text
+language plpgsql as
+$$
+declare
+    ln text;
+begin
+    for ln in
+        execute format('explain (analyze, costs off, summary off, timing off) %s',
+            query)
+    loop
+        ln := regexp_replace(ln, 'Memory Usage: \d+', 'Memory Usage: N');
+        return next ln;
+    end loop;
+end;
+$$;
+
+set enable_nestloop = off;
+set enable_mergejoin = off;
+set enable_hashjoin_bloom = off;
+
+set work_mem = '64MB';
+select explain_hashjoin('
+select count(*) from hj_outer o left join hj_inner i on o.k = i.k');
+select count(*), count(i.k), sum(i.v)
+  from hj_outer o left join hj_inner i on o.k = i.k;
+
+-- Again with the outer tuples of the second batch read back from disk
+set work_mem = '3MB';
+select explain_hashjoin('
+select count(*) from hj_outer o left join hj_inner i on o.k = i.k');
+select count(*), count(i.k), sum(i.v)
+  from hj_outer o left join hj_inner i on o.k = i.k;
+
+-- Compare with a merge join
+reset work_mem;
+set enable_hashjoin = off;
+set enable_mergejoin = on;
+select count(*), count(i.k), sum(i.v)
+  from hj_outer o left join hj_inner i on o.k = i.k;
+
+reset enable_hashjoin;
+reset enable_hashjoin_bloom;
+reset enable_nestloop;
+reset enable_mergejoin;
+
+drop function explain_hashjoin(text);
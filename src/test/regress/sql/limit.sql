@@ -141,3 +141,22 @@ select sum(tenthous) as s1, sum(tenthous) + random()*0 as s2
 
 select sum(tenthous) as s1, sum(tenthous) + random()*0 as s2
   from tenk1 group by thousand order by thousand limit 3;
+
+-- incremental sort of an index scan ordered by a prefix of the sort keys
+explain (costs off)
+select thousand, unique1 from tenk1 order by thousand, unique1 limit 5;
+
+select thousand, unique1 from tenk1 order by thousand, unique1 limit 5;
+
+-- the bound must hold across groups of equal prefix keys
+explain (costs off)
+select thousand, unique1 from tenk1
+  order by thousand, unique1 desc limit 3 offset 9;
+
+select thousand, unique1 from tenk1
+  order by thousand, unique1 desc limit 3 offset 9;
+
+set enable_incremental_sort = off;
+explain (costs off)
+select thousand, unique1 from tenk1 order by thousand, unique1 limit 5;
+reset enable_incremental_sort;
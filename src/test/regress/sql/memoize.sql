@@ -0,0 +1,91 @@
+-- Perform tests on the Memoize node.
+
+-- The cache hits/misses/evictions from the Memoize node can vary between
+-- machines.  Let's just replace the number with an 'N'.  In order to allow us
+-- to perform validation when the measure was zero, we replace a zero value
+-- with "Zero".  All other numbers are replaced with 'N'.  The loop counts of
+-- the cached scan follow the misses, so they're hidden along with them.
+create function explain_memoize(query text, hide_hitmiss bool) returns setof text
+language plpgsql as
+$$
+declare
+    ln text;
+begin
+    for ln in
+        execute format('explain (analyze, costs off, summary off, timing off) %s',
+            query)
+    loop
+        if hide_hitmiss = true then
+                ln := regexp_replace(ln, 'Hits: 0', 'Hits: Zero');
+                ln := regexp_replace(ln, 'Hits: \d+', 'Hits: N');
+                ln := regexp_replace(ln, 'Misses: 0', 'Misses: Zero');
+                ln := regexp_replace(ln, 'Misses: \d+', 'Misses: N');
+                ln := regexp_replace(ln, 'loops=\d+', 'loops=N');
+        end if;
+        ln := regexp_replace(ln, 'Evictions: 0', 'Evictions: Zero');
+        ln := regexp_replace(ln, 'Evictions: \d+', 'Evictions: N');
+        ln := regexp_replace(ln, 'Memory Usage: \d+', 'Memory Usage: N');
+        ln := regexp_replace(ln, 'Heap Fetches: \d+', 'Heap Fetches: N');
+        return next ln;
+    end loop;
+end;
+$$;
+
+-- Ensure we get a memoize node on the inner side of the nested loop
+set enable_hashjoin to off;
+set enable_mergejoin to off;
+set enable_bitmapscan to off;
+
+select explain_memoize('
+select count(*), avg(t1.unique1) from tenk1 t1
+inner join tenk1 t2 on t1.unique1 = t2.twenty
+where t2.unique1 < 1000;', false);
+
+-- And check we get the expected results.
+select count(*), avg(t1.unique1) from tenk1 t1
+inner join tenk1 t2 on t1.unique1 = t2.twenty
+where t2.unique1 < 1000;
+
+-- Try with LATERAL joins
+select explain_memoize('
+select count(*), avg(t2.unique1) from tenk1 t1,
+lateral (select t2.unique1 from tenk1 t2 where t1.twenty = t2.unique1) t2
+where t1.unique1 < 1000;', false);
+
+-- And check we get the expected results.
+select count(*), avg(t2.unique1) from tenk1 t1,
+lateral (select t2.unique1 from tenk1 t2 where t1.twenty = t2.unique1) t2
+where t1.unique1 < 1000;
+
+-- Reduce work_mem so that we see some cache evictions
+set work_mem to '64kB';
+
+-- Ensure we get some evictions.  We're unable to validate the hits and misses
+-- here as the number of entries that fit in the cache at once will vary
+-- between different machines.
+select explain_memoize('
+select count(*), avg(t1.unique1) from tenk1 t1
+inner join tenk1 t2 on t1.unique1 = t2.thousand
+where t2.unique1 < 1200;', true);
+
+-- And check that evicting entries doesn't change the results.
+select count(*), avg(t1.unique1) from tenk1 t1
+inner join tenk1 t2 on t1.unique1 = t2.thousand
+where t2.unique1 < 1200;
+
+reset work_mem;
+
+-- The same query without a Memoize node gives the same answer
+set enable_memoize to off;
+
+select count(*), avg(t1.unique1) from tenk1 t1
+inner join tenk1 t2 on t1.unique1 = t2.thousand
+where t2.unique1 < 1200;
+
+reset enable_memoize;
+
+reset enable_bitmapscan;
+reset enable_hashjoin;
+reset enable_mergejoin;
+
+drop function explain_memoize(text, bool);
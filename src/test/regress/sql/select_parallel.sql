@@ -136,6 +136,36 @@ select  count(*) from tenk1, tenk2 where tenk1.unique1 = tenk2.unique1;
 reset enable_hashjoin;
 reset enable_nestloop;
 
+-- test parallel hash join, which builds one hash table shared by all
+-- participants; it is only planned when that table fits in work_mem, and
+-- only when enabled, which it is not by default.
+set enable_parallel_hash to on;
+create table phj_wide as
+  select g as id, repeat('x', 200) as pad from generate_series(0, 4999) g;
+analyze phj_wide;
+set enable_mergejoin to off;
+set enable_nestloop to off;
+set work_mem = '4MB';
+prepare phj_count as
+  select count(*), sum(length(pad)) from tenk1 join phj_wide on fivethous = id;
+explain (costs off) execute phj_count;
+execute phj_count;
+-- the plan stays the same when work_mem shrinks, but the shared table then
+-- outgrows its budget, and as it cannot be split into batches that is an
+-- error; keep the leader alone so that it is the one reporting it
+set work_mem = '64kB';
+set max_parallel_workers = 0;
+savepoint phj_budget;
+execute phj_count;
+rollback to savepoint phj_budget;
+deallocate phj_count;
+reset max_parallel_workers;
+reset work_mem;
+reset enable_mergejoin;
+reset enable_nestloop;
+reset enable_parallel_hash;
+drop table phj_wide;
+
 -- test gather merge
 set enable_hashagg = false;
 
@@ -2,10 +2,13 @@
 
 -- We will be checking execution plans without/with statistics, so
 -- let's make sure we get simple non-parallel plans. Also set the
--- work_mem low so that we can use small amounts of data.
+-- work_mem low so that we can use small amounts of data, and keep
+-- hashed aggregation within it, so the group estimates decide between
+-- hashing and sorting.
 SET max_parallel_workers = 0;
 SET max_parallel_workers_per_gather = 0;
 SET work_mem = '128kB';
+SET enable_hashagg_disk = off;
 
 -- Verify failures
 CREATE STATISTICS tst;